@@ -0,0 +1,95 @@
+/**
+ * Benchmark of expression evaluation used in script conditions.
+ *
+ * Compares evaluation of expression tree, which looks up device values
+ * by name at every evaluation, with compiled expression using bound
+ * values.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "block.h"
+#include "compiledexpression.h"
+
+#define DEVICES   20
+#define VALUES    40
+#define ROUNDS    200000
+
+using namespace rts2expression;
+
+class BenchBlock:public rts2core::Block
+{
+	public:
+		BenchBlock ():rts2core::Block (0, NULL) {}
+		virtual int run () { return 0; }
+
+		void addDevice (const char *name)
+		{
+			rts2core::Connection *conn = new rts2core::Connection (this);
+			conn->setName (-1, name);
+			char vname[20];
+			for (int i = 0; i < VALUES; i++)
+			{
+				snprintf (vname, 20, "v%d", i);
+				conn->metaInfo (RTS2_VALUE_DOUBLE, vname, "value");
+				((rts2core::ValueDouble *) conn->getValue (vname))->setValueDouble (i);
+			}
+			getConnections ()->push_back (conn);
+			connectionsChanged ();
+		}
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void bench (BenchBlock *block, const char *str)
+{
+	Expression *expr = parseExpression (str);
+	CompiledExpression compiled (block);
+	compiled.compile (expr);
+
+	double sum = 0;
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+		sum += expr->evaluate ();
+	double tt = (now () - t) / ROUNDS;
+
+	t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+		sum -= compiled.evaluate ();
+	double tc = (now () - t) / ROUNDS;
+
+	printf ("%-50s tree %8.3f us  compiled %8.3f us (%5.1fx) %s\n", str, tt * 1e6, tc * 1e6, tt / tc, sum == 0 ? "" : "RESULTS DIFFER");
+
+	delete expr;
+}
+
+int main (int argc, char **argv)
+{
+	BenchBlock block;
+	char name[20];
+	for (int i = 0; i < DEVICES; i++)
+	{
+		snprintf (name, 20, "D%d", i);
+		block.addDevice (name);
+	}
+
+	printf ("%d devices with %d values, average of %d evaluations\n", DEVICES, VALUES, ROUNDS);
+
+	bench (&block, "D0.v1 > 0");
+	bench (&block, "D19.v39 > 5");
+	bench (&block, "D19.v39 > 5 and D10.v20 < 100 or D0.v1 == 3");
+	bench (&block, "D19.v0 > 5 and D10.v20 < 100 and D15.v30 >= 30");
+	bench (&block, "1 > 2 and D19.v39 > 5");
+
+	return 0;
+}
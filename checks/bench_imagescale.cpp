@@ -0,0 +1,137 @@
+/**
+ * Benchmark of pixel scaling used for image previews and streaming of
+ * scaled images.
+ *
+ * Compares per-pixel loop with branches, working on copy of the data
+ * chunk (as done before PixelScaler was introduced), with PixelScaler
+ * scaling directly from the source buffer, in single and all threads.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "imghdr.h"
+#include "rts2fits/imagescale.h"
+
+#define WIDTH     6144
+#define HEIGHT    6144
+#define ROUNDS    5
+
+using namespace rts2image;
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+// the old scaling, in place with branches for every pixel
+template <typename bt, typename dt> void legacyScale (dt * data, size_t numpix, dt smin, dt smax, scaling_type scaling, bt white)
+{
+	dt * end = data + numpix;
+	dt * p = data;
+	bt *nd = (bt *) data;
+
+	double l = smax - smin;
+
+	for (; p < end; p++, nd++)
+	{
+		if (*p < smin)
+		{
+			*nd = 0;
+			continue;
+		}
+		if (*p > smax)
+		{
+			*nd = white;
+			continue;
+		}
+		double d = *p;
+		d = white * (d - smin) / l;
+		switch (scaling)
+		{
+			case SCALING_LINEAR:
+				break;
+			case SCALING_LOG:
+				d = log (d);
+				break;
+			case SCALING_POW:
+				d *= d;
+				break;
+			case SCALING_SQRT:
+				d = sqrt (d);
+				break;
+		}
+		*nd = (bt) d;
+	}
+}
+
+template <typename dt> double benchLegacy (const dt *data, size_t numpix, dt smin, dt smax, scaling_type scaling)
+{
+	size_t bytes = numpix * sizeof (dt);
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		// copy of the chunk, scaled in place
+		char *chunk = new char[bytes];
+		memcpy (chunk, data, bytes);
+		legacyScale ((dt *) chunk, numpix, smin, smax, scaling, (uint8_t) 0xff);
+		delete[] chunk;
+	}
+	return (now () - t) / ROUNDS;
+}
+
+double benchScaler (int dataType, const void *data, size_t numpix, double smin, double smax, scaling_type scaling, int threads)
+{
+	PixelScaler scaler (smin, smax, scaling, RTS2_DATA_BYTE);
+	scaler.setThreads (threads);
+	uint8_t *out = new uint8_t[numpix];
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+		scaler.scale (dataType, data, out, numpix);
+	t = (now () - t) / ROUNDS;
+	delete[] out;
+	return t;
+}
+
+template <typename dt> void runBench (const char *name, int dataType, const dt *data, size_t numpix, dt smin, dt smax)
+{
+	const char *scalings[] = {"lin", "log", "sqrt", "pow"};
+	for (int s = 0; s < 4; s++)
+	{
+		scaling_type scaling = (scaling_type) s;
+		double tl = benchLegacy (data, numpix, smin, smax, scaling);
+		double t1 = benchScaler (dataType, data, numpix, smin, smax, scaling, 1);
+		double tn = benchScaler (dataType, data, numpix, smin, smax, scaling, 0);
+		printf ("%-7s %-5s legacy %8.2f ms  scaler 1 thread %8.2f ms (%5.1fx)  %d threads %8.2f ms (%5.1fx)\n", name, scalings[s], tl * 1000, t1 * 1000, tl / t1, onlineCPUs (), tn * 1000, tl / tn);
+	}
+}
+
+int main (int argc, char **argv)
+{
+	size_t numpix = WIDTH * HEIGHT;
+
+	printf ("scaling %dx%d frame to 8 bits, average of %d rounds\n", WIDTH, HEIGHT, ROUNDS);
+
+	uint16_t *d16 = new uint16_t[numpix];
+	uint32_t *d32 = new uint32_t[numpix];
+	srandom (1);
+	for (size_t i = 0; i < numpix; i++)
+	{
+		// sky background with noise and few saturated pixels
+		d16[i] = 1000 + random () % 200 + (random () % 1000 == 0 ? 60000 : 0);
+		d32[i] = d16[i] * 16;
+	}
+
+	runBench ("ushort", RTS2_DATA_USHORT, d16, numpix, (uint16_t) 900, (uint16_t) 1300);
+	runBench ("ulong", RTS2_DATA_ULONG, d32, numpix, (uint32_t) 900 * 16, (uint32_t) 1300 * 16);
+
+	delete[] d16;
+	delete[] d32;
+
+	return 0;
+}
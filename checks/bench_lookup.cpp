@@ -0,0 +1,104 @@
+/**
+ * Benchmark of device and value lookups by name.
+ *
+ * Compares linear search of connections and values, which was used
+ * before, with the hashed lookups of Block::getValue.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "block.h"
+
+#define DEVICES   30
+#define VALUES    300
+#define ROUNDS    200000
+
+class BenchBlock:public rts2core::Block
+{
+	public:
+		BenchBlock ():rts2core::Block (0, NULL) {}
+		virtual int run () { return 0; }
+
+		void addDevice (const char *name)
+		{
+			rts2core::Connection *conn = new rts2core::Connection (this);
+			conn->setName (-1, name);
+			char vname[20];
+			for (int i = 0; i < VALUES; i++)
+			{
+				snprintf (vname, 20, "value_%d", i);
+				conn->metaInfo (RTS2_VALUE_DOUBLE, vname, "value");
+			}
+			getConnections ()->push_back (conn);
+			connectionsChanged ();
+		}
+
+		// lookup as it was done before the indices
+		rts2core::Value *linearValue (const char *device_name, const char *value_name)
+		{
+			for (rts2core::connections_t::iterator iter = getConnections ()->begin (); iter != getConnections ()->end (); iter++)
+			{
+				if (!strcmp ((*iter)->getName (), device_name))
+				{
+					for (rts2core::ValueVector::iterator vi = (*iter)->valueBegin (); vi != (*iter)->valueEnd (); vi++)
+					{
+						if ((*vi)->isValue (value_name))
+							return *vi;
+					}
+					return NULL;
+				}
+			}
+			return NULL;
+		}
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void bench (BenchBlock *block, const char *device, const char *value)
+{
+	rts2core::Value *v1 = NULL;
+	rts2core::Value *v2 = NULL;
+
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+		v1 = block->linearValue (device, value);
+	double tl = (now () - t) / ROUNDS;
+
+	t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+		v2 = block->getValue (device, value);
+	double th = (now () - t) / ROUNDS;
+
+	printf ("%5s.%-10s linear %8.3f us  hashed %8.3f us (%6.1fx) %s\n", device, value, tl * 1e6, th * 1e6, tl / th, v1 == v2 ? "" : "RESULTS DIFFER");
+}
+
+int main (int argc, char **argv)
+{
+	BenchBlock block;
+	char name[20];
+	for (int i = 0; i < DEVICES; i++)
+	{
+		snprintf (name, 20, "D%d", i);
+		block.addDevice (name);
+	}
+
+	printf ("%d devices with %d values, average of %d lookups\n", DEVICES, VALUES, ROUNDS);
+
+	bench (&block, "D0", "value_0");
+	bench (&block, "D15", "value_150");
+	bench (&block, "D29", "value_299");
+	bench (&block, "D29", "missing");
+	bench (&block, "D99", "value_0");
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+/**
+ * Benchmark of shared memory frame ring.
+ *
+ * Writer thread publishes frames as fast as it can, reader threads read
+ * them either in "every" or "latest" mode. Prints frames/s for writer and
+ * readers and number of frames lost by "every" readers, for few frame sizes.
+ *
+ * Optional argument limits writer rate (frames/s), to emulate camera
+ * running at given frame rate.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+#include "shmring.h"
+
+#define SLOTS       8
+#define DURATION    2.0
+
+// writer frame rate, 0 for unlimited
+double rate = 0;
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+struct ReaderArgs
+{
+	rts2core::ShmRingWriter *writer;
+	bool every;
+	volatile bool *stop;
+	uint64_t frames;
+	uint64_t lost;
+	uint64_t bad;
+};
+
+void *reader (void *arg)
+{
+	struct ReaderArgs *ra = (struct ReaderArgs *) arg;
+	rts2core::ShmRingReader r;
+	if (r.attachFd (ra->writer->getFd ()))
+	{
+		perror ("attach");
+		return NULL;
+	}
+	char *buf = new char[r.getSlotSize ()];
+	rts2core::ShmFrameInfo info;
+	while (!*(ra->stop))
+	{
+		int ret = ra->every ? r.readNext (buf, info) : r.readLatest (buf, info);
+		if (ret == 1)
+		{
+			ra->frames++;
+			// first and last bytes hold frame number
+			if (buf[0] != (char) info.frame || buf[info.size - 1] != (char) info.frame)
+				ra->bad++;
+		}
+	}
+	ra->lost = r.getLost ();
+	delete[] buf;
+	return NULL;
+}
+
+void bench (size_t frameSize, int readers, bool every)
+{
+	rts2core::ShmRingWriter w;
+	if (w.create (NULL, SLOTS, frameSize))
+	{
+		perror ("create");
+		exit (1);
+	}
+
+	volatile bool stop = false;
+	pthread_t *threads = new pthread_t[readers];
+	struct ReaderArgs *args = new struct ReaderArgs[readers];
+	for (int i = 0; i < readers; i++)
+	{
+		args[i].writer = &w;
+		args[i].every = every;
+		args[i].stop = &stop;
+		args[i].frames = args[i].lost = args[i].bad = 0;
+		pthread_create (threads + i, NULL, reader, args + i);
+	}
+
+	double t = now ();
+	double end = t + DURATION;
+	uint64_t f = 0;
+	while (now () < end)
+	{
+		if (rate > 0)
+		{
+			double d = t + f / rate - now ();
+			if (d > 0)
+				usleep (d * 1e6);
+		}
+		char *data = w.beginFrame ();
+		// touch the whole frame, as camera readout does
+		memset (data, (char) f, frameSize);
+		w.endFrame (frameSize, NULL, f);
+		f++;
+	}
+	t = now () - t;
+	stop = true;
+
+	printf ("%8zu KiB %-6s %d readers: writer %10.1f frames/s %8.1f MiB/s", frameSize / 1024, every ? "every" : "latest", readers, f / t, f * frameSize / t / 1048576.0);
+	for (int i = 0; i < readers; i++)
+	{
+		pthread_join (threads[i], NULL);
+		printf (" | reader %9.1f frames/s", args[i].frames / t);
+		if (every)
+			printf (" lost %llu", (unsigned long long) args[i].lost);
+		if (args[i].bad)
+			printf (" CORRUPTED %llu", (unsigned long long) args[i].bad);
+	}
+	printf ("\n");
+
+	delete[] threads;
+	delete[] args;
+}
+
+int main (int argc, char **argv)
+{
+	if (argc > 1)
+		rate = atof (argv[1]);
+	size_t sizes[] = {64 * 1024, 1024 * 1024, 8 * 1024 * 1024, 32 * 1024 * 1024};
+	for (size_t i = 0; i < sizeof (sizes) / sizeof (sizes[0]); i++)
+	{
+		bench (sizes[i], 1, true);
+		bench (sizes[i], 1, false);
+		bench (sizes[i], 2, false);
+	}
+	return 0;
+}
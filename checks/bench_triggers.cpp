@@ -0,0 +1,123 @@
+/**
+ * Benchmark of value trigger dispatch used in rts2-httpd.
+ *
+ * Replays stream of value changes against synthetic triggers of
+ * rts2xmlrpc::Events. Compares scan of all value triggers, which compares
+ * device and value names of every trigger for every value change, with
+ * Events::valueTriggers lookup used by HttpD::valueChangedEvent.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "events.h"
+
+#define DEVICES    50
+#define VALUES     100
+#define STREAM     20000
+
+/**
+ * Value trigger counting its runs.
+ */
+class BenchTrigger:public rts2xmlrpc::ValueChange
+{
+	public:
+		// cadency timer needs the daemon, so cadency is 0 or disabled
+		BenchTrigger (const char *_deviceName, const char *_valueName, float _cadency):rts2xmlrpc::ValueChange (NULL, _deviceName, _valueName, _cadency, NULL) { runs = 0; }
+
+		virtual void run (rts2core::Value *val, double validTime) { runs++; }
+
+		unsigned long runs;
+};
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void bench (int ntriggers)
+{
+	rts2xmlrpc::Events events (NULL);
+	char dn[20], vn[20];
+
+	srandom (ntriggers);
+	for (int i = 0; i < ntriggers; i++)
+	{
+		snprintf (dn, 20, "D%ld", random () % DEVICES);
+		snprintf (vn, 20, "value_%ld", random () % VALUES);
+		events.valueCommands.push_back (new BenchTrigger (dn, vn, (i % 3) ? -1 : 0));
+	}
+
+	// first lookup builds the index
+	double t = now ();
+	events.valueTriggers ("D0", "value_0");
+	double tb = now () - t;
+
+	// value stream, twice as many values as values with triggers
+	std::vector <std::pair <std::string, std::string> > stream;
+	for (int i = 0; i < STREAM; i++)
+	{
+		snprintf (dn, 20, "D%ld", random () % DEVICES);
+		snprintf (vn, 20, "value_%ld", random () % (VALUES * 2));
+		stream.push_back (std::pair <std::string, std::string> (dn, vn));
+	}
+
+	// scan as it was done before triggers were indexed
+	unsigned long scanRuns = 0;
+	t = now ();
+	for (int i = 0; i < STREAM; i++)
+	{
+		const char *name = stream[i].first.c_str ();
+		for (rts2xmlrpc::ValueCommands::iterator iter = events.valueCommands.begin (); iter != events.valueCommands.end (); iter++)
+		{
+			rts2xmlrpc::ValueChange *vc = *iter;
+			if (!strcasecmp (vc->getDeviceName (), name) && !strcasecmp (vc->getValueName (), stream[i].second.c_str ()) && vc->shouldRun (i + 1))
+			{
+				vc->run (NULL, i + 1);
+				vc->runSuccessfully (i + 1);
+				scanRuns++;
+			}
+		}
+	}
+	double ts = (now () - t) / STREAM;
+
+	for (rts2xmlrpc::ValueCommands::iterator iter = events.valueCommands.begin (); iter != events.valueCommands.end (); iter++)
+		(*iter)->runSuccessfully (0);
+
+	unsigned long indexRuns = 0;
+	t = now ();
+	for (int i = 0; i < STREAM; i++)
+	{
+		std::vector <rts2xmlrpc::ValueChange *> *triggers = events.valueTriggers (stream[i].first.c_str (), stream[i].second.c_str ());
+		if (triggers == NULL)
+			continue;
+		for (std::vector <rts2xmlrpc::ValueChange *>::iterator iter = triggers->begin (); iter != triggers->end (); iter++)
+		{
+			if ((*iter)->shouldRun (i + 1))
+			{
+				(*iter)->run (NULL, i + 1);
+				(*iter)->runSuccessfully (i + 1);
+				indexRuns++;
+			}
+		}
+	}
+	double ti = (now () - t) / STREAM;
+
+	printf ("%6d triggers  scan %10.3f us  indexed %8.3f us (%7.1fx)  index build %8.3f ms  %lu runs %s\n", ntriggers, ts * 1e6, ti * 1e6, ts / ti, tb * 1e3, indexRuns, scanRuns == indexRuns ? "" : "RUNS DIFFER");
+}
+
+int main (int argc, char **argv)
+{
+	printf ("%d devices with %d values, average time per value change of %d changes\n", DEVICES, VALUES, STREAM);
+
+	bench (10);
+	bench (100);
+	bench (1000);
+	bench (5000);
+	bench (20000);
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+/**
+ * Benchmark of binary value frames against text value updates.
+ *
+ * Encodes and decodes set of double values and double array, similar to
+ * values published by telescope drivers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "valueframe.h"
+#include "valuearray.h"
+
+#define NVALUES     50
+#define ARRAY_LEN   500
+#define ROUNDS      2000
+
+double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void fillValues (rts2core::ValueVector &vv)
+{
+	char name[20];
+	for (int i = 0; i < NVALUES; i++)
+	{
+		snprintf (name, 20, "val_%d", i);
+		vv.push_back (new rts2core::ValueDouble (name));
+	}
+	vv.push_back (new rts2core::DoubleArray ("arr"));
+}
+
+// text protocol - format as V name value, parse with strtod
+double benchText (rts2core::ValueVector &src, rts2core::ValueVector &dst, size_t &bytes)
+{
+	std::string msg;
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		msg.clear ();
+		for (rts2core::ValueVector::iterator iter = src.begin (); iter != src.end (); iter++)
+		{
+			msg += "V ";
+			msg += (*iter)->getName ();
+			msg += " ";
+			msg += (*iter)->getValue ();
+			msg += "\n";
+		}
+		bytes = msg.length ();
+
+		char *p = (char *) msg.c_str ();
+		while (*p)
+		{
+			char *le = strchr (p, '\n');
+			*le = '\0';
+			char *name = p + 2;
+			char *ve = strchr (name, ' ');
+			*ve = '\0';
+			rts2core::Value *v = dst.getValue (name);
+			if (v->getValueType () == RTS2_VALUE_DOUBLE)
+			{
+				((rts2core::ValueDouble *) v)->setValueDouble (strtod (ve + 1, NULL));
+			}
+			else
+			{
+				std::vector <double> arr;
+				char *ae = ve + 1;
+				while (*ae)
+				{
+					char *en;
+					arr.push_back (strtod (ae, &en));
+					if (en == ae)
+						break;
+					ae = en;
+				}
+				((rts2core::DoubleArray *) v)->setValueArray (arr);
+			}
+			p = le + 1;
+		}
+	}
+	return now () - t;
+}
+
+double benchFrame (rts2core::ValueVector &src, rts2core::ValueVector &dst, size_t &bytes)
+{
+	rts2core::ValueFrame frame;
+	double t = now ();
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		frame.clear ();
+		for (rts2core::ValueVector::iterator iter = src.begin (); iter != src.end (); iter++)
+			frame.add (*iter);
+		bytes = frame.size ();
+		rts2core::ValueFrame::decode (frame.data (), frame.size (), dst);
+	}
+	return now () - t;
+}
+
+int main (int argc, char **argv)
+{
+	rts2core::ValueVector src, dst;
+	fillValues (src);
+	fillValues (dst);
+
+	for (int i = 0; i < NVALUES; i++)
+		((rts2core::ValueDouble *) src[i])->setValueDouble (i * M_PI);
+	for (int i = 0; i < ARRAY_LEN; i++)
+		((rts2core::DoubleArray *) src[NVALUES])->addValue (i / 7.0);
+
+	size_t textBytes, frameBytes;
+	double tt = benchText (src, dst, textBytes);
+	double tf = benchFrame (src, dst, frameBytes);
+
+	printf ("%d rounds of %d doubles and %d element array\n", ROUNDS, NVALUES, ARRAY_LEN);
+	printf ("text  : %8.3f us/round %8ld bytes\n", tt * 1e6 / ROUNDS, (long) textBytes);
+	printf ("binary: %8.3f us/round %8ld bytes\n", tf * 1e6 / ROUNDS, (long) frameBytes);
+	printf ("speedup %.1fx\n", tt / tf);
+	return 0;
+}
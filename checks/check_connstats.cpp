@@ -0,0 +1,163 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <math.h>
+#include <sstream>
+
+#include "connstats.h"
+
+START_TEST(histogram)
+{
+	rts2core::LatencyHistogram h;
+
+	ck_assert_int_eq (h.getCount (), 0);
+	ck_assert (isnan (h.getMean ()));
+	ck_assert (isnan (h.getQuantile (0.5)));
+
+	// 1 ms is in bucket with upper bound 1024 us
+	for (int i = 0; i < 99; i++)
+		h.record (0.001);
+	h.record (0.5);
+
+	ck_assert_int_eq (h.getCount (), 100);
+	ck_assert_dbl_eq (h.getSum (), 0.599, 1e-6);
+	ck_assert_dbl_eq (h.getMax (), 0.5, 1e-6);
+	ck_assert_dbl_eq (h.getQuantile (0.5), 0.001024, 1e-9);
+	ck_assert_dbl_eq (h.getQuantile (0.99), 0.001024, 1e-9);
+	// quantile never exceeds maximum
+	ck_assert_dbl_eq (h.getQuantile (1), 0.5, 1e-6);
+
+	// negative durations are recorded as 0
+	h.record (-1);
+	ck_assert_int_eq (h.getBucket (0), 1);
+
+	h.reset ();
+	ck_assert_int_eq (h.getCount (), 0);
+	ck_assert_dbl_eq (h.getMax (), 0, 1e-9);
+}
+END_TEST
+
+START_TEST(prometheus)
+{
+	rts2core::LatencyHistogram h;
+	h.record (0.000002);
+	h.record (100000);
+
+	rts2core::PrometheusWriter pw;
+	h.writePrometheus (pw, "test", "a=\"b\"");
+
+	std::ostringstream os;
+	pw.write (os);
+
+	std::string s = os.str ();
+	ck_assert (s.find ("# TYPE test histogram\ntest_bucket{a=\"b\",le=\"1e-06\"} 0\n") == 0);
+	ck_assert (s.find ("test_bucket{a=\"b\",le=\"+Inf\"} 2\n") != std::string::npos);
+	ck_assert (s.find ("test_bucket{a=\"b\",le=\"4e-06\"} 1\n") != std::string::npos);
+	ck_assert (s.find ("test_count{a=\"b\"} 2\n") != std::string::npos);
+}
+END_TEST
+
+START_TEST(prometheus_families)
+{
+	ck_assert_str_eq (rts2core::prometheusLabel ("peer", "C0").c_str (), "peer=\"C0\"");
+	ck_assert_str_eq (rts2core::prometheusLabel ("peer", "a\\b\"c\nd").c_str (), "peer=\"a\\\\b\\\"c\\nd\"");
+
+	rts2core::ConnStats c1, c2;
+	c1.bytesReceived (10);
+	c2.bytesReceived (20);
+
+	rts2core::PrometheusWriter pw;
+	c1.writePrometheus (pw, rts2core::prometheusLabel ("peer", "C1"));
+	c2.writePrometheus (pw, rts2core::prometheusLabel ("peer", "C2"));
+
+	std::ostringstream os;
+	pw.write (os);
+	std::string s = os.str ();
+
+	// each family has single TYPE line, followed by samples of both connections
+	size_t t = s.find ("# TYPE rts2_received_bytes_total counter\n");
+	ck_assert (t != std::string::npos);
+	ck_assert (s.find ("# TYPE rts2_received_bytes_total", t + 1) == std::string::npos);
+	ck_assert (s.find ("rts2_received_bytes_total{peer=\"C1\"} 10\nrts2_received_bytes_total{peer=\"C2\"} 20\n") == s.find ('\n', t) + 1);
+	ck_assert (s.find ("# TYPE rts2_command_rtt_seconds histogram\n") == 0);
+	ck_assert (s.find ("# TYPE rts2_buffer_max_bytes gauge\n") != std::string::npos);
+}
+END_TEST
+
+START_TEST(connstats)
+{
+	rts2core::ConnStats cs;
+
+	// nothing is recorded while instrumentation is disabled
+	rts2core::setStatsEnabled (false);
+	cs.commandSent ("info");
+	cs.commandReturned ();
+	ck_assert_int_eq (cs.getRoundTrip ().getCount (), 0);
+
+	rts2core::setStatsEnabled (true);
+	cs.commandSent ("info");
+	cs.commandReturned ();
+	cs.commandSent ("X exposure = 10");
+	cs.commandReturned ();
+	cs.commandSent ("info");
+	cs.commandReturned ();
+	// return without command
+	cs.commandReturned ();
+
+	ck_assert_int_eq (cs.getRoundTrip ().getCount (), 3);
+	ck_assert_int_eq (cs.getCommandHistograms ().size (), 2);
+	ck_assert_int_eq (cs.getCommandHistograms ().find ("info")->second->getCount (), 2);
+	ck_assert_int_eq (cs.getCommandHistograms ().find ("X")->second->getCount (), 1);
+
+	cs.bytesReceived (10);
+	cs.bytesReceived (20);
+	cs.bytesSent (5);
+	ck_assert_int_eq (cs.getReceivedBytes (), 30);
+	ck_assert_int_eq (cs.getSentBytes (), 5);
+
+	cs.bufferSize (2000);
+	cs.bufferSize (4000);
+	cs.bufferSize (3000);
+	ck_assert_int_eq (cs.getMaxBufferSize (), 4000);
+
+	ck_assert (isnan (cs.getBinaryRate ()));
+	cs.binaryChunk (1000, true);
+	cs.binaryChunk (1000, false);
+	ck_assert_int_eq (cs.getBinaryBytes (true), 1000);
+	ck_assert_int_eq (cs.getBinaryBytes (false), 1000);
+
+	rts2core::setStatsEnabled (false);
+}
+END_TEST
+
+Suite * connstats_suite (void)
+{
+	Suite *s;
+	TCase *tc_connstats;
+
+	s = suite_create ("ConnStats");
+	tc_connstats = tcase_create ("Connection statistics");
+
+	tcase_add_test (tc_connstats, histogram);
+	tcase_add_test (tc_connstats, prometheus);
+	tcase_add_test (tc_connstats, prometheus_families);
+	tcase_add_test (tc_connstats, connstats);
+	suite_add_tcase (s, tc_connstats);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = connstats_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,230 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "nmonitor.h"
+
+#define VALUES    300
+#define CHANGES   5
+
+using namespace rts2ncurses;
+
+NDeviceWindow *window;
+
+/**
+ * Device client reporting value changes to the window, as NMonDevClient does.
+ */
+class TestDevClient:public rts2core::DevClient
+{
+	public:
+		TestDevClient (rts2core::Connection *conn):rts2core::DevClient (conn) {}
+
+		virtual void valueChanged (rts2core::Value *value)
+		{
+			if (window)
+				window->valueChanged (getConnection (), value);
+		}
+};
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+		virtual int run () { return 0; }
+
+		virtual rts2core::DevClient *createOtherType (rts2core::Connection *conn, int other_device_type) { return new TestDevClient (conn); }
+
+		rts2core::Connection *addDevice (const char *name)
+		{
+			rts2core::Connection *conn = new rts2core::Connection (this);
+			conn->setName (-1, name);
+			conn->setOtherType (DEVICE_TYPE_SENSOR);
+			char vname[20];
+			for (int i = 0; i < VALUES; i++)
+			{
+				snprintf (vname, 20, "value_%d", i);
+				conn->metaInfo (RTS2_VALUE_DOUBLE, vname, "value");
+				((rts2core::ValueDouble *) conn->getValue (vname))->setValueDouble (i);
+			}
+			getConnections ()->push_back (conn);
+			return conn;
+		}
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestBlock *block;
+rts2core::Connection *conn;
+SCREEN *screen;
+FILE *out;
+
+void setup_window (void)
+{
+	// headless terminal
+	setenv ("LINES", "60", 1);
+	setenv ("COLUMNS", "160", 1);
+	out = fopen ("/dev/null", "w");
+	screen = newterm ("vt100", out, stdin);
+	ck_assert (screen != NULL);
+
+	block = new TestBlock ();
+	conn = block->addDevice ("S0");
+	window = new NDeviceWindow (conn, false);
+}
+
+void teardown_window (void)
+{
+	delete window;
+	window = NULL;
+	delete block;
+	endwin ();
+	delscreen (screen);
+	fclose (out);
+}
+
+// emulates value received from the device
+void changeValue (int i, double v)
+{
+	char vname[20];
+	snprintf (vname, 20, "value_%d", i);
+	rts2core::Value *val = conn->getValue (vname);
+	((rts2core::ValueDouble *) val)->setValueDouble (v);
+	conn->getOtherDevClient ()->valueChanged (val);
+}
+
+std::string lineText (int row)
+{
+	char buf[200];
+	mvwinnstr (window->getWriteWindow (), row, 0, buf, 199);
+	return std::string (buf);
+}
+
+START_TEST(redraw_changed)
+{
+	// window constructor draws all lines
+	ck_assert_int_eq (window->getRenderedLines (), VALUES);
+
+	unsigned long last = window->getRenderedLines ();
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, 0);
+
+	for (int tick = 0; tick < 10; tick++)
+	{
+		last = window->getRenderedLines ();
+		for (int i = 0; i < CHANGES; i++)
+			changeValue ((tick * 37 + i * 53) % VALUES, 1000 + tick * 10 + i);
+		window->draw ();
+		ck_assert_int_eq (window->getRenderedLines () - last, CHANGES);
+		char expected[20];
+		snprintf (expected, 20, "%d", 1000 + tick * 10);
+		ck_assert (lineText ((tick * 37) % VALUES).find (expected) != std::string::npos);
+	}
+
+	// value changed to the same display string is not written
+	last = window->getRenderedLines ();
+	changeValue (1, conn->getValue ("value_1")->getValueDouble ());
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, 0);
+
+	// change of flags redraws the line
+	last = window->getRenderedLines ();
+	rts2core::Value *v2 = conn->getValue ("value_2");
+	v2->setFlags (v2->getFlags () | RTS2_VALUE_ERROR);
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, 1);
+}
+END_TEST
+
+START_TEST(redraw_list)
+{
+	// new value changes layout, so all lines are drawn
+	unsigned long last = window->getRenderedLines ();
+	conn->metaInfo (RTS2_VALUE_DOUBLE, "new_value", "new value");
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, VALUES + 1);
+
+	// time value is redrawn only if its display changes
+	conn->metaInfo (RTS2_VALUE_TIME, "time_value", "time value");
+	window->draw ();
+	last = window->getRenderedLines ();
+	window->draw ();
+	ck_assert (window->getRenderedLines () - last <= 1);
+
+	// moving selection redraws previously selected line
+	window->injectKey (KEY_HOME);
+	window->draw ();
+	last = window->getRenderedLines ();
+	window->injectKey (KEY_DOWN);
+	window->draw ();
+	ck_assert (window->getRenderedLines () - last <= 2);
+	ck_assert (window->getRenderedLines () - last >= 1);
+
+	// filter for FITS values - no value is displayed
+	window->injectKey (KEY_F (8));
+	last = window->getRenderedLines ();
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, 0);
+	ck_assert (lineText (0).find ("value_0") == std::string::npos);
+
+	// filter for writable values - no value is displayed, nothing is redrawn
+	window->injectKey (KEY_F (8));
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, 0);
+
+	// all values again
+	window->injectKey (KEY_F (8));
+	window->draw ();
+	ck_assert_int_eq (window->getRenderedLines () - last, VALUES + 2);
+	ck_assert (lineText (0).find ("value_0") != std::string::npos);
+}
+END_TEST
+
+START_TEST(writes_per_tick)
+{
+	// compare with full redraw, done before by every tick
+	unsigned long last = window->getRenderedLines ();
+	for (int tick = 0; tick < 100; tick++)
+	{
+		for (int i = 0; i < CHANGES; i++)
+			changeValue ((tick * 7 + i * 31) % VALUES, tick * 100 + i);
+		window->draw ();
+	}
+	double perTick = (window->getRenderedLines () - last) / 100.0;
+	printf ("%d values, %d changed per tick: %.1f lines written per tick, %d with full redraw\n", VALUES, CHANGES, perTick, VALUES);
+	ck_assert (perTick <= CHANGES);
+}
+END_TEST
+
+Suite * devicewindow_suite (void)
+{
+	Suite *s;
+	TCase *tc_devicewindow;
+
+	s = suite_create ("DeviceWindow");
+	tc_devicewindow = tcase_create ("Differential redraw");
+
+	tcase_add_checked_fixture (tc_devicewindow, setup_window, teardown_window);
+	tcase_add_test (tc_devicewindow, redraw_changed);
+	tcase_add_test (tc_devicewindow, redraw_list);
+	tcase_add_test (tc_devicewindow, writes_per_tick);
+	suite_add_tcase (s, tc_devicewindow);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = devicewindow_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
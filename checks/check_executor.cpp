@@ -0,0 +1,218 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "rts2json/executor.h"
+#include "xmlrpc++/XmlRpcServer.h"
+
+// server interface needed by the executor
+class TestHTTPServer:public rts2json::HTTPServer
+{
+	public:
+		TestHTTPServer () { executed = 0; }
+
+		virtual bool isPublic (struct sockaddr_in *saddr, const std::string &path) { return true; }
+		virtual bool existsSession (std::string sessionId) { return false; }
+		virtual void addExecutedPage () { executed++; }
+		virtual const char* getPagePrefix () { return ""; }
+		virtual bool getDebug () { return false; }
+		virtual void sendValueAll (rts2core::Value * value) {}
+		virtual rts2db::CamList *getCameras () { return NULL; }
+		virtual rts2core::connections_t *getConnections () { return NULL; }
+		virtual void getOpenConnectionType (int deviceType, rts2core::connections_t::iterator &current) {}
+		virtual bool verifyDBUser (std::string username, std::string pass, rts2core::UserPermissions *userPermissions = NULL) { return true; }
+
+		int executed;
+};
+
+// drops responses of closed connections, as HttpD does
+class TestXmlServer:public XmlRpc::XmlRpcServer
+{
+	public:
+		TestXmlServer (rts2json::RequestExecutor *_executor):XmlRpc::XmlRpcServer () { executor = _executor; }
+
+		virtual void removeConnection (XmlRpc::XmlRpcServerConnection *sc)
+		{
+			executor->orphanRequests (sc);
+			XmlRpc::XmlRpcServer::removeConnection (sc);
+		}
+
+	private:
+		rts2json::RequestExecutor *executor;
+};
+
+class TestConnection:public XmlRpc::XmlRpcServerConnection
+{
+	public:
+		TestConnection (int fd, XmlRpc::XmlRpcServer *server):XmlRpc::XmlRpcServerConnection (fd, server, false, NULL, 0) {}
+
+		std::list <std::pair <const char*, std::string> > & getExtraHeaders () { return _extra_headers; }
+};
+
+// request blocking until it is released
+class BlockingRequest:public rts2json::GetRequestAuthorized
+{
+	public:
+		BlockingRequest (rts2json::HTTPServer *_server):rts2json::GetRequestAuthorized ("/block", _server)
+		{
+			pthread_mutex_init (&mutex, NULL);
+			pthread_cond_init (&cond, NULL);
+			started = false;
+			released = false;
+		}
+
+		~BlockingRequest ()
+		{
+			pthread_cond_destroy (&cond);
+			pthread_mutex_destroy (&mutex);
+		}
+
+		void waitStarted ()
+		{
+			pthread_mutex_lock (&mutex);
+			while (!started)
+				pthread_cond_wait (&cond, &mutex);
+			pthread_mutex_unlock (&mutex);
+		}
+
+		void release ()
+		{
+			pthread_mutex_lock (&mutex);
+			released = true;
+			pthread_cond_broadcast (&cond);
+			pthread_mutex_unlock (&mutex);
+		}
+
+	protected:
+		virtual void authorizedExecute (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length)
+		{
+			pthread_mutex_lock (&mutex);
+			started = true;
+			pthread_cond_broadcast (&cond);
+			while (!released)
+				pthread_cond_wait (&cond, &mutex);
+			pthread_mutex_unlock (&mutex);
+
+			cacheMaxAge (60);
+
+			response_type = "text/plain";
+			response_length = 4;
+			response = new char[response_length];
+			memcpy (response, "done", response_length);
+		}
+
+	private:
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		bool started;
+		bool released;
+};
+
+TestHTTPServer *httpServer;
+rts2json::RequestExecutor *executor;
+TestXmlServer *xmlServer;
+BlockingRequest *request;
+int sockets[2];
+
+void setup_executor (void)
+{
+	httpServer = new TestHTTPServer ();
+	executor = new rts2json::RequestExecutor (httpServer);
+	xmlServer = new TestXmlServer (executor);
+	request = new BlockingRequest (httpServer);
+	ck_assert_int_eq (executor->start (1), 0);
+	ck_assert_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+}
+
+void teardown_executor (void)
+{
+	executor->stop ();
+	delete request;
+	delete xmlServer;
+	delete executor;
+	delete httpServer;
+	close (sockets[0]);
+	close (sockets[1]);
+}
+
+// wait for the worker to finish the request
+static void waitFinished ()
+{
+	struct pollfd pfd;
+	pfd.fd = executor->getNotifyFd ();
+	pfd.events = POLLIN;
+	ck_assert_int_eq (poll (&pfd, 1, 5000), 1);
+}
+
+START_TEST(headers)
+{
+	TestConnection *conn = new TestConnection (sockets[0], xmlServer);
+	XmlRpc::HttpParams params;
+
+	ck_assert (executor->queueRequest (request, conn, "/", &params));
+	request->release ();
+	waitFinished ();
+
+	// header set by the worker is passed to the connection with the response
+	ck_assert_int_eq (executor->processFinished (), 1);
+	ck_assert_int_eq (httpServer->executed, 1);
+	ck_assert_int_eq (conn->getExtraHeaders ().size (), 1);
+	ck_assert_str_eq (conn->getExtraHeaders ().front ().first, "Cache-Control");
+
+	delete conn;
+}
+END_TEST
+
+START_TEST(closed)
+{
+	TestConnection *conn = new TestConnection (sockets[0], xmlServer);
+	XmlRpc::HttpParams params;
+
+	ck_assert (executor->queueRequest (request, conn, "/", &params));
+	request->waitStarted ();
+
+	// connection is closed while its request is running
+	delete conn;
+
+	request->release ();
+	waitFinished ();
+
+	// response is dropped
+	ck_assert_int_eq (executor->processFinished (), 1);
+	ck_assert_int_eq (httpServer->executed, 1);
+}
+END_TEST
+
+Suite * executor_suite (void)
+{
+	Suite *s;
+	TCase *tc_executor;
+
+	s = suite_create ("Executor");
+	tc_executor = tcase_create ("Request executor");
+
+	tcase_add_checked_fixture (tc_executor, setup_executor, teardown_executor);
+	tcase_add_test (tc_executor, headers);
+	tcase_add_test (tc_executor, closed);
+	suite_add_tcase (s, tc_executor);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = executor_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,256 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "block.h"
+#include "compiledexpression.h"
+
+using namespace rts2expression;
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+		virtual int run () { return 0; }
+
+		rts2core::Connection *addDevice (const char *name)
+		{
+			rts2core::Connection *conn = new rts2core::Connection (this);
+			conn->setName (-1, name);
+			conn->metaInfo (RTS2_VALUE_DOUBLE, "temp", "temperature");
+			conn->metaInfo (RTS2_VALUE_DOUBLE, "hum", "humidity");
+			getConnections ()->push_back (conn);
+			connectionsChanged ();
+			return conn;
+		}
+
+		void removeDevice (rts2core::Connection *conn)
+		{
+			for (rts2core::connections_t::iterator iter = getConnections ()->begin (); iter != getConnections ()->end (); iter++)
+			{
+				if (*iter == conn)
+				{
+					getConnections ()->erase (iter);
+					break;
+				}
+			}
+			delete conn;
+			connectionsChanged ();
+		}
+
+		void removeAll ()
+		{
+			while (!getConnections ()->empty ())
+				removeDevice (getConnections ()->front ());
+		}
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestBlock *block;
+rts2core::Connection *dev;
+
+// block is master application, used by expression trees
+void setup_block (void)
+{
+	block = new TestBlock ();
+}
+
+void teardown_block (void)
+{
+	delete block;
+}
+
+void setup_expression (void)
+{
+	dev = block->addDevice ("D1");
+}
+
+void teardown_expression (void)
+{
+	block->removeAll ();
+}
+
+static void setValue (rts2core::Connection *conn, const char *name, double v)
+{
+	((rts2core::ValueDouble *) conn->getValue (name))->setValueDouble (v);
+}
+
+// true if evaluation fails on missing value
+static bool valueMissing (CompiledExpression &compiled)
+{
+	try
+	{
+		compiled.evaluate ();
+	}
+	catch (ExpressionErrorValueMissing &er)
+	{
+		return true;
+	}
+	return false;
+}
+
+// evaluate expression with both tree and compiled code
+static void checkExpression (const char *str, double expected)
+{
+	Expression *expr = parseExpression (str);
+	CompiledExpression compiled (block);
+	compiled.compile (expr);
+	ck_assert_dbl_eq (expr->evaluate (), expected, 10e-10);
+	ck_assert_dbl_eq (compiled.evaluate (), expected, 10e-10);
+	delete expr;
+}
+
+START_TEST(compare)
+{
+	setValue (dev, "temp", 10);
+	setValue (dev, "hum", 80);
+
+	checkExpression ("D1.temp > 5", 1);
+	checkExpression ("D1.temp < 5", 0);
+	checkExpression ("D1.temp >= 10 and D1.hum < 90", 1);
+	checkExpression ("D1.temp > 10 or D1.hum != 80", 0);
+	checkExpression ("D1.temp == 10 xor D1.hum == 80", 0);
+	checkExpression ("5 < D1.temp", 1);
+	checkExpression ("D1.temp", 10);
+
+	setValue (dev, "hum", 95);
+	checkExpression ("D1.temp >= 10 and D1.hum < 90", 0);
+	checkExpression ("D1.temp > 10 or D1.hum != 80", 1);
+}
+END_TEST
+
+START_TEST(folding)
+{
+	double v;
+	CompiledExpression compiled (block);
+
+	Expression *expr = parseExpression ("1 < 2 and 3 == 3");
+	compiled.compile (expr);
+	ck_assert (compiled.isConstant (v));
+	ck_assert_dbl_eq (v, 1, 10e-10);
+	delete expr;
+
+	// false and .. does not need the value, even if device does not exist
+	expr = parseExpression ("1 > 2 and D2.temp > 5");
+	compiled.compile (expr);
+	ck_assert (compiled.isConstant (v));
+	ck_assert_dbl_eq (compiled.evaluate (), 0, 10e-10);
+	delete expr;
+
+	// true and x is x converted to 0 / 1
+	expr = parseExpression ("1 < 2 and D1.temp");
+	compiled.compile (expr);
+	ck_assert_int_eq (compiled.size (), 2);
+	setValue (dev, "temp", 15);
+	ck_assert_dbl_eq (compiled.evaluate (), 1, 10e-10);
+	delete expr;
+
+	// folding stops at jump targets
+	expr = parseExpression ("D1.temp and 1 == 1");
+	compiled.compile (expr);
+	setValue (dev, "temp", 0);
+	ck_assert_dbl_eq (compiled.evaluate (), 0, 10e-10);
+	setValue (dev, "temp", 3);
+	ck_assert_dbl_eq (compiled.evaluate (), 1, 10e-10);
+	delete expr;
+}
+END_TEST
+
+START_TEST(shortcircuit)
+{
+	Expression *expr = parseExpression ("D1.temp > 5 or D2.temp > 5");
+	CompiledExpression compiled (block);
+	compiled.compile (expr);
+
+	setValue (dev, "temp", 10);
+	ck_assert_dbl_eq (compiled.evaluate (), 1, 10e-10);
+
+	// second value is needed, and it is missing
+	setValue (dev, "temp", 0);
+	ck_assert (valueMissing (compiled));
+
+	// device appears
+	rts2core::Connection *dev2 = block->addDevice ("D2");
+	setValue (dev2, "temp", 6);
+	ck_assert_dbl_eq (compiled.evaluate (), 1, 10e-10);
+
+	delete expr;
+}
+END_TEST
+
+START_TEST(rebind)
+{
+	CompiledExpression compiled (block);
+	compiled.pushValue ("D1", "temp");
+
+	setValue (dev, "temp", 1);
+	ck_assert_dbl_eq (compiled.evaluate (), 1, 10e-10);
+	unsigned long gen = block->getValuesGeneration ();
+
+	// value updates do not require new lookup
+	setValue (dev, "temp", 2);
+	ck_assert_dbl_eq (compiled.evaluate (), 2, 10e-10);
+	ck_assert_int_eq (block->getValuesGeneration (), gen);
+
+	// device reconnects with new connection and new values
+	block->removeDevice (dev);
+	ck_assert (valueMissing (compiled));
+	dev = block->addDevice ("D1");
+	setValue (dev, "temp", 3);
+	ck_assert_dbl_eq (compiled.evaluate (), 3, 10e-10);
+
+	// value is replaced with value of different type
+	dev->metaInfo (RTS2_VALUE_INTEGER, "temp", "temperature");
+	((rts2core::ValueInteger *) dev->getValue ("temp"))->setValueInteger (4);
+	ck_assert_dbl_eq (compiled.evaluate (), 4, 10e-10);
+
+	// missing value of connected device
+	CompiledExpression missing (block);
+	missing.pushValue ("D1", "pressure", true);
+	ck_assert (isnan (missing.evaluate ()));
+	missing.clear ();
+	missing.pushValue ("D1", "pressure");
+	ck_assert (valueMissing (missing));
+
+	ValueBinding binding ("D1", "hum");
+	ck_assert (binding.getValue (block) == dev->getValue ("hum"));
+	ck_assert (binding.isConnected ());
+}
+END_TEST
+
+Suite * expression_suite (void)
+{
+	Suite *s;
+	TCase *tc_expression;
+
+	s = suite_create ("Expression");
+	tc_expression = tcase_create ("Compiled expressions");
+
+	tcase_add_unchecked_fixture (tc_expression, setup_block, teardown_block);
+	tcase_add_checked_fixture (tc_expression, setup_expression, teardown_expression);
+	tcase_add_test (tc_expression, compare);
+	tcase_add_test (tc_expression, folding);
+	tcase_add_test (tc_expression, shortcircuit);
+	tcase_add_test (tc_expression, rebind);
+	suite_add_tcase (s, tc_expression);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = expression_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
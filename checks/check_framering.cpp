@@ -0,0 +1,182 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "framering.h"
+
+#define FRAMES       10
+#define CHUNKS       16
+#define CHUNK_SIZE   64
+
+rts2core::FrameRing *ring = NULL;
+
+void setup_framering (void)
+{
+	ring = new rts2core::FrameRing ();
+	ring->allocate (2, 2, CHUNKS * CHUNK_SIZE);
+}
+
+void teardown_framering (void)
+{
+	delete ring;
+}
+
+// fills frames with frame number, in both channels
+void *producer (void *arg)
+{
+	char buf[CHUNK_SIZE];
+	for (int f = 0; f < FRAMES; f++)
+	{
+		int frame = ring->acquire (f);
+		for (int c = 0; c < CHUNKS; c++)
+		{
+			memset (buf, f, CHUNK_SIZE);
+			ring->write (frame, 0, buf, CHUNK_SIZE);
+			// fill buffer directly
+			memset (ring->getTop (frame, 1), f + 100, CHUNK_SIZE);
+			ring->write (frame, 1, ring->getTop (frame, 1), CHUNK_SIZE);
+		}
+		ring->finish (frame, -2);
+	}
+	return NULL;
+}
+
+START_TEST(single)
+{
+	int frame = ring->acquire (1);
+	ck_assert_int_eq (frame, 0);
+	ck_assert_int_eq (ring->getUsed (), 1);
+
+	ck_assert_int_eq (ring->write (frame, 0, "abcd", 4), 0);
+	ck_assert_int_eq (ring->write (frame, 0, "efgh", 4), 0);
+	// channel out of range
+	ck_assert_int_eq (ring->write (frame, 2, "abcd", 4), -1);
+	ring->finish (frame, -2);
+
+	rts2core::FrameChunk chunk (-1, -1, 0, 0);
+	ck_assert (ring->pop (chunk));
+	ck_assert_int_eq (chunk.chan, 0);
+	ck_assert_int_eq (chunk.offset, 0);
+	ck_assert_int_eq (chunk.size, 4);
+	ck_assert (ring->pop (chunk));
+	ck_assert_int_eq (chunk.offset, 4);
+	ck_assert (strncmp (ring->getData (frame, 0), "abcdefgh", 8) == 0);
+
+	ck_assert (ring->pop (chunk));
+	ck_assert_int_eq (chunk.chan, -1);
+	ck_assert_int_eq (chunk.ret, -2);
+	ck_assert_int_eq (ring->getSequence (chunk.frame), 1);
+	ck_assert (!ring->pop (chunk));
+
+	ring->release (frame);
+	ck_assert_int_eq (ring->getUsed (), 0);
+
+	// data which does not fit
+	frame = ring->acquire (2);
+	ck_assert_int_eq (frame, 1);
+	char big[CHUNKS * CHUNK_SIZE + 1];
+	ck_assert_int_eq (ring->write (frame, 0, big, sizeof (big)), -1);
+}
+END_TEST
+
+START_TEST(threaded)
+{
+	pthread_t t;
+	pthread_create (&t, NULL, producer, NULL);
+
+	int frames = 0;
+	size_t received[2] = {0, 0};
+	rts2core::FrameChunk chunk (-1, -1, 0, 0);
+	while (frames < FRAMES)
+	{
+		if (!ring->pop (chunk))
+		{
+			usleep (100);
+			continue;
+		}
+		long seq = ring->getSequence (chunk.frame);
+		if (chunk.chan < 0)
+		{
+			ck_assert_int_eq (seq, frames);
+			ck_assert_int_eq (received[0], CHUNKS * CHUNK_SIZE);
+			ck_assert_int_eq (received[1], CHUNKS * CHUNK_SIZE);
+			received[0] = received[1] = 0;
+			ring->release (chunk.frame);
+			frames++;
+			continue;
+		}
+		char *data = ring->getData (chunk.frame, chunk.chan) + chunk.offset;
+		for (size_t i = 0; i < chunk.size; i++)
+			ck_assert_int_eq (data[i], chunk.chan == 0 ? seq : seq + 100);
+		ck_assert_int_eq (chunk.offset, received[chunk.chan]);
+		received[chunk.chan] += chunk.size;
+	}
+
+	pthread_join (t, NULL);
+	ck_assert_int_eq (ring->getUsed (), 0);
+}
+END_TEST
+
+void *blockedAcquire (void *arg)
+{
+	*((int *) arg) = ring->acquire (3);
+	return NULL;
+}
+
+START_TEST(cancel)
+{
+	ck_assert_int_eq (ring->acquire (1), 0);
+	ck_assert_int_eq (ring->acquire (2), 1);
+
+	// producer waits for free frame until the ring is cancelled
+	int frame = 0;
+	pthread_t t;
+	pthread_create (&t, NULL, blockedAcquire, &frame);
+	usleep (10000);
+	ring->cancel ();
+	pthread_join (t, NULL);
+	ck_assert_int_eq (frame, -1);
+
+	ring->release (0);
+	ck_assert_int_eq (ring->acquire (4), -1);
+
+	// allocation clears cancel
+	ring->allocate (2, 1, CHUNK_SIZE);
+	ck_assert_int_eq (ring->acquire (5), 0);
+}
+END_TEST
+
+Suite * framering_suite (void)
+{
+	Suite *s;
+	TCase *tc_framering;
+
+	s = suite_create ("FrameRing");
+	tc_framering = tcase_create ("Frame buffers ring");
+
+	tcase_add_checked_fixture (tc_framering, setup_framering, teardown_framering);
+	tcase_add_test (tc_framering, single);
+	tcase_add_test (tc_framering, threaded);
+	tcase_add_test (tc_framering, cancel);
+	suite_add_tcase (s, tc_framering);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = framering_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
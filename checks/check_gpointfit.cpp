@@ -0,0 +1,297 @@
+#include "gpointfit.h"
+
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <string.h>
+
+// arcseconds to radians
+#define AS(x)   ln_deg_to_rad ((x) / 3600.0)
+
+rts2telmodel::GPointModel *gem_model;
+rts2telmodel::GPointModel *altaz_model;
+
+void setup_gpointfit (void)
+{
+	gem_model = new rts2telmodel::GPointModel (34);
+	std::istringstream iss1 ("RTS2_MODEL 20\" -15\" 8\" 3\" -40\" 25\" -12\" 5\" 7\"");
+	gem_model->load (iss1);
+
+	altaz_model = new rts2telmodel::GPointModel (-32.5);
+	std::istringstream iss2 ("RTS2_ALTAZ -30\" 4\" -8\" 12\" -6\" 18\" 9\"\nAZ 6\" sincos az;el 2;2\nEL 3\" sin az 1");
+	altaz_model->load (iss2);
+}
+
+void teardown_gpointfit (void)
+{
+	delete gem_model;
+	delete altaz_model;
+}
+
+/**
+ * Generate GEM alignment points, real position is target with model applied.
+ */
+void fill_gem (rts2telmodel::GPointFit &fit, double noise)
+{
+	srand (1);
+	for (double ha = -80; ha <= 80; ha += 10)
+	{
+		for (double dec = -30; dec <= 80; dec += 10)
+		{
+			struct ln_equ_posn pos;
+			pos.ra = ha;
+			pos.dec = dec;
+			gem_model->apply (&pos);
+			fit.addHaDec (ha, dec, pos.ra + noise * (rand () / (double) RAND_MAX - 0.5), pos.dec + noise * (rand () / (double) RAND_MAX - 0.5));
+		}
+	}
+}
+
+START_TEST(fit_gem)
+{
+	rts2telmodel::GPointFit fit (34);
+	fill_gem (fit, 0);
+	ck_assert_int_eq (fit.getPoints (), 17 * 12);
+	ck_assert (fit.getRMS (false) > 10);
+
+	fit.fit ();
+
+	ck_assert_int_eq (fit.getParams (), GPOINT_GEM_PARAMS);
+	for (int i = 0; i < GPOINT_GEM_PARAMS; i++)
+		ck_assert_dbl_eq (fit.getParam (i), (double) gem_model->params[i], AS (0.001));
+	ck_assert_str_eq (fit.getParamName (7), "daf");
+	ck_assert (fit.getRMS (true) < 0.001);
+}
+END_TEST
+
+START_TEST(fit_altaz)
+{
+	rts2telmodel::GPointFit fit (-32.5);
+	fit.addExtra ("az:sincos:az;el:2;2");
+	fit.addExtra ("alt", "sin", "az", "1");
+
+	for (double az = 5; az < 360; az += 15)
+	{
+		for (double alt = 15; alt < 85; alt += 10)
+		{
+			struct ln_hrz_posn hrz, err;
+			struct ln_equ_posn equ;
+			hrz.az = az;
+			hrz.alt = alt;
+			equ.ra = equ.dec = 0;
+			altaz_model->getErrAltAz (&hrz, &equ, &err);
+			fit.addAltAz (az, alt, hrz.az, hrz.alt);
+		}
+	}
+
+	fit.fit ();
+
+	ck_assert_int_eq (fit.getParams (), GPOINT_ALTAZ_PARAMS + 2);
+	ck_assert_str_eq (fit.getParamName (GPOINT_ALTAZ_PARAMS), "az_sincos_az_el_2_0_2_0");
+	ck_assert_str_eq (fit.getParamName (GPOINT_ALTAZ_PARAMS + 1), "el_sin_az_1_0");
+	for (int i = 0; i < GPOINT_ALTAZ_PARAMS; i++)
+		ck_assert_dbl_eq (fit.getParam (i), (double) altaz_model->params[i], AS (0.001));
+	ck_assert_dbl_eq (fit.getParam (GPOINT_ALTAZ_PARAMS), AS (6), AS (0.001));
+	ck_assert_dbl_eq (fit.getParam (GPOINT_ALTAZ_PARAMS + 1), AS (3), AS (0.001));
+
+	// model written by fit is loaded by the runtime model
+	std::ostringstream os;
+	fit.print (os);
+	ck_assert (os.str ().compare (0, 11, "RTS2_ALTAZ ") == 0);
+
+	rts2telmodel::GPointModel loaded (-32.5);
+	std::istringstream is (os.str ());
+	loaded.load (is);
+	ck_assert (loaded.altaz);
+	ck_assert_int_eq (loaded.extraParamsAz.size (), 1);
+	ck_assert_int_eq (loaded.extraParamsEl.size (), 1);
+	for (int i = 0; i < GPOINT_ALTAZ_PARAMS; i++)
+		ck_assert_dbl_eq ((double) loaded.params[i], fit.getParam (i), AS (0.001));
+}
+END_TEST
+
+START_TEST(fixed)
+{
+	rts2telmodel::GPointFit fit (34);
+	fill_gem (fit, 0);
+	fit.setFixed ("fo");
+	fit.fit ();
+	ck_assert (fit.isFixed (8));
+	ck_assert_dbl_eq (fit.getParam (8), 0, 1e-12);
+	ck_assert_dbl_eq (fit.getParamError (8), 0, 1e-12);
+	ck_assert_dbl_eq (fit.getParam (4), (double) gem_model->params[4], AS (0.001));
+
+	rts2telmodel::GPointFit fit2 (34);
+	fill_gem (fit2, 0);
+	fit2.setFixed ("foo");
+	ck_assert_int_eq (fit2.getPoints (), 17 * 12);
+	bool thrown = false;
+	try
+	{
+		fit2.fit ();
+	}
+	catch (rts2core::Error &er)
+	{
+		thrown = true;
+	}
+	ck_assert (thrown);
+}
+END_TEST
+
+START_TEST(bootstrap)
+{
+	rts2telmodel::GPointFit fit (34);
+	// 10 arcsec noise
+	fill_gem (fit, 10 / 3600.0);
+	fit.fit ();
+	for (int i = 0; i < GPOINT_GEM_PARAMS; i++)
+	{
+		ck_assert (fit.getParamError (i) > 0);
+		ck_assert_dbl_eq (fit.getParam (i), (double) gem_model->params[i], AS (5));
+	}
+
+	fit.bootstrap (50, 1, 7);
+	std::vector <double> e1;
+	for (int i = 0; i < GPOINT_GEM_PARAMS; i++)
+	{
+		e1.push_back (fit.getBootstrapError (i));
+		ck_assert (e1[i] > 0 && e1[i] < AS (5));
+	}
+
+	// results does not depend on number of threads
+	fit.bootstrap (50, 3, 7);
+	for (int i = 0; i < GPOINT_GEM_PARAMS; i++)
+		ck_assert (fit.getBootstrapError (i) == e1[i]);
+}
+END_TEST
+
+START_TEST(read_alignment)
+{
+	rts2telmodel::GPointFit fit;
+	std::istringstream is (
+		"# Observation      MJD       LST-MNT RA-MNT   DEC-MNT   AXRA      AXDEC   RA-TRUE  DEC-TRUE\n"
+		"# observatory -17.87 28.76 2350\n"
+		"02a57222e0002o 57222.260012 233.8937 275.7921  77.0452  -55497734  -46831997 276.0206  77.0643\n"
+		"02a57222e0003o 57222.261012 234.1000 200.0000  100.0000  -55497734  -46831997 20.1000  79.9000\n"
+		"\n"
+		"02a57222e0004o 57222.262012 234.3000 250.0000  10.0000  -55497734  -46831997 250.0100  10.0200\n");
+	fit.readAlignment (is);
+	ck_assert (!fit.isAltAz ());
+	ck_assert_dbl_eq (fit.getLatitude (), 28.76, 1e-10);
+	ck_assert_int_eq (fit.getPoints (), 3);
+
+	fit.prepare ();
+	double r_ha, r_dec;
+	fit.getResidual (2, r_ha, r_dec);
+	ck_assert_dbl_eq (r_ha, ln_deg_to_rad (0.01) * cos (ln_deg_to_rad (10)), 1e-10);
+	ck_assert_dbl_eq (r_dec, ln_deg_to_rad (-0.02), 1e-10);
+
+	// flipped - RA flipped by 180, DEC mirrored around pole
+	fit.getResidual (1, r_ha, r_dec);
+	ck_assert_dbl_eq (r_ha, ln_deg_to_rad (0.1) * fabs (cos (ln_deg_to_rad (100))), 1e-10);
+	ck_assert_dbl_eq (r_dec, ln_deg_to_rad (-0.1), 1e-10);
+
+	rts2telmodel::GPointFit fit_east;
+	std::istringstream is2 (is.str ());
+	fit_east.readAlignment (is2, "east");
+	ck_assert_int_eq (fit_east.getPoints (), 1);
+
+	rts2telmodel::GPointFit fit_altaz (28.76);
+	std::istringstream is3 (
+		"# Observation      MJD       LST-MNT   AZ-MNT   ALT-MNT   AXAZ      AXALT   AZ-TRUE  ALT-TRUE\n"
+		"# altaz -17.87 0 2350\n"
+		"02a57222e0002o 57222.260012 233.8937 275.7921  77.0452  -55497734  -46831997 276.0206  77.0643\n");
+	fit_altaz.readAlignment (is3);
+	ck_assert (fit_altaz.isAltAz ());
+	// latitude from constructor is preferred
+	ck_assert_dbl_eq (fit_altaz.getLatitude (), 28.76, 1e-10);
+}
+END_TEST
+
+START_TEST(batch)
+{
+	struct ln_equ_posn pos[600], pos1;
+	struct ln_hrz_posn hrz[600], err[600], hrz1, err1;
+
+	std::istringstream iss ("RTS2_MODEL 20\" -15\" 8\" 3\" -40\" 25\" -12\" 5\" 7\"\nHA 5\" sin ha 2\nDEC -3\" cos az 1");
+	rts2telmodel::GPointModel m (34);
+	m.load (iss);
+
+	for (int i = 0; i < 600; i++)
+	{
+		pos[i].ra = -90 + i * 0.3;
+		pos[i].dec = -20 + i * 0.15;
+		hrz[i].az = i * 0.6;
+		hrz[i].alt = 10 + i * 0.12;
+	}
+
+	struct ln_equ_posn pos_r[600];
+	memcpy (pos_r, pos, sizeof (pos));
+	m.reverseBatch (pos_r, hrz, 600);
+
+	struct ln_equ_posn pos_a[600];
+	memcpy (pos_a, pos, sizeof (pos));
+	m.applyBatch (pos_a, 600);
+
+	struct ln_hrz_posn hrz_e[600];
+	memcpy (hrz_e, hrz, sizeof (hrz));
+	altaz_model->getErrAltAzBatch (hrz_e, pos, err, 600);
+
+	for (int i = 0; i < 600; i++)
+	{
+		pos1 = pos[i];
+		m.reverse (&pos1, &hrz[i]);
+		ck_assert (pos1.ra == pos_r[i].ra && pos1.dec == pos_r[i].dec);
+
+		pos1 = pos[i];
+		m.apply (&pos1);
+		ck_assert (pos1.ra == pos_a[i].ra && pos1.dec == pos_a[i].dec);
+
+		hrz1 = hrz[i];
+		altaz_model->getErrAltAz (&hrz1, &pos[i], &err1);
+		ck_assert (hrz1.az == hrz_e[i].az && hrz1.alt == hrz_e[i].alt);
+		ck_assert (err1.az == err[i].az && err1.alt == err[i].alt);
+	}
+
+	// extra terms are applied
+	ck_assert_dbl_eq (pos_r[0].ra - pos[0].ra, ln_rad_to_deg ((double) m.params[4] + AS (5) * sin (2 * ln_deg_to_rad (-90))
+		+ m.params[5] / cos (ln_deg_to_rad (-20)) + m.params[6] * tan (ln_deg_to_rad (-20)) + (m.params[1] * sin (ln_deg_to_rad (-90))) * tan (ln_deg_to_rad (-20))
+		+ m.params[3] * cos (ln_deg_to_rad (34)) * sin (ln_deg_to_rad (-90)) / cos (ln_deg_to_rad (-20))
+		+ m.params[7] * sin (ln_deg_to_rad (34)) * tan (ln_deg_to_rad (-20))), 1e-9);
+}
+END_TEST
+
+Suite * gpointfit_suite (void)
+{
+	Suite *s;
+	TCase *tc_gpointfit;
+
+	s = suite_create ("GPointFit");
+	tc_gpointfit = tcase_create ("Pointing model fit");
+
+	tcase_add_checked_fixture (tc_gpointfit, setup_gpointfit, teardown_gpointfit);
+	tcase_add_test (tc_gpointfit, fit_gem);
+	tcase_add_test (tc_gpointfit, fit_altaz);
+	tcase_add_test (tc_gpointfit, fixed);
+	tcase_add_test (tc_gpointfit, bootstrap);
+	tcase_add_test (tc_gpointfit, read_alignment);
+	tcase_add_test (tc_gpointfit, batch);
+	suite_add_tcase (s, tc_gpointfit);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = gpointfit_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,369 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "rts2fits/imagequeue.h"
+
+/*
+ * Runs against local PostgreSQL database, specified in RTS2_CHECK_DB
+ * environment variable (for example "dbname=rts2check"). Fixture table is
+ * created in check_imagequeue schema, which is dropped at the end. Test is
+ * skipped if the variable is not set. Database must provide wcs2 type in
+ * public schema (src/sql/update/wcs2.sql), as RTS2 database does.
+ */
+
+#define FRAMES          20000
+#define SINGLE_FRAMES   1000
+
+using namespace rts2image;
+
+std::string dbname;
+std::string conninfo;
+char journal[100];
+
+double timeNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+PGresult *fixture_sql (PGconn *conn, const char *sql)
+{
+	PGresult *res = PQexec (conn, sql);
+	if (PQresultStatus (res) != PGRES_COMMAND_OK && PQresultStatus (res) != PGRES_TUPLES_OK)
+		fprintf (stderr, "%s: %s\n", sql, PQresultErrorMessage (res));
+	ck_assert (PQresultStatus (res) == PGRES_COMMAND_OK || PQresultStatus (res) == PGRES_TUPLES_OK);
+	return res;
+}
+
+PGconn *fixture_connect ()
+{
+	PGconn *conn = PQconnectdb (conninfo.c_str ());
+	ck_assert (PQstatus (conn) == CONNECTION_OK);
+	return conn;
+}
+
+// returns integer result of the query
+int query_int (const char *sql)
+{
+	PGconn *conn = fixture_connect ();
+	PGresult *res = fixture_sql (conn, sql);
+	int ret = atoi (PQgetvalue (res, 0, 0));
+	PQclear (res);
+	PQfinish (conn);
+	return ret;
+}
+
+void setup_db (void)
+{
+	PGconn *conn = PQconnectdb (dbname.c_str ());
+	ck_assert (PQstatus (conn) == CONNECTION_OK);
+	PQclear (fixture_sql (conn,
+		"DROP SCHEMA IF EXISTS check_imagequeue CASCADE;"
+		"CREATE SCHEMA check_imagequeue;"
+		"SET search_path TO check_imagequeue, public;"
+		"CREATE TABLE images (img_id integer, obs_id integer, obs_subtype char(1), img_date timestamp, img_usec integer, img_exposure float4, img_temperature float4, "
+		"filter_id integer, img_alt float4, img_az float4, camera_name varchar(8), mount_name varchar(8), delete_flag boolean, process_bitfield integer, "
+		"img_fwhm float4, img_limmag float4, img_qmagmax float4, astrometry wcs2, img_err_ra float8, img_err_dec float8, img_err float8, img_path varchar(100), med_id integer, "
+		"PRIMARY KEY (obs_id, img_id));"));
+	PQfinish (conn);
+
+	conninfo = dbname + " options='-csearch_path=check_imagequeue,public'";
+	snprintf (journal, sizeof (journal), "/tmp/check_imagequeue_%d", getpid ());
+}
+
+void teardown_db (void)
+{
+	PGconn *conn = PQconnectdb (dbname.c_str ());
+	PQclear (fixture_sql (conn, "DROP SCHEMA check_imagequeue CASCADE;"));
+	PQfinish (conn);
+}
+
+ImageRecord frame (int i)
+{
+	ImageRecord rec;
+	rec.obs_id = 1 + i / 100;
+	rec.img_id = i % 100;
+	char path[100];
+	snprintf (path, sizeof (path), "/images/%05d/%03d.fits", rec.obs_id, rec.img_id);
+	rec.img_path = path;
+	rec.mount_name = "T0";
+	rec.camera_name = "C0";
+	rec.img_temperature = -40;
+	rec.img_exposure = 10;
+	rec.filter_id = i % 3;
+	rec.img_alt = 45;
+	rec.img_az = 180;
+	rec.img_date = 1700000000 + i * 12;
+	rec.img_usec = i % 1000;
+	rec.img_fwhm = 2.5;
+	// every second frame has astrometry
+	if (i % 2)
+	{
+		rec.astrometry = "NAXIS1 2048 NAXIS2 2048 CTYPE1 RA---TAN CTYPE2 DEC--TAN CRPIX1 1024.000000 CRPIX2 1024.000000 "
+			"CRVAL1 10.000000 CRVAL2 20.000000 CDELT1 0.000300 CDELT2 0.000300 CROTA 0.000000 EQUINOX 2000.000000";
+		rec.img_err_ra = 0.001;
+		rec.img_err_dec = 0.002;
+		rec.img_err = 0.003;
+	}
+	return rec;
+}
+
+START_TEST(throughput)
+{
+	// frame by frame, as ImageSkyDb::updateDB and updateAstrometry
+	PGconn *conn = fixture_connect ();
+	double t1 = timeNow ();
+	for (int i = 0; i < SINGLE_FRAMES; i++)
+	{
+		ImageRecord r = frame (FRAMES + i);
+		char sql[1000];
+		snprintf (sql, sizeof (sql), "INSERT INTO images (obs_id, img_id, img_path, obs_subtype, mount_name, camera_name, img_temperature, img_exposure, filter_id, img_alt, img_az, img_date, img_usec, med_id, process_bitfield, img_fwhm) "
+			"VALUES (%d, %d, '%s', 'S', 'T0', 'C0', -40, 10, %d, 45, 180, to_timestamp (%.0f), %d, 0, 0, 2.5)", r.obs_id, r.img_id, r.img_path.c_str (), r.filter_id, r.img_date, r.img_usec);
+		PQclear (fixture_sql (conn, sql));
+		if (!r.astrometry.empty ())
+		{
+			snprintf (sql, sizeof (sql), "UPDATE images SET astrometry = '%s', img_err_ra = 0.001, img_err_dec = 0.002, img_err = 0.003, process_bitfield = process_bitfield | 1 | 2 WHERE obs_id = %d AND img_id = %d", r.astrometry.c_str (), r.obs_id, r.img_id);
+			PQclear (fixture_sql (conn, sql));
+		}
+	}
+	double single = (timeNow () - t1) / SINGLE_FRAMES;
+	PQclear (fixture_sql (conn, "DELETE FROM images"));
+	PQfinish (conn);
+
+	ImageQueue q;
+	ck_assert_int_eq (q.start (conninfo.c_str (), NULL, NULL, journal, 0.5), 0);
+
+	t1 = timeNow ();
+	for (int i = 0; i < FRAMES; i++)
+		ck_assert_int_eq (q.add (frame (i)), 0);
+	ck_assert_int_eq (q.flush (), 0);
+	double batched = (timeNow () - t1) / FRAMES;
+
+	printf ("%d frames: %.1f frames/s in %lu transactions, %lu statements; %.1f frames/s frame by frame\n", FRAMES, 1 / batched, q.getTransactions (), q.getStatements (), 1 / single);
+
+	ck_assert_int_eq (q.getWritten (), FRAMES);
+	ck_assert (q.getTransactions () < FRAMES / 100);
+	ck_assert_int_eq (q.queued (), 0);
+
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images"), FRAMES);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE astrometry IS NOT NULL AND process_bitfield = 3"), FRAMES / 2);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE astrometry IS NULL AND img_err IS NULL AND process_bitfield = 0"), FRAMES / 2);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE img_date = to_timestamp (1700000000 + 12 * ((obs_id - 1) * 100 + img_id))::timestamp"), FRAMES);
+
+	q.stop ();
+
+	// journal was deleted
+	ck_assert (access ((std::string (journal) + ".0").c_str (), F_OK) != 0);
+	ck_assert (1 / batched > 5 / single);
+}
+END_TEST
+
+START_TEST(visibility)
+{
+	ImageQueue q;
+	ck_assert_int_eq (q.start (conninfo.c_str (), NULL, NULL, journal, 0.2), 0);
+
+	for (int i = 0; i < 5; i++)
+	{
+		double t1 = timeNow ();
+		ck_assert_int_eq (q.add (frame (i)), 0);
+		while (query_int ("SELECT count (*) FROM images") <= i)
+		{
+			ck_assert (timeNow () - t1 < 2);
+			usleep (10000);
+		}
+		double visible = timeNow () - t1;
+		printf ("frame visible after %.3f s\n", visible);
+		ck_assert (visible >= 0.15);
+	}
+
+	q.stop ();
+}
+END_TEST
+
+START_TEST(merge)
+{
+	ImageQueue q;
+	ck_assert_int_eq (q.start (conninfo.c_str (), NULL, NULL, journal, 10), 0);
+
+	// image 1 with astrometry, then saved again without astrometry and renamed
+	ImageRecord r = frame (1);
+	ck_assert_int_eq (q.add (r), 0);
+	r = frame (1);
+	r.astrometry = "";
+	r.img_fwhm = 3;
+	ck_assert_int_eq (q.add (r), 0);
+	ImageRecord p;
+	p.full = false;
+	p.obs_id = r.obs_id;
+	p.img_id = r.img_id;
+	p.img_path = "/archive/1.fits";
+	ck_assert_int_eq (q.add (p), 0);
+
+	// image 2 without astrometry
+	ck_assert_int_eq (q.add (frame (2)), 0);
+
+	ck_assert_int_eq (q.flush (), 0);
+	ck_assert_int_eq (q.getTransactions (), 1);
+	ck_assert_int_eq (q.getWritten (), 2);
+
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE img_id = 1 AND img_path = '/archive/1.fits' AND img_fwhm = 3 AND astrometry IS NOT NULL AND process_bitfield = 3"), 1);
+
+	// rename of image already in database, and update which does not clear astrometry
+	p.img_path = "/trash/1.fits";
+	ck_assert_int_eq (q.add (p), 0);
+	r = frame (2);
+	r.img_path = "/trash/2.fits";
+	ck_assert_int_eq (q.add (r), 0);
+	ck_assert_int_eq (q.flush (), 0);
+
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE img_id = 1 AND img_path = '/trash/1.fits' AND astrometry IS NOT NULL"), 1);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE img_id = 2 AND img_path = '/trash/2.fits' AND astrometry IS NULL"), 1);
+
+	q.stop ();
+}
+END_TEST
+
+START_TEST(journal_replay)
+{
+	// process crashes before records are written
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		ImageQueue cq;
+		cq.start (conninfo.c_str (), NULL, NULL, journal, 100);
+		for (int i = 0; i < 100; i++)
+			cq.add (frame (i));
+		_exit (0);
+	}
+	int status;
+	waitpid (child, &status, 0);
+
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images"), 0);
+
+	// database is not available - records are kept in journal
+	ImageQueue *q = new ImageQueue ();
+	ck_assert_int_eq (q->start ("host=127.0.0.1 port=1 connect_timeout=1", NULL, NULL, journal, 0.1), 0);
+	ck_assert_int_eq (q->queued (), 100);
+	for (int i = 100; i < 200; i++)
+		ck_assert_int_eq (q->add (frame (i)), 0);
+	// waiting for the records is bounded
+	ck_assert_int_eq (q->flush (0), -2);
+	ck_assert_int_eq (q->flush (), -1);
+	ck_assert_int_eq (q->queued (), 200);
+	delete q;
+
+	// image processed by other process in the meantime
+	PGconn *conn = fixture_connect ();
+	PQclear (fixture_sql (conn, "INSERT INTO images (obs_id, img_id, img_path, filter_id, process_bitfield) VALUES (1, 5, '/archive/5.fits', 7, 3)"));
+	PQfinish (conn);
+
+	// records are replayed on start
+	q = new ImageQueue ();
+	ck_assert_int_eq (q->start (conninfo.c_str (), NULL, NULL, journal, 0.1), 0);
+	ck_assert_int_eq (q->flush (), 0);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images"), 200);
+	// replay does not overwrite newer row
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images WHERE obs_id = 1 AND img_id = 5 AND img_path = '/archive/5.fits' AND filter_id = 7 AND process_bitfield = 3"), 1);
+	delete q;
+
+	// nothing is replayed again
+	q = new ImageQueue ();
+	ck_assert_int_eq (q->start (conninfo.c_str (), NULL, NULL, journal, 0.1), 0);
+	ck_assert_int_eq (q->queued (), 0);
+	delete q;
+}
+END_TEST
+
+START_TEST(bad_record)
+{
+	ImageQueue q;
+	ck_assert_int_eq (q.start (conninfo.c_str (), NULL, NULL, journal, 10), 0);
+
+	for (int i = 0; i < 10; i++)
+	{
+		ImageRecord r = frame (i);
+		// too long for the column
+		if (i == 5)
+			r.mount_name = "too long mount name";
+		ck_assert_int_eq (q.add (r), 0);
+	}
+	ck_assert_int_eq (q.flush (), 0);
+	ck_assert_int_eq (query_int ("SELECT count (*) FROM images"), 9);
+
+	q.stop ();
+}
+END_TEST
+
+START_TEST(record_string)
+{
+	ImageRecord r = frame (3);
+	r.img_path = "/with\ttab\\and\nnewline";
+	r.img_temperature = NAN;
+	ImageRecord p;
+	ck_assert (p.parse (r.toString ()));
+	ck_assert (p.full);
+	ck_assert_int_eq (p.obs_id, r.obs_id);
+	ck_assert_int_eq (p.img_id, r.img_id);
+	ck_assert (p.img_path == r.img_path);
+	ck_assert (std::isnan (p.img_temperature));
+	ck_assert_dbl_eq (p.img_date, r.img_date, 10e-6);
+	ck_assert (p.astrometry == r.astrometry);
+	ck_assert_dbl_eq (p.img_err, r.img_err, 10e-10);
+
+	// incomplete line
+	ck_assert (!p.parse (r.toString ().substr (0, 40)));
+}
+END_TEST
+
+Suite * imagequeue_suite (void)
+{
+	Suite *s;
+	TCase *tc_imagequeue;
+
+	s = suite_create ("Image queue");
+	tc_imagequeue = tcase_create ("Batched registration");
+
+	tcase_add_checked_fixture (tc_imagequeue, setup_db, teardown_db);
+	tcase_set_timeout (tc_imagequeue, 300);
+	tcase_add_test (tc_imagequeue, throughput);
+	tcase_add_test (tc_imagequeue, visibility);
+	tcase_add_test (tc_imagequeue, merge);
+	tcase_add_test (tc_imagequeue, journal_replay);
+	tcase_add_test (tc_imagequeue, bad_record);
+	tcase_add_test (tc_imagequeue, record_string);
+	suite_add_tcase (s, tc_imagequeue);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	const char *db = getenv ("RTS2_CHECK_DB");
+	if (db == NULL)
+	{
+		printf ("RTS2_CHECK_DB is not set, skipping database tests\n");
+		// automake skipped test
+		return 77;
+	}
+	dbname = db;
+	if (dbname.find ('=') == std::string::npos)
+		dbname = "dbname=" + dbname;
+
+	s = imagequeue_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
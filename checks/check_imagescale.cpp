@@ -0,0 +1,303 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "imghdr.h"
+#include "rts2fits/imagescale.h"
+#include "rts2fits/pixelhistogram.h"
+
+#include <math.h>
+
+// enough pixels to be split among threads
+#define NPIX    300000
+
+using namespace rts2image;
+
+PixelScaler *scaler;
+
+void setup_imagescale (void)
+{
+	scaler = new PixelScaler (1000, 3000, SCALING_LINEAR, RTS2_DATA_BYTE);
+}
+
+void teardown_imagescale (void)
+{
+	delete scaler;
+}
+
+// scaling formula of the original per-pixel implementation
+static uint8_t reference (double p, double smin, double smax)
+{
+	if (p < smin)
+		return 0;
+	if (p > smax)
+		return 255;
+	return (uint8_t) (255 * (p - smin) / (smax - smin));
+}
+
+START_TEST(linear)
+{
+	uint16_t *d16 = new uint16_t[NPIX];
+	uint32_t *d32 = new uint32_t[NPIX];
+	float *df = new float[NPIX];
+	for (int i = 0; i < NPIX; i++)
+	{
+		d16[i] = (i * 7) % 4096;
+		d32[i] = d16[i];
+		df[i] = d16[i] + 0.5;
+	}
+
+	uint8_t *out = new uint8_t[NPIX];
+
+	// lookup table
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, d16, out, NPIX));
+	for (int i = 0; i < NPIX; i++)
+		ck_assert_int_eq (out[i], reference (d16[i], 1000, 3000));
+
+	// direct computation
+	memset (out, 0, NPIX);
+	ck_assert (scaler->scale (RTS2_DATA_ULONG, d32, out, NPIX));
+	for (int i = 0; i < NPIX; i++)
+		ck_assert_int_eq (out[i], reference (d32[i], 1000, 3000));
+
+	ck_assert (scaler->scale (RTS2_DATA_FLOAT, df, out, NPIX));
+	for (int i = 0; i < NPIX; i++)
+		ck_assert_int_eq (out[i], reference (df[i], 1000, 3000));
+
+	// 16 bit output
+	uint16_t *o16 = new uint16_t[NPIX];
+	scaler->setNewType (RTS2_DATA_USHORT);
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, d16, o16, NPIX));
+	ck_assert_int_eq (o16[0], 0);
+	ck_assert_int_eq (o16[2000 / 7 + 1], (uint16_t) (65535.0 * (((2000 / 7 + 1) * 7) - 1000) / 2000));
+	ck_assert_int_eq (o16[3500 / 7], 65535);
+
+	// unsupported output type
+	scaler->setNewType (RTS2_DATA_LONG);
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, d16, o16, NPIX) == false);
+
+	delete[] o16;
+	delete[] out;
+	delete[] df;
+	delete[] d32;
+	delete[] d16;
+}
+END_TEST
+
+START_TEST(threads)
+{
+	uint16_t *data = new uint16_t[NPIX];
+	for (int i = 0; i < NPIX; i++)
+		data[i] = random ();
+
+	uint8_t *single = new uint8_t[NPIX];
+	uint8_t *multi = new uint8_t[NPIX];
+
+	scaler->setScaling (SCALING_SQRT);
+	scaler->setThreads (1);
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, data, single, NPIX));
+	scaler->setThreads (4);
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, data, multi, NPIX));
+	ck_assert (memcmp (single, multi, NPIX) == 0);
+
+	// in place, output overlaps input of other threads
+	ck_assert (scaler->scale (RTS2_DATA_USHORT, data, data, NPIX));
+	ck_assert (memcmp (single, data, NPIX) == 0);
+
+	delete[] multi;
+	delete[] single;
+	delete[] data;
+}
+END_TEST
+
+START_TEST(nonlinear)
+{
+	int32_t data[5] = {0, 1000, 1500, 3000, 5000};
+	uint8_t out[5];
+
+	scaler->setScaling (SCALING_SQRT);
+	ck_assert (scaler->scale (RTS2_DATA_LONG, data, out, 5));
+	ck_assert_int_eq (out[0], 0);
+	ck_assert_int_eq (out[1], 0);
+	ck_assert_int_eq (out[2], 127);
+	ck_assert_int_eq (out[3], 255);
+	ck_assert_int_eq (out[4], 255);
+
+	scaler->setScaling (SCALING_POW);
+	ck_assert (scaler->scale (RTS2_DATA_LONG, data, out, 5));
+	ck_assert_int_eq (out[1], 0);
+	ck_assert_int_eq (out[2], 15);
+	ck_assert_int_eq (out[3], 255);
+
+	scaler->setScaling (SCALING_LOG);
+	ck_assert (scaler->scale (RTS2_DATA_LONG, data, out, 5));
+	ck_assert_int_eq (out[1], 0);
+	// log (251) / log (1001) * 255
+	ck_assert_int_eq (out[2], 203);
+	ck_assert_int_eq (out[3], 255);
+
+	// lookup table is rebuild for new scaling
+	int16_t sd[3] = {-100, 1500, 3000};
+	ck_assert (scaler->scale (RTS2_DATA_SHORT, sd, out, 3));
+	ck_assert_int_eq (out[0], 0);
+	ck_assert_int_eq (out[1], 203);
+	ck_assert_int_eq (out[2], 255);
+}
+END_TEST
+
+START_TEST(nonfinite)
+{
+	float data[6] = {NAN, 2000, INFINITY, -INFINITY, -NAN, 500};
+	uint8_t out[6];
+
+	ck_assert (scaler->scale (RTS2_DATA_FLOAT, data, out, 6));
+	ck_assert_int_eq (out[0], 0);
+	ck_assert_int_eq (out[1], 127);
+	ck_assert_int_eq (out[2], 255);
+	ck_assert_int_eq (out[3], 0);
+	ck_assert_int_eq (out[4], 0);
+	ck_assert_int_eq (out[5], 0);
+
+	double dd[3] = {NAN, 3000, -NAN};
+	scaler->setScaling (SCALING_SQRT);
+	ck_assert (scaler->scale (RTS2_DATA_DOUBLE, dd, out, 3));
+	ck_assert_int_eq (out[0], 0);
+	ck_assert_int_eq (out[1], 255);
+	ck_assert_int_eq (out[2], 0);
+}
+END_TEST
+
+START_TEST(quantiles)
+{
+	uint16_t *data = new uint16_t[10000];
+	float *fdata = new float[10000];
+	for (int i = 0; i < 10000; i++)
+	{
+		data[i] = 9999 - i;
+		fdata[i] = i;
+	}
+
+	ck_assert (scaler->setQuantileLimits (RTS2_DATA_USHORT, data, 10000, 0.25));
+	ck_assert_dbl_eq (scaler->getMin (), 2500, 10e-5);
+	ck_assert_dbl_eq (scaler->getMax (), 7500, 10e-5);
+
+	ck_assert (scaler->setQuantileLimits (RTS2_DATA_FLOAT, fdata, 10000, 0.25));
+	ck_assert_dbl_eq (scaler->getMin (), 2499, 10e-5);
+	ck_assert_dbl_eq (scaler->getMax (), 7499, 10e-5);
+
+	ck_assert (scaler->setQuantileLimits (0, data, 10000, 0.01) == false);
+
+	delete[] fdata;
+	delete[] data;
+}
+END_TEST
+
+START_TEST(histogram)
+{
+	int16_t *data = new int16_t[NPIX];
+	for (int i = 0; i < NPIX; i++)
+		data[i] = (i % 2000) - 1000;
+
+	PixelHistogram hist (RTS2_DATA_SHORT);
+	ck_assert (hist.add (data, NPIX));
+	ck_assert (hist.isExact ());
+	ck_assert_int_eq (hist.getCount (), NPIX);
+	ck_assert_dbl_eq (hist.getMin (), -1000, 10e-5);
+	ck_assert_dbl_eq (hist.getMax (), 999, 10e-5);
+	ck_assert_dbl_eq (hist.quantile (0), -1000, 10e-5);
+	ck_assert_dbl_eq (hist.quantile (0.5), 0, 10e-5);
+	ck_assert_dbl_eq (hist.quantile (0.01), -980, 10e-5);
+	ck_assert_dbl_eq (hist.quantile (1), 999, 10e-5);
+
+	// chunks give the same histogram
+	PixelHistogram chunks (RTS2_DATA_SHORT);
+	chunks.setThreads (3);
+	ck_assert (chunks.add (data, 1000));
+	ck_assert (chunks.add (data + 1000, NPIX - 1000));
+	ck_assert_int_eq (chunks.getCount (), NPIX);
+	for (size_t i = 0; i < hist.getBins (); i++)
+		ck_assert_int_eq (chunks.getBin (i), hist.getBin (i));
+
+	PixelHistogram unknown (0);
+	ck_assert (unknown.add (data, NPIX) == false);
+	ck_assert (isnan (unknown.quantile (0.5)));
+
+	delete[] data;
+}
+END_TEST
+
+START_TEST(sketch)
+{
+	// more values than the sketch holds, with NaNs
+	size_t n = 3000000;
+	float *data = new float[n];
+	srandom (1);
+	for (size_t i = 0; i < n; i++)
+		data[i] = (i % 1000 == 7) ? NAN : (random () % 1000000) / 10.0;
+
+	PixelHistogram hist (RTS2_DATA_FLOAT);
+	// add in uneven chunks
+	size_t p = 0;
+	for (size_t c = 1; p < n; c *= 3)
+	{
+		size_t l = c < n - p ? c : n - p;
+		ck_assert (hist.add (data + p, l));
+		p += l;
+	}
+	ck_assert (hist.isExact () == false);
+	ck_assert_int_eq (hist.getCount (), n - n / 1000);
+	ck_assert (hist.getSampleSize () < n / 10);
+	ck_assert (hist.getSampleSize () > 100000);
+
+	// uniform distribution, 0 - 100000
+	ck_assert_dbl_eq (hist.quantile (0.01), 1000, 300);
+	ck_assert_dbl_eq (hist.quantile (0.5), 50000, 300);
+	ck_assert_dbl_eq (hist.quantile (0.99), 99000, 300);
+	ck_assert_dbl_eq (hist.quantile (0), hist.getMin (), 10e-5);
+	ck_assert (hist.getMin () >= 0 && hist.getMin () < 1);
+
+	// scaler uses histogram quantiles
+	scaler->setQuantileLimits (hist, 0.01);
+	ck_assert_dbl_eq (scaler->getMin (), hist.quantile (0.01), 10e-5);
+	ck_assert_dbl_eq (scaler->getMax (), hist.quantile (0.99), 10e-5);
+
+	delete[] data;
+}
+END_TEST
+
+Suite * imagescale_suite (void)
+{
+	Suite *s;
+	TCase *tc_imagescale;
+
+	s = suite_create ("ImageScale");
+	tc_imagescale = tcase_create ("Scaling of image pixels");
+
+	tcase_add_checked_fixture (tc_imagescale, setup_imagescale, teardown_imagescale);
+	tcase_add_test (tc_imagescale, linear);
+	tcase_add_test (tc_imagescale, threads);
+	tcase_add_test (tc_imagescale, nonlinear);
+	tcase_add_test (tc_imagescale, nonfinite);
+	tcase_add_test (tc_imagescale, quantiles);
+	tcase_add_test (tc_imagescale, histogram);
+	tcase_add_test (tc_imagescale, sketch);
+	suite_add_tcase (s, tc_imagescale);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = imagescale_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
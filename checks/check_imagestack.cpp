@@ -0,0 +1,160 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "rts2fits/imagestack.h"
+
+#define NFRAMES   11
+#define NPIX      5000
+
+float *frames[NFRAMES];
+float out[NPIX];
+
+void setup_imagestack (void)
+{
+	// frame f has value 100 + f in all pixels; pixel 10 has hot outlier in frame 3
+	for (int f = 0; f < NFRAMES; f++)
+	{
+		frames[f] = new float[NPIX];
+		for (int p = 0; p < NPIX; p++)
+			frames[f][p] = 100 + f;
+	}
+	frames[3][10] = 10000;
+	// pixel 20 is NaN in all but two frames
+	for (int f = 2; f < NFRAMES; f++)
+		frames[f][20] = NAN;
+	memset (out, 0, sizeof (out));
+}
+
+void teardown_imagestack (void)
+{
+	for (int f = 0; f < NFRAMES; f++)
+		delete[] frames[f];
+}
+
+START_TEST(median)
+{
+	rts2image::StackCombiner sc (rts2image::STACK_MEDIAN);
+	sc.combine (frames, NFRAMES, NPIX, out);
+	ck_assert_dbl_eq (out[0], 105, 1e-6);
+	ck_assert_dbl_eq (out[NPIX - 1], 105, 1e-6);
+	// outlier replaced 103, median moves by one rank
+	ck_assert_dbl_eq (out[10], 106, 1e-6);
+	// median of 100 and 101
+	ck_assert_dbl_eq (out[20], 100.5, 1e-6);
+
+	// even number of frames
+	sc.combine (frames, 4, NPIX, out);
+	ck_assert_dbl_eq (out[0], 101.5, 1e-6);
+}
+END_TEST
+
+START_TEST(mean)
+{
+	rts2image::StackCombiner sc (rts2image::STACK_MEAN);
+	sc.combine (frames, NFRAMES, NPIX, out);
+	ck_assert_dbl_eq (out[0], 105, 1e-6);
+	ck_assert_dbl_eq (out[10], (105 * NFRAMES - 103 + 10000) / (double) NFRAMES, 1e-3);
+	ck_assert_dbl_eq (out[20], 100.5, 1e-6);
+}
+END_TEST
+
+START_TEST(sigmaclip)
+{
+	rts2image::StackCombiner sc (rts2image::STACK_SIGMACLIP);
+	sc.setSigmaClip (3, 3, 3);
+	sc.combine (frames, NFRAMES, NPIX, out);
+	ck_assert_dbl_eq (out[0], 105, 1e-6);
+	// outlier rejected, mean of the others
+	ck_assert_dbl_eq (out[10], (105 * NFRAMES - 103) / (double) (NFRAMES - 1), 1e-3);
+	ck_assert_dbl_eq (out[20], 100.5, 1e-6);
+}
+END_TEST
+
+START_TEST(minmax)
+{
+	rts2image::StackCombiner sc (rts2image::STACK_MINMAX);
+	sc.setMinMax (1, 1);
+	sc.combine (frames, NFRAMES, NPIX, out);
+	ck_assert_dbl_eq (out[0], 105, 1e-6);
+	// 100 and 10000 rejected
+	ck_assert_dbl_eq (out[10], (105 * NFRAMES - 103 - 100) / (double) (NFRAMES - 2), 1e-3);
+	// not enough values to reject
+	ck_assert_dbl_eq (out[20], 100.5, 1e-6);
+}
+END_TEST
+
+START_TEST(threads)
+{
+	// the same results for different number of threads
+	float out1[NPIX];
+	rts2image::stackMethod_t methods[] = {rts2image::STACK_MEAN, rts2image::STACK_MEDIAN, rts2image::STACK_SIGMACLIP, rts2image::STACK_MINMAX};
+	for (int p = 0; p < NPIX; p++)
+		frames[p % NFRAMES][p] = p;
+
+	for (int m = 0; m < 4; m++)
+	{
+		rts2image::StackCombiner sc (methods[m]);
+		sc.setThreads (1);
+		sc.combine (frames, NFRAMES, NPIX, out1);
+		for (int t = 2; t < 9; t += 3)
+		{
+			sc.setThreads (t);
+			sc.combine (frames, NFRAMES, NPIX, out);
+			ck_assert (memcmp (out, out1, sizeof (out)) == 0);
+		}
+	}
+}
+END_TEST
+
+START_TEST(names)
+{
+	rts2image::stackMethod_t m;
+	rts2image::stackScale_t s;
+	ck_assert_int_eq (rts2image::stackMethodFromString ("sigclip", m), 0);
+	ck_assert_int_eq (m, rts2image::STACK_SIGMACLIP);
+	ck_assert_str_eq (rts2image::stackMethodName (m), "sigclip");
+	ck_assert_int_eq (rts2image::stackMethodFromString ("foo", m), -1);
+	ck_assert_int_eq (rts2image::stackScaleFromString ("max", s), 0);
+	ck_assert_int_eq (s, rts2image::STACK_SCALE_MAX);
+	ck_assert_int_eq (rts2image::stackScaleFromString (NULL, s), 0);
+	ck_assert_int_eq (s, rts2image::STACK_SCALE_NONE);
+}
+END_TEST
+
+Suite * imagestack_suite (void)
+{
+	Suite *s;
+	TCase *tc_imagestack;
+
+	s = suite_create ("ImageStack");
+	tc_imagestack = tcase_create ("Stack combine methods");
+
+	tcase_add_checked_fixture (tc_imagestack, setup_imagestack, teardown_imagestack);
+	tcase_add_test (tc_imagestack, median);
+	tcase_add_test (tc_imagestack, mean);
+	tcase_add_test (tc_imagestack, sigmaclip);
+	tcase_add_test (tc_imagestack, minmax);
+	tcase_add_test (tc_imagestack, threads);
+	tcase_add_test (tc_imagestack, names);
+	suite_add_tcase (s, tc_imagestack);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = imagestack_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
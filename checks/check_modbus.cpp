@@ -0,0 +1,253 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "connection/modbus.h"
+#include "modbusstandin.h"
+
+// Zelio register map
+#define ZREG_J1XT1       16
+#define ZREG_O1XT1       20
+#define ZREG_O3XT1       22
+#define ZREG_O4XT1       23
+
+// simulated network round trip time
+#define LATENCY          0.005
+
+ModbusStandIn *server;
+rts2core::ConnModbusTCP *conn;
+
+static double now ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static rts2core::ConnModbusTCP *connectStandIn (ModbusStandIn *s)
+{
+	int port = s->start ();
+	if (port < 0)
+		return NULL;
+	rts2core::ConnModbusTCP *c = new rts2core::ConnModbusTCP (NULL, "127.0.0.1", port);
+	c->setReconnectTime (0);
+	c->init ();
+	return c;
+}
+
+void setup_modbus (void)
+{
+	server = new ModbusStandIn (LATENCY);
+	conn = connectStandIn (server);
+}
+
+void teardown_modbus (void)
+{
+	delete conn;
+	delete server;
+}
+
+// status poll of Zelio dome - info, isGoodWeather and isOpened calls
+static void zelioPoll (rts2core::ConnModbus *c, rts2core::ModbusScanner *scanner)
+{
+	uint16_t regs[8];
+	if (scanner)
+	{
+		scanner->readHoldingRegisters (ZREG_J1XT1, 8, regs);
+		scanner->readHoldingRegisters (ZREG_O4XT1, 1, regs);
+		scanner->readHoldingRegisters (ZREG_O3XT1, 1, regs);
+		scanner->readHoldingRegisters (ZREG_O1XT1, 2, regs);
+	}
+	else
+	{
+		c->readHoldingRegisters (0, ZREG_J1XT1, 8, regs);
+		c->readHoldingRegisters (0, ZREG_O4XT1, 1, regs);
+		c->readHoldingRegisters (0, ZREG_O3XT1, 1, regs);
+		c->readHoldingRegisters (0, ZREG_O1XT1, 2, regs);
+	}
+}
+
+START_TEST(blocks)
+{
+	ck_assert_msg (conn != NULL, "cannot start Modbus stand-in server");
+
+	rts2core::ModbusScanner scanner (conn, 0, 4);
+	scanner.addRegisters (16, 8, 10);
+	// gap of 3 registers, merged to the first block
+	scanner.addRegisters (27, 1, 10);
+	scanner.addRegisters (40, 1, 10);
+	scanner.addRegisters (100, 2, 10);
+
+	scanner.scan ();
+	ck_assert_int_eq (server->getTransactions (), 3);
+	ck_assert_int_eq (scanner.getBlockReads (), 3);
+
+	uint16_t regs[8];
+	scanner.readHoldingRegisters (16, 8, regs);
+	for (int i = 0; i < 8; i++)
+		ck_assert_int_eq (regs[i], 16 + i);
+	scanner.readHoldingRegisters (27, 1, regs);
+	ck_assert_int_eq (regs[0], 27);
+	scanner.readHoldingRegisters (100, 2, regs);
+	ck_assert_int_eq (regs[0], 100);
+	ck_assert_int_eq (regs[1], 101);
+
+	// all values are fresh
+	scanner.scan ();
+	ck_assert_int_eq (server->getTransactions (), 3);
+
+	scanner.scan (true);
+	ck_assert_int_eq (server->getTransactions (), 6);
+
+	// registers outside of the map are read directly
+	scanner.readHoldingRegisters (50, 2, regs);
+	ck_assert_int_eq (regs[0], 50);
+	ck_assert_int_eq (server->getTransactions (), 7);
+}
+END_TEST
+
+START_TEST(zelio_poll)
+{
+	rts2core::ModbusScanner scanner (conn, 0);
+	scanner.addRegisters (ZREG_J1XT1, 4, 2.0);
+	scanner.addRegisters (ZREG_O1XT1, 4, 0.5);
+
+	double t = now ();
+	zelioPoll (conn, NULL);
+	double direct = now () - t;
+	unsigned long directTransactions = server->getTransactions ();
+
+	server->resetTransactions ();
+	t = now ();
+	zelioPoll (conn, &scanner);
+	double scanned = now () - t;
+
+	printf ("Zelio poll: direct %lu transactions %.1f ms, scanned %lu transactions %.1f ms\n", directTransactions, direct * 1000, server->getTransactions (), scanned * 1000);
+
+	ck_assert_int_eq (directTransactions, 4);
+	ck_assert_int_eq (server->getTransactions (), 1);
+	ck_assert (scanned < direct);
+}
+END_TEST
+
+START_TEST(staleness)
+{
+	uint16_t reg;
+	rts2core::ModbusScanner scanner (conn, 0);
+	scanner.addRegisters (ZREG_J1XT1, 4, 10);
+	scanner.addRegisters (ZREG_O1XT1, 4, 0.05);
+
+	zelioPoll (conn, &scanner);
+	zelioPoll (conn, &scanner);
+	ck_assert_int_eq (server->getTransactions (), 1);
+
+	// only outputs are read again
+	usleep (100000);
+	server->registers[ZREG_O4XT1] = 0x1234;
+	zelioPoll (conn, &scanner);
+	ck_assert_int_eq (server->getTransactions (), 2);
+	scanner.readHoldingRegisters (ZREG_O4XT1, 1, &reg);
+	ck_assert_int_eq (reg, 0x1234);
+
+	// writes invalidate cached values
+	scanner.writeHoldingRegister (ZREG_J1XT1, 0x0f0f);
+	ck_assert_int_eq (server->registers[ZREG_J1XT1], 0x0f0f);
+	scanner.readHoldingRegisters (ZREG_J1XT1, 1, &reg);
+	ck_assert_int_eq (reg, 0x0f0f);
+
+	scanner.writeHoldingRegisterMask (ZREG_J1XT1, 0x00ff, 0x0001);
+	scanner.readHoldingRegisters (ZREG_J1XT1, 1, &reg);
+	ck_assert_int_eq (reg, 0x0f01);
+}
+END_TEST
+
+START_TEST(pipelined)
+{
+	ModbusStandIn slow (0.02);
+	rts2core::ConnModbusTCP *c = connectStandIn (&slow);
+	ck_assert_msg (c != NULL, "cannot start Modbus stand-in server");
+
+	int16_t starts[4] = {0, 50, 100, 150};
+	int16_t qtys[4] = {2, 2, 2, 2};
+	uint16_t data[4][2];
+	uint16_t *replies[4] = {data[0], data[1], data[2], data[3]};
+
+	double t = now ();
+	c->readHoldingRegisters (0, 4, starts, qtys, replies);
+	double inflight = now () - t;
+	for (int i = 0; i < 4; i++)
+		ck_assert_int_eq (data[i][1], starts[i] + 1);
+
+	c->setMaxInFlight (1);
+	t = now ();
+	c->readHoldingRegisters (0, 4, starts, qtys, replies);
+	double sequential = now () - t;
+
+	printf ("4 blocks with 20 ms latency: pipelined %.1f ms, sequential %.1f ms\n", inflight * 1000, sequential * 1000);
+	ck_assert_int_eq (slow.getTransactions (), 8);
+	ck_assert (inflight * 2 < sequential);
+
+	delete c;
+}
+END_TEST
+
+START_TEST(exception)
+{
+	int16_t starts[2] = {0, 250};
+	int16_t qtys[2] = {2, 10};
+	uint16_t data[2][10];
+	uint16_t *replies[2] = {data[0], data[1]};
+
+	bool thrown = false;
+	try
+	{
+		conn->readHoldingRegisters (0, 2, starts, qtys, replies);
+	}
+	catch (rts2core::ModbusError &er)
+	{
+		thrown = true;
+	}
+	ck_assert (thrown);
+
+	// errors close the connection, it can be opened again
+	conn->init ();
+	qtys[1] = 2;
+	conn->readHoldingRegisters (0, 2, starts, qtys, replies);
+	ck_assert_int_eq (data[1][0], 250);
+}
+END_TEST
+
+Suite * modbus_suite (void)
+{
+	Suite *s;
+	TCase *tc_modbus;
+
+	s = suite_create ("Modbus");
+	tc_modbus = tcase_create ("Register scanner");
+
+	tcase_add_checked_fixture (tc_modbus, setup_modbus, teardown_modbus);
+	tcase_add_test (tc_modbus, blocks);
+	tcase_add_test (tc_modbus, zelio_poll);
+	tcase_add_test (tc_modbus, staleness);
+	tcase_add_test (tc_modbus, pipelined);
+	tcase_add_test (tc_modbus, exception);
+	suite_add_tcase (s, tc_modbus);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = modbus_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+
+#include "block.h"
+#include "nameindex.h"
+
+class TestBlock:public rts2core::Block
+{
+	public:
+		TestBlock ():rts2core::Block (0, NULL) {}
+		virtual int run () { return 0; }
+
+		rts2core::Connection *addDevice (const char *name)
+		{
+			rts2core::Connection *conn = new rts2core::Connection (this);
+			conn->setName (-1, name);
+			getConnections ()->push_back (conn);
+			connectionsChanged ();
+			return conn;
+		}
+
+	protected:
+		virtual rts2core::Connection *createClientConnection (rts2core::NetworkAddress * in_addr) { return NULL; }
+};
+
+TestBlock *block;
+
+void setup_block (void)
+{
+	block = new TestBlock ();
+}
+
+void teardown_block (void)
+{
+	delete block;
+}
+
+START_TEST(hash_index)
+{
+	int a, b, c;
+	rts2core::NameIndex <int, true> caseless;
+	rts2core::NameIndex <int, false> exact;
+
+	ck_assert (caseless.find ("a") == NULL);
+	ck_assert (caseless.add ("temp", &a));
+	ck_assert (caseless.add ("hum", &b));
+	ck_assert (!caseless.add ("TEMP", &c));
+	ck_assert (caseless.find ("Temp") == &a);
+	ck_assert (caseless.find ("hum") == &b);
+	ck_assert (caseless.find ("press") == NULL);
+	ck_assert_int_eq (caseless.size (), 2);
+
+	ck_assert (exact.add ("C0", &a));
+	ck_assert (exact.add ("c0", &b));
+	ck_assert (exact.find ("C0") == &a);
+	ck_assert (exact.find ("c0") == &b);
+
+	// force several rehashes
+	char name[20];
+	int vals[1000];
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf (name, 20, "v%d", i);
+		ck_assert (exact.add (name, vals + i));
+	}
+	for (int i = 0; i < 1000; i++)
+	{
+		snprintf (name, 20, "v%d", i);
+		ck_assert (exact.find (name) == vals + i);
+	}
+	ck_assert_int_eq (exact.size (), 1002);
+
+	exact.clear ();
+	ck_assert (exact.find ("C0") == NULL);
+	ck_assert_int_eq (exact.size (), 0);
+}
+END_TEST
+
+START_TEST(multi_index)
+{
+	int a, b, c, d;
+	rts2core::NameMultiIndex <int, true> multi;
+
+	ck_assert (multi.find ("temp") == NULL);
+	multi.add ("temp", &a);
+	multi.add ("hum", &b);
+	multi.add ("TEMP", &c);
+	for (int i = 0; i < 100; i++)
+		multi.add ("Temp", &d);
+
+	// objects are kept in order of addition
+	std::vector <int *> *t = multi.find ("temp");
+	ck_assert (t != NULL);
+	ck_assert_int_eq (t->size (), 102);
+	ck_assert ((*t)[0] == &a);
+	ck_assert ((*t)[1] == &c);
+	ck_assert ((*t)[101] == &d);
+	ck_assert_int_eq (multi.find ("HUM")->size (), 1);
+	ck_assert (multi.find ("press") == NULL);
+
+	multi.clear ();
+	ck_assert (multi.find ("temp") == NULL);
+}
+END_TEST
+
+START_TEST(values)
+{
+	rts2core::Connection *conn = block->addDevice ("C0");
+	conn->metaInfo (RTS2_VALUE_DOUBLE, "temp", "temperature");
+	conn->metaInfo (RTS2_VALUE_INTEGER, "count", "counter");
+
+	rts2core::Value *temp = conn->getValue ("temp");
+	ck_assert (temp != NULL);
+	ck_assert_str_eq (temp->getName ().c_str (), "temp");
+	// value names are case insensitive
+	ck_assert (conn->getValue ("TEMP") == temp);
+	ck_assert (conn->getValue ("hum") == NULL);
+	ck_assert (block->getValue ("C0", "count") == conn->getValue ("count"));
+
+	// value is replaced with new type
+	conn->metaInfo (RTS2_VALUE_STRING, "temp", "temperature");
+	ck_assert (conn->getValue ("temp") != NULL);
+	ck_assert_int_eq (conn->getValue ("temp")->getValueType (), RTS2_VALUE_STRING);
+	ck_assert (conn->getValue ("count") != NULL);
+
+	ck_assert (block->getMinConn ("count") == conn);
+	ck_assert (block->getMinConn ("hum") == NULL);
+}
+END_TEST
+
+START_TEST(connections)
+{
+	rts2core::Connection *c1 = block->addDevice ("C1");
+	rts2core::Connection *c2 = block->addDevice ("C2");
+
+	ck_assert (block->getOpenConnection ("C1") == c1);
+	ck_assert (block->findName ("C2") == c2);
+	// device names are case sensitive
+	ck_assert (block->getOpenConnection ("c1") == NULL);
+
+	// first connection with the name is found
+	rts2core::Connection *c3 = block->addDevice ("C1");
+	ck_assert (block->getOpenConnection ("C1") == c1);
+
+	c3->setName (-1, "C3");
+	ck_assert (block->getOpenConnection ("C3") == c3);
+
+	block->removeConnection (c1);
+	delete c1;
+	ck_assert (block->getOpenConnection ("C1") == NULL);
+	ck_assert (block->getOpenConnection ("C2") == c2);
+}
+END_TEST
+
+Suite * nameindex_suite (void)
+{
+	Suite *s;
+	TCase *tc_nameindex;
+
+	s = suite_create ("NameIndex");
+	tc_nameindex = tcase_create ("Hashed lookups");
+
+	tcase_add_checked_fixture (tc_nameindex, setup_block, teardown_block);
+	tcase_add_test (tc_nameindex, hash_index);
+	tcase_add_test (tc_nameindex, multi_index);
+	tcase_add_test (tc_nameindex, values);
+	tcase_add_test (tc_nameindex, connections);
+	suite_add_tcase (s, tc_nameindex);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = nameindex_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,259 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <sstream>
+
+#include "rts2db/pgpool.h"
+#include "rts2db/imageset.h"
+#include "rts2db/observationset.h"
+
+/*
+ * Runs against local PostgreSQL database, specified in RTS2_CHECK_DB
+ * environment variable (for example "dbname=rts2check"). Fixture tables are
+ * created in check_pgpool schema, which is dropped at the end. Test is
+ * skipped if the variable is not set.
+ */
+
+#define TARGETS         20
+#define OBSERVATIONS    10
+#define IMAGES          10
+#define THREADS         8
+#define POOL_SIZE       3
+
+std::string dbname;
+
+void fixture_sql (const char *sql)
+{
+	PGconn *conn = PQconnectdb (dbname.c_str ());
+	ck_assert (PQstatus (conn) == CONNECTION_OK);
+	PGresult *res = PQexec (conn, sql);
+	if (PQresultStatus (res) != PGRES_COMMAND_OK)
+		fprintf (stderr, "%s: %s\n", sql, PQresultErrorMessage (res));
+	ck_assert (PQresultStatus (res) == PGRES_COMMAND_OK);
+	PQclear (res);
+	PQfinish (conn);
+}
+
+void setup_db (void)
+{
+	char sql[2000];
+	snprintf (sql, sizeof (sql),
+		"DROP SCHEMA IF EXISTS check_pgpool CASCADE;"
+		"CREATE SCHEMA check_pgpool;"
+		"SET search_path TO check_pgpool;"
+		"CREATE TABLE targets (tar_id integer PRIMARY KEY, tar_name varchar(150), type_id char(1));"
+		"CREATE TABLE observations (obs_id integer PRIMARY KEY, tar_id integer, obs_ra float8, obs_dec float8, obs_alt float8, obs_az float8, obs_slew timestamp, obs_start timestamp, obs_state integer, obs_end timestamp, plan_id integer);"
+		"CREATE TABLE filters (filter_id integer PRIMARY KEY, standart_name varchar(50));"
+		"CREATE TABLE images (img_id integer, obs_id integer, obs_subtype char(1), img_date timestamp, img_usec integer, img_exposure float4, img_temperature float4, filter_id integer, img_alt float4, img_az float4, camera_name varchar(50), mount_name varchar(50), delete_flag boolean, process_bitfield integer, img_err_ra float8, img_err_dec float8, img_err float8, img_path varchar(100));"
+		"INSERT INTO filters VALUES (0, 'B'), (1, 'V'), (2, 'R');"
+		"INSERT INTO targets SELECT i, 'target ' || i, 'O' FROM generate_series (1, %d) AS i;"
+		"INSERT INTO observations SELECT i, 1 + i %% %d, 10, 20, 45, 180, to_timestamp (1700000000 + i * 600), to_timestamp (1700000010 + i * 600), 2, to_timestamp (1700000500 + i * 600), NULL FROM generate_series (1, %d) AS i;"
+		"INSERT INTO images SELECT i, 1 + i / %d, 'S', to_timestamp (1700000000 + i * 60), 0, 10, NULL, i %% 3, 45, 180, 'C0', 'T0', false, 0, NULL, NULL, NULL, NULL FROM generate_series (%d, %d) AS i;",
+		TARGETS, TARGETS, TARGETS * OBSERVATIONS, IMAGES, 0, TARGETS * OBSERVATIONS * IMAGES - 1);
+	fixture_sql (sql);
+
+	rts2db::ConnectionPool::instance ()->setDatabase ((dbname + " options='-csearch_path=check_pgpool'").c_str (), NULL, NULL, POOL_SIZE);
+	rts2db::ConnectionPool::instance ()->resetStats ();
+}
+
+void teardown_db (void)
+{
+	rts2db::ConnectionPool::instance ()->disconnect ();
+	fixture_sql ("DROP SCHEMA check_pgpool CASCADE;");
+}
+
+// round trips of loading rows with FETCH next cursor - PREPARE, OPEN, FETCH for every row and final FETCH, CLOSE and COMMIT
+unsigned long cursorTrips (unsigned long calls, unsigned long rows)
+{
+	return calls * 5 + rows;
+}
+
+void printStats (const char *name, int calls)
+{
+	rts2db::PgStats s = rts2db::ConnectionPool::instance ()->getStats ();
+	printf ("%-28s %4d calls %6lu rows: %3lu prepares %4lu executes %4lu round trips, %6lu with FETCH next cursor\n", name, calls, s.rows, s.prepares, s.executes, s.roundTrips, cursorTrips (calls, s.rows));
+}
+
+START_TEST(observations_target)
+{
+	for (int t = 1; t <= TARGETS; t++)
+	{
+		rts2db::ObservationSet os;
+		os.loadTarget (t);
+		ck_assert_int_eq (os.size (), OBSERVATIONS);
+		ck_assert_int_eq (os.getSuccess (), OBSERVATIONS);
+		ck_assert_int_eq (os[0].getTargetId (), t);
+	}
+
+	printStats ("ObservationSet::loadTarget", TARGETS);
+
+	rts2db::PgStats s = rts2db::ConnectionPool::instance ()->getStats ();
+	// statement is prepared once, and then executed
+	ck_assert_int_eq (s.prepares, 1);
+	ck_assert_int_eq (s.executes, TARGETS);
+	ck_assert_int_eq (s.cached, TARGETS - 1);
+	ck_assert_int_eq (s.roundTrips, TARGETS + 1);
+	ck_assert_int_eq (s.rows, TARGETS * OBSERVATIONS);
+
+	// time constrained query is different statement
+	rts2db::ConnectionPool::instance ()->resetStats ();
+	time_t from = 1700000000;
+	time_t to = from + 600 * TARGETS * OBSERVATIONS / 2;
+	for (int t = 1; t <= TARGETS; t++)
+	{
+		rts2db::ObservationSet os;
+		os.loadTarget (t, &from, &to);
+		ck_assert (os.size () > 0);
+		ck_assert (os.size () <= OBSERVATIONS);
+	}
+	s = rts2db::ConnectionPool::instance ()->getStats ();
+	ck_assert_int_eq (s.prepares, 1);
+	ck_assert_int_eq (s.roundTrips, TARGETS + 1);
+}
+END_TEST
+
+START_TEST(images_target)
+{
+	for (int t = 1; t <= TARGETS; t++)
+	{
+		rts2db::ImageSetTarget is (t);
+		ck_assert_int_eq (is.load (), 0);
+		ck_assert_int_eq (is.size (), OBSERVATIONS * IMAGES);
+		ck_assert_int_eq (is.getAllStat ().count, OBSERVATIONS * IMAGES);
+		for (int f = 0; f < 3; f++)
+			ck_assert ((*(is.getStat (f))).count > 0);
+		// filter names are loaded with images
+		ck_assert (strlen ((*(is.begin ()))->getFilter ()) == 1);
+	}
+
+	printStats ("ImageSetTarget::load", TARGETS);
+
+	rts2db::PgStats s = rts2db::ConnectionPool::instance ()->getStats ();
+	ck_assert_int_eq (s.prepares, 1);
+	ck_assert_int_eq (s.roundTrips, TARGETS + 1);
+	ck_assert_int_eq (s.rows, TARGETS * OBSERVATIONS * IMAGES);
+
+	rts2db::ConnectionPool::instance ()->resetStats ();
+	for (int i = 0; i < TARGETS; i++)
+	{
+		rts2db::ImageSetDate is (1700000000 + i * 6000, 1700000000 + (i + 1) * 6000);
+		ck_assert_int_eq (is.load (), 0);
+	}
+	printStats ("ImageSetDate::load", TARGETS);
+	s = rts2db::ConnectionPool::instance ()->getStats ();
+	ck_assert_int_eq (s.prepares, 1);
+}
+END_TEST
+
+START_TEST(literal)
+{
+	for (int t = 1; t <= TARGETS; t++)
+	{
+		std::ostringstream _os;
+		_os << "SELECT tar_name FROM targets WHERE tar_id = " << t << ";";
+
+		rts2db::PooledConnection conn;
+		rts2db::PgResult res (conn->execute (_os.str ().c_str ()));
+		ck_assert_int_eq (res.rows (), 1);
+		// SQL with values written in is not kept prepared
+		ck_assert_int_eq (conn->preparedStatements (), 0);
+	}
+
+	rts2db::PgStats s = rts2db::ConnectionPool::instance ()->getStats ();
+	ck_assert_int_eq (s.prepares, 0);
+	ck_assert_int_eq (s.executes, TARGETS);
+	ck_assert_int_eq (s.roundTrips, TARGETS);
+}
+END_TEST
+
+void *loadThread (void *arg)
+{
+	int *failed = (int *) arg;
+	for (int i = 0; i < 50; i++)
+	{
+		int t = 1 + (i * 7 + *failed) % TARGETS;
+		rts2db::ObservationSet os;
+		os.loadTarget (t);
+		if (os.size () != OBSERVATIONS || os[0].getTargetId () != t)
+			(*failed) += 1000;
+	}
+	return NULL;
+}
+
+START_TEST(pool_threads)
+{
+	pthread_t threads[THREADS];
+	int failed[THREADS];
+
+	struct timeval tv1, tv2;
+	gettimeofday (&tv1, NULL);
+
+	for (int i = 0; i < THREADS; i++)
+	{
+		failed[i] = i;
+		pthread_create (threads + i, NULL, loadThread, failed + i);
+	}
+	for (int i = 0; i < THREADS; i++)
+	{
+		pthread_join (threads[i], NULL);
+		ck_assert_int_eq (failed[i], i);
+	}
+
+	gettimeofday (&tv2, NULL);
+
+	printStats ("ObservationSet, threads", THREADS * 50);
+	printf ("%d threads, %d connections in %.3f s\n", THREADS, rts2db::ConnectionPool::instance ()->getOpenConnections (), (tv2.tv_sec - tv1.tv_sec) + (tv2.tv_usec - tv1.tv_usec) / 1e6);
+
+	// connections are shared, each prepared the statement once
+	ck_assert (rts2db::ConnectionPool::instance ()->getOpenConnections () <= POOL_SIZE);
+	rts2db::PgStats s = rts2db::ConnectionPool::instance ()->getStats ();
+	ck_assert (s.prepares <= POOL_SIZE);
+	ck_assert_int_eq (s.executes, THREADS * 50);
+}
+END_TEST
+
+Suite * pgpool_suite (void)
+{
+	Suite *s;
+	TCase *tc_pgpool;
+
+	s = suite_create ("Database connection pool");
+	tc_pgpool = tcase_create ("Loaders");
+
+	tcase_add_checked_fixture (tc_pgpool, setup_db, teardown_db);
+	tcase_set_timeout (tc_pgpool, 60);
+	tcase_add_test (tc_pgpool, observations_target);
+	tcase_add_test (tc_pgpool, images_target);
+	tcase_add_test (tc_pgpool, literal);
+	tcase_add_test (tc_pgpool, pool_threads);
+	suite_add_tcase (s, tc_pgpool);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	const char *db = getenv ("RTS2_CHECK_DB");
+	if (db == NULL)
+	{
+		printf ("RTS2_CHECK_DB is not set, skipping database tests\n");
+		// automake skipped test
+		return 77;
+	}
+	dbname = db;
+	if (dbname.find ('=') == std::string::npos)
+		dbname = "dbname=" + dbname;
+
+	s = pgpool_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,232 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "photstream.h"
+
+// 2 kHz stream for 2 seconds, ring holds only small part of the stream
+#define RATE         2000
+#define SAMPLES      4000
+#define BATCH        100
+
+rts2phot::SampleRing *ring = NULL;
+
+void setup_photstream (void)
+{
+	ring = new rts2phot::SampleRing (2 * BATCH);
+}
+
+void teardown_photstream (void)
+{
+	delete ring;
+}
+
+// produces samples at RATE with the clock used by photometer drivers, count is the sample sequence number
+class Generator:public rts2phot::SampleClock
+{
+	public:
+		Generator () { stop = false; }
+
+		volatile bool stop;
+
+	protected:
+		virtual bool sample (const struct timeval *tv)
+		{
+			rts2phot::PhotSample s ((uint64_t) tv->tv_sec * 1000000 + tv->tv_usec, ring->getPushed (), 1.0 / RATE, 1, false);
+			return ring->push (s) || ring->getPushed () < SAMPLES;
+		}
+};
+
+void *generator (void *arg)
+{
+	Generator *g = (Generator *) arg;
+	g->runClock (1.0 / RATE, g->stop);
+	return NULL;
+}
+
+static double cpuTime ()
+{
+	struct rusage ru;
+	getrusage (RUSAGE_SELF, &ru);
+	return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1000000.0;
+}
+
+START_TEST(pack)
+{
+	std::vector <rts2phot::PhotSample> samples;
+	samples.push_back (rts2phot::PhotSample (1500000000123456ULL, 4000000000U, 0.001, 3, false));
+	samples.push_back (rts2phot::PhotSample (1500000000124456ULL, 12, 0.001, -1, true));
+	samples[0].seq = 1ULL << 33;
+	samples[1].seq = (1ULL << 33) + 1;
+
+	char buf[rts2phot::batchSize (2)];
+	ck_assert_int_eq (rts2phot::packSamples (samples, buf), 56);
+
+	std::vector <rts2phot::PhotSample> out;
+	ck_assert_int_eq (rts2phot::unpackSamples (buf, sizeof (buf), out), 2);
+	ck_assert (out[0].seq == 1ULL << 33);
+	ck_assert (out[1].seq == (1ULL << 33) + 1);
+	ck_assert (out[0].usec == 1500000000123456ULL);
+	ck_assert (out[0].count == 4000000000U);
+	ck_assert_int_eq (out[1].count, 12);
+	ck_assert_dbl_eq (out[0].exp, 0.001, 1e-9);
+	ck_assert_int_eq (out[0].filter, 3);
+	ck_assert_int_eq (out[1].filter, -1);
+	ck_assert (!out[0].overflow);
+	ck_assert (out[1].overflow);
+	ck_assert_dbl_eq (out[1].getTime (), 1500000000.124456, 1e-6);
+
+	// truncated batch
+	out.clear ();
+	ck_assert_int_eq (rts2phot::unpackSamples (buf, sizeof (buf) - 1, out), -1);
+	ck_assert_int_eq (rts2phot::unpackSamples (buf, 10, out), -1);
+	ck_assert_int_eq (out.size (), 0);
+}
+END_TEST
+
+START_TEST(overrun)
+{
+	rts2phot::SampleRing small (4);
+	rts2phot::PhotSample s (0, 0, 1, 0, false);
+	for (int i = 0; i < 6; i++)
+		ck_assert (small.push (s) == (i < 4));
+	ck_assert_int_eq (small.getPushed (), 6);
+	ck_assert_int_eq (small.getDropped (), 2);
+
+	std::vector <rts2phot::PhotSample> out;
+	ck_assert_int_eq (small.pop (out, 3), 3);
+	ck_assert_int_eq (small.size (), 1);
+	ck_assert (small.push (s));
+	// dropped samples consumed sequence numbers 4 and 5, batch ends before the gap
+	ck_assert_int_eq (small.pop (out, 10), 1);
+	ck_assert_int_eq (out[2].seq, 2);
+	ck_assert_int_eq (out[3].seq, 3);
+	ck_assert_int_eq (small.size (), 1);
+
+	// sequence numbers survive pack/unpack of batches split at the gap
+	std::vector <rts2phot::PhotSample> batch (out.begin () + 3, out.end ());
+	std::vector <rts2phot::PhotSample> received;
+	char buf[rts2phot::batchSize (4)];
+	ck_assert_int_eq (rts2phot::unpackSamples (buf, rts2phot::packSamples (batch, buf), received), 1);
+	ck_assert_int_eq (received[0].seq, 3);
+
+	batch.clear ();
+	ck_assert_int_eq (small.pop (batch, 10), 1);
+	ck_assert_int_eq (small.size (), 0);
+	received.clear ();
+	ck_assert_int_eq (rts2phot::unpackSamples (buf, rts2phot::packSamples (batch, buf), received), 1);
+	ck_assert_int_eq (received[0].seq, 6);
+
+	small.reset (2);
+	ck_assert (!small.isFinished ());
+	ck_assert (small.push (s));
+	ck_assert (small.push (s));
+	// limit reached - not dropped
+	ck_assert (!small.push (s));
+	ck_assert_int_eq (small.getDropped (), 0);
+	ck_assert (!small.isFinished ());
+	out.clear ();
+	ck_assert_int_eq (small.pop (out, 10), 2);
+	ck_assert_int_eq (out[0].seq, 0);
+	ck_assert (small.isFinished ());
+}
+END_TEST
+
+START_TEST(stream)
+{
+	ring->reset (SAMPLES);
+
+	double cpuStart = cpuTime ();
+	struct timeval wallStart, wallEnd;
+	gettimeofday (&wallStart, NULL);
+
+	Generator g;
+	pthread_t gen;
+	ck_assert_int_eq (pthread_create (&gen, NULL, generator, &g), 0);
+
+	uint64_t next = 0;
+	uint64_t received = 0;
+	uint64_t lastUsec = 0;
+	size_t batches = 0;
+	std::vector <rts2phot::PhotSample> batch;
+	char buf[rts2phot::batchSize (BATCH)];
+
+	// consumer sends out batches every 20 ms, as main loop of the daemon
+	while (!ring->isFinished ())
+	{
+		usleep (20000);
+		while (ring->size () > 0)
+		{
+			batch.clear ();
+			ring->pop (batch, BATCH);
+			size_t size = rts2phot::packSamples (batch, buf);
+
+			std::vector <rts2phot::PhotSample> unpacked;
+			ck_assert_int_eq (rts2phot::unpackSamples (buf, size, unpacked), batch.size ());
+			for (std::vector <rts2phot::PhotSample>::iterator iter = unpacked.begin (); iter != unpacked.end (); iter++)
+			{
+				// samples dropped when the consumer is late leave gap in sequence numbers
+				ck_assert (iter->seq >= next);
+				ck_assert (iter->count == iter->seq);
+				ck_assert (iter->usec > lastUsec);
+				lastUsec = iter->usec;
+				next = iter->seq + 1;
+				received++;
+			}
+			batches++;
+		}
+	}
+	pthread_join (gen, NULL);
+
+	gettimeofday (&wallEnd, NULL);
+	double cpu = cpuTime () - cpuStart;
+	double wall = wallEnd.tv_sec - wallStart.tv_sec + (wallEnd.tv_usec - wallStart.tv_usec) / 1000000.0;
+
+	ck_assert_int_eq (ring->getPushed (), SAMPLES);
+	ck_assert_int_eq (received + ring->getDropped (), SAMPLES);
+	ck_assert (wall > 1.5);
+
+	// CPU load depends on the machine, it is reported, not checked
+	printf ("%d samples in %d batches, %d dropped, %.2f s, CPU %.3f s (%.1f %%, %.2f us/sample)\n", SAMPLES, (int) batches, (int) ring->getDropped (), wall, cpu, 100 * cpu / wall, 1000000 * cpu / SAMPLES);
+}
+END_TEST
+
+Suite * photstream_suite (void)
+{
+	Suite *s;
+	TCase *tc_photstream;
+
+	s = suite_create ("PhotStream");
+	tc_photstream = tcase_create ("Photometer samples stream");
+
+	tcase_add_checked_fixture (tc_photstream, setup_photstream, teardown_photstream);
+	tcase_set_timeout (tc_photstream, 10);
+	tcase_add_test (tc_photstream, pack);
+	tcase_add_test (tc_photstream, overrun);
+	tcase_add_test (tc_photstream, stream);
+	suite_add_tcase (s, tc_photstream);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = photstream_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
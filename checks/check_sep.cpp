@@ -433,6 +433,157 @@ START_TEST(SEP1)
 }
 END_TEST
 
+/* star field as generated by the dummy camera in artificial stellar field
+   mode - uniform noise around bias, Gaussian stars at random positions */
+float *
+makestarfield (int w, int h, double sigma)
+{
+	int i, x, y, nstars, rmax;
+	float *im;
+	double xc, yc, amp, s2;
+
+	im = (float *) malloc (w * h * sizeof (float));
+	srand (0);
+	for (i = 0; i < w * h; i++)
+		im[i] = 400 + 300.0 * rand () / RAND_MAX - 150;
+
+	nstars = w * h / 300 / sigma / sigma;
+	rmax = ceil (sigma * 5);
+	s2 = sigma * sigma;
+	for (i = 0; i < nstars; i++)
+	{
+		xc = (double) w * rand () / RAND_MAX;
+		yc = (double) h * rand () / RAND_MAX;
+		/* more faint stars than bright ones */
+		amp = 200000 * pow ((double) rand () / RAND_MAX, 3);
+		for (y = (int) yc - rmax; y <= (int) yc + rmax; y++)
+			for (x = (int) xc - rmax; x <= (int) xc + rmax; x++)
+				if (x >= 0 && x < w && y >= 0 && y < h)
+					im[x + w * y] += amp * exp (-((x - xc) * (x - xc) + (y - yc) * (y - yc)) / (2 * s2)) / 2 / M_PI / s2;
+	}
+	return im;
+}
+
+
+#define CAT_SAME(field, n) (memcmp (c1->field, c2->field, n * sizeof (*c1->field)) == 0)
+
+/* true if catalogs are the same, bit by bit */
+bool
+same_catalog (sep_catalog *c1, sep_catalog *c2)
+{
+	int n = c1->nobj;
+	if (n != c2->nobj)
+		return false;
+	if (!(CAT_SAME (thresh, n) && CAT_SAME (npix, n) && CAT_SAME (tnpix, n)
+		&& CAT_SAME (xmin, n) && CAT_SAME (xmax, n) && CAT_SAME (ymin, n) && CAT_SAME (ymax, n)
+		&& CAT_SAME (x, n) && CAT_SAME (y, n) && CAT_SAME (x2, n) && CAT_SAME (y2, n) && CAT_SAME (xy, n)
+		&& CAT_SAME (errx2, n) && CAT_SAME (erry2, n) && CAT_SAME (errxy, n)
+		&& CAT_SAME (a, n) && CAT_SAME (b, n) && CAT_SAME (theta, n)
+		&& CAT_SAME (cflux, n) && CAT_SAME (flux, n) && CAT_SAME (cpeak, n) && CAT_SAME (peak, n)
+		&& CAT_SAME (xcpeak, n) && CAT_SAME (ycpeak, n) && CAT_SAME (xpeak, n) && CAT_SAME (ypeak, n)
+		&& CAT_SAME (flag, n)))
+		return false;
+	for (int i = 0; i < n; i++)
+		if (memcmp (c1->pix[i], c2->pix[i], c1->npix[i] * sizeof (int)))
+			return false;
+	return true;
+}
+
+
+/* background and sources of the star field with given number of threads */
+void
+extract_threads (float *field, int w, int h, int nthreads, bool matched, sep_bkg **bkg, sep_catalog **catalog)
+{
+	float conv[] = { 1, 2, 1, 2, 4, 2, 1, 2, 1 };
+	uint64_t t0, t1, t2;
+	int status;
+
+	float *data = (float *) malloc (w * h * sizeof (float));
+	memcpy (data, field, w * h * sizeof (float));
+
+	sep_set_nthreads (nthreads);
+
+	sep_image im = { data, NULL, NULL, SEP_TFLOAT, SEP_TFLOAT, SEP_TFLOAT, w, h, 0.0, SEP_NOISE_NONE, 1.0, 0.0 };
+	t0 = gettime_ns ();
+	status = sep_background (&im, 64, 64, 3, 3, 0.0, bkg);
+	ck_assert_int_eq (status, 0);
+	status = sep_bkg_subarray (*bkg, im.data, im.dtype);
+	ck_assert_int_eq (status, 0);
+
+	float *noise = NULL;
+	float *mask = NULL;
+	t1 = gettime_ns ();
+	if (matched)
+	{
+		/* noise map, with mask over the centre of the image */
+		noise = (float *) malloc (w * h * sizeof (float));
+		mask = (float *) calloc (w * h, sizeof (float));
+		sep_bkg_rmsarray (*bkg, noise, SEP_TFLOAT);
+		for (int y = h / 2 - 20; y < h / 2 + 20; y++)
+			for (int x = w / 2 - 20; x < w / 2 + 20; x++)
+				mask[x + w * y] = 1;
+		im.noise = noise;
+		im.mask = mask;
+		im.noise_type = SEP_NOISE_STDDEV;
+		t1 = gettime_ns ();
+		status = sep_extract (&im, 1.5, SEP_THRESH_REL, 5, conv, 3, 3, SEP_FILTER_MATCHED, 32, 0.005, 1, 1.0, catalog);
+	}
+	else
+	{
+		im.noiseval = (*bkg)->globalrms;
+		im.noise_type = SEP_NOISE_STDDEV;
+		status = sep_extract (&im, 1.5, SEP_THRESH_REL, 5, conv, 3, 3, SEP_FILTER_CONV, 32, 0.005, 1, 1.0, catalog);
+	}
+	t2 = gettime_ns ();
+	ck_assert_int_eq (status, 0);
+
+	printf ("%d threads%s: background %6.1f ms, extract %6.1f ms, %d objects\n", nthreads, matched ? " (matched filter)" : "", (t1 - t0) / 1e6, (t2 - t1) / 1e6, (*catalog)->nobj);
+
+	free (data);
+	free (noise);
+	free (mask);
+}
+
+
+START_TEST(SEPthreads)
+{
+	int w = 2048;
+	int h = 2048;
+	float *field = makestarfield (w, h, 3);
+
+	/* objects crossing borders of strips processed by different threads */
+	for (int i = 1; i < 8; i++)
+	{
+		addbox (field, w, h, 200 * i, h * i / 8, 10, 2000);
+		addbox (field, w, h, 200 * i + 100, h * i / 8 - 1, 2, 1000);
+	}
+
+	for (int m = 0; m < 2; m++)
+	{
+		sep_bkg *bkg1, *bkg;
+		sep_catalog *cat1, *cat;
+		extract_threads (field, w, h, 1, m, &bkg1, &cat1);
+		ck_assert_int_gt (cat1->nobj, 500);
+
+		for (int t = 2; t <= 8; t *= 2)
+		{
+			extract_threads (field, w, h, t, m, &bkg, &cat);
+			ck_assert (memcmp (bkg1->back, bkg->back, bkg->n * sizeof (float)) == 0);
+			ck_assert (memcmp (bkg1->sigma, bkg->sigma, bkg->n * sizeof (float)) == 0);
+			ck_assert (memcmp (&(bkg1->globalrms), &(bkg->globalrms), sizeof (float)) == 0);
+			ck_assert (same_catalog (cat1, cat));
+			sep_bkg_free (bkg);
+			sep_catalog_free (cat);
+		}
+		sep_bkg_free (bkg1);
+		sep_catalog_free (cat1);
+	}
+
+	sep_set_nthreads (1);
+	free (field);
+}
+END_TEST
+
 /***************************************************************************/
 /* aperture photometry */
 
@@ -475,6 +626,7 @@ sep_suite (void)
 
 	tcase_add_checked_fixture (tc_sep, setup_sep, teardown_sep);
 	tcase_add_test (tc_sep, SEP1);
+	tcase_add_test (tc_sep, SEPthreads);
 	suite_add_tcase (s, tc_sep);
 
 	return s;
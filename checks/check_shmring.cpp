@@ -0,0 +1,200 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "shmring.h"
+
+#define SLOTS       4
+#define SLOT_SIZE   1024
+
+rts2core::ShmRingWriter *writer = NULL;
+rts2core::ShmRingReader *reader = NULL;
+char *buf = NULL;
+
+void setup_shmring (void)
+{
+	writer = new rts2core::ShmRingWriter ();
+	ck_assert_int_eq (writer->create (NULL, SLOTS, SLOT_SIZE), 0);
+	reader = new rts2core::ShmRingReader ();
+	ck_assert_int_eq (reader->attachFd (writer->getFd ()), 0);
+	buf = new char[SLOT_SIZE];
+}
+
+void teardown_shmring (void)
+{
+	delete reader;
+	delete writer;
+	delete[] buf;
+}
+
+// writes frame filled with its number
+void writeFrame (int f, size_t size = SLOT_SIZE)
+{
+	char *data = writer->beginFrame ();
+	ck_assert (data != NULL);
+	memset (data, f, size);
+	writer->endFrame (size, NULL, f);
+}
+
+START_TEST(every)
+{
+	rts2core::ShmFrameInfo info;
+	ck_assert_int_eq (reader->readNext (buf, info), 0);
+
+	for (int f = 0; f < SLOTS - 1; f++)
+		writeFrame (f, 100 + f);
+
+	for (int f = 0; f < SLOTS - 1; f++)
+	{
+		ck_assert_int_eq (reader->readNext (buf, info), 1);
+		ck_assert_int_eq (info.frame, f);
+		ck_assert_int_eq (info.size, 100 + f);
+		ck_assert_int_eq (info.channels, 1);
+		ck_assert_int_eq (buf[0], f);
+		ck_assert_int_eq (buf[99 + f], f);
+	}
+	ck_assert_int_eq (reader->readNext (buf, info), 0);
+	ck_assert_int_eq (reader->getLost (), 0);
+
+	// overrun - only last SLOTS - 1 frames can be read
+	for (int f = SLOTS - 1; f < SLOTS + 7; f++)
+		writeFrame (f);
+	ck_assert_int_eq (writer->getPublished (), SLOTS + 7);
+
+	for (int f = 8; f < SLOTS + 7; f++)
+	{
+		ck_assert_int_eq (reader->readNext (buf, info), 1);
+		ck_assert_int_eq (info.frame, f);
+		ck_assert_int_eq (buf[SLOT_SIZE - 1], f);
+	}
+	ck_assert_int_eq (reader->getLost (), 8 - (SLOTS - 1));
+	ck_assert_int_eq (reader->readNext (buf, info), 0);
+}
+END_TEST
+
+START_TEST(latest)
+{
+	rts2core::ShmFrameInfo info;
+	ck_assert_int_eq (reader->readLatest (buf, info), 0);
+
+	for (int f = 0; f < 10; f++)
+		writeFrame (f);
+
+	ck_assert_int_eq (reader->readLatest (buf, info), 1);
+	ck_assert_int_eq (info.frame, 9);
+	ck_assert_int_eq (buf[0], 9);
+	ck_assert (info.timestamp == 9);
+	// nothing newer
+	ck_assert_int_eq (reader->readLatest (buf, info), 0);
+
+	writeFrame (10);
+	ck_assert_int_eq (reader->readLatest (buf, info), 1);
+	ck_assert_int_eq (info.frame, 10);
+}
+END_TEST
+
+START_TEST(aborted)
+{
+	rts2core::ShmFrameInfo info;
+	writeFrame (0);
+
+	// frame being written is not visible
+	char *data = writer->beginFrame ();
+	memset (data, 1, SLOT_SIZE);
+	ck_assert (writer->isWriting ());
+	ck_assert_int_eq (reader->readNext (buf, info), 1);
+	ck_assert_int_eq (info.frame, 0);
+	ck_assert_int_eq (reader->readNext (buf, info), 0);
+	ck_assert_int_eq (reader->readLatest (buf, info), 1);
+	ck_assert_int_eq (info.frame, 0);
+
+	writer->abortFrame ();
+	ck_assert (!writer->isWriting ());
+	ck_assert_int_eq (writer->getPublished (), 1);
+
+	// slot is reused by the next frame
+	writeFrame (2);
+	ck_assert_int_eq (reader->readNext (buf, info), 1);
+	ck_assert_int_eq (info.frame, 1);
+	ck_assert_int_eq (buf[0], 2);
+}
+END_TEST
+
+START_TEST(channels)
+{
+	rts2core::ShmFrameInfo info;
+	size_t sizes[3] = {10, 20, 30};
+	struct imghdr hdr;
+	memset (&hdr, 0, sizeof (hdr));
+	hdr.naxes = 2;
+	hdr.channel = 5;
+
+	char *data = writer->beginFrame ();
+	memset (data, 'a', 60);
+	writer->endFrame (3, sizes, &hdr, 12.5);
+
+	ck_assert_int_eq (reader->readNext (buf, info), 1);
+	ck_assert_int_eq (info.channels, 3);
+	ck_assert_int_eq (info.chanSizes[2], 30);
+	ck_assert_int_eq (info.size, 60);
+	ck_assert_int_eq (info.header.naxes, 2);
+	ck_assert_int_eq (info.header.channel, 5);
+	ck_assert (info.timestamp == 12.5);
+}
+END_TEST
+
+START_TEST(named)
+{
+	rts2core::ShmFrameInfo info;
+	rts2core::ShmRingWriter w;
+	ck_assert_int_eq (w.create ("/rts2_check_shmring", 2, 16), 0);
+
+	rts2core::ShmRingReader r;
+	ck_assert_int_eq (r.attach ("/rts2_check_shmring"), 0);
+	ck_assert_int_eq (r.getSlotSize (), 16);
+
+	strcpy (w.beginFrame (), "test");
+	w.endFrame (5, NULL, 1);
+	ck_assert_int_eq (r.readNext (buf, info), 1);
+	ck_assert_str_eq (buf, "test");
+
+	// single slot ring is not allowed
+	ck_assert_int_eq (w.create ("/rts2_check_shmring", 1, 16), -1);
+	ck_assert_int_eq (r.attach ("/rts2_check_shmring"), -1);
+}
+END_TEST
+
+Suite * shmring_suite (void)
+{
+	Suite *s;
+	TCase *tc_shmring;
+
+	s = suite_create ("ShmRing");
+	tc_shmring = tcase_create ("Shared memory frame ring");
+
+	tcase_add_checked_fixture (tc_shmring, setup_shmring, teardown_shmring);
+	tcase_add_test (tc_shmring, every);
+	tcase_add_test (tc_shmring, latest);
+	tcase_add_test (tc_shmring, aborted);
+	tcase_add_test (tc_shmring, channels);
+	tcase_add_test (tc_shmring, named);
+	suite_add_tcase (s, tc_shmring);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = shmring_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
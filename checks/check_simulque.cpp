@@ -0,0 +1,193 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "configuration.h"
+#include "utilsfunc.h"
+#include "rts2db/devicedb.h"
+#include "rts2script/simulque.h"
+
+#define TARGETS    30
+
+/**
+ * Selector device, which is never initialized and so never connects to
+ * the database.
+ */
+class TestDevice:public rts2db::DeviceDb
+{
+	public:
+		TestDevice ():rts2db::DeviceDb (0, NULL, DEVICE_TYPE_SELECTOR, "SEL")
+		{
+			cameras.push_back ("C0");
+		}
+};
+
+/**
+ * Simulation queue with targets created in memory.
+ */
+class TestSimulQueue:public rts2plan::SimulQueue
+{
+	public:
+		TestSimulQueue (rts2db::DeviceDb *master, struct ln_lnlat_posn **_observer, rts2plan::Queues *_queues):rts2plan::SimulQueue (master, "simul", _observer, _queues)
+		{
+			loaded = 0;
+		}
+
+		int loaded;
+
+	protected:
+		virtual rts2db::Target *loadTarget (int tar_id)
+		{
+			loaded++;
+			return createTestTarget (tar_id, *observer);
+		}
+
+	public:
+		static rts2db::Target *createTestTarget (int tar_id, struct ln_lnlat_posn *obs)
+		{
+			struct ln_equ_posn pos;
+			pos.ra = tar_id * 360.0 / TARGETS;
+			pos.dec = -20 + (tar_id * 7) % 80;
+			rts2db::Target *tar = new rts2db::ConstTarget (tar_id, obs, 0, &pos);
+			tar->setTargetName ("test");
+			return tar;
+		}
+};
+
+struct ln_lnlat_posn observer;
+struct ln_lnlat_posn *observerp;
+TestDevice *device;
+rts2plan::Queues *queues;
+
+void setup_simul (void)
+{
+	char cfg[] = "/tmp/check_simulque_XXXXXX";
+	int fd = mkstemp (cfg);
+	ck_assert (fd >= 0);
+	const char *cnt = "[observatory]\nlongitude = 15\nlatitude = 50\naltitude = 500\ntarget_path = /nonexisting\n\n[C0]\nscript = \"E 120 E 120\"\n";
+	ck_assert (write (fd, cnt, strlen (cnt)) == (ssize_t) strlen (cnt));
+	close (fd);
+	ck_assert_int_eq (rts2core::Configuration::instance ()->loadFile (cfg), 0);
+	unlink (cfg);
+
+	observer.lng = 15;
+	observer.lat = 50;
+	observerp = &observer;
+
+	device = new TestDevice ();
+	queues = new rts2plan::Queues ();
+
+	queues->push_back (rts2plan::ExecutorQueue (device, "q0", &observerp, 500, -1));
+	queues->push_back (rts2plan::ExecutorQueue (device, "q1", &observerp, 500, -1));
+
+	for (int i = 1; i <= TARGETS; i++)
+		(*queues)[i % 2].addTarget (TestSimulQueue::createTestTarget (i, observerp), NAN, NAN, -1, -1, NAN, -1, false, false);
+}
+
+void teardown_simul (void)
+{
+	delete queues;
+	delete device;
+}
+
+START_TEST(simulate_night)
+{
+	time_t nstart, nstop;
+	// 2026-01-15 12:00 UT
+	getNight (1768478400, &observer, -10, nstart, nstop);
+	ck_assert (nstart < nstop);
+
+	TestSimulQueue simul (device, &observerp, queues);
+
+	struct timeval tv1, tv2;
+	gettimeofday (&tv1, NULL);
+
+	simul.start (nstart, nstop);
+
+	// every target is loaded only once
+	ck_assert_int_eq (simul.loaded, TARGETS);
+
+	std::vector <double> starts, ends;
+	double st;
+	double p;
+	double last_t = nstart;
+	while (true)
+	{
+		std::vector <double> s, e;
+		p = simul.progress (st, s, e);
+		ck_assert (!std::isnan (p));
+		ck_assert (st >= last_t);
+		last_t = st;
+		starts.insert (starts.end (), s.begin (), s.end ());
+		ends.insert (ends.end (), e.begin (), e.end ());
+		if (p == 2)
+			break;
+		ck_assert (p >= 0 && p <= 1);
+		usleep (1000);
+	}
+
+	gettimeofday (&tv2, NULL);
+
+	ck_assert_dbl_eq (st, nstop, 10e-5);
+	std::vector <double> s, e;
+	ck_assert (std::isnan (simul.progress (st, s, e)));
+
+	// free intervals are paired and ordered
+	ck_assert_int_eq (starts.size (), ends.size ());
+	for (size_t i = 0; i < starts.size (); i++)
+	{
+		ck_assert (starts[i] < ends[i]);
+		if (i > 0)
+			ck_assert (ends[i - 1] <= starts[i]);
+	}
+
+	// some targets were selected, in time order
+	ck_assert (simul.size () > 0);
+	double t = nstart;
+	for (rts2plan::ExecutorQueue::iterator iter = simul.begin (); iter != simul.end (); iter++)
+	{
+		ck_assert (iter->t_start >= t);
+		ck_assert (iter->t_end >= iter->t_start);
+		ck_assert (iter->t_end <= nstop);
+		t = iter->t_end;
+	}
+
+	printf ("simulated %.1f hours night, %d targets, %d entries, %d free intervals in %.3f s\n", (nstop - nstart) / 3600.0, TARGETS, (int) simul.size (), (int) starts.size (), (tv2.tv_sec - tv1.tv_sec) + (tv2.tv_usec - tv1.tv_usec) / 1e6);
+
+	// queue entries were not touched
+	ck_assert_int_eq ((*queues)[0].size () + (*queues)[1].size (), TARGETS);
+}
+END_TEST
+
+Suite * simulque_suite (void)
+{
+	Suite *s;
+	TCase *tc_simulque;
+
+	s = suite_create ("Simulation queue");
+	tc_simulque = tcase_create ("Night simulation");
+
+	tcase_add_checked_fixture (tc_simulque, setup_simul, teardown_simul);
+	tcase_set_timeout (tc_simulque, 300);
+	tcase_add_test (tc_simulque, simulate_night);
+	suite_add_tcase (s, tc_simulque);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = simulque_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,166 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sstream>
+
+#include "rts2json/statedelta.h"
+
+rts2json::StateDelta *sd;
+
+void setup_statedelta (void)
+{
+	sd = new rts2json::StateDelta ();
+}
+
+void teardown_statedelta (void)
+{
+	delete sd;
+}
+
+// set state of two devices, tel value ra is parameter
+static uint32_t update (const char *ra, bool withFocuser = true)
+{
+	sd->beginUpdate ();
+	sd->setMember ("T0", rts2json::SECTION_VALUES, "ra", ra);
+	sd->setMember ("T0", rts2json::SECTION_VALUES, "dec", "20");
+	sd->setMember ("T0", rts2json::SECTION_MINMAX, "ra", "[0,360]");
+	sd->setMember ("T0", rts2json::SECTION_HEADER, "state", "0");
+	if (withFocuser)
+	{
+		sd->setMember ("F0", rts2json::SECTION_VALUES, "pos", "1200");
+		sd->setMember ("F0", rts2json::SECTION_HEADER, "state", "1");
+	}
+	return sd->endUpdate ();
+}
+
+START_TEST(full)
+{
+	ck_assert_int_eq (sd->getSeq (), 0);
+	ck_assert_int_eq (update ("10"), 1);
+
+	std::ostringstream os;
+	sd->full (os);
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"d\":{\"ra\":10,\"dec\":20},\"minmax\":{\"ra\":[0,360]},\"state\":0},\"F0\":{\"d\":{\"pos\":1200},\"minmax\":{},\"state\":1}}");
+
+	// delta without acknowledged state is not possible
+	std::ostringstream ds;
+	ck_assert (sd->delta (ds, 0) == false);
+	ck_assert (ds.str ().empty ());
+}
+END_TEST
+
+START_TEST(delta)
+{
+	ck_assert_int_eq (update ("10"), 1);
+
+	// nothing changed, sequence is not increased
+	ck_assert_int_eq (update ("10"), 1);
+	std::ostringstream os;
+	ck_assert (sd->delta (os, 1));
+	ck_assert_str_eq (os.str ().c_str (), "{}");
+
+	ck_assert_int_eq (update ("11"), 2);
+	ck_assert_int_eq (sd->changedMembers (1), 1);
+	os.str ("");
+	ck_assert (sd->delta (os, 1));
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"d\":{\"ra\":11}}}");
+
+	ck_assert_int_eq (update ("12"), 3);
+	sd->beginUpdate ();
+	sd->setMember ("T0", rts2json::SECTION_VALUES, "ra", "12");
+	sd->setMember ("T0", rts2json::SECTION_VALUES, "dec", "20");
+	sd->setMember ("T0", rts2json::SECTION_MINMAX, "ra", "[0,360]");
+	sd->setMember ("T0", rts2json::SECTION_HEADER, "state", "2");
+	sd->setMember ("F0", rts2json::SECTION_VALUES, "pos", "1200");
+	sd->setMember ("F0", rts2json::SECTION_HEADER, "state", "1");
+	// new value is sent in delta
+	sd->setMember ("F0", rts2json::SECTION_VALUES, "temp", "4.5");
+	ck_assert_int_eq (sd->endUpdate (), 4);
+
+	// delta from older base is cumulative
+	os.str ("");
+	ck_assert (sd->delta (os, 1));
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"d\":{\"ra\":12},\"state\":2},\"F0\":{\"d\":{\"temp\":4.5}}}");
+
+	os.str ("");
+	ck_assert (sd->delta (os, 3));
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"state\":2},\"F0\":{\"d\":{\"temp\":4.5}}}");
+
+	// base from future
+	os.str ("");
+	ck_assert (sd->delta (os, 5) == false);
+}
+END_TEST
+
+START_TEST(removed)
+{
+	ck_assert_int_eq (update ("10"), 1);
+	ck_assert_int_eq (update ("11"), 2);
+
+	// focuser disappeared
+	ck_assert_int_eq (update ("11", false), 3);
+	ck_assert_int_eq (sd->getDevices (), 1);
+
+	std::ostringstream os;
+	ck_assert (sd->delta (os, 2) == false);
+	ck_assert (sd->delta (os, 1) == false);
+	ck_assert (sd->delta (os, 3));
+	ck_assert_str_eq (os.str ().c_str (), "{}");
+
+	os.str ("");
+	sd->full (os);
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"d\":{\"ra\":11,\"dec\":20},\"minmax\":{\"ra\":[0,360]},\"state\":0}}");
+
+	// focuser is back, it is sent in delta
+	ck_assert_int_eq (update ("11"), 4);
+	os.str ("");
+	ck_assert (sd->delta (os, 3));
+	ck_assert_str_eq (os.str ().c_str (), "{\"F0\":{\"d\":{\"pos\":1200},\"state\":1}}");
+
+	// removed value
+	sd->beginUpdate ();
+	sd->setMember ("T0", rts2json::SECTION_VALUES, "ra", "11");
+	sd->setMember ("T0", rts2json::SECTION_MINMAX, "ra", "[0,360]");
+	sd->setMember ("T0", rts2json::SECTION_HEADER, "state", "0");
+	sd->setMember ("F0", rts2json::SECTION_VALUES, "pos", "1200");
+	sd->setMember ("F0", rts2json::SECTION_HEADER, "state", "1");
+	ck_assert_int_eq (sd->endUpdate (), 5);
+	os.str ("");
+	ck_assert (sd->delta (os, 4) == false);
+	os.str ("");
+	sd->full (os);
+	ck_assert_str_eq (os.str ().c_str (), "{\"T0\":{\"d\":{\"ra\":11},\"minmax\":{\"ra\":[0,360]},\"state\":0},\"F0\":{\"d\":{\"pos\":1200},\"minmax\":{},\"state\":1}}");
+}
+END_TEST
+
+Suite * statedelta_suite (void)
+{
+	Suite *s;
+	TCase *tc_statedelta;
+
+	s = suite_create ("StateDelta");
+	tc_statedelta = tcase_create ("Delta encoding of observatory state");
+
+	tcase_add_checked_fixture (tc_statedelta, setup_statedelta, teardown_statedelta);
+	tcase_add_test (tc_statedelta, full);
+	tcase_add_test (tc_statedelta, delta);
+	tcase_add_test (tc_statedelta, removed);
+	suite_add_tcase (s, tc_statedelta);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = statedelta_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
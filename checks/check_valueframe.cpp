@@ -0,0 +1,137 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+
+#include "valueframe.h"
+#include "valuearray.h"
+#include "valuestat.h"
+
+START_TEST(roundtrip)
+{
+	rts2core::ValueVector src;
+	rts2core::ValueVector dst;
+
+	rts2core::ValueDouble *d1 = new rts2core::ValueDouble ("dbl");
+	rts2core::ValueFloat *f1 = new rts2core::ValueFloat ("flt");
+	rts2core::ValueInteger *i1 = new rts2core::ValueInteger ("int");
+	rts2core::ValueLong *l1 = new rts2core::ValueLong ("lng");
+	rts2core::ValueString *s1 = new rts2core::ValueString ("str");
+	rts2core::ValueBool *b1 = new rts2core::ValueBool ("bool");
+	rts2core::DoubleArray *a1 = new rts2core::DoubleArray ("arr");
+	rts2core::IntegerArray *ia1 = new rts2core::IntegerArray ("iarr");
+
+	src.push_back (d1);
+	src.push_back (f1);
+	src.push_back (i1);
+	src.push_back (l1);
+	src.push_back (s1);
+	src.push_back (b1);
+	src.push_back (a1);
+	src.push_back (ia1);
+
+	d1->setValueDouble (1.23456789012345e-7);
+	f1->setValueFloat (-3.5);
+	i1->setValueInteger (-123456);
+	l1->setValueLong (1234567890123L);
+	s1->setValueCharArr ("test string with spaces");
+	b1->setValueBool (true);
+	a1->addValue (1.5);
+	a1->addValue (NAN);
+	a1->addValue (-2e10);
+	ia1->addValue (-1);
+	ia1->addValue (7);
+
+	rts2core::ValueDouble *d2 = new rts2core::ValueDouble ("dbl");
+	rts2core::ValueFloat *f2 = new rts2core::ValueFloat ("flt");
+	rts2core::ValueInteger *i2 = new rts2core::ValueInteger ("int");
+	rts2core::ValueLong *l2 = new rts2core::ValueLong ("lng");
+	rts2core::ValueString *s2 = new rts2core::ValueString ("str");
+	rts2core::ValueBool *b2 = new rts2core::ValueBool ("bool");
+	rts2core::DoubleArray *a2 = new rts2core::DoubleArray ("arr");
+	rts2core::IntegerArray *ia2 = new rts2core::IntegerArray ("iarr");
+
+	// value with type different from sender - must be skipped
+	rts2core::ValueString *s3 = new rts2core::ValueString ("int");
+
+	dst.push_back (d2);
+	dst.push_back (f2);
+	dst.push_back (l2);
+	dst.push_back (s2);
+	dst.push_back (b2);
+	dst.push_back (a2);
+	dst.push_back (ia2);
+	dst.push_back (s3);
+
+	rts2core::ValueFrame frame;
+	for (rts2core::ValueVector::iterator iter = src.begin (); iter != src.end (); iter++)
+		ck_assert (frame.add (*iter));
+	ck_assert_int_eq (frame.getCount (), 8);
+
+	std::vector <rts2core::Value *> updated;
+	ck_assert_int_eq (rts2core::ValueFrame::decode (frame.data (), frame.size (), dst, &updated), 8);
+	ck_assert_int_eq (updated.size (), 7);
+
+	ck_assert (d2->getValueDouble () == d1->getValueDouble ());
+	ck_assert (f2->getValueFloat () == -3.5);
+	ck_assert_int_eq (l2->getValueLong (), 1234567890123L);
+	ck_assert_str_eq (s2->getValue (), "test string with spaces");
+	ck_assert (b2->getValueBool ());
+	ck_assert_int_eq (a2->size (), 3);
+	ck_assert ((*a2)[0] == 1.5);
+	ck_assert (isnan ((*a2)[1]));
+	ck_assert ((*a2)[2] == -2e10);
+	ck_assert_int_eq (ia2->size (), 2);
+	ck_assert_int_eq ((*ia2)[0], -1);
+	ck_assert_int_eq ((*ia2)[1], 7);
+	ck_assert_str_eq (s3->getValue (), "");
+
+	// truncated frame
+	ck_assert_int_eq (rts2core::ValueFrame::decode (frame.data (), frame.size () - 1, dst, NULL), -1);
+
+	frame.clear ();
+	ck_assert (frame.empty ());
+	ck_assert_int_eq (frame.getCount (), 0);
+}
+END_TEST
+
+START_TEST(textonly)
+{
+	rts2core::ValueRaDec radec ("radec");
+	rts2core::ValueDoubleStat stat ("stat");
+
+	rts2core::ValueFrame frame;
+	ck_assert (frame.add (&radec) == false);
+	ck_assert_int_eq (rts2core::ValueFrame::encodingType (&stat), 0);
+	ck_assert (frame.empty ());
+}
+END_TEST
+
+Suite * valueframe_suite (void)
+{
+	Suite *s;
+	TCase *tc_valueframe;
+
+	s = suite_create ("ValueFrame");
+	tc_valueframe = tcase_create ("Binary value frames");
+
+	tcase_add_test (tc_valueframe, roundtrip);
+	tcase_add_test (tc_valueframe, textonly);
+	suite_add_tcase (s, tc_valueframe);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = valueframe_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
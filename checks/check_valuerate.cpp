@@ -0,0 +1,124 @@
+#include <check.h>
+#include <check_utils.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+#include "connection.h"
+
+int fds[2];
+rts2core::Connection *conn = NULL;
+
+void setup_valuerate (void)
+{
+	socketpair (AF_UNIX, SOCK_STREAM, 0, fds);
+	fcntl (fds[1], F_SETFL, O_NONBLOCK);
+	conn = new rts2core::Connection (fds[0], NULL);
+}
+
+void teardown_valuerate (void)
+{
+	delete conn;
+	close (fds[1]);
+}
+
+// returns number of lines received on the other side of the connection
+int receivedLines ()
+{
+	char buf[2000];
+	int lines = 0;
+	ssize_t ret;
+	while ((ret = read (fds[1], buf, sizeof (buf))) > 0)
+	{
+		for (ssize_t i = 0; i < ret; i++)
+			if (buf[i] == '\n')
+				lines++;
+	}
+	return lines;
+}
+
+START_TEST(coalesce)
+{
+	rts2core::ValueDouble v1 ("v1");
+	rts2core::ValueInteger v2 ("v2");
+
+	v1.setValueDouble (1);
+	conn->queValueUpdate (&v1);
+	v2.setValueInteger (1);
+	conn->queValueUpdate (&v2);
+	v1.setValueDouble (2);
+	conn->queValueUpdate (&v1);
+	v1.setValueDouble (3);
+	conn->queValueUpdate (&v1);
+
+	ck_assert_int_eq (conn->getSuppressedUpdates (), 2);
+	ck_assert_int_eq (receivedLines (), 0);
+
+	ck_assert (isnan (conn->flushValueUpdates ()));
+	ck_assert_int_eq (receivedLines (), 2);
+
+	// other message flushes pending values first
+	conn->queValueUpdate (&v1);
+	conn->sendMsg ("T ready");
+	ck_assert_int_eq (receivedLines (), 2);
+}
+END_TEST
+
+START_TEST(ratelimit)
+{
+	rts2core::ValueDouble v1 ("v1");
+	rts2core::ValueDouble v2 ("v2");
+
+	conn->setValueRate (&v1, 0.5);
+
+	conn->queValueUpdate (&v1);
+	conn->queValueUpdate (&v2);
+	ck_assert (isnan (conn->flushValueUpdates ()));
+	ck_assert_int_eq (receivedLines (), 2);
+
+	// v1 is held for 2 seconds, v2 is send
+	conn->queValueUpdate (&v1);
+	conn->queValueUpdate (&v2);
+	double next = conn->flushValueUpdates ();
+	ck_assert (!isnan (next));
+	ck_assert (next > getNow () + 1);
+	ck_assert_int_eq (receivedLines (), 1);
+
+	// rate limit removed, held value is send
+	conn->setValueRate (&v1, 0);
+	ck_assert (isnan (conn->flushValueUpdates ()));
+	ck_assert_int_eq (receivedLines (), 1);
+}
+END_TEST
+
+Suite * valuerate_suite (void)
+{
+	Suite *s;
+	TCase *tc_valuerate;
+
+	s = suite_create ("ValueRate");
+	tc_valuerate = tcase_create ("Coalesced value updates");
+
+	tcase_add_checked_fixture (tc_valuerate, setup_valuerate, teardown_valuerate);
+	tcase_add_test (tc_valuerate, coalesce);
+	tcase_add_test (tc_valuerate, ratelimit);
+	suite_add_tcase (s, tc_valuerate);
+
+	return s;
+}
+
+int main (void)
+{
+	int number_failed;
+	Suite *s;
+	SRunner *sr;
+
+	s = valuerate_suite ();
+	sr = srunner_create (s);
+	srunner_run_all (sr, CK_NORMAL);
+	number_failed = srunner_ntests_failed (sr);
+	srunner_free (sr);
+
+	return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
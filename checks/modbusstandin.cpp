@@ -0,0 +1,197 @@
+#include "modbusstandin.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <deque>
+#include <string>
+
+static double standinNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+ModbusStandIn::ModbusStandIn (double _latency)
+{
+	latency = _latency;
+	listenSock = -1;
+	running = false;
+	transactions = 0;
+	for (int i = 0; i < STANDIN_REGISTERS; i++)
+		registers[i] = i;
+}
+
+ModbusStandIn::~ModbusStandIn ()
+{
+	stop ();
+}
+
+int ModbusStandIn::start ()
+{
+	listenSock = socket (AF_INET, SOCK_STREAM, 0);
+	if (listenSock < 0)
+		return -1;
+	int on = 1;
+	setsockopt (listenSock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof (on));
+
+	struct sockaddr_in addr;
+	memset (&addr, 0, sizeof (addr));
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	addr.sin_port = 0;
+	socklen_t addrlen = sizeof (addr);
+	if (bind (listenSock, (struct sockaddr *) &addr, sizeof (addr)) || listen (listenSock, 1) || getsockname (listenSock, (struct sockaddr *) &addr, &addrlen))
+	{
+		close (listenSock);
+		listenSock = -1;
+		return -1;
+	}
+
+	running = true;
+	if (pthread_create (&thread, NULL, runThread, this))
+	{
+		running = false;
+		return -1;
+	}
+	return ntohs (addr.sin_port);
+}
+
+void ModbusStandIn::stop ()
+{
+	if (!running)
+		return;
+	running = false;
+	pthread_join (thread, NULL);
+	close (listenSock);
+	listenSock = -1;
+}
+
+void *ModbusStandIn::runThread (void *arg)
+{
+	ModbusStandIn *server = (ModbusStandIn *) arg;
+	while (server->running)
+	{
+		struct pollfd pfd;
+		pfd.fd = server->listenSock;
+		pfd.events = POLLIN;
+		if (poll (&pfd, 1, 50) <= 0)
+			continue;
+		int sock = accept (server->listenSock, NULL, NULL);
+		if (sock < 0)
+			continue;
+		server->serve (sock);
+		close (sock);
+	}
+	return NULL;
+}
+
+struct PendingReply
+{
+	double due;
+	std::string data;
+};
+
+void ModbusStandIn::serve (int sock)
+{
+	std::string inbuf;
+	std::deque <PendingReply> pending;
+
+	while (running)
+	{
+		int timeout = 50;
+		if (!pending.empty ())
+		{
+			timeout = (pending.front ().due - standinNow ()) * 1000;
+			if (timeout < 0)
+				timeout = 0;
+		}
+		struct pollfd pfd;
+		pfd.fd = sock;
+		pfd.events = POLLIN;
+		int ret = poll (&pfd, 1, timeout);
+		if (ret > 0)
+		{
+			char buf[1024];
+			ssize_t r = recv (sock, buf, sizeof (buf), 0);
+			if (r <= 0)
+				return;
+			inbuf.append (buf, r);
+			// process all complete frames
+			while (inbuf.length () >= 6)
+			{
+				const unsigned char *f = (const unsigned char *) inbuf.data ();
+				size_t len = 6 + ((f[4] << 8) | f[5]);
+				if (inbuf.length () < len)
+					break;
+				unsigned char reply[300];
+				// transaction and protocol ID are copied from request
+				memcpy (reply, f, 4);
+				size_t rlen = processRequest (f + 6, reply + 6);
+				reply[4] = rlen >> 8;
+				reply[5] = rlen & 0xff;
+				PendingReply p;
+				p.due = standinNow () + latency;
+				p.data = std::string ((char *) reply, rlen + 6);
+				pending.push_back (p);
+				inbuf.erase (0, len);
+				transactions++;
+			}
+		}
+		while (!pending.empty () && pending.front ().due <= standinNow ())
+		{
+			send (sock, pending.front ().data.data (), pending.front ().data.length (), 0);
+			pending.pop_front ();
+		}
+	}
+}
+
+size_t ModbusStandIn::processRequest (const unsigned char *req, unsigned char *reply)
+{
+	reply[0] = req[0];
+	reply[1] = req[1];
+	int start = (req[2] << 8) | req[3];
+	int qty = (req[4] << 8) | req[5];
+	switch (req[1])
+	{
+		case 0x03:
+			if (qty < 1 || qty > 125 || start + qty > STANDIN_REGISTERS)
+				break;
+			reply[2] = qty * 2;
+			for (int i = 0; i < qty; i++)
+			{
+				reply[3 + 2 * i] = registers[start + i] >> 8;
+				reply[4 + 2 * i] = registers[start + i] & 0xff;
+			}
+			return 3 + qty * 2;
+		case 0x06:
+			if (start >= STANDIN_REGISTERS)
+				break;
+			// qty holds the new value
+			registers[start] = qty;
+			memcpy (reply + 2, req + 2, 4);
+			return 6;
+		case 0x10:
+			if (qty < 1 || start + qty > STANDIN_REGISTERS)
+				break;
+			for (int i = 0; i < qty; i++)
+				registers[start + i] = (req[7 + 2 * i] << 8) | req[8 + 2 * i];
+			memcpy (reply + 2, req + 2, 4);
+			return 6;
+		default:
+			// illegal function
+			reply[1] = req[1] | 0x80;
+			reply[2] = 0x01;
+			return 3;
+	}
+	// illegal data address
+	reply[1] = req[1] | 0x80;
+	reply[2] = 0x02;
+	return 3;
+}
@@ -0,0 +1,43 @@
+#include <atomic>
+#include <pthread.h>
+#include <stdint.h>
+
+#define STANDIN_REGISTERS    256
+
+/**
+ * Local Modbus TCP server standing in for a PLC. Serves holding register
+ * reads and writes (functions 3, 6 and 16) from a register array. Replies
+ * are delayed by given latency, requests received in the meantime are
+ * processed, so pipelined transactions overlap as on a real link.
+ */
+class ModbusStandIn
+{
+	public:
+		ModbusStandIn (double _latency = 0);
+		~ModbusStandIn ();
+
+		/**
+		 * Start server thread.
+		 *
+		 * @return port on which server listens, -1 on error
+		 */
+		int start ();
+
+		void stop ();
+
+		unsigned long getTransactions () { return transactions; }
+		void resetTransactions () { transactions = 0; }
+
+		uint16_t registers[STANDIN_REGISTERS];
+
+	private:
+		double latency;
+		int listenSock;
+		pthread_t thread;
+		std::atomic <bool> running;
+		std::atomic <unsigned long> transactions;
+
+		static void *runThread (void *arg);
+		void serve (int sock);
+		size_t processRequest (const unsigned char *req, unsigned char *reply);
+};
@@ -54,6 +54,8 @@
 // protocol specific commands
 /** The command is variable value update. @ingroup RTS2Protocol */
 #define PROTO_VALUE            "V"
+/** The command is followed by binary frame with variable values. @ingroup RTS2Protocol */
+#define PROTO_VALUE_FRAME      "W"
 /** The command set variable value. @ingroup RTS2Protocol */
 #define PROTO_SET_VALUE        "X"
 /** The command is authorization request. @ingroup RTS2Protocol */
@@ -337,6 +339,15 @@ class Block: public App
 		}
 		void oneRunLoop ();
 
+		/**
+		 * Send changed values and value updates batched in binary
+		 * value frames. Called before the event loop waits for new
+		 * events.
+		 *
+		 * @return time when value held by rate limit shall be send, NAN if there is not any
+		 */
+		double flushValueUpdates ();
+
 		/**
 		 * This function is called when device on given connection is ready
 		 * to accept commands.
@@ -521,13 +532,20 @@ class Block: public App
 
 		/**
 		 * Return vector of active connections to devices and clients.
-		 *
+		 * Caller which adds or removes connections must call
+		 * connectionsChanged.
 		 */
 		connections_t* getConnections ()
 		{
 			return &connections;
 		}
 
+		/**
+		 * Returns event loop instrumentation. Loop statistics are
+		 * collected only if instrumentation is enabled (see statsEnabled).
+		 */
+		const LoopStats & getLoopStats () { return loopStats; }
+
 		/**
 		 * Returns list of connected clients.
 		 */
@@ -623,6 +641,27 @@ class Block: public App
 		 */
 		Value *getValueExpression (std::string expression, const char *defaultDevice = NULL);
 
+		/**
+		 * Returns counter of changes in connections and their
+		 * values. Pointers to values obtained with getValue remain
+		 * valid and refer to the same device and value only while
+		 * the counter does not change.
+		 */
+		unsigned long getValuesGeneration () { return valuesGeneration; }
+
+		/**
+		 * Called when connection values change. Invalidates cached
+		 * value pointers.
+		 */
+		void valuesChanged () { valuesGeneration++; }
+
+		/**
+		 * Called when connection is added, removed or renamed.
+		 * Invalidates index of connections by name, as well as cached
+		 * value pointers.
+		 */
+		void connectionsChanged () { connectionIndexValid = false; valuesChanged (); }
+
 		virtual void endRunLoop ()
 		{
 			setEndLoop (true);
@@ -814,6 +853,12 @@ class Block: public App
 		std::map <double, Event*> timers;
 
 		connections_t connections;
+
+		// connections by name, rebuild on first lookup after connections change
+		NameIndex <Connection, false> connectionIndex;
+		bool connectionIndexValid;
+
+		LoopStats loopStats;
 		
 		// vector which holds connections which were recently added - idle loop will move them to connections
 		connections_t connections_added;
@@ -832,6 +877,8 @@ class Block: public App
 		rts2_status_t masterState;
 		Connection *stateMasterConn;
 
+		unsigned long valuesGeneration;
+
 		/**
 		 * Set value error mask.
 		 *
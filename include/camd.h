@@ -25,6 +25,11 @@
 
 #include "scriptdevice.h"
 #include "imghdr.h"
+#include "framering.h"
+#include "shmring.h"
+#include "tsqueue.h"
+
+#include <atomic>
 
 #define MAX_CHIPS  3
 #define MAX_DATA_RETRY 100
@@ -225,6 +230,11 @@ class Camera:public rts2core::ScriptDevice
 
 		virtual int idle ();
 
+		virtual void addPollSocks ();
+		virtual void pollSuccess ();
+
+		virtual void sendMessage (messageType_t in_messageType, const char *in_messageString);
+
 		virtual rts2core::DevClient *createOtherType (rts2core::Connection * conn, int other_device_type);
 		virtual int info ();
 
@@ -276,6 +286,12 @@ class Camera:public rts2core::ScriptDevice
 
 		int camReadout (rts2core::Connection * conn);
 
+		/**
+		 * Body of the readout thread. Calls doReadout for queued
+		 * readouts, until stopReadoutThread is called.
+		 */
+		void runReadoutThread ();
+
 		// focuser functions
 		int setFocuser (int new_set);
 		int getFocPos ();
@@ -466,6 +482,8 @@ class Camera:public rts2core::ScriptDevice
 		 */
 		long getWriteBinaryDataSize ()
 		{
+			if (inReadoutThread ())
+				return readoutBytesLeft (-1);
 			if (currentImageData < 0 && calculateStatistics->getValueInteger () == STATISTIC_ONLY)
 				// end bytes
 				return calculateDataSize;
@@ -481,6 +499,8 @@ class Camera:public rts2core::ScriptDevice
 		 */
 		long getWriteBinaryDataSize (int chan)
 		{
+			if (inReadoutThread ())
+				return readoutBytesLeft (chan);
 			if (currentImageData < 0 && calculateStatistics->getValueInteger () == STATISTIC_ONLY)
 				// end bytes
 				return calculateDataSize;
@@ -652,6 +672,39 @@ class Camera:public rts2core::ScriptDevice
 		 */
 		virtual int doReadout () = 0;
 
+		/**
+		 * Returns true if doReadout can be called from the readout
+		 * thread. Driver which returns true must not touch values,
+		 * connections or other daemon state in doReadout, except by
+		 * calling sendReadoutData, getDataBuffer, getDataTop,
+		 * getWriteBinaryDataSize and logStream, which are safe to call
+		 * from the readout thread. Such driver must also call
+		 * stopReadoutThread in its destructor.
+		 *
+		 * Threaded readout is enabled with --readout-thread option.
+		 * doReadout then runs in the readout thread and fills frames
+		 * from a ring of preallocated buffers, while the main loop
+		 * answers commands and sends filled chunks to the clients.
+		 */
+		virtual bool supportThreadedReadout () { return false; }
+
+		/**
+		 * Stop the readout thread. Running readout is aborted.
+		 */
+		void stopReadoutThread ();
+
+		/**
+		 * Returns true if called from the readout thread.
+		 */
+		bool inReadoutThread () { return readoutThreadStarted && pthread_equal (pthread_self (), readoutThread); }
+
+		/**
+		 * Returns true if readout running in the readout thread was
+		 * aborted. Drivers with long readout loops shall check it
+		 * and return -1 from doReadout.
+		 */
+		bool isReadoutAborted () { return inReadoutThread () && readoutFrame >= 0 && readoutRing.getSequence (readoutFrame) <= readoutAbortSeq.load (); }
+
 		void clearReadout ();
 
 		void setSize (int in_width, int in_height, int in_x, int in_y)
@@ -975,6 +1028,9 @@ class Camera:public rts2core::ScriptDevice
 		 */
 		void updateReadoutSpeed (size_t computedPixels)
 		{
+			// main loop updates readout speed as it sends out chunks
+			if (inReadoutThread ())
+				return;
 			if (!std::isnan (timeReadoutStart))
 			{
 				readoutTime->setValueDouble (getNow () - timeReadoutStart);
@@ -1040,6 +1096,12 @@ class Camera:public rts2core::ScriptDevice
 		int sharedMemNum;
 		rts2core::DataSharedWrite *sharedData;
 
+		// frame ring for local readers, NULL when not enabled by --shm-ring
+		int shmRingSlots;
+		rts2core::ShmRingWriter *shmRing;
+		rts2core::ValueString *shmRingName;
+		rts2core::ValueLong *shmRingFrames;
+
 		// number of exposures camera takes
 		rts2core::ValueLong *exposureNumber;
 		// exposure number inside script
@@ -1354,6 +1416,44 @@ class Camera:public rts2core::ScriptDevice
 		}
 
 		bool lastCareBlock;
+
+		// threaded readout, NULL when not enabled by --readout-thread
+		rts2core::ValueBool *readoutThreaded;
+		rts2core::ValueInteger *readoutRingUsed;
+		int readoutRingFrames;
+
+		rts2core::FrameRing readoutRing;
+		// sequence numbers of readouts for the thread, -1 ends the thread
+		TSQueue <long> readoutJobs;
+		// log messages produced by the readout thread
+		TSQueue <std::pair <messageType_t, std::string> > readoutMessages;
+
+		pthread_t readoutThread;
+		bool readoutThreadStarted;
+		int readoutPipe[2];
+
+		// sequence number of the last readout queued to the thread
+		long readoutSeq;
+		// readouts with sequence number up to this one are aborted
+		std::atomic <long> readoutAbortSeq;
+		// readouts up to this one were killed, their data are dropped
+		long readoutKilledSeq;
+		// readout was queued and its end was not yet processed
+		bool readoutQueued;
+		// sequence number of the last readout which read the whole chip
+		std::atomic <long> readoutReadSeq;
+		// queued readout read the chip, next exposure can start while its data are sent
+		bool readoutChipRead;
+		// sending of data from the ring failed
+		bool readoutFailed;
+		// frame filled by the readout thread
+		int readoutFrame;
+
+		int startReadoutThread ();
+		void notifyReadout ();
+		void processReadoutRing ();
+		void readoutEnded (int ret);
+		long readoutBytesLeft (int chan);
 };
 
 }
@@ -47,6 +47,23 @@
  */
 #define COMMAND_INFO            "info"
 
+/**
+ * Request binary value updates. @ingroup RTS2Command
+ *
+ * Parameter is value frame version. Devices which do not know the command
+ * return error, and the connection keeps text value updates.
+ */
+#define COMMAND_VALUE_FRAMES    "value_frames"
+
+/**
+ * Limit rate of value updates send to the connection. @ingroup RTS2Command
+ *
+ * First parameter is maximal number of updates per second, 0 for unlimited.
+ * If it is followed by value names, the limit applies only to those values,
+ * otherwise it is default limit for all values.
+ */
+#define COMMAND_VALUE_RATE      "value_rate"
+
 
 /**
  * Move command. @ingroup RTS2Command
@@ -421,11 +438,7 @@ class CommandSendKey:public Command
 		CommandSendKey (Block * _master, int _centrald_id, int _centrald_num, int _key);
 		virtual int send ();
 
-		virtual int commandReturnOK (Connection * conn)
-		{
-			connection->setConnState (CONN_AUTH_OK);
-			return -1;
-		}
+		virtual int commandReturnOK (Connection * conn);
 		virtual int commandReturnFailed (int status, Connection * conn)
 		{
 			connection->setConnState (CONN_AUTH_FAILED);
@@ -433,6 +446,17 @@ class CommandSendKey:public Command
 		}
 };
 
+/**
+ * Ask device to send value updates in binary frames.
+ *
+ * @ingroup RTS2Command
+ */
+class CommandValueFrames:public Command
+{
+	public:
+		CommandValueFrames (Block * _master);
+};
+
 /**
  * Send authorization query to centrald daemon.
  *
@@ -775,6 +799,19 @@ class CommandIntegrate:public Command
 		virtual int commandReturnFailed (int status, Connection * conn);
 };
 
+/**
+ * Start burst of photometer integrations. Samples are received over
+ * data channel, see DevClientPhot::addSamples.
+ */
+class CommandBurst:public Command
+{
+	private:
+		DevClientPhot * phot;
+	public:
+		CommandBurst (DevClientPhot * _phot, float _exp, int _count);
+		virtual int commandReturnFailed (int status, Connection * conn);
+};
+
 class CommandExecNext:public Command
 {
 	public:
@@ -808,6 +845,19 @@ class CommandExecGrb:public Command
 		int grb_id;
 };
 
+/**
+ * Pass GRB position to executor before it is stored in the database.
+ * Besides position, it carries time when GCN packet was received and when
+ * it was parsed, so executor can report latency of the alert.
+ *
+ * @ingroup RTS2Command
+ */
+class CommandExecGrbFast:public Command
+{
+	public:
+		CommandExecGrbFast (Block * _master, int _grb_id, double ra, double dec, double errorbox, double t_packet, double t_parse);
+};
+
 class CommandQueueNow:public Command
 {
 	public:
@@ -0,0 +1,206 @@
+/*
+ * Expressions compiled to flat code with bound values.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_COMPILEDEXPRESSION__
+#define __RTS2_COMPILEDEXPRESSION__
+
+#include "expression.h"
+
+#include <string>
+#include <vector>
+
+namespace rts2expression
+{
+
+/**
+ * Device value referenced by device and value name. Pointer to the value
+ * is cached, and looked up again only when connections or values of the
+ * master block change (see rts2core::Block::getValuesGeneration).
+ */
+class ValueBinding
+{
+	public:
+		ValueBinding (const char *_device, const char *_value);
+
+		/**
+		 * Returns value, NULL if device or value does not exist.
+		 */
+		rts2core::Value *getValue (rts2core::Block *master)
+		{
+			if (!bound || generation != master->getValuesGeneration ())
+				bind (master);
+			return value;
+		}
+
+		/**
+		 * True if master is connected to the device. Valid after getValue call.
+		 */
+		bool isConnected () { return connected; }
+
+		const char *getDeviceName () { return deviceName.c_str (); }
+		const char *getValueName () { return valueName.c_str (); }
+
+	private:
+		std::string deviceName;
+		std::string valueName;
+
+		rts2core::Value *value;
+		bool connected;
+		bool bound;
+		unsigned long generation;
+
+		void bind (rts2core::Block *master);
+};
+
+/**
+ * Expression compiled to flat array of instructions for a stack machine.
+ * Device values are referenced through ValueBinding, so names are resolved
+ * only when connections change, not at every evaluation. Constant
+ * subexpressions are folded during compilation, and or/and are
+ * short-circuited.
+ *
+ * Code is build by calling push methods in postfix order, either directly or
+ * through compile methods of Expression and script operands.
+ */
+class CompiledExpression
+{
+	public:
+		CompiledExpression (rts2core::Block *_master);
+
+		/**
+		 * Compile expression tree. Replaces current code.
+		 */
+		void compile (Expression *expression);
+
+		/**
+		 * Evaluate expression.
+		 *
+		 * @throw ExpressionErrorValueMissing when device value is not available
+		 */
+		double evaluate ();
+
+		/**
+		 * Clear code.
+		 */
+		void clear ();
+
+		/**
+		 * Number of instructions.
+		 */
+		size_t size () { return code.size (); }
+
+		/**
+		 * True if expression does not depend on any value.
+		 */
+		bool isConstant (double &val) { return isConstantSince (0, val); }
+
+		/**
+		 * True if code emitted since given position is a single constant.
+		 */
+		bool isConstantSince (size_t pos, double &val);
+
+		/**
+		 * Remove instructions from given position.
+		 */
+		void truncate (size_t pos);
+
+		void pushConst (double val);
+
+		/**
+		 * Push value of device. Value which is missing at connected
+		 * device is evaluated as NAN when nanIfMissing is true, all other
+		 * missing values are errors.
+		 */
+		void pushValue (const char *device, const char *value, bool nanIfMissing = false);
+
+		/**
+		 * Push result of function call. Used for terms which cannot be
+		 * compiled, func is called at every evaluation.
+		 */
+		void pushCall (double (*func) (void *arg), void *arg);
+
+		/**
+		 * Replace two values on top of the stack with result of binary
+		 * operation. OR and AND are not short-circuited, use jump
+		 * instructions for that.
+		 */
+		void pushOp (op_t op);
+
+		/**
+		 * Replace value on top of the stack with 1 if it is not zero, 0 if it is zero.
+		 */
+		void pushBool ();
+
+		/**
+		 * Jump if value on top of the stack is zero and leave it on the
+		 * stack, otherwise remove it from the stack.
+		 *
+		 * @return index of jump instruction, to be passed to setLabel
+		 */
+		size_t jumpIfFalse ();
+
+		/**
+		 * Jump if value on top of the stack is not zero and replace it with
+		 * 1, otherwise remove it from the stack.
+		 */
+		size_t jumpIfTrue ();
+
+		/**
+		 * Set target of jump instruction to the current end of code.
+		 */
+		void setLabel (size_t jump);
+
+	private:
+		typedef enum { I_CONST, I_VALUE, I_CALL, I_OP, I_BOOL, I_JUMP_FALSE, I_JUMP_TRUE } opcode_t;
+
+		struct Instruction
+		{
+			opcode_t opcode;
+			op_t op;
+			// constant value
+			double val;
+			// binding index or jump target
+			size_t arg;
+			double (*func) (void *arg);
+			void *funcArg;
+			bool nanIfMissing;
+		};
+
+		rts2core::Block *master;
+
+		std::vector <Instruction> code;
+		std::vector <ValueBinding> bindings;
+		std::vector <double> stack;
+
+		// instructions before this index cannot be folded, as they are jump targets
+		size_t foldBarrier;
+
+		void push (opcode_t opcode);
+
+		double getValue (const Instruction &ins);
+};
+
+/**
+ * Evaluate binary operation.
+ */
+double evaluateOp (op_t op, double v1, double v2);
+
+}
+
+#endif // !__RTS2_COMPILEDEXPRESSION__
@@ -30,6 +30,7 @@
 #include <string.h>
 #include <time.h>
 #include <list>
+#include <set>
 #include <netinet/in.h>
 
 #include <status.h>
@@ -41,6 +42,9 @@
 #include "message.h"
 #include "logstream.h"
 #include "valuelist.h"
+#include "nameindex.h"
+#include "connstats.h"
+#include "valueframe.h"
 
 #define MAX_DATA    2000
 
@@ -328,11 +332,7 @@ class Connection:public Object
 		int getLocalPort () { return port; }
 		const char *getName () { return name.c_str (); };
 		int isName (const char *in_name) { return (!strcmp (getName (), in_name)); }
-		void setName (int _centrald_num, const char *in_name)
-		{
-			centrald_num = _centrald_num;
-			name = std::string (in_name);
-		}
+		void setName (int _centrald_num, const char *in_name);
 		int getKey () { return key; };
 		virtual void setKey (int in_key)
 		{
@@ -656,6 +656,70 @@ class Connection:public Object
 
 		void setSendAll (bool sa) { sendAll = sa; }
 
+		/**
+		 * Returns connection instrumentation - command round trip
+		 * times, data and buffer sizes.
+		 */
+		const ConnStats & getStats () { return stats; }
+
+		/**
+		 * Enable or disable binary value updates. Enabled when the
+		 * other side requested them with COMMAND_VALUE_FRAMES.
+		 */
+		void setValueFrames (bool vf);
+
+		bool getValueFrames () { return valueFrames; }
+
+		/**
+		 * Send value update. If binary value updates were negotiated
+		 * and value can be encoded, the value is added to pending
+		 * value frame. The frame is send at the end of event loop
+		 * iteration, or before any other message is send over the
+		 * connection. Otherwise the value is send as text.
+		 *
+		 * @param value  value to send
+		 */
+		void sendValueUpdate (Value *value);
+
+		/**
+		 * Send pending value frame.
+		 *
+		 * @return -1 on error, 0 on success or if nothing was pending
+		 */
+		int flushValueFrame ();
+
+		/**
+		 * Mark value as changed. Value will be send at the end of
+		 * the event loop iteration, or before any other message is
+		 * send over the connection. Multiple updates of the same value
+		 * are coalesced, and value is not send more often than the
+		 * rate set with setValueRate.
+		 *
+		 * @param value  changed value
+		 */
+		void queValueUpdate (Value *value);
+
+		/**
+		 * Send changed values, which are not held by rate limit.
+		 *
+		 * @return time when next held value shall be send, NAN if no value is held
+		 */
+		double flushValueUpdates ();
+
+		/**
+		 * Set maximal rate of value updates.
+		 *
+		 * @param value  value which rate will be limited, NULL to set default rate for all values
+		 * @param rate   maximal number of updates per second, 0 for unlimited
+		 */
+		void setValueRate (Value *value, double rate);
+
+		/**
+		 * Returns number of value updates which were coalesced with
+		 * later update of the same value.
+		 */
+		uint64_t getSuppressedUpdates () { return suppressedUpdates; }
+
 	protected:
 		char *buf;
 		size_t buf_size;
@@ -786,6 +850,35 @@ class Connection:public Object
 
 		bool sendAll;	// if true, sendValueAll will send the value to the connection
 
+		ConnStats stats;
+
+		// other side accepts binary value updates
+		bool valueFrames;
+		ValueFrame pendingFrame;
+
+		// changed values waiting to be send
+		std::vector <Value *> dirtyValues;
+		std::set <Value *> dirtySet;
+		bool flushingValues;
+		uint64_t suppressedUpdates;
+
+		// update rate limits
+		double maxValueRate;
+		std::map <Value *, double> valueRates;
+		std::map <Value *, double> valueSent;
+
+		// value frame being received
+		char *inFrame;
+		size_t inFrameSize;
+		size_t inFrameTop;
+
+		/**
+		 * Copy data to frame being received, process it when complete.
+		 *
+		 * @return number of bytes consumed
+		 */
+		size_t addValueFrameData (const char *data, size_t len);
+
 		std::list < Command * > commandQue;
 		Command *runningCommand;
 		enum {WAITING, SEND, RETURNING}
@@ -845,6 +938,14 @@ class Connection:public Object
 		 */
 		ValueVector values;
 
+		// values by name, must be updated when values change
+		NameIndex <Value, true> valueIndex;
+
+		/**
+		 * Rebuild value index from values.
+		 */
+		void indexValues ();
+
 		/**
 		 * Time when last information was received.
 		 */
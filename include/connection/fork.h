@@ -66,6 +66,14 @@ class ConnFork:public ConnNoSend
 
 		void setInput (std::string _input) { input = _input; }
 
+		/**
+		 * Returns number of bytes sent to the process which the process
+		 * has not yet read.
+		 *
+		 * @return number of unread bytes, -1 if it cannot be determined
+		 */
+		int getUnreadInput ();
+
 		virtual int add (Block *block);
 
 		virtual int receive (Block *block);
@@ -19,6 +19,8 @@
 
 #include "tcp.h"
 
+#include <map>
+
 namespace rts2core
 {
 
@@ -121,6 +123,21 @@ class ConnModbus:public ConnNoSend
 		 */
 		void readHoldingRegisters (uint8_t slaveId, int16_t start, int16_t qty, uint16_t *reply_data);
 
+		/**
+		 * Read multiple blocks of holding registers. Default
+		 * implementation reads blocks one after the other,
+		 * connections which can keep multiple transactions in flight
+		 * send requests before waiting for the replies.
+		 *
+		 * @param n          Number of blocks.
+		 * @param starts     Starting addresses of the blocks.
+		 * @param qtys       Quantities of registers in the blocks.
+		 * @param reply_data Arrays for returned data of the blocks.
+		 *
+		 * @throw            ConnError on error.
+		 */
+		virtual void readHoldingRegisters (uint8_t slaveId, int n, const int16_t *starts, const int16_t *qtys, uint16_t **reply_data);
+
 		/**
 		 * Read input registers.
 		 *
@@ -199,11 +216,113 @@ class ConnModbusTCP: public ConnTCP, public ConnModbus
 
 		virtual void setDebug (int d);
 
+		using ConnModbus::readHoldingRegisters;
+
+		/**
+		 * Read multiple blocks of holding registers, keeping up to
+		 * maxInFlight transactions in flight. Replies are matched to
+		 * requests by transaction ID, so they can arrive in any
+		 * order.
+		 */
+		virtual void readHoldingRegisters (uint8_t slaveId, int n, const int16_t *starts, const int16_t *qtys, uint16_t **reply_data);
+
+		/**
+		 * Set maximal number of transactions sent before waiting for
+		 * reply. Some devices accept only a single outstanding
+		 * transaction.
+		 */
+		void setMaxInFlight (int _maxInFlight) { maxInFlight = _maxInFlight > 0 ? _maxInFlight : 1; }
+
 	protected:
 		virtual void exchangeData (const void *modbusPayload, size_t payloadSize, void *reply, size_t replySize);
 
 	private:
 		uint16_t transId;
+		int maxInFlight;
+};
+
+/**
+ * Cached scanner of Modbus holding registers.
+ *
+ * Registers of interest are added to a register map, each with maximal age
+ * of its cached value. When a register is requested and its cached value
+ * is too old, all stale registers of the map are read, merged into as few
+ * block reads as possible - registers separated by at most maxGap
+ * registers are read in a single block. Blocks are read with a single
+ * ConnModbus::readHoldingRegisters call, so connections supporting it
+ * pipeline them.
+ *
+ * Writes done through the scanner invalidate cached values of the
+ * written registers.
+ */
+class ModbusScanner
+{
+	public:
+		/**
+		 * @param _conn     Modbus connection.
+		 * @param _slaveId  Slave (unit) ID.
+		 * @param _maxGap   Maximal number of unused registers between registers read in a block.
+		 */
+		ModbusScanner (ConnModbus *_conn, uint8_t _slaveId, int _maxGap = 4);
+
+		/**
+		 * Add registers to the register map.
+		 *
+		 * @param start   First register address.
+		 * @param qty     Number of registers.
+		 * @param maxAge  Maximal age of cached value (in seconds).
+		 */
+		void addRegisters (uint16_t start, uint16_t qty, double maxAge);
+
+		/**
+		 * Read registers of the map.
+		 *
+		 * @param all  If true, read all registers, otherwise only stale registers.
+		 *
+		 * @throw      ConnError on error.
+		 */
+		void scan (bool all = false);
+
+		/**
+		 * Returns holding registers. Cached values are used if they
+		 * are fresh, registers not in the map are always read from
+		 * the device.
+		 *
+		 * @throw      ConnError on error.
+		 */
+		void readHoldingRegisters (uint16_t start, uint16_t qty, uint16_t *reply_data);
+
+		/**
+		 * Mark cached values as stale.
+		 */
+		void invalidate (uint16_t start, uint16_t qty = 1);
+
+		void invalidateAll ();
+
+		void writeHoldingRegister (int16_t reg, int16_t val);
+
+		void writeHoldingRegisterMask (int16_t reg, int16_t mask, int16_t val);
+
+		/**
+		 * Returns number of block reads issued by the scanner.
+		 */
+		unsigned long getBlockReads () { return blockReads; }
+
+	private:
+		struct Register
+		{
+			double maxAge;
+			double readTime;
+			uint16_t value;
+		};
+
+		ConnModbus *conn;
+		uint8_t slaveId;
+		int maxGap;
+
+		std::map <uint16_t, Register> registers;
+
+		unsigned long blockReads;
 };
 
 class ConnModbusRTUTCP: public ConnTCP, public ConnModbus
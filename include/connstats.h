@@ -0,0 +1,277 @@
+/*
+ * Connection and event loop instrumentation.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_CONNSTATS__
+#define __RTS2_CONNSTATS__
+
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Number of histogram buckets. Bucket i counts samples shorter than 2^i
+ * microseconds, the last bucket is overflow bucket.
+ */
+#define STATS_HIST_BUCKETS    32
+
+namespace rts2core
+{
+
+/**
+ * Returns true if instrumentation is switched on. Instrumentation is process
+ * wide and can be switched on and off at runtime.
+ */
+bool statsEnabled ();
+
+/**
+ * Switch instrumentation on or off.
+ */
+void setStatsEnabled (bool enabled);
+
+/**
+ * Returns monotonic time in seconds. Used for all instrumentation
+ * measurements, as it is not affected by system clock changes.
+ */
+double statsNow ();
+
+/**
+ * Returns Prometheus label with escaped value (backslash, double quote and
+ * newline), as name="value".
+ */
+std::string prometheusLabel (const char *name, const std::string &value);
+
+/**
+ * Collects metrics in Prometheus text exposition format. Samples are grouped
+ * by metric family, each family is written once, preceded by its # TYPE
+ * line, no matter in which order its samples were added.
+ */
+class PrometheusWriter
+{
+	public:
+		PrometheusWriter () {}
+		~PrometheusWriter ();
+
+		/**
+		 * Returns stream for samples of metric family. Family is
+		 * created on first use.
+		 *
+		 * @param name  metric family name
+		 * @param type  metric type - counter, gauge or histogram
+		 */
+		std::ostream & family (const std::string &name, const char *type);
+
+		/**
+		 * Write all families to the stream.
+		 */
+		void write (std::ostream &os) const;
+
+	private:
+		struct Family
+		{
+			std::string name;
+			const char *type;
+			std::ostringstream samples;
+		};
+
+		// in order of creation
+		std::vector <Family *> families;
+		std::map <std::string, Family *> byName;
+};
+
+/**
+ * Lock-free latency histogram with logarithmic (power of two microseconds)
+ * buckets. Can be recorded from one thread and read from any other thread
+ * without locking.
+ *
+ */
+class LatencyHistogram
+{
+	public:
+		LatencyHistogram ();
+
+		/**
+		 * Record single measurement.
+		 *
+		 * @param sec  measured duration in seconds
+		 */
+		void record (double sec);
+
+		/**
+		 * Clear all recorded measurements.
+		 */
+		void reset ();
+
+		uint64_t getCount () const { return count.load (std::memory_order_relaxed); }
+
+		/**
+		 * Sum of all recorded durations, in seconds.
+		 */
+		double getSum () const { return sumUsec.load (std::memory_order_relaxed) / 1e6; }
+
+		/**
+		 * Mean duration in seconds, NAN if nothing was recorded.
+		 */
+		double getMean () const;
+
+		/**
+		 * Maximal recorded duration in seconds.
+		 */
+		double getMax () const { return maxUsec.load (std::memory_order_relaxed) / 1e6; }
+
+		/**
+		 * Returns approximate quantile. As histogram holds only bucket
+		 * counts, upper bound of the bucket holding the quantile is
+		 * returned.
+		 *
+		 * @param q  quantile (0..1)
+		 *
+		 * @return quantile upper bound in seconds, NAN if histogram is empty
+		 */
+		double getQuantile (double q) const;
+
+		uint64_t getBucket (int i) const { return buckets[i].load (std::memory_order_relaxed); }
+
+		/**
+		 * Upper bound of the bucket, in seconds. Returns INFINITY for the last bucket.
+		 */
+		static double bucketBound (int i);
+
+		/**
+		 * Add histogram to Prometheus metrics.
+		 *
+		 * @param pw      metrics writer
+		 * @param name    metric name
+		 * @param labels  labels (without {}), can be empty
+		 */
+		void writePrometheus (PrometheusWriter &pw, const std::string &name, const std::string &labels) const;
+
+	private:
+		std::atomic <uint64_t> buckets[STATS_HIST_BUCKETS];
+		std::atomic <uint64_t> count;
+		std::atomic <uint64_t> sumUsec;
+		std::atomic <uint64_t> maxUsec;
+};
+
+/**
+ * Instrumentation of a single connection. Records command round trip times
+ * (overall and per command), received and send data sizes, buffer size and
+ * binary transfer rates.
+ *
+ * Per-command histograms are created only from the thread running the
+ * connection event loop.
+ *
+ */
+class ConnStats
+{
+	public:
+		ConnStats ();
+		~ConnStats ();
+
+		/**
+		 * Called when command was send over the connection.
+		 *
+		 * @param cmd_text  command text; command name is the first word
+		 */
+		void commandSent (const char *cmd_text);
+
+		/**
+		 * Called when command return (+/-) was received.
+		 */
+		void commandReturned ();
+
+		void bytesReceived (size_t len) { rxBytes.fetch_add (len, std::memory_order_relaxed); }
+		void bytesSent (size_t len) { txBytes.fetch_add (len, std::memory_order_relaxed); }
+
+		/**
+		 * Record size of the receiving buffer.
+		 */
+		void bufferSize (size_t len);
+
+		/**
+		 * Record chunk of binary data received or sent.
+		 */
+		void binaryChunk (size_t len, bool received);
+
+		uint64_t getReceivedBytes () const { return rxBytes.load (std::memory_order_relaxed); }
+		uint64_t getSentBytes () const { return txBytes.load (std::memory_order_relaxed); }
+		uint64_t getBinaryBytes (bool received) const { return received ? binRx.load (std::memory_order_relaxed) : binTx.load (std::memory_order_relaxed); }
+		size_t getMaxBufferSize () const { return maxBuf.load (std::memory_order_relaxed); }
+
+		/**
+		 * Binary transfer rate in bytes per second, averaged over time
+		 * when binary transfer was active.
+		 */
+		double getBinaryRate () const;
+
+		const LatencyHistogram & getRoundTrip () const { return roundTrip; }
+
+		const std::map <std::string, LatencyHistogram *> & getCommandHistograms () const { return commands; }
+
+		/**
+		 * Add all connection metrics to Prometheus metrics.
+		 *
+		 * @param pw      metrics writer
+		 * @param labels  labels identifying the connection (without {})
+		 */
+		void writePrometheus (PrometheusWriter &pw, const std::string &labels) const;
+
+	private:
+		LatencyHistogram roundTrip;
+		std::map <std::string, LatencyHistogram *> commands;
+
+		double cmdStart;
+		std::string cmdName;
+
+		std::atomic <uint64_t> rxBytes;
+		std::atomic <uint64_t> txBytes;
+		std::atomic <uint64_t> binRx;
+		std::atomic <uint64_t> binTx;
+		std::atomic <size_t> maxBuf;
+
+		// time spend in binary transfers, in microseconds
+		std::atomic <uint64_t> binUsec;
+		double lastBinary;
+};
+
+/**
+ * Event loop instrumentation. Records time spend in poll processing
+ * (pollSuccess), idle calls and lag of the poll wakeup.
+ *
+ */
+class LoopStats
+{
+	public:
+		LoopStats () {}
+
+		LatencyHistogram poll;
+		LatencyHistogram idle;
+		LatencyHistogram lag;
+
+		void writePrometheus (PrometheusWriter &pw, const std::string &labels) const;
+};
+
+}
+
+#endif // !__RTS2_CONNSTATS__
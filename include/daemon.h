@@ -688,6 +688,9 @@ class Daemon:public Block
 		rts2_status_t state;
 
 		CondValueVector values;
+		// values are only added, so indices are updated in addValue
+		NameIndex <CondValue, true> valueIndex;
+		std::map <const Value *, CondValue *> condValues;
 		// values which do not change, they are send only once at connection
 		// initialization
 		ValueVector constValues;
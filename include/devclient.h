@@ -23,6 +23,7 @@
 #include "object.h"
 #include "block.h"
 #include "value.h"
+#include "photstream.h"
 
 namespace rts2core
 {
@@ -269,15 +270,42 @@ class DevClientPhot:public DevClient
 
 		virtual void valueChanged (Value * value);
 
+		/**
+		 * Unpacks batch of burst samples.
+		 */
+		virtual void fullDataReceived (int data_conn, DataChannels *data);
+
+		/**
+		 * Number of burst samples missing in received batches.
+		 */
+		uint64_t getLostSamples () { return lostSamples; }
+
+		uint64_t getReceivedSamples () { return receivedSamples; }
+
 	protected:
 		virtual void filterMoveStart ();
 		virtual void filterMoveEnd ();
 		virtual void integrationStart ();
 		virtual void integrationEnd ();
 		virtual void addCount (int count, float exp, bool is_ov);
+
+		/**
+		 * Called with batch of burst samples. Counts of burst samples
+		 * are not reported through addCount.
+		 */
+		virtual void addSamples (std::vector <rts2phot::PhotSample> &samples) {}
+
 		int lastCount;
 		float lastExp;
 		bool integrating;
+
+	private:
+		// true from first received burst batch till end of the integration
+		bool burst;
+		// sequence number of the next expected burst sample
+		uint64_t nextSample;
+		uint64_t lostSamples;
+		uint64_t receivedSamples;
 };
 
 class DevClientFilter:public DevClient
@@ -335,5 +363,60 @@ class DevClientBB:public DevClient
 		DevClientBB (Connection * in_connection);
 };
 
+/**
+ * Creates client of class T for connection.
+ */
+class DevClientFactory
+{
+	public:
+		DevClientFactory (Connection * _conn) { conn = _conn; }
+
+		template <class T> DevClient *create () { return new T (conn); }
+
+	private:
+		Connection *conn;
+};
+
+/**
+ * Create client of the device type. Client class is selected by device
+ * type and created by factory, which provides template method create
+ * <T> () (see DevClientFactory). Allows clients to wrap DevClient
+ * classes, while keeping the mapping from device types to classes at
+ * one place.
+ *
+ * @param factory            factory of clients
+ * @param other_device_type  type of the device, DEVICE_TYPE_XXX
+ */
+template <class F> DevClient *createDevClient (F &factory, int other_device_type)
+{
+	switch (other_device_type)
+	{
+		case DEVICE_TYPE_MOUNT:
+			return factory.template create <DevClientTelescope> ();
+		case DEVICE_TYPE_CCD:
+			return factory.template create <DevClientCamera> ();
+		case DEVICE_TYPE_DOME:
+			return factory.template create <DevClientDome> ();
+		case DEVICE_TYPE_CUPOLA:
+			return factory.template create <DevClientCupola> ();
+		case DEVICE_TYPE_PHOT:
+			return factory.template create <DevClientPhot> ();
+		case DEVICE_TYPE_FW:
+			return factory.template create <DevClientFilter> ();
+		case DEVICE_TYPE_EXECUTOR:
+			return factory.template create <DevClientExecutor> ();
+		case DEVICE_TYPE_IMGPROC:
+			return factory.template create <DevClientImgproc> ();
+		case DEVICE_TYPE_SELECTOR:
+			return factory.template create <DevClientSelector> ();
+		case DEVICE_TYPE_GRB:
+			return factory.template create <DevClientGrb> ();
+		case DEVICE_TYPE_BB:
+			return factory.template create <DevClientBB> ();
+		default:
+			return factory.template create <DevClient> ();
+	}
+}
+
 }
 #endif							 /* !__RTS2_DEVCLIENT__ */
@@ -304,6 +304,13 @@ class Device:public Daemon
 
 		virtual void setWeatherState (bool good_weather, const char *msg);
 
+		/**
+		 * Update instrumentation values (event loop and connection
+		 * statistics), if instrumentation is enabled.
+		 */
+		virtual int info ();
+		using Daemon::info;
+
 		friend class MultiDev;
 
 	protected:
@@ -410,6 +417,19 @@ class Device:public Daemon
 		char *last_weathermsg;
 
 		bool multidevPart;
+
+		// instrumentation values
+		rts2core::ValueBool *instrument;
+		rts2core::ValueDouble *loopLag;
+		rts2core::ValueDouble *loopPoll;
+		rts2core::ValueDouble *loopIdle;
+		rts2core::ValueDouble *commandRtt;
+		rts2core::ValueLong *bytesReceived;
+		rts2core::ValueLong *bytesSent;
+		rts2core::ValueDouble *binaryRate;
+		rts2core::ValueLong *suppressedUpdates;
+
+		void updateStats ();
 };
 
 }
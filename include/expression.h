@@ -30,12 +30,20 @@ namespace rts2expression
 
 typedef enum {OR, AND, XOR, EQU, LT, LEQU, GT, GEQU, NEQ} op_t;
 
+class CompiledExpression;
+
 class Expression
 {
 	public:
 		virtual ~Expression () {};
 		virtual double evaluate () = 0;
 
+		/**
+		 * Append code evaluating expression to compiled expression.
+		 * Default implementation calls evaluate.
+		 */
+		virtual void compile (CompiledExpression &program);
+
 		virtual Expression* add (op_t _op);
 		virtual Expression* add (Expression *_exp) { throw rts2core::Error ("missing operand"); }
 
@@ -51,6 +59,7 @@ class ExpressionPair:public Expression
 		ExpressionPair (Expression *_exp1, op_t _op, Expression *_exp2) { exp1 = _exp1; op = _op; exp2 = _exp2; }
 		virtual ~ExpressionPair () { delete exp1; delete exp2; }
 		virtual double evaluate ();
+		virtual void compile (CompiledExpression &program);
 
 		virtual Expression *add (op_t _op);
 		virtual Expression *add (Expression *_exp);
@@ -67,6 +76,7 @@ class ExpressionConst:public Expression
 	public:
 		ExpressionConst (double _val) { val = _val; }
 		virtual double evaluate () { return val; }
+		virtual void compile (CompiledExpression &program);
 	private:
 		double val;
 };
@@ -80,6 +90,7 @@ class ExpressionValue:public Expression
 			valueName = std::string (_value);
 		}
 		virtual double evaluate ();
+		virtual void compile (CompiledExpression &program);
 	private:
 		std::string deviceName;
 		std::string valueName;
@@ -0,0 +1,169 @@
+/*
+ * Ring of preallocated frame buffers.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_FRAMERING__
+#define __RTS2_FRAMERING__
+
+#include <deque>
+#include <vector>
+#include <pthread.h>
+#include <stddef.h>
+
+namespace rts2core
+{
+
+/**
+ * Piece of frame data written by the producer. Chunk with negative channel
+ * marks end of the frame, its ret holds return code of the readout.
+ */
+class FrameChunk
+{
+	public:
+		FrameChunk (int _frame, int _chan, size_t _offset, size_t _size, int _ret = 0)
+		{
+			frame = _frame;
+			chan = _chan;
+			offset = _offset;
+			size = _size;
+			ret = _ret;
+		}
+
+		int frame;
+		int chan;
+		size_t offset;
+		size_t size;
+		int ret;
+};
+
+/**
+ * Ring of preallocated, multi-channel frame buffers. Single producer
+ * (readout thread) fills the frames and announces written chunks, single
+ * consumer (main loop) pops the chunks, sends them out and releases the
+ * frame after it reads its end chunk.
+ *
+ * Frame data are written only by the producer before the chunk is
+ * announced, and read only by the consumer after the chunk is popped, so
+ * only the chunk queue and frame states are protected by the mutex.
+ */
+class FrameRing
+{
+	public:
+		FrameRing ();
+		~FrameRing ();
+
+		/**
+		 * Allocate frame buffers. Must be called when no frame is in use.
+		 *
+		 * @param frames    number of frames
+		 * @param channels  number of channels
+		 * @param chanSize  size of single channel buffer (in bytes)
+		 */
+		void allocate (int frames, int channels, size_t chanSize);
+
+		int getFrames () { return frameBuffers.size (); }
+
+		size_t getChannelSize () { return chanSize; }
+
+		/**
+		 * Get next free frame, wait until one is released.
+		 *
+		 * @param seq  sequence number stored with the frame
+		 *
+		 * @return frame index, -1 if ring is not allocated or was cancelled
+		 */
+		int acquire (long seq);
+
+		/**
+		 * Wake up producer waiting in acquire, which then returns -1.
+		 * Ring stays cancelled until it is allocated again.
+		 */
+		void cancel ();
+
+		/**
+		 * Start of channel buffer.
+		 */
+		char *getData (int frame, int chan) { return frameBuffers[frame][chan]; }
+
+		/**
+		 * First byte in the channel which was not yet written.
+		 */
+		char *getTop (int frame, int chan) { return frameBuffers[frame][chan] + written[frame][chan]; }
+
+		/**
+		 * Number of bytes written to the channel.
+		 */
+		size_t getWritten (int frame, int chan) { return written[frame][chan]; }
+
+		long getSequence (int frame) { return sequences[frame]; }
+
+		/**
+		 * Write data to the channel and announce them to the consumer.
+		 * If data points to the top of the channel buffer (producer
+		 * filled the frame buffer directly), they are not copied.
+		 *
+		 * @return -1 if data do not fit into the buffer, 0 on success
+		 */
+		int write (int frame, int chan, const char *data, size_t size);
+
+		/**
+		 * Announce end of the frame.
+		 *
+		 * @param ret  readout return code
+		 */
+		void finish (int frame, int ret);
+
+		/**
+		 * Pop next chunk.
+		 *
+		 * @return false if there isn't any chunk waiting
+		 */
+		bool pop (FrameChunk &chunk);
+
+		/**
+		 * Return frame to the ring. Called by the consumer after it
+		 * processed end chunk of the frame.
+		 */
+		void release (int frame);
+
+		/**
+		 * Number of frames being filled or waiting to be send out.
+		 */
+		int getUsed ();
+
+	private:
+		std::vector <char **> frameBuffers;
+		std::vector <size_t *> written;
+		std::vector <long> sequences;
+		std::vector <bool> used;
+		int channels;
+		size_t chanSize;
+		int next;
+		bool cancelled;
+
+		std::deque <FrameChunk> chunks;
+
+		pthread_mutex_t mutex;
+		pthread_cond_t released;
+
+		void freeBuffers ();
+};
+
+}
+
+#endif // !__RTS2_FRAMERING__
@@ -0,0 +1,241 @@
+/*
+ * Pointing model fitting.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_GPOINTFIT__
+#define __RTS2_GPOINTFIT__
+
+#include "gpointmodel.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <math.h>
+
+namespace rts2telmodel
+{
+
+/**
+ * Least squares fit of GPoint model. Fits the same model as gpoint Python
+ * script, using the term evaluation of GPointModel and ExtraParam. Model
+ * parameters are fitted with Levenberg-Marquardt, using analytic partial
+ * derivatives of the terms. Produces RTS2_GEM or RTS2_ALTAZ model file,
+ * which can be loaded by GPointModel or gpoint script.
+ *
+ * Residuals are the model errors in declination (altitude) and hour
+ * angle (azimuth) multiplied by cosine of declination (altitude), so the
+ * fit minimizes sum of squared angular distances.
+ *
+ * Errors are reported by throwing rts2core::Error.
+ */
+class GPointFit
+{
+	public:
+		/**
+		 * @param _latitude  observatory latitude in degrees, NAN to read it from input file
+		 * @param _altaz     fit Alt-Az model
+		 */
+		GPointFit (double _latitude = NAN, bool _altaz = false);
+		~GPointFit ();
+
+		double getLatitude () { return latitude; }
+
+		bool isAltAz () { return altaz; }
+
+		/**
+		 * Read alignment data, in format produced by rts2-telmodeltest
+		 * or scripts collecting astrometry results (see gpoint manual page).
+		 *
+		 * @param flips  both, east or west - select only pointings on given side
+		 */
+		void readAlignment (std::istream &is, const char *flips = "both");
+		void readAlignment (const char *fn, const char *flips = "both");
+
+		/**
+		 * Add GEM alignment point. All values are in degrees.
+		 *
+		 * @param a_ha   target (mount) hour angle
+		 * @param a_dec  target (mount) declination, above 90 or below -90 for flipped mount
+		 * @param r_ha   real (measured) hour angle
+		 * @param r_dec  real (measured) declination
+		 */
+		void addHaDec (double a_ha, double a_dec, double r_ha, double r_dec);
+
+		/**
+		 * Add alt-az alignment point. Azimuth is counted from south, in degrees.
+		 */
+		void addAltAz (double a_az, double a_alt, double r_az, double r_alt);
+
+		size_t getPoints () { return a_ha.size (); }
+
+		/**
+		 * Add extra term, with the same arguments as gpoint --extra option.
+		 *
+		 * @param axis      axis name (ha, dec for GEM, az, el or alt for Alt-Az)
+		 * @param function  function name (sin, cos, ...)
+		 * @param terms     ; separated terms (az, el, zd, ha, dec, pd)
+		 * @param consts    ; separated constants multiplying the terms
+		 */
+		void addExtra (const char *axis, const char *function, const char *terms, const char *consts);
+
+		/**
+		 * Parse gpoint style extra term description - axis:function:terms:consts.
+		 */
+		void addExtra (const char *desc);
+
+		/**
+		 * Number of parameters (basic and extra). Parameters are
+		 * available after fit or prepare call.
+		 */
+		int getParams () { return names.size (); }
+
+		const char *getParamName (int i) { return names[i].c_str (); }
+
+		/**
+		 * Returns parameter index, -1 if parameter is not known.
+		 */
+		int findParam (const char *name);
+
+		/**
+		 * Prepare parameters and partial derivatives for the fit.
+		 */
+		void prepare ();
+
+		/**
+		 * Fix parameter, so it will not be fitted. Names are checked
+		 * when the fit is run.
+		 */
+		void setFixed (const char *name) { fixedNames.push_back (std::string (name)); }
+
+		/**
+		 * Fit only parameters set with setFixed, fix all others
+		 * (gpoint --fixed !name,..).
+		 */
+		void setVaryOnly (bool _varyOnly) { varyOnly = _varyOnly; }
+
+		bool isFixed (int i) { return fixed[i]; }
+
+		/**
+		 * Parameter value in radians.
+		 */
+		double getParam (int i) { return params[i]; }
+
+		void setParam (int i, double v) { params[i] = v; }
+
+		/**
+		 * Parameter standard error from the fit covariance, in radians.
+		 */
+		double getParamError (int i) { return errors[i]; }
+
+		/**
+		 * Parameter standard deviation from bootstrap, in radians.
+		 */
+		double getBootstrapError (int i) { return bootErrors[i]; }
+
+		/**
+		 * Fit model parameters.
+		 *
+		 * @param maxfev  maximal number of residual evaluations
+		 * @param ftol    relative reduction of sum of squares needed to continue
+		 * @param xtol    relative change of parameters needed to continue
+		 *
+		 * @return number of evaluations
+		 */
+		int fit (int maxfev = 1000, double ftol = 1.49012e-08, double xtol = 1.49012e-08);
+
+		/**
+		 * Estimate parameter errors by fitting resampled alignment
+		 * points. Samples are distributed among threads, results does
+		 * not depend on number of threads.
+		 *
+		 * @param samples  number of bootstrap samples
+		 * @param threads  number of threads, 0 for number of CPUs
+		 * @param seed     random number generator seed
+		 */
+		void bootstrap (int samples, int threads = 0, unsigned int seed = 1);
+
+		/**
+		 * Angular RMS of pointing errors, in arcseconds.
+		 *
+		 * @param model  if true, use model residuals, otherwise raw pointing errors
+		 */
+		double getRMS (bool model);
+
+		/**
+		 * Residuals of the point with current parameters, in radians. Hour angle (azimuth)
+		 * residual is multiplied by cosine of declination (altitude).
+		 */
+		void getResidual (size_t i, double &r_ha, double &r_dec);
+
+		/**
+		 * Print model in RTS2_GEM / RTS2_ALTAZ format.
+		 *
+		 * @param frmt  d for degrees, m for arcminutes, s for arcseconds
+		 */
+		std::ostream & print (std::ostream &os, char frmt = 's');
+
+		/**
+		 * Print parameters with their errors in arcseconds.
+		 */
+		std::ostream & printParams (std::ostream &os);
+
+	private:
+		double latitude;
+		bool altaz;
+
+		// alignment data, in radians. a_ha and a_dec are used for alt-az as well, as extra
+		// terms can depend on them
+		std::vector <double> a_ha, a_dec, a_az, a_el;
+		// residuals without model, hour angle (azimuth) residual is multiplied by cosine of declination (altitude)
+		std::vector <double> d_ha, d_dec;
+
+		std::vector <std::string> names;
+		std::vector <std::string> fixedNames;
+		bool varyOnly;
+		std::vector <bool> fixed;
+		std::vector <double> params;
+		std::vector <double> errors;
+		std::vector <double> bootErrors;
+
+		struct Extra
+		{
+			ExtraParam *ep;
+			std::string axis;
+			std::string desc;
+			// true for ha or az
+			bool first;
+		};
+		std::vector <Extra> extras;
+
+		// partial derivatives of the residuals, per parameter, for all points
+		std::vector <std::vector <double> > jac_ha;
+		std::vector <std::vector <double> > jac_dec;
+
+		void setAltAz (bool _altaz);
+		void checkLatitude ();
+
+		double cost (const std::vector <int> *counts, const double *p);
+
+		int lmFit (const std::vector <int> *counts, double *p, int maxfev, double ftol, double xtol, double *cov);
+
+		friend void *bootstrapThread (void *arg);
+};
+
+}
+
+#endif // !__RTS2_GPOINTFIT__
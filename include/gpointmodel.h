@@ -29,6 +29,11 @@ namespace rts2telmodel
 //* maximal number of terms
 #define MAX_TERMS   4
 
+//* number of basic GEM (RTS2_MODEL) parameters
+#define GPOINT_GEM_PARAMS     9
+//* number of basic Alt-Az (RTS2_ALTAZ) parameters
+#define GPOINT_ALTAZ_PARAMS   7
+
 typedef enum { GPOINT_OFFSET=0, GPOINT_SIN, GPOINT_COS, GPOINT_TAN, GPOINT_SINCOS, GPOINT_COSCOS, GPOINT_SINSIN, GPOINT_ABSSIN, GPOINT_ABSCOS, GPOINT_CSC, GPOINT_SEC, GPOINT_COT, GPOINT_SINH, GPOINT_COSH, GPOINT_TANH, GPOINT_SECH, GPOINT_CSCH, GPOINT_COTH, GPOINT_LASTFUN } function_t;
 typedef enum { GPOINT_AZ=0, GPOINT_EL, GPOINT_ZD, GPOINT_HA, GPOINT_DEC, GPOINT_PD, GPOINT_LASTTERM } terms_t;
 
@@ -42,7 +47,19 @@ class ExtraParam
 	public:
 		ExtraParam ();
 		void parse (std::istream &is);
-		double getValue (double az, double el, double ha, double dec);
+		double getValue (double az, double el, double ha, double dec) { return params[0] * getBasis (az, el, ha, dec); }
+
+		/**
+		 * Returns term value for unit multiplier. As the term is linear
+		 * in its multiplier (params[0]), this is also partial derivative
+		 * of the term used by the model fitting.
+		 */
+		double getBasis (double az, double el, double ha, double dec);
+
+		/**
+		 * Calculate basis for n positions (all in radians).
+		 */
+		void getBasis (size_t n, const double *az, const double *el, const double *ha, const double *dec, double *basis);
 
 		std::string toString (char frmt = 'r');
 
@@ -87,10 +104,40 @@ class GPointModel:public TelModel
 		 */
 		void getErrAltAz (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err);
 
+		/**
+		 * Apply model to n positions. Trigonometric functions of the
+		 * latitude are calculated only once.
+		 */
+		void applyBatch (struct ln_equ_posn *pos, size_t n);
+
+		/**
+		 * Reverse model on n positions. Extra terms are evaluated
+		 * over the whole batch, term by term.
+		 */
+		void reverseBatch (struct ln_equ_posn *pos, struct ln_hrz_posn *hrz, size_t n);
+
+		/**
+		 * Calculate alt-az model errors for n positions.
+		 */
+		void getErrAltAzBatch (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err, size_t n);
+
+		/**
+		 * Partial derivatives of GEM model offsets in hour angle and
+		 * declination by the GPOINT_GEM_PARAMS basic parameters, as used
+		 * by reverse. All values are in radians.
+		 */
+		static void termsHaDec (double sin_lat, double cos_lat, double ha, double dec, double *t_ha, double *t_dec);
+
+		/**
+		 * Partial derivatives of alt-az model errors by the
+		 * GPOINT_ALTAZ_PARAMS basic parameters.
+		 */
+		static void termsAltAz (double az, double el, double *t_az, double *t_el);
+
 		virtual std::istream & load (std::istream & is);
 		virtual std::ostream & print (std::ostream & os, char frmt = 'r');
 
-		long double params[9];
+		long double params[GPOINT_GEM_PARAMS];
 
 		std::list <ExtraParam *> extraParamsAz;
 		std::list <ExtraParam *> extraParamsEl;
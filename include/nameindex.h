@@ -0,0 +1,203 @@
+/*
+ * Hash index of objects by name.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_NAMEINDEX__
+#define __RTS2_NAMEINDEX__
+
+#include <ctype.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <list>
+#include <string>
+#include <vector>
+
+namespace rts2core
+{
+
+/**
+ * Hash table from names to objects. Used to speed up lookups of values and
+ * connections, which are otherwise stored in vectors and lists. Objects are
+ * only added; when object is removed from the indexed container, the index
+ * shall be cleared and filled again.
+ *
+ * When the same name is added twice, the first object is kept, so lookups
+ * return the same object as linear search of the container.
+ *
+ * @param T        indexed object
+ * @param caseless true if names are compared case insensitive
+ */
+template <typename T, bool caseless> class NameIndex
+{
+	public:
+		NameIndex () { used = 0; }
+
+		void clear ()
+		{
+			slots.clear ();
+			used = 0;
+		}
+
+		size_t size () { return used; }
+
+		/**
+		 * Add object to index.
+		 *
+		 * @return false if object with the same name is already indexed
+		 */
+		bool add (const char *name, T *obj)
+		{
+			if ((used + 1) * 2 > slots.size ())
+				grow ();
+			uint32_t h = hash (name);
+			size_t mask = slots.size () - 1;
+			for (size_t i = h & mask; ; i = (i + 1) & mask)
+			{
+				Slot &s = slots[i];
+				if (s.obj == NULL)
+				{
+					s.hash = h;
+					s.name = std::string (name);
+					s.obj = obj;
+					used++;
+					return true;
+				}
+				if (s.hash == h && equal (s.name.c_str (), name))
+					return false;
+			}
+		}
+
+		/**
+		 * Find object with given name.
+		 *
+		 * @return object, NULL if name is not indexed
+		 */
+		T *find (const char *name) const
+		{
+			if (used == 0)
+				return NULL;
+			uint32_t h = hash (name);
+			size_t mask = slots.size () - 1;
+			for (size_t i = h & mask; ; i = (i + 1) & mask)
+			{
+				const Slot &s = slots[i];
+				if (s.obj == NULL)
+					return NULL;
+				if (s.hash == h && equal (s.name.c_str (), name))
+					return s.obj;
+			}
+		}
+
+	private:
+		struct Slot
+		{
+			Slot () { hash = 0; obj = NULL; }
+			uint32_t hash;
+			std::string name;
+			T *obj;
+		};
+
+		// open addressing with linear probing, size is power of 2
+		std::vector <Slot> slots;
+		size_t used;
+
+		// FNV-1a
+		static uint32_t hash (const char *name)
+		{
+			uint32_t h = 2166136261u;
+			for (; *name; name++)
+			{
+				h ^= (uint8_t) (caseless ? tolower ((unsigned char) *name) : *name);
+				h *= 16777619u;
+			}
+			return h;
+		}
+
+		static bool equal (const char *n1, const char *n2)
+		{
+			return caseless ? !strcasecmp (n1, n2) : !strcmp (n1, n2);
+		}
+
+		void grow ()
+		{
+			std::vector <Slot> old;
+			old.swap (slots);
+			slots.resize (old.empty () ? 16 : old.size () * 2);
+			size_t mask = slots.size () - 1;
+			for (typename std::vector <Slot>::iterator iter = old.begin (); iter != old.end (); iter++)
+			{
+				if (iter->obj == NULL)
+					continue;
+				size_t i = iter->hash & mask;
+				while (slots[i].obj != NULL)
+					i = (i + 1) & mask;
+				slots[i].hash = iter->hash;
+				slots[i].name.swap (iter->name);
+				slots[i].obj = iter->obj;
+			}
+		}
+};
+
+
+/**
+ * Index of objects by name, which allows multiple objects with the same
+ * name. Objects with the same name are returned in order in which they
+ * were added. As NameIndex, the index shall be cleared and filled again
+ * when any object is removed.
+ *
+ * @param T        indexed object
+ * @param caseless true if names are compared case insensitive
+ */
+template <typename T, bool caseless> class NameMultiIndex
+{
+	public:
+		void clear ()
+		{
+			index.clear ();
+			lists.clear ();
+		}
+
+		void add (const char *name, T *obj)
+		{
+			std::vector <T *> *l = index.find (name);
+			if (l == NULL)
+			{
+				lists.push_back (std::vector <T *> ());
+				l = &(lists.back ());
+				index.add (name, l);
+			}
+			l->push_back (obj);
+		}
+
+		/**
+		 * Find objects with given name.
+		 *
+		 * @return objects in order of addition, NULL if name is not indexed
+		 */
+		std::vector <T *> *find (const char *name) const { return index.find (name); }
+
+	private:
+		NameIndex <std::vector <T *>, caseless> index;
+		// list keeps addresses of vectors stable
+		std::list <std::vector <T *> > lists;
+};
+
+}
+
+#endif // !__RTS2_NAMEINDEX__
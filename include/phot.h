@@ -28,8 +28,10 @@
 
 #include "scriptdevice.h"
 #include "status.h"
+#include "photstream.h"
 
 #include <sys/time.h>
+#include <list>
 
 #define PHOT_EVENT_CHECK    RTS2_LOCAL_EVENT + 1250
 
@@ -45,6 +47,7 @@ class Photometer:public rts2core::ScriptDevice
 {
 	public:
 		Photometer (int argc, char **argv);
+		virtual ~Photometer ();
 		// return time till next getCount call in usec, or -1 when failed
 		virtual long getCount ()
 		{
@@ -54,10 +57,14 @@ class Photometer:public rts2core::ScriptDevice
 
 		virtual int idle ();
 
+		virtual void addPollSocks ();
+		virtual void pollSuccess ();
+
 		virtual int deleteConnection (rts2core::Connection * conn)
 		{
 			if (integrateConn == conn)
 				integrateConn = NULL;
+			streamConns.remove (conn);
 			return ScriptDevice::deleteConnection (conn);
 		}
 
@@ -71,6 +78,9 @@ class Photometer:public rts2core::ScriptDevice
 		const char *photType;
 		char *serial;
 
+		virtual int processOption (int in_opt);
+		virtual int init ();
+
 		virtual void postEvent (rts2core::Event *event);
 
 		virtual int setValue (rts2core::Value * old_value, rts2core::Value * new_value);
@@ -79,6 +89,38 @@ class Photometer:public rts2core::ScriptDevice
 		virtual int startIntegrate ();
 		virtual int endIntegrate ();
 
+		/**
+		 * Start burst mode. Driver shall start to produce samples
+		 * with req_time integration and pass them to addSample. Burst
+		 * ends when required number of samples is received, or when
+		 * it is stopped.
+		 *
+		 * @return -1 if burst mode is not supported or cannot be started
+		 */
+		virtual int startBurst () { return -1; }
+
+		/**
+		 * Stop producing burst samples. Called from the main loop.
+		 */
+		virtual int stopBurst () { return 0; }
+
+		/**
+		 * Add sample to burst stream. Can be called from any thread,
+		 * samples are send in batches from the main loop.
+		 *
+		 * @param tv     time of end of the integration
+		 *
+		 * @return false if the sample was not accepted (buffer is full, or all required samples were received)
+		 */
+		bool addSample (const struct timeval *tv, uint32_t in_count, float in_exp, bool in_is_ov);
+
+		bool isBursting () { return bursting; }
+
+		/**
+		 * True if all required burst samples were received. Can be called from any thread.
+		 */
+		bool isBurstComplete () { return burstLimit > 0 && samples->getPushed () >= burstLimit; }
+
 		virtual int homeFilter ();
 
 		void checkFilterMove ();
@@ -94,6 +136,13 @@ class Photometer:public rts2core::ScriptDevice
 		int startIntegrate (rts2core::Connection * conn, float in_req_time, int _req_count);
 		virtual int stopIntegrate ();
 
+		/**
+		 * Start burst of integrations, which are streamed to the connection.
+		 *
+		 * @param _req_count  number of samples, 0 for burst running until stopped
+		 */
+		int startBurst (rts2core::Connection * conn, float in_req_time, int _req_count);
+
 		int homeFilter (rts2core::Connection * conn);
 		int moveFilter (int new_filter);
 		int enableFilter (rts2core::Connection * conn);
@@ -112,6 +161,34 @@ class Photometer:public rts2core::ScriptDevice
 		rts2core::ValueFloat *exp;
 		rts2core::ValueBool *is_ov;
 		rts2core::Connection * integrateConn;
+
+		rts2core::ValueInteger *streamBatch;
+		rts2core::ValueDouble *streamInterval;
+		rts2core::ValueLong *streamSamples;
+		rts2core::ValueLong *streamLost;
+
+		// connections which receive burst samples, beside integrateConn
+		std::list <rts2core::Connection *> streamConns;
+
+		SampleRing *samples;
+		size_t streamBuffer;
+		// driver thread notifies main loop about full batch
+		int samplePipe[2];
+		bool bursting;
+		uint64_t burstLimit;
+		double lastSend;
+
+		void notifySamples ();
+
+		/**
+		 * Send samples waiting in the ring.
+		 *
+		 * @param all  if false, only full batches are sent
+		 */
+		void sendSamples (bool all);
+		void sendBatch (std::vector <PhotSample> &batch);
+
+		void endBurst (const char *msg);
 };
 
 }
@@ -0,0 +1,201 @@
+/*
+ * Buffered stream of photometer samples.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_PHOTSTREAM__
+#define __RTS2_PHOTSTREAM__
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/time.h>
+
+#include <vector>
+
+/**
+ * Data type of sample batches sent over binary data channel.
+ */
+#define RTS2_DATA_PHOTSAMPLES   1250
+
+// batch header - 64bit sequence number of the first sample, 32bit number of samples, 32bit reserved
+#define PHOTSTREAM_HEADER_SIZE  16
+// sample - 64bit time (usec since epoch), 32bit count, 32bit float exposure, 16bit filter, 16bit flags
+#define PHOTSTREAM_SAMPLE_SIZE  20
+
+#define PHOTSTREAM_OVERFLOW     0x0001
+
+namespace rts2phot
+{
+
+/**
+ * Single photometer reading.
+ */
+class PhotSample
+{
+	public:
+		PhotSample () { seq = 0; usec = 0; count = 0; exp = 0; filter = 0; overflow = false; }
+
+		PhotSample (uint64_t _usec, uint32_t _count, float _exp, int _filter, bool _overflow)
+		{
+			seq = 0;
+			usec = _usec;
+			count = _count;
+			exp = _exp;
+			filter = _filter;
+			overflow = _overflow;
+		}
+
+		/**
+		 * Sample time as ctime with fractional seconds.
+		 */
+		double getTime () const { return usec / 1000000.0; }
+
+		// sequence number, assigned when the sample is pushed to the ring
+		uint64_t seq;
+		// end of the integration, in microseconds since epoch
+		uint64_t usec;
+		uint32_t count;
+		float exp;
+		int filter;
+		bool overflow;
+};
+
+/**
+ * Fixed size ring of photometer samples. Driver thread pushes samples,
+ * main loop pops them in batches. Samples which do not fit into the
+ * ring are dropped, but they still consume sequence number, so the
+ * receiver can detect the gap.
+ */
+class SampleRing
+{
+	public:
+		SampleRing (size_t _capacity);
+		~SampleRing ();
+
+		/**
+		 * Empty the ring and reset counters.
+		 *
+		 * @param _limit  number of samples accepted before the ring stops accepting new samples, 0 for unlimited
+		 */
+		void reset (uint64_t _limit = 0);
+
+		/**
+		 * Add sample to the ring.
+		 *
+		 * @return false if the sample was not accepted, either because the ring is full or limit was reached
+		 */
+		bool push (const PhotSample &sample);
+
+		/**
+		 * Move samples from the ring to the vector. Popped samples have
+		 * consecutive sequence numbers, the batch ends before a gap
+		 * left by dropped samples.
+		 *
+		 * @param samples   vector samples are appended to
+		 * @param max       maximal number of samples to pop
+		 *
+		 * @return number of popped samples
+		 */
+		size_t pop (std::vector <PhotSample> &samples, size_t max);
+
+		size_t size ();
+
+		size_t getCapacity () { return capacity; }
+
+		/**
+		 * True if limit was reached and all accepted samples were popped.
+		 */
+		bool isFinished ();
+
+		/**
+		 * Number of samples offered to the ring since reset, including dropped samples.
+		 */
+		uint64_t getPushed ();
+
+		/**
+		 * Number of samples dropped because the ring was full.
+		 */
+		uint64_t getDropped ();
+
+	private:
+		std::vector <PhotSample> samples;
+		size_t capacity;
+		size_t head;
+		size_t used;
+
+		uint64_t limit;
+		uint64_t pushed;
+		uint64_t dropped;
+
+		pthread_mutex_t mutex;
+};
+
+/**
+ * Clock of burst integrations, run in driver thread. Calls sample for
+ * all integrations which ended, then sleeps at most 1 ms, so rates above
+ * 1 kHz do not need a wakeup per sample.
+ */
+class SampleClock
+{
+	public:
+		virtual ~SampleClock () {}
+
+		/**
+		 * Run the clock until stop is set or sample returns false.
+		 * First integration ends one period after the call.
+		 *
+		 * @param period  integration time in seconds
+		 * @param stop    flag set by other thread to stop the clock
+		 */
+		void runClock (double period, volatile bool &stop);
+
+	protected:
+		/**
+		 * Called at the end of each integration.
+		 *
+		 * @param tv  time of the end of the integration
+		 *
+		 * @return false to stop the clock
+		 */
+		virtual bool sample (const struct timeval *tv) = 0;
+};
+
+/**
+ * Size of packed batch.
+ */
+inline size_t batchSize (size_t samples) { return PHOTSTREAM_HEADER_SIZE + samples * PHOTSTREAM_SAMPLE_SIZE; }
+
+/**
+ * Pack samples to network-order batch. Samples must have contiguous sequence numbers.
+ *
+ * @param buf  buffer of at least batchSize (samples.size ()) bytes
+ *
+ * @return size of packed data
+ */
+size_t packSamples (const std::vector <PhotSample> &samples, char *buf);
+
+/**
+ * Unpack batch received over data channel.
+ *
+ * @return -1 if data are not valid batch, otherwise number of unpacked samples
+ */
+int unpackSamples (const char *buf, size_t size, std::vector <PhotSample> &samples);
+
+}
+
+#endif // !__RTS2_PHOTSTREAM__
@@ -67,6 +67,14 @@ class ImageSet:public std::vector <rts2image::Image * >
 		}
 	protected:
 		int load (std::string in_where);
+
+		/**
+		 * Load images matching where condition.
+		 *
+		 * @param in_where  SQL condition, can refer to parameters ($1, $2,..)
+		 * @param params    parameters values
+		 */
+		int load (std::string in_where, const std::vector <std::string> &params);
 		void stat ();
 	private:
 		ImageSetStat allStat;
@@ -150,6 +150,16 @@ class ObservationSet:public std::vector <Observation>, public TimeLog
 
 		void load (std::string in_where);
 
+		/**
+		 * Load observations matching where condition.
+		 *
+		 * @param in_where  SQL condition, can refer to parameters ($1, $2,..)
+		 * @param params    parameters values
+		 *
+		 * @throw SqlError on error
+		 */
+		void load (std::string in_where, const std::vector <std::string> &params);
+
 		// numbers
 		int allNum;
 		int goodNum;
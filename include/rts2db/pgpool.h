@@ -0,0 +1,270 @@
+/*
+ * Pool of database connections with prepared statements cache.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_PGPOOL__
+#define __RTS2_PGPOOL__
+
+#include <libpq-fe.h>
+#include <pthread.h>
+#include <sys/types.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rts2db
+{
+
+/**
+ * Statement and round-trip counters of database connections.
+ */
+class PgStats
+{
+	public:
+		PgStats () { prepares = executes = cached = roundTrips = rows = 0; }
+
+		PgStats & operator += (const PgStats &s)
+		{
+			prepares += s.prepares;
+			executes += s.executes;
+			cached += s.cached;
+			roundTrips += s.roundTrips;
+			rows += s.rows;
+			return *this;
+		}
+
+		// statements prepared on server
+		unsigned long prepares;
+		// executed statements
+		unsigned long executes;
+		// executions of statement prepared by previous call
+		unsigned long cached;
+		// requests sent to server and waited for reply
+		unsigned long roundTrips;
+		// returned rows
+		unsigned long rows;
+};
+
+/**
+ * Result of database query. All rows of the query are transfered in single
+ * round trip and hold in memory, so they can be accessed in any order.
+ * Takes ownership of the libpq result.
+ */
+class PgResult
+{
+	public:
+		PgResult (PGresult *_res) { res = _res; }
+		~PgResult () { PQclear (res); }
+
+		int rows () { return PQntuples (res); }
+
+		bool isNull (int row, int col) { return PQgetisnull (res, row, col); }
+
+		/**
+		 * Returns integer value, or def for NULL.
+		 */
+		int getInt (int row, int col, int def = -1);
+
+		/**
+		 * Returns double value, NAN for NULL.
+		 */
+		double getDouble (int row, int col);
+
+		/**
+		 * Returns string value, empty string for NULL.
+		 */
+		const char *getString (int row, int col) { return PQgetvalue (res, row, col); }
+
+		char getChar (int row, int col) { return PQgetvalue (res, row, col)[0]; }
+
+		bool getBool (int row, int col) { return PQgetvalue (res, row, col)[0] == 't'; }
+
+	private:
+		PGresult *res;
+
+		// not copyable
+		PgResult (const PgResult &);
+		PgResult & operator = (const PgResult &);
+};
+
+/**
+ * Database connection keeping named prepared statements. Statement is
+ * prepared when its SQL is executed for the first time, further execution
+ * of the same SQL uses the already prepared statement, so the query is not
+ * parsed and planned again. Values which differ between calls shall be
+ * passed as parameters ($1, $2,..), so the same SQL text is reused. SQL
+ * without parameters is executed unprepared, as it usually has values
+ * written in its text and will not be executed again.
+ *
+ * Connection is not thread safe - it shall be used only by thread which
+ * acquired it from ConnectionPool.
+ */
+class PgConnection
+{
+	public:
+		PgConnection (const char *dbname, const char *user, const char *password);
+		~PgConnection ();
+
+		bool isConnected () { return PQstatus (conn) == CONNECTION_OK; }
+
+		const char *getErrorMessage () { return PQerrorMessage (conn); }
+
+		/**
+		 * Reset broken connection. Prepared statements are lost.
+		 */
+		void reset ();
+
+		/**
+		 * Execute SQL, preparing it if it was not prepared before. SQL
+		 * without parameters is executed without preparing it.
+		 *
+		 * @param sql      SQL statement
+		 * @param params   parameters of the statement, in text form
+		 *
+		 * @return result, which shall be wrapped in PgResult
+		 *
+		 * @throw SqlError on error
+		 */
+		PGresult *execute (const char *sql, const std::vector <std::string> &params);
+
+		PGresult *execute (const char *sql) { std::vector <std::string> params; return execute (sql, params); }
+
+		/**
+		 * Returns counters and zero them.
+		 */
+		PgStats takeStats ();
+
+		size_t preparedStatements () { return statements.size (); }
+
+	private:
+		PGconn *conn;
+
+		class Prepared
+		{
+			public:
+				std::string name;
+				unsigned long lastUsed;
+		};
+
+		// prepared statements, indexed by SQL
+		std::map <std::string, Prepared> statements;
+		unsigned long nextName;
+		unsigned long useCounter;
+
+		PgStats stats;
+
+		void deallocateOldest ();
+};
+
+/**
+ * Pool of database connections. Threads acquire connection for a query
+ * (preferably through PooledConnection), so they do not wait for each
+ * other on single database connection. Connections are opened on demand,
+ * up to pool size, and keeps their prepared statements while they are
+ * idle in the pool.
+ */
+class ConnectionPool
+{
+	public:
+		static ConnectionPool * instance ();
+
+		/**
+		 * Set database to connect to. Database can be specified as
+		 * ECPG target (dbname[@host[:port]], tcp:postgresql://..) or
+		 * libpq connection string (dbname=.. host=..).
+		 *
+		 * @param _size   maximal number of open connections
+		 */
+		void setDatabase (const char *_db, const char *_user, const char *_password, int _size);
+
+		bool isConfigured () { return configured; }
+
+		/**
+		 * Returns libpq connection string of the database.
+		 */
+		const char *getDatabase () { return db.c_str (); }
+
+		/**
+		 * Returns connection from pool. Waits if pool size connections
+		 * are already in use.
+		 *
+		 * @throw SqlError if the pool is not configured or connection cannot be opened
+		 */
+		PgConnection *acquire ();
+
+		/**
+		 * Return connection to pool.
+		 */
+		void release (PgConnection *conn);
+
+		/**
+		 * Close idle connections.
+		 */
+		void disconnect ();
+
+		/**
+		 * Statistics of connections returned to the pool.
+		 */
+		PgStats getStats ();
+
+		void resetStats ();
+
+		int getOpenConnections () { return open; }
+
+	private:
+		ConnectionPool ();
+
+		static ConnectionPool *pInstance;
+
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+
+		std::vector <PgConnection *> idle;
+		int open;
+		int size;
+
+		// process which opened connections - after fork they cannot be used
+		pid_t pid;
+
+		bool configured;
+		std::string db;
+		std::string user;
+		std::string password;
+
+		PgStats stats;
+};
+
+/**
+ * Connection acquired from pool for lifetime of the object.
+ */
+class PooledConnection
+{
+	public:
+		PooledConnection () { conn = ConnectionPool::instance ()->acquire (); }
+		~PooledConnection () { ConnectionPool::instance ()->release (conn); }
+
+		PgConnection *operator -> () { return conn; }
+
+	private:
+		PgConnection *conn;
+};
+
+}
+
+#endif // ! __RTS2_PGPOOL__
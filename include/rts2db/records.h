@@ -69,9 +69,19 @@ class RecordsSet: public std::list <Record>
 		}
 
 		/**
+		 * Load records.
+		 *
+		 * @param t_from  start time
+		 * @param t_to    end time
+		 * @param bucket  if > 0, double records are downsampled to
+		 *                minimum and maximum of each bucket of given
+		 *                length (in seconds). State and boolean records,
+		 *                which are recorded only on change, are
+		 *                always loaded in full
+		 *
 		 * @throw SqlError on errror.
 		 */
-		void load (double t_from, double t_to);
+		void load (double t_from, double t_to, double bucket = 0);
 
 		double getMin () { return min; };
 		double getMax () { return max; };
@@ -88,6 +98,7 @@ class RecordsSet: public std::list <Record>
 
 		void loadState (double t_from, double t_to);
 		void loadDouble (double t_from, double t_to);
+		void loadDoubleBuckets (double t_from, double t_to, double bucket);
 		void loadBoolean (double t_from, double t_to);
 
 		// minmal and maximal values..
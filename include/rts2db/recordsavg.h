@@ -17,6 +17,9 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#ifndef __RTS2_DB_RECORDSAVG__
+#define __RTS2_DB_RECORDSAVG__
+
 #include <list>
 #include <string>
 
@@ -58,22 +61,48 @@ typedef enum {DAY, HOUR} cadence_t;
 /**
  * Class with value average records.
  *
+ * Records are aggregated to buckets of given length. Buckets are aligned to
+ * multiples of bucket length from the Unix epoch. Whole hours are read from
+ * the hourly rollup table, whole minutes from the minute rollup table; other
+ * bucket lengths are aggregated from records_double. Record time is the
+ * middle of the bucket.
+ *
  * @author Petr Kubanek <petr@kubanek.net>
  */
 class RecordAvgSet: public std::list <RecordAvg>
 {
 	private:
 		int recval_id;
-		cadence_t cadence;
+		double bucket;
+
+		void loadHour (double t_from, double t_to);
+		void loadMinute (double t_from, double t_to);
+		void loadRecords (double t_from, double t_to);
 	public:
 		RecordAvgSet (int _recval_id, cadence_t _cadence)
 		{
 			recval_id = _recval_id;
-			cadence = _cadence;
+			bucket = _cadence == DAY ? 86400 : 3600;
 		}
 
+		/**
+		 * @param _bucket  bucket length in seconds
+		 */
+		RecordAvgSet (int _recval_id, double _bucket)
+		{
+			recval_id = _recval_id;
+			bucket = _bucket;
+		}
+
+		double getBucket () { return bucket; }
+
+		/**
+		 * @throw SqlError on errror.
+		 */
 		void load (double t_from, double t_to);
 };
 
 
 }
+
+#endif /* !__RTS2_DB_RECORDSAVG__ */
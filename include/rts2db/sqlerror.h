@@ -36,6 +36,15 @@ class SqlError: public rts2core::Error
 		SqlError ();
 		SqlError (const char *sqlmsg);
 
+		/**
+		 * Error reported by database connection which is not managed by
+		 * ECPG.
+		 *
+		 * @param sqlmsg   SQL or operation which failed
+		 * @param dbmsg    error message from database
+		 */
+		SqlError (const char *sqlmsg, const char *dbmsg);
+
 		/**
 		 * Returns SQL error code.
 		 */
@@ -26,6 +26,8 @@
 #endif
 #include <sys/types.h>
 
+#include "rts2fits/pixelhistogram.h"
+
 namespace rts2image
 {
 
@@ -92,8 +94,25 @@ class Channel
 
 		const char *getData () { return (char *) data; }
 
+		/**
+		 * Compute average and standard deviation. When computed over
+		 * the whole channel, histogram of pixel values is computed
+		 * as well.
+		 */
 		void computeStatistics (size_t _from = 0, size_t _dataSize = 0);
 
+		/**
+		 * Returns histogram of channel pixels. It is computed on the
+		 * first call (or by computeStatistics), and kept until
+		 * dataChanged is called.
+		 */
+		PixelHistogram *getHistogram ();
+
+		/**
+		 * Drops cached histogram. Must be called after channel data were modified.
+		 */
+		void dataChanged ();
+
 	private:
 		char *data;
 		int naxis;
@@ -106,6 +125,8 @@ class Channel
 		double average;
 		double stdev;
 
+		PixelHistogram *histogram;
+
 		// channel number
 		int channelnum;
 };
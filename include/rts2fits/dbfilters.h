@@ -42,6 +42,13 @@ class DBFilters:public std::map <int, std::string>
 		 */
 		void load ();
 
+		/**
+		 * Get index of already loaded filter.
+		 *
+		 * @return filter index, -1 if filter is not in cache
+		 */
+		int findIndex (const char *filter);
+
 		/**
 		 * Get index of filter with given name. Create new entry in
 		 * filter table if the filter is not know.
@@ -2,6 +2,7 @@
 #define __RTS2_DEVCLIFOC__
 
 #include "devcliimg.h"
+#include "phottable.h"
 #include "connection/fork.h"
 
 #include <fstream>
@@ -74,11 +75,16 @@ class ConnFocus:public rts2core::ConnFork
 class DevClientPhotFoc:public rts2core::DevClientPhot
 {
 	public:
-		DevClientPhotFoc (rts2core::Connection * in_conn, char *in_photometerFile, float in_photometerTime, int in_photometerFilterChange, std::vector < int >in_skipFilters);
+		/**
+		 * @param in_photometerTable  FITS file burst samples are written to, NULL if they shall not be saved
+		 * @param in_photometerBurst  if > 0, start burst of that many integrations instead of single integrations
+		 */
+		DevClientPhotFoc (rts2core::Connection * in_conn, char *in_photometerFile, float in_photometerTime, int in_photometerFilterChange, std::vector < int >in_skipFilters, const char *in_photometerTable = NULL, int in_photometerBurst = 0);
 		virtual ~ DevClientPhotFoc (void);
 
 	protected:
 		virtual void addCount (int count, float exp, bool is_ov);
+		virtual void addSamples (std::vector <rts2phot::PhotSample> &samples);
 
 	private:
 		std::ofstream os;
@@ -88,6 +94,8 @@ class DevClientPhotFoc:public rts2core::DevClientPhot
 		int countCount;
 		std::vector < int >skipFilters;
 		int newFilter;
+		PhotTable *table;
+		int photometerBurst;
 };
 
 }
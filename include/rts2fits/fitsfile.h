@@ -17,6 +17,9 @@
  * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
  */
 
+#ifndef __RTS2_FITSFILE__
+#define __RTS2_FITSFILE__
+
 #include "expander.h"
 #include "error.h"
 #include "valuearray.h"
@@ -385,3 +388,5 @@ class ErrorSettingKey: public rts2core::Error
 };
 
 };
+
+#endif // !__RTS2_FITSFILE__
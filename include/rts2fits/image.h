@@ -30,6 +30,7 @@
 
 #include "rts2fits/fitsfile.h"
 #include "rts2fits/channel.h"
+#include "rts2fits/imagescale.h"
 
 #include "libnova_cpp.h"
 #include "devclient.h"
@@ -65,9 +66,6 @@ double ln_get_heliocentric_time_diff (double JD, struct ln_equ_posn *object);
 namespace rts2image
 {
 
-/** Image scaling functions. */
-typedef enum { SCALING_LINEAR, SCALING_LOG, SCALING_SQRT, SCALING_POW } scaling_type;
-
 /**
  * One pixel at the image, with coordinates and a value.
  */
@@ -98,6 +96,12 @@ typedef enum
 { EXPOSURE_START, INFO_CALLED, EXPOSURE_END, TRIGGERED }
 imageWriteWhich_t;
 
+/**
+ * Scale data in place to newType (RTS2_DATA_BYTE or RTS2_DATA_USHORT). See
+ * PixelScaler for details.
+ *
+ * @return pointer to data; data are left untouched if their type cannot be scaled
+ */
 const void * getScaledData (int dataType, const void *data, size_t numpix, long smin, long smax, scaling_type scaling, int newType);
 
 /**
@@ -285,6 +289,15 @@ class Image:public FitsFile
 		 */
 		void getChannelHistogram (int chan, long *histogram, long nbins);
 
+		/**
+		 * Returns histogram of channel pixel values. Histogram is
+		 * cached in the channel, so repeated quantile or scaling
+		 * requests do not recompute it.
+		 *
+		 * @param chan      channel number
+		 */
+		PixelHistogram *getChannelPixelHistogram (int chan);
+
 
 		template <typename bt, typename dt> void getChannelGrayscaleByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y);
 
@@ -304,6 +317,11 @@ class Image:public FitsFile
 
 		template <typename bt, typename dt> void getChannelPseudocolourByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y, int colourVariant = PSEUDOCOLOUR_VARIANT_BLUE);
 
+		/**
+		 * Returns values, below and above which are given quantiles
+		 * of channel pixels. Values are clipped to minval - mval
+		 * range, the range is returned if the image is empty or flat.
+		 */
 		template <typename dt> void getChannelQuantiles (int chan, dt minval, dt mval, float quantiles, dt * low_ptr, dt * high_ptr);
 
 		/**
@@ -121,6 +121,18 @@ class ImageSkyDb:public ImageDb
 		virtual void initDbImage ();
 		virtual int updateDB ();
 	private:
+		/**
+		 * Queue image record to ImageQueue.
+		 */
+		int queueDB ();
+
+		/**
+		 * Fills astrometry string and errors from WCS keywords.
+		 *
+		 * @return -1 if image does not have WCS
+		 */
+		int getAstrometry (std::string &astrometry, double &err_ra, double &err_dec, double &err);
+
 		int updateAstrometry ();
 
 		int processBitfiedl;
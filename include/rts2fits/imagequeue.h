@@ -0,0 +1,252 @@
+/*
+ * Write-behind queue of image database records.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_IMAGEQUEUE__
+#define __RTS2_IMAGEQUEUE__
+
+#include <libpq-fe.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace rts2image
+{
+
+/**
+ * Row of images table, with astrometry. Record either holds all values
+ * of the image, or only its new path (when the image was renamed).
+ */
+class ImageRecord
+{
+	public:
+		ImageRecord ();
+
+		int obs_id;
+		int img_id;
+
+		// if false, only img_path is updated
+		bool full;
+		// record read from journal, does not overwrite rows already in database
+		bool replayed;
+
+		std::string img_path;
+		char obs_subtype;
+		std::string mount_name;
+		std::string camera_name;
+		// NAN values are stored as NULL
+		double img_temperature;
+		double img_exposure;
+		int filter_id;
+		double img_alt;
+		double img_az;
+		// seconds part of exposure start
+		double img_date;
+		int img_usec;
+		int med_id;
+		int process_bitfield;
+		double img_fwhm;
+		double img_limmag;
+		double img_qmagmax;
+		// empty if astrometry is not known
+		std::string astrometry;
+		double img_err_ra;
+		double img_err_dec;
+		double img_err;
+
+		/**
+		 * Single line representation, used in journal.
+		 */
+		std::string toString () const;
+
+		/**
+		 * Parse record from journal line.
+		 *
+		 * @return false if line cannot be parsed
+		 */
+		bool parse (const std::string &line);
+};
+
+/**
+ * Queue of images waiting to be registered in database.
+ *
+ * Records are appended to journal file and put to memory queue. Writer
+ * thread writes queued records in batches, as multi-row upserts in single
+ * transaction, at latest maxDelay seconds after the record was queued.
+ * Records of the same image are merged, so only the last state is written.
+ *
+ * Journal is split into segments, current segment is closed when its
+ * records are taken by the writer and deleted after they are committed.
+ * Segments left by crashed process are replayed when the queue is started.
+ * Replayed records are only inserted, so rows updated since the records
+ * were journaled are not overwritten with stale values.
+ */
+class ImageQueue
+{
+	public:
+		ImageQueue ();
+		~ImageQueue ();
+
+		/**
+		 * Queue used by images of this process.
+		 */
+		static ImageQueue * instance ();
+
+		/**
+		 * Start writer thread. Replays records left in journal.
+		 *
+		 * @param conninfo   libpq connection string
+		 * @param user       database user, can be NULL
+		 * @param password   database password, can be NULL
+		 * @param journal    journal path prefix
+		 * @param _maxDelay  maximal time (in seconds) records are kept in queue
+		 *
+		 * @return -1 if journal cannot be opened, 0 on success
+		 */
+		int start (const char *conninfo, const char *user, const char *password, const char *journal, double _maxDelay);
+
+		/**
+		 * Write queued records and stop writer thread.
+		 */
+		void stop ();
+
+		/**
+		 * True if queue is running in this process. Queue is not
+		 * running in forked child.
+		 */
+		bool isRunning () { return running && pid == getpid (); }
+
+		/**
+		 * Queue record.
+		 *
+		 * @return -1 if record cannot be written to journal
+		 */
+		int add (const ImageRecord &rec);
+
+		/**
+		 * Waits until all records queued before the call are written.
+		 *
+		 * @param timeout  maximal time to wait in seconds, negative to wait until the records are written
+		 *
+		 * @return -1 if records cannot be written to database, -2 if they were not written before timeout
+		 */
+		int flush (double timeout = -1);
+
+		/**
+		 * Maximal number of records written by single statement.
+		 */
+		void setBatchSize (size_t _batchSize) { batchSize = _batchSize; }
+
+		size_t queued ();
+
+		unsigned long getWritten () { return written; }
+		unsigned long getTransactions () { return transactions; }
+		unsigned long getStatements () { return statements; }
+
+	private:
+		static ImageQueue *pInstance;
+
+		pthread_t writer;
+		pthread_mutex_t mutex;
+		// signaled when record is added or flush is requested
+		pthread_cond_t addCond;
+		// signaled when records were written
+		pthread_cond_t writtenCond;
+
+		bool running;
+		bool stopRequest;
+		pid_t pid;
+
+		std::string conninfo;
+		std::string user;
+		std::string password;
+		PGconn *conn;
+
+		double maxDelay;
+		size_t batchSize;
+
+		std::string journal;
+		int journalFd;
+		// segment records are appended to
+		unsigned long segment;
+		// oldest segment which was not yet committed
+		unsigned long firstSegment;
+		// true if a record was written to current segment
+		bool segmentUsed;
+
+		std::vector <ImageRecord> queue;
+		// time first record in queue was added
+		double queueStart;
+
+		// number of records added and records written since start
+		unsigned long added;
+		unsigned long done;
+		// number of failed writes
+		unsigned long failures;
+		bool flushRequest;
+
+		unsigned long written;
+		unsigned long transactions;
+		unsigned long statements;
+
+		// errors of writer thread, logged by thread which adds records
+		pthread_mutex_t errorMutex;
+		std::vector <std::string> errors;
+
+		void addError (const std::string &err);
+		void logErrors ();
+
+		static void *writerThread (void *arg);
+		void writerLoop ();
+
+		std::string segmentName (unsigned long seg);
+		int openSegment ();
+
+		/**
+		 * Write records to database. Records which cannot be written
+		 * because of their values are dropped.
+		 *
+		 * @return -1 if database is not available, records shall be kept for next try, 1 if some records were dropped, 0 if all were written
+		 */
+		int writeRecords (std::vector <ImageRecord> &records);
+
+		/**
+		 * Write records in single transaction.
+		 *
+		 * @param full    records of new images
+		 * @param paths   path updates of images
+		 */
+		bool writeBatch (std::vector <ImageRecord> &full, std::vector <ImageRecord> &paths);
+
+		/**
+		 * Insert full records, in statements of at most batchSize rows.
+		 *
+		 * @param tail    statement tail, handles rows already in database
+		 */
+		bool insertRecords (std::vector <ImageRecord> &records, const char *tail);
+
+		bool execute (const char *sql, std::vector <std::string> &params);
+		bool connect ();
+};
+
+}
+
+#endif // ! __RTS2_IMAGEQUEUE__
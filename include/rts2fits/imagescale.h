@@ -0,0 +1,159 @@
+/*
+ * Scaling of image pixels for previews and data streaming.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_IMAGESCALE__
+#define __RTS2_IMAGESCALE__
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace rts2image
+{
+
+class PixelHistogram;
+
+/** Image scaling functions. */
+typedef enum { SCALING_LINEAR, SCALING_LOG, SCALING_SQRT, SCALING_POW } scaling_type;
+
+/**
+ * Parse scaling name (lin, log, sqrt, pow).
+ *
+ * @return -1 when name is not known, 0 on success
+ */
+int scalingFromString (const char *name, scaling_type &scaling);
+
+/**
+ * Size of pixel of RTS2_DATA_xxx type in bytes.
+ */
+int pixelByteSize (int dataType);
+
+/**
+ * Number of online CPUs, at least 1.
+ */
+int onlineCPUs ();
+
+/**
+ * Split range [0, n) into contiguous parts, sized in multiplies of block,
+ * and call func for each part in separate thread. The last part is
+ * processed by the calling thread, as well as parts for which a thread
+ * cannot be created. Returns after all parts are processed.
+ *
+ * @param n        number of items
+ * @param block    minimal number of items processed by a thread
+ * @param threads  maximal number of threads
+ * @param func     function processing items from (included) to to (excluded)
+ * @param arg      argument passed to func
+ */
+void parallelRange (size_t n, size_t block, int threads, void (*func) (void *arg, size_t from, size_t to), void *arg);
+
+/**
+ * Scales pixel values to 8 or 16 bit unsigned integers. Values below the
+ * lower limit are scaled to 0, values above the upper limit to white
+ * (255 or 65535). Limits outside of the range of the data type are
+ * clipped to the type range.
+ *
+ * Nonlinear scalings work on values normalized to 0..1 (t) and produce
+ * white * log (1 + 1000 t) / log (1001) for log, white * sqrt (t) for sqrt
+ * and white * t * t for pow scaling.
+ *
+ * 8 and 16 bit data are mapped through lookup table, which is kept until
+ * limits, scaling or type changes. Nonlinear scaling of other data types
+ * maps normalized value through 65536 entries table of the scaling
+ * function. Linear scaling of 32 bit and floating point data is computed
+ * in loops without branches, which the compiler vectorizes. Large frames
+ * are split among threads.
+ */
+class PixelScaler
+{
+	public:
+		/**
+		 * @param _smin     lower limit
+		 * @param _smax     upper limit
+		 * @param _scaling  scaling function
+		 * @param _newType  output type, RTS2_DATA_BYTE or RTS2_DATA_USHORT
+		 */
+		PixelScaler (double _smin, double _smax, scaling_type _scaling, int _newType);
+
+		void setLimits (double _smin, double _smax);
+		double getMin () { return smin; }
+		double getMax () { return smax; }
+
+		void setScaling (scaling_type _scaling);
+		scaling_type getScaling () { return scaling; }
+
+		void setNewType (int _newType);
+		int getNewType () { return newType; }
+
+		/**
+		 * Number of threads, 0 for number of CPUs.
+		 */
+		void setThreads (int _threads);
+		int getThreads () { return threads; }
+
+		/**
+		 * Set limits so quantile of pixels is below the lower limit,
+		 * and the same quantile above the upper limit. 8 and 16 bit
+		 * data are counted in histogram, other types are sampled.
+		 *
+		 * @return false if data type is not supported
+		 */
+		bool setQuantileLimits (int dataType, const void *data, size_t numpix, float quantile);
+
+		/**
+		 * Set limits from quantiles of already computed histogram.
+		 */
+		void setQuantileLimits (PixelHistogram &hist, float quantile);
+
+		/**
+		 * Scale pixels. Source and destination can be the same
+		 * buffer, in that case the output overwrites the beginning of
+		 * input data.
+		 *
+		 * @param dataType  RTS2_DATA_xxx type of source data
+		 * @param src       source data
+		 * @param dst       output buffer, numpix pixels of new type
+		 * @param numpix    number of pixels
+		 *
+		 * @return false if data type is not supported, dst is not touched
+		 */
+		bool scale (int dataType, const void *src, void *dst, size_t numpix);
+
+	private:
+		double smin;
+		double smax;
+		scaling_type scaling;
+		int newType;
+		int threads;
+
+		// lookup table of 8 and 16 bit data, valid for lutType data
+		std::vector <uint16_t> lut;
+		int lutType;
+
+		// table of the scaling function, valid for curveType output
+		std::vector <uint16_t> curve;
+		int curveType;
+
+		template <typename bt> bool scaleOutput (int dataType, const void *src, bt *dst, size_t numpix);
+		template <typename dt, typename bt> void scaleType (int dataType, const dt *src, bt *dst, size_t numpix);
+};
+
+}
+
+#endif // !__RTS2_IMAGESCALE__
@@ -0,0 +1,194 @@
+/*
+ * Stacking of calibration images.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_IMAGESTACK__
+#define __RTS2_IMAGESTACK__
+
+#include <string>
+#include <vector>
+#include <stddef.h>
+
+namespace rts2image
+{
+
+typedef enum {STACK_MEAN, STACK_MEDIAN, STACK_SIGMACLIP, STACK_MINMAX} stackMethod_t;
+
+/**
+ * Frame scaling / output normalization.
+ */
+typedef enum {STACK_SCALE_NONE, STACK_SCALE_MEAN, STACK_SCALE_MEDIAN, STACK_SCALE_MAX} stackScale_t;
+
+/**
+ * Parse method name (mean, median, sigclip, minmax).
+ *
+ * @return -1 when name is not known, 0 on success
+ */
+int stackMethodFromString (const char *name, stackMethod_t &method);
+
+const char *stackMethodName (stackMethod_t method);
+
+/**
+ * Parse scale name (none, mean, median, max).
+ */
+int stackScaleFromString (const char *name, stackScale_t &scale);
+
+/**
+ * Combines pixels of multiple frames. Pixel ranges are split among
+ * threads, inner loops of mean and sigma clipping run over contiguous
+ * blocks of pixels of a single frame so the compiler can vectorize them.
+ * NaN pixels are ignored, output is NaN if a pixel is NaN in all frames.
+ */
+class StackCombiner
+{
+	public:
+		StackCombiner (stackMethod_t _method = STACK_MEDIAN);
+
+		void setMethod (stackMethod_t _method) { method = _method; }
+		stackMethod_t getMethod () { return method; }
+
+		/**
+		 * Sigma clipping parameters. First iteration clips around
+		 * median, following around mean of the remaining values.
+		 */
+		void setSigmaClip (float _kappaLow, float _kappaHigh, int _iterations);
+
+		/**
+		 * Number of lowest and highest values rejected by min/max method.
+		 */
+		void setMinMax (int _nlow, int _nhigh);
+
+		/**
+		 * Number of threads, 0 for number of CPUs.
+		 */
+		void setThreads (int _threads);
+		int getThreads () { return threads; }
+
+		/**
+		 * Combine frames.
+		 *
+		 * @param frames   array of nframes pointers to frame data
+		 * @param nframes  number of frames
+		 * @param npix     number of pixels in each frame
+		 * @param out      output buffer, npix pixels
+		 */
+		void combine (const float * const *frames, int nframes, size_t npix, float *out);
+
+		/**
+		 * Combine pixel range in the calling thread.
+		 */
+		void combineRange (const float * const *frames, int nframes, size_t from, size_t to, float *out);
+
+	private:
+		stackMethod_t method;
+		float kappaLow;
+		float kappaHigh;
+		int iterations;
+		int nlow;
+		int nhigh;
+		int threads;
+
+		void meanBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out);
+		void sigmaClipBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work);
+		void medianBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work);
+		void minMaxBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work);
+};
+
+/**
+ * Stacks 2D FITS images into single float image. Reads the input files in
+ * bands of rows, so memory usage is bounded regardless of number of
+ * frames. Next band is read while the previous one is combined.
+ *
+ * Errors are reported by throwing rts2core::Error.
+ */
+class ImageStack:public StackCombiner
+{
+	public:
+		ImageStack (stackMethod_t _method = STACK_MEDIAN);
+
+		void addFile (const char *fn) { files.push_back (std::string (fn)); }
+
+		int getFiles () { return files.size (); }
+
+		const char *getFile (int i) { return files[i].c_str (); }
+
+		/**
+		 * Image subtracted from every frame before scaling (master bias or dark).
+		 */
+		void setSubtract (const char *fn) { subtract = fn ? fn : ""; }
+
+		/**
+		 * Scale frames to have the given statistic equal to 1 before combining.
+		 */
+		void setScale (stackScale_t _scale) { scale = _scale; }
+
+		/**
+		 * Normalize output image so its statistic is equal to 1.
+		 */
+		void setNormalize (stackScale_t _normalize) { normalize = _normalize; }
+
+		/**
+		 * Maximal memory used for band buffers, in bytes.
+		 */
+		void setMemoryLimit (size_t _memoryLimit) { memoryLimit = _memoryLimit; }
+
+		/**
+		 * Stack images, write result to output. Existing output is overwritten.
+		 */
+		void stack (const char *output);
+
+		/**
+		 * Statistic of frame used for scaling, available after stack.
+		 */
+		double getFrameLevel (int i) { return levels[i]; }
+
+		double getOutputLevel () { return outputLevel; }
+
+	private:
+		std::vector <std::string> files;
+		std::string subtract;
+		stackScale_t scale;
+		stackScale_t normalize;
+		size_t memoryLimit;
+
+		std::vector <double> levels;
+		double outputLevel;
+};
+
+}
+
+/**
+ * Stack FITS files, C interface for Python ctypes.
+ *
+ * @param output     output file name
+ * @param files      input files
+ * @param nfiles     number of input files
+ * @param method     method name (mean, median, sigclip, minmax)
+ * @param scale      frame scaling (none, mean, median, max)
+ * @param normalize  output normalization (none, mean, median, max)
+ * @param subtract   image subtracted from the frames, NULL for none
+ * @param kappa      sigma clipping limit
+ * @param iterations sigma clipping iterations
+ * @param nreject    number of rejected lowest and highest values for minmax
+ * @param threads    number of threads, 0 for all CPUs
+ *
+ * @return 0 on success, -1 on error (error is printed to stderr)
+ */
+extern "C" int rts2image_stack (const char *output, const char **files, int nfiles, const char *method, const char *scale, const char *normalize, const char *subtract, double kappa, int iterations, int nreject, int threads);
+
+#endif // !__RTS2_IMAGESTACK__
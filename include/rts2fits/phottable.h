@@ -0,0 +1,64 @@
+/*
+ * FITS binary table of photometer samples.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_PHOTTABLE__
+#define __RTS2_PHOTTABLE__
+
+#include "rts2fits/fitsfile.h"
+#include "photstream.h"
+
+#include <vector>
+
+namespace rts2image
+{
+
+/**
+ * Photometer samples stored in PHOTOMETER binary table extension, one
+ * row per sample. Rows are appended in batches, as they are received
+ * from the burst stream.
+ */
+class PhotTable:public FitsFile
+{
+	public:
+		PhotTable (const char *_filename);
+
+		/**
+		 * Open the table for appending. File with empty table is
+		 * created if it does not exist.
+		 *
+		 * @throw ErrorOpeningFitsFile
+		 */
+		void open ();
+
+		/**
+		 * Append samples to the table.
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int append (const std::vector <rts2phot::PhotSample> &samples);
+
+		long getRows () { return rows; }
+
+	private:
+		long rows;
+};
+
+}
+
+#endif // !__RTS2_PHOTTABLE__
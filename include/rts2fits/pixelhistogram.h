@@ -0,0 +1,128 @@
+/*
+ * Histogram and quantile sketch of image pixels.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_PIXELHISTOGRAM__
+#define __RTS2_PIXELHISTOGRAM__
+
+#include <vector>
+#include <stddef.h>
+
+namespace rts2image
+{
+
+/**
+ * Distribution of pixel values, used to find quantiles for image scaling.
+ *
+ * 8 and 16 bit integer data are counted in exact histogram with a bin for
+ * every possible value. Wider integer and floating point data are
+ * sampled - every n-th pixel is kept, and when the sample reaches its
+ * maximal size, every second value is dropped and n is doubled. Quantiles
+ * of the sample are then within a fraction of percent of true quantiles,
+ * regardless of the value range. NaNs are ignored.
+ *
+ * Pixels can be added in chunks, as they are received.
+ */
+class PixelHistogram
+{
+	public:
+		/**
+		 * @param _dataType  RTS2_DATA_xxx type of pixels
+		 */
+		PixelHistogram (int _dataType);
+
+		/**
+		 * Clear histogram, prepare it for data of given type.
+		 */
+		void reset (int _dataType);
+
+		/**
+		 * Number of threads used to count exact histogram, 0 for number of CPUs.
+		 */
+		void setThreads (int _threads);
+
+		/**
+		 * Add pixels. Chunks of the same image shall be added in order.
+		 *
+		 * @return false if data type is not supported
+		 */
+		bool add (const void *data, size_t numpix);
+
+		int getDataType () { return dataType; }
+
+		/**
+		 * Number of counted (not NaN) pixels.
+		 */
+		size_t getCount () { return count; }
+
+		/**
+		 * True if histogram holds all values, false if it is sampled.
+		 */
+		bool isExact () { return !bins.empty (); }
+
+		/**
+		 * Number of sampled pixels. Equals to getCount for exact histogram.
+		 */
+		size_t getSampleSize () { return isExact () ? count : sample.size (); }
+
+		double getMin () { return vmin; }
+		double getMax () { return vmax; }
+
+		/**
+		 * Returns pixel value such that fraction q of pixels is below
+		 * or equal to it.
+		 *
+		 * @param q  fraction, 0 - 1
+		 *
+		 * @return quantile value, NAN if histogram is empty
+		 */
+		double quantile (double q);
+
+		/**
+		 * Count of exact histogram bin, bin 0 holds the lowest value of the type.
+		 */
+		size_t getBin (size_t i) { return i < bins.size () ? bins[i] : 0; }
+		size_t getBins () { return bins.size (); }
+
+	private:
+		int dataType;
+		int threads;
+
+		size_t count;
+		double vmin;
+		double vmax;
+
+		// exact histogram
+		std::vector <size_t> bins;
+		double binLowest;
+
+		// sample of wider types
+		std::vector <double> sample;
+		bool sorted;
+		size_t step;
+		// pixels added so far and stream index of next sampled pixel
+		size_t position;
+		size_t nextSample;
+
+		template <typename dt> void addExact (const dt *data, size_t numpix);
+		template <typename dt> void addSampled (const dt *data, size_t numpix);
+};
+
+}
+
+#endif // !__RTS2_PIXELHISTOGRAM__
@@ -156,6 +156,8 @@ class AsyncDataAPI:public AsyncAPI
 {
 	public:
 		AsyncDataAPI (JSONRequest *_req, rts2core::Connection *_conn, XmlRpc::XmlRpcServerConnection *_source, rts2core::DataAbstractRead *_data, int _chan, long _smin, long _smax, rts2image::scaling_type _scaling, int _newType);
+		virtual ~AsyncDataAPI ();
+
 		virtual void fullDataReceived (rts2core::Connection *_conn, rts2core::DataChannels *data);
 
 		virtual void nullSource () { data = NULL; AsyncAPI::nullSource (); }
@@ -179,6 +181,24 @@ class AsyncDataAPI:public AsyncAPI
 	private:
 		bool headerSend;
 
+		// scaler is created once type of the data is known, keeps its lookup tables between chunks
+		rts2image::PixelScaler *scaler;
+		std::vector <char> scaled;
+
+		/**
+		 * Scale data received so far, starting at bosend offset of the
+		 * original data, into scaled buffer. Header is copied with
+		 * the new data type.
+		 *
+		 * @return number of bytes in scaled buffer
+		 */
+		size_t scaleChunk (size_t bosend);
+
+		/**
+		 * Offset of the original data corresponding to bytes already sent.
+		 */
+		size_t originalOffset ();
+
 		void doSendData (void *buf, size_t bufs)
 		{
 			ssize_t ret = send (source->getfd (), buf, bufs, 0);
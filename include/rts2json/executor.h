@@ -0,0 +1,199 @@
+/*
+ * Worker pool for HTTP requests.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_EXECUTOR__
+#define __RTS2_EXECUTOR__
+
+#include "httpreq.h"
+#include "connstats.h"
+#include "message.h"
+#include "tsqueue.h"
+
+#include <atomic>
+#include <list>
+#include <vector>
+#include <pthread.h>
+
+namespace rts2json
+{
+
+/**
+ * Request queued for execution in worker thread. Holds copy of the request
+ * path and parameters, and the response produced by the worker. Worker
+ * does not access the source connection, which can be closed while the
+ * request is executed.
+ */
+class RequestJob
+{
+	public:
+		RequestJob (GetRequestAuthorized *_request, XmlRpc::XmlRpcServerConnection *_source, const std::string &_path, XmlRpc::HttpParams *_params);
+
+		GetRequestAuthorized *request;
+		XmlRpc::XmlRpcServerConnection *source;
+		std::string path;
+		XmlRpc::HttpParams params;
+
+		// time when the job was queued (statsNow)
+		double queued;
+
+		// connection was closed, response is dropped; accessed only from the main loop
+		bool orphaned;
+
+		// headers added by the request, passed to the connection with the response
+		std::list <std::pair <const char *, std::string> > headers;
+
+		int http_code;
+		const char *response_type;
+		char *response;
+		size_t response_length;
+};
+
+/**
+ * Executes slow HTTP requests (database queries, image conversions) in pool
+ * of worker threads, so they do not block the main loop handling device
+ * connections.
+ *
+ * Request is put to the queue by GetRequestAuthorized, and its connection
+ * is switched to asynchronous mode. Worker executes the request and puts
+ * it to the finished queue, and notifies the main loop by writing to a
+ * pipe. The main loop then calls processFinished, which passes responses
+ * to the connections.
+ */
+class RequestExecutor
+{
+	public:
+		RequestExecutor (HTTPServer *_server);
+		~RequestExecutor ();
+
+		/**
+		 * Start worker threads.
+		 *
+		 * @param nthreads  number of worker threads
+		 *
+		 * @return -1 on error, 0 on success
+		 */
+		int start (int nthreads);
+
+		/**
+		 * Stop all worker threads. Waits for running requests to finish.
+		 */
+		void stop ();
+
+		int getThreads () { return threads.size (); }
+
+		/**
+		 * Queue request for execution.
+		 *
+		 * @return false if executor is not running
+		 */
+		bool queueRequest (GetRequestAuthorized *request, XmlRpc::XmlRpcServerConnection *source, const std::string &path, XmlRpc::HttpParams *params);
+
+		/**
+		 * File descriptor which becomes readable when some requests
+		 * are finished, -1 if executor is not running.
+		 */
+		int getNotifyFd () { return notifyPipe[0]; }
+
+		/**
+		 * Pass finished responses to their connections. Must be
+		 * called from the main loop.
+		 *
+		 * @return number of finished requests
+		 */
+		int processFinished ();
+
+		/**
+		 * Drop responses of requests from the connection, as the
+		 * connection is being deleted. Must be called from the main
+		 * loop.
+		 */
+		void orphanRequests (XmlRpc::XmlRpcServerConnection *source);
+
+		/**
+		 * Queue log message produced by worker thread, to be sent from
+		 * the main loop.
+		 *
+		 * @return false if not called from worker thread, message was not queued
+		 */
+		bool queueMessage (messageType_t type, const char *msg);
+
+		/**
+		 * Get message queued by worker thread.
+		 *
+		 * @return false if there isn't any message waiting
+		 */
+		bool popMessage (std::pair <messageType_t, std::string> &msg);
+
+		/**
+		 * Number of requests waiting for a worker.
+		 */
+		size_t getQueueDepth () { return jobs.size (); }
+
+		/**
+		 * Number of requests being executed.
+		 */
+		int getRunning () { return running.load (std::memory_order_relaxed); }
+
+		/**
+		 * Time requests spend in the queue.
+		 */
+		const rts2core::LatencyHistogram & getQueueWait () const { return queueWait; }
+
+		/**
+		 * Time spend executing requests.
+		 */
+		const rts2core::LatencyHistogram & getHandlerTime () const { return handlerTime; }
+
+		/**
+		 * Worker thread body.
+		 */
+		void run ();
+
+	private:
+		HTTPServer *server;
+
+		std::vector <pthread_t> threads;
+
+		TSQueue <RequestJob *> jobs;
+		TSQueue <RequestJob *> finished;
+		// log messages produced by workers
+		TSQueue <std::pair <messageType_t, std::string> > messages;
+
+		// queued jobs whose response was not yet processed, main loop only
+		std::list <RequestJob *> pending;
+
+		pthread_t mainThread;
+		int notifyPipe[2];
+
+		std::atomic <int> running;
+		std::atomic <int> threadNum;
+
+		rts2core::LatencyHistogram queueWait;
+		rts2core::LatencyHistogram handlerTime;
+
+		void execute (RequestJob *job);
+
+		void notify ();
+
+		void setResponse (RequestJob *job, int http_code, const char *response_type, const std::string &msg);
+};
+
+}
+
+#endif // !__RTS2_EXECUTOR__
@@ -63,7 +63,22 @@ class GetRequestAuthorized: public XmlRpc::XmlRpcServerGetRequest
 
 		virtual void execute (XmlRpc::XmlRpcSource *source, struct ::sockaddr_in *saddr, std::string path, XmlRpc::HttpParams *params, int &http_code, const char* &response_type, char* &response, size_t &response_length);
 
+		friend class RequestExecutor;
+
 	protected:
+		/**
+		 * Returns true if request for the given path can be executed
+		 * in worker thread. Such requests must not access device
+		 * connections, as those are handled in the main loop. They
+		 * usually query database or process images.
+		 *
+		 * @param path    exact path of the request, excluding prefix part
+		 * @param params  HTTP parameters
+		 *
+		 * @return true if request can be passed to worker thread
+		 */
+		virtual bool isThreaded (const std::string &path, XmlRpc::HttpParams *params) { return false; }
+
 		/**
 		 * Received exact path and HTTP params. Returns response - MIME
 		 * type, its data and length. This request is password
@@ -185,6 +200,12 @@ class GetRequestAuthorized: public XmlRpc::XmlRpcServerGetRequest
 		rts2core::UserPermissions *userPermissions;
 
 		struct sockaddr_in *source_addr;
+
+		/**
+		 * Pass request to worker thread if it can be executed there,
+		 * otherwise execute it.
+		 */
+		void dispatchExecute (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
 };
 
 class JSONRequest:public GetRequestAuthorized
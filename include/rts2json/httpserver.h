@@ -30,10 +30,13 @@
 #include "userpermissions.h"
 #include "rts2db/camlist.h"
 
+#include "xmlrpc++/XmlRpcServerGetRequest.h"
+
 namespace rts2json
 {
 
 class AsyncAPI;
+class GetRequestAuthorized;
 
 /**
  * Interface for HTTP server. Declares methods needed by user authorization.
@@ -105,6 +108,27 @@ class HTTPServer
 
 		void asyncIdle ();
 
+		/**
+		 * Queue request for execution in worker thread.
+		 *
+		 * @param request  request to execute
+		 * @param source   connection which will receive the response
+		 * @param path     request path
+		 * @param params   request parameters, copied for the worker
+		 *
+		 * @return false if request cannot be queued and must be executed in the calling thread
+		 */
+		virtual bool queueRequest (GetRequestAuthorized *request, XmlRpc::XmlRpcServerConnection *source, const std::string &path, XmlRpc::HttpParams *params) { return false; }
+
+		/**
+		 * Called from newly started worker thread, before it starts
+		 * processing requests. Can be used to open per-thread
+		 * resources, e.g. database connection.
+		 *
+		 * @param num  worker thread number
+		 */
+		virtual void workerStarted (int num) {}
+
 	protected:
 		rts2core::ValueInteger *numberAsyncAPIs;
 		rts2core::ValueInteger *sumAsync;
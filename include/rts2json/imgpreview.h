@@ -92,6 +92,9 @@ class JpegImageRequest: public rts2json::GetRequestAuthorized
 		JpegImageRequest (const char* prefix, rts2json::HTTPServer *_http_server, XmlRpc::XmlRpcServer* s):rts2json::GetRequestAuthorized (prefix, _http_server, NULL, s) {}
 
 		virtual void authorizedExecute (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
+
+	protected:
+		virtual bool isThreaded (const std::string &path, XmlRpc::HttpParams *params) { return true; }
 };
 
 /**
@@ -105,6 +108,10 @@ class JpegPreview:public rts2json::GetRequestAuthorized
 		JpegPreview (const char* prefix, rts2json::HTTPServer *_http_server, const char *_dirPath, XmlRpc::XmlRpcServer *s):rts2json::GetRequestAuthorized (prefix, _http_server, "JPEG image preview", s) { dirPath = _dirPath; }
 
 		virtual void authorizedExecute (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
+
+	protected:
+		virtual bool isThreaded (const std::string &path, XmlRpc::HttpParams *params) { return true; }
+
 	private:
 		const char *dirPath;
 };
@@ -122,6 +129,9 @@ class FitsImageRequest:public rts2json::GetRequestAuthorized
 		FitsImageRequest (const char* prefix, rts2json::HTTPServer *_http_server, XmlRpc::XmlRpcServer* s):rts2json::GetRequestAuthorized (prefix, _http_server, NULL, s) {}
 
 		virtual void authorizedExecute (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
+
+	protected:
+		virtual bool isThreaded (const std::string &path, XmlRpc::HttpParams *params) { return true; }
 };
 
 /**
@@ -144,6 +144,9 @@ void sendRectangleValue (rts2core::Value *value, std::ostringstream &os);
 
 void sendValue (rts2core::Value *value, std::ostringstream &os);
 
+// encode value data to JSON, without value name
+void jsonValueData (rts2core::Value *value, bool extended, std::ostringstream & os);
+
 // encode value to JSON
 void jsonValue (rts2core::Value *value, bool extended, std::ostringstream & os);
 
@@ -153,6 +156,58 @@ void jsonValue (rts2core::Value *value, bool extended, std::ostringstream & os);
  * @param time from which changed values will be reported. nan means that all values will be reported.
  */
 void sendConnectionValues (std::ostringstream &os, rts2core::Connection * conn, XmlRpc::HttpParams *params, double from = NAN, bool extended = false);
+
+/**
+ * Snapshot of JSON encoded connection values. Requests for all values of a
+ * device are served from the snapshot, which is rebuild only after the
+ * connection values changed. Used only from the main loop.
+ *
+ * Values of connections without DevClient are not cached, as their changes
+ * are not reported.
+ */
+class ValuesSnapshot
+{
+	public:
+		ValuesSnapshot ():entries () { hits = 0; misses = 0; }
+
+		/**
+		 * Send connection values, using the snapshot if possible.
+		 * Produces the same output as rts2json::sendConnectionValues.
+		 */
+		void sendConnectionValues (std::ostringstream &os, rts2core::Connection * conn, XmlRpc::HttpParams *params, double from = NAN, bool extended = false);
+
+		/**
+		 * Mark connection snapshot as invalid. Must be called when
+		 * connection value changes, or when connection is removed.
+		 */
+		void invalidate (rts2core::Connection *conn);
+
+		/**
+		 * Number of requests served from the snapshot.
+		 */
+		long getHits () { return hits; }
+
+		/**
+		 * Number of snapshot rebuilds.
+		 */
+		long getMisses () { return misses; }
+
+	private:
+		struct SnapshotEntry
+		{
+			std::string json;
+			rts2_status_t state;
+			double progressStart;
+			double progressEnd;
+			size_t nvalues;
+		};
+
+		std::map <std::pair <rts2core::Connection *, bool>, SnapshotEntry> entries;
+
+		long hits;
+		long misses;
+};
+
 }
 
 #endif // !__RTS2_JSONVALUE__
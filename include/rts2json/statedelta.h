@@ -0,0 +1,153 @@
+/*
+ * Delta encoding of JSON observatory state.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_STATEDELTA__
+#define __RTS2_STATEDELTA__
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+namespace rts2json
+{
+
+/**
+ * Sections of device state. Values and minmax sections are JSON objects
+ * holding members for each value, header members (idle, state, progress
+ * times,..) are stored directly in the device object.
+ */
+typedef enum { SECTION_VALUES, SECTION_MINMAX, SECTION_HEADER } stateSection_t;
+
+/**
+ * Tracks JSON encoded state of observatory devices and produces either
+ * full snapshot, or delta holding only members changed since given
+ * sequence number.
+ *
+ * Full snapshot has the same format as BB observatory update - object
+ * with device names as members, each holding "d" and "minmax" objects and
+ * header members. Delta has the same structure, but holds only changed
+ * devices and members. Values and minmax objects in delta shall be merged
+ * member by member into the stored state, other members replace stored
+ * members.
+ *
+ * State is updated by calling beginUpdate, setMember for all members and
+ * endUpdate. Sequence number is increased only when something changed.
+ * Delta cannot express removal of device or member - if one is removed,
+ * delta for any older sequence number is refused and full snapshot must be
+ * sent.
+ *
+ * The class is not thread safe, caller shall update and encode it from a
+ * single thread.
+ */
+class StateDelta
+{
+	public:
+		StateDelta ();
+
+		/**
+		 * Start update of the state. Members not set until endUpdate are removed.
+		 */
+		void beginUpdate ();
+
+		/**
+		 * Set member value.
+		 *
+		 * @param device   device name
+		 * @param section  section of the device state
+		 * @param name     member name
+		 * @param json     JSON encoded member value
+		 */
+		void setMember (const std::string &device, stateSection_t section, const std::string &name, const std::string &json);
+
+		/**
+		 * Finish update, remove members and devices not set since beginUpdate.
+		 *
+		 * @return current sequence number
+		 */
+		uint32_t endUpdate ();
+
+		/**
+		 * Current sequence number. 0 is never returned after first endUpdate.
+		 */
+		uint32_t getSeq () { return seq; }
+
+		/**
+		 * Write members changed after base sequence number.
+		 *
+		 * @param os    stream to write delta
+		 * @param base  sequence number acknowledged by the receiver
+		 *
+		 * @return false if delta cannot be produced and full snapshot must be sent, nothing is written in this case
+		 */
+		bool delta (std::ostream &os, uint32_t base);
+
+		/**
+		 * Write full state.
+		 */
+		void full (std::ostream &os);
+
+		/**
+		 * Number of members changed after base sequence number.
+		 */
+		size_t changedMembers (uint32_t base);
+
+		size_t getDevices () { return devices.size (); }
+
+	private:
+		struct Member
+		{
+			std::string name;
+			std::string json;
+			uint32_t changed;
+			uint32_t seen;
+		};
+
+		struct Section
+		{
+			std::vector <Member> members;
+			std::map <std::string, size_t> index;
+		};
+
+		struct Device
+		{
+			std::string name;
+			Section sections[3];
+			uint32_t seen;
+		};
+
+		std::vector <Device> devices;
+		std::map <std::string, size_t> deviceIndex;
+
+		uint32_t seq;
+		// sequence number of the last removal, deltas with older base are refused
+		uint32_t removedSeq;
+		uint32_t pass;
+		bool changed;
+		bool removed;
+
+		void writeDevice (std::ostream &os, Device &dev, uint32_t base);
+		bool deviceChanged (Device &dev, uint32_t base);
+		bool pruneSection (Section &sec);
+};
+
+}
+
+#endif // !__RTS2_STATEDELTA__
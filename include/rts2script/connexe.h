@@ -23,6 +23,9 @@
 #include "rts2script/element.h"
 #include "connection/fork.h"
 
+#include <list>
+#include <sstream>
+
 namespace rts2script {
 
 /**
@@ -40,6 +43,11 @@ class ConnExe:public rts2core::ConnFork
 
 		virtual void processLine ();
 
+		/**
+		 * Push changes of subscribed values to the script.
+		 */
+		virtual int idle ();
+
 	protected:
 		virtual void processCommand (char *cmd);
 
@@ -48,11 +56,45 @@ class ConnExe:public rts2core::ConnFork
 		rts2core::Connection *getConnectionForScript (const char *name);
 		int getDeviceType (const char *name);
 
+		/**
+		 * Returns value of other device, centrald values included.
+		 */
+		rts2core::Value *getValueForScript (const char *device, const char *value);
+
 		bool checkActive (bool report = false);
 	
 	private:
 		std::vector <std::string> tempentries;
 
+		/**
+		 * Value subscribed by the script. Value is pushed to the
+		 * script when its string representation changes.
+		 */
+		struct Subscription
+		{
+			std::string device;
+			std::string value;
+			std::string last;
+			bool sent;
+		};
+
+		std::list <Subscription> subscriptions;
+
+		void subscribe (const char *device, const char *value, std::ostringstream &_os);
+		void unsubscribe (const char *device, const char *value);
+
+		/**
+		 * Push subscribed value if it changed since it was last
+		 * pushed. Returns true if value was pushed.
+		 */
+		bool pushValue (Subscription &sub, std::ostringstream &_os);
+
+		/**
+		 * Parse MV operand. Inside double quotes, \" and \\ stand
+		 * for " and \.
+		 */
+		int paramNextOperand (char **str);
+
 		void testWritableVariable (const char *cmd, int32_t vflags, rts2core::Value *v);
 		bool active;
 };
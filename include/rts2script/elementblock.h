@@ -219,14 +219,15 @@ class ElementWhileSod:public ElementBlock
 };
 
 /**
- * Repeat commands while condition hold true.
+ * Repeat commands while condition hold true. Condition is compiled
+ * when the element is created.
  *
  * @author Petr Kubanek <petr@kubanek.net>
  */
 class ElementWhile:public ElementBlock
 {
 	public:
-		ElementWhile (Script * _script, rts2operands::Operand *_condition, int _max_cycles):ElementBlock (_script) { condition = _condition; max_cycles = _max_cycles; }
+		ElementWhile (Script * _script, rts2operands::Operand *_condition, int _max_cycles);
 		virtual ~ElementWhile () { delete condition; }
 
 		virtual void printScript (std::ostream &os);
@@ -234,6 +235,7 @@ class ElementWhile:public ElementBlock
 		virtual bool endLoop ();
 	private:
 		rts2operands::Operand *condition;
+		rts2expression::CompiledExpression compiledCondition;
 		int max_cycles;
 };
 
@@ -245,15 +247,16 @@ class ElementWhile:public ElementBlock
 class ElementDo:public ElementBlock
 {
 	public:
-		ElementDo (Script *_script, int _max_cycles):ElementBlock (_script) { max_cycles = _max_cycles; condition = NULL; }
+		ElementDo (Script *_script, int _max_cycles);
 		virtual ~ElementDo () { delete condition; }
-		void setCondition (rts2operands::Operand *_condition) { condition = _condition; }
+		void setCondition (rts2operands::Operand *_condition);
 
 		virtual void printScript (std::ostream &os);
 	protected:
 		virtual bool endLoop ();
 	private:
 		rts2operands::Operand *condition;
+		rts2expression::CompiledExpression compiledCondition;
 		int max_cycles;
 };
 
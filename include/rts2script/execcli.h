@@ -55,6 +55,9 @@
 // slew to target, and do not wait for clearing of the block state
 #define EVENT_SLEW_TO_TARGET_NOW           RTS2_LOCAL_EVENT+68
 
+// telescope started to move
+#define EVENT_MOVE_STARTED                 RTS2_LOCAL_EVENT+69
+
 namespace rts2script
 {
 
@@ -163,6 +166,7 @@ class DevClientTelescopeExec:public rts2image::DevClientTelescopeImage
 		int syncTarget (bool now = false, int plan_id = -1);
 		void checkInterChange ();
 	protected:
+		virtual void moveStart (bool correcting);
 		virtual void moveEnd ();
 	public:
 		DevClientTelescopeExec (rts2core::Connection * in_connection);
@@ -62,12 +62,14 @@ class QueuedTarget:public rts2db::QueueEntry
 		{
 			target = qt.target;
 			unobservable_reported = qt.unobservable_reported;
+			simulStarted = qt.simulStarted;
 		}
 
 		QueuedTarget (const QueuedTarget &qt, rts2db::Target *_target):rts2db::QueueEntry (qt)
 		{
 			target = _target;
 			unobservable_reported = false;
+			simulStarted = false;
 		}
 
 		~QueuedTarget () {}
@@ -82,6 +84,9 @@ class QueuedTarget:public rts2db::QueueEntry
 		bool hard;
 
 		bool unobservable_reported;
+
+		// observation of the entry was started in simulation
+		bool simulStarted;
 };
 
 /**
@@ -129,7 +134,7 @@ class TargetQueue:public std::list <QueuedTarget>
 		// order by given target list
 		void orderByTargetList (std::list <rts2db::Target *> tl);
 
-		double getMaximalDuration (rts2db::Target *tar, struct ln_equ_posn *currentp = NULL, int runnum = 0);
+		virtual double getMaximalDuration (rts2db::Target *tar, struct ln_equ_posn *currentp = NULL, int runnum = 0);
 
 		/**
 		 * Put next target on front of the queue.
@@ -211,7 +216,23 @@ class TargetQueue:public std::list <QueuedTarget>
 		 */
 		virtual TargetQueue::iterator removeEntry (TargetQueue::iterator &iter, const removed_t reason) = 0;
 
-		bool isAboveHorizon (QueuedTarget &tar, double &JD);
+		virtual bool isAboveHorizon (QueuedTarget &tar, double &JD);
+
+		/**
+		 * Returns target for entry which is put again to the queue.
+		 * The default implementation loads new target from the database.
+		 */
+		virtual rts2db::Target *reloadTarget (rts2db::Target *tar) { return createTarget (tar->getTargetID (), *observer, obs_altitude); }
+
+		/**
+		 * Called when queue entry does not need its target anymore.
+		 */
+		virtual void releaseTarget (rts2db::Target *tar) { delete tar; }
+
+		/**
+		 * Returns true if observation of the entry was started.
+		 */
+		virtual bool observationStarted (QueuedTarget &qt) { return qt.target->observationStarted (); }
 
 		// return true if its't time to remove first element from the queue. This is usaully when the
 		// second observation next time is before the current time
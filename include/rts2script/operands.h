@@ -23,6 +23,7 @@
 #include "error.h"
 #include "utilsfunc.h"
 #include "block.h"
+#include "compiledexpression.h"
 
 #include <vector>
 #include <ostream>
@@ -48,6 +49,12 @@ class Operand
 		// return as number..
 		virtual double getDouble ();
 
+		/**
+		 * Append code computing operand value to compiled
+		 * expression. Default implementation calls getDouble.
+		 */
+		virtual void compile (rts2expression::CompiledExpression &program);
+
 		// return as string..
 
 		friend std::ostream & operator << (std::ostream &_os, Operand &_op)
@@ -66,6 +73,7 @@ class Number:public Operand
 	public:
 		Number (double _val) { val = _val; }
 		virtual double getDouble () { return val; }
+		virtual void compile (rts2expression::CompiledExpression &program) { program.pushConst (val); }
 		virtual std::ostream & writeTo (std::ostream &_os) { _os << getDouble (); return _os; }
 	private:
 		double val;
@@ -82,6 +90,7 @@ class SystemValue:public Operand
 	public:
 		SystemValue (rts2core::Block *_master, std::string _device, std::string _value):Operand () { master = _master; device = _device; value = _value; }
 		virtual double getDouble ();
+		virtual void compile (rts2expression::CompiledExpression &program) { program.pushValue (device.c_str (), value.c_str (), true); }
 		virtual std::ostream & writeTo (std::ostream &_os) { _os << getDouble (); return _os; }
 	private:
 		rts2core::Block *master;
@@ -179,6 +188,8 @@ class OperandsLREquation:public Operand
 		 * Evaluate equation. Return 0 if it false, otherwise 1.
 		 */
 		virtual double getDouble ();
+
+		virtual void compile (rts2expression::CompiledExpression &program);
 		
 		virtual std::ostream & writeTo (std::ostream &_os) { _os << l->getDouble () << getCmpSymbol () << r->getDouble (); return _os; }
 	private:
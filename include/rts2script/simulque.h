@@ -21,21 +21,100 @@
 #define __RTS2_SIMULQUEUE__
 
 #include "rts2script/executorque.h"
+#include "rts2script/script.h"
+
+#include <map>
+#include <pthread.h>
 
 namespace rts2plan
 {
+
+class SimulQueue;
+
+/**
+ * Target used in simulation. Target is loaded only once for the whole
+ * simulation, together with its scripts. Target visibility (horizon and
+ * constraints) is precomputed on grid covering the simulated interval, so
+ * simulation steps do not access the database.
+ */
+class SimulTarget
+{
+	public:
+		/**
+		 * Prepare target for simulation.
+		 *
+		 * @param _target   target, owned by SimulTarget
+		 * @param cameras   cameras for which scripts are loaded
+		 * @param observer  observer position
+		 * @param from      simulation start (ctime)
+		 * @param to        simulation end (ctime)
+		 * @param step      visibility grid step (seconds)
+		 */
+		SimulTarget (rts2db::Target *_target, rts2db::CamList &cameras, struct ln_lnlat_posn *observer, double from, double to, double step);
+		~SimulTarget ();
+
+		rts2db::Target *getTarget () { return target; }
+
+		/**
+		 * Returns maximal duration of target scripts.
+		 *
+		 * @return maximal duration in seconds, NAN if some script cannot be loaded
+		 */
+		double getMaximalDuration (struct ln_equ_posn *currentp, int runnum);
+
+		/**
+		 * Returns true if target is visible at the given time. Times
+		 * outside of simulated interval are reported as not visible.
+		 *
+		 * @param JD               Julian date
+		 * @param testConstraints  if true, target constraints must be satisfied as well
+		 */
+		bool isVisible (double JD, bool testConstraints);
+
+		/**
+		 * Returns time when target constraints will not be satisfied.
+		 * Same as rts2db::Target::getSatisfiedDuration, but uses
+		 * precomputed grid.
+		 *
+		 * @return time when constraints will not be satisfied, NAN if they are not satisfied at from + length, INFINITY if they are satisfied till the end of interval
+		 */
+		double getSatisfiedDuration (double from, double to, double length);
+
+	private:
+		rts2db::Target *target;
+
+		// scripts for cameras, NULL if script cannot be loaded
+		std::vector <rts2script::Script *> scripts;
+
+		double JDfrom;
+		double JDstep;
+
+		std::vector <bool> aboveHorizon;
+		std::vector <bool> satisfied;
+
+		int gridIndex (double JD);
+};
+
 /**
  * Hold queue entries for simulation. As the code cannot remove observed
  * targets from real queues, it must create and fill queues for simulation.
+ * Entries use targets cached in simulation queue, and are not stored in
+ * the database.
  */
 class SimulQueueTargets:public TargetQueue
 {
 	public:
-		SimulQueueTargets (ExecutorQueue &eq);
+		SimulQueueTargets (ExecutorQueue &eq, SimulQueue *_simul);
 		~SimulQueueTargets ();
 
 		void clearNext ();
 
+		virtual double getMaximalDuration (rts2db::Target *tar, struct ln_equ_posn *currentp = NULL, int runnum = 0);
+
+		virtual bool isAboveHorizon (QueuedTarget &tar, double &JD);
+
+		double getSatisfiedDuration (rts2db::Target *tar, double from, double to, double length);
+
 	protected:
 		virtual int getQueueType () { return queueType; }
 		virtual const bool getSkipBelowHorizon () { return skipBelowHorizon; }
@@ -45,7 +124,14 @@ class SimulQueueTargets:public TargetQueue
 		virtual const bool getCheckTargetLength () { return checkTargetLength; }
 
 		virtual TargetQueue::iterator removeEntry (TargetQueue::iterator &iter, const removed_t reason);
+
+		virtual rts2db::Target *reloadTarget (rts2db::Target *tar) { return tar; }
+		virtual void releaseTarget (rts2db::Target *tar) {}
+		virtual bool observationStarted (QueuedTarget &qt) { return qt.simulStarted; }
+
 	private:
+		SimulQueue *simul;
+
 		int queueType;
 		bool removeAfterExecution;
 		bool skipBelowHorizon;
@@ -57,6 +143,11 @@ class SimulQueueTargets:public TargetQueue
 /**
  * Simulation queue. Allows to simulate observing run from queues.
  *
+ * Targets, their scripts and visibility are prepared in start (), which
+ * must be called from the thread holding database connection. Simulation
+ * then runs in a separate thread, progress of the simulation is reported
+ * by progress () call.
+ *
  * @author Petr Kubanek <kubanek@fzu.cz>
  */
 class SimulQueue:public ExecutorQueue
@@ -65,22 +156,70 @@ class SimulQueue:public ExecutorQueue
 		SimulQueue (rts2db::DeviceDb *master, const char *name, struct ln_lnlat_posn **_observer, Queues *_queues);
 		virtual ~SimulQueue ();
 
+		/**
+		 * Prepare targets and start simulation thread. Running
+		 * simulation is stopped.
+		 */
 		void start (double from, double to);
 
+		/**
+		 * Stop running simulation.
+		 */
+		void stop ();
+
 		/**
 		 * Performs one step of the simulation.
 		 *
 		 * @return Progress (0-1 range) of the simulation, 2 if simulation was done. Negative values means that queue target cannot be selected, but progress is reporetd anyway
 		 */
 		double step ();
+
+		/**
+		 * Returns simulation progress. Must be called periodically
+		 * from the main thread. When simulation is done, queue values
+		 * are updated.
+		 *
+		 * @param time    current simulation time
+		 * @param starts  starts of intervals without selected target found since the last call
+		 * @param ends    ends of intervals without selected target found since the last call
+		 *
+		 * @return progress (0-1 range), 2 if simulation was done, NAN if simulation is not running
+		 */
+		double progress (double &time, std::vector <double> &starts, std::vector <double> &ends);
 		
 		/**
 		 * Get simulation time.
 		 *
-		 * @return current simulation time. You can get simulation progress when calling step ().
-		 * @see step()
+		 * @return current simulation time. You can get simulation progress when calling progress ().
+		 * @see progress()
+		 */
+		double getSimulationTime ();
+
+		/**
+		 * Queue message logged from the simulation thread. Queued
+		 * messages are logged from progress (), called from the main
+		 * thread.
+		 *
+		 * @return true if message was queued, false if it was not logged from the simulation thread
 		 */
-		double getSimulationTime () { return t; } 
+		bool queueMessage (messageType_t type, const char *msg);
+
+		/**
+		 * Returns target prepared for simulation, NULL if target was not prepared.
+		 */
+		SimulTarget *getSimulTarget (int tar_id);
+
+		/**
+		 * Step of visibility grid (seconds).
+		 */
+		static const double visibilityStep;
+
+	protected:
+		/**
+		 * Load target for simulation. Called from start () for every
+		 * target in the queues.
+		 */
+		virtual rts2db::Target *loadTarget (int tar_id) { return createTarget (tar_id, *observer, obs_altitude); }
 
 	private:
 		// list of simulation input queues
@@ -89,6 +228,32 @@ class SimulQueue:public ExecutorQueue
 
 		std::vector <SimulQueueTargets> sqs;
 
+		// targets prepared for simulation, indexed by target ID
+		std::map <int, SimulTarget *> targets;
+
+		pthread_t thread;
+		bool running;
+
+		// guards values below, shared with simulation thread
+		pthread_mutex_t mutex;
+		bool stopRequested;
+		bool done;
+		double simulTime;
+		double simulProgress;
+		std::vector <double> freeStarts;
+		std::vector <double> freeEnds;
+		// messages logged by simulation thread
+		bool threadLogging;
+		pthread_t loggingThread;
+		std::vector <std::pair <messageType_t, std::string> > messages;
+
+		void logMessages ();
+
+		static void *simulationThread (void *arg);
+		void run ();
+
+		void clearTargets ();
+
 		double from;
 		double fr;
 		double to;
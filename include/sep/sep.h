@@ -237,6 +237,11 @@ int sep_extract(sep_image *image,
 void sep_set_extract_pixstack(size_t val);
 size_t sep_get_extract_pixstack(void);
 
+/* set and get the number of threads used by sep_background() and
+ * sep_extract(). Results do not depend on the number of threads. [1] */
+void sep_set_nthreads(int n);
+int sep_get_nthreads(void);
+
 /* free memory associated with a catalog */
 void sep_catalog_free(sep_catalog *catalog);
 
@@ -79,6 +79,9 @@ typedef void (*array_writer)(float *ptr, int n, void *target);
 float fqmedian(float *ra, int n);
 void put_errdetail(char *errtext);
 
+/* run func on n argument structs of argsize bytes, each in its own thread */
+int runparallel(void *(*func)(void *), void *args, int n, size_t argsize);
+
 int get_converter(int dtype, converter *f, int *size);
 int get_array_converter(int dtype, array_converter *f, int *size);
 int get_array_writer(int dtype, array_writer *f, int *size);
@@ -0,0 +1,265 @@
+/*
+ * Lock-free frame ring in POSIX shared memory.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_SHMRING__
+#define __RTS2_SHMRING__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+#include "imghdr.h"
+
+#define SHMRING_MAGIC     0x52545332
+#define SHMRING_VERSION   1
+
+// maximal number of channels in a frame
+#define SHMRING_MAX_CHANNELS  16
+
+namespace rts2core
+{
+
+/**
+ * Header of the ring, at the beginning of the shared memory.
+ */
+struct ShmRingHeader
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t nslots;
+	uint32_t reserved;
+	// size of the slot payload
+	uint64_t slotSize;
+	// offset of the first slot, distance between slots
+	uint64_t slotOffset;
+	uint64_t slotStride;
+	// number of published frames; written atomically
+	uint64_t published;
+};
+
+/**
+ * Frame slot header. Frame data follow the header.
+ *
+ * seq works as a sequence lock: it is odd while the writer fills the slot,
+ * and 2 * (frame + 1) once frame number frame is complete. Reader copies
+ * the data and checks that seq did not change during the copy.
+ */
+struct ShmRingSlot
+{
+	uint64_t seq;
+	uint64_t frame;
+	// frame time (ctime with fraction)
+	double timestamp;
+	// number of channels and their sizes; channel data follow each other
+	uint32_t channels;
+	uint32_t reserved;
+	uint64_t chanSizes[SHMRING_MAX_CHANNELS];
+	// image header of the first channel
+	struct imghdr header;
+};
+
+/**
+ * Info about the frame read from the ring.
+ */
+class ShmFrameInfo
+{
+	public:
+		ShmFrameInfo () { frame = 0; timestamp = 0; channels = 0; size = 0; }
+
+		uint64_t frame;
+		double timestamp;
+		int channels;
+		size_t chanSizes[SHMRING_MAX_CHANNELS];
+		size_t size;
+		struct imghdr header;
+};
+
+/**
+ * Writer side of the shared memory frame ring. Single writer publishes
+ * frames into N slots, overwriting the oldest. Writer never waits for the
+ * readers, readers detect frames overwritten during the copy from the slot
+ * sequence counter.
+ *
+ * Ring is created either as named POSIX shared memory (readers attach with
+ * its name), or as an anonymous memfd when name is NULL (for threads and
+ * forked processes).
+ *
+ * @ingroup RTS2Block
+ */
+class ShmRingWriter
+{
+	public:
+		ShmRingWriter ();
+		~ShmRingWriter ();
+
+		/**
+		 * Create the ring.
+		 *
+		 * @param name      shared memory name (starting with /), NULL for memfd
+		 * @param nslots    number of frame slots
+		 * @param slotSize  maximal size of frame data
+		 *
+		 * @return -1 on error (errno set), 0 on success
+		 */
+		int create (const char *name, int nslots, size_t slotSize);
+
+		const char *getName () { return name.c_str (); }
+
+		int getFd () { return fd; }
+
+		int getSlots ();
+
+		size_t getSlotSize ();
+
+		/**
+		 * Start writing new frame. Marks the slot as being written.
+		 *
+		 * @return pointer to slot data
+		 */
+		char *beginFrame ();
+
+		/**
+		 * Data of the channel in the frame being written.
+		 *
+		 * @param offset  channel offset in slot data
+		 */
+		char *getFrameData (size_t offset = 0) { return frameData + offset; }
+
+		/**
+		 * Publish the frame.
+		 *
+		 * @param channels   number of channels
+		 * @param chanSizes  size of each channel data
+		 * @param header     image header of the first channel, can be NULL
+		 * @param timestamp  frame time
+		 */
+		void endFrame (int channels, size_t *chanSizes, struct imghdr *header, double timestamp);
+
+		/**
+		 * Publish single channel frame.
+		 */
+		void endFrame (size_t size, struct imghdr *header, double timestamp) { endFrame (1, &size, header, timestamp); }
+
+		/**
+		 * Drop frame being written. Slot stays marked as invalid until
+		 * it is reused.
+		 */
+		void abortFrame ();
+
+		/**
+		 * Returns number of published frames.
+		 */
+		uint64_t getPublished ();
+
+		bool isWriting () { return frameData != NULL; }
+
+	private:
+		std::string name;
+		int fd;
+		struct ShmRingHeader *ring;
+		size_t mapSize;
+
+		char *frameData;
+		struct ShmRingSlot *frameSlot;
+
+		void unmap ();
+};
+
+/**
+ * Reader side of the shared memory frame ring.
+ *
+ * In "latest" mode reader gets the newest complete frame, skipping the
+ * frames it missed. In "every" mode it gets frames in order; if it falls
+ * more than ring size behind, the overwritten frames are counted as lost
+ * and reading continues with the oldest frame available.
+ *
+ * @ingroup RTS2Block
+ */
+class ShmRingReader
+{
+	public:
+		ShmRingReader ();
+		~ShmRingReader ();
+
+		/**
+		 * Attach to named ring.
+		 *
+		 * @return -1 on error (errno set), 0 on success
+		 */
+		int attach (const char *name);
+
+		/**
+		 * Attach to ring from file descriptor (memfd).
+		 */
+		int attachFd (int fd);
+
+		size_t getSlotSize ();
+
+		/**
+		 * Copy latest complete frame.
+		 *
+		 * @param buf    buffer for frame data, at least getSlotSize () bytes
+		 * @param info   frame info
+		 *
+		 * @return 1 if new frame was copied, 0 if there isn't newer frame than the last one returned, -1 on error
+		 */
+		int readLatest (char *buf, ShmFrameInfo &info);
+
+		/**
+		 * Copy next frame in order.
+		 *
+		 * @return 1 if frame was copied, 0 if no new frame is available, -1 on error
+		 */
+		int readNext (char *buf, ShmFrameInfo &info);
+
+		/**
+		 * Number of frames the reader missed in "every" mode,
+		 * because they were overwritten.
+		 */
+		uint64_t getLost () { return lost; }
+
+		/**
+		 * Number of published frames.
+		 */
+		uint64_t getPublished ();
+
+	private:
+		int fd;
+		struct ShmRingHeader *ring;
+		size_t mapSize;
+
+		// next frame to read in "every" mode
+		uint64_t next;
+		uint64_t lost;
+		// last frame returned by readLatest
+		uint64_t lastLatest;
+
+		int map (int _fd);
+
+		/**
+		 * Copy frame from slot.
+		 *
+		 * @return 1 on success, 0 if frame is not in the slot (overwritten or being written)
+		 */
+		int copyFrame (uint64_t frame, char *buf, ShmFrameInfo &info);
+};
+
+}
+
+#endif // !__RTS2_SHMRING__
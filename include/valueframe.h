@@ -0,0 +1,125 @@
+/*
+ * Binary framing of value updates.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_VALUEFRAME__
+#define __RTS2_VALUEFRAME__
+
+#include <string>
+#include <vector>
+
+#include "valuelist.h"
+
+/**
+ * Version of binary value frame encoding. Send as parameter of
+ * COMMAND_VALUE_FRAMES command.
+ */
+#define VALUE_FRAME_VERSION     1
+
+/**
+ * Maximal size of the value frame. Frames announced with bigger size are
+ * treated as protocol error.
+ */
+#define VALUE_FRAME_MAX_SIZE    (64 * 1024 * 1024)
+
+// record types
+#define VF_DOUBLE               1
+#define VF_FLOAT                2
+#define VF_INTEGER              3
+#define VF_LONG                 4
+#define VF_STRING               5
+#define VF_DOUBLE_ARRAY         6
+#define VF_INTEGER_ARRAY        7
+
+namespace rts2core
+{
+
+/**
+ * Batch of value updates in binary form. Used instead of PROTO_VALUE text
+ * lines on connections which negotiated binary value updates.
+ *
+ * Frame is a sequence of records. Each record starts with one byte record
+ * type, two bytes name length and value name, followed by the value.
+ * Numbers are stored little endian, integers as 4 bytes, long integers and
+ * doubles as 8 bytes, floats as 4 bytes. Strings and arrays are prefixed
+ * with 4 bytes element count.
+ *
+ * Only simple values and arrays of numbers are encoded. Composite values
+ * (statistics, min-max, RA/DEC,..) are send as text.
+ *
+ * @ingroup RTS2Protocol
+ */
+class ValueFrame
+{
+	public:
+		ValueFrame ();
+
+		/**
+		 * Returns record type used to encode the value.
+		 *
+		 * @return record type, 0 if value cannot be encoded and must be send as text
+		 */
+		static int encodingType (Value *value);
+
+		/**
+		 * Append value to the frame.
+		 *
+		 * @return false if value cannot be encoded
+		 */
+		bool add (Value *value);
+
+		bool empty () { return buf.empty (); }
+
+		size_t size () { return buf.size (); }
+
+		const char *data () { return buf.data (); }
+
+		/**
+		 * Number of values in the frame.
+		 */
+		int getCount () { return count; }
+
+		void clear ();
+
+		/**
+		 * Decode frame, set values found in values vector. Values
+		 * which are not found in the vector, or which record type
+		 * does not match value type, are skipped.
+		 *
+		 * @param data     frame data
+		 * @param len      frame length
+		 * @param values   values to update
+		 * @param updated  if not NULL, updated values are appended to it
+		 *
+		 * @return number of records decoded, -1 on malformed frame
+		 */
+		static int decode (const char *data, size_t len, ValueVector &values, std::vector <Value *> *updated = NULL);
+
+	private:
+		std::string buf;
+		int count;
+
+		void putUInt16 (uint16_t v);
+		void putUInt32 (uint32_t v);
+		void putUInt64 (uint64_t v);
+		void putDouble (double v);
+};
+
+}
+
+#endif // !__RTS2_VALUEFRAME__
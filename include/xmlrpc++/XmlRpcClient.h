@@ -63,6 +63,13 @@ namespace XmlRpc
 					_authorization = std::string("");
 			}
 
+			//! Compress bodies of POST requests with deflate. Server must
+			//! understand Content-Encoding: deflate. Bodies are sent
+			//! uncompressed if RTS2 was compiled without zlib.
+			void setDeflateRequests (bool deflate) { _deflateRequests = deflate; }
+
+			bool getDeflateRequests () { return _deflateRequests; }
+
 			//! Execute the named procedure on the remote server.
 			//!  @param method The name of the remote procedure to execute
 			//!  @param params An array of the arguments for the method
@@ -129,7 +136,7 @@ namespace XmlRpc
 			virtual bool generateGetRequest(const char* path, const char* body);
 			virtual bool generatePostRequest(const char* path, const char* body);
 			virtual std::string generateHeader(std::string const& body);
-			virtual std::string generateGetPostHeader(std::string const& path, size_t contentLength, bool post);
+			virtual std::string generateGetPostHeader(std::string const& path, size_t contentLength, bool post, const char *contentEncoding = NULL);
 			virtual bool writeRequest();
 			virtual bool readHeader();
 			virtual bool readResponse();
@@ -144,6 +151,9 @@ namespace XmlRpc
 			std::string _host;
 			std::string _authorization;
 			std::string _uri;
+
+			// compress POST request bodies
+			bool _deflateRequests;
 			int _port;
 
 			std::string _proxy_host;
@@ -18,6 +18,7 @@
 #define HTTP_OK              200
 #define HTTP_BAD_REQUEST     400
 #define HTTP_UNAUTHORIZED    401
+#define HTTP_TOO_LARGE       413
 
 namespace XmlRpc
 {
@@ -26,6 +26,9 @@
 
 #include "XmlRpcSource.h"
 
+//! Default limit of request body size, after compressed body is inflated
+#define XMLRPC_MAX_REQUEST_SIZE   (16 * 1024 * 1024)
+
 
 namespace XmlRpc
 {
@@ -77,6 +80,11 @@ namespace XmlRpc
 			//! Specify default GET request handler
 			void setDefaultGetRequest(XmlRpcServerGetRequest *defaultGetRequest);
 
+			//! Set maximal size of request body. Larger requests are rejected with HTTP 413.
+			void setMaxRequestSize(size_t maxRequestSize) { _maxRequestSize = maxRequestSize; }
+
+			size_t getMaxRequestSize() const { return _maxRequestSize; }
+
 			//! Add a GET request to the HTTP server
 			void addGetRequest(XmlRpcServerGetRequest* serverGetRequest);
 
@@ -155,6 +163,9 @@ namespace XmlRpc
 			// system methods
 			XmlRpcServerMethod* _listMethods;
 			XmlRpcServerMethod* _methodHelp;
+
+			// Maximal size of (inflated) request body
+			size_t _maxRequestSize;
 		private:
 			XmlRpcServerGetRequest* _defaultGetRequest;
 	};
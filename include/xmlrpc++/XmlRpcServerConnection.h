@@ -89,6 +89,13 @@ namespace XmlRpc
 			// Set response
 			void setResponse(char *_response, size_t _response_length);
 
+			/**
+			 * Set response to GET request which was put to asynchronous
+			 * mode, and start writing it. Response is owned by the
+			 * connection after the call, it must be allocated with new[].
+			 */
+			void setAsyncResponse (int http_code, const char *response_type, char *response, size_t response_length);
+
 			// Switch connection to chunged response mode.
 			void goChunked () { _contentLength = -1; }
 
@@ -125,6 +132,9 @@ namespace XmlRpc
 			void generateJSONFaultResponse(std::string const& msg, int errorCode);
 			std::string generateHeader(std::string const& body);
 
+			// Fill _get_response_header for the current response
+			void prepareGetHeader (int http_code, const char *response_type);
+
 			// The XmlRpc server that accepted this connection
 			XmlRpcServer* _server;
 
@@ -150,6 +160,15 @@ namespace XmlRpc
 			// Number of bytes expected in the request body (parsed from header)
 			int _contentLength;
 
+			// Request body is compressed with deflate (Content-Encoding: deflate)
+			bool _deflated;
+
+			// Inflate request body, returns HTTP_OK or HTTP code of the error
+			int inflateRequest();
+
+			// Reply with error and close connection, request body is not processed
+			bool rejectRequest(int http_code, const char *reason);
+
 			// Request body
 			char* _request_buf;
 			int _request_length;
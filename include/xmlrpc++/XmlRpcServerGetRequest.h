@@ -21,6 +21,7 @@
 #define HTTP_OK              200
 #define HTTP_BAD_REQUEST     400
 #define HTTP_UNAUTHORIZED    401
+#define HTTP_TOO_LARGE       413
 
 namespace XmlRpc
 {
@@ -114,6 +115,9 @@ namespace XmlRpc
 
 			void setConnection (XmlRpcServerConnection *_connection) { connection = _connection; }
 
+			//! Set list collecting headers of requests executed in the calling thread. Worker threads, which execute requests outside of the server loop, must not touch the connection, as it can be closed in the meantime; headers are passed to the connection from the server loop. NULL resets it, so headers are added to connection set by setConnection.
+			static void setThreadHeaders (std::list <std::pair <const char*, std::string> > *_headers);
+
 			//! Send JSON to XmlRpcSource connection. Re-enables read mask (as async call finished)
 			void sendAsyncJSON (std::ostringstream &_os, XmlRpcServerConnection *source);
 
@@ -125,7 +129,7 @@ namespace XmlRpc
 
 			XmlRpcServerConnection *connection;
 
-			void addExtraHeader (const char *name, const char *value) { connection->addExtraHeader (name, value); }
+			void addExtraHeader (const char *name, std::string value);
 			/**
 			 * Specify max age in seconds. For this time cached response will be valid. This method
 			 * is provide for convinient setting of cache timeout.
@@ -136,7 +140,7 @@ namespace XmlRpc
 			{
 				std::ostringstream _os;
 				_os << "max-age=" << maxage;
-				connection->addExtraHeader ("Cache-Control", _os.str ());
+				addExtraHeader ("Cache-Control", _os.str ());
 			}
 		private:
 			std::string _prefix;
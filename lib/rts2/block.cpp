@@ -65,6 +65,8 @@ Block::Block (int in_argc, char **in_argv):App (in_argc, in_argv)
 
 	masterState = SERVERD_HARD_OFF;
 	stateMasterConn = NULL;
+	valuesGeneration = 0;
+	connectionIndexValid = false;
 	// allocate ports dynamically
 	port = 0;
 }
@@ -169,28 +171,25 @@ void Block::removeConnection (Connection *_conn)
 		else
 			iter++;
 	}
+	connectionsChanged ();
 }
 
 void Block::addCentraldConnection (Connection *_conn, bool added)
 {
 	if (added)
+	{
 	  	centraldConns.push_back (_conn);
+		connectionsChanged ();
+	}
 	else
+	{
 		centraldConns_added.push_back (_conn);
+	}
 }
 
 Connection * Block::findName (const char *in_name)
 {
-	connections_t::iterator iter;
-	for (iter = connections.begin (); iter != connections.end (); iter++)
-	{
-		Connection *conn = *iter;
-		if (!strcmp (conn->getName (), in_name))
-			return conn;
-	}
-	// if connection not found, try to look to list of available
-	// connections
-	return NULL;
+	return getOpenConnection (in_name);
 }
 
 Connection * Block::findCentralId (int in_id)
@@ -274,6 +273,9 @@ int Block::idle ()
 		(*iter)->idle ();
 
 	// add from connection queue..
+	if (!connections_added.empty () || !centraldConns_added.empty ())
+		connectionsChanged ();
+
 	for (iter = connections_added.begin (); iter != connections_added.end (); iter = connections_added.erase (iter))
 	{
 		connections.push_back (*iter);
@@ -327,6 +329,7 @@ void Block::pollSuccess ()
 				iter = connections.erase (iter);
 				connectionRemoved (conn);
 				delete conn;
+				connectionsChanged ();
 			}
 			else
 			{
@@ -353,6 +356,7 @@ void Block::pollSuccess ()
 				iter = centraldConns.erase (iter);
 				connectionRemoved (conn);
 				delete conn;
+				connectionsChanged ();
 			}
 			else
 			{
@@ -379,6 +383,8 @@ void Block::oneRunLoop ()
 	struct timespec read_tout;
 	double t_diff;
 
+	double nextUpdate = flushValueUpdates ();
+
 	if (timers.begin () != timers.end () && (USEC_SEC * (t_diff = (timers.begin ()->first - getNow ()))) < idle_timeout)
 	{
 		if (t_diff <= 0)
@@ -406,14 +412,69 @@ void Block::oneRunLoop ()
 		}
 	}
 
+	// wake up to send values held by rate limit
+	if (!isnan (nextUpdate))
+	{
+		t_diff = nextUpdate - getNow ();
+		if (t_diff < 0)
+			t_diff = 0;
+		if (t_diff < read_tout.tv_sec + read_tout.tv_nsec / (double) NSEC_SEC)
+		{
+			read_tout.tv_sec = t_diff;
+			read_tout.tv_nsec = (t_diff - floor (t_diff)) * NSEC_SEC;
+		}
+	}
+
 	addPollSocks ();
-	if (ppoll (fds, npolls, &read_tout, NULL) > 0)
-		pollSuccess ();
-	ret = idle ();
+	if (statsEnabled ())
+	{
+		double t_start = statsNow ();
+		ret = ppoll (fds, npolls, &read_tout, NULL);
+		double t_polled = statsNow ();
+		// lag is recorded only for timeouts, as other wakeups are expected to come early
+		if (ret == 0)
+			loopStats.lag.record (t_polled - t_start - (read_tout.tv_sec + read_tout.tv_nsec / (double) NSEC_SEC));
+		if (ret > 0)
+		{
+			pollSuccess ();
+			t_start = statsNow ();
+			loopStats.poll.record (t_start - t_polled);
+		}
+		else
+		{
+			t_start = t_polled;
+		}
+		ret = idle ();
+		loopStats.idle.record (statsNow () - t_start);
+	}
+	else
+	{
+		if (ppoll (fds, npolls, &read_tout, NULL) > 0)
+			pollSuccess ();
+		ret = idle ();
+	}
 	if (ret == -1)
 		endRunLoop ();
 }
 
+double Block::flushValueUpdates ()
+{
+	double next = NAN;
+	connections_t::iterator iter;
+	for (int i = 0; i < 2; i++)
+	{
+		connections_t *conns = (i == 0) ? &connections : &centraldConns;
+		for (iter = conns->begin (); iter != conns->end (); iter++)
+		{
+			double n = (*iter)->flushValueUpdates ();
+			if (!isnan (n) && (isnan (next) || n < next))
+				next = n;
+			(*iter)->flushValueFrame ();
+		}
+	}
+	return next;
+}
+
 int Block::deleteConnection (Connection * conn)
 {
 	if (conn->isConnState (CONN_DELETE))
@@ -738,33 +799,8 @@ void Block::deleteAddress (int p_centrald_num, const char *p_name)
 
 DevClient * Block::createOtherType (Connection * conn, int other_device_type)
 {
-	switch (other_device_type)
-	{
-		case DEVICE_TYPE_MOUNT:
-			return new DevClientTelescope (conn);
-		case DEVICE_TYPE_CCD:
-			return new DevClientCamera (conn);
-		case DEVICE_TYPE_DOME:
-			return new DevClientDome (conn);
-		case DEVICE_TYPE_CUPOLA:
-			return new DevClientCupola (conn);
-		case DEVICE_TYPE_PHOT:
-			return new DevClientPhot (conn);
-		case DEVICE_TYPE_FW:
-			return new DevClientFilter (conn);
-		case DEVICE_TYPE_EXECUTOR:
-			return new DevClientExecutor (conn);
-		case DEVICE_TYPE_IMGPROC:
-			return new DevClientImgproc (conn);
-		case DEVICE_TYPE_SELECTOR:
-			return new DevClientSelector (conn);
-		case DEVICE_TYPE_GRB:
-			return new DevClientGrb (conn);
-		case DEVICE_TYPE_BB:
-			return new DevClientBB (conn);
-		default:
-			return new DevClient (conn);
-	}
+	DevClientFactory factory (conn);
+	return createDevClient (factory, other_device_type);
 }
 
 void Block::addClient (int p_centraldId, const char *p_login, const char *p_name)
@@ -801,16 +837,15 @@ void Block::deleteClient (int p_centraldId)
 
 Connection * Block::getOpenConnection (const char *deviceName)
 {
-	connections_t::iterator iter;
-
-	// try to find active connection..
-	for (iter = connections.begin (); iter != connections.end (); iter++)
+	if (!connectionIndexValid)
 	{
-		Connection *conn = *iter;
-		if (conn->isName (deviceName))
-			return conn;
+		// first connection with the name is indexed
+		connectionIndex.clear ();
+		for (connections_t::iterator iter = connections.begin (); iter != connections.end (); iter++)
+			connectionIndex.add ((*iter)->getName (), *iter);
+		connectionIndexValid = true;
 	}
-	return NULL;
+	return connectionIndex.find (deviceName);
 }
 
 void Block::getOpenConnectionType (int deviceType, connections_t::iterator &current)
@@ -27,6 +27,7 @@
 #include <fcntl.h>
 #include <time.h>
 #include <errno.h>
+#include <unistd.h>
 #include <iomanip>
 
 #include "camd.h"
@@ -51,11 +52,20 @@
 #define OPT_COMMENTS          OPT_LOCAL + 421
 #define OPT_HISTORIES         OPT_LOCAL + 422
 #define OPT_RTS2_COOLING      OPT_LOCAL + 423
+#define OPT_READOUT_THREAD    OPT_LOCAL + 424
+#define OPT_SHM_RING          OPT_LOCAL + 425
 
 #define EVENT_TEMP_CHECK      RTS2_LOCAL_EVENT + 676
 
 using namespace rts2camd;
 
+// readout thread routine
+void *readoutThreadRoutine (void *arg)
+{
+	((Camera *) arg)->runReadoutThread ();
+	return NULL;
+}
+
 FilterVal::FilterVal (Camera *master, const char *n, char fil)
 {
 	master->createValue (filter, (std::string ("FILT") + fil).c_str (), "used filter number", true, RTS2_VALUE_WRITABLE, CAM_EXPOSING);
@@ -206,6 +216,178 @@ int Camera::processData (char *data, size_t size)
 	return size;
 }
 
+int Camera::startReadoutThread ()
+{
+	readoutRing.allocate (readoutRingFrames, getNumChannels (), getWidth () * getHeight () * maxPixelByteSize ());
+
+	if (pipe (readoutPipe))
+	{
+		logStream (MESSAGE_ERROR) << "cannot create readout pipe: " << strerror (errno) << sendLog;
+		readoutPipe[0] = readoutPipe[1] = -1;
+		return -1;
+	}
+	fcntl (readoutPipe[0], F_SETFL, O_NONBLOCK);
+	fcntl (readoutPipe[1], F_SETFL, O_NONBLOCK);
+
+	int ret = pthread_create (&readoutThread, NULL, readoutThreadRoutine, this);
+	if (ret)
+	{
+		logStream (MESSAGE_ERROR) << "cannot start readout thread: " << strerror (ret) << sendLog;
+		return -1;
+	}
+	readoutThreadStarted = true;
+	return 0;
+}
+
+void Camera::stopReadoutThread ()
+{
+	if (!readoutThreadStarted)
+		return;
+	readoutAbortSeq = readoutSeq;
+	readoutJobs.push (-1);
+	// thread can wait for frame which main loop will not release
+	readoutRing.cancel ();
+	pthread_join (readoutThread, NULL);
+	readoutThreadStarted = false;
+
+	close (readoutPipe[0]);
+	close (readoutPipe[1]);
+	readoutPipe[0] = readoutPipe[1] = -1;
+}
+
+void Camera::runReadoutThread ()
+{
+	while (true)
+	{
+		long seq = readoutJobs.pop (true);
+		if (seq < 0)
+			break;
+		// readout was killed before it started
+		if (seq <= readoutAbortSeq.load ())
+			continue;
+
+		readoutFrame = readoutRing.acquire (seq);
+		if (readoutFrame < 0)
+		{
+			// ring was cancelled by stopReadoutThread, or is not allocated
+			if (seq > readoutAbortSeq.load ())
+			{
+				logStream (MESSAGE_ERROR) << "cannot get frame buffer for readout" << sendLog;
+				readoutRing.finish (-1, -1);
+				notifyReadout ();
+			}
+			continue;
+		}
+
+		int ret;
+		while (true)
+		{
+			if (seq <= readoutAbortSeq.load ())
+			{
+				ret = -1;
+				break;
+			}
+			ret = doReadout ();
+			if (ret < 0)
+				break;
+			if (ret > 0)
+				usleep (ret);
+		}
+
+		// chip is read, main loop can start next exposure while data are sent
+		if (ret == -2)
+			readoutReadSeq = seq;
+
+		readoutRing.finish (readoutFrame, ret);
+		readoutFrame = -1;
+		notifyReadout ();
+	}
+}
+
+void Camera::notifyReadout ()
+{
+	char c = 0;
+	// pipe full means main loop has not yet processed previous notifications
+	if (write (readoutPipe[1], &c, 1) < 0 && errno != EAGAIN)
+		std::cerr << "cannot notify main loop about readout data: " << strerror (errno) << std::endl;
+}
+
+void Camera::processReadoutRing ()
+{
+	char buf[100];
+	while (read (readoutPipe[0], buf, sizeof (buf)) > 0)
+		;
+
+	while (!readoutMessages.empty ())
+	{
+		std::pair <messageType_t, std::string> msg = readoutMessages.pop ();
+		rts2core::ScriptDevice::sendMessage (msg.first, msg.second.c_str ());
+	}
+
+	if (readoutQueued && !readoutChipRead && readoutReadSeq.load () == readoutSeq)
+	{
+		readoutChipRead = true;
+		// start queued exposure before the data are send out
+		if (quedExpNumber->getValueInteger () > 0 && exposureConn && queValues.empty ())
+			camExpose (exposureConn, getStateChip (0) & ~CAM_MASK_EXPOSE, true, lastCareBlock);
+	}
+
+	rts2core::FrameChunk chunk (-1, -1, 0, 0);
+	while (readoutRing.pop (chunk))
+	{
+		// readout failed before it got a frame
+		if (chunk.frame < 0)
+		{
+			if (!readoutQueued)
+				continue;
+			readoutQueued = false;
+			readoutChipRead = false;
+			readoutEnded (-1);
+			readoutFailed = false;
+			continue;
+		}
+		bool killed = readoutRing.getSequence (chunk.frame) <= readoutKilledSeq;
+		if (chunk.chan >= 0)
+		{
+			if (killed || readoutFailed)
+				continue;
+			char *data = readoutRing.getData (chunk.frame, chunk.chan) + chunk.offset;
+			// shared memory clients read data from the segment
+			if (currentImageTransfer == SHARED)
+				memcpy (getDataTop (chunk.chan), data, chunk.size);
+			if (sendReadoutData (data, chunk.size, chunk.chan) < 0)
+				readoutFailed = true;
+			continue;
+		}
+		// end of frame
+		readoutRing.release (chunk.frame);
+		if (killed)
+			continue;
+		readoutQueued = false;
+		readoutChipRead = false;
+		readoutEnded (readoutFailed ? -1 : chunk.ret);
+		readoutFailed = false;
+	}
+
+	if (readoutRingUsed)
+	{
+		readoutRingUsed->setValueInteger (readoutRing.getUsed ());
+		sendValueAll (readoutRingUsed);
+	}
+}
+
+long Camera::readoutBytesLeft (int chan)
+{
+	long chanBytes = chipByteSize ();
+	if (chan >= 0)
+		return chanBytes - readoutRing.getWritten (readoutFrame, chan);
+	int chnTot = dataChannels ? dataChannels->getValueInteger () : 1;
+	long ret = 0;
+	for (int i = 0; i < chnTot; i++)
+		ret += chanBytes - readoutRing.getWritten (readoutFrame, i);
+	return ret;
+}
+
 int Camera::deleteConnection (rts2core::Connection * conn)
 {
 	if (conn == exposureConn)
@@ -251,7 +433,8 @@ int Camera::endReadout ()
 			currentImageData = -1;
 		}
 	}
-	if (quedExpNumber->getValueInteger () > 0 && exposureConn)
+	// queued exposure could be already started after readout thread read the chip
+	if (quedExpNumber->getValueInteger () > 0 && exposureConn && !(readoutThreadStarted && (getStateChip (0) & (CAM_EXPOSING | CAM_EXPOSING_NOIM))))
 	{
 		// do not report that we start exposure
 		camExpose (exposureConn, getStateChip(0) & CAM_MASK_EXPOSE, true, lastCareBlock);
@@ -379,7 +562,7 @@ bool Camera::supportFrameTransfer ()
 	return false;
 }
 
-Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2core::ScriptDevice (in_argc, in_argv, DEVICE_TYPE_CCD, "C0")
+Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2core::ScriptDevice (in_argc, in_argv, DEVICE_TYPE_CCD, "C0"), readoutRing (), readoutJobs (), readoutMessages (), readoutAbortSeq (-1), readoutReadSeq (-1)
 {
 	binningRounding = binning_rounding;
 	expType = NULL;
@@ -434,6 +617,10 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 
 	sharedData = NULL;
 	sharedMemNum = -1;
+	shmRingSlots = 0;
+	shmRing = NULL;
+	shmRingName = NULL;
+	shmRingFrames = NULL;
 
 	currentImageData = -1;
 	currentImageTransfer = TCPIP;
@@ -444,6 +631,18 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 
 	lastCareBlock = true;
 
+	readoutThreaded = NULL;
+	readoutRingUsed = NULL;
+	readoutRingFrames = 0;
+	readoutThreadStarted = false;
+	readoutPipe[0] = readoutPipe[1] = -1;
+	readoutSeq = 0;
+	readoutKilledSeq = 0;
+	readoutQueued = false;
+	readoutChipRead = false;
+	readoutFailed = false;
+	readoutFrame = -1;
+
 	createValue (ccdRealType, "CCD_TYPE", "camera type", true, RTS2_VALUE_WRITABLE | RTS2_VALUE_AUTOSAVE);
 	createValue (serialNumber, "CCD_SER", "camera serial number", true, RTS2_VALUE_WRITABLE | RTS2_VALUE_AUTOSAVE);
 	createValue (ccdChipType, "CCD_CHIP", "camera chip type", true, RTS2_VALUE_WRITABLE | RTS2_VALUE_AUTOSAVE);
@@ -487,6 +686,8 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 	createValue (sepFluxes, "sep_fluxes", "star fluxes", false);
 
 	sepFind->setValueBool (false);
+	// star finding runs after readout, spread it over all processors
+	sep_set_nthreads (sysconf (_SC_NPROCESSORS_ONLN));
 
 	createValue (slitPosX, "slitposx", "[pixels] slit position along dithering axis", true, RTS2_VALUE_WRITABLE);
 	slitPosX->setValueDouble (-1);
@@ -578,6 +779,8 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 	addOption (OPT_WCS_CDELT, "wcs", 1, "WCS CD matrix (CRPIX1:CRPIX2:CDELT1:CDELT2:CROTA in default, unbinned configuration)");
 	addOption (OPT_WCS_MULTI, "wcs-multi", 1, "letter for multiple WCS (A-Z)");
 	addOption (OPT_WITHSHM, "with-shm", 2, "use given numbers of segments of shared memory");
+	addOption (OPT_SHM_RING, "shm-ring", 2, "publish images to lock-free shared memory ring with given number of slots (default to 4)");
+	addOption (OPT_READOUT_THREAD, "readout-thread", 2, "read chip in separate thread, into ring of given number of frames (default to 3)");
 
 	// detector sizes, channel starting points and offsets
 	addOption (OPT_DETSIZE, "detsize", 1, "detector size - X:Y:W:H");
@@ -589,7 +792,10 @@ Camera::Camera (int in_argc, char **in_argv, rounding_t binning_rounding):rts2co
 
 Camera::~Camera ()
 {
+	stopReadoutThread ();
+
 	delete sharedData;
+	delete shmRing;
 	delete fhd;
 
 	delete[] dataBuffers;
@@ -677,6 +883,16 @@ int Camera::killAll (bool callScriptEnds)
 {
 	timeReadoutStart = NAN;
 
+	if (readoutQueued)
+	{
+		// abort readout in thread, drop data it already read
+		readoutAbortSeq = readoutSeq;
+		readoutKilledSeq = readoutSeq;
+		readoutQueued = false;
+		readoutChipRead = false;
+		readoutFailed = false;
+	}
+
 	waitingForNotBop->setValueBool (false);
 	waitingForEmptyQue->setValueBool (false);
 
@@ -891,6 +1107,17 @@ int Camera::processOption (int in_opt)
 			else
 				sharedMemNum = atoi (optarg);
 			break;
+		case OPT_SHM_RING:
+			shmRingSlots = optarg ? atoi (optarg) : 4;
+			if (shmRingSlots < 2)
+			{
+				std::cerr << "at least two slots are needed for shared memory ring" << std::endl;
+				return -1;
+			}
+			createValue (shmRingName, "shm_ring", "name of shared memory frame ring", false);
+			createValue (shmRingFrames, "shm_ring_frames", "number of frames published to shared memory ring", false);
+			shmRingFrames->setValueLong (0);
+			break;
 
 		case OPT_DETSIZE:
 			{
@@ -917,6 +1144,18 @@ int Camera::processOption (int in_opt)
 			createValue (chan2offset, "CHAN2_OFFSETS", "[Y1 Y2 Y3 ..] channels Y offsets", false);
 			fillPairs (chan1offset, chan2offset, optarg);
 			break;
+		case OPT_READOUT_THREAD:
+			readoutRingFrames = optarg ? atoi (optarg) : 3;
+			if (readoutRingFrames < 2)
+			{
+				std::cerr << "at least two frames are needed for readout thread" << std::endl;
+				return -1;
+			}
+			createValue (readoutThreaded, "readout_thread", "read chip in separate thread", false, RTS2_VALUE_WRITABLE | RTS2_DT_ONOFF);
+			readoutThreaded->setValueBool (true);
+			createValue (readoutRingUsed, "readout_frames", "number of frames being read or send from readout ring", false);
+			readoutRingUsed->setValueInteger (0);
+			break;
 		case OPT_CHANNELS_DELTAS:
 			createValue (chan1delta, "CHAN1_DELTA", "[X1 X2 X3 ..] channels X deltas", false);
 			createValue (chan2delta, "CHAN2_DELTA", "[Y1 Y2 Y3 ..] channels Y deltas", false);
@@ -970,6 +1209,17 @@ int Camera::sendImage (char *data, size_t dataSize)
 
 int Camera::sendReadoutData (char *data, size_t dataSize, int chan)
 {
+	// readout thread only stores data in the ring, main loop sends them
+	if (inReadoutThread ())
+	{
+		if (readoutRing.write (readoutFrame, chan, data, dataSize))
+		{
+			logStream (MESSAGE_ERROR) << "readout data does not fit into frame buffer, channel " << chan << " size " << dataSize << sendLog;
+			return -1;
+		}
+		notifyReadout ();
+		return 0;
+	}
 	std::cerr << "Camera::sendReadoutData " << dataSize << " chan " << chan << " exposureConn " << exposureConn << std::endl;
 	// calculated..
 	if (calculateStatistics->getValueInteger () != STATISTIC_NO)
@@ -1079,6 +1329,13 @@ int Camera::sendReadoutData (char *data, size_t dataSize, int chan)
 	if (currentImageTransfer == SHARED)
 		sharedData->dataWritten (chan, dataSize);
 
+	if (shmRing && shmRing->isWriting ())
+	{
+		size_t chanSize = getWidth () * getHeight () * maxPixelByteSize ();
+		if (dataWritten[chan] + dataSize <= chanSize)
+			memcpy (shmRing->getFrameData (chan * chanSize + dataWritten[chan]), data, dataSize);
+	}
+
 	dataWritten[chan] += dataSize;
 
 	if (exposureConn && currentImageTransfer == TCPIP)
@@ -1255,6 +1512,17 @@ int Camera::initValues ()
 		}
 		logStream (MESSAGE_DEBUG) << "creating shared memory with " << sharedMemNum << " segments" << sendLog;
 	}
+	if (shmRingSlots > 0)
+	{
+		std::string rn = std::string ("/rts2_") + getDeviceName ();
+		shmRing = new rts2core::ShmRingWriter ();
+		if (shmRing->create (rn.c_str (), shmRingSlots, getNumChannels () * getWidth () * getHeight () * maxPixelByteSize ()))
+		{
+			logStream (MESSAGE_ERROR) << "cannot create shared memory frame ring " << rn << ": " << strerror (errno) << sendLog;
+			return -1;
+		}
+		shmRingName->setValueCharArr (rn.c_str ());
+	}
 	fhd = new struct imghdr;
 	focusingHeader = NULL;
 
@@ -1269,6 +1537,19 @@ int Camera::initValues ()
 	dataWritten = new size_t[getNumChannels ()];
 	memset (dataWritten, 0, getNumChannels () * sizeof (size_t));
 
+	if (readoutThreaded)
+	{
+		if (!supportThreadedReadout ())
+		{
+			logStream (MESSAGE_WARNING) << "driver does not support threaded readout, chip will be read from the main loop" << sendLog;
+			readoutThreaded->setValueBool (false);
+		}
+		else if (startReadoutThread ())
+		{
+			return -1;
+		}
+	}
+
 	return rts2core::ScriptDevice::initValues ();
 }
 
@@ -1342,6 +1623,12 @@ void Camera::checkExposures ()
 					endExposure (ret);
 					break;
 				case -2:
+					// previous frame is still being sent from the readout ring
+					if (readoutQueued)
+					{
+						setTimeout (USEC_SEC / 100);
+						break;
+					}
 					// remember exposure number
 					expNum = getExposureNumber ();
 					endExposure (ret);
@@ -1372,20 +1659,52 @@ void Camera::checkReadouts ()
 	int ret;
 	if ((getStateChip (0) & CAM_MASK_READING) != CAM_READING)
 		return;
+	if (readoutQueued)
+		return;
+	if (readoutThreadStarted && readoutThreaded->getValueBool ())
+	{
+		readoutQueued = true;
+		readoutChipRead = false;
+		readoutJobs.push (++readoutSeq);
+		return;
+	}
 	ret = doReadout ();
 	if (ret >= 0)
-	{
 		setTimeout (ret);
-	}
 	else
+		readoutEnded (ret);
+}
+
+void Camera::readoutEnded (int ret)
+{
+	if (shmRing && shmRing->isWriting ())
 	{
-		endReadout ();
-		afterReadout ();
 		if (ret == -2)
-			maskState (CAM_MASK_SHIFTING | CAM_MASK_READING | CAM_MASK_HAS_IMAGE, CAM_NOTREADING | CAM_HAS_IMAGE, "readout ended", NAN, NAN, exposureConn);
+		{
+			// channels were written at fixed offsets, readers expect them to follow each other
+			size_t chanSize = getWidth () * getHeight () * maxPixelByteSize ();
+			size_t off = dataWritten[0];
+			for (int i = 1; i < getNumChannels (); i++)
+			{
+				if (off != i * chanSize)
+					memmove (shmRing->getFrameData (off), shmRing->getFrameData (i * chanSize), dataWritten[i]);
+				off += dataWritten[i];
+			}
+			shmRing->endFrame (getNumChannels (), dataWritten, focusingHeader, timeReadoutStart);
+			shmRingFrames->setValueLong (shmRing->getPublished ());
+			sendValueAll (shmRingFrames);
+		}
 		else
-			maskState (DEVICE_ERROR_MASK | CAM_MASK_SHIFTING | CAM_MASK_READING, DEVICE_ERROR_HW | CAM_NOTREADING, "readout ended with error", NAN, NAN, exposureConn);
+		{
+			shmRing->abortFrame ();
+		}
 	}
+	endReadout ();
+	afterReadout ();
+	if (ret == -2)
+		maskState (CAM_MASK_SHIFTING | CAM_MASK_READING | CAM_MASK_HAS_IMAGE, CAM_NOTREADING | CAM_HAS_IMAGE, "readout ended", NAN, NAN, exposureConn);
+	else
+		maskState (DEVICE_ERROR_MASK | CAM_MASK_SHIFTING | CAM_MASK_READING, DEVICE_ERROR_HW | CAM_NOTREADING, "readout ended with error", NAN, NAN, exposureConn);
 }
 
 void Camera::afterReadout ()
@@ -1525,6 +1844,32 @@ int Camera::idle ()
 	return rts2core::ScriptDevice::idle ();
 }
 
+void Camera::addPollSocks ()
+{
+	rts2core::ScriptDevice::addPollSocks ();
+	if (readoutPipe[0] >= 0)
+		addPollFD (readoutPipe[0], POLLIN | POLLPRI);
+}
+
+void Camera::pollSuccess ()
+{
+	rts2core::ScriptDevice::pollSuccess ();
+	if (readoutPipe[0] >= 0 && isForRead (readoutPipe[0]))
+		processReadoutRing ();
+}
+
+void Camera::sendMessage (messageType_t in_messageType, const char *in_messageString)
+{
+	// messages from readout thread are send from the main loop
+	if (inReadoutThread ())
+	{
+		readoutMessages.push (std::pair <messageType_t, std::string> (in_messageType, in_messageString));
+		notifyReadout ();
+		return;
+	}
+	rts2core::ScriptDevice::sendMessage (in_messageType, in_messageString);
+}
+
 void Camera::changeMasterState (rts2_status_t old_state, rts2_status_t new_state)
 {
 	switch (new_state & SERVERD_STATUS_MASK)
@@ -1741,7 +2086,7 @@ int Camera::camExpose (rts2core::Connection * conn, int chipState, bool fromQue,
 	// or there are queued values which needs to be dealed before we can start exposing
 	if ((chipState & CAM_EXPOSING)
 	  	|| (chipState & CAM_EXPOSING_NOIM)
-		|| ((chipState & CAM_READING) && !supportFrameTransfer ())
+		|| ((chipState & CAM_READING) && !supportFrameTransfer () && !readoutChipRead)
 		|| (!queValues.empty () && fromQue == false)
 		)
 	{
@@ -1841,6 +2186,9 @@ int Camera::camReadout (rts2core::Connection * conn)
 
 	memset (dataWritten, 0, getNumChannels () * sizeof (size_t));
 
+	if (shmRing)
+		shmRing->beginFrame ();
+
 	if (realTimeDataTransferCount >= 0)
 	{
 		realTimeDataTransferCount++;
@@ -2183,6 +2531,8 @@ void Camera::setFullBopState (rts2_status_t new_state)
 
 char* Camera::getDataBuffer (int chan)
 {
+	if (inReadoutThread ())
+		return readoutRing.getData (readoutFrame, chan);
 	if (currentImageTransfer == SHARED)
 		return ((char *) sharedData->getChannelData (chan)) + sizeof (imghdr);
 	// if dataBuffesr is null, allocate it
@@ -2193,6 +2543,8 @@ char* Camera::getDataBuffer (int chan)
 
 char* Camera::getDataTop (int chan)
 {
+	if (inReadoutThread ())
+		return readoutRing.getTop (readoutFrame, chan);
 	return getDataBuffer (chan) + dataWritten[chan];
 }
 
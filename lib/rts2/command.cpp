@@ -144,6 +144,21 @@ int CommandSendKey::send ()
 	return Command::send ();
 }
 
+int CommandSendKey::commandReturnOK (Connection * conn)
+{
+	// other side will send values, ask for binary updates
+	connection->queCommand (new CommandValueFrames (owner));
+	connection->setConnState (CONN_AUTH_OK);
+	return -1;
+}
+
+CommandValueFrames::CommandValueFrames (Block * _master):Command (_master)
+{
+	std::ostringstream _os;
+	_os << COMMAND_VALUE_FRAMES " " << VALUE_FRAME_VERSION;
+	setCommand (_os);
+}
+
 CommandAuthorize::CommandAuthorize (Block * _master, int centralId, int key):Command (_master)
 {
 	std::ostringstream _os;
@@ -593,6 +608,21 @@ int CommandIntegrate::commandReturnFailed (int status, Connection * conn)
 	return Command::commandReturnFailed (status, conn);
 }
 
+CommandBurst::CommandBurst (DevClientPhot * _phot, float _exp, int _count):Command (_phot->getMaster ())
+{
+	phot = _phot;
+	std::ostringstream _os;
+	_os << "burst " << std::fixed << _exp << " " << _count;
+	setCommand (_os);
+}
+
+int CommandBurst::commandReturnFailed (int status, Connection * conn)
+{
+	if (phot)
+		phot->integrationFailed (status);
+	return Command::commandReturnFailed (status, conn);
+}
+
 CommandExecNext::CommandExecNext (Block * _master, int next_id):Command (_master)
 {
 	std::ostringstream _os;
@@ -622,6 +652,13 @@ CommandExecGrb::CommandExecGrb (Block * _master, int _grb_id):Command (_master)
 	setCommand (_os);
 }
 
+CommandExecGrbFast::CommandExecGrbFast (Block * _master, int _grb_id, double ra, double dec, double errorbox, double t_packet, double t_parse):Command (_master)
+{
+	std::ostringstream _os;
+	_os << "grb_fast " << _grb_id << " " << std::fixed << ra << " " << dec << " " << errorbox << " " << t_packet << " " << t_parse;
+	setCommand (_os);
+}
+
 CommandQueueNow::CommandQueueNow (Block *_master, const char *queue, int tar_id):Command (_master)
 {
 	std::ostringstream _os;
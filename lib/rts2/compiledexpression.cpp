@@ -0,0 +1,289 @@
+/*
+ * Expressions compiled to flat code with bound values.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "compiledexpression.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace rts2expression;
+
+ValueBinding::ValueBinding (const char *_device, const char *_value)
+{
+	deviceName = std::string (_device);
+	valueName = std::string (_value);
+	value = NULL;
+	connected = false;
+	bound = false;
+	generation = 0;
+}
+
+void ValueBinding::bind (rts2core::Block *master)
+{
+	value = master->getValue (deviceName.c_str (), valueName.c_str ());
+	connected = value != NULL || master->getOpenConnection (deviceName.c_str ()) != NULL;
+	generation = master->getValuesGeneration ();
+	bound = true;
+}
+
+static inline double opResult (op_t op, double v1, double v2)
+{
+	switch (op)
+	{
+		case OR:
+			return v1 || v2;
+		case AND:
+			return v1 && v2;
+		case XOR:
+			return (v1 != 0) != (v2 != 0);
+		case EQU:
+			return v1 == v2;
+		case LT:
+			return v1 < v2;
+		case LEQU:
+			return v1 <= v2;
+		case GT:
+			return v1 > v2;
+		case GEQU:
+			return v1 >= v2;
+		case NEQ:
+			return v1 != v2;
+	}
+	throw rts2core::Error ("unknow operand");
+}
+
+double rts2expression::evaluateOp (op_t op, double v1, double v2)
+{
+	return opResult (op, v1, v2);
+}
+
+CompiledExpression::CompiledExpression (rts2core::Block *_master)
+{
+	master = _master;
+	foldBarrier = 0;
+}
+
+void CompiledExpression::compile (Expression *expression)
+{
+	clear ();
+	expression->compile (*this);
+}
+
+double CompiledExpression::getValue (const Instruction &ins)
+{
+	ValueBinding &binding = bindings[ins.arg];
+	rts2core::Value *val = binding.getValue (master);
+	if (val)
+		return val->getValueDouble ();
+	if (ins.nanIfMissing && binding.isConnected ())
+		return NAN;
+	throw ExpressionErrorValueMissing (binding.getDeviceName (), binding.getValueName ());
+}
+
+double CompiledExpression::evaluate ()
+{
+	if (code.empty ())
+		throw rts2core::Error ("empty expression");
+
+	if (stack.empty ())
+	{
+		// jumps lead forward to places with the same stack depth, so depth of the straight path is sufficient
+		int depth = 0;
+		int maxDepth = 1;
+		for (std::vector <Instruction>::iterator iter = code.begin (); iter != code.end (); iter++)
+		{
+			switch (iter->opcode)
+			{
+				case I_CONST:
+				case I_VALUE:
+				case I_CALL:
+					depth++;
+					break;
+				case I_OP:
+				case I_JUMP_FALSE:
+				case I_JUMP_TRUE:
+					depth--;
+					break;
+				case I_BOOL:
+					break;
+			}
+			if (depth > maxDepth)
+				maxDepth = depth;
+		}
+		stack.resize (maxDepth);
+	}
+
+	double *s = &(stack[0]);
+	int top = -1;
+	const Instruction *begin = &(code[0]);
+	const Instruction *end = begin + code.size ();
+	const Instruction *ins = begin;
+
+	while (ins < end)
+	{
+		switch (ins->opcode)
+		{
+			case I_CONST:
+				s[++top] = ins->val;
+				break;
+			case I_VALUE:
+				s[++top] = getValue (*ins);
+				break;
+			case I_CALL:
+				s[++top] = ins->func (ins->funcArg);
+				break;
+			case I_OP:
+				top--;
+				s[top] = opResult (ins->op, s[top], s[top + 1]);
+				break;
+			case I_BOOL:
+				s[top] = s[top] != 0;
+				break;
+			case I_JUMP_FALSE:
+				if (s[top] == 0)
+				{
+					s[top] = 0;
+					ins = begin + ins->arg;
+					continue;
+				}
+				top--;
+				break;
+			case I_JUMP_TRUE:
+				if (s[top] != 0)
+				{
+					s[top] = 1;
+					ins = begin + ins->arg;
+					continue;
+				}
+				top--;
+				break;
+		}
+		ins++;
+	}
+	return s[top];
+}
+
+void CompiledExpression::clear ()
+{
+	truncate (0);
+	bindings.clear ();
+}
+
+bool CompiledExpression::isConstantSince (size_t pos, double &val)
+{
+	if (code.size () != pos + 1 || code[pos].opcode != I_CONST)
+		return false;
+	val = code[pos].val;
+	return true;
+}
+
+void CompiledExpression::truncate (size_t pos)
+{
+	if (pos < code.size ())
+		code.resize (pos);
+	if (foldBarrier > pos)
+		foldBarrier = pos;
+	stack.clear ();
+}
+
+void CompiledExpression::push (opcode_t opcode)
+{
+	Instruction ins;
+	ins.opcode = opcode;
+	ins.op = OR;
+	ins.val = 0;
+	ins.arg = 0;
+	ins.func = NULL;
+	ins.funcArg = NULL;
+	ins.nanIfMissing = false;
+	code.push_back (ins);
+	stack.clear ();
+}
+
+void CompiledExpression::pushConst (double val)
+{
+	push (I_CONST);
+	code.back ().val = val;
+}
+
+void CompiledExpression::pushValue (const char *device, const char *value, bool nanIfMissing)
+{
+	size_t i;
+	for (i = 0; i < bindings.size (); i++)
+	{
+		if (!strcmp (bindings[i].getDeviceName (), device) && !strcmp (bindings[i].getValueName (), value))
+			break;
+	}
+	if (i == bindings.size ())
+		bindings.push_back (ValueBinding (device, value));
+
+	push (I_VALUE);
+	code.back ().arg = i;
+	code.back ().nanIfMissing = nanIfMissing;
+}
+
+void CompiledExpression::pushCall (double (*func) (void *arg), void *arg)
+{
+	push (I_CALL);
+	code.back ().func = func;
+	code.back ().funcArg = arg;
+}
+
+void CompiledExpression::pushOp (op_t op)
+{
+	size_t n = code.size ();
+	if (n >= foldBarrier + 2 && code[n - 2].opcode == I_CONST && code[n - 1].opcode == I_CONST)
+	{
+		double v = opResult (op, code[n - 2].val, code[n - 1].val);
+		truncate (n - 2);
+		pushConst (v);
+		return;
+	}
+	push (I_OP);
+	code.back ().op = op;
+}
+
+void CompiledExpression::pushBool ()
+{
+	size_t n = code.size ();
+	if (n >= foldBarrier + 1 && code[n - 1].opcode == I_CONST)
+	{
+		code[n - 1].val = code[n - 1].val != 0;
+		return;
+	}
+	push (I_BOOL);
+}
+
+size_t CompiledExpression::jumpIfFalse ()
+{
+	push (I_JUMP_FALSE);
+	return code.size () - 1;
+}
+
+size_t CompiledExpression::jumpIfTrue ()
+{
+	push (I_JUMP_TRUE);
+	return code.size () - 1;
+}
+
+void CompiledExpression::setLabel (size_t jump)
+{
+	code[jump].arg = code.size ();
+	foldBarrier = code.size ();
+}
@@ -100,6 +100,14 @@ Connection::Connection (Block * in_master):Object ()
 	dataConn = 0;
 
 	sharedReadMemory = NULL;
+
+	valueFrames = false;
+	flushingValues = false;
+	suppressedUpdates = 0;
+	maxValueRate = 0;
+	inFrame = NULL;
+	inFrameSize = 0;
+	inFrameTop = 0;
 }
 
 Connection::Connection (int in_sock, Block * in_master):Object ()
@@ -142,6 +150,14 @@ Connection::Connection (int in_sock, Block * in_master):Object ()
 	dataConn = 0;
 
 	sharedReadMemory = NULL;
+
+	valueFrames = false;
+	flushingValues = false;
+	suppressedUpdates = 0;
+	maxValueRate = 0;
+	inFrame = NULL;
+	inFrameSize = 0;
+	inFrameTop = 0;
 }
 
 Connection::~Connection (void)
@@ -154,6 +170,7 @@ Connection::~Connection (void)
 	delete[]buf;
 	delete sharedReadMemory;
 	delete otherDevice;
+	delete[] inFrame;
 }
 
 int Connection::add (Block *block)
@@ -669,6 +686,8 @@ void Connection::checkBufferSize ()
 		buf_size += MAX_DATA;
 		delete[]buf;
 		buf = new_buf;
+		if (statsEnabled ())
+			stats.bufferSize (buf_size);
 	}
 }
 
@@ -719,6 +738,15 @@ void Connection::setBopState (rts2_status_t in_value)
 		sendCommand ();
 }
 
+void Connection::setName (int _centrald_num, const char *in_name)
+{
+	centrald_num = _centrald_num;
+	name = std::string (in_name);
+	// connections are looked up by name
+	if (master)
+		master->connectionsChanged ();
+}
+
 void Connection::setOtherType (int other_device_type)
 {
 	delete otherDevice;
@@ -837,6 +865,27 @@ void Connection::processLine ()
 			ret = -1;
 		}
 	}
+	else if (isCommand (PROTO_VALUE_FRAME))
+	{
+		int v_count;
+		long v_size;
+		if (paramNextInteger (&v_count) || paramNextLong (&v_size) || !paramEnd () || v_size < 0 || v_size > VALUE_FRAME_MAX_SIZE || inFrame)
+		{
+			// end connection - we cannot find start of the next command
+			connectionError (-2);
+			ret = -2;
+		}
+		else
+		{
+			inFrameSize = v_size;
+			inFrameTop = 0;
+			inFrame = new char[inFrameSize];
+			// empty frame
+			if (inFrameSize == 0)
+				addValueFrameData (NULL, 0);
+			ret = -1;
+		}
+	}
 	else if (isCommand (PROTO_SELMETAINFO))
 	{
 		char *m_name;
@@ -1085,6 +1134,13 @@ void Connection::processBuffer ()
 				memmove (buf_top, buf_top + readSize, (full_data_end - buf_top) - readSize + 1);
 				full_data_end -= readSize;
 			}
+			// binary value frame
+			else if (inFrame)
+			{
+				size_t readSize = addValueFrameData (buf_top, full_data_end - buf_top);
+				memmove (buf_top, buf_top + readSize, (full_data_end - buf_top) - readSize + 1);
+				full_data_end -= readSize;
+			}
 			command_start = buf_top;
 		}
 	}
@@ -1119,9 +1175,29 @@ int Connection::receive (Block *block)
 			}
 			if (data_size == 0)
 				return 0;
+			if (data_size > 0 && statsEnabled ())
+				stats.binaryChunk (data_size, true);
 			dataReceived ();
 			return data_size;
 		}
+		// rest of the binary value frame
+		if (inFrame)
+		{
+			data_size = read (sock, inFrame + inFrameTop, inFrameSize - inFrameTop);
+			if (data_size == -1 && errno == EINTR)
+				return 0;
+			if (data_size <= 0)
+			{
+				connectionError (data_size);
+				return -1;
+			}
+			if (statsEnabled ())
+				stats.bytesReceived (data_size);
+			successfullRead ();
+			inFrameTop += data_size;
+			addValueFrameData (NULL, 0);
+			return data_size;
+		}
 		checkBufferSize ();
 		data_size = read (sock, buf_top, buf_size - (buf_top - buf));
 		// ignore EINTR
@@ -1133,6 +1209,8 @@ int Connection::receive (Block *block)
 			return -1;
 		}
 		buf_top[data_size] = '\0';
+		if (statsEnabled ())
+			stats.bytesReceived (data_size);
 		successfullRead ();
 		#ifdef DEBUG_ALL
 		std::cout << "Connection::receive name " << getName ()
@@ -1476,6 +1554,7 @@ void Connection::sendCommand ()
 				#ifdef DEBUG_ALL
 				logStream (MESSAGE_DEBUG) << "executing " << runningCommand->getText () << " " << runningCommand << sendLog;
 				#endif
+				stats.commandSent (runningCommand->getText ());
 				runningCommand->send ();
 				runningCommandStatus = SEND;
 				runningCommand->setStatusCallProgress (CIP_WAIT);
@@ -1494,6 +1573,7 @@ void Connection::sendCommand ()
 				// we can do that, as if we are running on same connection as is centrald, we are runningCommand, so we can send directly..
 				statInfoCall->setConnection (this);
 				statInfoCall->setStatusCallProgress (CIP_RETURN);
+				stats.commandSent (statInfoCall->getText ());
 				statInfoCall->send ();
 				runningCommand->setStatusCallProgress (CIP_WAIT);
 				commandQue.push_front (runningCommand);
@@ -1509,6 +1589,7 @@ void Connection::sendCommand ()
 					runningCommandStatus = WAITING;
 					break;
 				}
+				stats.commandSent (runningCommand->getText ());
 				runningCommand->send ();
 				runningCommandStatus = SEND;
 				runningCommand->setStatusCallProgress (CIP_RETURN);
@@ -1520,6 +1601,7 @@ void Connection::sendCommand ()
 	}
 	else
 	{
+		stats.commandSent (runningCommand->getText ());
 		runningCommand->send ();
 		runningCommandStatus = SEND;
 	}
@@ -1554,6 +1636,7 @@ int Connection::commandReturn ()
 		return -1;
 	}
 	runningCommandStatus = RETURNING;
+	stats.commandReturned ();
 	commandReturn (runningCommand, stat);
 	ret = runningCommand->commandReturn (stat, this);
 	#ifdef DEBUG_ALL
@@ -1583,6 +1666,11 @@ int Connection::sendMsg (const char *msg)
 		#endif
 		return -1;
 	}
+	// keep order of value updates and other messages
+	if (!flushingValues && !dirtyValues.empty ())
+		flushValueUpdates ();
+	if (!pendingFrame.empty () && flushValueFrame ())
+		return -1;
 	len = strlen (msg) + 1;
 	char *mbuf = new char[len + 1];
 	strcpy (mbuf, msg);
@@ -1617,10 +1705,159 @@ int Connection::sendMsg (const char *msg)
 	#endif
 
 	delete[] mbuf;
+	if (statsEnabled ())
+		stats.bytesSent (ret);
+	successfullSend ();
+	return 0;
+}
+
+void Connection::setValueFrames (bool vf)
+{
+	if (vf == false)
+		flushValueFrame ();
+	valueFrames = vf;
+}
+
+void Connection::sendValueUpdate (Value *value)
+{
+	if (valueFrames && sock >= 0 && pendingFrame.add (value))
+		return;
+	value->send (this);
+}
+
+int Connection::flushValueFrame ()
+{
+	if (pendingFrame.empty ())
+		return 0;
+	if (sock == -1)
+	{
+		pendingFrame.clear ();
+		return -1;
+	}
+	std::ostringstream _os;
+	_os << PROTO_VALUE_FRAME " " << pendingFrame.getCount () << " " << pendingFrame.size () << "\n";
+	std::string fr = _os.str ();
+	fr.append (pendingFrame.data (), pendingFrame.size ());
+	pendingFrame.clear ();
+
+	const char *top = fr.data ();
+	size_t len = fr.length ();
+	while (len > 0)
+	{
+		ssize_t ret = write (sock, top, len);
+		if (ret == -1)
+		{
+			if (errno == EINTR)
+				continue;
+			logStream (MESSAGE_ERROR) << "cannot send value frame to " << getName () << ": " << strerror (errno) << sendLog;
+			connectionError (ret);
+			return -1;
+		}
+		top += ret;
+		len -= ret;
+	}
+	if (statsEnabled ())
+		stats.bytesSent (fr.length ());
 	successfullSend ();
 	return 0;
 }
 
+void Connection::queValueUpdate (Value *value)
+{
+	if (dirtySet.insert (value).second == false)
+	{
+		suppressedUpdates++;
+		return;
+	}
+	dirtyValues.push_back (value);
+}
+
+double Connection::flushValueUpdates ()
+{
+	if (flushingValues || dirtyValues.empty ())
+		return NAN;
+	if (sock == -1)
+	{
+		dirtyValues.clear ();
+		dirtySet.clear ();
+		return NAN;
+	}
+	flushingValues = true;
+
+	double now = getNow ();
+	double next = NAN;
+
+	std::vector <Value *>::iterator iter = dirtyValues.begin ();
+	while (iter != dirtyValues.end ())
+	{
+		double rate = maxValueRate;
+		std::map <Value *, double>::iterator ri = valueRates.find (*iter);
+		if (ri != valueRates.end ())
+			rate = ri->second;
+		if (rate > 0)
+		{
+			std::map <Value *, double>::iterator si = valueSent.find (*iter);
+			if (si != valueSent.end () && now < si->second + 1 / rate)
+			{
+				// held by rate limit
+				if (isnan (next) || si->second + 1 / rate < next)
+					next = si->second + 1 / rate;
+				iter++;
+				continue;
+			}
+			valueSent[*iter] = now;
+		}
+		sendValueUpdate (*iter);
+		dirtySet.erase (*iter);
+		iter = dirtyValues.erase (iter);
+	}
+	flushingValues = false;
+	flushValueFrame ();
+	return next;
+}
+
+void Connection::setValueRate (Value *value, double rate)
+{
+	if (value == NULL)
+	{
+		maxValueRate = rate;
+		return;
+	}
+	if (rate <= 0)
+		valueRates.erase (value);
+	else
+		valueRates[value] = rate;
+}
+
+size_t Connection::addValueFrameData (const char *data, size_t len)
+{
+	if (len > inFrameSize - inFrameTop)
+		len = inFrameSize - inFrameTop;
+	if (len > 0)
+	{
+		memcpy (inFrame + inFrameTop, data, len);
+		inFrameTop += len;
+	}
+	if (inFrameTop < inFrameSize)
+		return len;
+
+	std::vector <Value *> updated;
+	int ret = ValueFrame::decode (inFrame, inFrameSize, values, &updated);
+	delete[] inFrame;
+	inFrame = NULL;
+	if (ret < 0)
+	{
+		logStream (MESSAGE_ERROR) << "malformed value frame received from " << getName () << sendLog;
+		return len;
+	}
+	if (getOtherDevClient ())
+	{
+		for (std::vector <Value *>::iterator iter = updated.begin (); iter != updated.end (); iter++)
+			getOtherDevClient ()->valueChanged (*iter);
+	}
+	return len;
+}
+
 int Connection::sendMsg (std::string msg)
 {
 	return sendMsg (msg.c_str ());
@@ -1680,6 +1917,8 @@ int Connection::sendBinaryData (int data_conn, int chan, char *data, size_t data
 		{
 			binaryWriteTop += ret;
 			dataSize -= ret;
+			if (statsEnabled ())
+				stats.binaryChunk (ret, false);
 			std::map <int, DataAbstractWrite *>::iterator iter = writeChannels.find (data_conn);
 			if (iter != writeChannels.end ())
 			{
@@ -1776,6 +2015,15 @@ void Connection::connConnected ()
 void Connection::connectionError (int last_data_size)
 {
 	activeReadData = -1;
+	valueFrames = false;
+	pendingFrame.clear ();
+	dirtyValues.clear ();
+	dirtySet.clear ();
+	maxValueRate = 0;
+	valueRates.clear ();
+	valueSent.clear ();
+	delete[] inFrame;
+	inFrame = NULL;
 	if (canDelete ())
 		setConnState (CONN_DELETE);
 	else
@@ -2196,7 +2444,7 @@ void Connection::dataReceived ()
 
 Value * Connection::getValue (const char *value_name)
 {
-	return values.getValue (value_name);
+	return valueIndex.find (value_name);
 }
 
 Value * Connection::getValueType (const char *value_name, int value_type)
@@ -2223,13 +2471,28 @@ void Connection::addValue (Value * value, const ValueVector::iterator eiter)
 {
 	if (value->isValue (RTS2_VALUE_INFOTIME))
 		info_time = (ValueTime *) value;
+	bool last = (eiter == values.end ());
 	values.insert (eiter, value);
+	// value inserted in the middle can precede value with the same name
+	if (last)
+		valueIndex.add (value->getName ().c_str (), value);
+	else
+		indexValues ();
+	if (master)
+		master->valuesChanged ();
+}
+
+void Connection::indexValues ()
+{
+	valueIndex.clear ();
+	for (ValueVector::iterator iter = values.begin (); iter != values.end (); iter++)
+		valueIndex.add ((*iter)->getName ().c_str (), *iter);
 }
 
 int Connection::metaInfo (int rts2Type, std::string m_name, std::string desc)
 {
 	// if value exists, update it
-	Value *existing_value = values.getValue (m_name.c_str ());
+	Value *existing_value = getValue (m_name.c_str ());
 	ValueVector::iterator eiter;
 	if (existing_value)
 	{
@@ -2240,6 +2503,7 @@ int Connection::metaInfo (int rts2Type, std::string m_name, std::string desc)
 			return -1;
 		}
 		eiter = values.removeValue (m_name.c_str ());
+		indexValues ();
 	}
 	else
 	{
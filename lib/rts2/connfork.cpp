@@ -21,6 +21,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/ioctl.h>
 #include <signal.h>
 #include <unistd.h>
 
@@ -132,6 +133,20 @@ int ConnFork::writeToProcess (const char *msg)
 	return 0;
 }
 
+int ConnFork::getUnreadInput ()
+{
+#ifdef FIONREAD
+	if (sockwrite < 0)
+		return -1;
+	int unread;
+	if (ioctl (sockwrite, FIONREAD, &unread))
+		return -1;
+	return unread + input.length ();
+#else
+	return -1;
+#endif
+}
+
 int ConnFork::writeToProcessInt (int msg)
 {
 	std::ostringstream os;
@@ -20,8 +20,10 @@
 #include "connection/modbus.h"
 #include "utilsfunc.h"
 
+#include <math.h>
 #include <strings.h>
 #include <sys/socket.h>
+#include <vector>
 
 using namespace rts2core;
 
@@ -116,6 +118,12 @@ void ConnModbus::readHoldingRegisters (uint8_t slaveId, int16_t start, int16_t q
 	callFunction16 (slaveId, 0x03, start, qty, reply_data, qty);
 }
 
+void ConnModbus::readHoldingRegisters (uint8_t slaveId, int n, const int16_t *starts, const int16_t *qtys, uint16_t **reply_data)
+{
+	for (int i = 0; i < n; i++)
+		readHoldingRegisters (slaveId, starts[i], qtys[i], reply_data[i]);
+}
+
 void ConnModbus::readInputRegisters (uint8_t slaveId, int16_t start, int16_t qty, uint16_t *reply_data)
 {
 	callFunction16 (slaveId, 0x04, start, qty, reply_data, qty);
@@ -151,6 +159,7 @@ void ConnModbus::writeHoldingRegisterMask (uint8_t slaveId, int16_t reg, int16_t
 ConnModbusTCP::ConnModbusTCP (Block * _master, const char *_hostname, int _port):ConnTCP (_master, _hostname, _port), ConnModbus ()
 {
 	transId = 1;
+	maxInFlight = 4;
 }
 
 int ConnModbusTCP::init ()
@@ -198,6 +207,92 @@ void ConnModbusTCP::exchangeData (const void *payloadData, size_t payloadSize, v
 
 }
 
+void ConnModbusTCP::readHoldingRegisters (uint8_t slaveId, int n, const int16_t *starts, const int16_t *qtys, uint16_t **reply_data)
+{
+	if (n == 1 || maxInFlight == 1)
+	{
+		ConnModbus::readHoldingRegisters (slaveId, n, starts, qtys, reply_data);
+		return;
+	}
+
+	uint16_t firstId = transId;
+	std::vector <bool> done (n, false);
+	int sent = 0;
+	int received = 0;
+
+	try
+	{
+		while (received < n)
+		{
+			for (; sent < n && sent - received < maxInFlight; sent++)
+			{
+				unsigned char req[12];
+				*((uint16_t *) req) = htons ((uint16_t) (firstId + sent));
+				req[2] = 0;
+				req[3] = 0;
+				*((uint16_t *) (req + 4)) = htons (6);
+				req[6] = slaveId;
+				req[7] = 0x03;
+				*((uint16_t *) (req + 8)) = htons (starts[sent]);
+				*((uint16_t *) (req + 10)) = htons (qtys[sent]);
+				ConnTCP::sendData (req, 12);
+			}
+
+			// MBAP header, unit ID and function code
+			unsigned char header[8];
+			ConnTCP::receiveData (header, 8, 50);
+			uint16_t i = ntohs (*((uint16_t *) header)) - firstId;
+			uint16_t len = ntohs (*((uint16_t *) (header + 4)));
+			if (i >= sent || done[i])
+			{
+				std::ostringstream _os;
+				_os << "invalid ID in reply data " << ntohs (*((uint16_t *) header));
+				throw ModbusError (static_cast<ConnTCP *> (this), _os.str ().c_str ());
+			}
+			if (len < 3 || len > 256)
+			{
+				std::ostringstream _os;
+				_os << "invalid length in reply header " << len;
+				throw ModbusError (static_cast<ConnTCP *> (this), _os.str ().c_str ());
+			}
+			std::vector <unsigned char> body (len - 2);
+			ConnTCP::receiveData (&(body[0]), len - 2, 50);
+			done[i] = true;
+			received++;
+
+			if (header[6] != slaveId)
+			{
+				std::ostringstream _os;
+				_os << "invalid reply ID " << (int) header[6] << " " << (int) slaveId;
+				throw ModbusError (static_cast<ConnTCP *> (this), _os.str ().c_str ());
+			}
+			if (header[7] & 0x80)
+			{
+				std::ostringstream _os;
+				_os << "Error executing function 3 error code is: 0x" << std::hex << (int) body[0];
+				throw ModbusError (static_cast<ConnTCP *> (this), _os.str ().c_str ());
+			}
+			if (header[7] != 0x03 || body[0] != qtys[i] * 2 || len - 3 != body[0])
+			{
+				std::ostringstream _os;
+				_os << "invalid reply to read of " << qtys[i] << " registers from " << starts[i];
+				throw ModbusError (static_cast<ConnTCP *> (this), _os.str ().c_str ());
+			}
+			for (int j = 0; j < qtys[i]; j++)
+				reply_data[i][j] = (body[1 + 2 * j] << 8) | body[2 + 2 * j];
+		}
+	}
+	catch (ConnError &err)
+	{
+		// ConnError closed the connection, so replies to
+		// transactions still in flight are dropped with it
+		logStream (MESSAGE_ERROR) << err << sendLog;
+		transId = firstId + sent;
+		throw;
+	}
+	transId = firstId + n;
+}
+
 ConnModbusRTUTCP::ConnModbusRTUTCP (Block * _master, const char *_hostname, int _port):ConnTCP (_master, _hostname, _port), ConnModbus ()
 {
 }
@@ -236,3 +331,139 @@ void ConnModbusRTUTCP::exchangeData (const void *payloadData, size_t payloadSize
 		throw (err);
 	}
 }
+
+ModbusScanner::ModbusScanner (ConnModbus *_conn, uint8_t _slaveId, int _maxGap)
+{
+	conn = _conn;
+	slaveId = _slaveId;
+	maxGap = _maxGap;
+	blockReads = 0;
+}
+
+void ModbusScanner::addRegisters (uint16_t start, uint16_t qty, double maxAge)
+{
+	for (int a = start; a < start + qty; a++)
+	{
+		Register r;
+		r.maxAge = maxAge;
+		r.readTime = NAN;
+		r.value = 0;
+		registers[a] = r;
+	}
+}
+
+// never read, invalidated or too old
+#define isStale(r, now)   (isnan (r.readTime) || now - r.readTime > r.maxAge)
+
+// maximal number of registers in a single read
+#define MAX_BLOCK         125
+
+void ModbusScanner::scan (bool all)
+{
+	double now = getNow ();
+	std::vector <int16_t> starts;
+	std::vector <int16_t> qtys;
+	int bstart = -1;
+	int blast = -1;
+
+	for (std::map <uint16_t, Register>::iterator iter = registers.begin (); iter != registers.end (); iter++)
+	{
+		if (!all && !isStale (iter->second, now))
+			continue;
+		int a = iter->first;
+		if (bstart >= 0 && a - blast - 1 <= maxGap && a - bstart < MAX_BLOCK)
+		{
+			blast = a;
+			continue;
+		}
+		if (bstart >= 0)
+		{
+			starts.push_back (bstart);
+			qtys.push_back (blast - bstart + 1);
+		}
+		bstart = blast = a;
+	}
+	if (bstart < 0)
+		return;
+	starts.push_back (bstart);
+	qtys.push_back (blast - bstart + 1);
+
+	size_t total = 0;
+	for (std::vector <int16_t>::iterator iter = qtys.begin (); iter != qtys.end (); iter++)
+		total += *iter;
+	std::vector <uint16_t> data (total);
+	std::vector <uint16_t *> replies (starts.size ());
+	total = 0;
+	for (size_t i = 0; i < starts.size (); i++)
+	{
+		replies[i] = &data[total];
+		total += qtys[i];
+	}
+
+	blockReads += starts.size ();
+	conn->readHoldingRegisters (slaveId, starts.size (), &starts[0], &qtys[0], &replies[0]);
+
+	now = getNow ();
+	for (size_t i = 0; i < starts.size (); i++)
+	{
+		for (int j = 0; j < qtys[i]; j++)
+		{
+			std::map <uint16_t, Register>::iterator iter = registers.find (starts[i] + j);
+			if (iter == registers.end ())
+				continue;
+			iter->second.value = replies[i][j];
+			iter->second.readTime = now;
+		}
+	}
+}
+
+void ModbusScanner::readHoldingRegisters (uint16_t start, uint16_t qty, uint16_t *reply_data)
+{
+	double now = getNow ();
+	bool stale = false;
+	for (int a = start; a < start + qty; a++)
+	{
+		std::map <uint16_t, Register>::iterator iter = registers.find (a);
+		if (iter == registers.end ())
+		{
+			// not in the map, read directly
+			blockReads++;
+			conn->readHoldingRegisters (slaveId, start, qty, reply_data);
+			return;
+		}
+		if (isStale (iter->second, now))
+			stale = true;
+	}
+	if (stale)
+		scan ();
+	for (int a = 0; a < qty; a++)
+		reply_data[a] = registers[start + a].value;
+}
+
+void ModbusScanner::invalidate (uint16_t start, uint16_t qty)
+{
+	for (int a = start; a < start + qty; a++)
+	{
+		std::map <uint16_t, Register>::iterator iter = registers.find (a);
+		if (iter != registers.end ())
+			iter->second.readTime = NAN;
+	}
+}
+
+void ModbusScanner::invalidateAll ()
+{
+	for (std::map <uint16_t, Register>::iterator iter = registers.begin (); iter != registers.end (); iter++)
+		iter->second.readTime = NAN;
+}
+
+void ModbusScanner::writeHoldingRegister (int16_t reg, int16_t val)
+{
+	invalidate (reg);
+	conn->writeHoldingRegister (slaveId, reg, val);
+}
+
+void ModbusScanner::writeHoldingRegisterMask (int16_t reg, int16_t mask, int16_t val)
+{
+	invalidate (reg);
+	conn->writeHoldingRegisterMask (slaveId, reg, mask, val);
+}
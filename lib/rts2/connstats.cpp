@@ -0,0 +1,286 @@
+/*
+ * Connection and event loop instrumentation.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "connstats.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+using namespace rts2core;
+
+static std::atomic <bool> stats_enabled (false);
+
+// binary chunks separated by more than this are treated as separate transfers
+#define BINARY_GAP    1.0
+
+bool rts2core::statsEnabled ()
+{
+	return stats_enabled.load (std::memory_order_relaxed);
+}
+
+void rts2core::setStatsEnabled (bool enabled)
+{
+	stats_enabled.store (enabled, std::memory_order_relaxed);
+}
+
+double rts2core::statsNow ()
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+LatencyHistogram::LatencyHistogram ()
+{
+	reset ();
+}
+
+void LatencyHistogram::record (double sec)
+{
+	if (isnan (sec) || sec < 0)
+		sec = 0;
+	uint64_t usec = (uint64_t) (sec * 1e6);
+	int b = 0;
+	while (b < STATS_HIST_BUCKETS - 1 && usec >= (((uint64_t) 1) << b))
+		b++;
+	buckets[b].fetch_add (1, std::memory_order_relaxed);
+	count.fetch_add (1, std::memory_order_relaxed);
+	sumUsec.fetch_add (usec, std::memory_order_relaxed);
+	uint64_t m = maxUsec.load (std::memory_order_relaxed);
+	while (usec > m && !maxUsec.compare_exchange_weak (m, usec, std::memory_order_relaxed))
+		;
+}
+
+void LatencyHistogram::reset ()
+{
+	for (int i = 0; i < STATS_HIST_BUCKETS; i++)
+		buckets[i].store (0, std::memory_order_relaxed);
+	count.store (0, std::memory_order_relaxed);
+	sumUsec.store (0, std::memory_order_relaxed);
+	maxUsec.store (0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean () const
+{
+	uint64_t c = getCount ();
+	if (c == 0)
+		return NAN;
+	return getSum () / c;
+}
+
+double LatencyHistogram::getQuantile (double q) const
+{
+	uint64_t c = getCount ();
+	if (c == 0)
+		return NAN;
+	uint64_t target = (uint64_t) ceil (q * c);
+	if (target == 0)
+		target = 1;
+	uint64_t cum = 0;
+	for (int i = 0; i < STATS_HIST_BUCKETS; i++)
+	{
+		cum += getBucket (i);
+		if (cum >= target)
+		{
+			// do not report more than the maximum seen
+			double b = bucketBound (i);
+			return b < getMax () ? b : getMax ();
+		}
+	}
+	return getMax ();
+}
+
+std::string rts2core::prometheusLabel (const char *name, const std::string &value)
+{
+	std::string ret = std::string (name) + "=\"";
+	for (std::string::const_iterator iter = value.begin (); iter != value.end (); iter++)
+	{
+		switch (*iter)
+		{
+			case '\\':
+				ret += "\\\\";
+				break;
+			case '"':
+				ret += "\\\"";
+				break;
+			case '\n':
+				ret += "\\n";
+				break;
+			default:
+				ret += *iter;
+		}
+	}
+	return ret + "\"";
+}
+
+PrometheusWriter::~PrometheusWriter ()
+{
+	for (std::vector <Family *>::iterator iter = families.begin (); iter != families.end (); iter++)
+		delete *iter;
+}
+
+std::ostream & PrometheusWriter::family (const std::string &name, const char *type)
+{
+	std::map <std::string, Family *>::iterator iter = byName.find (name);
+	if (iter != byName.end ())
+		return iter->second->samples;
+	Family *f = new Family ();
+	f->name = name;
+	f->type = type;
+	families.push_back (f);
+	byName[name] = f;
+	return f->samples;
+}
+
+void PrometheusWriter::write (std::ostream &os) const
+{
+	for (std::vector <Family *>::const_iterator iter = families.begin (); iter != families.end (); iter++)
+		os << "# TYPE " << (*iter)->name << " " << (*iter)->type << "\n" << (*iter)->samples.str ();
+}
+
+double LatencyHistogram::bucketBound (int i)
+{
+	if (i >= STATS_HIST_BUCKETS - 1)
+		return INFINITY;
+	return ((uint64_t) 1 << i) / 1e6;
+}
+
+void LatencyHistogram::writePrometheus (PrometheusWriter &pw, const std::string &name, const std::string &labels) const
+{
+	std::ostream &os = pw.family (name, "histogram");
+	std::string sep = labels.empty () ? "" : ",";
+	uint64_t cum = 0;
+	for (int i = 0; i < STATS_HIST_BUCKETS; i++)
+	{
+		cum += getBucket (i);
+		os << name << "_bucket{" << labels << sep << "le=\"";
+		if (i == STATS_HIST_BUCKETS - 1)
+			os << "+Inf";
+		else
+			os << bucketBound (i);
+		os << "\"} " << cum << "\n";
+	}
+	if (labels.empty ())
+	{
+		os << name << "_sum " << getSum () << "\n";
+		os << name << "_count " << getCount () << "\n";
+	}
+	else
+	{
+		os << name << "_sum{" << labels << "} " << getSum () << "\n";
+		os << name << "_count{" << labels << "} " << getCount () << "\n";
+	}
+}
+
+ConnStats::ConnStats ():roundTrip (), commands ()
+{
+	cmdStart = NAN;
+	rxBytes = 0;
+	txBytes = 0;
+	binRx = 0;
+	binTx = 0;
+	maxBuf = 0;
+	binUsec = 0;
+	lastBinary = NAN;
+}
+
+ConnStats::~ConnStats ()
+{
+	for (std::map <std::string, LatencyHistogram *>::iterator iter = commands.begin (); iter != commands.end (); iter++)
+		delete iter->second;
+	commands.clear ();
+}
+
+void ConnStats::commandSent (const char *cmd_text)
+{
+	if (!statsEnabled () || cmd_text == NULL)
+	{
+		cmdStart = NAN;
+		return;
+	}
+	const char *e = strchr (cmd_text, ' ');
+	if (e == NULL)
+		cmdName = std::string (cmd_text);
+	else
+		cmdName = std::string (cmd_text, e - cmd_text);
+	cmdStart = statsNow ();
+}
+
+void ConnStats::commandReturned ()
+{
+	if (isnan (cmdStart))
+		return;
+	double rtt = statsNow () - cmdStart;
+	cmdStart = NAN;
+	roundTrip.record (rtt);
+	std::map <std::string, LatencyHistogram *>::iterator iter = commands.find (cmdName);
+	if (iter == commands.end ())
+		iter = commands.insert (std::pair <std::string, LatencyHistogram *> (cmdName, new LatencyHistogram ())).first;
+	iter->second->record (rtt);
+}
+
+void ConnStats::bufferSize (size_t len)
+{
+	size_t m = maxBuf.load (std::memory_order_relaxed);
+	if (len > m)
+		maxBuf.store (len, std::memory_order_relaxed);
+}
+
+void ConnStats::binaryChunk (size_t len, bool received)
+{
+	if (received)
+		binRx.fetch_add (len, std::memory_order_relaxed);
+	else
+		binTx.fetch_add (len, std::memory_order_relaxed);
+	double now = statsNow ();
+	if (!isnan (lastBinary) && now - lastBinary < BINARY_GAP)
+		binUsec.fetch_add ((uint64_t) ((now - lastBinary) * 1e6), std::memory_order_relaxed);
+	lastBinary = now;
+}
+
+double ConnStats::getBinaryRate () const
+{
+	uint64_t us = binUsec.load (std::memory_order_relaxed);
+	if (us == 0)
+		return NAN;
+	return (getBinaryBytes (true) + getBinaryBytes (false)) / (us / 1e6);
+}
+
+void ConnStats::writePrometheus (PrometheusWriter &pw, const std::string &labels) const
+{
+	roundTrip.writePrometheus (pw, "rts2_command_rtt_seconds", labels);
+	for (std::map <std::string, LatencyHistogram *>::const_iterator iter = commands.begin (); iter != commands.end (); iter++)
+		iter->second->writePrometheus (pw, "rts2_command_seconds", labels + "," + prometheusLabel ("command", iter->first));
+	pw.family ("rts2_received_bytes_total", "counter") << "rts2_received_bytes_total{" << labels << "} " << getReceivedBytes () << "\n";
+	pw.family ("rts2_sent_bytes_total", "counter") << "rts2_sent_bytes_total{" << labels << "} " << getSentBytes () << "\n";
+	pw.family ("rts2_binary_received_bytes_total", "counter") << "rts2_binary_received_bytes_total{" << labels << "} " << getBinaryBytes (true) << "\n";
+	pw.family ("rts2_binary_sent_bytes_total", "counter") << "rts2_binary_sent_bytes_total{" << labels << "} " << getBinaryBytes (false) << "\n";
+	pw.family ("rts2_buffer_max_bytes", "gauge") << "rts2_buffer_max_bytes{" << labels << "} " << getMaxBufferSize () << "\n";
+	double rate = getBinaryRate ();
+	if (!isnan (rate))
+		pw.family ("rts2_binary_rate_bytes_per_second", "gauge") << "rts2_binary_rate_bytes_per_second{" << labels << "} " << rate << "\n";
+}
+
+void LoopStats::writePrometheus (PrometheusWriter &pw, const std::string &labels) const
+{
+	poll.writePrometheus (pw, "rts2_loop_poll_seconds", labels);
+	idle.writePrometheus (pw, "rts2_loop_idle_seconds", labels);
+	lag.writePrometheus (pw, "rts2_loop_lag_seconds", labels);
+}
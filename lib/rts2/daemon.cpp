@@ -706,7 +706,11 @@ void Daemon::pollSuccess ()
 
 void Daemon::addValue (Value * value, int queCondition)
 {
-	values.push_back (new CondValue (value, queCondition));
+	CondValue *cv = new CondValue (value, queCondition);
+	values.push_back (cv);
+	valueIndex.add (value->getName ().c_str (), cv);
+	condValues[value] = cv;
+	valuesChanged ();
 }
 
 Value * Daemon::getOwnValue (const char *v_name)
@@ -719,26 +723,15 @@ Value * Daemon::getOwnValue (const char *v_name)
 
 CondValue * Daemon::getCondValue (const char *v_name)
 {
-	CondValueVector::iterator iter;
-	for (iter = values.begin (); iter != values.end (); iter++)
-	{
-		CondValue *val = *iter;
-		if (val->getValue ()->isValue (v_name))
-			return val;
-	}
-	return NULL;
+	return valueIndex.find (v_name);
 }
 
 CondValue * Daemon::getCondValue (const Value *val)
 {
-	CondValueVector::iterator iter;
-	for (iter = values.begin (); iter != values.end (); iter++)
-	{
-		CondValue *c_val = *iter;
-		if (c_val->getValue () == val)
-			return c_val;
-	}
-	return NULL;
+	std::map <const Value *, CondValue *>::iterator iter = condValues.find (val);
+	if (iter == condValues.end ())
+		return NULL;
+	return iter->second;
 }
 
 Value * Daemon::duplicateValue (Value * old_value, bool withVal)
@@ -808,6 +801,7 @@ Value * Daemon::duplicateValue (Value * old_value, bool withVal)
 void Daemon::addConstValue (Value * value)
 {
 	constValues.push_back (value);
+	valuesChanged ();
 }
 
 void Daemon::addConstValue (const char *in_name, const char *in_desc, const char *in_value)
@@ -1073,13 +1067,13 @@ int Daemon::sendInfo (Connection * conn, bool forceSend)
 		Value *val = (*iter)->getValue ();
 		if (val->needSend () || forceSend)
 		{
-			val->send (conn);
+			conn->sendValueUpdate (val);
 		}
 	}
 	if (info_time->needSend ())
-		info_time->send (conn);
+		conn->sendValueUpdate (info_time);
 	if (uptime->needSend ())
-		uptime->send (conn);
+		conn->sendValueUpdate (uptime);
 	return 0;
 }
 
@@ -1090,10 +1084,10 @@ void Daemon::sendValueAll (Value * value)
 		connections_t::iterator iter;
 		for (iter = getConnections ()->begin (); iter != getConnections ()->end (); iter++)
 			if ((*iter)->getSendAll ())
-				value->send (*iter);
+				(*iter)->queValueUpdate (value);
 		for (iter = getCentraldConns ()->begin (); iter != getCentraldConns ()->end (); iter++)
 			if ((*iter)->getSendAll ())
-				value->send (*iter);
+				(*iter)->queValueUpdate (value);
 		value->resetNeedSend ();
 	}
 }
@@ -360,6 +360,10 @@ DevClientPhot::DevClientPhot (Connection * _connection):DevClient (_connection)
 	lastCount = -1;
 	lastExp = -1.0;
 	integrating = false;
+	burst = false;
+	nextSample = 0;
+	lostSamples = 0;
+	receivedSamples = 0;
 }
 
 DevClientPhot::~DevClientPhot ()
@@ -422,11 +426,13 @@ void DevClientPhot::integrationStart ()
 void DevClientPhot::integrationEnd ()
 {
 	integrating = false;
+	burst = false;
 }
 
 void DevClientPhot::integrationFailed (int status)
 {
 	integrating = false;
+	burst = false;
 }
 
 void DevClientPhot::addCount (int count, float exp, bool is_ov)
@@ -436,6 +442,36 @@ void DevClientPhot::addCount (int count, float exp, bool is_ov)
 }
 
 
+void DevClientPhot::fullDataReceived (int data_conn, DataChannels *data)
+{
+	for (DataChannels::iterator iter = data->begin (); iter != data->end (); iter++)
+	{
+		std::vector <rts2phot::PhotSample> samples;
+		if (rts2phot::unpackSamples ((*iter)->getDataBuff (), (*iter)->getDataTop () - (*iter)->getDataBuff (), samples) < 0)
+		{
+			logStream (MESSAGE_WARNING) << "invalid batch of samples received from " << getName () << sendLog;
+			continue;
+		}
+		if (samples.empty ())
+			continue;
+		// new burst starts with sequence 0
+		uint64_t first = samples.front ().seq;
+		if (first == 0)
+			nextSample = 0;
+		if (first > nextSample)
+			lostSamples += first - nextSample;
+		nextSample = samples.back ().seq + 1;
+		burst = true;
+		receivedSamples += samples.size ();
+
+		const rts2phot::PhotSample &last = samples.back ();
+		lastCount = last.count;
+		lastExp = last.exp;
+
+		addSamples (samples);
+	}
+}
+
 bool DevClientPhot::isIntegrating ()
 {
 	return integrating;
@@ -443,7 +479,8 @@ bool DevClientPhot::isIntegrating ()
 
 void DevClientPhot::valueChanged (Value * value)
 {
-	if (value->isValue ("count"))
+	// count is updated once per batch of burst samples
+	if (value->isValue ("count") && !burst)
 	{
 		Value *v_count = getConnection ()->getValue ("count");
 		Value *v_exp = getConnection ()->getValue ("exposure");
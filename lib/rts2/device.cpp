@@ -20,6 +20,7 @@
 #include <fcntl.h>
 #include <netdb.h>
 #include <sys/socket.h>
+#include <math.h>
 
 #include <rts2-config.h>
 #include "status.h"
@@ -503,6 +504,17 @@ Device::Device (int in_argc, char **in_argv, int in_device_type, const char *def
 
 	multidevPart = false;
 
+	createValue (instrument, "instrument", "collect connection and event loop statistics", false, RTS2_VALUE_WRITABLE | RTS2_VALUE_DEBUG);
+	instrument->setValueBool (statsEnabled ());
+	createValue (loopLag, "loop_lag", "[s] 99% quantile of event loop wakeup delay", false, RTS2_VALUE_DEBUG | RTS2_DT_TIMEINTERVAL);
+	createValue (loopPoll, "loop_poll", "[s] average time spend processing socket events", false, RTS2_VALUE_DEBUG | RTS2_DT_TIMEINTERVAL);
+	createValue (loopIdle, "loop_idle", "[s] average time spend in idle call", false, RTS2_VALUE_DEBUG | RTS2_DT_TIMEINTERVAL);
+	createValue (commandRtt, "command_rtt", "[s] average command round trip time", false, RTS2_VALUE_DEBUG | RTS2_DT_TIMEINTERVAL);
+	createValue (bytesReceived, "bytes_received", "bytes received on all connections", false, RTS2_VALUE_DEBUG);
+	createValue (bytesSent, "bytes_sent", "bytes sent on all connections", false, RTS2_VALUE_DEBUG);
+	createValue (binaryRate, "binary_rate", "[bytes/s] average binary data transfer rate", false, RTS2_VALUE_DEBUG);
+	createValue (suppressedUpdates, "suppressed_updates", "number of value updates coalesced with later updates", false, RTS2_VALUE_DEBUG);
+
 	// now add options..
 	addOption (OPT_NOAUTH, "noauth", 0, "allow unauthorized connections");
 	addOption (OPT_NOTCHECKNULL, "notcheck", 0, "ignore if some recomended values are not set");
@@ -576,6 +588,44 @@ int Device::commandAuthorized (Connection * conn)
 	{
 		return autosaveValues ();
 	}
+	else if (conn->isCommand (COMMAND_VALUE_FRAMES))
+	{
+		int ver;
+		if (conn->paramNextInteger (&ver) || !conn->paramEnd ())
+			return -2;
+		if (ver != VALUE_FRAME_VERSION)
+		{
+			conn->sendCommandEnd (DEVDEM_E_PARAMSVAL, "unsupported value frame version");
+			return -1;
+		}
+		conn->setValueFrames (true);
+		return 0;
+	}
+	else if (conn->isCommand (COMMAND_VALUE_RATE))
+	{
+		double rate;
+		if (conn->paramNextDouble (&rate) || rate < 0)
+			return -2;
+		if (conn->paramEnd ())
+		{
+			conn->setValueRate (NULL, rate);
+			return 0;
+		}
+		while (!conn->paramEnd ())
+		{
+			char *vn;
+			if (conn->paramNextString (&vn))
+				return -2;
+			rts2core::Value *val = getOwnValue (vn);
+			if (val == NULL)
+			{
+				conn->sendCommandEnd (DEVDEM_E_PARAMSVAL, (std::string ("cannot find value ") + vn).c_str ());
+				return -1;
+			}
+			conn->setValueRate (val, rate);
+		}
+		return 0;
+	}
 	// we need to try that - due to other device commands
 	return -5;
 }
@@ -648,9 +698,71 @@ void Device::queDeviceStatusCommand (Connection *in_owner_conn)
 
 int Device::setValue (rts2core::Value * old_value, rts2core::Value * new_value)
 {
+	if (old_value == instrument)
+	{
+		setStatsEnabled (((rts2core::ValueBool *) new_value)->getValueBool ());
+		return 0;
+	}
 	return Daemon::setValue (old_value, new_value);
 }
 
+int Device::info ()
+{
+	if (instrument->getValueBool () != statsEnabled ())
+		instrument->setValueBool (statsEnabled ());
+	if (statsEnabled ())
+		updateStats ();
+
+	uint64_t suppressed = 0;
+	connections_t::iterator iter;
+	for (iter = getConnections ()->begin (); iter != getConnections ()->end (); iter++)
+		suppressed += (*iter)->getSuppressedUpdates ();
+	for (iter = getCentraldConns ()->begin (); iter != getCentraldConns ()->end (); iter++)
+		suppressed += (*iter)->getSuppressedUpdates ();
+	suppressedUpdates->setValueLong (suppressed);
+
+	return Daemon::info ();
+}
+
+void Device::updateStats ()
+{
+	const LoopStats &ls = getLoopStats ();
+	loopLag->setValueDouble (ls.lag.getQuantile (0.99));
+	loopPoll->setValueDouble (ls.poll.getMean ());
+	loopIdle->setValueDouble (ls.idle.getMean ());
+
+	double rttSum = 0;
+	uint64_t rttCount = 0;
+	uint64_t rx = 0;
+	uint64_t tx = 0;
+	uint64_t binBytes = 0;
+	double binTime = 0;
+
+	for (int i = 0; i < 2; i++)
+	{
+		connections_t *conns = (i == 0) ? getConnections () : getCentraldConns ();
+		for (connections_t::iterator iter = conns->begin (); iter != conns->end (); iter++)
+		{
+			const ConnStats &cs = (*iter)->getStats ();
+			rttSum += cs.getRoundTrip ().getSum ();
+			rttCount += cs.getRoundTrip ().getCount ();
+			rx += cs.getReceivedBytes ();
+			tx += cs.getSentBytes ();
+			double rate = cs.getBinaryRate ();
+			if (!isnan (rate))
+			{
+				uint64_t b = cs.getBinaryBytes (true) + cs.getBinaryBytes (false);
+				binBytes += b;
+				binTime += b / rate;
+			}
+		}
+	}
+	commandRtt->setValueDouble (rttCount > 0 ? rttSum / rttCount : NAN);
+	bytesReceived->setValueLong (rx);
+	bytesSent->setValueLong (tx);
+	binaryRate->setValueDouble (binTime > 0 ? binBytes / binTime : NAN);
+}
+
 Connection * Device::createClientConnection (NetworkAddress * in_addres)
 {
 	DevConnection *conn;
@@ -18,6 +18,7 @@
  */
 
 #include "expression.h"
+#include "compiledexpression.h"
 
 #include <ctype.h>
 
@@ -28,6 +29,16 @@ Expression *Expression::add (op_t _op)
 	return new ExpressionPair (this, _op, NULL);
 }
 
+static double evaluateExpression (void *arg)
+{
+	return ((Expression *) arg)->evaluate ();
+}
+
+void Expression::compile (CompiledExpression &program)
+{
+	program.pushCall (evaluateExpression, this);
+}
+
 double ExpressionPair::evaluate ()
 {
 	switch (op)
@@ -54,23 +65,68 @@ double ExpressionPair::evaluate ()
 	throw rts2core::Error ("unknow operand");
 }
 
+void ExpressionPair::compile (CompiledExpression &program)
+{
+	if (op != OR && op != AND)
+	{
+		exp1->compile (program);
+		exp2->compile (program);
+		program.pushOp (op);
+		return;
+	}
+
+	size_t start = program.size ();
+	exp1->compile (program);
+	double c;
+	if (program.isConstantSince (start, c))
+	{
+		program.truncate (start);
+		// false and .., true or ..
+		if ((op == AND) == (c == 0))
+		{
+			program.pushConst (op == OR);
+			return;
+		}
+		exp2->compile (program);
+		program.pushBool ();
+		return;
+	}
+	size_t jump = (op == AND) ? program.jumpIfFalse () : program.jumpIfTrue ();
+	exp2->compile (program);
+	program.pushBool ();
+	program.setLabel (jump);
+}
+
 Expression *ExpressionPair::add (op_t _op)
 {
 	if (_op < op)
 		return new ExpressionPair (this, _op, NULL);
 	if (exp2 == NULL)
 		throw rts2core::Error ("missing value");
-	return exp2->add (_op);
+	// operator with higher priority binds right operand
+	exp2 = exp2->add (_op);
+	return this;
 }
 
 Expression *ExpressionPair::add (Expression *_exp)
 {
 	if (exp2 != NULL)
-		return exp2->add (_exp);
-	exp2 = _exp;
+		exp2->add (_exp);
+	else
+		exp2 = _exp;
 	return this;
 }
 
+void ExpressionConst::compile (CompiledExpression &program)
+{
+	program.pushConst (val);
+}
+
+void ExpressionValue::compile (CompiledExpression &program)
+{
+	program.pushValue (deviceName.c_str (), valueName.c_str ());
+}
+
 double ExpressionValue::evaluate ()
 {
 	rts2core::Value *val = ((rts2core::Block *)getMasterApp ())->getValue (deviceName.c_str (), valueName.c_str ());
@@ -96,6 +152,8 @@ Expression * parseExpression (const char *str)
 			char val[i - b + 1];
 			memcpy (val, str + b, i - b);
 			val[i - b] = '\0';
+			// for loop increment moves to the character after token
+			i--;
 			// keywords..
 			if (!strcasecmp (val, "or"))
 			{
@@ -113,11 +171,12 @@ Expression * parseExpression (const char *str)
 			{
 				char *sep = strchr (val, '.');
 				if (sep == NULL)
+				{
+					delete root_exp;
 					throw rts2core::Error ("cannot find value separator (.)");
+				}
 				*sep = '\0';
 				sep++;
-				delete new_exp;
-				delete root_exp;
 				new_exp = new ExpressionValue (val, sep);
 			}
 		}
@@ -152,6 +211,7 @@ Expression * parseExpression (const char *str)
 					throw rts2core::Error ("number contains unallowed characters");
 				}
 			}
+			i--;
 			new_exp = new ExpressionConst (v);
 		}
 		else if (str[i] == '=' || str[i] == '>' || str[i] == '<' || str[i] == '!')
@@ -163,6 +223,8 @@ Expression * parseExpression (const char *str)
 			char val[i - b + 1];
 			memcpy (val, str + b, i - b);
 			val[i - b] = '\0';
+			// for loop increment moves to the character after token
+			i--;
 			if (!strcmp (val, "=="))
 			{
 				op = EQU;
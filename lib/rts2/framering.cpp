@@ -0,0 +1,179 @@
+/*
+ * Ring of preallocated frame buffers.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "framering.h"
+
+#include <string.h>
+
+using namespace rts2core;
+
+FrameRing::FrameRing ():frameBuffers (), written (), sequences (), used (), chunks ()
+{
+	channels = 0;
+	chanSize = 0;
+	next = 0;
+	cancelled = false;
+	pthread_mutex_init (&mutex, NULL);
+	pthread_cond_init (&released, NULL);
+}
+
+FrameRing::~FrameRing ()
+{
+	freeBuffers ();
+	pthread_mutex_destroy (&mutex);
+	pthread_cond_destroy (&released);
+}
+
+void FrameRing::allocate (int frames, int _channels, size_t _chanSize)
+{
+	pthread_mutex_lock (&mutex);
+	freeBuffers ();
+
+	channels = _channels;
+	chanSize = _chanSize;
+	next = 0;
+	cancelled = false;
+
+	for (int i = 0; i < frames; i++)
+	{
+		char **bufs = new char*[channels];
+		for (int ch = 0; ch < channels; ch++)
+			bufs[ch] = new char[chanSize];
+		frameBuffers.push_back (bufs);
+
+		size_t *w = new size_t[channels];
+		memset (w, 0, channels * sizeof (size_t));
+		written.push_back (w);
+
+		sequences.push_back (-1);
+		used.push_back (false);
+	}
+	pthread_mutex_unlock (&mutex);
+}
+
+int FrameRing::acquire (long seq)
+{
+	pthread_mutex_lock (&mutex);
+	if (frameBuffers.empty ())
+	{
+		pthread_mutex_unlock (&mutex);
+		return -1;
+	}
+	while (used[next] && !cancelled)
+		pthread_cond_wait (&released, &mutex);
+	if (cancelled)
+	{
+		pthread_mutex_unlock (&mutex);
+		return -1;
+	}
+
+	int frame = next;
+	used[frame] = true;
+	sequences[frame] = seq;
+	memset (written[frame], 0, channels * sizeof (size_t));
+	next = (next + 1) % frameBuffers.size ();
+
+	pthread_mutex_unlock (&mutex);
+	return frame;
+}
+
+void FrameRing::cancel ()
+{
+	pthread_mutex_lock (&mutex);
+	cancelled = true;
+	pthread_cond_broadcast (&released);
+	pthread_mutex_unlock (&mutex);
+}
+
+int FrameRing::write (int frame, int chan, const char *data, size_t size)
+{
+	if (chan < 0 || chan >= channels)
+		return -1;
+	size_t offset = written[frame][chan];
+	if (offset + size > chanSize)
+		return -1;
+	char *top = frameBuffers[frame][chan] + offset;
+	if (data != top)
+		memcpy (top, data, size);
+	written[frame][chan] += size;
+
+	pthread_mutex_lock (&mutex);
+	chunks.push_back (FrameChunk (frame, chan, offset, size));
+	pthread_mutex_unlock (&mutex);
+	return 0;
+}
+
+void FrameRing::finish (int frame, int ret)
+{
+	pthread_mutex_lock (&mutex);
+	chunks.push_back (FrameChunk (frame, -1, 0, 0, ret));
+	pthread_mutex_unlock (&mutex);
+}
+
+bool FrameRing::pop (FrameChunk &chunk)
+{
+	pthread_mutex_lock (&mutex);
+	if (chunks.empty ())
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	chunk = chunks.front ();
+	chunks.pop_front ();
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
+
+void FrameRing::release (int frame)
+{
+	pthread_mutex_lock (&mutex);
+	used[frame] = false;
+	pthread_cond_broadcast (&released);
+	pthread_mutex_unlock (&mutex);
+}
+
+int FrameRing::getUsed ()
+{
+	int ret = 0;
+	pthread_mutex_lock (&mutex);
+	for (std::vector <bool>::iterator iter = used.begin (); iter != used.end (); iter++)
+	{
+		if (*iter)
+			ret++;
+	}
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+void FrameRing::freeBuffers ()
+{
+	for (std::vector <char **>::iterator iter = frameBuffers.begin (); iter != frameBuffers.end (); iter++)
+	{
+		for (int ch = 0; ch < channels; ch++)
+			delete[] (*iter)[ch];
+		delete[] *iter;
+	}
+	for (std::vector <size_t *>::iterator iter = written.begin (); iter != written.end (); iter++)
+		delete[] *iter;
+	frameBuffers.clear ();
+	written.clear ();
+	sequences.clear ();
+	used.clear ();
+	chunks.clear ();
+}
@@ -65,6 +65,19 @@ void MultiDev::runLoop (float tmout)
 
 	for (iter = begin (); iter != end (); iter++)
 	{
+		// wake up to send values held by rate limit
+		double nextUpdate = (*iter)->flushValueUpdates ();
+		if (!isnan (nextUpdate))
+		{
+			double t_diff = nextUpdate - getNow ();
+			if (t_diff < 0)
+				t_diff = 0;
+			if (t_diff < read_tout.tv_sec + read_tout.tv_nsec / (double) NSEC_SEC)
+			{
+				read_tout.tv_sec = t_diff;
+				read_tout.tv_nsec = (t_diff - floor (t_diff)) * NSEC_SEC;
+			}
+		}
 		(*iter)->addPollSocks ();
 		polls += (*iter)->npolls;
 	}
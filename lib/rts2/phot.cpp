@@ -21,30 +21,98 @@
 #include "device.h"
 #include "status.h"
 
+#include <algorithm>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <syslog.h>
 #include <time.h>
 
+#define OPT_STREAM_BUFFER     OPT_LOCAL + 450
+
 using namespace rts2phot;
 
 Photometer::Photometer (int in_argc, char **in_argv):ScriptDevice (in_argc, in_argv, DEVICE_TYPE_PHOT, "PHOT")
 {
 	integrateConn = NULL;
 
+	samples = NULL;
+	streamBuffer = 65536;
+	samplePipe[0] = samplePipe[1] = -1;
+	bursting = false;
+	burstLimit = 0;
+	lastSend = 0;
+
 	createValue (filter, "filter", "used filter", false, RTS2_VALUE_WRITABLE);
 	createValue (req_count, "required", "number of readings left", false);
 	createValue (count, "count", "count of the photometer", false);
 	createValue (exp, "exposure", "exposure time in sec", false, RTS2_VALUE_WRITABLE);
 	createValue (is_ov, "is_ov", "if photometer overflow", false);
 
+	createValue (streamBatch, "stream_batch", "maximal number of burst samples send in single batch", false, RTS2_VALUE_WRITABLE);
+	streamBatch->setValueInteger (1000);
+	createValue (streamInterval, "stream_interval", "[s] maximal delay of burst samples", false, RTS2_VALUE_WRITABLE);
+	streamInterval->setValueDouble (0.1);
+	createValue (streamSamples, "stream_samples", "number of burst samples send", false);
+	createValue (streamLost, "stream_lost", "number of burst samples lost on buffer overrun", false);
+
 	photType = NULL;
 
 	req_count->setValueInteger (-1);
 	setReqTime (1);
+
+	addOption (OPT_STREAM_BUFFER, "stream-buffer", 1, "size of burst samples buffer (default to 65536)");
+}
+
+Photometer::~Photometer ()
+{
+	if (samplePipe[0] >= 0)
+	{
+		close (samplePipe[0]);
+		close (samplePipe[1]);
+	}
+	delete samples;
+}
+
+int Photometer::processOption (int in_opt)
+{
+	switch (in_opt)
+	{
+		case OPT_STREAM_BUFFER:
+			if (atoi (optarg) <= 0)
+			{
+				logStream (MESSAGE_ERROR) << "invalid burst samples buffer size: " << optarg << sendLog;
+				return -1;
+			}
+			streamBuffer = atoi (optarg);
+			break;
+		default:
+			return ScriptDevice::processOption (in_opt);
+	}
+	return 0;
+}
+
+int Photometer::init ()
+{
+	int ret = ScriptDevice::init ();
+	if (ret)
+		return ret;
+
+	samples = new SampleRing (streamBuffer);
+
+	if (pipe (samplePipe))
+	{
+		logStream (MESSAGE_ERROR) << "cannot create samples pipe: " << strerror (errno) << sendLog;
+		samplePipe[0] = samplePipe[1] = -1;
+		return -1;
+	}
+	fcntl (samplePipe[0], F_SETFL, O_NONBLOCK);
+	fcntl (samplePipe[1], F_SETFL, O_NONBLOCK);
+	return 0;
 }
 
 void Photometer::checkFilterMove ()
@@ -74,9 +142,37 @@ int Photometer::idle ()
 {
 	// check filter moving..
 	checkFilterMove ();
+	if (bursting)
+	{
+		double interval = streamInterval->getValueDouble ();
+		if (getNow () >= lastSend + interval)
+			sendSamples (true);
+		if (bursting)
+			setTimeoutMin ((long) (interval * USEC_SEC));
+	}
 	return ScriptDevice::idle ();
 }
 
+void Photometer::addPollSocks ()
+{
+	ScriptDevice::addPollSocks ();
+	if (samplePipe[0] >= 0)
+		addPollFD (samplePipe[0], POLLIN | POLLPRI);
+}
+
+void Photometer::pollSuccess ()
+{
+	ScriptDevice::pollSuccess ();
+	if (samplePipe[0] >= 0 && isForRead (samplePipe[0]))
+	{
+		char buf[100];
+		while (read (samplePipe[0], buf, sizeof (buf)) > 0)
+			;
+		if (bursting)
+			sendSamples (false);
+	}
+}
+
 int Photometer::homeFilter ()
 {
 	return -1;
@@ -134,8 +230,146 @@ int Photometer::endIntegrate ()
 	return 0;
 }
 
+int Photometer::startBurst (rts2core::Connection * conn, float _req_time, int _req_count)
+{
+	if (bursting)
+	{
+		conn->sendCommandEnd (DEVDEM_E_HW, "burst is already running");
+		return -1;
+	}
+	if (!(_req_time > 0) || _req_count < 0)
+		return -2;
+
+	req_time = _req_time;
+	exp->setValueFloat (req_time);
+	sendValueAll (exp);
+	req_count->setValueInteger (_req_count > 0 ? _req_count : -1);
+	sendValueAll (req_count);
+	streamSamples->setValueLong (0);
+	sendValueAll (streamSamples);
+	streamLost->setValueLong (0);
+	sendValueAll (streamLost);
+
+	burstLimit = _req_count;
+	samples->reset (burstLimit);
+	integrateConn = conn;
+	bursting = true;
+	lastSend = getNow ();
+
+	if (startBurst ())
+	{
+		bursting = false;
+		integrateConn = NULL;
+		req_count->setValueInteger (-1);
+		conn->sendCommandEnd (DEVDEM_E_HW, "cannot start burst");
+		return -1;
+	}
+	maskState (PHOT_MASK_INTEGRATE, PHOT_INTEGRATE, "burst started");
+	return 0;
+}
+
+bool Photometer::addSample (const struct timeval *tv, uint32_t in_count, float in_exp, bool in_is_ov)
+{
+	PhotSample s ((uint64_t) tv->tv_sec * USEC_SEC + tv->tv_usec, in_count, in_exp, filter->getValueInteger (), in_is_ov);
+	if (!samples->push (s))
+		return false;
+	size_t batch = streamBatch->getValueInteger ();
+	if (samples->size () % batch == 0 || (burstLimit > 0 && samples->getPushed () >= burstLimit))
+		notifySamples ();
+	return true;
+}
+
+void Photometer::notifySamples ()
+{
+	char c = 0;
+	// pipe full means main loop has not yet processed previous notifications
+	if (write (samplePipe[1], &c, 1) < 0 && errno != EAGAIN)
+		std::cerr << "cannot notify main loop about burst samples: " << strerror (errno) << std::endl;
+}
+
+void Photometer::sendSamples (bool all)
+{
+	size_t batchMax = streamBatch->getValueInteger ();
+	std::vector <PhotSample> batch;
+	long sent = 0;
+
+	while (true)
+	{
+		size_t waiting = samples->size ();
+		if (waiting == 0 || (!all && waiting < batchMax))
+			break;
+		batch.clear ();
+		samples->pop (batch, batchMax);
+		sendBatch (batch);
+		sent += batch.size ();
+	}
+
+	if (all || sent > 0)
+		lastSend = getNow ();
+
+	if (sent > 0)
+	{
+		// values are updated once per batch, not per sample
+		const PhotSample &last = batch.back ();
+		count->setValueInteger (last.count);
+		exp->setValueFloat (last.exp);
+		is_ov->setValueBool (last.overflow);
+		streamSamples->setValueLong (streamSamples->getValueLong () + sent);
+		streamLost->setValueLong (samples->getDropped ());
+		sendValueAll (exp);
+		sendValueAll (is_ov);
+		sendValueAll (count);
+		sendValueAll (streamSamples);
+		sendValueAll (streamLost);
+		if (burstLimit > 0)
+		{
+			req_count->setValueInteger (burstLimit - samples->getPushed () + samples->size ());
+			sendValueAll (req_count);
+		}
+	}
+
+	if (bursting && samples->isFinished ())
+		endBurst ("burst finished");
+}
+
+void Photometer::sendBatch (std::vector <PhotSample> &batch)
+{
+	size_t size = batchSize (batch.size ());
+	char *buf = new char[size];
+	packSamples (batch, buf);
+
+	std::list <rts2core::Connection *> conns = streamConns;
+	if (integrateConn && std::find (conns.begin (), conns.end (), integrateConn) == conns.end ())
+		conns.push_back (integrateConn);
+
+	for (std::list <rts2core::Connection *>::iterator iter = conns.begin (); iter != conns.end (); iter++)
+	{
+		int data_conn = (*iter)->startBinaryData (RTS2_DATA_PHOTSAMPLES, 1, &size);
+		if (data_conn >= 0)
+			(*iter)->sendBinaryData (data_conn, 0, buf, size);
+	}
+	delete[] buf;
+}
+
+void Photometer::endBurst (const char *msg)
+{
+	stopBurst ();
+	bursting = false;
+	// samples produced before the driver stopped
+	sendSamples (true);
+	integrateConn = NULL;
+	req_count->setValueInteger (-1);
+	sendValueAll (req_count);
+	maskState (PHOT_MASK_INTEGRATE, PHOT_NOINTEGRATE, msg);
+}
+
 int Photometer::stopIntegrate ()
 {
+	if (bursting)
+	{
+		endBurst ("burst interrupted");
+		return 0;
+	}
 	maskState (PHOT_MASK_INTEGRATE, PHOT_NOINTEGRATE, "Integration interrupted");
 	startIntegrate ();
 	return 0;
@@ -214,6 +448,9 @@ void Photometer::postEvent (rts2core::Event *event)
 	switch (event->getType ())
 	{
 		case PHOT_EVENT_CHECK:
+			// burst samples are not polled
+			if (bursting)
+				break;
 			ret = getCount ();
 			if (ret >= 0 && req_count->getValueInteger () > 0)
 				addTimer (ret, new rts2core::Event (PHOT_EVENT_CHECK, this));
@@ -230,6 +467,10 @@ int Photometer::setValue (rts2core::Value * old_value, rts2core::Value * new_val
 		return moveFilter (new_value->getValueInteger ()) == 0 ? 0 : -2;
 	if (old_value == exp)
 		return setExposure (new_value->getValueFloat ()) == 0 ? 0 : -2;
+	if (old_value == streamBatch)
+		return new_value->getValueInteger () > 0 ? 0 : -2;
+	if (old_value == streamInterval)
+		return new_value->getValueDouble () > 0 ? 0 : -2;
 	return ScriptDevice::setValue (old_value, new_value);
 }
 
@@ -285,6 +526,28 @@ int Photometer::commandAuthorized (rts2core::Connection * conn)
 		return startIntegrate (conn, new_req_time, new_req_count);
 	}
 
+	else if (conn->isCommand ("burst"))
+	{
+		float new_req_time;
+		int new_req_count;
+		if (conn->paramNextFloat (&new_req_time)
+			|| conn->paramNextInteger (&new_req_count) || !conn->paramEnd ())
+			return -2;
+
+		return startBurst (conn, new_req_time, new_req_count);
+	}
+
+	else if (conn->isCommand ("stream"))
+	{
+		int subscribe;
+		if (conn->paramNextInteger (&subscribe) || !conn->paramEnd ())
+			return -2;
+		streamConns.remove (conn);
+		if (subscribe)
+			streamConns.push_back (conn);
+		return 0;
+	}
+
 	else if (conn->isCommand ("stop"))
 	{
 		return stopIntegrate ();
@@ -309,6 +572,8 @@ int Photometer::commandAuthorized (rts2core::Connection * conn)
 		conn->sendMsg ("exit - exit from main loop");
 		conn->sendMsg ("help - print, what you are reading just now");
 		conn->sendMsg ("integrate <time> <count> - start integration");
+		conn->sendMsg ("burst <time> <count> - stream <count> integrations (0 until stopped) over data channel");
+		conn->sendMsg ("stream <0|1> - receive burst samples started by other connection");
 		conn->sendMsg ("enable - enable filter movements");
 		conn->sendMsg ("stop - stop any running integration");
 		return 0;
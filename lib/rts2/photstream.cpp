@@ -0,0 +1,247 @@
+/*
+ * Buffered stream of photometer samples.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "photstream.h"
+
+#include <arpa/inet.h>
+#include <string.h>
+#include <time.h>
+
+using namespace rts2phot;
+
+SampleRing::SampleRing (size_t _capacity):samples (_capacity)
+{
+	capacity = _capacity;
+	head = 0;
+	used = 0;
+	limit = 0;
+	pushed = 0;
+	dropped = 0;
+	pthread_mutex_init (&mutex, NULL);
+}
+
+SampleRing::~SampleRing ()
+{
+	pthread_mutex_destroy (&mutex);
+}
+
+void SampleRing::reset (uint64_t _limit)
+{
+	pthread_mutex_lock (&mutex);
+	head = 0;
+	used = 0;
+	limit = _limit;
+	pushed = 0;
+	dropped = 0;
+	pthread_mutex_unlock (&mutex);
+}
+
+bool SampleRing::push (const PhotSample &sample)
+{
+	pthread_mutex_lock (&mutex);
+	if (limit > 0 && pushed >= limit)
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	if (used >= capacity)
+	{
+		pushed++;
+		dropped++;
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	PhotSample &s = samples[(head + used) % capacity];
+	s = sample;
+	s.seq = pushed++;
+	used++;
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
+
+size_t SampleRing::pop (std::vector <PhotSample> &out, size_t max)
+{
+	pthread_mutex_lock (&mutex);
+	size_t n = 0;
+	while (n < used && n < max)
+	{
+		// batch carries only sequence number of its first sample
+		if (n > 0 && samples[head].seq != out.back ().seq + 1)
+			break;
+		out.push_back (samples[head]);
+		head = (head + 1) % capacity;
+		n++;
+	}
+	used -= n;
+	pthread_mutex_unlock (&mutex);
+	return n;
+}
+
+size_t SampleRing::size ()
+{
+	pthread_mutex_lock (&mutex);
+	size_t ret = used;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+bool SampleRing::isFinished ()
+{
+	pthread_mutex_lock (&mutex);
+	bool ret = limit > 0 && pushed >= limit && used == 0;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+uint64_t SampleRing::getPushed ()
+{
+	pthread_mutex_lock (&mutex);
+	uint64_t ret = pushed;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+uint64_t SampleRing::getDropped ()
+{
+	pthread_mutex_lock (&mutex);
+	uint64_t ret = dropped;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+void SampleClock::runClock (double period, volatile bool &stop)
+{
+	long nsec = (long) (period * 1000000000.0);
+	if (nsec < 1)
+		nsec = 1;
+
+	struct timespec next;
+	clock_gettime (CLOCK_REALTIME, &next);
+	next.tv_nsec += nsec;
+	next.tv_sec += next.tv_nsec / 1000000000;
+	next.tv_nsec %= 1000000000;
+
+	while (!stop)
+	{
+		struct timespec now;
+		clock_gettime (CLOCK_REALTIME, &now);
+		while (next.tv_sec < now.tv_sec || (next.tv_sec == now.tv_sec && next.tv_nsec <= now.tv_nsec))
+		{
+			struct timeval tv;
+			tv.tv_sec = next.tv_sec;
+			tv.tv_usec = next.tv_nsec / 1000;
+			if (!sample (&tv))
+				return;
+
+			next.tv_nsec += nsec;
+			next.tv_sec += next.tv_nsec / 1000000000;
+			next.tv_nsec %= 1000000000;
+		}
+
+		struct timespec wake = now;
+		wake.tv_nsec += 1000000;
+		wake.tv_sec += wake.tv_nsec / 1000000000;
+		wake.tv_nsec %= 1000000000;
+		if (next.tv_sec < wake.tv_sec || (next.tv_sec == wake.tv_sec && next.tv_nsec < wake.tv_nsec))
+			wake = next;
+		clock_nanosleep (CLOCK_REALTIME, TIMER_ABSTIME, &wake, NULL);
+	}
+}
+
+static char *put32 (char *buf, uint32_t v)
+{
+	v = htonl (v);
+	memcpy (buf, &v, 4);
+	return buf + 4;
+}
+
+static char *put64 (char *buf, uint64_t v)
+{
+	buf = put32 (buf, v >> 32);
+	return put32 (buf, v & 0xffffffff);
+}
+
+static const char *get32 (const char *buf, uint32_t &v)
+{
+	memcpy (&v, buf, 4);
+	v = ntohl (v);
+	return buf + 4;
+}
+
+static const char *get64 (const char *buf, uint64_t &v)
+{
+	uint32_t hi, lo;
+	buf = get32 (buf, hi);
+	buf = get32 (buf, lo);
+	v = ((uint64_t) hi << 32) | lo;
+	return buf;
+}
+
+size_t rts2phot::packSamples (const std::vector <PhotSample> &samples, char *buf)
+{
+	char *top = buf;
+	top = put64 (top, samples.empty () ? 0 : samples.front ().seq);
+	top = put32 (top, samples.size ());
+	top = put32 (top, 0);
+
+	for (std::vector <PhotSample>::const_iterator iter = samples.begin (); iter != samples.end (); iter++)
+	{
+		uint32_t e;
+		memcpy (&e, &(iter->exp), 4);
+
+		top = put64 (top, iter->usec);
+		top = put32 (top, iter->count);
+		top = put32 (top, e);
+		top = put32 (top, ((uint32_t) (iter->filter & 0xffff) << 16) | (iter->overflow ? PHOTSTREAM_OVERFLOW : 0));
+	}
+	return top - buf;
+}
+
+int rts2phot::unpackSamples (const char *buf, size_t size, std::vector <PhotSample> &samples)
+{
+	if (size < PHOTSTREAM_HEADER_SIZE)
+		return -1;
+
+	uint64_t seq;
+	uint32_t n, reserved;
+	const char *top = buf;
+	top = get64 (top, seq);
+	top = get32 (top, n);
+	top = get32 (top, reserved);
+
+	if (size != batchSize (n))
+		return -1;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		PhotSample s;
+		uint32_t e, ff;
+		top = get64 (top, s.usec);
+		top = get32 (top, s.count);
+		top = get32 (top, e);
+		top = get32 (top, ff);
+
+		s.seq = seq + i;
+		memcpy (&(s.exp), &e, 4);
+		s.filter = (int16_t) (ff >> 16);
+		s.overflow = ff & PHOTSTREAM_OVERFLOW;
+		samples.push_back (s);
+	}
+	return n;
+}
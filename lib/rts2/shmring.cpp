@@ -0,0 +1,371 @@
+/*
+ * Lock-free frame ring in POSIX shared memory.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "shmring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+using namespace rts2core;
+
+// slots are aligned to cache line / page boundary
+#define SLOT_ALIGN     4096
+
+static inline size_t alignSize (size_t s)
+{
+	return (s + SLOT_ALIGN - 1) & ~((size_t) SLOT_ALIGN - 1);
+}
+
+static inline uint64_t loadAcquire (uint64_t *p)
+{
+	return __atomic_load_n (p, __ATOMIC_ACQUIRE);
+}
+
+static inline void storeRelease (uint64_t *p, uint64_t v)
+{
+	__atomic_store_n (p, v, __ATOMIC_RELEASE);
+}
+
+static inline struct ShmRingSlot *getSlot (struct ShmRingHeader *ring, uint64_t frame)
+{
+	return (struct ShmRingSlot *) (((char *) ring) + ring->slotOffset + (frame % ring->nslots) * ring->slotStride);
+}
+
+static inline char *getSlotData (struct ShmRingSlot *slot)
+{
+	return ((char *) slot) + alignSize (sizeof (struct ShmRingSlot));
+}
+
+ShmRingWriter::ShmRingWriter ():name ()
+{
+	fd = -1;
+	ring = NULL;
+	mapSize = 0;
+	frameData = NULL;
+	frameSlot = NULL;
+}
+
+ShmRingWriter::~ShmRingWriter ()
+{
+	unmap ();
+}
+
+int ShmRingWriter::create (const char *_name, int nslots, size_t slotSize)
+{
+	unmap ();
+
+	if (nslots < 2)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	if (_name)
+	{
+		// readers map the ring read-only, only the writer may modify it
+		fd = shm_open (_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fd >= 0)
+		{
+			// segment left by previous run can have wider permissions
+			fchmod (fd, 0644);
+			name = _name;
+		}
+	}
+	else
+	{
+#ifdef SYS_memfd_create
+		fd = syscall (SYS_memfd_create, "rts2ring", 0);
+#else
+		errno = ENOSYS;
+#endif
+	}
+	if (fd < 0)
+		return -1;
+
+	size_t stride = alignSize (sizeof (struct ShmRingSlot)) + alignSize (slotSize);
+	size_t offset = alignSize (sizeof (struct ShmRingHeader));
+	mapSize = offset + nslots * stride;
+
+	void *m = MAP_FAILED;
+	if (ftruncate (fd, mapSize) == 0)
+		m = mmap (NULL, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (m == MAP_FAILED)
+	{
+		int err = errno;
+		unmap ();
+		errno = err;
+		return -1;
+	}
+	ring = (struct ShmRingHeader *) m;
+
+	// ftruncate zeroed the memory, all slot seqs are 0 - empty
+	ring->version = SHMRING_VERSION;
+	ring->nslots = nslots;
+	ring->slotSize = slotSize;
+	ring->slotOffset = offset;
+	ring->slotStride = stride;
+	storeRelease (&(ring->published), 0);
+	// readers check magic last
+	__atomic_store_n (&(ring->magic), SHMRING_MAGIC, __ATOMIC_RELEASE);
+	return 0;
+}
+
+int ShmRingWriter::getSlots ()
+{
+	return ring ? ring->nslots : 0;
+}
+
+size_t ShmRingWriter::getSlotSize ()
+{
+	return ring ? ring->slotSize : 0;
+}
+
+char *ShmRingWriter::beginFrame ()
+{
+	if (ring == NULL)
+		return NULL;
+	uint64_t frame = ring->published;
+	frameSlot = getSlot (ring, frame);
+	// odd value marks slot being written
+	storeRelease (&(frameSlot->seq), 2 * frame + 1);
+	// data must not be written before readers can see the odd seq
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	frameData = getSlotData (frameSlot);
+	return frameData;
+}
+
+void ShmRingWriter::endFrame (int channels, size_t *chanSizes, struct imghdr *header, double timestamp)
+{
+	if (frameData == NULL)
+		return;
+	uint64_t frame = ring->published;
+
+	if (channels > SHMRING_MAX_CHANNELS)
+		channels = SHMRING_MAX_CHANNELS;
+
+	frameSlot->frame = frame;
+	frameSlot->timestamp = timestamp;
+	frameSlot->channels = channels;
+	for (int i = 0; i < channels; i++)
+		frameSlot->chanSizes[i] = chanSizes[i];
+	if (header)
+		frameSlot->header = *header;
+	else
+		memset (&(frameSlot->header), 0, sizeof (struct imghdr));
+
+	storeRelease (&(frameSlot->seq), 2 * frame + 2);
+	storeRelease (&(ring->published), frame + 1);
+
+	frameData = NULL;
+	frameSlot = NULL;
+}
+
+void ShmRingWriter::abortFrame ()
+{
+	// slot keeps odd seq, readers skip it; next beginFrame reuses it
+	frameData = NULL;
+	frameSlot = NULL;
+}
+
+uint64_t ShmRingWriter::getPublished ()
+{
+	return ring ? loadAcquire (&(ring->published)) : 0;
+}
+
+void ShmRingWriter::unmap ()
+{
+	if (ring)
+	{
+		munmap (ring, mapSize);
+		ring = NULL;
+	}
+	if (fd >= 0)
+	{
+		close (fd);
+		fd = -1;
+	}
+	if (name.length () > 0)
+	{
+		shm_unlink (name.c_str ());
+		name = "";
+	}
+	frameData = NULL;
+	frameSlot = NULL;
+}
+
+ShmRingReader::ShmRingReader ()
+{
+	fd = -1;
+	ring = NULL;
+	mapSize = 0;
+	next = 0;
+	lost = 0;
+	lastLatest = 0;
+}
+
+ShmRingReader::~ShmRingReader ()
+{
+	if (ring)
+		munmap (ring, mapSize);
+	if (fd >= 0)
+		close (fd);
+}
+
+int ShmRingReader::attach (const char *name)
+{
+	int _fd = shm_open (name, O_RDONLY, 0);
+	if (_fd < 0)
+		return -1;
+	return map (_fd);
+}
+
+int ShmRingReader::attachFd (int _fd)
+{
+	int d = dup (_fd);
+	if (d < 0)
+		return -1;
+	return map (d);
+}
+
+int ShmRingReader::map (int _fd)
+{
+	struct stat st;
+	if (fstat (_fd, &st) || (size_t) st.st_size < sizeof (struct ShmRingHeader))
+	{
+		close (_fd);
+		errno = EINVAL;
+		return -1;
+	}
+	void *m = mmap (NULL, st.st_size, PROT_READ, MAP_SHARED, _fd, 0);
+	if (m == MAP_FAILED)
+	{
+		int err = errno;
+		close (_fd);
+		errno = err;
+		return -1;
+	}
+	struct ShmRingHeader *r = (struct ShmRingHeader *) m;
+	if (__atomic_load_n (&(r->magic), __ATOMIC_ACQUIRE) != SHMRING_MAGIC || r->version != SHMRING_VERSION
+		|| r->slotOffset + r->nslots * r->slotStride > (size_t) st.st_size)
+	{
+		munmap (m, st.st_size);
+		close (_fd);
+		errno = EINVAL;
+		return -1;
+	}
+	fd = _fd;
+	ring = r;
+	mapSize = st.st_size;
+	// start with frames published from now on
+	next = loadAcquire (&(ring->published));
+	lastLatest = next;
+	lost = 0;
+	return 0;
+}
+
+size_t ShmRingReader::getSlotSize ()
+{
+	return ring ? ring->slotSize : 0;
+}
+
+uint64_t ShmRingReader::getPublished ()
+{
+	return ring ? loadAcquire (&(ring->published)) : 0;
+}
+
+int ShmRingReader::copyFrame (uint64_t frame, char *buf, ShmFrameInfo &info)
+{
+	struct ShmRingSlot *slot = getSlot (ring, frame);
+	uint64_t seq = loadAcquire (&(slot->seq));
+	if (seq != 2 * frame + 2)
+		return 0;
+
+	info.frame = slot->frame;
+	info.timestamp = slot->timestamp;
+	info.channels = slot->channels;
+	if (info.channels > SHMRING_MAX_CHANNELS)
+		return 0;
+	info.size = 0;
+	for (int i = 0; i < info.channels; i++)
+	{
+		info.chanSizes[i] = slot->chanSizes[i];
+		info.size += info.chanSizes[i];
+	}
+	info.header = slot->header;
+	if (info.size > ring->slotSize)
+		return 0;
+
+	memcpy (buf, getSlotData (slot), info.size);
+
+	// check the writer did not start to overwrite the slot during copy
+	__atomic_thread_fence (__ATOMIC_ACQUIRE);
+	if (__atomic_load_n (&(slot->seq), __ATOMIC_RELAXED) != seq)
+		return 0;
+	return 1;
+}
+
+int ShmRingReader::readLatest (char *buf, ShmFrameInfo &info)
+{
+	if (ring == NULL)
+		return -1;
+	while (true)
+	{
+		uint64_t published = loadAcquire (&(ring->published));
+		if (published == 0 || published <= lastLatest)
+			return 0;
+		if (copyFrame (published - 1, buf, info))
+		{
+			lastLatest = published;
+			return 1;
+		}
+		// frame was overwritten during copy, try the newer one
+	}
+}
+
+int ShmRingReader::readNext (char *buf, ShmFrameInfo &info)
+{
+	if (ring == NULL)
+		return -1;
+	while (true)
+	{
+		uint64_t published = loadAcquire (&(ring->published));
+		if (next >= published)
+			return 0;
+		// the oldest frame which can still be in the ring; writer may be writing to the slot of published - nslots
+		uint64_t oldest = published > (uint64_t) ring->nslots - 1 ? published - (ring->nslots - 1) : 0;
+		if (next < oldest)
+		{
+			lost += oldest - next;
+			next = oldest;
+		}
+		if (copyFrame (next, buf, info))
+		{
+			next++;
+			return 1;
+		}
+		// overwritten during copy
+		lost++;
+		next++;
+	}
+}
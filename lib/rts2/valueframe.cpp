@@ -0,0 +1,265 @@
+/*
+ * Binary framing of value updates.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "valueframe.h"
+#include "valuearray.h"
+
+using namespace rts2core;
+
+static inline uint16_t getUInt16 (const unsigned char *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t getUInt32 (const unsigned char *p)
+{
+	return ((uint32_t) p[0]) | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+static inline uint64_t getUInt64 (const unsigned char *p)
+{
+	return ((uint64_t) getUInt32 (p)) | ((uint64_t) getUInt32 (p + 4) << 32);
+}
+
+static inline double getDouble (const unsigned char *p)
+{
+	uint64_t u = getUInt64 (p);
+	double d;
+	memcpy (&d, &u, sizeof (d));
+	return d;
+}
+
+ValueFrame::ValueFrame ()
+{
+	count = 0;
+}
+
+int ValueFrame::encodingType (Value *value)
+{
+	switch (value->getValueType ())
+	{
+		case RTS2_VALUE_DOUBLE:
+		case RTS2_VALUE_TIME:
+			return VF_DOUBLE;
+		case RTS2_VALUE_FLOAT:
+			return VF_FLOAT;
+		case RTS2_VALUE_INTEGER:
+		case RTS2_VALUE_BOOL:
+		case RTS2_VALUE_SELECTION:
+			return VF_INTEGER;
+		case RTS2_VALUE_LONGINT:
+			return VF_LONG;
+		case RTS2_VALUE_STRING:
+			return VF_STRING;
+		case RTS2_VALUE_ARRAY | RTS2_VALUE_DOUBLE:
+		case RTS2_VALUE_ARRAY | RTS2_VALUE_TIME:
+			return VF_DOUBLE_ARRAY;
+		case RTS2_VALUE_ARRAY | RTS2_VALUE_INTEGER:
+		case RTS2_VALUE_ARRAY | RTS2_VALUE_BOOL:
+			return VF_INTEGER_ARRAY;
+	}
+	return 0;
+}
+
+bool ValueFrame::add (Value *value)
+{
+	int t = encodingType (value);
+	if (t == 0)
+		return false;
+
+	std::string name = value->getName ();
+	buf.push_back ((char) t);
+	putUInt16 (name.length ());
+	buf.append (name);
+
+	switch (t)
+	{
+		case VF_DOUBLE:
+			putDouble (value->getValueDouble ());
+			break;
+		case VF_FLOAT:
+			{
+				float f = value->getValueFloat ();
+				uint32_t u;
+				memcpy (&u, &f, sizeof (u));
+				putUInt32 (u);
+			}
+			break;
+		case VF_INTEGER:
+			putUInt32 ((uint32_t) value->getValueInteger ());
+			break;
+		case VF_LONG:
+			putUInt64 ((uint64_t) value->getValueLong ());
+			break;
+		case VF_STRING:
+			{
+				const char *s = value->getValue ();
+				size_t l = s ? strlen (s) : 0;
+				putUInt32 (l);
+				buf.append (s ? s : "", l);
+			}
+			break;
+		case VF_DOUBLE_ARRAY:
+			{
+				const std::vector <double> &arr = ((DoubleArray *) value)->getValueVector ();
+				putUInt32 (arr.size ());
+				for (std::vector <double>::const_iterator iter = arr.begin (); iter != arr.end (); iter++)
+					putDouble (*iter);
+			}
+			break;
+		case VF_INTEGER_ARRAY:
+			{
+				const std::vector <int> &arr = ((IntegerArray *) value)->getValueVector ();
+				putUInt32 (arr.size ());
+				for (std::vector <int>::const_iterator iter = arr.begin (); iter != arr.end (); iter++)
+					putUInt32 ((uint32_t) *iter);
+			}
+			break;
+	}
+	count++;
+	return true;
+}
+
+void ValueFrame::clear ()
+{
+	buf.clear ();
+	count = 0;
+}
+
+int ValueFrame::decode (const char *data, size_t len, ValueVector &values, std::vector <Value *> *updated)
+{
+	const unsigned char *p = (const unsigned char *) data;
+	const unsigned char *end = p + len;
+	int records = 0;
+
+	while (p < end)
+	{
+		if (end - p < 3)
+			return -1;
+		int t = *p;
+		uint16_t nl = getUInt16 (p + 1);
+		p += 3;
+		if (end - p < nl)
+			return -1;
+		std::string name ((const char *) p, nl);
+		p += nl;
+
+		// size of the value data
+		size_t vs;
+		uint32_t n = 0;
+		switch (t)
+		{
+			case VF_DOUBLE:
+			case VF_LONG:
+				vs = 8;
+				break;
+			case VF_FLOAT:
+			case VF_INTEGER:
+				vs = 4;
+				break;
+			case VF_STRING:
+			case VF_DOUBLE_ARRAY:
+			case VF_INTEGER_ARRAY:
+				if (end - p < 4)
+					return -1;
+				n = getUInt32 (p);
+				p += 4;
+				vs = (size_t) n * (t == VF_STRING ? 1 : (t == VF_DOUBLE_ARRAY ? 8 : 4));
+				break;
+			default:
+				return -1;
+		}
+		if ((size_t) (end - p) < vs)
+			return -1;
+
+		Value *value = values.getValue (name.c_str ());
+		if (value != NULL && encodingType (value) == t)
+		{
+			switch (t)
+			{
+				case VF_DOUBLE:
+					((ValueDouble *) value)->setValueDouble (getDouble (p));
+					break;
+				case VF_FLOAT:
+					{
+						uint32_t u = getUInt32 (p);
+						float f;
+						memcpy (&f, &u, sizeof (f));
+						((ValueFloat *) value)->setValueFloat (f);
+					}
+					break;
+				case VF_INTEGER:
+					value->setValueInteger ((int32_t) getUInt32 (p));
+					break;
+				case VF_LONG:
+					((ValueLong *) value)->setValueLong ((int64_t) getUInt64 (p));
+					break;
+				case VF_STRING:
+					value->setValueCharArr (std::string ((const char *) p, n).c_str ());
+					break;
+				case VF_DOUBLE_ARRAY:
+					{
+						std::vector <double> arr (n);
+						for (uint32_t i = 0; i < n; i++)
+							arr[i] = getDouble (p + i * 8);
+						((DoubleArray *) value)->setValueArray (arr);
+					}
+					break;
+				case VF_INTEGER_ARRAY:
+					{
+						std::vector <int> arr (n);
+						for (uint32_t i = 0; i < n; i++)
+							arr[i] = (int32_t) getUInt32 (p + i * 4);
+						((IntegerArray *) value)->setValueArray (arr);
+					}
+					break;
+			}
+			if (updated)
+				updated->push_back (value);
+		}
+		p += vs;
+		records++;
+	}
+	return records;
+}
+
+void ValueFrame::putUInt16 (uint16_t v)
+{
+	char b[2] = {(char) (v & 0xff), (char) (v >> 8)};
+	buf.append (b, 2);
+}
+
+void ValueFrame::putUInt32 (uint32_t v)
+{
+	char b[4] = {(char) (v & 0xff), (char) ((v >> 8) & 0xff), (char) ((v >> 16) & 0xff), (char) (v >> 24)};
+	buf.append (b, 4);
+}
+
+void ValueFrame::putUInt64 (uint64_t v)
+{
+	putUInt32 (v & 0xffffffff);
+	putUInt32 (v >> 32);
+}
+
+void ValueFrame::putDouble (double v)
+{
+	uint64_t u;
+	memcpy (&u, &v, sizeof (u));
+	putUInt64 (u);
+}
@@ -0,0 +1,315 @@
+/*
+ * Pool of database connections with prepared statements cache.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2db/pgpool.h"
+#include "rts2db/sqlerror.h"
+#include "nan.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// maximal number of prepared statements kept on connection
+#define MAX_PREPARED    200
+
+using namespace rts2db;
+
+int PgResult::getInt (int row, int col, int def)
+{
+	if (isNull (row, col))
+		return def;
+	return atoi (PQgetvalue (res, row, col));
+}
+
+double PgResult::getDouble (int row, int col)
+{
+	if (isNull (row, col))
+		return NAN;
+	return atof (PQgetvalue (res, row, col));
+}
+
+PgConnection::PgConnection (const char *dbname, const char *user, const char *password)
+{
+	const char *keywords[4];
+	const char *values[4];
+	int i = 0;
+
+	keywords[i] = "dbname";
+	values[i++] = dbname;
+	if (user && *user)
+	{
+		keywords[i] = "user";
+		values[i++] = user;
+	}
+	if (password && *password)
+	{
+		keywords[i] = "password";
+		values[i++] = password;
+	}
+	keywords[i] = NULL;
+	values[i] = NULL;
+
+	// dbname can be connection string or URI
+	conn = PQconnectdbParams (keywords, values, 1);
+
+	nextName = 0;
+	useCounter = 0;
+}
+
+PgConnection::~PgConnection ()
+{
+	PQfinish (conn);
+}
+
+void PgConnection::reset ()
+{
+	PQreset (conn);
+	statements.clear ();
+}
+
+PGresult *PgConnection::execute (const char *sql, const std::vector <std::string> &params)
+{
+	PGresult *res;
+
+	// SQL without parameters has values written in its text, so it is not worth to keep it prepared
+	if (params.empty ())
+	{
+		res = PQexecParams (conn, sql, 0, NULL, NULL, NULL, NULL, 0);
+	}
+	else
+	{
+		std::map <std::string, Prepared>::iterator iter = statements.find (sql);
+		if (iter == statements.end ())
+		{
+			if (statements.size () >= MAX_PREPARED)
+				deallocateOldest ();
+
+			char name[30];
+			snprintf (name, sizeof (name), "rts2_s%lu", nextName++);
+
+			res = PQprepare (conn, name, sql, 0, NULL);
+			stats.roundTrips++;
+			if (PQresultStatus (res) != PGRES_COMMAND_OK)
+			{
+				SqlError err (sql, PQresultErrorMessage (res));
+				PQclear (res);
+				throw err;
+			}
+			PQclear (res);
+			stats.prepares++;
+
+			iter = statements.insert (std::pair <std::string, Prepared> (sql, Prepared ())).first;
+			iter->second.name = name;
+		}
+		else
+		{
+			stats.cached++;
+		}
+		iter->second.lastUsed = ++useCounter;
+
+		std::vector <const char *> values;
+		for (std::vector <std::string>::const_iterator piter = params.begin (); piter != params.end (); piter++)
+			values.push_back (piter->c_str ());
+
+		res = PQexecPrepared (conn, iter->second.name.c_str (), values.size (), &(values[0]), NULL, NULL, 0);
+	}
+	stats.roundTrips++;
+	stats.executes++;
+	if (PQresultStatus (res) != PGRES_TUPLES_OK && PQresultStatus (res) != PGRES_COMMAND_OK)
+	{
+		SqlError err (sql, PQresultErrorMessage (res));
+		PQclear (res);
+		throw err;
+	}
+	stats.rows += PQntuples (res);
+	return res;
+}
+
+PgStats PgConnection::takeStats ()
+{
+	PgStats ret = stats;
+	stats = PgStats ();
+	return ret;
+}
+
+void PgConnection::deallocateOldest ()
+{
+	std::map <std::string, Prepared>::iterator oldest = statements.begin ();
+	for (std::map <std::string, Prepared>::iterator iter = statements.begin (); iter != statements.end (); iter++)
+	{
+		if (iter->second.lastUsed < oldest->second.lastUsed)
+			oldest = iter;
+	}
+	std::string cmd = "DEALLOCATE " + oldest->second.name;
+	PQclear (PQexec (conn, cmd.c_str ()));
+	stats.roundTrips++;
+	statements.erase (oldest);
+}
+
+ConnectionPool *ConnectionPool::pInstance = NULL;
+
+ConnectionPool * ConnectionPool::instance ()
+{
+	if (!pInstance)
+		pInstance = new ConnectionPool ();
+	return pInstance;
+}
+
+ConnectionPool::ConnectionPool ()
+{
+	pthread_mutex_init (&mutex, NULL);
+	pthread_cond_init (&cond, NULL);
+	open = 0;
+	size = 1;
+	pid = getpid ();
+	configured = false;
+}
+
+void ConnectionPool::setDatabase (const char *_db, const char *_user, const char *_password, int _size)
+{
+	pthread_mutex_lock (&mutex);
+
+	db = _db;
+	// ECPG target - translate to libpq
+	if (db.find ('=') == std::string::npos && db.find ("://") == std::string::npos)
+	{
+		size_t at = db.find ('@');
+		if (at != std::string::npos)
+		{
+			std::string host = db.substr (at + 1);
+			std::string dbname = db.substr (0, at);
+			size_t colon = host.find (':');
+			db = "dbname='" + dbname + "' host='" + host.substr (0, colon) + "'";
+			if (colon != std::string::npos)
+				db += " port='" + host.substr (colon + 1) + "'";
+		}
+	}
+	else if (db.compare (0, 4, "tcp:") == 0)
+	{
+		db = db.substr (4);
+	}
+	else if (db.compare (0, 5, "unix:") == 0)
+	{
+		db = db.substr (5);
+	}
+
+	user = _user ? _user : "";
+	password = _password ? _password : "";
+	size = _size > 0 ? _size : 1;
+	configured = true;
+
+	pthread_mutex_unlock (&mutex);
+
+	disconnect ();
+}
+
+PgConnection *ConnectionPool::acquire ()
+{
+	PgConnection *conn = NULL;
+
+	pthread_mutex_lock (&mutex);
+	if (!configured)
+	{
+		pthread_mutex_unlock (&mutex);
+		throw SqlError ("connection pool", "database is not configured");
+	}
+
+	// connections opened by parent process cannot be used (nor closed) by child
+	if (pid != getpid ())
+	{
+		idle.clear ();
+		open = 0;
+		pid = getpid ();
+	}
+
+	while (idle.empty () && open >= size)
+		pthread_cond_wait (&cond, &mutex);
+
+	if (!idle.empty ())
+	{
+		conn = idle.back ();
+		idle.pop_back ();
+		pthread_mutex_unlock (&mutex);
+	}
+	else
+	{
+		open++;
+		std::string _db = db;
+		std::string _user = user;
+		std::string _password = password;
+		pthread_mutex_unlock (&mutex);
+
+		conn = new PgConnection (_db.c_str (), _user.c_str (), _password.c_str ());
+	}
+
+	if (!conn->isConnected ())
+	{
+		conn->reset ();
+		if (!conn->isConnected ())
+		{
+			SqlError err ("cannot connect to database", conn->getErrorMessage ());
+			delete conn;
+			pthread_mutex_lock (&mutex);
+			open--;
+			pthread_cond_signal (&cond);
+			pthread_mutex_unlock (&mutex);
+			throw err;
+		}
+	}
+	return conn;
+}
+
+void ConnectionPool::release (PgConnection *conn)
+{
+	pthread_mutex_lock (&mutex);
+	stats += conn->takeStats ();
+	idle.push_back (conn);
+	pthread_cond_signal (&cond);
+	pthread_mutex_unlock (&mutex);
+}
+
+void ConnectionPool::disconnect ()
+{
+	pthread_mutex_lock (&mutex);
+	if (pid == getpid ())
+	{
+		for (std::vector <PgConnection *>::iterator iter = idle.begin (); iter != idle.end (); iter++)
+			delete *iter;
+		open -= idle.size ();
+	}
+	idle.clear ();
+	pthread_mutex_unlock (&mutex);
+}
+
+PgStats ConnectionPool::getStats ()
+{
+	pthread_mutex_lock (&mutex);
+	PgStats ret = stats;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+void ConnectionPool::resetStats ()
+{
+	pthread_mutex_lock (&mutex);
+	stats = PgStats ();
+	pthread_mutex_unlock (&mutex);
+}
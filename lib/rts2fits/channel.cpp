@@ -43,6 +43,8 @@ Channel::Channel (int16_t _dataType)
 	sizes = NULL;
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
 }
 
 Channel::Channel (int ch, char *_data, int _naxis, long *_sizes, int16_t _dataType, bool dealloc)
@@ -60,6 +62,8 @@ Channel::Channel (int ch, char *_data, int _naxis, long *_sizes, int16_t _dataTy
 	memcpy (sizes, _sizes, naxis * sizeof (long));
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
 }
 
 
@@ -79,6 +83,8 @@ Channel::Channel (int ch, char *_data, long dataSize, int _naxis, long *_sizes,
 	memcpy (sizes, _sizes, naxis * sizeof (long));
 
 	pixelSum = average = stdev = NAN;
+
+	histogram = NULL;
 }
 
 Channel::~Channel ()
@@ -86,6 +92,7 @@ Channel::~Channel ()
 	if (allocated)
 		delete[] data;
 	delete[] sizes;
+	delete histogram;
 }
 
 template <typename pixel_type> void computeDataStatistics (pixel_type *data, long totalPixels, long double &pixelSum, double &average, double &stdev)
@@ -159,6 +166,25 @@ void Channel::computeStatistics (size_t _from, size_t _dataSize)
 		default:
 			throw rts2core::Error ("unknow dataType");
 	}
+
+	if (_from == 0 && _dataSize == (size_t) getNPixels ())
+		getHistogram ();
+}
+
+PixelHistogram *Channel::getHistogram ()
+{
+	if (histogram == NULL)
+	{
+		histogram = new PixelHistogram (dataType);
+		histogram->add (data, getNPixels ());
+	}
+	return histogram;
+}
+
+void Channel::dataChanged ()
+{
+	delete histogram;
+	histogram = NULL;
 }
 
 Channels::Channels ()
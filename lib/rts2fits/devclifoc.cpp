@@ -207,7 +207,7 @@ void ConnFocus::processLine ()
 	return;
 }
 
-DevClientPhotFoc::DevClientPhotFoc (rts2core::Connection * in_conn, char *in_photometerFile, float in_photometerTime, int in_photometerFilterChange, std::vector < int >in_skipFilters):rts2core::DevClientPhot (in_conn)
+DevClientPhotFoc::DevClientPhotFoc (rts2core::Connection * in_conn, char *in_photometerFile, float in_photometerTime, int in_photometerFilterChange, std::vector < int >in_skipFilters, const char *in_photometerTable, int in_photometerBurst):rts2core::DevClientPhot (in_conn)
 {
 	photometerFile = in_photometerFile;
 	photometerTime = in_photometerTime;
@@ -226,11 +226,42 @@ DevClientPhotFoc::DevClientPhotFoc (rts2core::Connection * in_conn, char *in_pho
 	}
 	skipFilters = in_skipFilters;
 	newFilter = 0;
+
+	table = NULL;
+	photometerBurst = in_photometerBurst;
+	if (in_photometerTable)
+	{
+		table = new PhotTable (in_photometerTable);
+		try
+		{
+			table->open ();
+		}
+		catch (rts2core::Error &er)
+		{
+			connection->getMaster ()->logStream (MESSAGE_ERROR) << "Cannot write to " << in_photometerTable << ", exiting." << sendLog;
+			exit (1);
+		}
+	}
+
+	if (photometerBurst > 0)
+		connection->queCommand (new rts2core::CommandBurst (this, photometerTime, photometerBurst));
+	else if (table)
+		// save bursts started by other clients
+		connection->queCommand (new rts2core::Command (connection->getMaster (), "stream 1"));
 }
 
 DevClientPhotFoc::~DevClientPhotFoc (void)
 {
 	os.close ();
+	delete table;
+}
+
+void DevClientPhotFoc::addSamples (std::vector <rts2phot::PhotSample> &samples)
+{
+	connection->getMaster ()->logStream (MESSAGE_DEBUG) << "Received " << samples.size () << " samples from " << connection->getName ()
+		<< ", lost " << getLostSamples () << sendLog;
+	if (table)
+		table->append (samples);
 }
 
 void DevClientPhotFoc::addCount (int count, float exp, bool is_ov)
@@ -250,6 +281,9 @@ void DevClientPhotFoc::addCount (int count, float exp, bool is_ov)
 			<< " " << count << " " << exp << " " << is_ov << std::endl;
 		os.flush ();
 	}
+	// counts received before the burst started
+	if (photometerBurst > 0)
+		return;
 	if (photometerFilterChange > 0 && countCount >= photometerFilterChange)
 	{
 		// try to find filter in skipped one..
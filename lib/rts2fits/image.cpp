@@ -32,6 +32,7 @@
 #include "imgdisplay.h"
 
 #include <iomanip>
+#include <limits>
 #include <sstream>
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -1105,41 +1106,23 @@ void Image::getImgHeader (struct imghdr *im_h, int chan)
 
 void Image::getHistogram (long *histogram, long nbins)
 {
-	memset (histogram, 0, nbins * sizeof(int));
-	int bins;
+	memset (histogram, 0, nbins * sizeof (long));
 	if (channels.size () == 0)
 		loadChannels ();
 
-	switch (dataType)
+	long *chhist = new long[nbins];
+	for (size_t chan = 0; chan < channels.size (); chan++)
 	{
-		case RTS2_DATA_USHORT:
-			bins = 65536 / nbins;
-			for (Channels::iterator iter = channels.begin (); iter != channels.end (); iter++)
-			{
-				for (uint16_t *d = (uint16_t *)((*iter)->getData ()); d < ((uint16_t *)((*iter)->getData ())) + ((*iter)->getNPixels ()); d++)
-				{
-					histogram[*d / bins]++;
-				}
-			}
-			break;
-		case RTS2_DATA_FLOAT:
-			bins = 65536 / nbins;
-			for (Channels::iterator iter = channels.begin (); iter != channels.end (); iter++)
-			{
-				for (float *d = (float *)((*iter)->getData ()); d < ((float *)((*iter)->getData ())) + ((*iter)->getNPixels ()); d++)
-				{
-					histogram[((uint16_t)*d) / bins]++;
-				}
-			}
-			break;
-		default:
-			break;
+		getChannelHistogram (chan, chhist, nbins);
+		for (long i = 0; i < nbins; i++)
+			histogram[i] += chhist[i];
 	}
+	delete[] chhist;
 }
 
 void Image::getChannelHistogram (int chan, long *histogram, long nbins)
 {
-	memset (histogram, 0, nbins * sizeof(int));
+	memset (histogram, 0, nbins * sizeof (long));
 	int bins;
 	if (channels.size () == 0)
 		loadChannels ();
@@ -1147,10 +1130,11 @@ void Image::getChannelHistogram (int chan, long *histogram, long nbins)
 	switch (dataType)
 	{
 		case RTS2_DATA_USHORT:
-			bins = 65536 / nbins;
-			for (uint16_t *d = (uint16_t *)(channels[chan]->getData ()); d < ((uint16_t *)(channels[chan]->getData ()) + channels[chan]->getNPixels ()); d++)
 			{
-				histogram[*d / bins]++;
+				bins = 65536 / nbins;
+				PixelHistogram *hist = channels[chan]->getHistogram ();
+				for (size_t i = 0; i < hist->getBins (); i++)
+					histogram[i / bins] += hist->getBin (i);
 			}
 			break;
 		case RTS2_DATA_FLOAT:
@@ -1165,57 +1149,120 @@ void Image::getChannelHistogram (int chan, long *histogram, long nbins)
 	}
 }
 
+PixelHistogram *Image::getChannelPixelHistogram (int chan)
+{
+	if (channels.size () == 0)
+		loadChannels ();
+	return channels[chan]->getHistogram ();
+}
 
-template <typename bt, typename dt> void Image::getChannelGrayscaleByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y)
+
+// previews are computed by rows, rows are split among threads
+template <typename bt, typename dt> struct PreviewJob
 {
-	if (buf == NULL)
-		buf = new bt[s];
+	const dt *data;
+	bt *buf;
+	int chw;
+	int chh;
+	size_t offset;
+	bool invert_y;
+	dt low;
+	dt high;
+	bt black;
+	// pseudocolour palette, RGB triplets
+	const bt *palette;
+	double pscale;
+	bool pinvert;
+	// lookup table of 8 and 16 bit data, indexed by value - type minimum
+	const bt *lut;
+	const uint16_t *ilut;
+};
 
-	bt *k = buf;
+template <typename bt, typename dt> static bt *previewRow (PreviewJob <bt, dt> *job, size_t row, int channels)
+{
+	size_t r = job->invert_y ? job->chh - 1 - row : row;
+	return job->buf + channels * (job->chw + job->offset) * r;
+}
 
-	if (invert_y)
-		k += (getChannelWidth (chan) + offset) * (getChannelHeight (chan) - 1);
+// size of lookup table of 8 and 16 bit data, 0 for other types
+template <typename dt> static long previewLutSize ()
+{
+	if (std::numeric_limits <dt>::is_integer && sizeof (dt) <= 2)
+		return sizeof (dt) == 1 ? 256 : 65536;
+	return 0;
+}
 
-	const void *imageData = getChannelData (chan);
+// lookup table is used for images with more pixels than the table
+template <typename dt> static bool previewLut (long s)
+{
+	return previewLutSize <dt> () > 0 && s > previewLutSize <dt> ();
+}
 
-	int chw = getChannelWidth (chan);
-	int j = chw;
+template <typename bt, typename dt> static inline bt grayscalePixel (dt pix, dt low, dt high, bt black)
+{
+	if (high <= low)
+		return pix <= low ? black : 0;
+	pix = pix < low ? low : pix;
+	pix = pix > high ? high : pix;
+	// linear scaling
+	return black - black * ((double (pix - low)) / (high - low));
+}
 
-	for (int i = 0; (long) i < s; i++)
+template <typename bt, typename dt> static void grayscaleRows (void *arg, size_t from, size_t to)
+{
+	PreviewJob <bt, dt> *job = (PreviewJob <bt, dt> *) arg;
+	const long off = std::numeric_limits <dt>::min ();
+	const dt low = job->low;
+	const dt high = job->high;
+	const bt black = job->black;
+	for (size_t row = from; row < to; row++)
 	{
-		bt n;
-		dt pix = ((dt *)imageData)[i];
-		if (pix <= low)
-		{
-			n = black;
-		}
-		else if (pix >= high)
+		const dt *d = job->data + row * job->chw;
+		bt *k = previewRow (job, row, 1);
+		if (job->lut)
 		{
-			n = 0;
+			for (int i = 0; i < job->chw; i++)
+				k[i] = job->lut[(long) d[i] - off];
 		}
 		else
 		{
-			// linear scaling
-			n = black - black * ((double (pix - low)) / (high - low));
-		}
-		*k = n;
-		k++;
-		if (offset != 0 || invert_y)
-		{
-			j--;
-			if (j == 0)
-			{
-				if (invert_y)
-					k -= 2 * chw + offset;
-				else
-			  		k += offset;
-				j = chw;
-			}
+			for (int i = 0; i < job->chw; i++)
+				k[i] = grayscalePixel (d[i], low, high, black);
 		}
 	}
 }
 
+template <typename bt, typename dt> void Image::getChannelGrayscaleByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y)
+{
+	if (buf == NULL)
+		buf = new bt[s];
 
+	PreviewJob <bt, dt> job;
+	job.data = (const dt *) getChannelData (chan);
+	job.buf = buf;
+	job.chw = getChannelWidth (chan);
+	job.chh = s / job.chw;
+	job.offset = offset;
+	job.invert_y = invert_y;
+	job.low = low;
+	job.high = high;
+	job.black = black;
+	job.palette = NULL;
+	job.lut = NULL;
+	job.ilut = NULL;
+
+	std::vector <bt> lut;
+	if (previewLut <dt> (s))
+	{
+		const long off = std::numeric_limits <dt>::min ();
+		lut.resize (previewLutSize <dt> ());
+		for (size_t i = 0; i < lut.size (); i++)
+			lut[i] = grayscalePixel ((dt) (off + (long) i), low, high, black);
+		job.lut = &(lut[0]);
+	}
+
+	parallelRange (job.chh, 64, onlineCPUs (), grayscaleRows <bt, dt>, &job);
+}
 
 template <typename bt, typename dt> void Image::getChannelGrayscaleBuffer (int chan, bt * &buf, bt black, dt minval, dt mval, float quantiles, size_t offset, bool invert_y)
 {
@@ -1268,187 +1315,172 @@ void Image::getChannelGrayscaleImage (int _dataType, int chan, unsigned char * &
 
 
 
-template <typename bt, typename dt> void Image::getChannelPseudocolourByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y, int colourVariant)
+// palette index of a pixel
+template <typename dt> static inline int pseudocolourIndex (dt pix, dt low, dt high, double pscale, bool pinvert)
 {
-	if (buf == NULL)
-		buf = new bt[3 * s];
-
+	if (high <= low)
+		return pinvert ? pscale : 0;
+	pix = pix < low ? low : pix;
+	pix = pix > high ? high : pix;
 	double n;
-	bt nR, nG, nB;
-
-	bt *k = buf;
-
-	if (invert_y)
-		k += 3 * (getChannelWidth (chan) + offset) * (getChannelHeight (chan) - 1);
-
-	const void *imageData = getChannelData (chan);
-
-	int chw = getChannelWidth (chan);
-	int j = chw;
+	if (pinvert)
+		n = pscale * ( 1.0 - double (pix - low) / double (high - low) );
+	else
+		n = pscale * double (pix - low) / double (high - low);
+	return n;
+}
 
-	for (int i = 0; (long) i < s; i++)
+/**
+ * Fill palette of colour variant. Channels of colour variants are mixed
+ * from ramps of palette index n (0-511) - n - 256 for n > 256, n / 2, and n
+ * clipped at 255. Grey variants use 0-255 index.
+ *
+ * @return false for unknown variant
+ */
+template <typename bt> static bool pseudocolourPalette (int colourVariant, std::vector <bt> &palette, double &pscale, bool &pinvert)
+{
+	// ramps for R, G and B channels; 0 - n - 256, 1 - n / 2, 2 - n up to 255, 3 - grey
+	int ramps[3];
+	pscale = 511.0;
+	pinvert = colourVariant % 2;
+	switch (colourVariant)
+	{
+		case PSEUDOCOLOUR_VARIANT_GREY:
+		case PSEUDOCOLOUR_VARIANT_GREY_INV:
+			pscale = 255.0;
+			ramps[0] = ramps[1] = ramps[2] = 3;
+			break;
+		case PSEUDOCOLOUR_VARIANT_BLUE:
+		case PSEUDOCOLOUR_VARIANT_BLUE_INV:
+			ramps[0] = 0; ramps[1] = 1; ramps[2] = 2;
+			break;
+		case PSEUDOCOLOUR_VARIANT_RED:
+		case PSEUDOCOLOUR_VARIANT_RED_INV:
+			ramps[0] = 2; ramps[1] = 1; ramps[2] = 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_GREEN:
+		case PSEUDOCOLOUR_VARIANT_GREEN_INV:
+			ramps[0] = 1; ramps[1] = 2; ramps[2] = 0;
+			break;
+		case PSEUDOCOLOUR_VARIANT_VIOLET:
+		case PSEUDOCOLOUR_VARIANT_VIOLET_INV:
+			ramps[0] = 1; ramps[1] = 0; ramps[2] = 2;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MAGENTA:
+		case PSEUDOCOLOUR_VARIANT_MAGENTA_INV:
+			ramps[0] = 2; ramps[1] = 0; ramps[2] = 1;
+			break;
+		case PSEUDOCOLOUR_VARIANT_MALACHIT:
+		case PSEUDOCOLOUR_VARIANT_MALACHIT_INV:
+			ramps[0] = 0; ramps[1] = 2; ramps[2] = 1;
+			break;
+		default:
+			return false;
+	}
+	int size = pscale + 1;
+	palette.resize (3 * size);
+	for (int n = 0; n < size; n++)
 	{
-		dt pix = ((dt *)imageData)[i];
-
-		if ( pix < low )
-			pix = low;
-		if ( pix > high )
-			pix = high;
-
-		switch (colourVariant)
-		{
-			case PSEUDOCOLOUR_VARIANT_GREY:
-				n = 255.0 * double (pix - low) / double (high - low);
-				nR = n;
-				nG = nR;
-				nB = nR;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREY_INV:
-				n = 255.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n;
-				nG = nR;
-				nB = nR;
-				break;
-			case PSEUDOCOLOUR_VARIANT_BLUE:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = n / 2.0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_BLUE_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = n / 2.0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_RED:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = (n < 256.0) ? n : 255;
-				nG = n / 2.0;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_RED_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = (n < 256.0) ? n : 255;
-				nG = n / 2.0;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREEN:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = n / 2.0;
-				nG = (n < 256.0) ? n : 255;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_GREEN_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n / 2.0;
-				nG = (n < 256.0) ? n : 255;
-				nB = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_VIOLET:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = n / 2.0;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_VIOLET_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = n / 2.0;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = (n < 256.0) ? n : 255;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MAGENTA:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = (n < 256.0) ? n : 255;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MAGENTA_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = (n < 256.0) ? n : 255;
-				nG = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MALACHIT:
-				n = 511.0 * double (pix - low) / double (high - low);
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = (n < 256.0) ? n : 255;
-				nB = n / 2.0;
-				break;
-			case PSEUDOCOLOUR_VARIANT_MALACHIT_INV:
-				n = 511.0 * ( 1.0 - double (pix - low) / double (high - low) );
-				nR = ((n - 256.0) > 0.0) ? n - 256.0 : 0;
-				nG = (n < 256.0) ? n : 255;
-				nB = n / 2.0;
-				break;
-			default:
-				logStream (MESSAGE_ERROR) << "Unknown colourVariant" << colourVariant << sendLog;
-		}
-
-		*k = nR;
-		k++;
-		*k = nG;
-		k++;
-		*k = nB;
-		k++;
-		if (offset != 0 || invert_y)
+		for (int c = 0; c < 3; c++)
 		{
-			j--;
-			if (j == 0)
+			switch (ramps[c])
 			{
-				if (invert_y)
-					k -= 3 * (2 * chw + offset);
-				else
-			  		k += 3 * offset;
-				j = chw;
+				case 0:
+					palette[3 * n + c] = n > 256 ? n - 256 : 0;
+					break;
+				case 1:
+					palette[3 * n + c] = n / 2;
+					break;
+				case 2:
+					palette[3 * n + c] = n < 256 ? n : 255;
+					break;
+				default:
+					palette[3 * n + c] = n;
 			}
 		}
 	}
+	return true;
 }
 
-template <typename dt> void Image::getChannelQuantiles (int chan, dt minval, dt mval, float quantiles, dt * low_ptr, dt * high_ptr)
+template <typename bt, typename dt> static void pseudocolourRows (void *arg, size_t from, size_t to)
 {
-	long hist[65536];
-	getChannelHistogram (chan, hist, 65536);
-
-	long psum = 0;
-	dt low = minval;
-	dt high = minval;
+	PreviewJob <bt, dt> *job = (PreviewJob <bt, dt> *) arg;
+	const long off = std::numeric_limits <dt>::min ();
+	const bt *palette = job->palette;
+	for (size_t row = from; row < to; row++)
+	{
+		const dt *d = job->data + row * job->chw;
+		bt *k = previewRow (job, row, 3);
+		for (int i = 0; i < job->chw; i++)
+		{
+			int n;
+			if (job->ilut)
+				n = job->ilut[(long) d[i] - off];
+			else
+				n = pseudocolourIndex (d[i], job->low, job->high, job->pscale, job->pinvert);
+			const bt *c = palette + 3 * n;
+			k[3 * i] = c[0];
+			k[3 * i + 1] = c[1];
+			k[3 * i + 2] = c[2];
+		}
+	}
+}
 
-	uint32_t i;
+template <typename bt, typename dt> void Image::getChannelPseudocolourByteBuffer (int chan, bt * &buf, bt black, dt low, dt high, long s, size_t offset, bool invert_y, int colourVariant)
+{
+	if (buf == NULL)
+		buf = new bt[3 * s];
 
-	long s = getChannelNPixels (chan);
+	PreviewJob <bt, dt> job;
 
-	// find quantiles
-	for (i = 0; (dt) i < mval; i++)
+	std::vector <bt> palette;
+	if (pseudocolourPalette (colourVariant, palette, job.pscale, job.pinvert) == false)
 	{
-		psum += hist[i];
-		if (psum > s * quantiles)
-		{
-			low = i;
-			break;
-		}
+		logStream (MESSAGE_ERROR) << "Unknown colourVariant" << colourVariant << sendLog;
+		pseudocolourPalette (PSEUDOCOLOUR_VARIANT_GREY, palette, job.pscale, job.pinvert);
 	}
 
-	if (low == minval)
+	job.data = (const dt *) getChannelData (chan);
+	job.buf = buf;
+	job.chw = getChannelWidth (chan);
+	job.chh = s / job.chw;
+	job.offset = offset;
+	job.invert_y = invert_y;
+	job.low = low;
+	job.high = high;
+	job.black = black;
+	job.palette = &(palette[0]);
+	job.lut = NULL;
+	job.ilut = NULL;
+
+	std::vector <uint16_t> ilut;
+	if (previewLut <dt> (s))
 	{
-		low = minval;
-		high = mval;
+		const long off = std::numeric_limits <dt>::min ();
+		ilut.resize (previewLutSize <dt> ());
+		for (size_t i = 0; i < ilut.size (); i++)
+			ilut[i] = pseudocolourIndex ((dt) (off + (long) i), low, high, job.pscale, job.pinvert);
+		job.ilut = &(ilut[0]);
 	}
-	else
+
+	parallelRange (job.chh, 64, onlineCPUs (), pseudocolourRows <bt, dt>, &job);
+}
+
+template <typename dt> void Image::getChannelQuantiles (int chan, dt minval, dt mval, float quantiles, dt * low_ptr, dt * high_ptr)
+{
+	PixelHistogram *hist = getChannelPixelHistogram (chan);
+
+	dt low = minval;
+	dt high = mval;
+
+	if (hist->getCount () > 0)
 	{
-		for (; (dt) i < mval; i++)
+		double l = hist->quantile (quantiles);
+		double h = hist->quantile (1 - quantiles);
+		if (l < h)
 		{
-			psum += hist[i];
-			if (psum > s * (1 - quantiles))
-			{
-				high = i;
-				break;
-			}
-		}
-		if (high == minval)
-		{
-			high = mval;
+			low = l <= minval ? minval : (l >= mval ? mval : (dt) l);
+			high = h <= minval ? minval : (h >= mval ? mval : (dt) h);
 		}
 	}
 
@@ -2038,78 +2070,26 @@ const void* Image::getChannelData (int chan)
 	return channels[chan]->getData ();
 }
 
-template <typename bt, typename dt> const bt * scaleData (dt * data, size_t numpix, dt smin, dt smax, scaling_type scaling, bt white)
-{
-	dt * end = data + numpix;
-	dt * p = data;
-	// overwrite data..
-	bt *nd = (bt *) data;
-
-	double l = smax - smin;
-
-// scaling macro to keep switch outside from main loop
-#define doscaling(scaling_func)                 \
-	for (; p < end; p++, nd++)              \
-	{                                       \
-		if (*p < smin)                  \
-		{                               \
-			*nd = 0;                \
-			continue;               \
-		}                               \
-		if (*p > smax)                  \
-		{                               \
-			*nd = white;            \
-			continue;               \
-		}                               \
-		double d = *p;                  \
-		d = white * (d - smin) / l;     \
-		scaling_func;                   \
-		*nd = (bt) d;                   \
-	}
-
-	switch (scaling)
-	{
-		case SCALING_LINEAR:
-			doscaling(;)
-			break;
-		case SCALING_LOG:
-			doscaling(d=log(d))
-			break;
-		case SCALING_POW:
-			doscaling(d*=d)
-			break;
-		case SCALING_SQRT:
-			doscaling(d=sqrt (d))
-			break;
-	}
-
-#undef doscaling
-
-	return (bt *) data;
-}
-
 const void * rts2image::getScaledData (int dataType, const void *data, size_t numpix, long smin, long smax, scaling_type scaling, int newType)
 {
-	switch (dataType)
-	{
-		case RTS2_DATA_USHORT:
-			return scaleData ((uint16_t *) data, numpix, (uint16_t) smin, (uint16_t) smax, scaling, (uint8_t) 0xff);
-		case RTS2_DATA_ULONG:
-			switch (newType)
-			{
-				case RTS2_DATA_BYTE:
-					return scaleData ((uint32_t *) data, numpix, (uint32_t) smin, (uint32_t) smax, scaling, (uint8_t) 0xff);
-				case RTS2_DATA_USHORT:
-					return scaleData ((uint32_t *) data, numpix, (uint32_t) smin, (uint32_t) smax, scaling, (uint16_t) 0xffff);
-			}
-			return scaleData ((uint32_t *) data, numpix, (uint32_t) smin, (uint32_t) smax, scaling, (uint8_t) 0xff);
-	}
+	if (newType != RTS2_DATA_USHORT)
+		newType = RTS2_DATA_BYTE;
+	// output must fit into input buffer
+	if (pixelByteSize (newType) > pixelByteSize (dataType))
+		return data;
+	PixelScaler scaler (smin, smax, scaling, newType);
+	scaler.scale (dataType, data, (void *) data, numpix);
 	return data;
 }
 
 const void * Image::getChannelDataScaled (int chan, long smin, long smax, scaling_type scaling, int newType)
 {
-	return getScaledData (dataType, getChannelData (chan), getChannelNPixels (chan), smin, smax, scaling, newType);
+	const void *data = getChannelData (chan);
+	if (data == NULL)
+		return NULL;
+	// data are scaled in place
+	channels[chan]->dataChanged ();
+	return getScaledData (dataType, data, getChannelNPixels (chan), smin, smax, scaling, newType);
 }
 
 int Image::setAstroResults (double in_ra, double in_dec, double in_ra_err, double in_dec_err)
@@ -0,0 +1,951 @@
+/*
+ * Write-behind queue of image database records.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/imagequeue.h"
+#include "app.h"
+#include "nan.h"
+#include "utilsfunc.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <math.h>
+#include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+// default number of records written by single statement
+#define BATCH_SIZE      1000
+
+// seconds between attempts to write to unavailable database
+#define RETRY_INTERVAL  5
+
+// number of columns written for full record
+#define COLUMNS         22
+
+using namespace rts2image;
+
+static double timeNow ()
+{
+	struct timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// escape characters used as separators in journal
+static std::string escape (const std::string &s)
+{
+	std::string ret;
+	for (std::string::const_iterator iter = s.begin (); iter != s.end (); iter++)
+	{
+		switch (*iter)
+		{
+			case '\\':
+				ret += "\\\\";
+				break;
+			case '\t':
+				ret += "\\t";
+				break;
+			case '\n':
+				ret += "\\n";
+				break;
+			default:
+				ret += *iter;
+		}
+	}
+	return ret;
+}
+
+static std::string unescape (const std::string &s)
+{
+	std::string ret;
+	for (std::string::const_iterator iter = s.begin (); iter != s.end (); iter++)
+	{
+		if (*iter == '\\' && iter + 1 != s.end ())
+		{
+			iter++;
+			switch (*iter)
+			{
+				case 't':
+					ret += '\t';
+					break;
+				case 'n':
+					ret += '\n';
+					break;
+				default:
+					ret += *iter;
+			}
+		}
+		else
+		{
+			ret += *iter;
+		}
+	}
+	return ret;
+}
+
+static std::string dbDouble (double v)
+{
+	std::ostringstream os;
+	os.precision (17);
+	os << v;
+	return os.str ();
+}
+
+ImageRecord::ImageRecord ()
+{
+	obs_id = -1;
+	img_id = -1;
+	replayed = false;
+	full = true;
+	obs_subtype = 'S';
+	img_temperature = NAN;
+	img_exposure = NAN;
+	filter_id = -1;
+	img_alt = NAN;
+	img_az = NAN;
+	img_date = 0;
+	img_usec = 0;
+	med_id = 0;
+	process_bitfield = 0;
+	img_fwhm = NAN;
+	img_limmag = NAN;
+	img_qmagmax = NAN;
+	img_err_ra = NAN;
+	img_err_dec = NAN;
+	img_err = NAN;
+}
+
+std::string ImageRecord::toString () const
+{
+	std::ostringstream os;
+	os.precision (17);
+	os << (full ? 'F' : 'P') << '\t' << obs_id << '\t' << img_id << '\t' << escape (img_path);
+	if (full)
+		os << '\t' << obs_subtype
+			<< '\t' << escape (mount_name)
+			<< '\t' << escape (camera_name)
+			<< '\t' << img_temperature
+			<< '\t' << img_exposure
+			<< '\t' << filter_id
+			<< '\t' << img_alt
+			<< '\t' << img_az
+			<< '\t' << img_date
+			<< '\t' << img_usec
+			<< '\t' << med_id
+			<< '\t' << process_bitfield
+			<< '\t' << img_fwhm
+			<< '\t' << img_limmag
+			<< '\t' << img_qmagmax
+			<< '\t' << escape (astrometry)
+			<< '\t' << img_err_ra
+			<< '\t' << img_err_dec
+			<< '\t' << img_err;
+	return os.str ();
+}
+
+bool ImageRecord::parse (const std::string &line)
+{
+	std::vector <std::string> f;
+	size_t start = 0;
+	while (true)
+	{
+		size_t tab = line.find ('\t', start);
+		f.push_back (unescape (line.substr (start, tab == std::string::npos ? std::string::npos : tab - start)));
+		if (tab == std::string::npos)
+			break;
+		start = tab + 1;
+	}
+
+	if (f.size () == 4 && f[0] == "P")
+		full = false;
+	else if (f.size () == COLUMNS + 1 && f[0] == "F")
+		full = true;
+	else
+		return false;
+
+	obs_id = atoi (f[1].c_str ());
+	img_id = atoi (f[2].c_str ());
+	img_path = f[3];
+	if (!full)
+		return true;
+
+	obs_subtype = f[4].empty () ? 'S' : f[4][0];
+	mount_name = f[5];
+	camera_name = f[6];
+	img_temperature = strtod (f[7].c_str (), NULL);
+	img_exposure = strtod (f[8].c_str (), NULL);
+	filter_id = atoi (f[9].c_str ());
+	img_alt = strtod (f[10].c_str (), NULL);
+	img_az = strtod (f[11].c_str (), NULL);
+	img_date = strtod (f[12].c_str (), NULL);
+	img_usec = atoi (f[13].c_str ());
+	med_id = atoi (f[14].c_str ());
+	process_bitfield = atoi (f[15].c_str ());
+	img_fwhm = strtod (f[16].c_str (), NULL);
+	img_limmag = strtod (f[17].c_str (), NULL);
+	img_qmagmax = strtod (f[18].c_str (), NULL);
+	astrometry = f[19];
+	img_err_ra = strtod (f[20].c_str (), NULL);
+	img_err_dec = strtod (f[21].c_str (), NULL);
+	img_err = strtod (f[22].c_str (), NULL);
+	return true;
+}
+
+ImageQueue *ImageQueue::pInstance = NULL;
+
+ImageQueue * ImageQueue::instance ()
+{
+	if (!pInstance)
+		pInstance = new ImageQueue ();
+	return pInstance;
+}
+
+ImageQueue::ImageQueue ()
+{
+	pthread_mutex_init (&mutex, NULL);
+	pthread_cond_init (&addCond, NULL);
+	pthread_cond_init (&writtenCond, NULL);
+	pthread_mutex_init (&errorMutex, NULL);
+
+	running = false;
+	stopRequest = false;
+	pid = getpid ();
+
+	conn = NULL;
+
+	maxDelay = 1;
+	batchSize = BATCH_SIZE;
+
+	journalFd = -1;
+	segment = 0;
+	firstSegment = 0;
+	segmentUsed = false;
+
+	queueStart = 0;
+
+	added = 0;
+	done = 0;
+	failures = 0;
+	flushRequest = false;
+
+	written = 0;
+	transactions = 0;
+	statements = 0;
+}
+
+ImageQueue::~ImageQueue ()
+{
+	stop ();
+	pthread_mutex_destroy (&errorMutex);
+	pthread_cond_destroy (&writtenCond);
+	pthread_cond_destroy (&addCond);
+	pthread_mutex_destroy (&mutex);
+}
+
+int ImageQueue::start (const char *_conninfo, const char *_user, const char *_password, const char *_journal, double _maxDelay)
+{
+	if (isRunning ())
+		stop ();
+
+	conninfo = _conninfo;
+	user = _user ? _user : "";
+	password = _password ? _password : "";
+	journal = _journal;
+	maxDelay = _maxDelay;
+	stopRequest = false;
+	pid = getpid ();
+
+	queue.clear ();
+	added = done = 0;
+	flushRequest = false;
+
+	// find segments left in journal directory
+	std::string dir = ".";
+	std::string prefix = journal + ".";
+	size_t slash = journal.rfind ('/');
+	if (slash != std::string::npos)
+	{
+		dir = journal.substr (0, slash + 1);
+		prefix = journal.substr (slash + 1) + ".";
+	}
+
+	if (mkpath (journal.c_str (), 0755))
+	{
+		logStream (MESSAGE_ERROR) << "cannot create image journal directory " << dir << ": " << strerror (errno) << sendLog;
+		return -1;
+	}
+
+	std::vector <unsigned long> segments;
+	DIR *d = opendir (dir.c_str ());
+	if (d == NULL)
+	{
+		logStream (MESSAGE_ERROR) << "cannot open image journal directory " << dir << ": " << strerror (errno) << sendLog;
+		return -1;
+	}
+	struct dirent *de;
+	while ((de = readdir (d)) != NULL)
+	{
+		if (strncmp (de->d_name, prefix.c_str (), prefix.length ()) != 0)
+			continue;
+		char *endp;
+		unsigned long seg = strtoul (de->d_name + prefix.length (), &endp, 10);
+		if (*endp == '\0' && endp != de->d_name + prefix.length ())
+			segments.push_back (seg);
+	}
+	closedir (d);
+
+	std::sort (segments.begin (), segments.end ());
+
+	segment = firstSegment = segments.empty () ? 0 : segments.front ();
+
+	// replay records, which were not committed before the process ended
+	for (std::vector <unsigned long>::iterator iter = segments.begin (); iter != segments.end (); iter++)
+	{
+		std::ifstream is (segmentName (*iter).c_str ());
+		std::string line;
+		while (std::getline (is, line))
+		{
+			ImageRecord rec;
+			// last line can be incomplete
+			if (rec.parse (line))
+			{
+				rec.replayed = true;
+				queue.push_back (rec);
+				added++;
+			}
+		}
+		segment = *iter + 1;
+	}
+
+	if (!queue.empty ())
+	{
+		logStream (MESSAGE_INFO) << "replaying " << queue.size () << " image records from journal " << journal << sendLog;
+		// write them at once
+		queueStart = timeNow () - maxDelay;
+	}
+
+	if (openSegment ())
+		return -1;
+
+	running = true;
+	if (pthread_create (&writer, NULL, ImageQueue::writerThread, this))
+	{
+		logStream (MESSAGE_ERROR) << "cannot start image queue writer thread" << sendLog;
+		running = false;
+		return -1;
+	}
+	return 0;
+}
+
+void ImageQueue::stop ()
+{
+	if (!isRunning ())
+		return;
+
+	pthread_mutex_lock (&mutex);
+	stopRequest = true;
+	pthread_cond_signal (&addCond);
+	pthread_mutex_unlock (&mutex);
+
+	pthread_join (writer, NULL);
+	running = false;
+
+	logErrors ();
+
+	close (journalFd);
+	journalFd = -1;
+
+	// all records were written - journal is not needed
+	if (queue.empty ())
+	{
+		for (unsigned long seg = firstSegment; seg <= segment; seg++)
+			unlink (segmentName (seg).c_str ());
+	}
+	else
+	{
+		logStream (MESSAGE_WARNING) << queue.size () << " image records were not written to database, they are kept in journal " << journal << sendLog;
+	}
+
+	if (conn)
+	{
+		PQfinish (conn);
+		conn = NULL;
+	}
+}
+
+int ImageQueue::add (const ImageRecord &rec)
+{
+	int ret = 0;
+	int err = 0;
+	std::string line = rec.toString () + "\n";
+
+	pthread_mutex_lock (&mutex);
+	// journal survives crash of the process, records are in system buffers
+	if (write (journalFd, line.c_str (), line.length ()) != (ssize_t) line.length ())
+	{
+		ret = -1;
+		err = errno;
+	}
+	if (queue.empty ())
+		queueStart = timeNow ();
+	queue.push_back (rec);
+	segmentUsed = true;
+	added++;
+	if (queue.size () >= batchSize)
+		pthread_cond_signal (&addCond);
+	pthread_mutex_unlock (&mutex);
+
+	if (ret)
+		logStream (MESSAGE_ERROR) << "cannot write image record to journal " << journal << ": " << strerror (err) << sendLog;
+
+	logErrors ();
+	return ret;
+}
+
+int ImageQueue::flush (double timeout)
+{
+	if (!isRunning ())
+		return 0;
+
+	struct timespec ts;
+	if (timeout >= 0)
+	{
+		double end = timeNow () + timeout;
+		ts.tv_sec = (time_t) end;
+		ts.tv_nsec = (long) ((end - ts.tv_sec) * 1e9);
+	}
+
+	pthread_mutex_lock (&mutex);
+	unsigned long target = added;
+	unsigned long f = failures;
+	flushRequest = true;
+	pthread_cond_signal (&addCond);
+	int ret = 0;
+	while (done < target && failures == f)
+	{
+		if (timeout < 0)
+		{
+			pthread_cond_wait (&writtenCond, &mutex);
+		}
+		else if (pthread_cond_timedwait (&writtenCond, &mutex, &ts) == ETIMEDOUT)
+		{
+			ret = -2;
+			break;
+		}
+	}
+	if (ret == 0 && done < target)
+		ret = -1;
+	pthread_mutex_unlock (&mutex);
+
+	logErrors ();
+	return ret;
+}
+
+size_t ImageQueue::queued ()
+{
+	pthread_mutex_lock (&mutex);
+	size_t ret = added - done;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+void *ImageQueue::writerThread (void *arg)
+{
+	((ImageQueue *) arg)->writerLoop ();
+	return NULL;
+}
+
+void ImageQueue::writerLoop ()
+{
+	pthread_mutex_lock (&mutex);
+	while (true)
+	{
+		if (queue.empty ())
+		{
+			if (stopRequest)
+				break;
+			pthread_cond_wait (&addCond, &mutex);
+			continue;
+		}
+
+		double writeAt = queueStart + maxDelay;
+		if (!(stopRequest || flushRequest || queue.size () >= batchSize || timeNow () >= writeAt))
+		{
+			struct timespec ts;
+			ts.tv_sec = (time_t) writeAt;
+			ts.tv_nsec = (long) ((writeAt - ts.tv_sec) * 1e9);
+			pthread_cond_timedwait (&addCond, &mutex, &ts);
+			continue;
+		}
+
+		flushRequest = false;
+
+		// take records, start new journal segment for records added while they are written
+		std::vector <ImageRecord> records;
+		records.swap (queue);
+		unsigned long takenUntil = added;
+		if (segmentUsed)
+		{
+			if (journalFd >= 0)
+			{
+				fdatasync (journalFd);
+				close (journalFd);
+			}
+			segment++;
+			openSegment ();
+		}
+		unsigned long lastSegment = segment - 1;
+
+		pthread_mutex_unlock (&mutex);
+
+		int ret = writeRecords (records);
+
+		pthread_mutex_lock (&mutex);
+		if (ret >= 0)
+		{
+			// segments with dropped records are kept, they are replayed on next start
+			if (ret == 0)
+			{
+				for (unsigned long seg = firstSegment; seg <= lastSegment; seg++)
+					unlink (segmentName (seg).c_str ());
+			}
+			else
+			{
+				std::ostringstream os;
+				os << "journal segments " << segmentName (firstSegment) << " to " << segmentName (lastSegment) << " with dropped image records are kept";
+				addError (os.str ());
+			}
+			firstSegment = lastSegment + 1;
+			done = takenUntil;
+			pthread_cond_broadcast (&writtenCond);
+		}
+		else
+		{
+			// keep records for next try, their journal segments stay on disk
+			records.insert (records.end (), queue.begin (), queue.end ());
+			records.swap (queue);
+			queueStart = timeNow () - maxDelay + RETRY_INTERVAL;
+			failures++;
+			pthread_cond_broadcast (&writtenCond);
+			if (stopRequest)
+				break;
+		}
+	}
+	pthread_mutex_unlock (&mutex);
+}
+
+std::string ImageQueue::segmentName (unsigned long seg)
+{
+	std::ostringstream os;
+	os << journal << "." << seg;
+	return os.str ();
+}
+
+int ImageQueue::openSegment ()
+{
+	std::string name = segmentName (segment);
+	journalFd = open (name.c_str (), O_WRONLY | O_CREAT | O_APPEND, 0644);
+	segmentUsed = false;
+	if (journalFd < 0)
+	{
+		addError ("cannot open image journal " + name + ": " + strerror (errno));
+		return -1;
+	}
+	return 0;
+}
+
+void ImageQueue::addError (const std::string &err)
+{
+	pthread_mutex_lock (&errorMutex);
+	errors.push_back (err);
+	pthread_mutex_unlock (&errorMutex);
+}
+
+void ImageQueue::logErrors ()
+{
+	pthread_mutex_lock (&errorMutex);
+	std::vector <std::string> e;
+	e.swap (errors);
+	pthread_mutex_unlock (&errorMutex);
+	for (std::vector <std::string>::iterator iter = e.begin (); iter != e.end (); iter++)
+	{
+		// libpq messages end with new line
+		size_t end = iter->find_last_not_of ("\n");
+		logStream (MESSAGE_ERROR) << iter->substr (0, end == std::string::npos ? 0 : end + 1) << sendLog;
+	}
+}
+
+bool ImageQueue::connect ()
+{
+	if (conn && PQstatus (conn) == CONNECTION_OK)
+		return true;
+
+	if (conn)
+	{
+		PQreset (conn);
+	}
+	else
+	{
+		const char *keywords[4];
+		const char *values[4];
+		int i = 0;
+
+		keywords[i] = "dbname";
+		values[i++] = conninfo.c_str ();
+		if (!user.empty ())
+		{
+			keywords[i] = "user";
+			values[i++] = user.c_str ();
+		}
+		if (!password.empty ())
+		{
+			keywords[i] = "password";
+			values[i++] = password.c_str ();
+		}
+		keywords[i] = NULL;
+		values[i] = NULL;
+
+		conn = PQconnectdbParams (keywords, values, 1);
+	}
+
+	if (PQstatus (conn) != CONNECTION_OK)
+	{
+		addError (std::string ("cannot connect to database to write images: ") + PQerrorMessage (conn));
+		return false;
+	}
+	return true;
+}
+
+bool ImageQueue::execute (const char *sql, std::vector <std::string> &params)
+{
+	std::vector <const char *> values;
+	for (std::vector <std::string>::iterator iter = params.begin (); iter != params.end (); iter++)
+		values.push_back (iter->c_str ());
+
+	PGresult *res = PQexecParams (conn, sql, values.size (), NULL, values.empty () ? NULL : &(values[0]), NULL, NULL, 0);
+	statements++;
+	bool ret = PQresultStatus (res) == PGRES_COMMAND_OK || PQresultStatus (res) == PGRES_TUPLES_OK;
+	if (!ret)
+		addError (std::string ("cannot write images to database: ") + PQresultErrorMessage (res));
+	PQclear (res);
+	return ret;
+}
+
+// NULL for NAN
+static void addDouble (std::vector <std::string> &params, std::vector <bool> &nulls, double v)
+{
+	nulls.push_back (std::isnan (v));
+	params.push_back (std::isnan (v) ? "" : dbDouble (v));
+}
+
+static void addInt (std::vector <std::string> &params, std::vector <bool> &nulls, int v)
+{
+	std::ostringstream os;
+	os << v;
+	nulls.push_back (false);
+	params.push_back (os.str ());
+}
+
+static void addString (std::vector <std::string> &params, std::vector <bool> &nulls, const std::string &v, bool nullEmpty = false)
+{
+	nulls.push_back (nullEmpty && v.empty ());
+	params.push_back (v);
+}
+
+/**
+ * Build multi-row statement. Placeholders of NULL values are replaced by
+ * NULL, so they are not send as parameters.
+ */
+static std::string buildStatement (const char *head, const char *tail, const char **types, int columns, std::vector <std::string> &params, std::vector <bool> &nulls, std::vector <std::string> &values)
+{
+	std::ostringstream os;
+	os << head;
+	int p = 0;
+	for (size_t i = 0; i < params.size (); i++)
+	{
+		int col = i % columns;
+		if (col == 0)
+			os << (i == 0 ? "(" : "), (");
+		else
+			os << ", ";
+		if (nulls[i])
+		{
+			os << "NULL";
+		}
+		else
+		{
+			values.push_back (params[i]);
+			os << "$" << ++p;
+		}
+		if (types[col])
+			os << "::" << types[col];
+	}
+	os << ")" << tail;
+	return os.str ();
+}
+
+// column types of full record; VALUES columns are not typed by target columns, there is no cast from text to wcs2
+static const char *fullTypes[COLUMNS] = {"integer", "integer", "text", "char", "text", "text", "real", "real", "integer", "real", "real", "double precision", "integer", "integer", "integer", "real", "real", "real", "wcs2", "double precision", "double precision", "double precision"};
+
+static const char *insertHead =
+	"INSERT INTO images (obs_id, img_id, img_path, obs_subtype, mount_name, camera_name, img_temperature, img_exposure, filter_id, img_alt, img_az, "
+	"img_date, img_usec, med_id, process_bitfield, img_fwhm, img_limmag, img_qmagmax, astrometry, img_err_ra, img_err_dec, img_err) "
+	"SELECT v.obs_id, v.img_id, v.img_path, v.obs_subtype, v.mount_name, v.camera_name, v.img_temperature, v.img_exposure, v.filter_id, v.img_alt, v.img_az, "
+	"to_timestamp (v.img_date), v.img_usec, v.med_id, v.process_bitfield, v.img_fwhm, v.img_limmag, v.img_qmagmax, v.astrometry, v.img_err_ra, v.img_err_dec, v.img_err "
+	"FROM (VALUES ";
+
+// images already in database are updated as by ImageSkyDb::updateDB, astrometry is updated only if it is known
+static const char *insertTail =
+	") AS v (obs_id, img_id, img_path, obs_subtype, mount_name, camera_name, img_temperature, img_exposure, filter_id, img_alt, img_az, "
+	"img_date, img_usec, med_id, process_bitfield, img_fwhm, img_limmag, img_qmagmax, astrometry, img_err_ra, img_err_dec, img_err) "
+	"ON CONFLICT (obs_id, img_id) DO UPDATE SET "
+	"img_path = EXCLUDED.img_path, img_date = EXCLUDED.img_date, img_usec = EXCLUDED.img_usec, med_id = EXCLUDED.med_id, "
+	"process_bitfield = EXCLUDED.process_bitfield, img_fwhm = EXCLUDED.img_fwhm, img_limmag = EXCLUDED.img_limmag, "
+	"img_qmagmax = EXCLUDED.img_qmagmax, filter_id = EXCLUDED.filter_id, "
+	"astrometry = COALESCE (EXCLUDED.astrometry, images.astrometry), img_err_ra = COALESCE (EXCLUDED.img_err_ra, images.img_err_ra), "
+	"img_err_dec = COALESCE (EXCLUDED.img_err_dec, images.img_err_dec), img_err = COALESCE (EXCLUDED.img_err, images.img_err)";
+
+// records replayed from journal might be older than rows in database
+static const char *replayTail =
+	") AS v (obs_id, img_id, img_path, obs_subtype, mount_name, camera_name, img_temperature, img_exposure, filter_id, img_alt, img_az, "
+	"img_date, img_usec, med_id, process_bitfield, img_fwhm, img_limmag, img_qmagmax, astrometry, img_err_ra, img_err_dec, img_err) "
+	"ON CONFLICT (obs_id, img_id) DO NOTHING";
+
+static const char *pathTypes[3] = {"integer", "integer", "text"};
+
+static const char *pathHead = "UPDATE images SET img_path = v.img_path FROM (VALUES ";
+
+static const char *pathTail = ") AS v (obs_id, img_id, img_path) WHERE images.obs_id = v.obs_id AND images.img_id = v.img_id";
+
+int ImageQueue::writeRecords (std::vector <ImageRecord> &records)
+{
+	// merge records of the same image, keep order of the first record
+	std::vector <ImageRecord> full;
+	std::vector <ImageRecord> paths;
+	std::map <std::pair <int, int>, size_t> fullIndex;
+	std::map <std::pair <int, int>, size_t> pathIndex;
+
+	for (std::vector <ImageRecord>::iterator iter = records.begin (); iter != records.end (); iter++)
+	{
+		std::pair <int, int> key (iter->obs_id, iter->img_id);
+		std::map <std::pair <int, int>, size_t>::iterator fi = fullIndex.find (key);
+		if (iter->full)
+		{
+			if (fi == fullIndex.end ())
+			{
+				fullIndex[key] = full.size ();
+				full.push_back (*iter);
+			}
+			else
+			{
+				ImageRecord &old = full[fi->second];
+				// later record without astrometry does not clear it
+				if (iter->astrometry.empty () && !old.astrometry.empty ())
+				{
+					std::string astrometry = old.astrometry;
+					double err_ra = old.img_err_ra;
+					double err_dec = old.img_err_dec;
+					double err = old.img_err;
+					old = *iter;
+					old.astrometry = astrometry;
+					old.img_err_ra = err_ra;
+					old.img_err_dec = err_dec;
+					old.img_err = err;
+				}
+				else
+				{
+					old = *iter;
+				}
+			}
+			std::map <std::pair <int, int>, size_t>::iterator pi = pathIndex.find (key);
+			// full record holds current path
+			if (!iter->replayed)
+				pathIndex.erase (key);
+			else if (pi != pathIndex.end ())
+				paths[pi->second].img_path = iter->img_path;
+		}
+		// replayed record is not written to existing row, path must be updated separately
+		else if (fi != fullIndex.end () && !full[fi->second].replayed)
+		{
+			full[fi->second].img_path = iter->img_path;
+		}
+		else
+		{
+			std::map <std::pair <int, int>, size_t>::iterator pi = pathIndex.find (key);
+			if (pi == pathIndex.end ())
+			{
+				pathIndex[key] = paths.size ();
+				paths.push_back (*iter);
+			}
+			else
+			{
+				paths[pi->second].img_path = iter->img_path;
+			}
+		}
+	}
+
+	// remove paths superseded by full records
+	std::vector <ImageRecord> p;
+	for (std::map <std::pair <int, int>, size_t>::iterator iter = pathIndex.begin (); iter != pathIndex.end (); iter++)
+		p.push_back (paths[iter->second]);
+	paths.swap (p);
+
+	if (!connect ())
+		return -1;
+
+	if (writeBatch (full, paths))
+		return 0;
+
+	if (PQstatus (conn) != CONNECTION_OK)
+		return -1;
+
+	// some record cannot be written - write them one by one, drop the bad ones
+	int ret = 0;
+	std::vector <ImageRecord> empty;
+	for (std::vector <ImageRecord>::iterator iter = full.begin (); iter != full.end (); iter++)
+	{
+		std::vector <ImageRecord> one (1, *iter);
+		if (!writeBatch (one, empty))
+		{
+			if (PQstatus (conn) != CONNECTION_OK)
+				return -1;
+			std::ostringstream os;
+			os << "dropped image record of observation " << iter->obs_id << " image " << iter->img_id << " " << iter->img_path;
+			addError (os.str ());
+			ret = 1;
+		}
+	}
+	for (std::vector <ImageRecord>::iterator iter = paths.begin (); iter != paths.end (); iter++)
+	{
+		std::vector <ImageRecord> one (1, *iter);
+		if (!writeBatch (empty, one))
+		{
+			if (PQstatus (conn) != CONNECTION_OK)
+				return -1;
+			std::ostringstream os;
+			os << "dropped path update of observation " << iter->obs_id << " image " << iter->img_id << " " << iter->img_path;
+			addError (os.str ());
+			ret = 1;
+		}
+	}
+	return ret;
+}
+
+bool ImageQueue::insertRecords (std::vector <ImageRecord> &records, const char *tail)
+{
+	for (size_t start = 0; start < records.size (); start += batchSize)
+	{
+		std::vector <std::string> params;
+		std::vector <bool> nulls;
+		size_t end = std::min (records.size (), start + batchSize);
+		for (size_t i = start; i < end; i++)
+		{
+			ImageRecord &r = records[i];
+			addInt (params, nulls, r.obs_id);
+			addInt (params, nulls, r.img_id);
+			addString (params, nulls, r.img_path);
+			addString (params, nulls, std::string (1, r.obs_subtype));
+			addString (params, nulls, r.mount_name);
+			addString (params, nulls, r.camera_name);
+			addDouble (params, nulls, r.img_temperature);
+			addDouble (params, nulls, r.img_exposure);
+			addInt (params, nulls, r.filter_id);
+			addDouble (params, nulls, r.img_alt);
+			addDouble (params, nulls, r.img_az);
+			addDouble (params, nulls, r.img_date);
+			addInt (params, nulls, r.img_usec);
+			addInt (params, nulls, r.med_id);
+			// astrometry sets astrometry processed and OK bits, as ImageSkyDb::updateAstrometry
+			addInt (params, nulls, r.astrometry.empty () ? r.process_bitfield : (r.process_bitfield | 1 | 2));
+			addDouble (params, nulls, r.img_fwhm);
+			addDouble (params, nulls, r.img_limmag);
+			addDouble (params, nulls, r.img_qmagmax);
+			addString (params, nulls, r.astrometry, true);
+			addDouble (params, nulls, r.img_err_ra);
+			addDouble (params, nulls, r.img_err_dec);
+			addDouble (params, nulls, r.img_err);
+		}
+		std::vector <std::string> values;
+		std::string sql = buildStatement (insertHead, tail, fullTypes, COLUMNS, params, nulls, values);
+		if (!execute (sql.c_str (), values))
+			return false;
+	}
+
+	return true;
+}
+
+bool ImageQueue::writeBatch (std::vector <ImageRecord> &full, std::vector <ImageRecord> &paths)
+{
+	std::vector <std::string> none;
+	if (!execute ("BEGIN", none))
+		return false;
+
+	std::vector <ImageRecord> fresh;
+	std::vector <ImageRecord> replayed;
+	for (std::vector <ImageRecord>::iterator iter = full.begin (); iter != full.end (); iter++)
+	{
+		if (iter->replayed)
+			replayed.push_back (*iter);
+		else
+			fresh.push_back (*iter);
+	}
+
+	if (!insertRecords (replayed, replayTail) || !insertRecords (fresh, insertTail))
+	{
+		execute ("ROLLBACK", none);
+		return false;
+	}
+
+	for (size_t start = 0; start < paths.size (); start += batchSize)
+	{
+		std::vector <std::string> params;
+		std::vector <bool> nulls;
+		size_t end = std::min (paths.size (), start + batchSize);
+		for (size_t i = start; i < end; i++)
+		{
+			addInt (params, nulls, paths[i].obs_id);
+			addInt (params, nulls, paths[i].img_id);
+			addString (params, nulls, paths[i].img_path);
+		}
+		std::vector <std::string> values;
+		std::string sql = buildStatement (pathHead, pathTail, pathTypes, 3, params, nulls, values);
+		if (!execute (sql.c_str (), values))
+		{
+			execute ("ROLLBACK", none);
+			return false;
+		}
+	}
+
+	if (!execute ("COMMIT", none))
+		return false;
+
+	pthread_mutex_lock (&mutex);
+	written += full.size () + paths.size ();
+	transactions++;
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
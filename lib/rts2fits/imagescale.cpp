@@ -0,0 +1,404 @@
+/*
+ * Scaling of image pixels for previews and data streaming.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/imagescale.h"
+#include "rts2fits/pixelhistogram.h"
+#include "imghdr.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+using namespace rts2image;
+
+// minimal number of pixels scaled by a thread
+#define SCALE_BLOCK     65536
+
+// entries of scaling function table
+#define CURVE_SIZE      65536
+
+int rts2image::scalingFromString (const char *name, scaling_type &scaling)
+{
+	if (!strcasecmp (name, "lin") || !strcasecmp (name, "linear"))
+		scaling = SCALING_LINEAR;
+	else if (!strcasecmp (name, "log"))
+		scaling = SCALING_LOG;
+	else if (!strcasecmp (name, "sqrt"))
+		scaling = SCALING_SQRT;
+	else if (!strcasecmp (name, "pow"))
+		scaling = SCALING_POW;
+	else
+		return -1;
+	return 0;
+}
+
+int rts2image::pixelByteSize (int dataType)
+{
+	if (dataType == RTS2_DATA_ULONG)
+		return 4;
+	return abs (dataType) / 8;
+}
+
+int rts2image::onlineCPUs ()
+{
+	long n = sysconf (_SC_NPROCESSORS_ONLN);
+	return n < 1 ? 1 : n;
+}
+
+struct RangeJob
+{
+	void (*func) (void *arg, size_t from, size_t to);
+	void *arg;
+	size_t from;
+	size_t to;
+};
+
+static void *rangeThread (void *arg)
+{
+	struct RangeJob *job = (struct RangeJob *) arg;
+	job->func (job->arg, job->from, job->to);
+	return NULL;
+}
+
+void rts2image::parallelRange (size_t n, size_t block, int threads, void (*func) (void *arg, size_t from, size_t to), void *arg)
+{
+	if (n == 0)
+		return;
+	if (block < 1)
+		block = 1;
+	size_t blocks = (n + block - 1) / block;
+	int nt = threads;
+	if ((size_t) nt > blocks)
+		nt = blocks;
+	if (nt <= 1)
+	{
+		func (arg, 0, n);
+		return;
+	}
+
+	pthread_t *th = new pthread_t[nt];
+	struct RangeJob *jobs = new struct RangeJob[nt];
+	size_t perThread = ((blocks + nt - 1) / nt) * block;
+	int started = 0;
+	for (int i = 0; i < nt; i++)
+	{
+		jobs[i].func = func;
+		jobs[i].arg = arg;
+		jobs[i].from = i * perThread;
+		jobs[i].to = std::min (n, (i + 1) * perThread);
+		if (jobs[i].from >= jobs[i].to)
+			break;
+		// last range is processed by the calling thread
+		if (i == nt - 1 || jobs[i].to == n)
+		{
+			rangeThread (jobs + i);
+			break;
+		}
+		if (pthread_create (th + started, NULL, rangeThread, jobs + i))
+			rangeThread (jobs + i);
+		else
+			started++;
+	}
+	for (int i = 0; i < started; i++)
+		pthread_join (th[i], NULL);
+
+	delete[] th;
+	delete[] jobs;
+}
+
+/**
+ * Scaling function on normalized value.
+ */
+static inline double scalingFunction (scaling_type scaling, double t)
+{
+	switch (scaling)
+	{
+		case SCALING_LINEAR:
+			break;
+		case SCALING_LOG:
+			return log (1 + 1000 * t) / log (1001);
+		case SCALING_SQRT:
+			return sqrt (t);
+		case SCALING_POW:
+			return t * t;
+	}
+	return t;
+}
+
+// lowest value of the type, including floating point types
+template <typename dt> static double typeLowest ()
+{
+	return std::numeric_limits <dt>::is_integer ? (double) std::numeric_limits <dt>::min () : -(double) std::numeric_limits <dt>::max ();
+}
+
+// size of lookup table of 8 and 16 bit data, 0 for other types
+template <typename dt> static size_t lutSize ()
+{
+	if (std::numeric_limits <dt>::is_integer && sizeof (dt) <= 2)
+		return sizeof (dt) == 1 ? 256 : 65536;
+	return 0;
+}
+
+template <typename dt, typename bt> struct ScaleJob
+{
+	const dt *src;
+	bt *dst;
+	double lo;
+	double hi;
+	double white;
+	const uint16_t *table;
+};
+
+// 8 and 16 bit data, table indexed by value - type minimum
+template <typename dt, typename bt> static void scaleLutRange (void *arg, size_t from, size_t to)
+{
+	ScaleJob <dt, bt> *job = (ScaleJob <dt, bt> *) arg;
+	const dt *s = job->src;
+	bt *d = job->dst;
+	const uint16_t *table = job->table;
+	const long off = std::numeric_limits <dt>::min ();
+	for (size_t i = from; i < to; i++)
+		d[i] = table[(long) s[i] - off];
+}
+
+template <typename dt, typename bt> static void scaleLinearRange (void *arg, size_t from, size_t to)
+{
+	ScaleJob <dt, bt> *job = (ScaleJob <dt, bt> *) arg;
+	const dt *s = job->src;
+	bt *d = job->dst;
+	const double lo = job->lo;
+	const double hi = job->hi;
+	const double l = hi - lo;
+	const double white = job->white;
+	for (size_t i = from; i < to; i++)
+	{
+		double p = s[i];
+		// negated test maps NaN to lo
+		p = !(p > lo) ? lo : p;
+		p = p > hi ? hi : p;
+		d[i] = (bt) (white * (p - lo) / l);
+	}
+}
+
+// nonlinear scaling of wide types, normalized value is mapped through function table
+template <typename dt, typename bt> static void scaleCurveRange (void *arg, size_t from, size_t to)
+{
+	ScaleJob <dt, bt> *job = (ScaleJob <dt, bt> *) arg;
+	const dt *s = job->src;
+	bt *d = job->dst;
+	const double lo = job->lo;
+	const double hi = job->hi;
+	const double k = (CURVE_SIZE - 1) / (hi - lo);
+	const uint16_t *table = job->table;
+	for (size_t i = from; i < to; i++)
+	{
+		double p = s[i];
+		// negated test maps NaN to lo
+		p = !(p > lo) ? lo : p;
+		p = p > hi ? hi : p;
+		d[i] = table[(int) ((p - lo) * k)];
+	}
+}
+
+PixelScaler::PixelScaler (double _smin, double _smax, scaling_type _scaling, int _newType)
+{
+	smin = _smin;
+	smax = _smax;
+	scaling = _scaling;
+	newType = _newType;
+	lutType = 0;
+	curveType = 0;
+	threads = 0;
+	setThreads (0);
+}
+
+void PixelScaler::setLimits (double _smin, double _smax)
+{
+	if (smin == _smin && smax == _smax)
+		return;
+	smin = _smin;
+	smax = _smax;
+	lutType = 0;
+}
+
+void PixelScaler::setScaling (scaling_type _scaling)
+{
+	if (scaling == _scaling)
+		return;
+	scaling = _scaling;
+	lutType = 0;
+	curveType = 0;
+}
+
+void PixelScaler::setNewType (int _newType)
+{
+	if (newType == _newType)
+		return;
+	newType = _newType;
+	lutType = 0;
+	curveType = 0;
+}
+
+void PixelScaler::setThreads (int _threads)
+{
+	threads = _threads;
+	if (threads <= 0)
+		threads = onlineCPUs ();
+}
+
+template <typename dt, typename bt> void PixelScaler::scaleType (int dataType, const dt *src, bt *dst, size_t numpix)
+{
+	double white = std::numeric_limits <bt>::max ();
+
+	double lo = std::max (smin, typeLowest <dt> ());
+	double hi = std::min (smax, (double) std::numeric_limits <dt>::max ());
+	if (hi <= lo)
+		hi = lo + 1;
+
+	ScaleJob <dt, bt> job;
+	job.lo = lo;
+	job.hi = hi;
+	job.white = white;
+	job.table = NULL;
+
+	void (*func) (void *, size_t, size_t) = scaleLinearRange <dt, bt>;
+
+	if (lutSize <dt> () > 0)
+	{
+		size_t range = lutSize <dt> ();
+		if (lutType != dataType)
+		{
+			lut.resize (range);
+			double l = hi - lo;
+			for (size_t i = 0; i < range; i++)
+			{
+				double p = typeLowest <dt> () + i;
+				p = p < lo ? lo : p;
+				p = p > hi ? hi : p;
+				if (scaling == SCALING_LINEAR)
+					lut[i] = (bt) (white * (p - lo) / l);
+				else
+					lut[i] = (bt) (white * scalingFunction (scaling, (p - lo) / l));
+			}
+			lutType = dataType;
+		}
+		job.table = &(lut[0]);
+		func = scaleLutRange <dt, bt>;
+	}
+	else if (scaling != SCALING_LINEAR)
+	{
+		if (curveType != newType)
+		{
+			curve.resize (CURVE_SIZE);
+			for (int i = 0; i < CURVE_SIZE; i++)
+				curve[i] = (bt) (white * scalingFunction (scaling, (double) i / (CURVE_SIZE - 1)));
+			curveType = newType;
+		}
+		job.table = &(curve[0]);
+		func = scaleCurveRange <dt, bt>;
+	}
+
+	job.src = src;
+
+	// in-place scaling to different size is safe only in single thread, from start to end
+	bool overlap = sizeof (dt) != sizeof (bt) && (const char *) dst < (const char *) (src + numpix) && (const char *) src < (const char *) (dst + numpix);
+	bool parallel = threads > 1 && numpix > SCALE_BLOCK;
+	if (overlap && (parallel || sizeof (bt) > sizeof (dt)))
+	{
+		std::vector <bt> tmp (numpix);
+		job.dst = &(tmp[0]);
+		parallelRange (numpix, SCALE_BLOCK, threads, func, &job);
+		memcpy (dst, &(tmp[0]), numpix * sizeof (bt));
+		return;
+	}
+
+	job.dst = dst;
+	parallelRange (numpix, SCALE_BLOCK, threads, func, &job);
+}
+
+template <typename bt> bool PixelScaler::scaleOutput (int dataType, const void *src, bt *dst, size_t numpix)
+{
+	switch (dataType)
+	{
+		case RTS2_DATA_BYTE:
+			scaleType (dataType, (const uint8_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_SBYTE:
+			scaleType (dataType, (const int8_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_SHORT:
+			scaleType (dataType, (const int16_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_USHORT:
+			scaleType (dataType, (const uint16_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_LONG:
+			scaleType (dataType, (const int32_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_ULONG:
+			scaleType (dataType, (const uint32_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_LONGLONG:
+			scaleType (dataType, (const int64_t *) src, dst, numpix);
+			break;
+		case RTS2_DATA_FLOAT:
+			scaleType (dataType, (const float *) src, dst, numpix);
+			break;
+		case RTS2_DATA_DOUBLE:
+			scaleType (dataType, (const double *) src, dst, numpix);
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+bool PixelScaler::scale (int dataType, const void *src, void *dst, size_t numpix)
+{
+	switch (newType)
+	{
+		case RTS2_DATA_BYTE:
+			return scaleOutput (dataType, src, (uint8_t *) dst, numpix);
+		case RTS2_DATA_USHORT:
+			return scaleOutput (dataType, src, (uint16_t *) dst, numpix);
+	}
+	return false;
+}
+
+bool PixelScaler::setQuantileLimits (int dataType, const void *data, size_t numpix, float quantile)
+{
+	PixelHistogram hist (dataType);
+	hist.setThreads (threads);
+	if (hist.add (data, numpix) == false)
+		return false;
+	setQuantileLimits (hist, quantile);
+	return true;
+}
+
+void PixelScaler::setQuantileLimits (PixelHistogram &hist, float quantile)
+{
+	if (hist.getCount () == 0)
+		return;
+	setLimits (hist.quantile (quantile), hist.quantile (1 - quantile));
+}
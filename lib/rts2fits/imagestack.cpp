@@ -0,0 +1,458 @@
+/*
+ * Stacking of calibration images.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/imagestack.h"
+#include "error.h"
+
+#include <fitsio.h>
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <math.h>
+#include <pthread.h>
+
+using namespace rts2image;
+
+// default memory limit for band buffers
+#define STACK_MEMORY     (512 * 1024 * 1024)
+
+// number of pixels sampled for median level
+#define STACK_SAMPLES    100000
+
+/**
+ * Thrown on cfitsio error.
+ */
+class StackError:public rts2core::Error
+{
+	public:
+		StackError (const char *op, const std::string &fn, int status):rts2core::Error ()
+		{
+			char err[FLEN_STATUS];
+			fits_get_errstatus (status, err);
+			std::ostringstream _os;
+			_os << "cannot " << op << " " << fn << ": " << err;
+			setMsg (_os.str ());
+		}
+};
+
+/**
+ * Open FITS files, closed when going out of scope.
+ */
+class StackFiles
+{
+	public:
+		StackFiles (int n) { fptrs.resize (n, NULL); }
+		~StackFiles ()
+		{
+			int status = 0;
+			for (std::vector <fitsfile *>::iterator iter = fptrs.begin (); iter != fptrs.end (); iter++)
+			{
+				if (*iter)
+					fits_close_file (*iter, &status);
+			}
+		}
+
+		std::vector <fitsfile *> fptrs;
+};
+
+/**
+ * Band of rows from all frames.
+ */
+struct StackBand
+{
+	std::vector <float *> frames;
+	float *sub;
+	float *out;
+	long row;
+	long rows;
+};
+
+static void freeBands (struct StackBand *bands)
+{
+	for (int b = 0; b < 2; b++)
+	{
+		for (std::vector <float *>::iterator iter = bands[b].frames.begin (); iter != bands[b].frames.end (); iter++)
+			delete[] *iter;
+		delete[] bands[b].sub;
+		delete[] bands[b].out;
+	}
+}
+
+struct StackCombineArgs
+{
+	StackCombiner *combiner;
+	struct StackBand *band;
+	long width;
+};
+
+static void *stackCombineThread (void *arg)
+{
+	struct StackCombineArgs *a = (struct StackCombineArgs *) arg;
+	a->combiner->combine (&(a->band->frames[0]), a->band->frames.size (), a->band->rows * a->width, a->band->out);
+	return NULL;
+}
+
+static void readRows (fitsfile *fptr, const std::string &fn, long width, long row, long rows, float *buf)
+{
+	int status = 0;
+	int anynul;
+	float nulval = NAN;
+	long fpixel[2] = {1, row + 1};
+	if (fits_read_pix (fptr, TFLOAT, fpixel, width * rows, &nulval, buf, &anynul, &status))
+		throw StackError ("read data from", fn, status);
+}
+
+/**
+ * Compute level (mean, median or max) from pixel values. Median is
+ * estimated from regularly sampled pixels.
+ */
+class LevelStat
+{
+	public:
+		LevelStat (stackScale_t _type, size_t npix)
+		{
+			type = _type;
+			sum = 0;
+			cnt = 0;
+			max = -INFINITY;
+			step = npix / STACK_SAMPLES;
+			if (step < 1)
+				step = 1;
+			pos = 0;
+		}
+
+		void add (const float *data, size_t len)
+		{
+			switch (type)
+			{
+				case STACK_SCALE_NONE:
+					break;
+				case STACK_SCALE_MEAN:
+					for (size_t i = 0; i < len; i++)
+					{
+						if (!std::isnan (data[i]))
+						{
+							sum += data[i];
+							cnt++;
+						}
+					}
+					break;
+				case STACK_SCALE_MAX:
+					for (size_t i = 0; i < len; i++)
+					{
+						if (data[i] > max)
+							max = data[i];
+					}
+					break;
+				case STACK_SCALE_MEDIAN:
+					for (; pos < len; pos += step)
+					{
+						if (!std::isnan (data[pos]))
+							samples.push_back (data[pos]);
+					}
+					pos -= len;
+					break;
+			}
+		}
+
+		double getLevel ()
+		{
+			switch (type)
+			{
+				case STACK_SCALE_MEAN:
+					return cnt ? sum / cnt : NAN;
+				case STACK_SCALE_MAX:
+					return max;
+				case STACK_SCALE_MEDIAN:
+					if (samples.empty ())
+						return NAN;
+					std::nth_element (samples.begin (), samples.begin () + samples.size () / 2, samples.end ());
+					return samples[samples.size () / 2];
+				default:
+					return 1;
+			}
+		}
+
+	private:
+		stackScale_t type;
+		double sum;
+		size_t cnt;
+		double max;
+		std::vector <float> samples;
+		size_t step;
+		size_t pos;
+};
+
+ImageStack::ImageStack (stackMethod_t _method):StackCombiner (_method), files (), subtract (), levels ()
+{
+	scale = STACK_SCALE_NONE;
+	normalize = STACK_SCALE_NONE;
+	memoryLimit = STACK_MEMORY;
+	outputLevel = 1;
+}
+
+void ImageStack::stack (const char *output)
+{
+	int status = 0;
+	int nframes = files.size ();
+	if (nframes == 0)
+		throw rts2core::Error ("no images to stack");
+
+	StackFiles in (nframes);
+	StackFiles sub (1);
+	StackFiles out (1);
+
+	long naxes[2] = {0, 0};
+	for (int i = 0; i < nframes; i++)
+	{
+		int naxis;
+		long sizes[2];
+		if (fits_open_image (&(in.fptrs[i]), files[i].c_str (), READONLY, &status))
+			throw StackError ("open", files[i], status);
+		if (fits_get_img_dim (in.fptrs[i], &naxis, &status) || fits_get_img_size (in.fptrs[i], 2, sizes, &status))
+			throw StackError ("get image size of", files[i], status);
+		if (naxis != 2)
+			throw rts2core::Error ("image " + files[i] + " is not 2D");
+		if (i == 0)
+		{
+			naxes[0] = sizes[0];
+			naxes[1] = sizes[1];
+		}
+		else if (sizes[0] != naxes[0] || sizes[1] != naxes[1])
+		{
+			throw rts2core::Error ("image " + files[i] + " has different size than " + files[0]);
+		}
+	}
+	if (subtract.length () > 0)
+	{
+		long sizes[2];
+		if (fits_open_image (&(sub.fptrs[0]), subtract.c_str (), READONLY, &status) || fits_get_img_size (sub.fptrs[0], 2, sizes, &status))
+			throw StackError ("open", subtract, status);
+		if (sizes[0] != naxes[0] || sizes[1] != naxes[1])
+			throw rts2core::Error ("subtracted image " + subtract + " has different size than stacked images");
+	}
+
+	long width = naxes[0];
+	long height = naxes[1];
+
+	// two bands are in memory, each holds all frames, subtracted image and output
+	long rows = memoryLimit / (2 * (nframes + 2) * width * sizeof (float));
+	if (rows < 1)
+		rows = 1;
+	if (rows > height)
+		rows = height;
+
+	struct StackBand bands[2];
+	// band combination thread, must be joined before bands are freed
+	pthread_t th;
+	bool running = false;
+	for (int b = 0; b < 2; b++)
+	{
+		for (int i = 0; i < nframes; i++)
+			bands[b].frames.push_back (new float[rows * width]);
+		bands[b].sub = sub.fptrs[0] ? new float[rows * width] : NULL;
+		bands[b].out = new float[rows * width];
+		bands[b].rows = 0;
+	}
+
+	try
+	{
+		// frame levels - needs pass over all frames
+		levels.assign (nframes, 1);
+		if (scale != STACK_SCALE_NONE)
+		{
+			struct StackBand &b = bands[0];
+			for (int i = 0; i < nframes; i++)
+			{
+				LevelStat ls (scale, width * height);
+				for (long r = 0; r < height; r += rows)
+				{
+					long n = std::min (rows, height - r);
+					readRows (in.fptrs[i], files[i], width, r, n, b.frames[i]);
+					if (b.sub)
+					{
+						readRows (sub.fptrs[0], subtract, width, r, n, b.sub);
+						for (long p = 0; p < n * width; p++)
+							b.frames[i][p] -= b.sub[p];
+					}
+					ls.add (b.frames[i], n * width);
+				}
+				levels[i] = ls.getLevel ();
+				if (!(levels[i] != 0) || std::isnan (levels[i]))
+					throw rts2core::Error ("invalid level of image " + files[i]);
+			}
+		}
+
+		// output header is copied from the first image
+		std::string ofn = std::string ("!") + output;
+		if (fits_create_file (&(out.fptrs[0]), ofn.c_str (), &status))
+			throw StackError ("create", output, status);
+		fitsfile *ofptr = out.fptrs[0];
+		if (fits_copy_header (in.fptrs[0], ofptr, &status) || fits_resize_img (ofptr, FLOAT_IMG, 2, naxes, &status))
+			throw StackError ("write header to", output, status);
+		fits_delete_key (ofptr, "BZERO", &status);
+		status = 0;
+		fits_delete_key (ofptr, "BSCALE", &status);
+		status = 0;
+		fits_set_bscale (ofptr, 1, 0, &status);
+
+		int ncomb = nframes;
+		fits_update_key (ofptr, TINT, "NCOMBINE", &ncomb, "number of stacked images", &status);
+		fits_update_key (ofptr, TSTRING, "STACKMET", (void *) stackMethodName (getMethod ()), "stacking method", &status);
+		if (subtract.length () > 0)
+			fits_update_key (ofptr, TSTRING, "STACKSUB", (void *) subtract.c_str (), "subtracted image", &status);
+		if (status)
+			throw StackError ("write header to", output, status);
+
+		LevelStat ols (normalize, width * height);
+
+		// read band, combine it in background while next band is read
+		bool pending = false;
+		struct StackCombineArgs args[2];
+		int cur = 0;
+		for (long r = 0; r < height || pending; r += rows)
+		{
+			struct StackBand &b = bands[cur];
+			if (r < height)
+			{
+				b.row = r;
+				b.rows = std::min (rows, height - r);
+				if (b.sub)
+					readRows (sub.fptrs[0], subtract, width, r, b.rows, b.sub);
+				for (int i = 0; i < nframes; i++)
+				{
+					float *d = b.frames[i];
+					readRows (in.fptrs[i], files[i], width, r, b.rows, d);
+					float sc = 1 / levels[i];
+					long np = b.rows * width;
+					if (b.sub)
+					{
+						for (long p = 0; p < np; p++)
+							d[p] = (d[p] - b.sub[p]) * sc;
+					}
+					else if (sc != 1)
+					{
+						for (long p = 0; p < np; p++)
+							d[p] *= sc;
+					}
+				}
+			}
+
+			// finish previous band
+			if (pending)
+			{
+				if (running)
+					pthread_join (th, NULL);
+				running = false;
+				pending = false;
+				struct StackBand &pb = bands[1 - cur];
+				long fpixel[2] = {1, pb.row + 1};
+				if (fits_write_pix (ofptr, TFLOAT, fpixel, pb.rows * width, pb.out, &status))
+					throw StackError ("write data to", output, status);
+				ols.add (pb.out, pb.rows * width);
+			}
+
+			if (r < height)
+			{
+				args[cur].combiner = this;
+				args[cur].band = &b;
+				args[cur].width = width;
+				running = pthread_create (&th, NULL, stackCombineThread, args + cur) == 0;
+				if (!running)
+					stackCombineThread (args + cur);
+				pending = true;
+				cur = 1 - cur;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		outputLevel = ols.getLevel ();
+		if (normalize != STACK_SCALE_NONE)
+		{
+			if (!(outputLevel != 0) || std::isnan (outputLevel))
+				throw rts2core::Error ("invalid level of stacked image");
+			float *d = bands[0].out;
+			for (long r = 0; r < height; r += rows)
+			{
+				long n = std::min (rows, height - r);
+				readRows (ofptr, output, width, r, n, d);
+				for (long p = 0; p < n * width; p++)
+					d[p] /= outputLevel;
+				long fpixel[2] = {1, r + 1};
+				if (fits_write_pix (ofptr, TFLOAT, fpixel, n * width, d, &status))
+					throw StackError ("write data to", output, status);
+			}
+			fits_update_key (ofptr, TDOUBLE, "STACKNRM", &outputLevel, "stacked image was divided by this value", &status);
+		}
+
+		if (fits_close_file (ofptr, &status))
+			throw StackError ("close", output, status);
+		out.fptrs[0] = NULL;
+	}
+	catch (rts2core::Error &er)
+	{
+		if (running)
+			pthread_join (th, NULL);
+		freeBands (bands);
+		throw;
+	}
+
+	freeBands (bands);
+}
+
+int rts2image_stack (const char *output, const char **files, int nfiles, const char *method, const char *scale, const char *normalize, const char *subtract, double kappa, int iterations, int nreject, int threads)
+{
+	stackMethod_t m;
+	stackScale_t sc;
+	stackScale_t nrm;
+	if (stackMethodFromString (method, m))
+	{
+		std::cerr << "unknown stacking method " << method << std::endl;
+		return -1;
+	}
+	if (stackScaleFromString (scale, sc) || stackScaleFromString (normalize, nrm))
+	{
+		std::cerr << "unknown scaling " << scale << " or normalization " << normalize << std::endl;
+		return -1;
+	}
+
+	ImageStack st (m);
+	st.setScale (sc);
+	st.setNormalize (nrm);
+	st.setSubtract (subtract);
+	st.setSigmaClip (kappa, kappa, iterations);
+	st.setMinMax (nreject, nreject);
+	st.setThreads (threads);
+	for (int i = 0; i < nfiles; i++)
+		st.addFile (files[i]);
+	try
+	{
+		st.stack (output);
+	}
+	catch (rts2core::Error &er)
+	{
+		std::cerr << er << std::endl;
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * FITS binary table of photometer samples.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/phottable.h"
+#include "block.h"
+#include "utilsfunc.h"
+
+#include <unistd.h>
+
+using namespace rts2image;
+
+PhotTable::PhotTable (const char *_filename):FitsFile ()
+{
+	setFileName (_filename);
+	rows = 0;
+}
+
+void PhotTable::open ()
+{
+	if (access (getFileName (), F_OK))
+	{
+		fitsfile *fptr = NULL;
+		const char *ttype[] = {"TIME", "SEQ", "COUNT", "EXPTIME", "FILTER", "OVERFLOW"};
+		const char *tform[] = {"1D", "1K", "1V", "1E", "1I", "1L"};
+		const char *tunit[] = {"s", "", "", "s", "", ""};
+
+		if (mkpath (getFileName (), 0777))
+			throw ErrorOpeningFitsFile (getFileName ());
+
+		fits_status = 0;
+		fits_create_file (&fptr, getFileName (), &fits_status);
+		fits_create_img (fptr, BYTE_IMG, 0, NULL, &fits_status);
+		fits_create_tbl (fptr, BINARY_TBL, 0, 6, (char **) ttype, (char **) tform, (char **) tunit, "PHOTOMETER", &fits_status);
+		fits_write_key_str (fptr, "TIMESYS", "UTC", "TIME is end of integration, seconds since 1970-01-01", &fits_status);
+		fits_close_file (fptr, &fits_status);
+		if (fits_status)
+		{
+			logStream (MESSAGE_ERROR) << "cannot create photometer table " << getFileName () << ": " << getFitsErrors () << sendLog;
+			throw ErrorOpeningFitsFile (getFileName ());
+		}
+	}
+
+	openFile (NULL, false);
+	moveHDU (2);
+	fits_get_num_rows (getFitsFile (), &rows, &fits_status);
+	if (fits_status)
+	{
+		logStream (MESSAGE_ERROR) << "cannot read photometer table " << getFileName () << ": " << getFitsErrors () << sendLog;
+		throw ErrorOpeningFitsFile (getFileName ());
+	}
+}
+
+int PhotTable::append (const std::vector <rts2phot::PhotSample> &samples)
+{
+	size_t n = samples.size ();
+	if (n == 0)
+		return 0;
+
+	std::vector <double> times (n);
+	std::vector <LONGLONG> seqs (n);
+	std::vector <unsigned int> counts (n);
+	std::vector <float> exps (n);
+	std::vector <short> filters (n);
+	std::vector <char> overflows (n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		times[i] = samples[i].getTime ();
+		seqs[i] = samples[i].seq;
+		counts[i] = samples[i].count;
+		exps[i] = samples[i].exp;
+		filters[i] = samples[i].filter;
+		overflows[i] = samples[i].overflow;
+	}
+
+	fitsfile *ffile = getFitsFile ();
+	fits_status = 0;
+	fits_write_col (ffile, TDOUBLE, 1, rows + 1, 1, n, &(times[0]), &fits_status);
+	fits_write_col (ffile, TLONGLONG, 2, rows + 1, 1, n, &(seqs[0]), &fits_status);
+	fits_write_col (ffile, TUINT, 3, rows + 1, 1, n, &(counts[0]), &fits_status);
+	fits_write_col (ffile, TFLOAT, 4, rows + 1, 1, n, &(exps[0]), &fits_status);
+	fits_write_col (ffile, TSHORT, 5, rows + 1, 1, n, &(filters[0]), &fits_status);
+	fits_write_col (ffile, TLOGICAL, 6, rows + 1, 1, n, &(overflows[0]), &fits_status);
+	// keep file readable (NAXIS2 updated) when the writer is killed
+	fits_flush_file (ffile, &fits_status);
+	if (fits_status)
+	{
+		logStream (MESSAGE_ERROR) << "cannot append to photometer table " << getFileName () << ": " << getFitsErrors () << sendLog;
+		return -1;
+	}
+	rows += n;
+	return 0;
+}
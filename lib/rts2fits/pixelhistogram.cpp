@@ -0,0 +1,222 @@
+/*
+ * Histogram and quantile sketch of image pixels.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/pixelhistogram.h"
+#include "rts2fits/imagescale.h"
+#include "imghdr.h"
+
+#include <algorithm>
+#include <limits>
+#include <math.h>
+#include <pthread.h>
+
+using namespace rts2image;
+
+// maximal number of sampled values
+#define SKETCH_SIZE     262144
+
+// minimal number of pixels counted by a thread
+#define HISTOGRAM_BLOCK   65536
+
+PixelHistogram::PixelHistogram (int _dataType)
+{
+	threads = 0;
+	setThreads (0);
+	reset (_dataType);
+}
+
+void PixelHistogram::reset (int _dataType)
+{
+	dataType = _dataType;
+	count = 0;
+	vmin = NAN;
+	vmax = NAN;
+	bins.clear ();
+	binLowest = 0;
+	sample.clear ();
+	sorted = true;
+	step = 1;
+	position = 0;
+	nextSample = 0;
+}
+
+void PixelHistogram::setThreads (int _threads)
+{
+	threads = _threads <= 0 ? onlineCPUs () : _threads;
+}
+
+template <typename dt> struct HistogramJob
+{
+	const dt *data;
+	size_t *bins;
+	size_t nbins;
+	pthread_mutex_t mutex;
+};
+
+// counts range to private histogram, which is then added to the shared one
+template <typename dt> static void histogramRange (void *arg, size_t from, size_t to)
+{
+	HistogramJob <dt> *job = (HistogramJob <dt> *) arg;
+	std::vector <size_t> h (job->nbins, 0);
+	const dt *s = job->data;
+	const long off = std::numeric_limits <dt>::min ();
+	for (size_t i = from; i < to; i++)
+		h[(long) s[i] - off]++;
+	pthread_mutex_lock (&(job->mutex));
+	for (size_t i = 0; i < job->nbins; i++)
+		job->bins[i] += h[i];
+	pthread_mutex_unlock (&(job->mutex));
+}
+
+template <typename dt> void PixelHistogram::addExact (const dt *data, size_t numpix)
+{
+	if (bins.empty ())
+	{
+		bins.resize (sizeof (dt) == 1 ? 256 : 65536, 0);
+		binLowest = std::numeric_limits <dt>::min ();
+	}
+
+	HistogramJob <dt> job;
+	job.data = data;
+	job.bins = &(bins[0]);
+	job.nbins = bins.size ();
+	pthread_mutex_init (&(job.mutex), NULL);
+	parallelRange (numpix, HISTOGRAM_BLOCK, threads, histogramRange <dt>, &job);
+	pthread_mutex_destroy (&(job.mutex));
+
+	count += numpix;
+
+	size_t i;
+	for (i = 0; i < bins.size () && bins[i] == 0; i++) ;
+	vmin = binLowest + i;
+	for (i = bins.size (); i > 0 && bins[i - 1] == 0; i--) ;
+	vmax = binLowest + i - 1;
+}
+
+template <typename dt> void PixelHistogram::addSampled (const dt *data, size_t numpix)
+{
+	// extremes and count of all pixels; comparisons with NaN are false
+	double mi = isnan (vmin) ? INFINITY : vmin;
+	double ma = isnan (vmax) ? -INFINITY : vmax;
+	size_t nans = 0;
+	for (size_t i = 0; i < numpix; i++)
+	{
+		double v = data[i];
+		mi = v < mi ? v : mi;
+		ma = v > ma ? v : ma;
+		nans += (v != v);
+	}
+	count += numpix - nans;
+	if (count > 0)
+	{
+		vmin = mi;
+		vmax = ma;
+	}
+
+	size_t i = nextSample - position;
+	for (; i < numpix; i += step)
+	{
+		double v = data[i];
+		if (v != v)
+			continue;
+		sample.push_back (v);
+		sorted = false;
+		if (sample.size () >= SKETCH_SIZE)
+		{
+			// keep odd samples, so the next one is one new step after the last kept
+			size_t j = 0;
+			for (size_t k = 1; k < sample.size (); k += 2)
+				sample[j++] = sample[k];
+			sample.resize (j);
+			step *= 2;
+		}
+	}
+	nextSample = position + i;
+	position += numpix;
+}
+
+bool PixelHistogram::add (const void *data, size_t numpix)
+{
+	sorted = false;
+	switch (dataType)
+	{
+		case RTS2_DATA_BYTE:
+			addExact ((const uint8_t *) data, numpix);
+			break;
+		case RTS2_DATA_SBYTE:
+			addExact ((const int8_t *) data, numpix);
+			break;
+		case RTS2_DATA_SHORT:
+			addExact ((const int16_t *) data, numpix);
+			break;
+		case RTS2_DATA_USHORT:
+			addExact ((const uint16_t *) data, numpix);
+			break;
+		case RTS2_DATA_LONG:
+			addSampled ((const int32_t *) data, numpix);
+			break;
+		case RTS2_DATA_ULONG:
+			addSampled ((const uint32_t *) data, numpix);
+			break;
+		case RTS2_DATA_LONGLONG:
+			addSampled ((const int64_t *) data, numpix);
+			break;
+		case RTS2_DATA_FLOAT:
+			addSampled ((const float *) data, numpix);
+			break;
+		case RTS2_DATA_DOUBLE:
+			addSampled ((const double *) data, numpix);
+			break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+double PixelHistogram::quantile (double q)
+{
+	if (count == 0)
+		return NAN;
+
+	if (isExact ())
+	{
+		double target = q * count;
+		size_t psum = 0;
+		for (size_t i = 0; i < bins.size (); i++)
+		{
+			psum += bins[i];
+			if (psum > target)
+				return binLowest + i;
+		}
+		return vmax;
+	}
+
+	if (sample.empty ())
+		return NAN;
+	if (sorted == false)
+	{
+		std::sort (sample.begin (), sample.end ());
+		sorted = true;
+	}
+	if (q <= 0)
+		return vmin;
+	if (q >= 1)
+		return vmax;
+	return sample[(size_t) (q * (sample.size () - 1))];
+}
@@ -0,0 +1,311 @@
+/*
+ * Pixel combination for image stacking.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2fits/imagestack.h"
+#include "rts2fits/imagescale.h"
+
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+using namespace rts2image;
+
+// pixels processed together in inner loops
+#define STACK_BLOCK   256
+
+int rts2image::stackMethodFromString (const char *name, stackMethod_t &method)
+{
+	if (!strcasecmp (name, "mean") || !strcasecmp (name, "average"))
+		method = STACK_MEAN;
+	else if (!strcasecmp (name, "median"))
+		method = STACK_MEDIAN;
+	else if (!strcasecmp (name, "sigclip") || !strcasecmp (name, "sigma"))
+		method = STACK_SIGMACLIP;
+	else if (!strcasecmp (name, "minmax"))
+		method = STACK_MINMAX;
+	else
+		return -1;
+	return 0;
+}
+
+const char *rts2image::stackMethodName (stackMethod_t method)
+{
+	switch (method)
+	{
+		case STACK_MEAN:
+			return "mean";
+		case STACK_MEDIAN:
+			return "median";
+		case STACK_SIGMACLIP:
+			return "sigclip";
+		case STACK_MINMAX:
+			return "minmax";
+	}
+	return "unknown";
+}
+
+int rts2image::stackScaleFromString (const char *name, stackScale_t &scale)
+{
+	if (name == NULL || !strcasecmp (name, "none"))
+		scale = STACK_SCALE_NONE;
+	else if (!strcasecmp (name, "mean"))
+		scale = STACK_SCALE_MEAN;
+	else if (!strcasecmp (name, "median"))
+		scale = STACK_SCALE_MEDIAN;
+	else if (!strcasecmp (name, "max"))
+		scale = STACK_SCALE_MAX;
+	else
+		return -1;
+	return 0;
+}
+
+/**
+ * Copy valid (not NaN) values of pixel to work buffer.
+ *
+ * @return number of valid values
+ */
+static inline int gatherPixel (const float * const *frames, int nframes, size_t p, float *work)
+{
+	int n = 0;
+	for (int f = 0; f < nframes; f++)
+	{
+		float v = frames[f][p];
+		if (!std::isnan (v))
+			work[n++] = v;
+	}
+	return n;
+}
+
+static inline float medianOf (float *work, int n)
+{
+	if (n == 0)
+		return NAN;
+	int h = n / 2;
+	std::nth_element (work, work + h, work + n);
+	if (n % 2)
+		return work[h];
+	// lower middle is maximum of the lower half
+	return (work[h] + *std::max_element (work, work + h)) / 2.0;
+}
+
+StackCombiner::StackCombiner (stackMethod_t _method)
+{
+	method = _method;
+	kappaLow = kappaHigh = 3;
+	iterations = 3;
+	nlow = nhigh = 1;
+	threads = 0;
+	setThreads (0);
+}
+
+void StackCombiner::setSigmaClip (float _kappaLow, float _kappaHigh, int _iterations)
+{
+	kappaLow = _kappaLow;
+	kappaHigh = _kappaHigh;
+	iterations = _iterations < 1 ? 1 : _iterations;
+}
+
+void StackCombiner::setMinMax (int _nlow, int _nhigh)
+{
+	nlow = _nlow < 0 ? 0 : _nlow;
+	nhigh = _nhigh < 0 ? 0 : _nhigh;
+}
+
+void StackCombiner::setThreads (int _threads)
+{
+	threads = _threads;
+	if (threads <= 0)
+		threads = onlineCPUs ();
+}
+
+struct CombineJob
+{
+	StackCombiner *combiner;
+	const float * const *frames;
+	int nframes;
+	float *out;
+};
+
+static void combineJob (void *arg, size_t from, size_t to)
+{
+	struct CombineJob *job = (struct CombineJob *) arg;
+	job->combiner->combineRange (job->frames, job->nframes, from, to, job->out);
+}
+
+void StackCombiner::combine (const float * const *frames, int nframes, size_t npix, float *out)
+{
+	struct CombineJob job;
+	job.combiner = this;
+	job.frames = frames;
+	job.nframes = nframes;
+	job.out = out;
+	// do not split small images
+	parallelRange (npix, STACK_BLOCK, threads, combineJob, &job);
+}
+
+void StackCombiner::combineRange (const float * const *frames, int nframes, size_t from, size_t to, float *out)
+{
+	// sigma clipping needs 3 block arrays and pixel values
+	float *work = new float[3 * STACK_BLOCK + nframes];
+	for (size_t p = from; p < to; p += STACK_BLOCK)
+	{
+		size_t len = std::min ((size_t) STACK_BLOCK, to - p);
+		switch (method)
+		{
+			case STACK_MEAN:
+				meanBlock (frames, nframes, p, len, out);
+				break;
+			case STACK_MEDIAN:
+				medianBlock (frames, nframes, p, len, out, work);
+				break;
+			case STACK_SIGMACLIP:
+				sigmaClipBlock (frames, nframes, p, len, out, work);
+				break;
+			case STACK_MINMAX:
+				minMaxBlock (frames, nframes, p, len, out, work);
+				break;
+		}
+	}
+	delete[] work;
+}
+
+void StackCombiner::meanBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out)
+{
+	double sum[STACK_BLOCK];
+	int cnt[STACK_BLOCK];
+	memset (sum, 0, sizeof (sum));
+	memset (cnt, 0, sizeof (cnt));
+	for (int f = 0; f < nframes; f++)
+	{
+		const float *d = frames[f] + from;
+		for (size_t i = 0; i < len; i++)
+		{
+			float v = d[i];
+			bool ok = (v == v);
+			sum[i] += ok ? v : 0;
+			cnt[i] += ok;
+		}
+	}
+	for (size_t i = 0; i < len; i++)
+		out[from + i] = cnt[i] ? sum[i] / cnt[i] : NAN;
+}
+
+void StackCombiner::sigmaClipBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work)
+{
+	double sum[STACK_BLOCK];
+	double sumsq[STACK_BLOCK];
+	int cnt[STACK_BLOCK];
+	float *center = work;
+	float *lo = work + STACK_BLOCK;
+	float *hi = work + 2 * STACK_BLOCK;
+
+	// first clip around median, as mean is skewed by outliers
+	float *pix = work + 3 * STACK_BLOCK;
+	for (size_t i = 0; i < len; i++)
+		center[i] = medianOf (pix, gatherPixel (frames, nframes, from + i, pix));
+
+	memset (sumsq, 0, sizeof (sumsq));
+	memset (cnt, 0, sizeof (cnt));
+	for (int f = 0; f < nframes; f++)
+	{
+		const float *d = frames[f] + from;
+		for (size_t i = 0; i < len; i++)
+		{
+			float v = d[i];
+			bool ok = (v == v);
+			double dv = ok ? v - center[i] : 0;
+			sumsq[i] += dv * dv;
+			cnt[i] += ok;
+		}
+	}
+	for (size_t i = 0; i < len; i++)
+	{
+		float sd = cnt[i] ? sqrt (sumsq[i] / cnt[i]) : 0;
+		lo[i] = center[i] - kappaLow * sd;
+		hi[i] = center[i] + kappaHigh * sd;
+	}
+
+	for (int it = 0; it < iterations; it++)
+	{
+		memset (sum, 0, sizeof (sum));
+		memset (sumsq, 0, sizeof (sumsq));
+		memset (cnt, 0, sizeof (cnt));
+		for (int f = 0; f < nframes; f++)
+		{
+			const float *d = frames[f] + from;
+			for (size_t i = 0; i < len; i++)
+			{
+				float v = d[i];
+				// NaN fails both comparisons
+				bool ok = (v >= lo[i]) && (v <= hi[i]);
+				double dv = ok ? v : 0;
+				sum[i] += dv;
+				sumsq[i] += dv * dv;
+				cnt[i] += ok;
+			}
+		}
+		if (it == iterations - 1)
+			break;
+		for (size_t i = 0; i < len; i++)
+		{
+			if (cnt[i] == 0)
+				continue;
+			double m = sum[i] / cnt[i];
+			double var = sumsq[i] / cnt[i] - m * m;
+			float sd = var > 0 ? sqrt (var) : 0;
+			lo[i] = m - kappaLow * sd;
+			hi[i] = m + kappaHigh * sd;
+		}
+	}
+	for (size_t i = 0; i < len; i++)
+		out[from + i] = cnt[i] ? sum[i] / cnt[i] : center[i];
+}
+
+void StackCombiner::medianBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work)
+{
+	for (size_t i = 0; i < len; i++)
+		out[from + i] = medianOf (work, gatherPixel (frames, nframes, from + i, work));
+}
+
+void StackCombiner::minMaxBlock (const float * const *frames, int nframes, size_t from, size_t len, float *out, float *work)
+{
+	for (size_t i = 0; i < len; i++)
+	{
+		int n = gatherPixel (frames, nframes, from + i, work);
+		if (n == 0)
+		{
+			out[from + i] = NAN;
+			continue;
+		}
+		int s = 0;
+		int e = n;
+		// reject only when something remains
+		if (n > nlow + nhigh)
+		{
+			std::sort (work, work + n);
+			s = nlow;
+			e = n - nhigh;
+		}
+		double sum = 0;
+		for (int j = s; j < e; j++)
+			sum += work[j];
+		out[from + i] = sum / (e - s);
+	}
+}
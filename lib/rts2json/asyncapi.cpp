@@ -228,6 +228,13 @@ AsyncDataAPI::AsyncDataAPI (JSONRequest *_req, rts2core::Connection *_conn, XmlR
 	oldType = 0;
 
 	headerSend = false;
+
+	scaler = NULL;
+}
+
+AsyncDataAPI::~AsyncDataAPI ()
+{
+	delete scaler;
 }
 
 void AsyncDataAPI::fullDataReceived (rts2core::Connection *_conn, rts2core::DataChannels *_data)
@@ -242,10 +249,9 @@ void AsyncDataAPI::fullDataReceived (rts2core::Connection *_conn, rts2core::Data
 			if (source)
 			{
 				size_t bosend = bytesSoFar;
-				if (newType != 0 && newType != oldType)
-				{
-					bosend = sizeof (struct imghdr) + (oldType / 8) * (bosend - sizeof (struct imghdr)) / (newType / 8);
-				}
+				bool scale = newType != 0 && newType != oldType;
+				if (scale)
+					bosend = originalOffset ();
 				if (data->getRestSize () > 0)
 				{
 					// incomplete image was received, close outbond connection..
@@ -255,38 +261,18 @@ void AsyncDataAPI::fullDataReceived (rts2core::Connection *_conn, rts2core::Data
 				else if (bosend < (size_t) (data->getDataTop () - data->getDataBuff ()))
 				{
 					// full image was received, let's make sure it will be send
-					if (newType != 0 && newType != oldType)
+					if (scale)
 					{
-						size_t ds = data->getDataTop () - data->getDataBuff () - bosend;
-						char *newData = new char[ds];
-						memcpy (newData, data->getDataBuff () + bosend, ds);
-						// scale data for async
-						if (bytesSoFar < sizeof (struct imghdr))
-						{
-							struct imghdr imgh;
-							memcpy (&imgh, newData, sizeof (struct imghdr) - bytesSoFar);
-							imgh.data_type = htons (newType);
-
-							oldType = ntohs (((struct imghdr *) data->getDataBuff ())->data_type);
-							ds = (ds - sizeof (struct imghdr) + bytesSoFar) / (oldType / 8);
-
-							getScaledData (oldType, newData + sizeof (struct imghdr) - bytesSoFar, ds, smin, smax, scaling, newType);
-							ds = sizeof (struct imghdr) + (newType / 8) * ds;
-							if (bytesSoFar == 0 && headerSend == false)
-							{
-								req->sendAsyncDataHeader (ds, source);
-								headerSend = true;
-							}
-						}
-						else
+						// part of the last pixel might be already sent
+						size_t skip = bytesSoFar > sizeof (struct imghdr) ? (bytesSoFar - sizeof (struct imghdr)) % rts2image::pixelByteSize (newType) : 0;
+						size_t ds = scaleChunk (bosend);
+						if (bytesSoFar == 0 && headerSend == false)
 						{
-							ds /= (oldType / 8);
-							// we send out pixels, so this scaling is legal
-							getScaledData (oldType, newData, ds, smin, smax, scaling, newType);
-							ds *= (newType / 8);
+							req->sendAsyncDataHeader (ds, source);
+							headerSend = true;
 						}
-						source->setResponse (newData, ds);
-						delete[] newData;
+						if (ds > skip)
+							source->setResponse (&(scaled[skip]), ds - skip);
 					}
 					else
 					{
@@ -326,7 +312,7 @@ void AsyncDataAPI::sendData ()
 				if (oldType == 0)
 					oldType = ntohs (((struct imghdr *) data->getDataBuff ())->data_type);
 
-				req->sendAsyncDataHeader (sizeof (struct imghdr) + (newType / 8) * (ds - sizeof (struct imghdr)) / (oldType / 8), source);
+				req->sendAsyncDataHeader (sizeof (struct imghdr) + rts2image::pixelByteSize (newType) * ((ds - sizeof (struct imghdr)) / rts2image::pixelByteSize (oldType)), source);
 			}
 			else
 			{
@@ -351,22 +337,52 @@ void AsyncDataAPI::sendData ()
 		// bytesSoFar > sizeof (struct imghdr)
 		else
 		{
-			// send bytes in old data lenght
-			size_t bosend = sizeof (struct imghdr) + (oldType / 8) * (bytesSoFar - sizeof (struct imghdr)) / (newType / 8);
-			size_t ds = data->getDataTop () - data->getDataBuff () - bosend;
-			char *newData = new char[ds];
-			memcpy (newData, data->getDataBuff () + bosend, ds);
-			// scale data
-			ds /= (oldType / 8);
-			getScaledData (oldType, newData, ds, smin, smax, scaling, newType);
-			doSendData (newData, (newType / 8) * ds);
-			delete[] newData;
+			// scale pixels from the first one not sent; part of it might be already sent
+			size_t skip = (bytesSoFar - sizeof (struct imghdr)) % rts2image::pixelByteSize (newType);
+			size_t ds = scaleChunk (originalOffset ());
+			if (ds > skip)
+				doSendData (&(scaled[skip]), ds - skip);
 		}
 		return;
 	}
 	doSendData (data->getDataBuff () + bytesSoFar, data->getDataTop () - data->getDataBuff () - bytesSoFar);
 }
 
+size_t AsyncDataAPI::originalOffset ()
+{
+	if (bytesSoFar <= sizeof (struct imghdr))
+		return bytesSoFar;
+	return sizeof (struct imghdr) + rts2image::pixelByteSize (oldType) * ((bytesSoFar - sizeof (struct imghdr)) / rts2image::pixelByteSize (newType));
+}
+
+size_t AsyncDataAPI::scaleChunk (size_t bosend)
+{
+	if (oldType == 0)
+		oldType = ntohs (((struct imghdr *) data->getDataBuff ())->data_type);
+	if (scaler == NULL)
+		scaler = new rts2image::PixelScaler (smin, smax, scaling, newType);
+
+	size_t top = data->getDataTop () - data->getDataBuff ();
+	size_t hs = 0;
+	if (bosend < sizeof (struct imghdr))
+	{
+		struct imghdr imgh;
+		memcpy (&imgh, data->getDataBuff (), sizeof (struct imghdr));
+		imgh.data_type = htons (newType);
+		hs = sizeof (struct imghdr) - bosend;
+		scaled.resize (hs);
+		memcpy (&(scaled[0]), ((char *) &imgh) + bosend, hs);
+		bosend = sizeof (struct imghdr);
+	}
+
+	// scale directly from received data, partial pixel at the end waits for the next chunk
+	size_t npix = top > bosend ? (top - bosend) / rts2image::pixelByteSize (oldType) : 0;
+	scaled.resize (hs + npix * rts2image::pixelByteSize (newType));
+	if (npix > 0)
+		scaler->scale (oldType, data->getDataBuff () + bosend, &(scaled[hs]), npix);
+	return scaled.size ();
+}
+
 AsyncCurrentAPI::AsyncCurrentAPI (JSONRequest *_req, rts2core::Connection *_conn, XmlRpc::XmlRpcServerConnection *_source, rts2core::DataAbstractRead *_data, int _chan, long _smin, long _smax, rts2image::scaling_type _scaling, int _newType):AsyncDataAPI (_req, _conn, _source, _data, _chan, _smin, _smax, _scaling, _newType)
 {
 	// try to send data
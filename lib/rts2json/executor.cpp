@@ -0,0 +1,251 @@
+/*
+ * Worker pool for HTTP requests.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2json/executor.h"
+#include "app.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+
+using namespace rts2json;
+
+// thread routine
+void *executorThread (void *arg)
+{
+	((RequestExecutor *) arg)->run ();
+	return NULL;
+}
+
+RequestJob::RequestJob (GetRequestAuthorized *_request, XmlRpc::XmlRpcServerConnection *_source, const std::string &_path, XmlRpc::HttpParams *_params):path (_path), params (*_params)
+{
+	request = _request;
+	source = _source;
+	queued = rts2core::statsNow ();
+	orphaned = false;
+
+	http_code = HTTP_BAD_REQUEST;
+	response_type = "text/html";
+	response = NULL;
+	response_length = 0;
+}
+
+RequestExecutor::RequestExecutor (HTTPServer *_server):threads (), jobs (), finished (), messages (), pending (), running (0), threadNum (0)
+{
+	server = _server;
+	notifyPipe[0] = notifyPipe[1] = -1;
+}
+
+RequestExecutor::~RequestExecutor ()
+{
+	stop ();
+}
+
+int RequestExecutor::start (int nthreads)
+{
+	if (nthreads <= 0 || threads.size () > 0)
+		return 0;
+
+	if (pipe (notifyPipe))
+	{
+		logStream (MESSAGE_ERROR) << "cannot create executor pipe: " << strerror (errno) << sendLog;
+		notifyPipe[0] = notifyPipe[1] = -1;
+		return -1;
+	}
+	fcntl (notifyPipe[0], F_SETFL, O_NONBLOCK);
+	fcntl (notifyPipe[1], F_SETFL, O_NONBLOCK);
+
+	mainThread = pthread_self ();
+
+	for (int i = 0; i < nthreads; i++)
+	{
+		pthread_t t;
+		int ret = pthread_create (&t, NULL, executorThread, this);
+		if (ret)
+		{
+			logStream (MESSAGE_ERROR) << "cannot start worker thread: " << strerror (ret) << sendLog;
+			break;
+		}
+		threads.push_back (t);
+	}
+	return threads.size () > 0 ? 0 : -1;
+}
+
+void RequestExecutor::stop ()
+{
+	// NULL job ends the worker
+	for (size_t i = 0; i < threads.size (); i++)
+		jobs.push (NULL);
+	for (std::vector <pthread_t>::iterator iter = threads.begin (); iter != threads.end (); iter++)
+		pthread_join (*iter, NULL);
+	threads.clear ();
+
+	while (!finished.empty ())
+	{
+		RequestJob *job = finished.pop ();
+		delete[] job->response;
+		delete job;
+	}
+	pending.clear ();
+	while (!messages.empty ())
+		messages.pop ();
+
+	if (notifyPipe[0] >= 0)
+	{
+		close (notifyPipe[0]);
+		close (notifyPipe[1]);
+		notifyPipe[0] = notifyPipe[1] = -1;
+	}
+}
+
+bool RequestExecutor::queueRequest (GetRequestAuthorized *request, XmlRpc::XmlRpcServerConnection *source, const std::string &path, XmlRpc::HttpParams *params)
+{
+	if (threads.size () == 0 || source == NULL)
+		return false;
+	RequestJob *job = new RequestJob (request, source, path, params);
+	pending.push_back (job);
+	jobs.push (job);
+	return true;
+}
+
+int RequestExecutor::processFinished ()
+{
+	char buf[50];
+	while (read (notifyPipe[0], buf, sizeof (buf)) > 0)
+		;
+
+	int ret = 0;
+	// main loop is the only consumer of finished queue
+	while (!finished.empty ())
+	{
+		RequestJob *job = finished.pop ();
+		pending.remove (job);
+		if (job->http_code == HTTP_OK)
+			server->addExecutedPage ();
+		if (job->orphaned)
+			delete[] job->response;
+		else
+		{
+			for (std::list <std::pair <const char *, std::string> >::iterator iter = job->headers.begin (); iter != job->headers.end (); iter++)
+				job->source->addExtraHeader (iter->first, iter->second);
+			// connection takes ownership of the response
+			job->source->setAsyncResponse (job->http_code, job->response_type, job->response, job->response_length);
+		}
+		delete job;
+		ret++;
+	}
+	return ret;
+}
+
+void RequestExecutor::orphanRequests (XmlRpc::XmlRpcServerConnection *source)
+{
+	for (std::list <RequestJob *>::iterator iter = pending.begin (); iter != pending.end (); iter++)
+	{
+		if ((*iter)->source == source)
+			(*iter)->orphaned = true;
+	}
+}
+
+bool RequestExecutor::queueMessage (messageType_t type, const char *msg)
+{
+	if (notifyPipe[1] < 0 || pthread_equal (pthread_self (), mainThread))
+		return false;
+	messages.push (std::pair <messageType_t, std::string> (type, msg));
+	notify ();
+	return true;
+}
+
+bool RequestExecutor::popMessage (std::pair <messageType_t, std::string> &msg)
+{
+	if (messages.empty ())
+		return false;
+	msg = messages.pop ();
+	return true;
+}
+
+void RequestExecutor::run ()
+{
+	server->workerStarted (threadNum.fetch_add (1));
+
+	while (true)
+	{
+		RequestJob *job = jobs.pop (true);
+		if (job == NULL)
+			break;
+
+		running.fetch_add (1, std::memory_order_relaxed);
+		double start = rts2core::statsNow ();
+		queueWait.record (start - job->queued);
+
+		execute (job);
+
+		handlerTime.record (rts2core::statsNow () - start);
+		running.fetch_sub (1, std::memory_order_relaxed);
+
+		finished.push (job);
+		notify ();
+	}
+}
+
+void RequestExecutor::notify ()
+{
+	char c = 0;
+	// pipe full means main loop has not yet processed previous notifications
+	if (write (notifyPipe[1], &c, 1) < 0 && errno != EAGAIN)
+		std::cerr << "cannot notify main loop about finished request: " << strerror (errno) << std::endl;
+}
+
+void RequestExecutor::execute (RequestJob *job)
+{
+	XmlRpc::XmlRpcServerGetRequest::setThreadHeaders (&(job->headers));
+	try
+	{
+		job->http_code = HTTP_OK;
+		// threaded requests do not use the source connection
+		job->request->authorizedExecute (NULL, job->path, &(job->params), job->response_type, job->response, job->response_length);
+	}
+	catch (XmlRpc::JSONException &fault)
+	{
+		setResponse (job, fault.getCode (), "application/json", "{\"error\":\"" + fault.getMessage () + "\",\"ret\":-2}");
+	}
+	catch (XmlRpc::XmlRpcAsynchronous &async)
+	{
+		// asynchronous calls must be handled in the main loop
+		setResponse (job, HTTP_BAD_REQUEST, "text/html", "<html><head><title>Error</title></head><body><p>Request cannot be executed asynchronously</p></body></html>");
+	}
+	catch (std::exception &ex)
+	{
+		setResponse (job, HTTP_BAD_REQUEST, "text/html", std::string ("<html><head><title>Error</title></head><body><p>Bad request ") + ex.what () + "</p></body></html>");
+	}
+	XmlRpc::XmlRpcServerGetRequest::setThreadHeaders (NULL);
+
+	// connection cannot send empty response
+	if (job->response == NULL || job->response_length == 0)
+		setResponse (job, job->http_code, job->response_type, "\n");
+}
+
+void RequestExecutor::setResponse (RequestJob *job, int http_code, const char *response_type, const std::string &msg)
+{
+	delete[] job->response;
+	job->http_code = http_code;
+	job->response_type = response_type;
+	job->response_length = msg.length ();
+	job->response = new char[job->response_length];
+	memcpy (job->response, msg.c_str (), job->response_length);
+}
@@ -30,7 +30,7 @@ void GetRequestAuthorized::execute (XmlRpc::XmlRpcSource *source, struct sockadd
 	if (getServer ()->isPublic (saddr, getPrefix () + path))
 	{
 		http_code = HTTP_OK;
-		authorizedExecute (source, path, params, response_type, response, response_length);
+		dispatchExecute (source, path, params, response_type, response, response_length);
 		return;
 	}
 
@@ -50,7 +50,7 @@ void GetRequestAuthorized::execute (XmlRpc::XmlRpcSource *source, struct sockadd
 	}
 	http_code = HTTP_OK;
 
-	authorizedExecute (source, path, params, response_type, response, response_length);
+	dispatchExecute (source, path, params, response_type, response, response_length);
 
 	getServer ()->addExecutedPage ();
 }
@@ -120,6 +120,13 @@ bool GetRequestAuthorized::canWriteDevice (const std::string &deviceName)
 	return userPermissions->canWriteDevice (deviceName);
 }
 
+void GetRequestAuthorized::dispatchExecute (XmlRpc::XmlRpcSource *source, std::string path, HttpParams *params, const char* &response_type, char* &response, size_t &response_length)
+{
+	if (isThreaded (path, params) && getServer ()->queueRequest (this, connection, path, params))
+		throw XmlRpc::XmlRpcAsynchronous ();
+	authorizedExecute (source, path, params, response_type, response, response_length);
+}
+
 bool GetRequestAuthorized::canWriteVariable (const std::string &deviceName, const std::string &variableName)
 {
 	if (canWriteDevice (deviceName))
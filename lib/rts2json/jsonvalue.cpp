@@ -138,10 +138,9 @@ void rts2json::sendValue (rts2core::Value *value, std::ostringstream &os)
 	}
 }
 
-// encode value to JSON
-void rts2json::jsonValue (rts2core::Value *value, bool extended, std::ostringstream & os)
+// encode value data to JSON
+void rts2json::jsonValueData (rts2core::Value *value, bool extended, std::ostringstream & os)
 {
-	os << "\"" << value->getName () << "\":";
 	if (extended)
 		os << "[" << value->getFlags () << ",";
   	if (value->getValueExtType() == RTS2_VALUE_ARRAY)
@@ -164,6 +163,13 @@ void rts2json::jsonValue (rts2core::Value *value, bool extended, std::ostringstr
 		os << "," << value->isError () << "," << value->isWarning () << ",\"" << value->getDescription () << "\"]";
 }
 
+// encode value to JSON
+void rts2json::jsonValue (rts2core::Value *value, bool extended, std::ostringstream & os)
+{
+	os << "\"" << value->getName () << "\":";
+	jsonValueData (value, extended, os);
+}
+
 void rts2json::sendConnectionValues (std::ostringstream & os, rts2core::Connection * conn, XmlRpc::HttpParams *params, double from, bool extended)
 {
 	os << "\"d\":{" << std::fixed;
@@ -208,3 +214,55 @@ void rts2json::sendConnectionValues (std::ostringstream & os, rts2core::Connecti
 
 	os << "},\"idle\":" << conn->isIdle () << ",\"state\":" << conn->getState () << ",\"sstart\":" << rts2json::JsonDouble (conn->getProgressStart ()) << ",\"send\":" << rts2json::JsonDouble (conn->getProgressEnd ()) << ",\"f\":" << rts2json::JsonDouble (mfrom);
 }
+
+// doubles are equal, or both are nan
+static bool sameDouble (double a, double b)
+{
+	return a == b || (std::isnan (a) && std::isnan (b));
+}
+
+void ValuesSnapshot::sendConnectionValues (std::ostringstream &os, rts2core::Connection * conn, XmlRpc::HttpParams *params, double from, bool extended)
+{
+	// only full dumps, without change times, are cached
+	if (std::isnan (from) || from > 0 || conn->getOtherDevClient () == NULL)
+	{
+		rts2json::sendConnectionValues (os, conn, params, from, extended);
+		return;
+	}
+
+	std::pair <rts2core::Connection *, bool> key (conn, extended);
+	size_t nvalues = conn->valueEnd () - conn->valueBegin ();
+
+	std::map <std::pair <rts2core::Connection *, bool>, SnapshotEntry>::iterator iter = entries.find (key);
+	if (iter != entries.end ()
+		&& iter->second.state == conn->getState ()
+		&& iter->second.nvalues == nvalues
+		&& sameDouble (iter->second.progressStart, conn->getProgressStart ())
+		&& sameDouble (iter->second.progressEnd, conn->getProgressEnd ()))
+	{
+		hits++;
+		os << std::fixed << iter->second.json;
+		return;
+	}
+
+	misses++;
+	std::ostringstream _os;
+	_os.copyfmt (os);
+	rts2json::sendConnectionValues (_os, conn, params, from, extended);
+
+	SnapshotEntry entry;
+	entry.json = _os.str ();
+	entry.state = conn->getState ();
+	entry.progressStart = conn->getProgressStart ();
+	entry.progressEnd = conn->getProgressEnd ();
+	entry.nvalues = nvalues;
+	entries[key] = entry;
+
+	os << std::fixed << entry.json;
+}
+
+void ValuesSnapshot::invalidate (rts2core::Connection *conn)
+{
+	entries.erase (std::pair <rts2core::Connection *, bool> (conn, false));
+	entries.erase (std::pair <rts2core::Connection *, bool> (conn, true));
+}
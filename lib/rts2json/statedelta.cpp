@@ -0,0 +1,261 @@
+/*
+ * Delta encoding of JSON observatory state.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "rts2json/statedelta.h"
+
+using namespace rts2json;
+
+static const char *sectionNames[2] = {"d", "minmax"};
+
+StateDelta::StateDelta ()
+{
+	seq = 0;
+	removedSeq = 0;
+	pass = 0;
+	changed = false;
+	removed = false;
+}
+
+void StateDelta::beginUpdate ()
+{
+	pass++;
+	changed = false;
+	removed = false;
+}
+
+void StateDelta::setMember (const std::string &device, stateSection_t section, const std::string &name, const std::string &json)
+{
+	size_t di;
+	std::map <std::string, size_t>::iterator diter = deviceIndex.find (device);
+	if (diter == deviceIndex.end ())
+	{
+		di = devices.size ();
+		devices.push_back (Device ());
+		devices[di].name = device;
+		deviceIndex[device] = di;
+	}
+	else
+	{
+		di = diter->second;
+	}
+
+	Device &dev = devices[di];
+	dev.seen = pass;
+
+	Section &sec = dev.sections[section];
+	std::map <std::string, size_t>::iterator miter = sec.index.find (name);
+	if (miter == sec.index.end ())
+	{
+		Member m;
+		m.name = name;
+		m.json = json;
+		m.changed = seq + 1;
+		m.seen = pass;
+		sec.index[name] = sec.members.size ();
+		sec.members.push_back (m);
+		changed = true;
+		return;
+	}
+
+	Member &m = sec.members[miter->second];
+	m.seen = pass;
+	if (m.json != json)
+	{
+		m.json = json;
+		m.changed = seq + 1;
+		changed = true;
+	}
+}
+
+bool StateDelta::pruneSection (Section &sec)
+{
+	size_t j = 0;
+	for (size_t i = 0; i < sec.members.size (); i++)
+	{
+		if (sec.members[i].seen != pass)
+			continue;
+		if (i != j)
+			sec.members[j] = sec.members[i];
+		j++;
+	}
+	if (j == sec.members.size ())
+		return false;
+
+	sec.members.resize (j);
+	sec.index.clear ();
+	for (size_t i = 0; i < j; i++)
+		sec.index[sec.members[i].name] = i;
+	return true;
+}
+
+uint32_t StateDelta::endUpdate ()
+{
+	size_t j = 0;
+	for (size_t i = 0; i < devices.size (); i++)
+	{
+		if (devices[i].seen != pass)
+		{
+			removed = true;
+			continue;
+		}
+		for (int s = 0; s < 3; s++)
+		{
+			if (pruneSection (devices[i].sections[s]))
+				removed = true;
+		}
+		if (i != j)
+			devices[j] = devices[i];
+		j++;
+	}
+
+	if (j != devices.size ())
+	{
+		devices.resize (j);
+		deviceIndex.clear ();
+		for (size_t i = 0; i < j; i++)
+			deviceIndex[devices[i].name] = i;
+	}
+
+	if (changed || removed)
+		seq++;
+	if (removed)
+		removedSeq = seq;
+
+	changed = false;
+	removed = false;
+
+	return seq;
+}
+
+void StateDelta::writeDevice (std::ostream &os, Device &dev, uint32_t base)
+{
+	os << "\"" << dev.name << "\":{";
+	bool first = true;
+	for (int s = 0; s < 2; s++)
+	{
+		Section &sec = dev.sections[s];
+		bool firstMember = true;
+		for (std::vector <Member>::iterator iter = sec.members.begin (); iter != sec.members.end (); iter++)
+		{
+			if (iter->changed <= base)
+				continue;
+			if (firstMember)
+			{
+				if (!first)
+					os << ",";
+				os << "\"" << sectionNames[s] << "\":{";
+				firstMember = false;
+				first = false;
+			}
+			else
+			{
+				os << ",";
+			}
+			os << "\"" << iter->name << "\":" << iter->json;
+		}
+		if (!firstMember)
+		{
+			os << "}";
+		}
+		// full snapshot always holds values and minmax objects
+		else if (base == 0)
+		{
+			if (!first)
+				os << ",";
+			os << "\"" << sectionNames[s] << "\":{}";
+			first = false;
+		}
+	}
+
+	Section &hdr = dev.sections[SECTION_HEADER];
+	for (std::vector <Member>::iterator iter = hdr.members.begin (); iter != hdr.members.end (); iter++)
+	{
+		if (iter->changed <= base)
+			continue;
+		if (first)
+			first = false;
+		else
+			os << ",";
+		os << "\"" << iter->name << "\":" << iter->json;
+	}
+	os << "}";
+}
+
+bool StateDelta::deviceChanged (Device &dev, uint32_t base)
+{
+	for (int s = 0; s < 3; s++)
+	{
+		for (std::vector <Member>::iterator iter = dev.sections[s].members.begin (); iter != dev.sections[s].members.end (); iter++)
+		{
+			if (iter->changed > base)
+				return true;
+		}
+	}
+	return false;
+}
+
+bool StateDelta::delta (std::ostream &os, uint32_t base)
+{
+	if (base == 0 || base > seq || base < removedSeq)
+		return false;
+
+	os << "{";
+	bool first = true;
+	for (std::vector <Device>::iterator iter = devices.begin (); iter != devices.end (); iter++)
+	{
+		if (!deviceChanged (*iter, base))
+			continue;
+		if (first)
+			first = false;
+		else
+			os << ",";
+		writeDevice (os, *iter, base);
+	}
+	os << "}";
+	return true;
+}
+
+void StateDelta::full (std::ostream &os)
+{
+	os << "{";
+	for (std::vector <Device>::iterator iter = devices.begin (); iter != devices.end (); iter++)
+	{
+		if (iter != devices.begin ())
+			os << ",";
+		writeDevice (os, *iter, 0);
+	}
+	os << "}";
+}
+
+size_t StateDelta::changedMembers (uint32_t base)
+{
+	size_t ret = 0;
+	for (std::vector <Device>::iterator iter = devices.begin (); iter != devices.end (); iter++)
+	{
+		for (int s = 0; s < 3; s++)
+		{
+			for (std::vector <Member>::iterator miter = iter->sections[s].members.begin (); miter != iter->sections[s].members.end (); miter++)
+			{
+				if (miter->changed > base)
+					ret++;
+			}
+		}
+	}
+	return ret;
+}
@@ -25,6 +25,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+// do not push values to script which does not read them
+#define PUSH_UNREAD_LIMIT    8192
+
 using namespace rts2script;
 
 ConnExe::ConnExe (rts2core::Block *_master, const char *_exec, bool fillConnEnv, int timeout):rts2core::ConnFork (_master, _exec, fillConnEnv, true, timeout)
@@ -149,17 +152,28 @@ void ConnExe::processCommand (char *cmd)
 			((rts2core::Daemon *) master)->sendValueAll (val);
 		}
 	}
+	else if (!strcmp (cmd, "MV"))
+	{
+		if (!checkActive ())
+			return;
+		// device value operator operand quadruplets, operands with spaces must be quoted
+		while (!paramEnd ())
+		{
+			if (paramNextString (&device) || paramNextString (&value) || paramNextString (&operat) || paramNextOperand (&operand))
+				throw rts2core::Error ("MV expects device, value, operator and operand");
+			rts2core::Connection *conn = getConnectionForScript (device);
+			if (conn)
+			{
+				conn->queCommand (new rts2core::CommandChangeValue (conn->getOtherDevClient ()->getMaster (), std::string (value), *operat, std::string (operand), true));
+			}
+		}
+	}
 	else if (!strcmp (cmd, "G"))
 	{
 		if (paramNextString (&device) || paramNextString (&value) || master == NULL)
 			return;
 
-		rts2core::Value *val = NULL;
-
-		if (isCentraldName (device))
-			val = master->getSingleCentralConn ()->getValue (value);
-		else
-			val = master->getValue (device, value);
+		rts2core::Value *val = getValueForScript (device, value);
 
 		if (val)
 		{
@@ -171,6 +185,59 @@ void ConnExe::processCommand (char *cmd)
 			writeToProcess ("ERR");
 		}
 	}
+	else if (!strcmp (cmd, "MG"))
+	{
+		if (master == NULL)
+			return;
+		// reply with a line for each device value pair
+		std::ostringstream _os;
+		while (!paramEnd ())
+		{
+			if (_os.tellp () > 0)
+				_os << "\n";
+			rts2core::Value *val = NULL;
+			if (!paramNextString (&device) && !paramNextString (&value))
+				val = getValueForScript (device, value);
+			if (val)
+				_os << val->getValue ();
+			else
+				_os << "ERR";
+		}
+		writeToProcess (_os.str ().c_str ());
+	}
+	else if (!strcmp (cmd, "subscribe"))
+	{
+		if (master == NULL)
+			return;
+		// pushes are throttled by amount of unread data
+		if (getUnreadInput () < 0)
+		{
+			writeToProcess ("ERR");
+			return;
+		}
+		std::ostringstream _os;
+		while (!paramEnd ())
+		{
+			if (paramNextString (&device) || paramNextString (&value))
+				throw rts2core::Error ("subscribe expects device value pairs");
+			subscribe (device, value, _os);
+		}
+		if (_os.tellp () > 0)
+			_os << "\n";
+		_os << subscriptions.size ();
+		writeToProcess (_os.str ().c_str ());
+	}
+	else if (!strcmp (cmd, "unsubscribe"))
+	{
+		if (paramEnd ())
+			subscriptions.clear ();
+		while (!paramEnd ())
+		{
+			if (paramNextString (&device) || paramNextString (&value))
+				throw rts2core::Error ("unsubscribe expects device value pairs");
+			unsubscribe (device, value);
+		}
+	}
 	else if (!strcmp (cmd, "get_own"))
 	{
 		if (paramNextString (&value) || master == NULL)
@@ -592,6 +659,23 @@ void ConnExe::processLine ()
 	}
 }
 
+int ConnExe::idle ()
+{
+	if (!subscriptions.empty ())
+	{
+		int unread = getUnreadInput ();
+		if (unread >= 0 && unread < PUSH_UNREAD_LIMIT)
+		{
+			std::ostringstream _os;
+			for (std::list <Subscription>::iterator iter = subscriptions.begin (); iter != subscriptions.end (); iter++)
+				pushValue (*iter, _os);
+			if (_os.tellp () > 0)
+				writeToProcess (_os.str ().c_str ());
+		}
+	}
+	return rts2core::ConnFork::idle ();
+}
+
 void ConnExe::processErrorLine (char *errbuf)
 {
 	logStream (MESSAGE_ERROR) << "from script " << getExePath () << " received " << errbuf << sendLog;
@@ -604,6 +688,92 @@ rts2core::Connection *ConnExe::getConnectionForScript (const char *_name)
 	return getMaster ()->getOpenConnection (_name);
 }
 
+rts2core::Value *ConnExe::getValueForScript (const char *device, const char *value)
+{
+	if (master == NULL)
+		return NULL;
+	if (isCentraldName (device))
+	{
+		rts2core::Connection *conn = master->getSingleCentralConn ();
+		return conn ? conn->getValue (value) : NULL;
+	}
+	return master->getValue (device, value);
+}
+
+void ConnExe::subscribe (const char *device, const char *value, std::ostringstream &_os)
+{
+	std::list <Subscription>::iterator iter;
+	for (iter = subscriptions.begin (); iter != subscriptions.end (); iter++)
+	{
+		if (iter->device == device && iter->value == value)
+			break;
+	}
+	if (iter == subscriptions.end ())
+	{
+		Subscription sub;
+		sub.device = std::string (device);
+		sub.value = std::string (value);
+		sub.sent = false;
+		iter = subscriptions.insert (subscriptions.end (), sub);
+	}
+	// script expects current value after subscribe
+	iter->sent = false;
+	pushValue (*iter, _os);
+}
+
+void ConnExe::unsubscribe (const char *device, const char *value)
+{
+	for (std::list <Subscription>::iterator iter = subscriptions.begin (); iter != subscriptions.end ();)
+	{
+		if (iter->device == device && iter->value == value)
+			iter = subscriptions.erase (iter);
+		else
+			iter++;
+	}
+}
+
+int ConnExe::paramNextOperand (char **str)
+{
+	while (isspace (*command_buf_top))
+		command_buf_top++;
+	if (*command_buf_top != '"')
+		return paramNextString (str);
+	command_buf_top++;
+	*str = command_buf_top;
+	// unescape in place
+	char *out = command_buf_top;
+	while (*command_buf_top && *command_buf_top != '"')
+	{
+		if (*command_buf_top == '\\' && (command_buf_top[1] == '"' || command_buf_top[1] == '\\'))
+			command_buf_top++;
+		*out = *command_buf_top;
+		out++;
+		command_buf_top++;
+	}
+	if (*command_buf_top)
+		command_buf_top++;
+	*out = '\0';
+	return 0;
+}
+
+bool ConnExe::pushValue (Subscription &sub, std::ostringstream &_os)
+{
+	rts2core::Value *val = getValueForScript (sub.device.c_str (), sub.value.c_str ());
+	if (val == NULL)
+		return false;
+	const char *v = val->getValue ();
+	if (v == NULL)
+		v = "";
+	if (sub.sent && sub.last == v)
+		return false;
+	sub.last = std::string (v);
+	sub.sent = true;
+	if (_os.tellp () > 0)
+		_os << "\n";
+	_os << "@ " << sub.device << " " << sub.value << " " << v;
+	return true;
+}
+
 int ConnExe::getDeviceType (const char *_name)
 {
 	#define NUMTYPES   13
@@ -558,6 +558,13 @@ void ElementWhileSod::printScript (std::ostream &os)
 	ElementBlock::printScript (os);
 }
 
+ElementWhile::ElementWhile (Script * _script, rts2operands::Operand *_condition, int _max_cycles):ElementBlock (_script), compiledCondition (_script->getMaster ())
+{
+	condition = _condition;
+	condition->compile (compiledCondition);
+	max_cycles = _max_cycles;
+}
+
 void ElementWhile::printScript (std::ostream &os)
 {
 	os << COMMAND_BLOCK_WHILE " " << max_cycles;
@@ -566,7 +573,20 @@ void ElementWhile::printScript (std::ostream &os)
 
 bool ElementWhile::endLoop ()
 {
-	return getLoopCount () >= max_cycles || condition->getDouble () == 0;
+	return getLoopCount () >= max_cycles || compiledCondition.evaluate () == 0;
+}
+
+ElementDo::ElementDo (Script *_script, int _max_cycles):ElementBlock (_script), compiledCondition (_script->getMaster ())
+{
+	max_cycles = _max_cycles;
+	condition = NULL;
+}
+
+void ElementDo::setCondition (rts2operands::Operand *_condition)
+{
+	condition = _condition;
+	compiledCondition.clear ();
+	condition->compile (compiledCondition);
 }
 
 void ElementDo::printScript (std::ostream &os)
@@ -579,7 +599,7 @@ bool ElementDo::endLoop ()
 {
 	if (getLoopCount () == 0)
 		return false;
-	return getLoopCount () >= max_cycles || condition->getDouble () == 0;
+	return getLoopCount () >= max_cycles || compiledCondition.evaluate () == 0;
 }
 
 void ElementOnce::printScript (std::ostream &os)
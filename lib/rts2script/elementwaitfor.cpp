@@ -21,7 +21,7 @@
 
 using namespace rts2script;
 
-ElementWaitFor::ElementWaitFor (Script * _script, const char *new_device, char *_valueName, double _tarval, double _range):Element (_script)
+ElementWaitFor::ElementWaitFor (Script * _script, const char *new_device, char *_valueName, double _tarval, double _range):Element (_script), binding (new_device, _valueName)
 {
 	valueName = std::string (_valueName);
 	deviceName = new char[strlen (new_device) + 1];
@@ -39,7 +39,7 @@ int ElementWaitFor::defnextCommand (rts2core::DevClient * client, rts2core::Comm
 
 int ElementWaitFor::idle ()
 {
-	rts2core::Value *val = script->getMaster ()->getValue (deviceName, valueName.c_str ());
+	rts2core::Value *val = binding.getValue (script->getMaster ());
 	if (!val)
 	{
 		NetworkAddress *add = script->getMaster ()->findAddress (deviceName);
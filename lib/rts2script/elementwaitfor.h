@@ -21,6 +21,7 @@
 #define __RTS2_WAITFOR__
 
 #include "rts2script/script.h"
+#include "compiledexpression.h"
 
 namespace rts2script
 {
@@ -41,6 +42,8 @@ class ElementWaitFor:public Element
 		virtual void printScript (std::ostream &os) { os << COMMAND_WAITFOR << " " << valueName << " " << tarval << " " << range; }
 	private:
 		std::string valueName;
+		// value pointer, looked up again when connections change
+		rts2expression::ValueBinding binding;
 		double tarval;
 		double range;
 };
@@ -704,6 +704,12 @@ void DevClientTelescopeExec::checkInterChange ()
 		getMaster ()->postEvent (new rts2core::Event (EVENT_ENTER_WAIT));
 }
 
+void DevClientTelescopeExec::moveStart (bool correcting)
+{
+	DevClientTelescopeImage::moveStart (correcting);
+	getMaster ()->postEvent (new rts2core::Event (EVENT_MOVE_STARTED));
+}
+
 void DevClientTelescopeExec::moveEnd ()
 {
 	if (moveWasCorrecting)
@@ -41,6 +41,7 @@ QueuedTarget::QueuedTarget (unsigned int _queue_id, rts2db::Target * _target, do
 	rep_separation = _rep_separation;
 
 	unobservable_reported = false;
+	simulStarted = false;
 
 	create ();
 }
@@ -49,6 +50,8 @@ QueuedTarget::QueuedTarget (unsigned int _queue_id, unsigned int _qid, struct ln
 {
 	load ();
 	target = createTarget (tar_id, observer, obs_altitude);
+	unobservable_reported = false;
+	simulStarted = false;
 }
 
 /**
@@ -173,8 +176,8 @@ void TargetQueue::beforeChange (double now)
 						front ().t_start = now + front ().rep_separation;
 					}
 				}
-				push_back (QueuedTarget (front (), createTarget (front ().target->getTargetID (), *observer, obs_altitude)));
-				delete front ().target;
+				push_back (QueuedTarget (front (), reloadTarget (front ().target)));
+				releaseTarget (front ().target);
 				pop_front ();
 			}
 			break;
@@ -191,8 +194,8 @@ void TargetQueue::beforeChange (double now)
 				{
 					front ().t_start = now + front ().rep_separation;
 				}
-				push_back (QueuedTarget (front (), createTarget (front ().target->getTargetID (), *observer, obs_altitude)));
-				delete front ().target;
+				push_back (QueuedTarget (front (), reloadTarget (front ().target)));
+				releaseTarget (front ().target);
 				pop_front ();
 			}
 			break;
@@ -429,7 +432,7 @@ void TargetQueue::filterExpired (double now)
 		double t_end = iter->t_end;
 		if (!std::isnan (t_end) && t_end <= now)
 			iter = removeEntry (iter, REMOVED_TIMES_EXPIRED);
-		else if (iter->target->observationStarted () && getRemoveAfterExecution () == true)
+		else if (observationStarted (*iter) && getRemoveAfterExecution () == true)
 		  	iter = removeEntry (iter, REMOVED_STARTED);
 		else  
 			iter++;
@@ -469,7 +472,7 @@ void TargetQueue::filterUnobservable (double now, double maxLength, std::list <Q
 					cameras->load ();
 				}
 				// calculate target script length..
-				double tl = getMaximalDuration (iter->target, NULL, iter->target->observationStarted () ? 1 : 0);
+				double tl = getMaximalDuration (iter->target, NULL, observationStarted (*iter) ? 1 : 0);
 				// if target will fit into available time, and target isAbove..
 				if (((getRemoveAfterExecution () == false && removeObserved == false) || tl < maxLength) && isAboveHorizon (*iter, tjd))
 					return;
@@ -483,7 +486,7 @@ void TargetQueue::filterUnobservable (double now, double maxLength, std::list <Q
 					case QUEUE_CIRCULAR:
 						break;
 					default:
-						if (!(std::isnan (iter->t_start) && std::isnan (iter->t_end)) && iter->target->observationStarted ())
+						if (!(std::isnan (iter->t_start) && std::isnan (iter->t_end)) && observationStarted (*iter))
 						{
 							logStream (MESSAGE_WARNING) << "target " << iter->target->getTargetName () << " (" << iter->target->getTargetID () << ") was observed, and as it has specified start or end times (" << LibnovaDateDouble (iter->t_start) << " to " << LibnovaDateDouble (iter->t_end) << "), and queue is not circular (" << getQueueType () << "), it will be removed" << sendLog;
 							iter->remove ();
@@ -826,8 +829,8 @@ int ExecutorQueue::selectNextSimulation (SimulQueueTargets &sq, double from, dou
 		time_t tn = from;
 		double JD = ln_get_julian_from_timet (&tn);
 		sq.front ().target->getPosition (nextp, JD);
-		double md = getMaximalDuration (sq.front ().target, currentp);
-		if (isAboveHorizon (sq.front(), JD) && sq.front ().notExpired (from) && from + md < to)
+		double md = sq.getMaximalDuration (sq.front ().target, currentp);
+		if (sq.isAboveHorizon (sq.front(), JD) && sq.front ().notExpired (from) && from + md < to)
 		{
 		  	// single execution?
 			if (removeAfterExecution->getValueBool ())
@@ -844,8 +847,8 @@ int ExecutorQueue::selectNextSimulation (SimulQueueTargets &sq, double from, dou
 				// or to time when target will become unacessible
 				else
 				{
-					e_end = sq.front ().target->getSatisfiedDuration (from, to, md, 60);
-					if (std::isnan (e_end))
+					e_end = sq.getSatisfiedDuration (sq.front ().target, from, to, md);
+					if (std::isnan (e_end) || e_end > to)
 						e_end = to;
 				}
 			}
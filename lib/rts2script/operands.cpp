@@ -27,6 +27,16 @@ double Operand::getDouble ()
 	throw rts2script::ParsingError ("Operand does not support conversion to double");
 }
 
+static double operandDouble (void *arg)
+{
+	return ((Operand *) arg)->getDouble ();
+}
+
+void Operand::compile (rts2expression::CompiledExpression &program)
+{
+	program.pushCall (operandDouble, this);
+}
+
 double SystemValue::getDouble ()
 {
 	rts2core::Connection *conn = master->getOpenConnection (device.c_str ());
@@ -258,6 +268,30 @@ double OperandsLREquation::getDouble ()
 	throw rts2script::ParsingError (_os.str ());
 }
 
+void OperandsLREquation::compile (rts2expression::CompiledExpression &program)
+{
+	l->compile (program);
+	r->compile (program);
+	switch (cmp)
+	{
+		case CMP_EQUAL:
+			program.pushOp (rts2expression::EQU);
+			break;
+		case CMP_LESS:
+			program.pushOp (rts2expression::LT);
+			break;
+		case CMP_LESS_EQU:
+			program.pushOp (rts2expression::LEQU);
+			break;
+		case CMP_GREAT_EQU:
+			program.pushOp (rts2expression::GEQU);
+			break;
+		case CMP_GREAT:
+			program.pushOp (rts2expression::GT);
+			break;
+	}
+}
+
 const char* OperandsLREquation::getCmpSymbol ()
 {
 	const char *cmp_sym[] = { "==", "<", "<=", ">=", ">" };
@@ -18,11 +18,118 @@
  */
 
 #include "rts2script/simulque.h"
+#include "rts2db/constraints.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/time.h>
 
 using namespace rts2plan;
 
-SimulQueueTargets::SimulQueueTargets (ExecutorQueue &eq):TargetQueue (eq.master, eq.observer, eq.obs_altitude)
+SimulTarget::SimulTarget (rts2db::Target *_target, rts2db::CamList &cameras, struct ln_lnlat_posn *observer, double from, double to, double step)
+{
+	target = _target;
+
+	for (rts2db::CamList::iterator cam = cameras.begin (); cam != cameras.end (); cam++)
+	{
+		rts2script::Script *script = new rts2script::Script ();
+		try
+		{
+			script->setTarget (cam->c_str (), target);
+		}
+		catch (rts2core::Error &er)
+		{
+			logStream (MESSAGE_ERROR) << "cannot load script for target " << target->getTargetID () << " and camera " << *cam << ": " << er << sendLog;
+			delete script;
+			script = NULL;
+		}
+		scripts.push_back (script);
+	}
+
+	time_t tf = from;
+	JDfrom = ln_get_julian_from_timet (&tf);
+	JDstep = step / 86400.0;
+
+	size_t n = ceil ((to - from) / step) + 1;
+	aboveHorizon.resize (n);
+	satisfied.resize (n);
+
+	struct ln_hrz_posn hrz;
+	rts2db::ConstraintsList violated;
+	for (size_t i = 0; i < n; i++)
+	{
+		double JD = JDfrom + i * JDstep;
+		target->getAltAz (&hrz, JD, observer);
+		aboveHorizon[i] = target->isAboveHorizon (&hrz);
+		violated.clear ();
+		satisfied[i] = target->getViolatedConstraints (JD, violated) == 0;
+	}
+}
+
+SimulTarget::~SimulTarget ()
+{
+	for (std::vector <rts2script::Script *>::iterator iter = scripts.begin (); iter != scripts.end (); iter++)
+		delete *iter;
+	delete target;
+}
+
+double SimulTarget::getMaximalDuration (struct ln_equ_posn *currentp, int runnum)
+{
+	double md = 0;
+	for (std::vector <rts2script::Script *>::iterator iter = scripts.begin (); iter != scripts.end (); iter++)
+	{
+		if (*iter == NULL)
+			return NAN;
+		double d = (*iter)->getExpectedDuration (currentp, runnum);
+		if (d > md)
+			md = d;
+	}
+	return md;
+}
+
+bool SimulTarget::isVisible (double JD, bool testConstraints)
+{
+	int i = gridIndex (JD);
+	if (i < 0)
+		return false;
+	return aboveHorizon[i] && (!testConstraints || satisfied[i]);
+}
+
+double SimulTarget::getSatisfiedDuration (double from, double to, double length)
+{
+	time_t fti = (time_t) to;
+	double to_JD = ln_get_julian_from_timet (&fti);
+	fti = (time_t) (from + length);
+	double from_JD = ln_get_julian_from_timet (&fti);
+
+	for (double t = from_JD; t < to_JD; t += JDstep)
+	{
+		int i = gridIndex (t);
+		if (i < 0 || !satisfied[i])
+		{
+			if (t == from_JD)
+				return NAN;
+			time_t ret;
+			ln_get_timet_from_julian (t, &ret);
+			return ret;
+		}
+	}
+	return INFINITY;
+}
+
+int SimulTarget::gridIndex (double JD)
 {
+	// allow for rounding errors of JD calculations
+	double i = floor ((JD - JDfrom) / JDstep + 1e-6);
+	if (i < 0 || i >= satisfied.size ())
+		return -1;
+	return (int) i;
+}
+
+SimulQueueTargets::SimulQueueTargets (ExecutorQueue &eq, SimulQueue *_simul):TargetQueue (eq.master, eq.observer, eq.obs_altitude)
+{
+	simul = _simul;
+
   	queueType = eq.getQueueType ();
 	removeAfterExecution = eq.getRemoveAfterExecution ();
 	skipBelowHorizon = eq.getSkipBelowHorizon ();
@@ -31,7 +138,14 @@ SimulQueueTargets::SimulQueueTargets (ExecutorQueue &eq):TargetQueue (eq.master,
 	checkTargetLength = eq.getCheckTargetLength ();
 
 	for (ExecutorQueue::iterator qi = eq.begin (); qi != eq.end (); qi++)
-		push_back ( QueuedTarget (*qi, createTarget (qi->target->getTargetID(), *observer, obs_altitude) ) );
+	{
+		SimulTarget *st = simul->getSimulTarget (qi->target->getTargetID ());
+		if (st == NULL)
+			continue;
+		push_back (QueuedTarget (*qi, st->getTarget ()));
+		// simulation must not touch database entries of the real queue
+		back ().queue_id = -1;
+	}
 }
 
 SimulQueueTargets::~SimulQueueTargets ()
@@ -40,41 +154,127 @@ SimulQueueTargets::~SimulQueueTargets ()
 
 void SimulQueueTargets::clearNext ()
 {
-	for (SimulQueueTargets::iterator iter = begin (); iter != end (); iter = erase (iter))
-		delete iter->target;
+	clear ();
 }
 
+double SimulQueueTargets::getMaximalDuration (rts2db::Target *tar, struct ln_equ_posn *currentp, int runnum)
+{
+	SimulTarget *st = simul->getSimulTarget (tar->getTargetID ());
+	if (st == NULL)
+		return NAN;
+	return st->getMaximalDuration (currentp, runnum);
+}
+
+bool SimulQueueTargets::isAboveHorizon (QueuedTarget &qt, double &JD)
+{
+	if (!std::isnan (qt.t_start))
+	{
+		time_t t = qt.t_start;
+		double njd = ln_get_julian_from_timet (&t);
+		// only change time to calculate conditions when start time is in future
+		if (njd > JD)
+			JD = njd;
+	}
+	SimulTarget *st = simul->getSimulTarget (qt.target->getTargetID ());
+	if (st == NULL)
+		return false;
+	return st->isVisible (JD, getTestConstraints ());
+}
+
+double SimulQueueTargets::getSatisfiedDuration (rts2db::Target *tar, double from, double to, double length)
+{
+	SimulTarget *st = simul->getSimulTarget (tar->getTargetID ());
+	if (st == NULL)
+		return NAN;
+	return st->getSatisfiedDuration (from, to, length);
+}
 
 TargetQueue::iterator SimulQueueTargets::removeEntry (TargetQueue::iterator &iter, const removed_t reason)
 {
-	delete iter->target;
 	return erase (iter);
 }
 
+const double SimulQueue::visibilityStep = 60;
+
 SimulQueue::SimulQueue (rts2db::DeviceDb *_master, const char *name, struct ln_lnlat_posn **_observer, Queues *_queues):ExecutorQueue (_master, name, _observer, -1, true)
 {
 	queues = _queues;
+
+	running = false;
+	pthread_mutex_init (&mutex, NULL);
+	stopRequested = false;
+	done = false;
+	simulTime = NAN;
+	simulProgress = NAN;
+	threadLogging = false;
 }
 
 SimulQueue::~SimulQueue ()
 {
-
+	stop ();
+	clearTargets ();
+	pthread_mutex_destroy (&mutex);
 }
 
 void SimulQueue::start (double _from, double _to)
 {
+	stop ();
+
+	clearTargets ();
+
   	from = _from;
 	fr = from;
 	to = _to;
 	t = from;
 
-	sqs.clear ();
+	// load targets, their scripts and visibility
+	for (Queues::iterator qi = queues->begin (); qi != queues->end (); qi++)
+	{
+		for (ExecutorQueue::iterator iter = qi->begin (); iter != qi->end (); iter++)
+		{
+			int tar_id = iter->target->getTargetID ();
+			if (targets.find (tar_id) != targets.end ())
+				continue;
+			rts2db::Target *tar = loadTarget (tar_id);
+			if (tar == NULL)
+			{
+				logStream (MESSAGE_ERROR) << "cannot load target " << tar_id << " for simulation" << sendLog;
+				continue;
+			}
+			targets[tar_id] = new SimulTarget (tar, master->cameras, *observer, from, to, visibilityStep);
+		}
+	}
 
 	// fill in simulation queues
+	sqs.reserve (queues->size ());
 	for (Queues::iterator qi = queues->begin (); qi != queues->end (); qi++)
-		sqs.push_back (SimulQueueTargets (*qi));
+		sqs.push_back (SimulQueueTargets (*qi, this));
 
-	clear ();
+	stopRequested = false;
+	done = false;
+	simulTime = from;
+	simulProgress = 0;
+	freeStarts.clear ();
+	freeEnds.clear ();
+
+	if (pthread_create (&thread, NULL, simulationThread, this))
+	{
+		logStream (MESSAGE_ERROR) << "cannot start simulation thread: " << strerror (errno) << sendLog;
+		return;
+	}
+	running = true;
+}
+
+void SimulQueue::stop ()
+{
+	if (!running)
+		return;
+	pthread_mutex_lock (&mutex);
+	stopRequested = true;
+	pthread_mutex_unlock (&mutex);
+	pthread_join (thread, NULL);
+	running = false;
+	logMessages ();
 }
 
 double SimulQueue::step ()
@@ -107,10 +307,10 @@ double SimulQueue::step ()
 						
 				}
 				t = e_end;
-				rts2db::Target *tar = createTarget (n_id, *observer, obs_altitude);
-				addTarget (tar, fr, t, -1, -1, false, false);
-				logStream (MESSAGE_DEBUG) << "adding to simulation:" << n_id << " " << tar->getTargetName () << " from " << LibnovaDateDouble (fr) << " to " << LibnovaDateDouble (t) << sendLog;
-				sq->front ().target->startObservation ();
+				// queue values are updated from the main thread after simulation ends
+				push_back (QueuedTarget (-1, sq->front ().target, fr, t));
+				logStream (MESSAGE_DEBUG) << "adding to simulation:" << n_id << " " << sq->front ().target->getTargetName () << " from " << LibnovaDateDouble (fr) << " to " << LibnovaDateDouble (t) << sendLog;
+				sq->front ().simulStarted = true;
 				sq->beforeChange (t);
 				found = true;
 				currentp.ra = nextp.ra;
@@ -137,7 +337,139 @@ double SimulQueue::step ()
 	for (sq = sqs.begin (); sq != sqs.end (); sq++)
 		sq->clearNext ();
 
-	updateVals ();
-
 	return 2;
 }
+
+double SimulQueue::progress (double &time, std::vector <double> &starts, std::vector <double> &ends)
+{
+	if (!running)
+		return NAN;
+
+	pthread_mutex_lock (&mutex);
+	time = simulTime;
+	double ret = done ? 2 : simulProgress;
+	starts.swap (freeStarts);
+	ends.swap (freeEnds);
+	freeStarts.clear ();
+	freeEnds.clear ();
+	pthread_mutex_unlock (&mutex);
+
+	if (ret == 2)
+	{
+		pthread_join (thread, NULL);
+		running = false;
+		updateVals ();
+	}
+
+	logMessages ();
+
+	return ret;
+}
+
+double SimulQueue::getSimulationTime ()
+{
+	pthread_mutex_lock (&mutex);
+	double ret = simulTime;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+bool SimulQueue::queueMessage (messageType_t type, const char *msg)
+{
+	pthread_mutex_lock (&mutex);
+	bool ret = threadLogging && pthread_equal (pthread_self (), loggingThread);
+	if (ret)
+		messages.push_back (std::pair <messageType_t, std::string> (type, msg));
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+void SimulQueue::logMessages ()
+{
+	std::vector <std::pair <messageType_t, std::string> > msgs;
+	pthread_mutex_lock (&mutex);
+	msgs.swap (messages);
+	pthread_mutex_unlock (&mutex);
+
+	for (std::vector <std::pair <messageType_t, std::string> >::iterator iter = msgs.begin (); iter != msgs.end (); iter++)
+		logStream (iter->first) << iter->second << sendLog;
+}
+
+SimulTarget *SimulQueue::getSimulTarget (int tar_id)
+{
+	std::map <int, SimulTarget *>::iterator iter = targets.find (tar_id);
+	if (iter == targets.end ())
+		return NULL;
+	return iter->second;
+}
+
+void *SimulQueue::simulationThread (void *arg)
+{
+	((SimulQueue *) arg)->run ();
+	return NULL;
+}
+
+void SimulQueue::run ()
+{
+	struct timeval tv1, tv2;
+	gettimeofday (&tv1, NULL);
+
+	pthread_mutex_lock (&mutex);
+	loggingThread = pthread_self ();
+	threadLogging = true;
+	pthread_mutex_unlock (&mutex);
+
+	// true if no target is selected
+	bool isFree = false;
+	while (true)
+	{
+		double st = t;
+		double p = step ();
+
+		pthread_mutex_lock (&mutex);
+		if (p == 2)
+		{
+			if (isFree)
+				freeEnds.push_back (st);
+			simulTime = to;
+			done = true;
+		}
+		else
+		{
+			if (p < 0 && !isFree)
+			{
+				freeStarts.push_back (st);
+				isFree = true;
+			}
+			else if (p >= 0 && isFree)
+			{
+				freeEnds.push_back (st);
+				isFree = false;
+			}
+			simulTime = t;
+			simulProgress = fabs (p);
+		}
+		bool br = done || stopRequested;
+		pthread_mutex_unlock (&mutex);
+
+		if (br)
+			break;
+	}
+
+	gettimeofday (&tv2, NULL);
+	logStream (MESSAGE_DEBUG) << "simulation from " << LibnovaDateDouble (from) << " to " << LibnovaDateDouble (to) << " took " << (tv2.tv_sec - tv1.tv_sec) + (tv2.tv_usec - tv1.tv_usec) / 1e6 << " seconds" << sendLog;
+
+	pthread_mutex_lock (&mutex);
+	threadLogging = false;
+	pthread_mutex_unlock (&mutex);
+}
+
+void SimulQueue::clearTargets ()
+{
+	// entries use cached targets, which are deleted below
+	clear ();
+	sqs.clear ();
+	for (std::map <int, SimulTarget *>::iterator iter = targets.begin (); iter != targets.end (); iter++)
+		delete iter->second;
+	targets.clear ();
+}
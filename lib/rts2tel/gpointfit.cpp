@@ -0,0 +1,778 @@
+/*
+ * Pointing model fitting.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "gpointfit.h"
+#include "error.h"
+#include "utilsfunc.h"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+using namespace rts2telmodel;
+
+// names of basic parameters, in order of RTS2_MODEL line
+static const char *gemParams[GPOINT_GEM_PARAMS] = {"id", "me", "ma", "tf", "ih", "ch", "np", "daf", "fo"};
+static const char *altazParams[GPOINT_ALTAZ_PARAMS] = {"ia", "tn", "te", "npae", "npoa", "ie", "tf"};
+
+static double wrapAngle (double a)
+{
+	a = fmod (a + M_PI, 2 * M_PI);
+	if (a < 0)
+		a += 2 * M_PI;
+	return a - M_PI;
+}
+
+static double flipRa (double ra, double dec)
+{
+	if (fabs (dec) > 90)
+		return fmod (ra + 180, 360);
+	return ra;
+}
+
+static double flipDec (double r_dec, double dec)
+{
+	if (dec > 90)
+		return 180 - r_dec;
+	else if (dec < -90)
+		return -180 - r_dec;
+	return r_dec;
+}
+
+/**
+ * Format constant as Python float, so parameter names match gpoint names.
+ */
+static std::string pyFloat (double v)
+{
+	std::ostringstream os;
+	os.precision (12);
+	os << v;
+	std::string ret = os.str ();
+	if (ret.find_first_of (".en") == std::string::npos)
+		ret += ".0";
+	return ret;
+}
+
+/**
+ * Cholesky decomposition of n x n matrix, in place (lower triangle).
+ *
+ * @return false if matrix is not positive definite
+ */
+static bool cholesky (std::vector <double> &a, int n)
+{
+	for (int j = 0; j < n; j++)
+	{
+		double d = a[j * n + j];
+		for (int k = 0; k < j; k++)
+			d -= a[j * n + k] * a[j * n + k];
+		if (!(d > 0))
+			return false;
+		d = sqrt (d);
+		a[j * n + j] = d;
+		for (int i = j + 1; i < n; i++)
+		{
+			double s = a[i * n + j];
+			for (int k = 0; k < j; k++)
+				s -= a[i * n + k] * a[j * n + k];
+			a[i * n + j] = s / d;
+		}
+	}
+	return true;
+}
+
+static void choleskySolve (const std::vector <double> &l, int n, double *x)
+{
+	for (int i = 0; i < n; i++)
+	{
+		for (int k = 0; k < i; k++)
+			x[i] -= l[i * n + k] * x[k];
+		x[i] /= l[i * n + i];
+	}
+	for (int i = n - 1; i >= 0; i--)
+	{
+		for (int k = i + 1; k < n; k++)
+			x[i] -= l[k * n + i] * x[k];
+		x[i] /= l[i * n + i];
+	}
+}
+
+GPointFit::GPointFit (double _latitude, bool _altaz)
+{
+	latitude = _latitude;
+	altaz = _altaz;
+	varyOnly = false;
+}
+
+GPointFit::~GPointFit ()
+{
+	for (std::vector <Extra>::iterator iter = extras.begin (); iter != extras.end (); iter++)
+		delete iter->ep;
+}
+
+void GPointFit::setAltAz (bool _altaz)
+{
+	if (altaz == _altaz)
+		return;
+	if (getPoints () > 0)
+		throw rts2core::Error ("cannot mix GEM and Alt-Az alignment data");
+	altaz = _altaz;
+}
+
+void GPointFit::checkLatitude ()
+{
+	if (isnan (latitude))
+		throw rts2core::Error ("latitude was not specified, either use latitude option, or specify it in input file (on #observatory line)");
+}
+
+void GPointFit::readAlignment (std::istream &is, const char *flips)
+{
+	std::string line;
+	bool manual = false;
+
+	if (strcmp (flips, "both") && strcmp (flips, "east") && strcmp (flips, "west"))
+		throw rts2core::Error (std::string ("invalid flip selection ") + flips);
+
+	// skip first line
+	std::getline (is, line);
+	while (std::getline (is, line))
+	{
+		if (line.find_first_not_of (" \t\r") == std::string::npos)
+			continue;
+		if (line[0] == '#')
+		{
+			std::istringstream iss (line.substr (1));
+			std::string kw, lng, lat, alt;
+			iss >> kw >> lng >> lat >> alt;
+			if (iss.fail ())
+				continue;
+			if (kw == "observatory" || kw == "gem")
+				setAltAz (false);
+			else if (kw == "altaz")
+				setAltAz (true);
+			else if (kw == "altaz-manual")
+			{
+				setAltAz (true);
+				manual = true;
+			}
+			else
+				continue;
+			if (isnan (latitude))
+				latitude = atof (lat.c_str ());
+			continue;
+		}
+
+		std::istringstream iss (line);
+		std::vector <std::string> cols;
+		std::string c;
+		while (iss >> c)
+			cols.push_back (c);
+
+		if (manual)
+		{
+			// Observation MJD RA DEC ERR-ALT ERR-AZ ALT AZ
+			if (cols.size () < 8)
+				throw rts2core::Error ("invalid alignment line " + line);
+			double a_alt = atof (cols[6].c_str ());
+			double a_az_deg = atof (cols[7].c_str ());
+			addAltAz (a_az_deg, a_alt, a_az_deg + atof (cols[5].c_str ()), a_alt + atof (cols[4].c_str ()));
+			continue;
+		}
+
+		// Observation MJD LST-MNT RA-MNT DEC-MNT AXRA AXDEC RA-TRUE DEC-TRUE (or AZ, ALT)
+		if (cols.size () < 9)
+			throw rts2core::Error ("invalid alignment line " + line);
+
+		double a1 = atof (cols[3].c_str ());
+		double a2 = atof (cols[4].c_str ());
+		double r1 = atof (cols[7].c_str ());
+		double r2 = atof (cols[8].c_str ());
+
+		if (altaz)
+		{
+			addAltAz (a1, a2, r1, r2);
+		}
+		else
+		{
+			if ((flips[0] == 'e' && fabs (a2) <= 90) || (flips[0] == 'w' && fabs (a2) >= 90))
+				continue;
+			double lst = atof (cols[2].c_str ());
+			addHaDec (lst - a1, a2, lst - flipRa (r1, a2), flipDec (r2, a2));
+		}
+	}
+}
+
+void GPointFit::readAlignment (const char *fn, const char *flips)
+{
+	std::ifstream is (fn);
+	if (is.fail ())
+		throw rts2core::Error (std::string ("cannot open alignment file ") + fn);
+	readAlignment (is, flips);
+}
+
+void GPointFit::addHaDec (double _a_ha, double _a_dec, double r_ha, double r_dec)
+{
+	setAltAz (false);
+	checkLatitude ();
+
+	double lat_r = ln_deg_to_rad (latitude);
+	double ha = ln_deg_to_rad (_a_ha);
+	double dec = ln_deg_to_rad (_a_dec);
+
+	a_ha.push_back (ha);
+	a_dec.push_back (dec);
+
+	// alt-az for extra terms, azimuth from south
+	double sin_alt = sin (lat_r) * sin (dec) + cos (lat_r) * cos (dec) * cos (ha);
+	double az = atan2 (cos (dec) * sin (ha), sin (lat_r) * cos (dec) * cos (ha) - cos (lat_r) * sin (dec));
+	a_az.push_back (az < 0 ? az + 2 * M_PI : az);
+	a_el.push_back (asin (sin_alt));
+
+	d_ha.push_back (wrapAngle (ha - ln_deg_to_rad (r_ha)) * fabs (cos (dec)));
+	d_dec.push_back (dec - ln_deg_to_rad (r_dec));
+}
+
+void GPointFit::addAltAz (double _a_az, double a_alt, double r_az, double r_alt)
+{
+	setAltAz (true);
+	checkLatitude ();
+
+	double lat_r = ln_deg_to_rad (latitude);
+	double az = ln_deg_to_rad (_a_az);
+	double el = ln_deg_to_rad (a_alt);
+
+	a_az.push_back (az);
+	a_el.push_back (el);
+
+	// ha-dec for extra terms
+	a_ha.push_back (atan2 (sin (az) * cos (el), sin (lat_r) * cos (el) * cos (az) + cos (lat_r) * sin (el)));
+	a_dec.push_back (asin (sin (lat_r) * sin (el) - cos (lat_r) * cos (el) * cos (az)));
+
+	d_ha.push_back (wrapAngle (az - ln_deg_to_rad (r_az)) * cos (el));
+	d_dec.push_back (el - ln_deg_to_rad (r_alt));
+}
+
+void GPointFit::addExtra (const char *axis, const char *function, const char *terms, const char *consts)
+{
+	Extra ex;
+	ex.axis = axis;
+	std::transform (ex.axis.begin (), ex.axis.end (), ex.axis.begin (), ::tolower);
+	if (ex.axis == "alt")
+		ex.axis = "el";
+	if (ex.axis != "ha" && ex.axis != "dec" && ex.axis != "az" && ex.axis != "el")
+		throw rts2core::Error (std::string ("invalid axis name: ") + axis);
+	ex.first = (ex.axis == "ha" || ex.axis == "az");
+
+	std::vector <std::string> cs = SplitStr (std::string (consts), std::string (";"));
+	std::string cname, cdesc;
+	for (std::vector <std::string>::iterator iter = cs.begin (); iter != cs.end (); iter++)
+	{
+		char *endp;
+		double c = strtod (iter->c_str (), &endp);
+		if (endp == iter->c_str () || *endp != '\0')
+			throw rts2core::Error (std::string ("invalid constant ") + *iter);
+		if (iter != cs.begin ())
+		{
+			cname += "_";
+			cdesc += ";";
+		}
+		cname += pyFloat (c);
+		cdesc += pyFloat (c);
+	}
+	std::replace (cname.begin (), cname.end (), '.', '_');
+
+	std::string tname (terms);
+	std::replace (tname.begin (), tname.end (), ';', '_');
+
+	ex.desc = std::string (function) + "\t" + terms + "\t" + cdesc;
+	std::string name = ex.axis + "_" + function + "_" + tname + "_" + cname;
+
+	for (std::vector <Extra>::iterator iter = extras.begin (); iter != extras.end (); iter++)
+	{
+		if (iter->axis + "\t" + iter->desc == ex.axis + "\t" + ex.desc)
+			throw rts2core::Error ("duplicated extra term " + name);
+	}
+
+	ex.ep = new ExtraParam ();
+	try
+	{
+		std::istringstream is (std::string ("0 ") + function + " " + terms + " " + cdesc);
+		ex.ep->parse (is);
+	}
+	catch (rts2core::Error &er)
+	{
+		delete ex.ep;
+		throw;
+	}
+	extras.push_back (ex);
+	names.push_back (name);
+}
+
+void GPointFit::addExtra (const char *desc)
+{
+	std::vector <std::string> es = SplitStr (std::string (desc), std::string (":"));
+	if (es.size () != 4)
+		throw rts2core::Error (std::string ("invalid extra function description: ") + desc);
+	addExtra (es[0].c_str (), es[1].c_str (), es[2].c_str (), es[3].c_str ());
+}
+
+int GPointFit::findParam (const char *name)
+{
+	for (size_t i = 0; i < names.size (); i++)
+	{
+		if (names[i] == name)
+			return i;
+	}
+	return -1;
+}
+
+void GPointFit::prepare ()
+{
+	if (getPoints () == 0)
+		throw rts2core::Error ("no alignment data");
+
+	int nb = altaz ? GPOINT_ALTAZ_PARAMS : GPOINT_GEM_PARAMS;
+	const char **bn = altaz ? altazParams : gemParams;
+
+	// extra names are kept in names from addExtra
+	names.erase (names.begin (), names.end () - extras.size ());
+	names.insert (names.begin (), bn, bn + nb);
+
+	for (std::vector <Extra>::iterator iter = extras.begin (); iter != extras.end (); iter++)
+	{
+		if (altaz != (iter->axis == "az" || iter->axis == "el"))
+			throw rts2core::Error ("extra term axis " + iter->axis + " cannot be used with " + (altaz ? "Alt-Az" : "GEM") + " model");
+	}
+
+	int np = names.size ();
+	params.assign (np, 0);
+	errors.assign (np, NAN);
+	bootErrors.assign (np, NAN);
+
+	fixed.assign (np, varyOnly);
+	for (std::vector <std::string>::iterator iter = fixedNames.begin (); iter != fixedNames.end (); iter++)
+	{
+		int i = findParam (iter->c_str ());
+		if (i < 0)
+			throw rts2core::Error ("unknown parameter " + *iter);
+		fixed[i] = !varyOnly;
+	}
+
+	// partial derivatives of residuals are constant, as the model is linear in its parameters
+	size_t n = getPoints ();
+	jac_ha.assign (np, std::vector <double> (n, 0));
+	jac_dec.assign (np, std::vector <double> (n, 0));
+
+	double lat_r = ln_deg_to_rad (latitude);
+	double sin_lat = sin (lat_r);
+	double cos_lat = cos (lat_r);
+
+	double t_ha[GPOINT_GEM_PARAMS];
+	double t_dec[GPOINT_GEM_PARAMS];
+
+	std::vector <double> w (n);
+
+	for (size_t i = 0; i < n; i++)
+	{
+		if (altaz)
+		{
+			w[i] = cos (a_el[i]);
+			GPointModel::termsAltAz (a_az[i], a_el[i], t_ha, t_dec);
+			for (int j = 0; j < nb; j++)
+			{
+				jac_ha[j][i] = t_ha[j] * w[i];
+				jac_dec[j][i] = t_dec[j];
+			}
+		}
+		else
+		{
+			// GPointModel::reverse adds the terms, model predicts errors with opposite sign
+			w[i] = fabs (cos (a_dec[i]));
+			GPointModel::termsHaDec (sin_lat, cos_lat, a_ha[i], a_dec[i], t_ha, t_dec);
+			for (int j = 0; j < nb; j++)
+			{
+				jac_ha[j][i] = - t_ha[j] * w[i];
+				jac_dec[j][i] = - t_dec[j];
+			}
+		}
+	}
+
+	for (size_t e = 0; e < extras.size (); e++)
+	{
+		std::vector <double> &col = extras[e].first ? jac_ha[nb + e] : jac_dec[nb + e];
+		extras[e].ep->getBasis (n, &a_az[0], &a_el[0], &a_ha[0], &a_dec[0], &col[0]);
+		if (extras[e].first)
+		{
+			for (size_t i = 0; i < n; i++)
+				col[i] *= w[i];
+		}
+	}
+}
+
+void GPointFit::getResidual (size_t i, double &r_ha, double &r_dec)
+{
+	r_ha = d_ha[i];
+	r_dec = d_dec[i];
+	for (size_t j = 0; j < params.size (); j++)
+	{
+		r_ha += jac_ha[j][i] * params[j];
+		r_dec += jac_dec[j][i] * params[j];
+	}
+}
+
+double GPointFit::cost (const std::vector <int> *counts, const double *p)
+{
+	size_t n = getPoints ();
+	size_t np = names.size ();
+	double ret = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (counts && (*counts)[i] == 0)
+			continue;
+		double r1 = d_ha[i];
+		double r2 = d_dec[i];
+		for (size_t j = 0; j < np; j++)
+		{
+			r1 += jac_ha[j][i] * p[j];
+			r2 += jac_dec[j][i] * p[j];
+		}
+		ret += (counts ? (*counts)[i] : 1) * (r1 * r1 + r2 * r2);
+	}
+	return ret;
+}
+
+int GPointFit::lmFit (const std::vector <int> *counts, double *p, int maxfev, double ftol, double xtol, double *cov)
+{
+	size_t n = getPoints ();
+	int np = names.size ();
+
+	// free parameters with non-zero derivatives
+	std::vector <int> fi;
+	for (int j = 0; j < np; j++)
+	{
+		if (fixed[j])
+			continue;
+		double s = 0;
+		for (size_t i = 0; i < n && s == 0; i++)
+			s = fabs (jac_ha[j][i]) + fabs (jac_dec[j][i]);
+		if (s > 0)
+			fi.push_back (j);
+	}
+	int m = fi.size ();
+
+	size_t nn = 0;
+	for (size_t i = 0; i < n; i++)
+		nn += counts ? (*counts)[i] : 1;
+
+	// J^T J is constant for the linear model
+	std::vector <double> jtj (m * m, 0);
+	for (int a = 0; a < m; a++)
+	{
+		const double *ha = &(jac_ha[fi[a]][0]);
+		const double *dec = &(jac_dec[fi[a]][0]);
+		for (int b = 0; b <= a; b++)
+		{
+			const double *hb = &(jac_ha[fi[b]][0]);
+			const double *db = &(jac_dec[fi[b]][0]);
+			double s = 0;
+			for (size_t i = 0; i < n; i++)
+				s += (counts ? (*counts)[i] : 1) * (ha[i] * hb[i] + dec[i] * db[i]);
+			jtj[a * m + b] = jtj[b * m + a] = s;
+		}
+	}
+
+	double c = cost (counts, p);
+	int nfev = 1;
+
+	double lambda = 1e-3;
+	std::vector <double> r1 (n), r2 (n), g (m), a (m * m), step (m), pn (p, p + np);
+
+	while (m > 0 && nfev < maxfev)
+	{
+		// gradient J^T r
+		for (size_t i = 0; i < n; i++)
+		{
+			r1[i] = d_ha[i];
+			r2[i] = d_dec[i];
+			for (int j = 0; j < np; j++)
+			{
+				r1[i] += jac_ha[j][i] * p[j];
+				r2[i] += jac_dec[j][i] * p[j];
+			}
+			if (counts)
+			{
+				r1[i] *= (*counts)[i];
+				r2[i] *= (*counts)[i];
+			}
+		}
+		for (int k = 0; k < m; k++)
+		{
+			double s = 0;
+			for (size_t i = 0; i < n; i++)
+				s += jac_ha[fi[k]][i] * r1[i] + jac_dec[fi[k]][i] * r2[i];
+			g[k] = s;
+		}
+
+		bool accepted = false;
+		double cn = c;
+		while (nfev < maxfev && lambda < 1e20)
+		{
+			a = jtj;
+			for (int k = 0; k < m; k++)
+				a[k * m + k] *= 1 + lambda;
+			if (!cholesky (a, m))
+			{
+				lambda *= 10;
+				continue;
+			}
+			for (int k = 0; k < m; k++)
+				step[k] = -g[k];
+			choleskySolve (a, m, &step[0]);
+
+			for (int k = 0; k < m; k++)
+				pn[fi[k]] = p[fi[k]] + step[k];
+			cn = cost (counts, &pn[0]);
+			nfev++;
+			if (cn <= c)
+			{
+				accepted = true;
+				break;
+			}
+			lambda *= 10;
+		}
+		if (!accepted)
+			break;
+
+		double snorm = 0, pnorm = 0;
+		for (int k = 0; k < m; k++)
+		{
+			snorm += step[k] * step[k];
+			pnorm += pn[fi[k]] * pn[fi[k]];
+			p[fi[k]] = pn[fi[k]];
+		}
+		bool conv = (c - cn <= ftol * c) || (sqrt (snorm) <= xtol * (sqrt (pnorm) + xtol));
+		c = cn;
+		lambda /= 10;
+		if (conv)
+			break;
+	}
+
+	if (cov)
+	{
+		for (int j = 0; j < np; j++)
+			cov[j] = NAN;
+		a = jtj;
+		if (m > 0 && cholesky (a, m) && (long) (2 * nn) > m)
+		{
+			double s2 = c / (2 * nn - m);
+			for (int k = 0; k < m; k++)
+			{
+				std::vector <double> e (m, 0);
+				e[k] = 1;
+				choleskySolve (a, m, &e[0]);
+				cov[fi[k]] = e[k] * s2;
+			}
+		}
+		for (int j = 0; j < np; j++)
+			if (fixed[j])
+				cov[j] = 0;
+	}
+
+	return nfev;
+}
+
+int GPointFit::fit (int maxfev, double ftol, double xtol)
+{
+	prepare ();
+	std::vector <double> cov (params.size ());
+	int ret = lmFit (NULL, &params[0], maxfev, ftol, xtol, &cov[0]);
+	for (size_t j = 0; j < params.size (); j++)
+		errors[j] = sqrt (cov[j]);
+	return ret;
+}
+
+namespace rts2telmodel
+{
+
+struct BootstrapData
+{
+	GPointFit *fit;
+	int samples;
+	unsigned int seed;
+	int next;
+	std::vector <double> *results;
+};
+
+void *bootstrapThread (void *arg)
+{
+	BootstrapData *bd = (BootstrapData *) arg;
+	GPointFit *f = bd->fit;
+	size_t n = f->getPoints ();
+	size_t np = f->params.size ();
+	std::vector <int> counts (n);
+
+	while (true)
+	{
+		int s = __sync_fetch_and_add (&(bd->next), 1);
+		if (s >= bd->samples)
+			break;
+		// seed depends only on sample number, so results does not depend on threads
+		unsigned int rs = bd->seed + s * 2654435761u;
+		counts.assign (n, 0);
+		for (size_t i = 0; i < n; i++)
+			counts[rand_r (&rs) % n]++;
+		double *p = &((*bd->results)[s * np]);
+		std::copy (f->params.begin (), f->params.end (), p);
+		f->lmFit (&counts, p, 100, 1.49012e-08, 1.49012e-08, NULL);
+	}
+	return NULL;
+}
+
+}
+
+void GPointFit::bootstrap (int samples, int threads, unsigned int seed)
+{
+	if (params.empty ())
+		throw rts2core::Error ("model must be fitted before bootstrap");
+	if (samples < 2)
+		throw rts2core::Error ("at least two bootstrap samples are needed");
+
+	if (threads <= 0)
+		threads = sysconf (_SC_NPROCESSORS_ONLN);
+	if (threads <= 0)
+		threads = 1;
+	if (threads > samples)
+		threads = samples;
+
+	size_t np = params.size ();
+	std::vector <double> results (samples * np);
+
+	BootstrapData bd;
+	bd.fit = this;
+	bd.samples = samples;
+	bd.seed = seed;
+	bd.next = 0;
+	bd.results = &results;
+
+	std::vector <pthread_t> th (threads);
+	int started = 0;
+	for (int t = 1; t < threads; t++)
+	{
+		if (pthread_create (&th[t], NULL, bootstrapThread, &bd))
+			break;
+		started++;
+	}
+	bootstrapThread (&bd);
+	for (int t = 1; t <= started; t++)
+		pthread_join (th[t], NULL);
+
+	for (size_t j = 0; j < np; j++)
+	{
+		double sum = 0, sum2 = 0;
+		for (int s = 0; s < samples; s++)
+			sum += results[s * np + j];
+		double mean = sum / samples;
+		for (int s = 0; s < samples; s++)
+			sum2 += (results[s * np + j] - mean) * (results[s * np + j] - mean);
+		bootErrors[j] = sqrt (sum2 / (samples - 1));
+	}
+}
+
+double GPointFit::getRMS (bool model)
+{
+	size_t n = getPoints ();
+	if (n == 0)
+		return NAN;
+	double s = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		double r1, r2;
+		if (model && !params.empty ())
+		{
+			getResidual (i, r1, r2);
+		}
+		else
+		{
+			r1 = d_ha[i];
+			r2 = d_dec[i];
+		}
+		s += r1 * r1 + r2 * r2;
+	}
+	return ln_rad_to_deg (sqrt (s / n)) * 3600.0;
+}
+
+std::ostream & GPointFit::print (std::ostream &os, char frmt)
+{
+	double mul = 3600.0;
+	char uv = '"';
+	switch (frmt)
+	{
+		case 'd':
+			mul = 1;
+			uv = 'd';
+			break;
+		case 'm':
+		case '\'':
+			mul = 60.0;
+			uv = '\'';
+			break;
+	}
+
+	int nb = params.size () - extras.size ();
+
+	std::ostringstream ms;
+	ms.precision (12);
+	ms << (altaz ? "RTS2_ALTAZ" : "RTS2_GEM");
+	for (int j = 0; j < nb; j++)
+		ms << " " << ln_rad_to_deg (params[j]) * mul << uv;
+	ms << std::endl;
+	for (size_t e = 0; e < extras.size (); e++)
+	{
+		std::string axis = extras[e].axis;
+		std::transform (axis.begin (), axis.end (), axis.begin (), ::toupper);
+		ms << axis << "\t" << ln_rad_to_deg (params[nb + e]) * mul << uv << "\t" << extras[e].desc << std::endl;
+	}
+	os << ms.str ();
+	return os;
+}
+
+std::ostream & GPointFit::printParams (std::ostream &os)
+{
+	std::ostringstream ms;
+	ms << std::fixed;
+	ms << "Name                      value(\") fixed stderr(\")";
+	bool boot = !bootErrors.empty () && !isnan (bootErrors[0]);
+	if (boot)
+		ms << " bootstrap(\")";
+	ms << std::endl;
+	for (size_t j = 0; j < params.size (); j++)
+	{
+		ms << std::left << std::setw (24) << names[j] << std::right << std::setprecision (2) << std::setw (10) << ln_rad_to_deg (params[j]) * 3600.0
+			<< "    " << (fixed[j] ? "*  " : "   ") << std::setw (9) << ln_rad_to_deg (errors[j]) * 3600.0;
+		if (boot)
+			ms << std::setw (13) << ln_rad_to_deg (bootErrors[j]) * 3600.0;
+		ms << std::endl;
+	}
+	os << ms.str ();
+	return os;
+}
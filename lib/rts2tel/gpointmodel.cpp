@@ -22,6 +22,7 @@
 #include "error.h"
 
 #include <math.h>
+#include <algorithm>
 #include <fstream>
 
 using namespace rts2telmodel;
@@ -203,56 +204,95 @@ double ExtraParam::getParamValue (double az, double el, double ha, double dec, i
 			return ha;
 		case GPOINT_DEC:
 			return dec;
+		case GPOINT_PD:
+			// pole distance, DEC axis continues over pole for flipped telescope
+			if (dec > M_PI / 2.0)
+				dec = M_PI - dec;
+			else if (dec < -M_PI / 2.0)
+				dec = -M_PI - dec;
+			return M_PI / 2.0 - fabs (dec);
 		default:
 			return 0;
 	}
 }
 
-double ExtraParam::getValue (double az, double el, double ha, double dec)
+/**
+ * Evaluate term function. x0 and x1 are already multiplied by the constants.
+ */
+static inline double basisFunction (function_t function, double x0, double x1)
 {
 	switch (function)
 	{
 		case GPOINT_OFFSET:
-			return params[0];
+			return 1;
 		case GPOINT_SIN:
-			return params[0] * sinl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return sin (x0);
 		case GPOINT_COS:
-			return params[0] * cosl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return cos (x0);
 		case GPOINT_ABSSIN:
-			return params[0] * abs (sinl (consts[0] * getParamValue (az, el, ha, dec, 0)));
+			return fabs (sin (x0));
 		case GPOINT_ABSCOS:
-			return params[0] * abs (cosl (consts[0] * getParamValue (az, el, ha, dec, 0)));
+			return fabs (cos (x0));
 		case GPOINT_TAN:
-			return params[0] * tanl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return tan (x0);
 		case GPOINT_CSC:
-			return params[0] / cosl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / sin (x0);
 		case GPOINT_SEC:
-			return params[0] / sinl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / cos (x0);
 		case GPOINT_COT:
-			return params[0] / tanl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / tan (x0);
 		case GPOINT_SINH:
-			return params[0] * sinhl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return sinh (x0);
 		case GPOINT_COSH:
-			return params[0] * coshl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return cosh (x0);
 		case GPOINT_TANH:
-			return params[0] * tanhl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return tanh (x0);
 		case GPOINT_SECH:
-			return params[0] / sinhl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / cosh (x0);
 		case GPOINT_CSCH:
-			return params[0] / coshl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / sinh (x0);
 		case GPOINT_COTH:
-			return params[0] / tanhl (consts[0] * getParamValue (az, el, ha, dec, 0));
+			return 1.0 / tanh (x0);
 		case GPOINT_SINCOS:
-			return params[0] * sinl (consts[0] * getParamValue (az, el, ha, dec, 0)) * cosl (consts[1] * getParamValue (az, el, ha, dec, 1));
+			return sin (x0) * cos (x1);
 		case GPOINT_COSCOS:
-			return params[0] * cosl (consts[0] * getParamValue (az, el, ha, dec, 0)) * cosl (consts[1] * getParamValue (az, el, ha, dec, 1));
+			return cos (x0) * cos (x1);
 		case GPOINT_SINSIN:
-			return sinl (consts[0] * getParamValue (az, el, ha, dec, 0)) * sinl (consts[1] * getParamValue (az, el, ha, dec, 1));
+			return sin (x0) * sin (x1);
 		default:
 			return 0;
 	}
 }
 
+static inline bool twoTerms (function_t function)
+{
+	return function == GPOINT_SINCOS || function == GPOINT_COSCOS || function == GPOINT_SINSIN;
+}
+
+double ExtraParam::getBasis (double az, double el, double ha, double dec)
+{
+	double x0 = consts[0] * getParamValue (az, el, ha, dec, 0);
+	double x1 = twoTerms (function) ? consts[1] * getParamValue (az, el, ha, dec, 1) : 0;
+	return basisFunction (function, x0, x1);
+}
+
+void ExtraParam::getBasis (size_t n, const double *az, const double *el, const double *ha, const double *dec, double *basis)
+{
+	size_t i;
+	double c0 = consts[0];
+	if (twoTerms (function))
+	{
+		double c1 = consts[1];
+		for (i = 0; i < n; i++)
+			basis[i] = basisFunction (function, c0 * getParamValue (az[i], el[i], ha[i], dec[i], 0), c1 * getParamValue (az[i], el[i], ha[i], dec[i], 1));
+	}
+	else
+	{
+		for (i = 0; i < n; i++)
+			basis[i] = basisFunction (function, c0 * getParamValue (az[i], el[i], ha[i], dec[i], 0), 0);
+	}
+}
+
 std::string ExtraParam::toString (char frmt)
 {
 	std::ostringstream os;
@@ -264,7 +304,7 @@ std::string ExtraParam::toString (char frmt)
 GPointModel::GPointModel (double in_latitude):TelModel (in_latitude)
 {
 	altaz = false;
-	for (int i = 0; i < 9; i++)
+	for (int i = 0; i < GPOINT_GEM_PARAMS; i++)
 		params[i] = 0;
 }
 
@@ -292,21 +332,96 @@ int GPointModel::load (const char *modelFile)
 	return 0;
 }
 
+void GPointModel::termsHaDec (double sin_lat, double cos_lat, double ha, double dec, double *t_ha, double *t_dec)
+{
+	double sin_ha = sin (ha);
+	double cos_ha = cos (ha);
+	double sin_dec = sin (dec);
+	double cos_dec = cos (dec);
+	double tan_dec = sin_dec / cos_dec;
+
+	// id, me, ma, tf, ih, ch, np, daf, fo
+	t_dec[0] = 1;
+	t_dec[1] = cos_ha;
+	t_dec[2] = sin_ha;
+	t_dec[3] = cos_lat * sin_dec * cos_ha - sin_lat * cos_dec;
+	t_dec[4] = 0;
+	t_dec[5] = 0;
+	t_dec[6] = 0;
+	t_dec[7] = 0;
+	t_dec[8] = cos_ha;
+
+	t_ha[0] = 0;
+	t_ha[1] = sin_ha * tan_dec;
+	t_ha[2] = - cos_ha * tan_dec;
+	t_ha[3] = cos_lat * sin_ha / cos_dec;
+	t_ha[4] = 1;
+	t_ha[5] = 1 / cos_dec;
+	t_ha[6] = tan_dec;
+	t_ha[7] = sin_lat * tan_dec + cos_lat * cos_ha;
+	t_ha[8] = 0;
+}
+
+void GPointModel::termsAltAz (double az, double el, double *t_az, double *t_el)
+{
+	double sin_az = sin (az);
+	double cos_az = cos (az);
+	double cos_el = cos (el);
+	double tan_el = tan (el);
+
+	// ia, tn, te, npae, npoa, ie, tf
+	t_az[0] = -1;
+	t_az[1] = sin_az * tan_el;
+	t_az[2] = - cos_az * tan_el;
+	t_az[3] = - tan_el;
+	t_az[4] = 1 / cos_el;
+	t_az[5] = 0;
+	t_az[6] = 0;
+
+	t_el[0] = 0;
+	t_el[1] = cos_az;
+	t_el[2] = sin_az;
+	t_el[3] = 0;
+	t_el[4] = 0;
+	t_el[5] = -1;
+	t_el[6] = cos_el;
+}
+
 int GPointModel::apply (struct ln_equ_posn *pos)
 {
-	double d_tar, r_tar;
-	pos->ra = ln_deg_to_rad (pos->ra);
-	pos->dec = ln_deg_to_rad (pos->dec);
+	applyBatch (pos, 1);
+	return 0;
+}
+
+void GPointModel::applyBatch (struct ln_equ_posn *pos, size_t n)
+{
+	double t_ha[GPOINT_GEM_PARAMS];
+	double t_dec[GPOINT_GEM_PARAMS];
+	double p[GPOINT_GEM_PARAMS];
 
 	double lat_r = getLatitudeRadians ();
+	double sin_lat = sin (lat_r);
+	double cos_lat = cos (lat_r);
 
-	d_tar = pos->dec - params[0] - params[1] * cos (pos->ra) - params[2] * sin (pos->ra) - params[3] * (cos (lat_r) * sin (pos->dec) * cos (pos->ra) - sin (lat_r) * cos(pos->dec)) - params[8] * cos (pos->ra);
-	r_tar = pos->ra - params[4] - params[5] / cos (pos->dec) - params[6] * tan (pos->dec) - (params[1] * sin (pos->ra) - params[2] * cos (pos->ra)) * tan (pos->dec) - params[3] * cos (lat_r) * sin (pos->ra) / cos (pos->dec) - params[7] * (sin (lat_r) * tan (pos->dec) + cos (lat_r) * cos (pos->ra));
+	for (int j = 0; j < GPOINT_GEM_PARAMS; j++)
+		p[j] = params[j];
 
-	pos->ra = ln_rad_to_deg (r_tar);
-	pos->dec = ln_rad_to_deg (d_tar);
+	for (size_t i = 0; i < n; i++)
+	{
+		double ha_r = ln_deg_to_rad (pos[i].ra);
+		double dec_r = ln_deg_to_rad (pos[i].dec);
 
-	return 0;
+		termsHaDec (sin_lat, cos_lat, ha_r, dec_r, t_ha, t_dec);
+
+		for (int j = 0; j < GPOINT_GEM_PARAMS; j++)
+		{
+			ha_r -= p[j] * t_ha[j];
+			dec_r -= p[j] * t_dec[j];
+		}
+
+		pos[i].ra = ln_rad_to_deg (ha_r);
+		pos[i].dec = ln_rad_to_deg (dec_r);
+	}
 }
 
 int GPointModel::applyVerbose (struct ln_equ_posn *pos)
@@ -317,44 +432,77 @@ int GPointModel::applyVerbose (struct ln_equ_posn *pos)
 	return 0;
 }
 
+// size of batch processed at once by reverseBatch and getErrAltAzBatch
+#define GPOINT_CHUNK   256
+
+/**
+ * Adds value of extra parameters to the offsets.
+ */
+static void addExtras (std::list <ExtraParam *> &extras, size_t n, const double *az_r, const double *el_r, const double *ha_r, const double *dec_r, double *off)
+{
+	double basis[GPOINT_CHUNK];
+	for (std::list <ExtraParam *>::iterator it = extras.begin (); it != extras.end (); it++)
+	{
+		double m = (*it)->params[0];
+		(*it)->getBasis (n, az_r, el_r, ha_r, dec_r, basis);
+		for (size_t i = 0; i < n; i++)
+			off[i] += m * basis[i];
+	}
+}
+
 int GPointModel::reverse (struct ln_equ_posn *pos, struct ln_hrz_posn *hrz)
 {
-	double d_tar, r_tar;
-	double az_r, el_r, ha_r, dec_r;
-	az_r = ln_deg_to_rad (hrz->az);
-	el_r = ln_deg_to_rad (hrz->alt);
-	ha_r = ln_deg_to_rad (pos->ra);
-	dec_r = ln_deg_to_rad (pos->dec);
+	reverseBatch (pos, hrz, 1);
+	return 0;
+}
+
+void GPointModel::reverseBatch (struct ln_equ_posn *pos, struct ln_hrz_posn *hrz, size_t n)
+{
+	double az_r[GPOINT_CHUNK], el_r[GPOINT_CHUNK], ha_r[GPOINT_CHUNK], dec_r[GPOINT_CHUNK];
+	double r_tar[GPOINT_CHUNK], d_tar[GPOINT_CHUNK];
+	double t_ha[GPOINT_GEM_PARAMS];
+	double t_dec[GPOINT_GEM_PARAMS];
+	double p[GPOINT_GEM_PARAMS];
 
 	double lat_r = getLatitudeRadians ();
+	double sin_lat = sin (lat_r);
+	double cos_lat = cos (lat_r);
 
-	d_tar = dec_r
-		+ params[0]
-		+ params[1] * cos (ha_r)
-		+ params[2] * sin (ha_r)
-		+ params[3] * (cos (lat_r) * sin (dec_r) * cos (ha_r) - sin (lat_r) * cos(dec_r))
-		+ params[8] * cos (ha_r);
-
-	r_tar = ha_r
-		+ params[4]
-		+ params[5] / cos (dec_r)
-		+ params[6] * tan (dec_r)
-		+ (params[1] * sin (ha_r) - params[2] * cos (ha_r)) * tan (dec_r)
-		+ params[3] * cos (lat_r) * sin (ha_r) / cos (dec_r)
-		+ params[7] * (sin (lat_r) * tan (dec_r) + cos (lat_r) * cos (ha_r));
-
-	// now handle extra params
-	std::list <ExtraParam *>::iterator it;
-	for (it = extraParamsHa.begin (); it != extraParamsHa.end (); it++)
-		r_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	for (int j = 0; j < GPOINT_GEM_PARAMS; j++)
+		p[j] = params[j];
 
-	for (it = extraParamsDec.begin (); it != extraParamsDec.end (); it++)
-		d_tar += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	for (size_t s = 0; s < n; s += GPOINT_CHUNK)
+	{
+		size_t cn = std::min ((size_t) GPOINT_CHUNK, n - s);
+		size_t i;
+		for (i = 0; i < cn; i++)
+		{
+			az_r[i] = ln_deg_to_rad (hrz[s + i].az);
+			el_r[i] = ln_deg_to_rad (hrz[s + i].alt);
+			ha_r[i] = ln_deg_to_rad (pos[s + i].ra);
+			dec_r[i] = ln_deg_to_rad (pos[s + i].dec);
 
-	pos->ra = ln_rad_to_deg (r_tar);
-	pos->dec = ln_rad_to_deg (d_tar);
+			termsHaDec (sin_lat, cos_lat, ha_r[i], dec_r[i], t_ha, t_dec);
 
-	return 0;
+			r_tar[i] = ha_r[i];
+			d_tar[i] = dec_r[i];
+			for (int j = 0; j < GPOINT_GEM_PARAMS; j++)
+			{
+				r_tar[i] += p[j] * t_ha[j];
+				d_tar[i] += p[j] * t_dec[j];
+			}
+		}
+
+		// now handle extra params
+		addExtras (extraParamsHa, cn, az_r, el_r, ha_r, dec_r, r_tar);
+		addExtras (extraParamsDec, cn, az_r, el_r, ha_r, dec_r, d_tar);
+
+		for (i = 0; i < cn; i++)
+		{
+			pos[s + i].ra = ln_rad_to_deg (r_tar[i]);
+			pos[s + i].dec = ln_rad_to_deg (d_tar[i]);
+		}
+	}
 }
 
 int GPointModel::reverseVerbose (struct ln_equ_posn *pos, struct ln_hrz_posn *hrz)
@@ -368,41 +516,54 @@ int GPointModel::reverseVerbose (struct ln_equ_posn *pos, struct ln_hrz_posn *hr
 
 void GPointModel::getErrAltAz (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err)
 {
-	long double az_r, el_r, ha_r, dec_r;
-	az_r = ln_deg_to_rad (hrz->az);
-	el_r = ln_deg_to_rad (hrz->alt);
-	ha_r = ln_deg_to_rad (equ->ra);
-	dec_r = ln_deg_to_rad (equ->dec);
-
-	long double sin_az = sinl (az_r);
-	long double cos_az = cosl (az_r);
-	long double cos_el = cosl (el_r);
-	long double tan_el = tanl (el_r);
-
-	err->az = - params[0]
-		+ params[1] * sin_az  * tan_el
-		- params[2] * cos_az * tan_el
-		- params[3] * tan_el
-		+ params[4] / cos_el;
-
-	err->alt = - params[5]
-		+ params[1] * cos_az
-		+ params[2] * sin_az
-		+ params[6] * cos_el;
-
-	// now handle extra params
-	std::list <ExtraParam *>::iterator it;
-	for (it = extraParamsAz.begin (); it != extraParamsAz.end (); it++)
-		err->az += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+	getErrAltAzBatch (hrz, equ, err, 1);
+}
 
-	for (it = extraParamsEl.begin (); it != extraParamsEl.end (); it++)
-		err->alt += (*it)->getValue (az_r, el_r, ha_r, dec_r);
+void GPointModel::getErrAltAzBatch (struct ln_hrz_posn *hrz, struct ln_equ_posn *equ, struct ln_hrz_posn *err, size_t n)
+{
+	double az_r[GPOINT_CHUNK], el_r[GPOINT_CHUNK], ha_r[GPOINT_CHUNK], dec_r[GPOINT_CHUNK];
+	double e_az[GPOINT_CHUNK], e_el[GPOINT_CHUNK];
+	double t_az[GPOINT_ALTAZ_PARAMS];
+	double t_el[GPOINT_ALTAZ_PARAMS];
+	double p[GPOINT_ALTAZ_PARAMS];
+
+	for (int j = 0; j < GPOINT_ALTAZ_PARAMS; j++)
+		p[j] = params[j];
+
+	for (size_t s = 0; s < n; s += GPOINT_CHUNK)
+	{
+		size_t cn = std::min ((size_t) GPOINT_CHUNK, n - s);
+		size_t i;
+		for (i = 0; i < cn; i++)
+		{
+			az_r[i] = ln_deg_to_rad (hrz[s + i].az);
+			el_r[i] = ln_deg_to_rad (hrz[s + i].alt);
+			ha_r[i] = ln_deg_to_rad (equ[s + i].ra);
+			dec_r[i] = ln_deg_to_rad (equ[s + i].dec);
 
-	err->az = ln_rad_to_deg (err->az);
-	err->alt = ln_rad_to_deg (err->alt);
+			termsAltAz (az_r[i], el_r[i], t_az, t_el);
 
-	hrz->az += err->az;
-	hrz->alt += err->alt;
+			e_az[i] = e_el[i] = 0;
+			for (int j = 0; j < GPOINT_ALTAZ_PARAMS; j++)
+			{
+				e_az[i] += p[j] * t_az[j];
+				e_el[i] += p[j] * t_el[j];
+			}
+		}
+
+		// now handle extra params
+		addExtras (extraParamsAz, cn, az_r, el_r, ha_r, dec_r, e_az);
+		addExtras (extraParamsEl, cn, az_r, el_r, ha_r, dec_r, e_el);
+
+		for (i = 0; i < cn; i++)
+		{
+			err[s + i].az = ln_rad_to_deg (e_az[i]);
+			err[s + i].alt = ln_rad_to_deg (e_el[i]);
+
+			hrz[s + i].az += err[s + i].az;
+			hrz[s + i].alt += err[s + i].alt;
+		}
+	}
 }
 
 std::istream & GPointModel::load (std::istream & is)
@@ -418,12 +579,12 @@ std::istream & GPointModel::load (std::istream & is)
 
 	iss >> name;
 
-	int pn = 9;
+	int pn = GPOINT_GEM_PARAMS;
 
 	if (name == "RTS2_ALTAZ")
 	{
 		altaz = true;
-		pn = 7;
+		pn = GPOINT_ALTAZ_PARAMS;
 	}
 
 	int i = 0;
@@ -503,11 +664,11 @@ std::istream & GPointModel::load (std::istream & is)
 
 std::ostream & GPointModel::print (std::ostream & os, char frmt)
 {
-	int pn = 9;
+	int pn = GPOINT_GEM_PARAMS;
 	if (altaz)
 	{
 		os << "RTS2_ALTAZ";
-		pn = 7;
+		pn = GPOINT_ALTAZ_PARAMS;
 	}
 	else
 	{
@@ -51,15 +51,26 @@ void backstat(backstruct *backmesh,
 	      int n, int w, int bw, PIXTYPE maskthresh);
 int filterback(sep_bkg *bkg, int fw, int fh, double fthresh);
 float backguess(backstruct *bkg, float *mean, float *sigma);
+int backrows(sep_image *image, sep_bkg *bkg, int j0, int j1);
 int makebackspline(sep_bkg *bkg, float *map, float *dmap);
 
 
-int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
-                   double fthresh, sep_bkg **bkg)
+/* rows [j0, j1) of background boxes, processed by one thread */
+typedef struct {
+  sep_image *image;
+  sep_bkg   *bkg;
+  int       j0, j1;
+  int       status;
+} backrowsargs;
+
+/* Compute background and sigma of boxes in rows [j0, j1) of bkg mesh.
+ * Boxes only depend on their own pixels, so rows of boxes can be processed
+ * in parallel. */
+int backrows(sep_image *image, sep_bkg *bkg, int j0, int j1)
 {
   BYTE *imt, *maskt;
   int npix;                   /* size of image */
-  int nx, ny, nb;             /* number of background boxes in x, y, total */
+  int nx, bw, bh;             /* number of boxes in a row, box size */
   int bufsize;                /* size of a "row" of boxes in pixels (w*bh) */
   int elsize;                 /* size (in bytes) of an image array element */
   int melsize;                /* size (in bytes) of a mask array element */
@@ -67,55 +78,28 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
   PIXTYPE maskthresh;
   array_converter convert, mconvert;
   backstruct *backmesh, *bm;  /* info about each background "box" */
-  sep_bkg *bkgout;          /* output */
   int j,k,m, status;
 
   status = RETURN_OK;
   npix = image->w * image->h;
+  nx = bkg->nx;
+  bw = bkg->bw;
+  bh = bkg->bh;
   bufsize = image->w * bh;
   maskthresh = image->maskthresh;
   if (image->mask == NULL) maskthresh = 0.0;
+  melsize = 0;
 
   backmesh = bm = NULL;
-  bkgout = NULL;
   buf = mbuf = buft = mbuft = NULL;
   convert = mconvert = NULL;
 
-  /* determine number of background boxes */
-  if ((nx = (image->w - 1) / bw + 1) < 1)
-    nx = 1;
-  if ((ny = (image->h - 1) / bh + 1) < 1)
-    ny = 1;
-  nb = nx*ny;
-
   /* Allocate temp memory & initialize */
   QMALLOC(backmesh, backstruct, nx, status);
   bm = backmesh;
   for (m=nx; m--; bm++)
     bm->histo=NULL;
 
-  /* Allocate the returned struct */
-  QMALLOC(bkgout, sep_bkg, 1, status);
-  bkgout->w = image->w;
-  bkgout->h = image->h;
-  bkgout->nx = nx;
-  bkgout->ny = ny;
-  bkgout->n = nb;
-  bkgout->bw = bw;
-  bkgout->bh = bh;
-  bkgout->back = NULL;
-  bkgout->sigma = NULL;
-  bkgout->dback = NULL;
-  bkgout->dsigma = NULL;
-  QMALLOC(bkgout->back, float, nb, status);
-  QMALLOC(bkgout->sigma, float, nb, status);
-  QMALLOC(bkgout->dback, float, nb, status);
-  QMALLOC(bkgout->dsigma, float, nb, status);
-
-  /* cast input array pointers. These are used to step through the arrays. */
-  imt = (BYTE *)image->data;
-  maskt = (BYTE *)image->mask;
-
   /* get the correct array converter and element size, based on dtype code */
   status = get_array_converter(image->dtype, &convert, &elsize);
   if (status != RETURN_OK)
@@ -127,21 +111,21 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
 	goto exit;
     }
 
+  /* cast input array pointers. These are used to step through the arrays. */
+  imt = (BYTE *)image->data + (size_t)elsize*bufsize*j0;
+  maskt = image->mask? (BYTE *)image->mask + (size_t)melsize*bufsize*j0: NULL;
+
   /* If the input array type is not PIXTYPE, allocate a buffer to hold
      converted values */
   if (image->dtype != PIXDTYPE)
     {
       QMALLOC(buf, PIXTYPE, bufsize, status);
       buft = buf;
-      if (status != RETURN_OK)
-	goto exit;
     }
   if (image->mask && (image->mdtype != PIXDTYPE))
     {
       QMALLOC(mbuf, PIXTYPE, bufsize, status);
       mbuft = mbuf;
-      if (status != RETURN_OK)
-	goto exit;
     }
 
   /* loop over rows of background boxes.
@@ -151,10 +135,10 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
    * because the pixel buffers are only read in from disk in
    * increments of a row of background boxes at a time.)
    */
-  for (j=0; j<ny; j++)
+  for (j=j0; j<j1; j++)
     {
       /* if the last row, modify the width appropriately*/
-      if (j == ny-1 && npix%bufsize)
+      if (j == bkg->ny-1 && npix%bufsize)
         bufsize = npix%bufsize;
 
       /* convert this row to PIXTYPE and store in buffer(s)*/
@@ -188,7 +172,7 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
       for (m=0; m<nx; m++, bm++)
 	{
 	  k = m+nx*j;
-	  backguess(bm, bkgout->back+k, bkgout->sigma+k);
+	  backguess(bm, bkg->back+k, bkg->sigma+k);
 	  free(bm->histo);
 	  bm->histo = NULL;
 	}
@@ -199,13 +183,86 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
 	maskt += melsize * bufsize;
     }
 
-  /* free memory */
+ exit:
   free(buf);
-  buf = NULL;
   free(mbuf);
-  mbuf = NULL;
+  if (backmesh)
+    {
+      bm = backmesh;
+      for (m=0; m<nx; m++, bm++)
+	free(bm->histo);
+    }
   free(backmesh);
-  backmesh = NULL;
+  return status;
+}
+
+void *backrowsthread(void *arg)
+{
+  backrowsargs *args = (backrowsargs *)arg;
+  args->status = backrows(args->image, args->bkg, args->j0, args->j1);
+  return NULL;
+}
+
+int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
+                   double fthresh, sep_bkg **bkg)
+{
+  int nx, ny, nb;             /* number of background boxes in x, y, total */
+  int nt;                     /* number of threads */
+  backrowsargs *rows;         /* rows of boxes for each thread */
+  sep_bkg *bkgout;            /* output */
+  int t, status;
+
+  status = RETURN_OK;
+  bkgout = NULL;
+  rows = NULL;
+
+  /* determine number of background boxes */
+  if ((nx = (image->w - 1) / bw + 1) < 1)
+    nx = 1;
+  if ((ny = (image->h - 1) / bh + 1) < 1)
+    ny = 1;
+  nb = nx*ny;
+
+  /* Allocate the returned struct */
+  QMALLOC(bkgout, sep_bkg, 1, status);
+  bkgout->w = image->w;
+  bkgout->h = image->h;
+  bkgout->nx = nx;
+  bkgout->ny = ny;
+  bkgout->n = nb;
+  bkgout->bw = bw;
+  bkgout->bh = bh;
+  bkgout->back = NULL;
+  bkgout->sigma = NULL;
+  bkgout->dback = NULL;
+  bkgout->dsigma = NULL;
+  QMALLOC(bkgout->back, float, nb, status);
+  QMALLOC(bkgout->sigma, float, nb, status);
+  QMALLOC(bkgout->dback, float, nb, status);
+  QMALLOC(bkgout->dsigma, float, nb, status);
+
+  /* split rows of boxes among threads */
+  nt = sep_get_nthreads();
+  if (nt > ny)
+    nt = ny;
+  QMALLOC(rows, backrowsargs, nt, status);
+  for (t=0; t<nt; t++)
+    {
+      rows[t].image = image;
+      rows[t].bkg = bkgout;
+      rows[t].j0 = ny * t / nt;
+      rows[t].j1 = ny * (t + 1) / nt;
+      rows[t].status = RETURN_OK;
+    }
+  if ((status = runparallel(backrowsthread, rows, nt, sizeof(backrowsargs)))
+      != RETURN_OK)
+    goto exit;
+  for (t=0; t<nt; t++)
+    if ((status = rows[t].status) != RETURN_OK)
+      goto exit;
+
+  free(rows);
+  rows = NULL;
 
   /* Median-filter and check suitability of the background map */
   if ((status = filterback(bkgout, fw, fh, fthresh)) != RETURN_OK)
@@ -224,15 +281,7 @@ int sep_background(sep_image* image, int bw, int bh, int fw, int fh,
 
   /* If we encountered a problem, clean up any allocated memory */
  exit:
-  free(buf);
-  free(mbuf);
-  if (backmesh)
-    {
-      bm = backmesh;
-      for (m=0; m<nx; m++, bm++)
-	free(bm->histo);
-    }
-  free(backmesh);
+  free(rows);
   sep_bkg_free(bkgout);
   *bkg = NULL;
   return status;
@@ -33,6 +33,31 @@
 #define DETECT_MAXAREA 0             /* replaces prefs.ext_maxarea */
 #define	WTHRESH_CONVFAC	1e-4         /* Factor to apply to weights when */
 			             /* thresholding filtered weight-maps */
+#define	STRIP_MINH	64           /* min. height of strip filtered by */
+				     /* one thread */
+
+/* pixel above threshold, found by filterstrip() */
+typedef struct
+{
+  int     x;
+  PIXTYPE value, cdvalue, var, thresh;
+} detpixstruct;
+
+/* horizontal strip of the image, filtered and thresholded by one thread */
+typedef struct
+{
+  sep_image    *image;
+  int          y0, y1;          /* lines [y0, y1) of the strip */
+  float        *convnorm;       /* normalized filter, NULL if not convolving */
+  int          convw, convh, filter_type;
+  int          isvarnoise, isvarthresh;
+  PIXTYPE      thresh, relthresh, pixvar, pixsig;
+  detpixstruct *pix;            /* pixels above threshold, line by line */
+  size_t       npix, size, maxpix;
+  size_t       *linepix;        /* index in pix of the first pixel of lines */
+  PIXTYPE      *threshim;       /* thresholds of all image pixels */
+  int          status;
+} stripstruct;
 
 /* globals */
 int plistexist_cdvalue, plistexist_thresh, plistexist_var;
@@ -62,7 +87,9 @@ int convert_to_catalog(objliststruct *objlist, int *survives,
 int arraybuffer_init(arraybuffer *buf, void *arr, int dtype, int w, int h,
                      int bufw, int bufh);
 void arraybuffer_readline(arraybuffer *buf);
+void arraybuffer_seek(arraybuffer *buf, int y);
 void arraybuffer_free(arraybuffer *buf);
+void *filterstrip(void *arg);
 
 /********************* array buffer functions ********************************/
 
@@ -129,6 +156,22 @@ void arraybuffer_readline(arraybuffer *buf)
   return;
 }
 
+/* position the buffer as if all lines before line y were read by
+ * arraybuffer_readline(), starting from arraybuffer_init() */
+void arraybuffer_seek(arraybuffer *buf, int y)
+{
+  int i, yl;
+
+  buf->yoff = y - 1 - buf->bh/2;
+  for (i=0; i<buf->bh; i++)
+    {
+      yl = buf->yoff + i;
+      if (yl >= 0 && yl < buf->dh)
+        buf->readline(buf->dptr + (size_t)buf->elsize * buf->dw * yl,
+                      buf->dw, buf->bptr + buf->bw * i);
+    }
+}
+
 void arraybuffer_free(arraybuffer *buf)
 {
   free(buf->bptr);
@@ -168,6 +211,192 @@ void apply_mask_line(arraybuffer *mbuf, arraybuffer *imbuf, arraybuffer *nbuf)
     }
 }
 
+/* filterstrip: filter and threshold lines of a strip of the image.
+ *
+ * Does for strip lines the same computations as the main loop of
+ * sep_extract() in serial mode, and stores pixels above the threshold,
+ * so the main loop only has to run Lutz' algorithm on them. Strips are
+ * processed in parallel threads; the main loop processes objects in the
+ * same order as in serial mode, so the results are the same.
+ *
+ * Sets strip status to PIXSTACK_FULL if there are more than maxpix pixels
+ * above the threshold.
+ */
+void *filterstrip(void *arg)
+{
+  stripstruct  *strip;
+  sep_image    *image;
+  arraybuffer  dbuf, nbuf, mbuf;
+  detpixstruct *pix;
+  PIXTYPE      *scan, *cdscan, *wscan, *sigscan, *workscan;
+  PIXTYPE      thresh, pixvar, pixsig;
+  int          w, h, bufh, xl, yl, luflag, status;
+
+  strip = (stripstruct *)arg;
+  image = strip->image;
+  w = image->w;
+  h = image->h;
+  thresh = strip->thresh;
+  pixvar = strip->pixvar;
+  pixsig = strip->pixsig;
+  cdscan = sigscan = workscan = NULL;
+  dbuf.bptr = nbuf.bptr = mbuf.bptr = NULL;
+  status = RETURN_OK;
+
+  bufh = strip->convnorm ? strip->convh : 1;
+  status = arraybuffer_init(&dbuf, image->data, image->dtype, w, h, w+1, bufh);
+  if (status != RETURN_OK) goto exit;
+  if (strip->isvarnoise)
+    {
+      status = arraybuffer_init(&nbuf, image->noise, image->ndtype, w, h,
+                                w+1, bufh);
+      if (status != RETURN_OK) goto exit;
+    }
+  if (image->mask)
+    {
+      status = arraybuffer_init(&mbuf, image->mask, image->mdtype, w, h,
+                                w+1, bufh);
+      if (status != RETURN_OK) goto exit;
+    }
+
+  /* the main loop masks lines as they are read into the buffers, so mask
+   * lines read by seek. The first strip starts as the main loop does. */
+  if (strip->y0 > 0)
+    {
+      arraybuffer_seek(&dbuf, strip->y0);
+      if (strip->isvarnoise)
+        arraybuffer_seek(&nbuf, strip->y0);
+      if (image->mask)
+        {
+          arraybuffer_seek(&mbuf, strip->y0);
+          for (xl=0; xl<mbuf.bw*mbuf.bh; xl++)
+            if (mbuf.bptr[xl] > 0.0)
+              {
+                dbuf.bptr[xl] = 0.0;
+                if (strip->isvarnoise)
+                  nbuf.bptr[xl] = BIG;
+              }
+        }
+    }
+
+  scan = dbuf.midline;
+  wscan = strip->isvarnoise ? nbuf.midline : NULL;
+
+  if (strip->convnorm)
+    {
+      QMALLOC(cdscan, PIXTYPE, w+1, status);
+      if (strip->filter_type == SEP_FILTER_MATCHED)
+        {
+          QMALLOC(sigscan, PIXTYPE, w+1, status);
+          QMALLOC(workscan, PIXTYPE, w+1, status);
+        }
+    }
+  else
+    cdscan = scan;
+
+  for (yl=strip->y0; yl<strip->y1; yl++)
+    {
+      arraybuffer_readline(&dbuf);
+      if (strip->isvarnoise)
+        arraybuffer_readline(&nbuf);
+      if (image->mask)
+        {
+          arraybuffer_readline(&mbuf);
+          apply_mask_line(&mbuf, &dbuf, (strip->isvarnoise? &nbuf: NULL));
+        }
+
+      if (strip->convnorm)
+        {
+          status = convolve(&dbuf, yl, strip->convnorm, strip->convw,
+                            strip->convh, cdscan);
+          if (status != RETURN_OK)
+            goto exit;
+
+          if (strip->filter_type == SEP_FILTER_MATCHED)
+            {
+              status = matched_filter(&dbuf, &nbuf, yl, strip->convnorm,
+                                      strip->convw, strip->convh, workscan,
+                                      sigscan, image->noise_type);
+              if (status != RETURN_OK)
+                goto exit;
+            }
+        }
+
+      strip->linepix[yl - strip->y0] = strip->npix;
+
+      for (xl=0; xl<w; xl++)
+        {
+          if (strip->isvarnoise)
+            {
+              if (image->noise_type == SEP_NOISE_VAR)
+                {
+                  pixvar = wscan[xl];
+                  pixsig = sqrt(pixvar);
+                }
+              else
+                {
+                  pixsig = wscan[xl];
+                  pixvar = pixsig * pixsig;
+                }
+              if (strip->isvarthresh)
+                {
+                  thresh = strip->relthresh * pixsig;
+                  strip->threshim[(size_t)yl * w + xl] = thresh;
+                }
+            }
+
+          if (strip->filter_type == SEP_FILTER_MATCHED)
+            luflag = (sigscan[xl] > strip->relthresh)? 1: 0;
+          else
+            luflag = cdscan[xl] > thresh? 1: 0;
+
+          if (!luflag)
+            continue;
+
+          if (strip->npix == strip->size)
+            {
+              if (strip->size == strip->maxpix)
+                {
+                  status = PIXSTACK_FULL;
+                  goto exit;
+                }
+              strip->size = strip->size ? strip->size * 2 : w;
+              if (strip->size > strip->maxpix)
+                strip->size = strip->maxpix;
+              pix = realloc(strip->pix, strip->size * sizeof(detpixstruct));
+              if (pix == NULL)
+                {
+                  status = MEMORY_ALLOC_ERROR;
+                  goto exit;
+                }
+              strip->pix = pix;
+            }
+
+          pix = strip->pix + strip->npix++;
+          pix->x = xl;
+          pix->value = scan[xl];
+          pix->cdvalue = cdscan[xl];
+          pix->var = pixvar;
+          pix->thresh = thresh;
+        }
+    }
+
+  strip->linepix[strip->y1 - strip->y0] = strip->npix;
+
+ exit:
+  arraybuffer_free(&dbuf);
+  if (strip->isvarnoise)
+    arraybuffer_free(&nbuf);
+  if (image->mask)
+    arraybuffer_free(&mbuf);
+  if (strip->convnorm)
+    free(cdscan);
+  free(sigscan);
+  free(workscan);
+  strip->status = status;
+  return NULL;
+}
+
 /****************************** extract **************************************/
 int sep_extract(sep_image *image, float thresh, int thresh_type,
                 int minarea, float *conv, int convw, int convh,
@@ -184,7 +413,7 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
   int               w, h;
   int               co, i, luflag, pstop, xl, xl2, yl, cn;
   int               stacksize, convn, status;
-  int               bufh;
+  int               bufh, nstrips, prevdet;
   int               isvarthresh, isvarnoise;
   short             trunflag;
   PIXTYPE           relthresh, cdnewsymbol, pixvar, pixsig;
@@ -200,6 +429,9 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
   float             *convnorm;
   int               *start, *end, *survives;
   pixstatus         *psstack;
+  stripstruct       *strips, *strip;
+  detpixstruct      *dp, *dpend;
+  PIXTYPE           *threshim, *threshscan;
   char              errtext[512];
   sep_catalog       *cat;
 
@@ -216,6 +448,10 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
   finalobjlist = NULL;
   survives = NULL;
   cat = NULL;
+  strips = strip = NULL;
+  dp = dpend = NULL;
+  threshim = threshscan = NULL;
+  nstrips = prevdet = 0;
   convn = 0;
   sum = 0.0;
   w = image->w;
@@ -379,6 +615,72 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 	convnorm[i] = conv[i] / sum;
     }
 
+  /* filter and threshold horizontal strips of the image in parallel.
+   * Objects are then extracted from pixels above the threshold in the main
+   * loop. */
+  nstrips = h / (bufh > STRIP_MINH ? bufh : STRIP_MINH);
+  if (nstrips > sep_get_nthreads())
+    nstrips = sep_get_nthreads();
+  if (isvarnoise && image->noise_type != SEP_NOISE_VAR &&
+      image->noise_type != SEP_NOISE_STDDEV)
+    nstrips = 0;
+  if (nstrips > 1)
+    {
+      QCALLOC(strips, stripstruct, nstrips, status);
+      if (isvarthresh)
+        QMALLOC(threshim, PIXTYPE, (size_t)w * h, status);
+      for (i=0; i<nstrips; i++)
+        {
+          strip = strips + i;
+          strip->image = image;
+          strip->y0 = (int)((size_t)h * i / nstrips);
+          strip->y1 = (int)((size_t)h * (i + 1) / nstrips);
+          strip->convnorm = convnorm;
+          strip->convw = convw;
+          strip->convh = convh;
+          strip->filter_type = filter_type;
+          strip->isvarnoise = isvarnoise;
+          strip->isvarthresh = isvarthresh;
+          strip->thresh = thresh;
+          strip->relthresh = relthresh;
+          strip->pixvar = pixvar;
+          strip->pixsig = pixsig;
+          /* limit memory used by images without background subtracted;
+           * they are left for the serial mode to report */
+          strip->maxpix = (size_t)(strip->y1 - strip->y0) * w / 4;
+          if (strip->maxpix < mem_pixstack)
+            strip->maxpix = mem_pixstack;
+          strip->threshim = threshim;
+          QMALLOC(strip->linepix, size_t, strip->y1 - strip->y0 + 1, status);
+        }
+
+      status = runparallel(filterstrip, strips, nstrips, sizeof(stripstruct));
+      for (i=0; i<nstrips && status == RETURN_OK; i++)
+        status = strips[i].status;
+
+      if (status == PIXSTACK_FULL)
+        {
+          /* extract in the serial mode */
+          for (i=0; i<nstrips; i++)
+            {
+              free(strips[i].pix);
+              free(strips[i].linepix);
+            }
+          free(strips);
+          free(threshim);
+          strips = NULL;
+          threshim = NULL;
+          nstrips = 0;
+          status = RETURN_OK;
+        }
+      else if (status != RETURN_OK)
+        goto exit;
+
+      strip = strips;
+    }
+  else
+    nstrips = 0;
+
   /*----- MAIN LOOP ------ */
   for (yl=0; yl<=h; yl++)
     {
@@ -393,10 +695,25 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 	    {
 	      free(cdscan);
 	      cdscan = NULL;
+	      /* sigscan still holds the last image line */
+	      if (filter_type == SEP_FILTER_MATCHED)
+		for (xl=0; xl<stacksize; xl++)
+		  sigscan[xl] = -BIG;
 	    }
 	  cdscan = dummyscan;
 	}
 
+      else if (nstrips)
+        {
+          /* the line was filtered by filterstrip() */
+          if (yl == strip->y1)
+            strip++;
+          dp = strip->pix + strip->linepix[yl - strip->y0];
+          dpend = strip->pix + strip->linepix[yl - strip->y0 + 1];
+          if (isvarthresh)
+            threshscan = threshim + (size_t)yl * w;
+        }
+
       else
 	{
           arraybuffer_readline(&dbuf);
@@ -430,6 +747,17 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 	      cdscan = scan;
 	    }	  
 	}
+
+      /* a line without pixels above the threshold closes all objects, so
+       * next line without such pixels does nothing */
+      if (nstrips)
+        {
+          if (yl == h)
+            dp = dpend = NULL;
+          if (dp == dpend && !prevdet)
+            continue;
+          prevdet = (dp != dpend);
+        }
       
       trunflag = (yl==0 || yl==h-1)? SEP_OBJ_TRUNC: 0;
       
@@ -445,8 +773,29 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 
 	  curpixinfo.flag = trunflag;
 
+          if (nstrips)
+            {
+              /* take values computed by filterstrip() */
+              if (isvarthresh)
+                {
+                  if (xl == w || yl == h)
+                    {
+                      pixsig = pixvar = 0.0;
+                      thresh = relthresh * pixsig;
+                    }
+                  else
+                    thresh = threshscan[xl];
+                }
+              if (dp != dpend && dp->x == xl)
+                {
+                  cdnewsymbol = dp->cdvalue;
+                  pixvar = dp->var;
+                  thresh = dp->thresh;
+                }
+            }
+
           /* set pixel variance/noise based on noise array */
-          if (isvarnoise) {
+          else if (isvarnoise) {
             if (xl == w || yl == h) {
               pixsig = pixvar = 0.0;
             }
@@ -469,7 +818,9 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
           }
 
           /* luflag: is pixel above thresh (Y/N)? */
-          if (filter_type == SEP_FILTER_MATCHED)
+          if (nstrips)
+            luflag = (dp != dpend && dp->x == xl)? 1: 0;
+          else if (filter_type == SEP_FILTER_MATCHED)
             luflag = ((xl != w) && (sigscan[xl] > relthresh))? 1: 0;
           else
             luflag = cdnewsymbol > thresh? 1: 0;
@@ -490,7 +841,7 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 	      PLIST(pixt, nextpix) = -1;
 	      PLIST(pixt, x) = xl;
 	      PLIST(pixt, y) = yl;
-	      PLIST(pixt, value) = scan[xl];
+	      PLIST(pixt, value) = nstrips? (dp++)->value: scan[xl];
 	      if (PLISTEXIST(cdvalue))
 		PLISTPIX(pixt, cdvalue) = cdnewsymbol;
 	      if (PLISTEXIST(var))
@@ -674,6 +1025,13 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
 
     } /*---------------- End of the loop over the y's -----------------------*/
 
+  /* threshold of the last (empty) line, as if the line was processed */
+  if (nstrips && isvarthresh)
+    {
+      pixsig = pixvar = 0.0;
+      thresh = relthresh * pixsig;
+    }
+
   /* convert `finalobjlist` to an array of `sepobj` structs */
   /* if cleaning, see which objects "survive" cleaning. */
   if (clean_flag)
@@ -710,6 +1068,14 @@ int sep_extract(sep_image *image, float thresh, int thresh_type,
   free(start);
   free(end);
   free(survives);
+  if (strips)
+    for (i=0; i<nstrips; i++)
+      {
+        free(strips[i].pix);
+        free(strips[i].linepix);
+      }
+  free(strips);
+  free(threshim);
   arraybuffer_free(&dbuf);
   if (image->noise)
     arraybuffer_free(&nbuf);
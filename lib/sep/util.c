@@ -20,6 +20,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <pthread.h>
 #include "sep.h"
 #include "sepcore.h"
 
@@ -27,6 +28,7 @@
 
 char *sep_version_string = "0.6.0";
 static char _errdetail_buffer[DETAILSIZE] = "";
+static int nthreads = 1;
 
 /****************************************************************************/
 /* data type conversion mechanics for runtime type conversion */
@@ -364,6 +366,47 @@ void put_errdetail(char *errtext)
 
 }
 
+/*****************************************************************************/
+/* Threads */
+
+void sep_set_nthreads(int n)
+{
+  nthreads = (n < 1)? 1: n;
+}
+
+int sep_get_nthreads(void)
+{
+  return nthreads;
+}
+
+/* Call func for each of n argument structs stored at args, argsize bytes
+ * apart. The last call (and any call for which a thread cannot be created)
+ * runs in the calling thread. Returns when all calls have finished. */
+int runparallel(void *(*func)(void *), void *args, int n, size_t argsize)
+{
+  pthread_t *threads;
+  int       i, started, status;
+
+  status = RETURN_OK;
+  QMALLOC(threads, pthread_t, n, status);
+
+  for (started=0; started<n-1; started++)
+    if (pthread_create(threads+started, NULL, func,
+                       (BYTE *)args + started*argsize))
+      break;
+
+  for (i=started; i<n; i++)
+    func((BYTE *)args + i*argsize);
+
+  for (i=0; i<started; i++)
+    pthread_join(threads[i], NULL);
+
+  free(threads);
+
+ exit:
+  return status;
+}
+
 /*****************************************************************************/
 /* Array median */
 
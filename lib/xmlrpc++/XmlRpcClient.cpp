@@ -6,6 +6,12 @@
 
 #include "base64.h"
 
+#include "rts2-config.h"
+
+#ifdef RTS2_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -503,11 +509,37 @@ bool XmlRpcClient::generateGetRequest(const char* path, const char* body)
 	return true;
 }
 
+#ifdef RTS2_HAVE_ZLIB
+// deflate (zlib format, as required by HTTP) request body
+static bool deflateBody(const char* body, size_t bsize, std::string &out)
+{
+	uLongf clen = compressBound(bsize);
+	out.resize(clen);
+	if (compress2((Bytef *) &out[0], &clen, (const Bytef *) body, bsize, Z_DEFAULT_COMPRESSION) != Z_OK)
+		return false;
+	out.resize(clen);
+	return true;
+}
+#endif
+
 bool XmlRpcClient::generatePostRequest(const char* path, const char* body)
 {
 	size_t bsize = 0;
 	if (body)
 		bsize = strlen(body);
+
+#ifdef RTS2_HAVE_ZLIB
+	std::string compressed;
+	// small bodies are not worth the effort
+	if (_deflateRequests && bsize > 512 && deflateBody(body, bsize, compressed))
+	{
+		_request = generateGetPostHeader(path ? path : std::string(""), compressed.length(), true, "deflate");
+		XmlRpcUtil::log(4, "XmlRpcClient::generatePostRequest: body deflated from %d to %d bytes.", bsize, compressed.length());
+		_request += compressed;
+		return true;
+	}
+#endif
+
 	if (path)
 		_request = generateGetPostHeader(path, bsize, true);
 	else
@@ -556,7 +588,7 @@ std::string XmlRpcClient::generateHeader(std::string const& body)
 }
 
 // Prepare GET request header
-std::string XmlRpcClient::generateGetPostHeader(std::string const& path, size_t contentLength, bool post)
+std::string XmlRpcClient::generateGetPostHeader(std::string const& path, size_t contentLength, bool post, const char *contentEncoding)
 {
 	std::string header;
 	if (post)
@@ -604,6 +636,13 @@ std::string XmlRpcClient::generateGetPostHeader(std::string const& path, size_t
 		header += buff;
 	}
 
+	if (contentEncoding)
+	{
+		header += "Content-Encoding: ";
+		header += contentEncoding;
+		header += "\r\n";
+	}
+
 	header += "Connection: Close\r\n\r\n";
 
 	return header;
@@ -982,6 +1021,7 @@ void XmlRpcClient::setupHost(const char *host, int port, const char *authorizati
 	_connectionState = NO_CONNECTION;
 	_executing = NOEXEC;
 	_eof = false;
+	_deflateRequests = false;
 
 	// Default to keeping the connection open until an explicit close is done
 	setKeepOpen();
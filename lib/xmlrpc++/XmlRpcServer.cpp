@@ -25,6 +25,7 @@ XmlRpcServer::XmlRpcServer()
 	_listMethods = NULL;
 	_methodHelp = NULL;
 	_defaultGetRequest = NULL;
+	_maxRequestSize = XMLRPC_MAX_REQUEST_SIZE;
 }
 
 
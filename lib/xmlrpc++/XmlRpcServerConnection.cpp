@@ -7,6 +7,13 @@
 #include "urlencoding.h"
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
+
+#include "rts2-config.h"
+
+#ifdef RTS2_HAVE_ZLIB
+#include <zlib.h>
+#endif
 
 #ifndef MAKEDEPEND
 # include <stdio.h>
@@ -57,6 +64,7 @@ XmlRpcServerConnection::XmlRpcServerConnection(int fd, XmlRpcServer* server, boo
 
 	_request_buf = NULL;
 	_request_length = 0;
+	_deflated = false;
 
 	_server = server;
 	_connectionState = READ_HEADER;
@@ -134,6 +142,7 @@ bool XmlRpcServerConnection::readHeader()
 	char *lp = 0;				 // Start of content-length value
 	char *kp = 0;				 // Start of connection value
 	char *ap = 0;				 // Start of authorization header
+	char *ep2 = 0;				 // Start of content-encoding value
 
 	for (char *cp = hp; (bp == 0) && (cp < ep); ++cp)
 	{
@@ -147,6 +156,8 @@ bool XmlRpcServerConnection::readHeader()
 			kp = cp + 12;
 		else if ((ep - cp > 15) && (strncasecmp (cp, "Authorization: ", 15) == 0))
 			ap = cp + 15;
+		else if ((ep - cp > 18) && (strncasecmp (cp, "Content-Encoding: ", 18) == 0))
+			ep2 = cp + 18;
 		else if ((ep - cp >= 4) && (strncmp(cp, "\r\n\r\n", 4) == 0))
 			bp = cp + 4;
 		else if ((ep - cp >= 2) && (strncmp(cp, "\n\n", 2) == 0))
@@ -253,6 +264,25 @@ bool XmlRpcServerConnection::readHeader()
 			XmlRpcUtil::error("XmlRpcServerConnection::readHeader: Invalid Content-length specified (%d).", _contentLength);
 			return false;
 		}
+		if ((size_t) _contentLength > _server->getMaxRequestSize())
+		{
+			XmlRpcUtil::error("XmlRpcServerConnection::readHeader: Content-length %d exceeds limit %d.", _contentLength, (int) _server->getMaxRequestSize());
+			return rejectRequest(HTTP_TOO_LARGE, "Request too large");
+		}
+	}
+
+	_deflated = false;
+	if (ep2 != 0)
+	{
+		if (strncasecmp (ep2, "deflate", 7) == 0)
+		{
+			_deflated = true;
+		}
+		else if (strncasecmp (ep2, "identity", 8) != 0)
+		{
+			XmlRpcUtil::error("XmlRpcServerConnection::readHeader: unsupported Content-Encoding.");
+			return false;
+		}
 	}
 
 	XmlRpcUtil::log(3, "XmlRpcServerConnection::readHeader: specified content length is %d.", _contentLength);
@@ -305,6 +335,13 @@ bool XmlRpcServerConnection::readRequest()
 	// Otherwise, parse and dispatch the request
 	XmlRpcUtil::log(3, "XmlRpcServerConnection::readRequest read %d bytes.", _request_length);
 
+	if (_deflated)
+	{
+		int code = inflateRequest();
+		if (code != HTTP_OK)
+			return rejectRequest(code, code == HTTP_TOO_LARGE ? "Request too large" : "Invalid compressed request");
+	}
+
 	_connectionState = _connectionState == READ_GET_REQUEST ? GET_REQUEST : (_connectionState == READ_POST_REQUEST ? POST_REQUEST : WRITE_RESPONSE);
 
 	_request = _request_buf;
@@ -312,6 +349,98 @@ bool XmlRpcServerConnection::readRequest()
 	return true;				 // Continue monitoring this source
 }
 
+int XmlRpcServerConnection::inflateRequest()
+{
+#ifdef RTS2_HAVE_ZLIB
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+	if (inflateInit(&zs) != Z_OK)
+		return HTTP_BAD_REQUEST;
+
+	zs.next_in = (Bytef *) _request_buf;
+	zs.avail_in = _contentLength;
+
+	size_t max_size = _server->getMaxRequestSize();
+	size_t out_size = std::min(4 * (size_t) _contentLength + 1024, max_size);
+	char *out = (char*) malloc(out_size + 1);
+	if (out == NULL)
+	{
+		inflateEnd(&zs);
+		return HTTP_TOO_LARGE;
+	}
+	int ret;
+	bool too_large = false;
+
+	do
+	{
+		zs.next_out = (Bytef *) (out + zs.total_out);
+		zs.avail_out = out_size - zs.total_out;
+		ret = inflate(&zs, Z_NO_FLUSH);
+		if (ret == Z_OK && zs.avail_out == 0)
+		{
+			// inflated body would exceed the limit
+			if (out_size >= max_size)
+			{
+				too_large = true;
+				break;
+			}
+			out_size = std::min(out_size * 2, max_size);
+			char *n = (char*) realloc(out, out_size + 1);
+			if (n == NULL)
+			{
+				too_large = true;
+				break;
+			}
+			out = n;
+		}
+	} while (ret == Z_OK);
+
+	inflateEnd(&zs);
+
+	if (too_large)
+	{
+		XmlRpcUtil::error("XmlRpcServerConnection::inflateRequest: inflated request exceeds %d bytes.", (int) out_size);
+		free(out);
+		return HTTP_TOO_LARGE;
+	}
+
+	if (ret != Z_STREAM_END)
+	{
+		XmlRpcUtil::error("XmlRpcServerConnection::inflateRequest: invalid deflate stream (%d).", ret);
+		free(out);
+		return HTTP_BAD_REQUEST;
+	}
+
+	XmlRpcUtil::log(3, "XmlRpcServerConnection::inflateRequest: inflated %d to %d bytes.", _contentLength, (int) zs.total_out);
+
+	free(_request_buf);
+	_request_buf = out;
+	_request_length = zs.total_out;
+	_request_buf[_request_length] = '\0';
+	_deflated = false;
+	return HTTP_OK;
+#else
+	XmlRpcUtil::error("XmlRpcServerConnection::inflateRequest: compiled without zlib, cannot inflate request.");
+	return HTTP_BAD_REQUEST;
+#endif
+}
+
+bool XmlRpcServerConnection::rejectRequest(int http_code, const char *reason)
+{
+	delete[] _get_response;
+	_get_response_length = strlen(reason);
+	_get_response = new char[_get_response_length];
+	memcpy(_get_response, reason, _get_response_length);
+	prepareGetHeader(http_code, "text/plain");
+	_getHeaderWritten = 0;
+	_getWritten = 0;
+
+	// rest of the request is not read, connection cannot be reused
+	_keepAlive = false;
+	_connectionState = GET_REQUEST;
+	return true;
+}
+
 bool XmlRpcServerConnection::handleGet()
 {
 	if (_get_response_header.length () == 0 || _get_response_length == 0)
@@ -442,7 +571,6 @@ void XmlRpcServerConnection::executeGet()
 	const char* response_type = "text/plain";
 
 	int http_code = HTTP_BAD_REQUEST;
-	const char *http_code_string = "Failed";
 
 	XmlRpcServerGetRequest* request = _server->findGetRequest(_get);
 	if (request == NULL)
@@ -544,6 +672,13 @@ void XmlRpcServerConnection::executeGet()
 		}
 	}
 
+	prepareGetHeader (http_code, response_type);
+	printf ("%s", _get_response_header.c_str ());
+}
+
+void XmlRpcServerConnection::prepareGetHeader (int http_code, const char *response_type)
+{
+	const char *http_code_string;
 	switch (http_code)
 	{
 		case HTTP_OK:
@@ -553,6 +688,9 @@ void XmlRpcServerConnection::executeGet()
 			http_code_string = "Authorization Required";
 			addExtraHeader ("WWW-Authenticate", "Basic realm=\"Your RTS2 login\"");
 			break;
+		case HTTP_TOO_LARGE:
+			http_code_string = "Request Entity Too Large";
+			break;
 		case HTTP_BAD_REQUEST:
 		default:
 			http_code_string = "Failed";
@@ -560,7 +698,6 @@ void XmlRpcServerConnection::executeGet()
 	}
 
 	_get_response_header = printHeaders (http_code, http_code_string, response_type, _get_response_length, _extra_headers);
-	printf ("%s", _get_response_header.c_str ());
 }
 
 // Parse the method name and the argument values from the request.
@@ -704,6 +841,20 @@ void XmlRpcServerConnection::setResponse(char *_set_response, size_t _response_l
 	_server->setSourceEvents(this, XmlRpcDispatch::WritableEvent);
 }
 
+void XmlRpcServerConnection::setAsyncResponse (int http_code, const char *response_type, char *response, size_t response_length)
+{
+	delete[] _get_response;
+	_get_response = response;
+	_get_response_length = response_length;
+	_getHeaderWritten = 0;
+	_getWritten = 0;
+	prepareGetHeader (http_code, response_type);
+
+	// handleGet will write header and response
+	_connectionState = GET_REQUEST;
+	_server->setSourceEvents(this, XmlRpcDispatch::WritableEvent);
+}
+
 void XmlRpcServerConnection::generateFaultResponse(std::string const& errorMsg, int errorCode)
 {
 	const char RESPONSE_1[] =
@@ -782,6 +933,7 @@ void XmlRpcServerConnection::prepareForNext ()
 		free(_request_buf);
 	_request_buf = NULL;
 	_request_length = 0;
+	_deflated = false;
 	_get_response_header = std::string ("");
 	_extra_headers.clear ();
 	_get_response_length = 0;
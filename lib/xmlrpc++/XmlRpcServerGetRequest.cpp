@@ -12,6 +12,9 @@
 
 using namespace XmlRpc;
 
+// headers of request executed by worker thread
+static thread_local std::list <std::pair <const char*, std::string> > *threadHeaders = NULL;
+
 const char *HttpParams::getString (const char *_name, const char *def_val)
 {
 	for (HttpParams::iterator p = begin (); p != end (); p++)
@@ -140,6 +143,19 @@ XmlRpcServerGetRequest::~XmlRpcServerGetRequest()
 	if (_server) _server->removeGetRequest(this);
 }
 
+void XmlRpcServerGetRequest::setThreadHeaders (std::list <std::pair <const char*, std::string> > *_headers)
+{
+	threadHeaders = _headers;
+}
+
+void XmlRpcServerGetRequest::addExtraHeader (const char *name, std::string value)
+{
+	if (threadHeaders)
+		threadHeaders->push_back (std::pair <const char*, std::string> (name, value));
+	else
+		connection->addExtraHeader (name, value);
+}
+
 void XmlRpcServerGetRequest::setAuthorization(std::string authorization)
 {
  	if (authorization.length () == 0)
@@ -0,0 +1,47 @@
+#!/usr/bin/python
+#
+# Measures request rate of script communication. Run it as exe script,
+# e.g. from rts2-scriptexec:
+#
+#   rts2-scriptexec -d C0 -s 'exe /path/to/benchscriptcomm.py centrald sun_alt sun_az'
+#
+# Arguments are device name and names of values which are retrieved.
+
+from __future__ import print_function
+
+import sys
+import time
+
+import rts2.scriptcomm
+
+DURATION = 2.0
+
+c = rts2.scriptcomm.Rts2Comm(log_device = False)
+
+device = 'centrald'
+names = ['sun_alt', 'sun_az']
+if len(sys.argv) > 2:
+	device = sys.argv[1]
+	names = sys.argv[2:]
+
+values = [(n, device) for n in names]
+
+def bench(name, call):
+	n = 0
+	start = time.time()
+	while time.time() - start < DURATION:
+		call()
+		n += 1
+	el = time.time() - start
+	c.log('I', '{0:<32} {1:10.1f} calls/s {2:10.1f} values/s'.format(name, n / el, n * len(values) / el))
+
+def getSingle():
+	for v,d in values:
+		c.getValue(v, d)
+
+bench('G for every value', getSingle)
+bench('MG for all values', lambda: c.getValues(values))
+
+c.subscribe(values)
+bench('subscribed values (cached)', getSingle)
+c.unsubscribe()
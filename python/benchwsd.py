@@ -0,0 +1,240 @@
+#!/usr/bin/python
+#
+# Load test of value updates delivered by rts2-wsd websocket gateway,
+# compared with polling of rts2-httpd /api/getall.
+#
+# Opens number of websocket connections to rts2-wsd, subscribes infotime
+# (and optionally all values) of given devices, and measures delay between
+# infotime and time the update was received. The same is measured with
+# HTTP clients polling /api/getall. CPU time used by server processes is
+# read from /proc, so the script shall run on the same machine as servers.
+#
+# Example, with dummy devices C0 and T0 running:
+#
+#   benchwsd.py --wsd-pid `pidof rts2-wsd` --httpd-pid `pidof rts2-httpd` \
+#	--clients 500 --user petr --password test C0 T0
+
+from __future__ import print_function
+
+import argparse
+import base64
+import json
+import os
+import select
+import socket
+import struct
+import sys
+import threading
+import time
+
+try:
+	import urllib2 as urlrequest
+except ImportError:
+	import urllib.request as urlrequest
+
+class WsClient:
+	"""Minimal websocket client, only as much as needed to receive updates."""
+	def __init__(self, host, port, protocol):
+		self.sock = socket.create_connection((host, port))
+		key = base64.b64encode(os.urandom(16)).decode('ascii')
+		req = 'GET / HTTP/1.1\r\nHost: {0}:{1}\r\nUpgrade: websocket\r\nConnection: Upgrade\r\nSec-WebSocket-Key: {2}\r\nSec-WebSocket-Version: 13\r\nSec-WebSocket-Protocol: {3}\r\n\r\n'.format(host, port, key, protocol)
+		self.sock.sendall(req.encode('ascii'))
+		self.buf = b''
+		while not b'\r\n\r\n' in self.buf:
+			d = self.sock.recv(4096)
+			if not d:
+				raise Exception('connection closed during handshake')
+			self.buf += d
+		head, self.buf = self.buf.split(b'\r\n\r\n', 1)
+		if not head.startswith(b'HTTP/1.1 101'):
+			raise Exception('handshake failed: ' + head.split(b'\r\n')[0].decode('ascii'))
+		self.sock.setblocking(False)
+		self.frames = 0
+		self.received = 0
+
+	def fileno(self):
+		return self.sock.fileno()
+
+	def send(self, msg):
+		data = msg.encode('utf-8')
+		mask = os.urandom(4)
+		hdr = struct.pack('!B', 0x81)
+		if len(data) < 126:
+			hdr += struct.pack('!B', 0x80 | len(data))
+		else:
+			hdr += struct.pack('!BH', 0x80 | 126, len(data))
+		masked = bytearray(data)
+		for i in range(len(masked)):
+			masked[i] ^= ord(mask[i % 4:i % 4 + 1])
+		self.sock.setblocking(True)
+		self.sock.sendall(hdr + mask + bytes(masked))
+		self.sock.setblocking(False)
+
+	def read(self):
+		"""Returns list of received (opcode, payload) frames."""
+		try:
+			d = self.sock.recv(65536)
+		except socket.error:
+			return []
+		if not d:
+			raise Exception('connection closed')
+		self.received += len(d)
+		self.buf += d
+		ret = []
+		while len(self.buf) >= 2:
+			op, l = struct.unpack('!BB', self.buf[:2])
+			l &= 0x7f
+			p = 2
+			if l == 126:
+				if len(self.buf) < 4:
+					break
+				l = struct.unpack('!H', self.buf[2:4])[0]
+				p = 4
+			elif l == 127:
+				if len(self.buf) < 10:
+					break
+				l = struct.unpack('!Q', self.buf[2:10])[0]
+				p = 10
+			if len(self.buf) < p + l:
+				break
+			ret.append((op & 0x0f, self.buf[p:p + l]))
+			self.buf = self.buf[p + l:]
+			self.frames += 1
+		return ret
+
+class Stats:
+	def __init__(self):
+		self.lock = threading.Lock()
+		self.delays = []
+		self.updates = 0
+
+	def add(self, delay):
+		with self.lock:
+			self.delays.append(delay)
+
+	def report(self, name, duration, cpu):
+		d = sorted(self.delays)
+		if len(d) == 0:
+			print('{0:<10} no updates received'.format(name))
+			return
+		print('{0:<10} {1:8d} updates {2:10.1f} updates/s  delay ms: mean {3:8.2f} median {4:8.2f} 95% {5:8.2f} max {6:8.2f}  server CPU {7:6.2f} s ({8:5.1f} %)'.format(
+			name, len(d), len(d) / duration, 1000 * sum(d) / len(d), 1000 * d[len(d) // 2], 1000 * d[int(len(d) * 0.95)], 1000 * d[-1],
+			cpu, 100 * cpu / duration))
+
+def cputime(pid):
+	if pid is None:
+		return 0
+	with open('/proc/{0}/stat'.format(pid)) as f:
+		s = f.read().rsplit(')', 1)[1].split()
+	return (int(s[11]) + int(s[12])) / float(os.sysconf('SC_CLK_TCK'))
+
+def run_ws(args, stats):
+	clients = []
+	sub = {}
+	for d in args.devices:
+		sub[d] = '*' if args.all else ['infotime']
+	for i in range(args.clients):
+		c = WsClient(args.host, args.wsd_port, 'rts2-values')
+		if args.interval:
+			c.send(json.dumps({'interval':args.interval}))
+		c.send(json.dumps({'subscribe':sub}))
+		clients.append(c)
+
+	last = {}
+	start = time.time()
+	while time.time() - start < args.duration:
+		r, w, e = select.select(clients, [], [], 0.1)
+		now = time.time()
+		for c in r:
+			for op, payload in c.read():
+				if op != 1:
+					continue
+				msg = json.loads(payload.decode('utf-8'))
+				if 'error' in msg:
+					print('error from server', msg['error'], file=sys.stderr)
+				if not 'd' in msg:
+					continue
+				for dev, vals in msg['d'].items():
+					if 'infotime' in vals:
+						# first update is value current at subscription
+						if last.get((c, dev)) is not None:
+							stats.add(now - vals['infotime'])
+						last[(c, dev)] = vals['infotime']
+	received = sum([c.received for c in clients])
+	frames = sum([c.frames for c in clients])
+	for c in clients:
+		c.sock.close()
+	return received, frames
+
+def poll_http(args, stats, stop, counts):
+	url = 'http://{0}:{1}/api/getall?e=0'.format(args.host, args.httpd_port)
+	req = urlrequest.Request(url)
+	if args.user:
+		req.add_header('Authorization', 'Basic ' + base64.b64encode('{0}:{1}'.format(args.user, args.password).encode('utf-8')).decode('ascii'))
+	last = {}
+	while not stop.is_set():
+		t = time.time()
+		data = urlrequest.urlopen(req).read()
+		now = time.time()
+		counts[0] += len(data)
+		counts[1] += 1
+		msg = json.loads(data.decode('utf-8'))
+		for dev in args.devices:
+			try:
+				it = msg[dev]['d']['infotime']
+			except KeyError:
+				continue
+			if last.get(dev) is not None and last[dev] != it:
+				stats.add(now - it)
+			last[dev] = it
+		w = args.poll - (time.time() - t)
+		if w > 0:
+			stop.wait(w)
+
+def run_http(args, stats):
+	stop = threading.Event()
+	threads = []
+	counts = []
+	for i in range(args.pollers):
+		counts.append([0, 0])
+		th = threading.Thread(target=poll_http, args=(args, stats, stop, counts[-1]))
+		th.daemon = True
+		th.start()
+		threads.append(th)
+	time.sleep(args.duration)
+	stop.set()
+	for th in threads:
+		th.join()
+	return sum([c[0] for c in counts]), sum([c[1] for c in counts])
+
+parser = argparse.ArgumentParser(description='Compares value delivery through rts2-wsd websockets with /api/getall polling')
+parser.add_argument('devices', nargs='+', help='devices which values are watched')
+parser.add_argument('--host', default='localhost')
+parser.add_argument('--wsd-port', type=int, default=8888)
+parser.add_argument('--httpd-port', type=int, default=8889)
+parser.add_argument('--wsd-pid', type=int, help='PID of rts2-wsd, to measure its CPU time')
+parser.add_argument('--httpd-pid', type=int, help='PID of rts2-httpd, to measure its CPU time')
+parser.add_argument('--clients', type=int, default=200, help='number of websocket clients')
+parser.add_argument('--all', action='store_true', help='subscribe all device values, not only infotime')
+parser.add_argument('--interval', type=float, default=0, help='minimal interval between websocket updates')
+parser.add_argument('--pollers', type=int, default=20, help='number of HTTP polling clients; 0 to skip polling test')
+parser.add_argument('--poll', type=float, default=1, help='polling interval (seconds)')
+parser.add_argument('--user', help='HTTP user')
+parser.add_argument('--password', default='', help='HTTP password')
+parser.add_argument('--duration', type=float, default=30, help='duration of each test (seconds)')
+
+args = parser.parse_args()
+
+if args.clients > 0:
+	stats = Stats()
+	cpu = cputime(args.wsd_pid)
+	received, frames = run_ws(args, stats)
+	stats.report('websocket', args.duration, cputime(args.wsd_pid) - cpu)
+	print('{0:<10} {1} clients, {2} frames, {3:.1f} kB received'.format('', args.clients, frames, received / 1024.0))
+
+if args.pollers > 0:
+	stats = Stats()
+	cpu = cputime(args.httpd_pid)
+	received, requests = run_http(args, stats)
+	stats.report('getall', args.duration, cputime(args.httpd_pid) - cpu)
+	print('{0:<10} {1} pollers, {2} requests, {3:.1f} kB received'.format('', args.pollers, requests, received / 1024.0))
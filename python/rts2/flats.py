@@ -524,6 +524,28 @@ class FlatScript (scriptcomm.Rts2Comm):
         import numpy
         import os
         from astropy.io import fits as pyfits
+        import stack
+
+        if stack.available():
+            # median of flats scaled to their mean, normalized to maximum
+            try:
+                stack.stack(
+                    of, files, method='median', scale='mean',
+                    normalize='max')
+                f = pyfits.open(of)
+                m = f[0].data
+                self.log(
+                    'I',
+                    'writing {0} of min: {1} max: {2} mean: {3} std: {4} '
+                    'median: {5}'.format(
+                        of, numpy.nanmin(m), numpy.nanmax(m),
+                        numpy.nanmean(m), numpy.nanstd(m),
+                        numpy.nanmedian(m)))
+                f.close()
+                return
+            except stack.StackError as se:
+                self.log(
+                    'W', 'native stacking failed, using numpy: {0}'.format(se))
 
         f = pyfits.open(files[0])
         d = numpy.empty([len(files), len(f[0].data), len(f[0].data[0])])
@@ -19,9 +19,11 @@
 
 from __future__ import print_function
 
+import os
 import sys
 import time
 import re
+import select
 
 # constants for device types
 DEVICE_TELESCOPE   = "TELESCOPE"
@@ -67,6 +69,73 @@ class Rts2NotActive(Exception):
 	def __init__(self):
 		Exception.__init__(self,'script is not active')
 
+class _ScriptInput:
+	"""Lines read from standard input and values pushed by subscriptions.
+	Shared by all Rts2Comm instances of the script."""
+	def __init__(self):
+		self.buf = b''
+		self.lines = []
+		self.eof = False
+		self.subscribed = False
+		# (device, value) -> last value pushed by RTS2
+		self.cache = {}
+
+	def read(self, timeout):
+		"""Reads available data from standard input. Returns false if no data were read."""
+		if self.eof:
+			return False
+		if timeout is not None:
+			r,w,x = select.select([sys.stdin.fileno()],[],[],timeout)
+			if not r:
+				return False
+		data = os.read(sys.stdin.fileno(), 65536)
+		if not data:
+			self.eof = True
+			if self.buf:
+				self.lines.append(self.buf)
+				self.buf = b''
+			return False
+		self.buf += data
+		l = self.buf.split(b'\n')
+		self.buf = l.pop()
+		self.lines += l
+		return True
+
+	def nextLine(self, block=True):
+		"""Returns next line, None if no line is available (or end of input was reached)."""
+		while len(self.lines) == 0:
+			if not self.read(None if block else 0):
+				if self.eof and block:
+					return ''
+				if len(self.lines) == 0:
+					return None
+		return self.decode(self.lines.pop(0))
+
+	def decode(self, a):
+		if not isinstance(a, str):
+			return a.decode('utf-8', 'replace')
+		return a
+
+	def pushed(self, a):
+		"""Process subscription update. Returns true if the line was an update."""
+		if not self.subscribed or a[0:2] != '@ ':
+			return False
+		p = a.split(' ', 3)
+		if len(p) < 3:
+			return False
+		# ignore updates which arrived after unsubscribe
+		if (p[1], p[2]) in self.cache:
+			self.cache[(p[1], p[2])] = p[3] if len(p) > 3 else ''
+		return True
+
+	def drain(self):
+		"""Process all updates waiting on standard input, without blocking."""
+		while self.read(0):
+			pass
+		self.lines = [l for l in self.lines if not self.pushed(self.decode(l))]
+
+_input = _ScriptInput()
+
 class Rts2Comm:
 	"""Class for communicating with RTS2 in exe command."""
 	def __init__(self, log_device = True):
@@ -86,7 +155,10 @@ class Rts2Comm:
 		"""Reads single line from standard input. Checks for exceptions."""
 		ex = None
 		while True:
-			a = sys.stdin.readline().rstrip('\n')
+			a = _input.nextLine()
+			# values pushed by subscriptions can arrive at any time
+			if _input.pushed(a):
+				continue
 			# handle exceptions
 			m = self.exception_re.match(a)
 			if m:
@@ -101,14 +173,51 @@ class Rts2Comm:
 				return a
 
 	def getValue(self,value,device = None):
-		"""Returns given value."""
+		"""Returns given value. Subscribed values are returned from the local cache."""
 		if device is None:
 			print('? {0}'.format(value))
 		else:
+			if _input.cache.get((device,value)) is not None:
+				_input.drain()
+				return _input.cache[(device,value)]
 			print('G {0} {1}'.format(device,value))
 		sys.stdout.flush()
 		return self.readline()
 
+	def getValues(self,values):
+		"""Returns list of values with a single request. Values is list of (value, device) pairs."""
+		if len(values) == 0:
+			return []
+		print('MG {0}'.format(' '.join(['{0} {1}'.format(d,v) for v,d in values])))
+		sys.stdout.flush()
+		return [self.readline() for x in values]
+
+	def subscribe(self,values):
+		"""Subscribe to changes of values, given as list of (value, device) pairs. Changes are pushed
+		by RTS2 and kept in a local cache, so getValue of subscribed value does not need to ask RTS2.
+		Returns number of subscribed values."""
+		_input.subscribed = True
+		for v,d in values:
+			_input.cache.setdefault((d,v), None)
+		print('subscribe {0}'.format(' '.join(['{0} {1}'.format(d,v) for v,d in values])))
+		sys.stdout.flush()
+		ret = self.readline()
+		if ret == 'ERR':
+			self.unsubscribe(values)
+			raise Rts2Exception('subscriptions are not supported')
+		return int(ret)
+
+	def unsubscribe(self,values = None):
+		"""Cancel subscriptions of given (value, device) pairs, or of all values."""
+		if values is None:
+			print('unsubscribe')
+			_input.cache.clear()
+		else:
+			print('unsubscribe {0}'.format(' '.join(['{0} {1}'.format(d,v) for v,d in values])))
+			for v,d in values:
+				_input.cache.pop((d,v), None)
+		sys.stdout.flush()
+
 	def getOwnValue(self, value):
 		print('get_own {0}'.format(value))
 		sys.stdout.flush()
@@ -159,6 +268,13 @@ class Rts2Comm:
 			print("V {0} {1} = {2}".format(device,name,new_value))
 		sys.stdout.flush()
 
+	def setValues(self, values, device):
+		"""Set multiple values of the device with a single line. Values is dictionary of value names and new values."""
+		if len(values) == 0:
+			return
+		print('MV {0}'.format(' '.join(['{0} {1} = "{2}"'.format(device,n,str(v).replace('\\','\\\\').replace('"','\\"')) for n,v in values.items()])))
+		sys.stdout.flush()
+
 	def setOwnValue(self, name, new_value):
 		print('set_own {0} {1}'.format(name, new_value))
 		sys.stdout.flush()
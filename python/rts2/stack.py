@@ -0,0 +1,94 @@
+# Binding to RTS2 native image stacking (librts2image).
+#
+# Stacks FITS images into master bias, dark or flat frames, using all
+# CPUs and bounded memory. Raises StackError if the library cannot be
+# loaded, so callers can fall back to numpy.
+#
+# (C) 2026 RTS2 developers
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation; either
+# version 2.1 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+
+import ctypes
+import ctypes.util
+
+_lib = None
+
+
+class StackError(Exception):
+    pass
+
+
+def _load():
+    global _lib
+    if _lib is not None:
+        return _lib
+    names = [ctypes.util.find_library('rts2image'), 'librts2image.so', 'librts2image.so.0']
+    for n in names:
+        if n is None:
+            continue
+        try:
+            _lib = ctypes.CDLL(n)
+            break
+        except OSError:
+            pass
+    if _lib is None:
+        raise StackError('cannot load librts2image')
+    _lib.rts2image_stack.restype = ctypes.c_int
+    _lib.rts2image_stack.argtypes = [
+        ctypes.c_char_p, ctypes.POINTER(ctypes.c_char_p), ctypes.c_int,
+        ctypes.c_char_p, ctypes.c_char_p, ctypes.c_char_p, ctypes.c_char_p,
+        ctypes.c_double, ctypes.c_int, ctypes.c_int, ctypes.c_int
+    ]
+    return _lib
+
+
+def _b(s):
+    if s is None:
+        return None
+    if isinstance(s, bytes):
+        return s
+    return s.encode('utf-8')
+
+
+def available():
+    """Returns true if native stacking can be used."""
+    try:
+        _load()
+        return True
+    except StackError:
+        return False
+
+
+def stack(
+    output, files, method='median', scale='none', normalize='none',
+    subtract=None, kappa=3.0, iterations=3, reject=1, threads=0
+):
+    """Stack images into output file.
+
+    method -- mean, median, sigclip or minmax
+    scale -- scale each image before stacking (none, mean, median or max)
+    normalize -- normalize result (none, mean, median or max)
+    subtract -- image (master bias or dark) subtracted from each image
+    kappa, iterations -- sigma clipping parameters
+    reject -- number of lowest and highest values rejected by minmax
+    threads -- number of threads, 0 for all CPUs
+    """
+    lib = _load()
+    arr = (ctypes.c_char_p * len(files))(*[_b(f) for f in files])
+    ret = lib.rts2image_stack(
+        _b(output), arr, len(files), _b(method), _b(scale),
+        _b(normalize), _b(subtract), kappa, iterations, reject, threads)
+    if ret != 0:
+        raise StackError('stacking of {0} images to {1} failed'.format(len(files), output))
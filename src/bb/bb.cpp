@@ -21,6 +21,7 @@
 #include "rts2json/directory.h"
 
 #define OPT_WWW_DIR    OPT_LOCAL + 1
+#define OPT_MAX_REQUEST  OPT_LOCAL + 2
 
 using namespace XmlRpc;
 using namespace rts2bb;
@@ -55,6 +56,7 @@ BB::BB (int argc, char ** argv):
 
 	addOption ('p', NULL, 1, "RPC listening port");
 	addOption (OPT_WWW_DIR, "www-directory", 1, "default directory for BB requests");
+	addOption (OPT_MAX_REQUEST, "max-request", 1, "maximal size of (inflated) request body in kB; larger requests are rejected");
 }
 
 void BB::postEvent (rts2core::Event *event)
@@ -86,6 +88,14 @@ int BB::processOption (int opt)
 		case OPT_WWW_DIR:
 			XmlRpcServer::setDefaultGetRequest (new rts2json::Directory (NULL, this, optarg, "index.html", NULL));
 			break;
+		case OPT_MAX_REQUEST:
+			if (atoi (optarg) <= 0)
+			{
+				std::cerr << "invalid maximal request size: " << optarg << std::endl;
+				return -1;
+			}
+			XmlRpcServer::setMaxRequestSize ((size_t) atoi (optarg) * 1024);
+			break;
 		default:
 			return rts2db::DeviceDb::processOption (opt);
 	}
@@ -43,11 +43,6 @@ BBAPI::BBAPI (const char* prefix, rts2json::HTTPServer *_http_server, XmlRpc::Xm
 
 BBAPI::~BBAPI ()
 {
-	for (std::map <int, std::pair <double, JsonParser*> >::iterator iter = observatoriesJsons.begin (); iter != observatoriesJsons.end (); iter++)
-	{
-		g_object_unref (iter->second.second);
-	}
-	observatoriesJsons.clear ();
 }
 
 void BBAPI::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length)
@@ -202,27 +197,23 @@ void BBAPI::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc:
 			Observatory obs (observatory_id);
 			obs.load ();
 
-			JsonParser *newJson = json_parser_new ();
-			GError *error = NULL;
-
-			json_parser_load_from_data (newJson, source->getRequest ().c_str (), source->getRequest ().length (), &error);
-			if (error)
-			{
-				logStream (MESSAGE_ERROR) << "unable to parse request from observatory " << observatory_id << error->code << ":" << error->message << sendLog;
-				g_error_free (error);
-				g_object_unref (newJson);
-				throw JSONException ("unable to parse request");
-			}
-			else
-			{
-				std::map <int, std::pair <double, JsonParser*> >::iterator obs_iter = observatoriesJsons.find (observatory_id);
-				if (obs_iter != observatoriesJsons.end ())
-					g_object_unref (obs_iter->second.second);
-
-				observatoriesJsons[observatory_id] = std::pair <double, JsonParser *> (getNow (), newJson);
-				os << "\"localtime\":" << std::fixed << getNow () << ",\"push\":" << ((obs.getURL ()[0] == '\0') ? "true" : "false");
-				g_object_unref (error);
-			}
+			// observatories without delta support send only full state, without sequence number
+			uint32_t seq = params->getInteger ("seq", 0);
+			uint32_t base = params->getInteger ("base", 0);
+			bool full = params->getInteger ("full", 0) || base == 0;
+
+			bool resync;
+			uint32_t ack = observatoryStates.receive (observatory_id, source->getRequest (), seq, base, full, getNow (), resync);
+			if (observatoryStates.needIngest ())
+				queue->queueTask (new BBIngestTask (&observatoryStates));
+
+			os << "\"localtime\":" << std::fixed << getNow () << ",\"push\":" << ((obs.getURL ()[0] == '\0') ? "true" : "false")
+				<< ",\"seq\":" << ack << ",\"resync\":" << (resync ? "true" : "false")
+#ifdef RTS2_HAVE_ZLIB
+				<< ",\"deflate\":true";
+#else
+				<< ",\"deflate\":false";
+#endif
 		}
 		else if (vals[0] == "obspush")
 		{
@@ -250,11 +241,7 @@ void BBAPI::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc:
 				if (iter != obs.begin ())
 					os << ",";
 
-				double lastup = NAN;
-
-				std::map <int, std::pair <double, JsonParser*> >::iterator obs_iter = observatoriesJsons.find (iter->getId ());
-				if (obs_iter != observatoriesJsons.end ())
-					lastup = obs_iter->second.first;
+				double lastup = observatoryStates.getLastUpdate (iter->getId ());
 
 				os << "\"" << iter->getId () << "\":[" << rts2json::JsonDouble (lastup)
 					<< "," << iter->getPosition ()->lat
@@ -269,49 +256,26 @@ void BBAPI::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc:
 		if (vals.size () < 3)
 			throw JSONException ("insuficient number of subdirs");
 		int observatory_id = atoi (vals[1].c_str ());
-		std::map <int, std::pair <double, JsonParser*> >::iterator iter = observatoriesJsons.find (observatory_id);
-		if (iter == observatoriesJsons.end ())
+		double lastup = observatoryStates.getLastUpdate (observatory_id);
+		if (std::isnan (lastup))
 			throw JSONException ("cannot find data for observatory");
 		if (vals[2] == "api")
 		{
 			if (vals[3] == "devices")
 			{
-				os << "[";
-				GList *devices = json_object_get_members (json_node_get_object (json_parser_get_root (iter->second.second)));
-				for (GList *giter = g_list_first (devices); giter != g_list_last (devices); giter = g_list_next (giter))
-				{
-					if (giter != g_list_first (devices))
-						os << ",";
-					os << "\"" << ((gchar *) g_list_nth_data (giter, 0)) << "\"";
-				}
-				g_list_free (devices);
-				os << "]";
+				if (!observatoryStates.getDevices (observatory_id, os))
+					throw JSONException ("cannot find data for observatory");
 			}
 			else if (vals[3] == "getall")
 			{
-				JsonGenerator *gen = json_generator_new ();
-				json_generator_set_root (gen, json_parser_get_root (iter->second.second));
-
-				gchar *out = json_generator_to_data (gen, NULL);
-				os << out;
-
-				g_free (out);
-				g_object_unref (gen);
+				if (!observatoryStates.getAll (observatory_id, os))
+					throw JSONException ("cannot find data for observatory");
 			}
 			else if (vals[3] == "get")
 			{
 				const char *device = params->getString ("d", "");
-				JsonNode *node = json_object_get_member (json_node_get_object (json_parser_get_root (iter->second.second)), device);
-				if (node == NULL)
+				if (!observatoryStates.getDevice (observatory_id, device, os))
 					throw JSONException ("cannot find device");
-
-				JsonGenerator *gen = json_generator_new ();
-				json_generator_set_root (gen, node);
-				gchar *out = json_generator_to_data (gen, NULL);
-				os << out;
-
-				g_free (out);
-				g_object_unref (gen);
 			}
 			else
 			{
@@ -320,7 +284,7 @@ void BBAPI::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc:
 		}
 		else if (vals[2] == "last_update")
 		{
-			os << iter->second.first;
+			os << lastup;
 		}
 		else
 		{
@@ -42,7 +42,7 @@ class BBAPI:public rts2json::JSONDBRequest
 	private:
 		void executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
 
-		std::map <int, std::pair <double, JsonParser *> > observatoriesJsons;
+		ObservatoryStates observatoryStates;
 
 		BBTasks *queue;
 };
@@ -134,6 +134,14 @@ void BBConfirmTask::confirmTarget (BBSchedules &bbsch, ObservatorySchedule &sche
 	}
 }
 
+int BBIngestTask::run ()
+{
+	int processed = states->ingest ();
+	if (processed > 1)
+		logStream (MESSAGE_DEBUG) << "merged " << processed << " observatory state updates" << sendLog;
+	return 0;
+}
+
 BBTasks::BBTasks (BB *_server):TSQueue <BBTask *> ()
 {
 	send_thread = 0;
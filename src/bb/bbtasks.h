@@ -24,6 +24,7 @@
 
 #include "bbdb.h"
 #include "bbconn.h"
+#include "obsstate.h"
 
 #include <pthread.h>
 #include <glib-object.h>
@@ -106,6 +107,27 @@ class BBConfirmTask:public BBTask
 		void confirmTarget (BBSchedules &bbsch, ObservatorySchedule &schedule);
 };
 
+/**
+ * Merge observatory state updates received by BB API.
+ */
+class BBIngestTask:public BBTask
+{
+	public:
+		BBIngestTask (ObservatoryStates *_states)
+		{
+			states = _states;
+		}
+
+		virtual ~BBIngestTask ()
+		{
+
+		}
+
+		virtual int run ();
+
+	private:
+		ObservatoryStates *states;
+};
 
 /**
  * Queue holding all tasks.
@@ -0,0 +1,304 @@
+/*
+ * State of observatories reported to BB.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "obsstate.h"
+#include "app.h"
+
+#include <math.h>
+#include <string.h>
+
+using namespace rts2bb;
+
+void rts2bb::mergeState (JsonObject *state, JsonObject *delta)
+{
+	GList *devices = json_object_get_members (delta);
+	for (GList *diter = devices; diter != NULL; diter = g_list_next (diter))
+	{
+		const gchar *dname = (const gchar *) diter->data;
+		JsonNode *dnode = json_object_get_member (delta, dname);
+		JsonNode *snode = json_object_get_member (state, dname);
+		if (snode == NULL || !JSON_NODE_HOLDS_OBJECT (snode) || !JSON_NODE_HOLDS_OBJECT (dnode))
+		{
+			json_object_set_member (state, dname, json_node_copy (dnode));
+			continue;
+		}
+
+		JsonObject *sdev = json_node_get_object (snode);
+		JsonObject *ddev = json_node_get_object (dnode);
+
+		GList *members = json_object_get_members (ddev);
+		for (GList *miter = members; miter != NULL; miter = g_list_next (miter))
+		{
+			const gchar *mname = (const gchar *) miter->data;
+			JsonNode *dm = json_object_get_member (ddev, mname);
+			JsonNode *sm = json_object_get_member (sdev, mname);
+			if ((strcmp (mname, "d") == 0 || strcmp (mname, "minmax") == 0) && sm != NULL && JSON_NODE_HOLDS_OBJECT (sm) && JSON_NODE_HOLDS_OBJECT (dm))
+			{
+				JsonObject *sobj = json_node_get_object (sm);
+				JsonObject *dobj = json_node_get_object (dm);
+				GList *vals = json_object_get_members (dobj);
+				for (GList *viter = vals; viter != NULL; viter = g_list_next (viter))
+					json_object_set_member (sobj, (const gchar *) viter->data, json_node_copy (json_object_get_member (dobj, (const gchar *) viter->data)));
+				g_list_free (vals);
+			}
+			else
+			{
+				json_object_set_member (sdev, mname, json_node_copy (dm));
+			}
+		}
+		g_list_free (members);
+	}
+	g_list_free (devices);
+}
+
+ObservatoryStates::ObservatoryStates ()
+{
+	ingestQueued = false;
+	pthread_mutex_init (&mutex, NULL);
+}
+
+ObservatoryStates::~ObservatoryStates ()
+{
+	for (std::map <int, State>::iterator iter = states.begin (); iter != states.end (); iter++)
+	{
+		if (iter->second.root)
+			json_node_free (iter->second.root);
+	}
+	states.clear ();
+	pthread_mutex_destroy (&mutex);
+}
+
+uint32_t ObservatoryStates::receive (int observatory_id, const std::string &body, uint32_t seq, uint32_t base, bool full, double t, bool &resync)
+{
+	pthread_mutex_lock (&mutex);
+	State &st = states[observatory_id];
+
+	resync = false;
+
+	if (!full)
+	{
+		// delta holds all changes after base, so it can be applied to any newer state
+		if (!st.known || base > st.seq)
+		{
+			resync = true;
+			pthread_mutex_unlock (&mutex);
+			return st.seq;
+		}
+		// stale delta
+		if (seq <= st.seq)
+		{
+			pthread_mutex_unlock (&mutex);
+			return st.seq;
+		}
+	}
+	else
+	{
+		// full snapshot replaces everything waiting in queue
+		st.pending.clear ();
+	}
+
+	st.seq = seq;
+	st.known = true;
+	st.lastUpdate = t;
+
+	Update up;
+	up.body = body;
+	up.full = full;
+	st.pending.push_back (up);
+
+	pthread_mutex_unlock (&mutex);
+	return seq;
+}
+
+bool ObservatoryStates::needIngest ()
+{
+	pthread_mutex_lock (&mutex);
+	bool ret = !ingestQueued;
+	ingestQueued = true;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+int ObservatoryStates::ingest ()
+{
+	std::map <int, std::vector <Update> > batch;
+
+	pthread_mutex_lock (&mutex);
+	ingestQueued = false;
+	for (std::map <int, State>::iterator iter = states.begin (); iter != states.end (); iter++)
+	{
+		if (iter->second.pending.empty ())
+			continue;
+		batch[iter->first].swap (iter->second.pending);
+	}
+	pthread_mutex_unlock (&mutex);
+
+	int processed = 0;
+
+	for (std::map <int, std::vector <Update> >::iterator biter = batch.begin (); biter != batch.end (); biter++)
+	{
+		// parse outside of the lock, so readers are not blocked
+		std::vector <JsonParser *> parsed;
+		bool failed = false;
+		bool full = false;
+
+		for (std::vector <Update>::iterator uiter = biter->second.begin (); uiter != biter->second.end (); uiter++)
+		{
+			JsonParser *parser = json_parser_new ();
+			GError *error = NULL;
+			json_parser_load_from_data (parser, uiter->body.c_str (), uiter->body.length (), &error);
+			if (error || !JSON_NODE_HOLDS_OBJECT (json_parser_get_root (parser)))
+			{
+				if (error)
+				{
+					logStream (MESSAGE_ERROR) << "unable to parse state of observatory " << biter->first << " " << error->code << ":" << error->message << sendLog;
+					g_error_free (error);
+				}
+				g_object_unref (parser);
+				failed = true;
+				break;
+			}
+			if (uiter->full)
+			{
+				for (std::vector <JsonParser *>::iterator piter = parsed.begin (); piter != parsed.end (); piter++)
+					g_object_unref (*piter);
+				parsed.clear ();
+				full = true;
+			}
+			parsed.push_back (parser);
+			processed++;
+		}
+
+		pthread_mutex_lock (&mutex);
+		State &st = states[biter->first];
+		if (failed)
+		{
+			// next delta will be refused, observatory will send full snapshot
+			st.known = false;
+		}
+		else
+		{
+			std::vector <JsonParser *>::iterator piter = parsed.begin ();
+			if (full)
+			{
+				if (st.root)
+					json_node_free (st.root);
+				st.root = json_node_copy (json_parser_get_root (*piter));
+				piter++;
+			}
+			if (st.root == NULL)
+			{
+				st.known = false;
+			}
+			else
+			{
+				for (; piter != parsed.end (); piter++)
+					mergeState (json_node_get_object (st.root), json_node_get_object (json_parser_get_root (*piter)));
+			}
+		}
+		pthread_mutex_unlock (&mutex);
+
+		for (std::vector <JsonParser *>::iterator piter = parsed.begin (); piter != parsed.end (); piter++)
+			g_object_unref (*piter);
+	}
+
+	return processed;
+}
+
+double ObservatoryStates::getLastUpdate (int observatory_id)
+{
+	double ret = NAN;
+	pthread_mutex_lock (&mutex);
+	std::map <int, State>::iterator iter = states.find (observatory_id);
+	if (iter != states.end () && iter->second.root)
+		ret = iter->second.lastUpdate;
+	pthread_mutex_unlock (&mutex);
+	return ret;
+}
+
+bool ObservatoryStates::getDevices (int observatory_id, std::ostringstream &os)
+{
+	pthread_mutex_lock (&mutex);
+	std::map <int, State>::iterator iter = states.find (observatory_id);
+	if (iter == states.end () || iter->second.root == NULL)
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+
+	os << "[";
+	GList *devices = json_object_get_members (json_node_get_object (iter->second.root));
+	for (GList *giter = devices; giter != NULL; giter = g_list_next (giter))
+	{
+		if (giter != devices)
+			os << ",";
+		os << "\"" << ((const gchar *) giter->data) << "\"";
+	}
+	g_list_free (devices);
+	os << "]";
+
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
+
+bool ObservatoryStates::getAll (int observatory_id, std::ostringstream &os)
+{
+	pthread_mutex_lock (&mutex);
+	std::map <int, State>::iterator iter = states.find (observatory_id);
+	if (iter == states.end () || iter->second.root == NULL)
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	writeNode (iter->second.root, os);
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
+
+bool ObservatoryStates::getDevice (int observatory_id, const char *device, std::ostringstream &os)
+{
+	pthread_mutex_lock (&mutex);
+	std::map <int, State>::iterator iter = states.find (observatory_id);
+	if (iter == states.end () || iter->second.root == NULL)
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	JsonNode *node = json_object_get_member (json_node_get_object (iter->second.root), device);
+	if (node == NULL)
+	{
+		pthread_mutex_unlock (&mutex);
+		return false;
+	}
+	writeNode (node, os);
+	pthread_mutex_unlock (&mutex);
+	return true;
+}
+
+void ObservatoryStates::writeNode (JsonNode *node, std::ostringstream &os)
+{
+	JsonGenerator *gen = json_generator_new ();
+	json_generator_set_root (gen, node);
+
+	gchar *out = json_generator_to_data (gen, NULL);
+	os << out;
+
+	g_free (out);
+	g_object_unref (gen);
+}
@@ -0,0 +1,152 @@
+/*
+ * State of observatories reported to BB.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_BB_OBSSTATE__
+#define __RTS2_BB_OBSSTATE__
+
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <stdint.h>
+
+#include <json-glib/json-glib.h>
+
+namespace rts2bb
+{
+
+/**
+ * Holds last known state of observatories. Observatories send either full
+ * state snapshot, or delta with values changed since sequence number
+ * acknowledged by BB (see rts2json::StateDelta).
+ *
+ * Updates are only checked for sequence continuity and queued when
+ * received, so the HTTP server is not blocked by parsing of large
+ * requests. Queued updates are parsed and merged by ingest, called from
+ * BB task thread. Updates received while the previous batch is being
+ * processed are coalesced - updates older than the last full snapshot are
+ * dropped.
+ */
+class ObservatoryStates
+{
+	public:
+		ObservatoryStates ();
+		~ObservatoryStates ();
+
+		/**
+		 * Receive observatory update.
+		 *
+		 * @param observatory_id  observatory ID
+		 * @param body            update body (JSON)
+		 * @param seq             update sequence number
+		 * @param base            sequence number delta is based on
+		 * @param full            true if update is full snapshot
+		 * @param t               time when update was received
+		 * @param resync          set to true if delta cannot be applied and full snapshot is needed
+		 *
+		 * @return acknowledged sequence number
+		 */
+		uint32_t receive (int observatory_id, const std::string &body, uint32_t seq, uint32_t base, bool full, double t, bool &resync);
+
+		/**
+		 * Returns true if ingest task shall be queued. Returns true only
+		 * once until ingest is called.
+		 */
+		bool needIngest ();
+
+		/**
+		 * Parse and merge queued updates.
+		 *
+		 * @return number of processed updates
+		 */
+		int ingest ();
+
+		/**
+		 * Time of the last received update, NAN if observatory has not
+		 * reported its state.
+		 */
+		double getLastUpdate (int observatory_id);
+
+		/**
+		 * Write JSON array with device names.
+		 *
+		 * @return false if state of observatory is not known
+		 */
+		bool getDevices (int observatory_id, std::ostringstream &os);
+
+		/**
+		 * Write full state as JSON.
+		 */
+		bool getAll (int observatory_id, std::ostringstream &os);
+
+		/**
+		 * Write state of a single device.
+		 *
+		 * @return false if state of observatory or device is not known
+		 */
+		bool getDevice (int observatory_id, const char *device, std::ostringstream &os);
+
+	private:
+		struct Update
+		{
+			std::string body;
+			bool full;
+		};
+
+		struct State
+		{
+			State ()
+			{
+				root = NULL;
+				seq = 0;
+				known = false;
+				lastUpdate = 0;
+			}
+
+			JsonNode *root;
+			// sequence of the last accepted update
+			uint32_t seq;
+			// false if delta cannot be accepted
+			bool known;
+			double lastUpdate;
+			std::vector <Update> pending;
+		};
+
+		std::map <int, State> states;
+		bool ingestQueued;
+
+		pthread_mutex_t mutex;
+
+		void writeNode (JsonNode *node, std::ostringstream &os);
+};
+
+/**
+ * Merge delta of observatory state into stored state. Values ("d") and
+ * "minmax" objects are merged member by member, other members of device
+ * objects are replaced.
+ *
+ * @param state  stored state object, devices as members
+ * @param delta  delta object
+ */
+void mergeState (JsonObject *state, JsonObject *delta);
+
+}
+
+#endif // !__RTS2_BB_OBSSTATE__
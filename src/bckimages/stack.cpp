@@ -0,0 +1,184 @@
+/*
+ * Stack calibration images (bias, dark, flat) into master frame.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "cliapp.h"
+#include "error.h"
+#include "rts2fits/imagestack.h"
+
+#include <iostream>
+#include <stdlib.h>
+
+#define OPT_MEMORY     OPT_LOCAL + 1
+#define OPT_KAPPA      OPT_LOCAL + 2
+#define OPT_ITER       OPT_LOCAL + 3
+#define OPT_REJECT     OPT_LOCAL + 4
+
+/**
+ * Stacks images into master calibration frame.
+ */
+class StackApp:public rts2core::CliApp
+{
+	public:
+		StackApp (int in_argc, char **in_argv);
+
+		virtual int doProcessing ();
+
+	protected:
+		virtual int processOption (int in_opt);
+		virtual int processArgs (const char *arg);
+		virtual void usage ();
+
+	private:
+		rts2image::ImageStack stack;
+		const char *output;
+		bool verbose;
+
+		float kappaLow;
+		float kappaHigh;
+		int iterations;
+		int nlow;
+		int nhigh;
+};
+
+StackApp::StackApp (int in_argc, char **in_argv):rts2core::CliApp (in_argc, in_argv), stack ()
+{
+	output = NULL;
+	verbose = false;
+	kappaLow = kappaHigh = 3;
+	iterations = 3;
+	nlow = nhigh = 1;
+
+	addOption ('o', NULL, 1, "output file (will be overwritten)");
+	addOption ('m', NULL, 1, "stacking method - mean, median (default), sigclip or minmax");
+	addOption ('s', NULL, 1, "scale images before stacking - none (default), mean, median or max");
+	addOption ('n', NULL, 1, "normalize result - none (default), mean, median or max");
+	addOption ('b', NULL, 1, "subtract given image (master bias or dark) from images before stacking");
+	addOption ('j', NULL, 1, "number of threads (default to number of CPUs)");
+	addOption ('v', NULL, 0, "print frame levels");
+	addOption (OPT_KAPPA, "kappa", 1, "sigma clipping limit, low:high or single value (default 3)");
+	addOption (OPT_ITER, "iterations", 1, "sigma clipping iterations (default 3)");
+	addOption (OPT_REJECT, "reject", 1, "number of lowest:highest values rejected by minmax (default 1:1)");
+	addOption (OPT_MEMORY, "memory", 1, "memory used for image bands, in MB (default 512)");
+}
+
+int StackApp::processOption (int in_opt)
+{
+	rts2image::stackMethod_t method;
+	rts2image::stackScale_t sc;
+	char *end;
+	switch (in_opt)
+	{
+		case 'o':
+			output = optarg;
+			break;
+		case 'm':
+			if (rts2image::stackMethodFromString (optarg, method))
+			{
+				std::cerr << "unknown stacking method " << optarg << std::endl;
+				return -1;
+			}
+			stack.setMethod (method);
+			break;
+		case 's':
+		case 'n':
+			if (rts2image::stackScaleFromString (optarg, sc))
+			{
+				std::cerr << "unknown scaling " << optarg << std::endl;
+				return -1;
+			}
+			if (in_opt == 's')
+				stack.setScale (sc);
+			else
+				stack.setNormalize (sc);
+			break;
+		case 'b':
+			stack.setSubtract (optarg);
+			break;
+		case 'j':
+			stack.setThreads (atoi (optarg));
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case OPT_KAPPA:
+			kappaLow = strtod (optarg, &end);
+			kappaHigh = (*end == ':') ? atof (end + 1) : kappaLow;
+			break;
+		case OPT_ITER:
+			iterations = atoi (optarg);
+			break;
+		case OPT_REJECT:
+			nlow = strtol (optarg, &end, 10);
+			nhigh = (*end == ':') ? atoi (end + 1) : nlow;
+			break;
+		case OPT_MEMORY:
+			stack.setMemoryLimit ((size_t) atol (optarg) * 1024 * 1024);
+			break;
+		default:
+			return rts2core::CliApp::processOption (in_opt);
+	}
+	return 0;
+}
+
+int StackApp::processArgs (const char *arg)
+{
+	stack.addFile (arg);
+	return 0;
+}
+
+void StackApp::usage ()
+{
+	std::cout
+		<< "  rts2-stack -o master_bias.fits bias*.fits                       .. median of bias frames" << std::endl
+		<< "  rts2-stack -m sigclip -o master_dark.fits -b master_bias.fits dark*.fits  .. sigma clipped mean of bias subtracted darks" << std::endl
+		<< "  rts2-stack -s mean -n max -o master_flat.fits flat*.fits         .. median of flats, each scaled to mean, result normalized to maximum" << std::endl;
+}
+
+int StackApp::doProcessing ()
+{
+	if (output == NULL)
+	{
+		std::cerr << "output file was not specified" << std::endl;
+		return -1;
+	}
+	stack.setSigmaClip (kappaLow, kappaHigh, iterations);
+	stack.setMinMax (nlow, nhigh);
+	try
+	{
+		stack.stack (output);
+	}
+	catch (rts2core::Error &er)
+	{
+		std::cerr << er << std::endl;
+		return -1;
+	}
+	if (verbose)
+	{
+		for (int i = 0; i < stack.getFiles (); i++)
+			std::cout << stack.getFile (i) << " " << stack.getFrameLevel (i) << std::endl;
+		std::cout << output << " " << stack.getOutputLevel () << std::endl;
+	}
+	return 0;
+}
+
+int main (int argc, char **argv)
+{
+	StackApp app (argc, argv);
+	return app.run ();
+}
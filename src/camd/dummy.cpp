@@ -132,6 +132,7 @@ class Dummy:public Camera
 
 		virtual ~Dummy (void)
 		{
+			stopReadoutThread ();
 			readoutSleep = NULL;
 			delete[] written;
 		}
@@ -242,6 +243,7 @@ class Dummy:public Camera
 		{
 			if (fitsTransfer->getValueBool ())
 				setFitsTransfer ();
+			generateStars ();
 			written[0] = -1;
 			if (channels)
 			{
@@ -269,6 +271,8 @@ class Dummy:public Camera
 
 		virtual bool supportFrameTransfer () { return supportFrameT; }
 	protected:
+		virtual bool supportThreadedReadout () { return true; }
+
 		virtual void initBinnings ()
 		{
 			Camera::initBinnings ();
@@ -345,6 +349,16 @@ class Dummy:public Camera
 
 		bool showTemp;
 
+		// star positions of the current exposure, used by the readout thread
+		std::vector <double> starX;
+		std::vector <double> starY;
+
+		/**
+		 * Generate positions of artificial stars for the exposure.
+		 * Called from the main loop, as it changes values.
+		 */
+		void generateStars ();
+
 		void generateImage (size_t pixelsize, int chan);
 
 		template <typename dt> void generateData (dt *data, size_t pixelsize);
@@ -547,7 +561,7 @@ int Dummy::doReadout ()
 	return 0;					 // imediately send new data
 }
 
-void Dummy::generateImage (size_t pixelsize, int chan)
+void Dummy::generateStars ()
 {
 	// artifical star center
 	astar_Xp->clear ();
@@ -571,12 +585,18 @@ void Dummy::generateImage (size_t pixelsize, int chan)
 	sendValueAll (astar_Xp);
 	sendValueAll (astar_Yp);
 
+	starX = astar_Xp->getValueVector ();
+	starY = astar_Yp->getValueVector ();
+
 	if (genType->getValueInteger () == 6)
 	{
 		// Make it again random
 		srandom (0 + time (NULL) + getExposureNumber ());
 	}
+}
 
+void Dummy::generateImage (size_t pixelsize, int chan)
+{
 	switch (getDataType ())
 	{
 		case RTS2_DATA_BYTE:
@@ -700,10 +720,10 @@ template <typename dt> void Dummy::generateData (dt *data, size_t pixelSize)
 			int x = i % getUsedWidthBinned ();
 			int y = i / getUsedWidthBinned ();
 
-			for (int j = 0; j < astar_num->getValueInteger (); j++)
+			for (size_t j = 0; j < starX.size (); j++)
 			{
-				double aax = x - (*astar_Xp)[j];
-				double aay = y - (*astar_Yp)[j];
+				double aax = x - starX[j];
+				double aay = y - starY[j];
 
 				if (fabs (aax) < xmax && fabs (aay) < ymax)
 				{
@@ -720,10 +740,10 @@ template <typename dt> void Dummy::generateData (dt *data, size_t pixelSize)
 			int x = i % getUsedWidthBinned ();
 			int y = i / getUsedWidthBinned ();
 
-			for (int j = 0; j < astar_num->getValueInteger (); j++)
+			for (size_t j = 0; j < starX.size (); j++)
 			{
-				double aax = x - (*astar_Xp)[j];
-				double aay = y - (*astar_Yp)[j];
+				double aax = x - starX[j];
+				double aay = y - starY[j];
 
 				double r = hypot (aax, aay);
 				double flux = pow (1.0 + j, -magSlope); // Distribution of relative fluxes
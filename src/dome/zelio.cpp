@@ -26,6 +26,11 @@
 #define DEFAULT_DEADMAN_TIMEOUT_S      60
 #define DEFAULT_COOLDOWN_LOCKOUT_S     1200    // Heat dissipation
 
+// maximal age of cached register values, in seconds. Inputs are changed
+// only by the driver, writes invalidate them
+#define ZELIO_INPUTS_MAX_AGE     2.0
+#define ZELIO_OUTPUTS_MAX_AGE    0.5
+
 // Zelio registers
 
 #define ZREG_J1XT1       16
@@ -242,6 +247,8 @@ class Zelio:public Dome
 		rts2core::ValueInteger *O4XT1;
 
 		rts2core::ConnModbus *zelioConn;
+		// cached registers, polls read all of them in a single transaction
+		rts2core::ModbusScanner *zelioRegs;
 
 	  	int setBitsInput (uint16_t reg, uint16_t mask, bool value);
 
@@ -258,15 +265,10 @@ using namespace rts2dome;
 
 int Zelio::setBitsInput (uint16_t reg, uint16_t mask, bool value)
 {
-	uint16_t oldValue;
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, reg, 1, &oldValue);
-		// switch mask..
-		oldValue &= ~mask;
-		if (value)
-			oldValue |= mask;
-		zelioConn->writeHoldingRegister (unitId, reg, oldValue);
+		// masked write reads the register from the device, not the cached value
+		zelioRegs->writeHoldingRegisterMask (reg, mask, value ? mask : 0);
 	}
 	catch (rts2core::ConnError err)
 	{
@@ -286,8 +288,10 @@ int Zelio::startOpen ()
 
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, ZREG_O4XT1, 1, &reg);
-		zelioConn->readHoldingRegisters (unitId, ZREG_J1XT1, 1, &reg_J1);
+		// decide on current state
+		zelioRegs->invalidateAll ();
+		zelioRegs->readHoldingRegisters (ZREG_O4XT1, 1, &reg);
+		zelioRegs->readHoldingRegisters (ZREG_J1XT1, 1, &reg_J1);
 		if (!(reg & ZS_SW_AUTO))
 		{
 			logStream (MESSAGE_WARNING) << "dome not in auto mode" << sendLog;
@@ -319,9 +323,9 @@ int Zelio::startOpen ()
 			logStream (MESSAGE_WARNING) << "current battery level (" << battery->getValueFloat () << ") is bellow minimal level (" << batteryMin->getValueFloat () << sendLog;
 		}
 
-		zelioConn->writeHoldingRegisterMask (unitId, ZREG_J1XT1, ZI_DEADMAN_MASK, deadTimeout->getValueInteger ());
-		zelioConn->writeHoldingRegisterMask (unitId, ZREG_J2XT1, ZI_DEADN_MASK, 0);
-		zelioConn->writeHoldingRegisterMask (unitId, ZREG_J2XT1, ZI_DEADN_MASK, 1);
+		zelioRegs->writeHoldingRegisterMask (ZREG_J1XT1, ZI_DEADMAN_MASK, deadTimeout->getValueInteger ());
+		zelioRegs->writeHoldingRegisterMask (ZREG_J2XT1, ZI_DEADN_MASK, 0);
+		zelioRegs->writeHoldingRegisterMask (ZREG_J2XT1, ZI_DEADN_MASK, 1);
 	}
 	catch (rts2core::ConnError err)
 	{
@@ -343,9 +347,9 @@ bool Zelio::isGoodWeather ()
 	uint16_t reg3;
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, ZREG_O4XT1, 1, &reg);
+		zelioRegs->readHoldingRegisters (ZREG_O4XT1, 1, &reg);
 		if (haveBatteryLevel || haveHumidityOutput || zelioModel == ZELIO_ELYA)
-			zelioConn->readHoldingRegisters (unitId, ZREG_O3XT1, 1, &reg3);
+			zelioRegs->readHoldingRegisters (ZREG_O3XT1, 1, &reg3);
 	}
 	catch (rts2core::ConnError err)
 	{
@@ -354,9 +358,9 @@ bool Zelio::isGoodWeather ()
 		try
 		{
 			zelioConn->init ();
-			zelioConn->readHoldingRegisters (unitId, ZREG_O4XT1, 1, &reg);
+			zelioRegs->readHoldingRegisters (ZREG_O4XT1, 1, &reg);
 			if (haveBatteryLevel || haveHumidityOutput || zelioModel == ZELIO_ELYA)
-				zelioConn->readHoldingRegisters (unitId, ZREG_O3XT1, 1, &reg3);
+				zelioRegs->readHoldingRegisters (ZREG_O3XT1, 1, &reg3);
 		}
 		catch (rts2core::ConnError err2)
 		{
@@ -509,7 +513,7 @@ long Zelio::isOpened ()
 	uint16_t regs[2];
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, ZREG_O1XT1, 2, regs);
+		zelioRegs->readHoldingRegisters (ZREG_O1XT1, 2, regs);
 		sendSwInfo (regs);
 	}
 	catch (rts2core::ConnError err)
@@ -526,7 +530,7 @@ long Zelio::isOpened ()
 		try
 		{
 			zelioConn->init ();
-			zelioConn->readHoldingRegisters (unitId, ZREG_O1XT1, 2, regs);
+			zelioRegs->readHoldingRegisters (ZREG_O1XT1, 2, regs);
 			sendSwInfo (regs);
 		}
 		catch (rts2core::ConnError er)
@@ -572,15 +576,15 @@ int Zelio::startClose ()
 		{
 			case ZELIO_ELYA:
 				// ELYA needs to set timeout to some small value, not 0
-				zelioConn->writeHoldingRegisterMask (unitId, ZREG_J1XT1, ZI_DEADMAN_MASK, 1);
+				zelioRegs->writeHoldingRegisterMask (ZREG_J1XT1, ZI_DEADMAN_MASK, 1);
 				break;
 			default:
-				zelioConn->writeHoldingRegisterMask (unitId, ZREG_J1XT1, ZI_DEADMAN_MASK, 0);
+				zelioRegs->writeHoldingRegisterMask (ZREG_J1XT1, ZI_DEADMAN_MASK, 0);
 		}
 		try
 		{
 			// update automode status..
-			zelioConn->readHoldingRegisters (unitId, ZREG_O4XT1, 1, &reg);
+			zelioRegs->readHoldingRegisters (ZREG_O4XT1, 1, &reg);
 			automode->setValueBool (reg & ZS_SW_AUTO);
 			// reset ignore rain value
 			if (ignoreRain && ignoreRain->getValueBool ())
@@ -618,7 +622,7 @@ long Zelio::isClosed ()
 	uint16_t regs[2];
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, ZREG_O1XT1, 2, regs);
+		zelioRegs->readHoldingRegisters (ZREG_O1XT1, 2, regs);
 		sendSwInfo (regs);
 	}
 	catch (rts2core::ConnError err)
@@ -725,7 +729,7 @@ void Zelio::postEvent (rts2core::Event *event)
 			{
 			  	try
 				{
-					zelioConn->writeHoldingRegisterMask (unitId, ZREG_J2XT1, ZI_DEADN_MASK, deadManNum);
+					zelioRegs->writeHoldingRegisterMask (ZREG_J2XT1, ZI_DEADN_MASK, deadManNum);
 				}
 				catch (rts2core::ConnError err)
 				{
@@ -749,6 +753,8 @@ Zelio::Zelio (int argc, char **argv):Dome (argc, argv)
 	closeErrorReported = false;
 
 	unitId = 0;
+	zelioConn = NULL;
+	zelioRegs = NULL;
 
 	createValue (zelioModelString, "zelio_model", "String with Zelio model", false);
 
@@ -823,6 +829,7 @@ Zelio::Zelio (int argc, char **argv):Dome (argc, argv)
 
 Zelio::~Zelio (void)
 {
+	delete zelioRegs;
 	delete zelioConn;
 	delete host;
 }
@@ -832,7 +839,7 @@ int Zelio::info ()
 	uint16_t regs[8];
 	try
 	{
-		zelioConn->readHoldingRegisters (unitId, 16, 8, regs);
+		zelioRegs->readHoldingRegisters (16, 8, regs);
 	}
 	catch (rts2core::ConnError err)
 	{
@@ -841,7 +848,7 @@ int Zelio::info ()
 		{
 			sleep (2);
 			zelioConn->init ();
-			zelioConn->readHoldingRegisters (unitId, 16, 8, regs);
+			zelioRegs->readHoldingRegisters (16, 8, regs);
 		}
 		catch (rts2core::ConnError err2)
 		{
@@ -975,13 +982,16 @@ int Zelio::initHardware ()
 		return -1;
 	}
 	zelioConn = new rts2core::ConnModbusTCP (this, host->getHostname (), host->getPort ());
+	zelioRegs = new rts2core::ModbusScanner (zelioConn, unitId);
+	zelioRegs->addRegisters (ZREG_J1XT1, 4, ZELIO_INPUTS_MAX_AGE);
+	zelioRegs->addRegisters (ZREG_O1XT1, 4, ZELIO_OUTPUTS_MAX_AGE);
 
 	uint16_t regs[8];
 
 	try
 	{
 		zelioConn->init ();
-		zelioConn->readHoldingRegisters (unitId, 16, 8, regs);
+		zelioRegs->readHoldingRegisters (16, 8, regs);
 	}
 	catch (rts2core::ConnError er)
 	{
@@ -1248,22 +1258,22 @@ int Zelio::setValue (rts2core::Value *oldValue, rts2core::Value *newValue)
 	{
 		if (oldValue == J1XT1)
 		{
-			zelioConn->writeHoldingRegister (unitId, ZREG_J1XT1, newValue->getValueInteger ());
+			zelioRegs->writeHoldingRegister (ZREG_J1XT1, newValue->getValueInteger ());
 			return 0;
 		}
 		else if (oldValue == J2XT1)
 		{
-			zelioConn->writeHoldingRegister (unitId, ZREG_J2XT1, newValue->getValueInteger ());
+			zelioRegs->writeHoldingRegister (ZREG_J2XT1, newValue->getValueInteger ());
 			return 0;
 		}
 		else if (oldValue == J3XT1)
 		{
-			zelioConn->writeHoldingRegister (unitId, ZREG_J3XT1, newValue->getValueInteger ());
+			zelioRegs->writeHoldingRegister (ZREG_J3XT1, newValue->getValueInteger ());
 			return 0;
 		}
 		else if (oldValue == J4XT1)
 		{
-			zelioConn->writeHoldingRegister (unitId, ZREG_J4XT1, newValue->getValueInteger ());
+			zelioRegs->writeHoldingRegister (ZREG_J4XT1, newValue->getValueInteger ());
 			return 0;
 		}
 		else if (oldValue == domeTimeout)
@@ -1276,11 +1286,11 @@ int Zelio::setValue (rts2core::Value *oldValue, rts2core::Value *newValue)
 				// user switched timeout
 				nreg |= 0x8000;
 				// put in value
-				zelioConn->writeHoldingRegisterMask (unitId, ZREG_J2XT1, ZI_USER_TIO_MASK | ZI_TIMEOUT_MASK, nreg);
+				zelioRegs->writeHoldingRegisterMask (ZREG_J2XT1, ZI_USER_TIO_MASK | ZI_TIMEOUT_MASK, nreg);
 			}
 			else
 			{
-				zelioConn->writeHoldingRegisterMask (unitId, ZREG_J2XT1, ZI_USER_TIO_MASK, 0);
+				zelioRegs->writeHoldingRegisterMask (ZREG_J2XT1, ZI_USER_TIO_MASK, 0);
 			}
 		}
 	}
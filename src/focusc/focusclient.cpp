@@ -41,6 +41,8 @@
 #define OPT_NOSYNC          OPT_LOCAL + 53
 #define OPT_DARK            OPT_LOCAL + 54
 #define OPT_IGNORE_BLOCK    OPT_LOCAL + 55
+#define OPT_PHOTOMETER_TABLE OPT_LOCAL + 56
+#define OPT_PHOTOMETER_BURST OPT_LOCAL + 57
 
 #define CHECK_TIMER         0.1
 
@@ -147,6 +149,8 @@ FocusClient::FocusClient (int in_argc, char **in_argv):rts2core::Client (in_argc
 	photometerFile = NULL;
 	photometerTime = 1;
 	photometerFilterChange = 0;
+	photometerTable = NULL;
+	photometerBurst = 0;
 	configFile = NULL;
 
 	bop = BOP_EXPOSURE;
@@ -172,6 +176,8 @@ FocusClient::FocusClient (int in_argc, char **in_argv):rts2core::Client (in_argc
 	addOption (OPT_PHOTOMETER_TIME, "photometer_time", 1, "photometer integration time (in seconds); default to 1 second");
 	addOption (OPT_CHANGE_FILTER, "change_filter", 1, "change filter on photometer after taking n counts; default to 0 (don't change)");
 	addOption (OPT_SKIP_FILTER, "skip_filter", 1, "Skip that filter number");
+	addOption (OPT_PHOTOMETER_TABLE, "photometer_table", 1, "save photometer burst samples to FITS binary table");
+	addOption (OPT_PHOTOMETER_BURST, "photometer_burst", 1, "start burst of n photometer integrations (0 until stopped) instead of single integrations");
 }
 
 FocusClient::~FocusClient (void)
@@ -243,6 +249,14 @@ int FocusClient::processOption (int in_opt)
 		case OPT_SKIP_FILTER:
 			skipFilters.push_back (atoi (optarg));
 			break;
+		case OPT_PHOTOMETER_TABLE:
+			photometerTable = optarg;
+			break;
+		case OPT_PHOTOMETER_BURST:
+			photometerBurst = atoi (optarg);
+			if (photometerBurst < 0)
+				photometerBurst = 0;
+			break;
 		default:
 			return rts2core::Client::processOption (in_opt);
 	}
@@ -304,7 +318,7 @@ rts2core::DevClient *FocusClient::createOtherType (rts2core::Connection * conn,
 		case DEVICE_TYPE_FOCUS:
 			return new rts2image::DevClientFocusFoc (conn);
 		case DEVICE_TYPE_PHOT:
-			return new rts2image::DevClientPhotFoc (conn, photometerFile, photometerTime, photometerFilterChange, skipFilters);
+			return new rts2image::DevClientPhotFoc (conn, photometerFile, photometerTime, photometerFilterChange, skipFilters, photometerTable, photometerBurst);
 		case DEVICE_TYPE_DOME:
 		case DEVICE_TYPE_MIRROR:
 		case DEVICE_TYPE_SENSOR:
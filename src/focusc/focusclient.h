@@ -86,6 +86,8 @@ class FocusClient:public rts2core::Client
 		char *photometerFile;
 		float photometerTime;
 		int photometerFilterChange;
+		char *photometerTable;
+		int photometerBurst;
 
 		std::vector < int >skipFilters;
 
@@ -0,0 +1,243 @@
+/*
+ * Reads frames from camera shared memory frame ring.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "cliapp.h"
+#include "error.h"
+#include "shmring.h"
+#include "utilsfunc.h"
+#include "rts2fits/image.h"
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <arpa/inet.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Attach to shared memory frame ring of a camera (started with --shm-ring)
+ * and print or save frames published to it.
+ */
+class ShmFramesApp:public rts2core::CliApp
+{
+	public:
+		ShmFramesApp (int in_argc, char **in_argv);
+		virtual ~ShmFramesApp ();
+
+		virtual int doProcessing ();
+
+	protected:
+		virtual int processOption (int in_opt);
+		virtual int processArgs (const char *arg);
+		virtual void usage ();
+		virtual void afterProcessing ();
+
+	private:
+		rts2core::ShmRingReader reader;
+		std::string ringName;
+		const char *prefix;
+		bool every;
+		long count;
+		double interval;
+
+		long frames;
+
+		char *buf;
+		char *chanBuf;
+
+		int saveFrame (rts2core::ShmFrameInfo &info);
+};
+
+ShmFramesApp::ShmFramesApp (int in_argc, char **in_argv):rts2core::CliApp (in_argc, in_argv), reader ()
+{
+	prefix = NULL;
+	every = false;
+	count = 0;
+	interval = 0.01;
+
+	frames = 0;
+
+	buf = NULL;
+	chanBuf = NULL;
+
+	addOption ('e', NULL, 0, "read every frame in order (default to the latest frame)");
+	addOption ('c', NULL, 1, "number of frames to read (default to read until interrupted)");
+	addOption ('i', NULL, 1, "interval between checks for new frame, in seconds (default 0.01)");
+	addOption ('o', NULL, 1, "save frames to FITS files starting with given prefix, followed by frame number");
+}
+
+ShmFramesApp::~ShmFramesApp ()
+{
+	delete[] buf;
+	delete[] chanBuf;
+}
+
+int ShmFramesApp::processOption (int in_opt)
+{
+	switch (in_opt)
+	{
+		case 'e':
+			every = true;
+			break;
+		case 'c':
+			count = atol (optarg);
+			break;
+		case 'i':
+			interval = atof (optarg);
+			if (interval < 0)
+			{
+				std::cerr << "invalid interval " << optarg << std::endl;
+				return -1;
+			}
+			break;
+		case 'o':
+			prefix = optarg;
+			break;
+		default:
+			return rts2core::CliApp::processOption (in_opt);
+	}
+	return 0;
+}
+
+int ShmFramesApp::processArgs (const char *arg)
+{
+	if (ringName.length () > 0)
+	{
+		std::cerr << "only single camera or ring can be specified" << std::endl;
+		return -1;
+	}
+	// camera names its ring /rts2_<device name>
+	if (arg[0] == '/')
+		ringName = arg;
+	else
+		ringName = std::string ("/rts2_") + arg;
+	return 0;
+}
+
+void ShmFramesApp::usage ()
+{
+	std::cout
+		<< "  rts2-shmframes C0                    .. print latest frames published by camera C0" << std::endl
+		<< "  rts2-shmframes -e -o /tmp/c0_ C0     .. save every frame of camera C0 to /tmp/c0_<frame>.fits" << std::endl
+		<< "  rts2-shmframes -c 1 -o last_ /rts2_C0 .. save single frame from ring /rts2_C0" << std::endl;
+}
+
+int ShmFramesApp::saveFrame (rts2core::ShmFrameInfo &info)
+{
+	std::ostringstream fn;
+	fn << prefix << std::setfill ('0') << std::setw (8) << info.frame << ".fits";
+
+	struct timeval tv;
+	tv.tv_sec = (time_t) info.timestamp;
+	tv.tv_usec = (suseconds_t) ((info.timestamp - tv.tv_sec) * USEC_SEC);
+
+	rts2image::Image *image = NULL;
+	try
+	{
+		image = new rts2image::Image (fn.str ().c_str (), &tv, true, false, false);
+		size_t off = 0;
+		for (int i = 0; i < info.channels; i++)
+		{
+			// image header is in network order, as sent to camera clients
+			struct imghdr *hdr = (struct imghdr *) chanBuf;
+			memcpy (hdr, &(info.header), sizeof (struct imghdr));
+			hdr->channel = htons (i);
+			memcpy (chanBuf + sizeof (struct imghdr), buf + off, info.chanSizes[i]);
+			if (image->writeData (chanBuf, chanBuf + sizeof (struct imghdr) + info.chanSizes[i], info.channels))
+			{
+				std::cerr << "cannot write channel " << i << " to " << fn.str () << std::endl;
+				delete image;
+				return -1;
+			}
+			off += info.chanSizes[i];
+		}
+		image->saveImage ();
+	}
+	catch (rts2core::Error &er)
+	{
+		std::cerr << er << std::endl;
+		delete image;
+		return -1;
+	}
+	delete image;
+	std::cout << " " << fn.str ();
+	return 0;
+}
+
+int ShmFramesApp::doProcessing ()
+{
+	if (ringName.length () == 0)
+	{
+		std::cerr << "camera or ring name was not specified" << std::endl;
+		return -1;
+	}
+	if (reader.attach (ringName.c_str ()))
+	{
+		std::cerr << "cannot attach to shared memory frame ring " << ringName << ": " << strerror (errno) << std::endl;
+		return -1;
+	}
+
+	buf = new char[reader.getSlotSize ()];
+	if (prefix)
+		chanBuf = new char[sizeof (struct imghdr) + reader.getSlotSize ()];
+
+	rts2core::ShmFrameInfo info;
+
+	while (!getEndLoop () && (count <= 0 || frames < count))
+	{
+		int ret = every ? reader.readNext (buf, info) : reader.readLatest (buf, info);
+		if (ret < 0)
+		{
+			std::cerr << "cannot read frame from " << ringName << std::endl;
+			return -1;
+		}
+		if (ret == 0)
+		{
+			usleep (interval * USEC_SEC);
+			continue;
+		}
+		frames++;
+		std::cout << std::setw (8) << info.frame << " " << std::fixed << std::setprecision (3) << info.timestamp << " " << info.channels << " " << info.size;
+		if (every)
+			std::cout << " lost " << reader.getLost ();
+		if (prefix && saveFrame (info))
+			return -1;
+		std::cout << std::endl;
+	}
+	return 0;
+}
+
+void ShmFramesApp::afterProcessing ()
+{
+	// not attached
+	if (buf == NULL)
+		return;
+	std::cout << "read " << frames << " of " << reader.getPublished () << " published frames";
+	if (every)
+		std::cout << ", lost " << reader.getLost ();
+	std::cout << std::endl;
+}
+
+int main (int argc, char **argv)
+{
+	ShmFramesApp app (argc, argv);
+	return app.run ();
+}
@@ -0,0 +1,603 @@
+/*
+ * Replay recorded GCN packets to GRBD and measure GRB alert latency.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "client.h"
+#include "connnosend.h"
+#include "devclient.h"
+#include "grbconst.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <libnova/libnova.h>
+
+#define OPT_GCN_PORT        OPT_LOCAL + 60
+#define OPT_DELAY           OPT_LOCAL + 61
+#define OPT_TIMEOUT         OPT_LOCAL + 62
+#define OPT_NOW             OPT_LOCAL + 63
+
+#define EVENT_REPLAY_NEXT     RTS2_LOCAL_EVENT + 610
+#define EVENT_REPLAY_TIMEOUT  RTS2_LOCAL_EVENT + 611
+
+namespace rts2grbd
+{
+
+class GcnReplay;
+
+/**
+ * Listen for GRBD connection. GRBD shall be started with --gcn-host
+ * pointing to the host running replay, and --gcn-port set to port passed
+ * to the replay.
+ */
+class ConnReplayListen:public rts2core::ConnNoSend
+{
+	public:
+		ConnReplayListen (GcnReplay *_master, int _port);
+		virtual int init ();
+		virtual int receive (rts2core::Block *block);
+
+	private:
+		GcnReplay *replay;
+		int port;
+};
+
+/**
+ * Connection to GRBD. Sends packets and receives echoed packets, as GCN
+ * server does (see socket_demo.c in this directory for the client side).
+ */
+class ConnReplay:public rts2core::ConnNoSend
+{
+	public:
+		ConnReplay (int _sock, GcnReplay *_master);
+		virtual int receive (rts2core::Block *block);
+		virtual void connectionError (int last_data_size);
+
+		int sendPacket (int32_t *nbuf);
+
+	private:
+		GcnReplay *replay;
+		int32_t echo[SIZ_PKT];
+		int echoBytes;
+};
+
+/**
+ * Passes trace values of GRBD and executor to replay.
+ */
+class TraceClient:public rts2core::DevClient
+{
+	public:
+		TraceClient (rts2core::Connection *_connection, GcnReplay *_replay):rts2core::DevClient (_connection) { replay = _replay; }
+		virtual void valueChanged (rts2core::Value *value);
+
+	private:
+		GcnReplay *replay;
+};
+
+/**
+ * Replays packets recorded from GCN socket and collects latency of each
+ * stage of GRB alert processing - packet echo, parsing, executor decision,
+ * mount command and start of the slew, together with time needed to
+ * record the GRB in the database. Distribution of the latencies is printed
+ * when all packets were replayed.
+ *
+ * Latencies reported by GRBD and executor are measured relative to GRBD
+ * reception time, so replay does not need synchronized clocks. Replay
+ * shall run on the same machine as GRBD to match trace values to replayed
+ * packets.
+ */
+class GcnReplay:public rts2core::Client
+{
+	public:
+		GcnReplay (int argc, char **argv);
+		virtual ~GcnReplay ();
+
+		virtual rts2core::DevClient *createOtherType (rts2core::Connection *conn, int other_device_type);
+		virtual void postEvent (rts2core::Event *event);
+
+		void grbdConnected (ConnReplay *conn);
+		void grbdDisconnected (ConnReplay *conn);
+		void packetEcho (int32_t *nbuf);
+		void traceValue (int device_type, rts2core::Value *value);
+
+	protected:
+		virtual int processOption (int opt);
+		virtual int processArgs (const char *arg);
+		virtual int init ();
+		virtual void usage ();
+
+	private:
+		int port;
+		double delay;
+		double timeout;
+		bool shiftTime;
+
+		std::vector <std::string> files;
+		std::vector <int32_t *> packets;
+		size_t current;
+
+		ConnReplay *grbdConn;
+
+		// trace of the current packet
+		double sent;
+		double deadline;
+		bool waiting;
+		bool execDone;
+		bool grbdDone;
+		double tracePacket;
+
+		std::map <std::string, std::vector <double> > stages;
+		std::vector <std::string> stageOrder;
+		int timeouts;
+
+		int loadPackets (const char *fn);
+		void sendNext ();
+		void packetDone ();
+		void addStage (const char *stage, double value);
+		void printStatistics ();
+};
+
+}
+
+using namespace rts2grbd;
+
+ConnReplayListen::ConnReplayListen (GcnReplay *_master, int _port):rts2core::ConnNoSend (_master)
+{
+	replay = _master;
+	port = _port;
+}
+
+int ConnReplayListen::init ()
+{
+	sock = socket (PF_INET, SOCK_STREAM, 0);
+	if (sock == -1)
+	{
+		logStream (MESSAGE_ERROR) << "cannot create listen socket " << strerror (errno) << sendLog;
+		return -1;
+	}
+	const int so_reuseaddr = 1;
+	setsockopt (sock, SOL_SOCKET, SO_REUSEADDR, &so_reuseaddr, sizeof (so_reuseaddr));
+	struct sockaddr_in server;
+	server.sin_family = AF_INET;
+	server.sin_port = htons (port);
+	server.sin_addr.s_addr = htonl (INADDR_ANY);
+	if (bind (sock, (struct sockaddr *) &server, sizeof (server)) == -1)
+	{
+		logStream (MESSAGE_ERROR) << "cannot bind to port " << port << ": " << strerror (errno) << sendLog;
+		return -1;
+	}
+	if (listen (sock, 1))
+	{
+		logStream (MESSAGE_ERROR) << "cannot listen: " << strerror (errno) << sendLog;
+		close (sock);
+		sock = -1;
+		return -1;
+	}
+	return 0;
+}
+
+int ConnReplayListen::receive (rts2core::Block *block)
+{
+	if (sock >= 0 && block->isForRead (sock))
+	{
+		struct sockaddr_in other_side;
+		socklen_t addr_size = sizeof (struct sockaddr_in);
+		int new_sock = accept (sock, (struct sockaddr *) &other_side, &addr_size);
+		if (new_sock == -1)
+		{
+			logStream (MESSAGE_ERROR) << "accept " << strerror (errno) << sendLog;
+			return 0;
+		}
+		logStream (MESSAGE_INFO) << "GRBD connected from " << inet_ntoa (other_side.sin_addr) << " port " << ntohs (other_side.sin_port) << sendLog;
+		ConnReplay *conn = new ConnReplay (new_sock, replay);
+		replay->addConnection (conn);
+		replay->grbdConnected (conn);
+	}
+	return 0;
+}
+
+ConnReplay::ConnReplay (int _sock, GcnReplay *_master):rts2core::ConnNoSend (_sock, _master)
+{
+	replay = _master;
+	echoBytes = 0;
+	setConnState (CONN_CONNECTED);
+}
+
+int ConnReplay::receive (rts2core::Block *block)
+{
+	if (sock < 0 || !block->isForRead (sock))
+		return 0;
+
+	int ret = read (sock, ((char *) echo) + echoBytes, sizeof (echo) - echoBytes);
+	if (ret <= 0)
+	{
+		connectionError (ret);
+		return -1;
+	}
+	successfullRead ();
+	echoBytes += ret;
+	if (echoBytes == sizeof (echo))
+	{
+		echoBytes = 0;
+		replay->packetEcho (echo);
+	}
+	return ret;
+}
+
+void ConnReplay::connectionError (int last_data_size)
+{
+	replay->grbdDisconnected (this);
+	rts2core::ConnNoSend::connectionError (last_data_size);
+}
+
+int ConnReplay::sendPacket (int32_t *nbuf)
+{
+	int ret = write (sock, nbuf, SIZ_PKT * sizeof (nbuf[0]));
+	if (ret != (int) (SIZ_PKT * sizeof (nbuf[0])))
+	{
+		logStream (MESSAGE_ERROR) << "cannot send packet: " << strerror (errno) << sendLog;
+		connectionError (-1);
+		return -1;
+	}
+	successfullSend ();
+	return 0;
+}
+
+void TraceClient::valueChanged (rts2core::Value *value)
+{
+	replay->traceValue (getConnection ()->getOtherType (), value);
+	rts2core::DevClient::valueChanged (value);
+}
+
+GcnReplay::GcnReplay (int argc, char **argv):rts2core::Client (argc, argv, "gcnreplay")
+{
+	port = 5348;
+	delay = 1;
+	timeout = 10;
+	shiftTime = false;
+	current = 0;
+	grbdConn = NULL;
+
+	sent = NAN;
+	deadline = NAN;
+	waiting = false;
+	execDone = false;
+	grbdDone = false;
+	tracePacket = NAN;
+	timeouts = 0;
+
+	addOption (OPT_GCN_PORT, "gcn-port", 1, "port on which replay waits for GRBD connection (default to 5348)");
+	addOption (OPT_DELAY, "delay", 1, "delay in seconds between end of processing of a packet and sending the next packet (default to 1)");
+	addOption (OPT_TIMEOUT, "timeout", 1, "seconds to wait for trace of the packet (default to 10)");
+	addOption (OPT_NOW, "now", 0, "change packet and burst times to the current time");
+}
+
+GcnReplay::~GcnReplay ()
+{
+	for (std::vector <int32_t *>::iterator iter = packets.begin (); iter != packets.end (); iter++)
+		delete[] *iter;
+}
+
+int GcnReplay::processOption (int opt)
+{
+	switch (opt)
+	{
+		case OPT_GCN_PORT:
+			port = atoi (optarg);
+			break;
+		case OPT_DELAY:
+			delay = atof (optarg);
+			break;
+		case OPT_TIMEOUT:
+			timeout = atof (optarg);
+			break;
+		case OPT_NOW:
+			shiftTime = true;
+			break;
+		default:
+			return rts2core::Client::processOption (opt);
+	}
+	return 0;
+}
+
+int GcnReplay::processArgs (const char *arg)
+{
+	files.push_back (std::string (arg));
+	return 0;
+}
+
+void GcnReplay::usage ()
+{
+	std::cout << "  " << getAppName () << " --gcn-port 5348 packets.bin     .. replay packets from packets.bin, GRBD must be started with --gcn-host localhost --gcn-port 5348" << std::endl
+		<< " Packet files hold packets as received from GCN socket - " << SIZ_PKT << " 32bit integers in network byte order per packet." << std::endl;
+}
+
+int GcnReplay::loadPackets (const char *fn)
+{
+	std::ifstream is (fn, std::ios::binary);
+	if (is.fail ())
+	{
+		std::cerr << "cannot open " << fn << ": " << strerror (errno) << std::endl;
+		return -1;
+	}
+	while (true)
+	{
+		int32_t *nbuf = new int32_t[SIZ_PKT];
+		is.read ((char *) nbuf, SIZ_PKT * sizeof (int32_t));
+		if (is.gcount () != SIZ_PKT * sizeof (int32_t))
+		{
+			delete[] nbuf;
+			break;
+		}
+		packets.push_back (nbuf);
+	}
+	return 0;
+}
+
+int GcnReplay::init ()
+{
+	int ret = rts2core::Client::init ();
+	if (ret)
+		return ret;
+
+	if (files.empty ())
+	{
+		std::cerr << "you must specify file(s) with recorded packets" << std::endl;
+		return -1;
+	}
+
+	for (std::vector <std::string>::iterator iter = files.begin (); iter != files.end (); iter++)
+	{
+		if (loadPackets (iter->c_str ()))
+			return -1;
+	}
+	if (packets.empty ())
+	{
+		std::cerr << "no packets found in input files" << std::endl;
+		return -1;
+	}
+
+	const char *names[] = {"echo", "grbd parse", "grbd forward", "grbd database", "exec parse", "exec decision", "exec command", "slew start"};
+	for (size_t i = 0; i < sizeof (names) / sizeof (names[0]); i++)
+		stageOrder.push_back (names[i]);
+
+	ConnReplayListen *listenConn = new ConnReplayListen (this, port);
+	ret = listenConn->init ();
+	if (ret)
+	{
+		delete listenConn;
+		return -1;
+	}
+	addConnection (listenConn);
+
+	std::cout << "loaded " << packets.size () << " packets, waiting for GRBD connection on port " << port << std::endl;
+	return 0;
+}
+
+rts2core::DevClient *GcnReplay::createOtherType (rts2core::Connection *conn, int other_device_type)
+{
+	switch (other_device_type)
+	{
+		case DEVICE_TYPE_GRB:
+		case DEVICE_TYPE_EXECUTOR:
+			return new TraceClient (conn, this);
+	}
+	return rts2core::Client::createOtherType (conn, other_device_type);
+}
+
+void GcnReplay::postEvent (rts2core::Event *event)
+{
+	switch (event->getType ())
+	{
+		case EVENT_REPLAY_NEXT:
+			sendNext ();
+			break;
+		case EVENT_REPLAY_TIMEOUT:
+			if (waiting && getNow () >= deadline)
+			{
+				timeouts++;
+				packetDone ();
+			}
+			break;
+	}
+	rts2core::Client::postEvent (event);
+}
+
+void GcnReplay::grbdConnected (ConnReplay *conn)
+{
+	if (grbdConn)
+		return;
+	grbdConn = conn;
+	addTimer (delay, new rts2core::Event (EVENT_REPLAY_NEXT, this));
+}
+
+void GcnReplay::grbdDisconnected (ConnReplay *conn)
+{
+	if (conn != grbdConn)
+		return;
+	grbdConn = NULL;
+	std::cerr << "GRBD disconnected after " << current << " packets" << std::endl;
+	printStatistics ();
+	endRunLoop ();
+}
+
+void GcnReplay::sendNext ()
+{
+	if (grbdConn == NULL)
+		return;
+	if (current >= packets.size ())
+	{
+		printStatistics ();
+		endRunLoop ();
+		return;
+	}
+
+	int32_t *nbuf = packets[current];
+	int type = ntohl (nbuf[PKT_TYPE]);
+
+	if (shiftTime)
+	{
+		struct timeval tv;
+		gettimeofday (&tv, NULL);
+		double JD = ln_get_julian_from_timet (&tv.tv_sec) + tv.tv_usec / USEC_SEC / 86400.0;
+		int32_t sod = (int32_t) (fmod (tv.tv_sec, 86400) * 100 + tv.tv_usec / 10000);
+		nbuf[PKT_SOD] = htonl (sod);
+		nbuf[BURST_TJD] = htonl ((int32_t) floor (JD - 2440000.5));
+		nbuf[BURST_SOD] = htonl (sod);
+	}
+
+	sent = getNow ();
+	if (grbdConn->sendPacket (nbuf))
+		return;
+
+	// only position packets produce trace
+	waiting = !(type == TYPE_IM_ALIVE || type == TYPE_TEST_COORDS || type == TYPE_KILL_SOCKET);
+	execDone = false;
+	grbdDone = false;
+	tracePacket = NAN;
+
+	if (waiting)
+	{
+		deadline = sent + timeout;
+		addTimer (timeout, new rts2core::Event (EVENT_REPLAY_TIMEOUT, this));
+	}
+}
+
+void GcnReplay::packetEcho (int32_t *nbuf)
+{
+	if (std::isnan (sent))
+		return;
+	addStage ("echo", getNow () - sent);
+	if (!waiting)
+		packetDone ();
+}
+
+void GcnReplay::traceValue (int device_type, rts2core::Value *value)
+{
+	if (!waiting)
+		return;
+
+	if (device_type == DEVICE_TYPE_GRB)
+	{
+		// GRBD sends its trace values after the packet was recorded in the database
+		if (!strcmp (value->getName ().c_str (), "fast_parse"))
+			addStage ("grbd parse", value->getValueDouble ());
+		else if (!strcmp (value->getName ().c_str (), "fast_forward"))
+		{
+			addStage ("grbd forward", value->getValueDouble ());
+			// position was not passed to executor
+			if (std::isnan (value->getValueDouble ()))
+				execDone = true;
+		}
+		else if (!strcmp (value->getName ().c_str (), "db_recorded"))
+		{
+			addStage ("grbd database", value->getValueDouble ());
+			grbdDone = true;
+		}
+	}
+	else if (device_type == DEVICE_TYPE_EXECUTOR)
+	{
+		if (!strcmp (value->getName ().c_str (), "grb_fast_packet"))
+		{
+			// trace of older packet
+			if (value->getValueDouble () < sent)
+				return;
+			tracePacket = value->getValueDouble ();
+		}
+		if (std::isnan (tracePacket))
+			return;
+		if (!strcmp (value->getName ().c_str (), "grb_fast_parse"))
+			addStage ("exec parse", value->getValueDouble ());
+		else if (!strcmp (value->getName ().c_str (), "grb_fast_decision"))
+			addStage ("exec decision", value->getValueDouble ());
+		else if (!strcmp (value->getName ().c_str (), "grb_fast_command"))
+		{
+			addStage ("exec command", value->getValueDouble ());
+			// GRB was not accepted, slew will not follow
+			if (std::isnan (value->getValueDouble ()))
+				execDone = true;
+		}
+		else if (!strcmp (value->getName ().c_str (), "grb_fast_slew") && !std::isnan (value->getValueDouble ()))
+		{
+			addStage ("slew start", value->getValueDouble ());
+			execDone = true;
+		}
+	}
+
+	if (execDone && grbdDone)
+		packetDone ();
+}
+
+void GcnReplay::packetDone ()
+{
+	waiting = false;
+	sent = NAN;
+	current++;
+	if (current % 10 == 0)
+		std::cout << "replayed " << current << " of " << packets.size () << " packets" << std::endl;
+	addTimer (delay, new rts2core::Event (EVENT_REPLAY_NEXT, this));
+}
+
+void GcnReplay::addStage (const char *stage, double value)
+{
+	if (std::isnan (value))
+		return;
+	stages[std::string (stage)].push_back (value);
+}
+
+void GcnReplay::printStatistics ()
+{
+	std::cout << std::endl << "replayed " << current << " packets, " << timeouts << " timeouts" << std::endl
+		<< std::setw (15) << "stage" << std::setw (8) << "count"
+		<< std::setw (12) << "min" << std::setw (12) << "median" << std::setw (12) << "90%"
+		<< std::setw (12) << "99%" << std::setw (12) << "max" << std::setw (12) << "mean" << std::endl;
+
+	std::cout << std::fixed << std::setprecision (6);
+	for (std::vector <std::string>::iterator iter = stageOrder.begin (); iter != stageOrder.end (); iter++)
+	{
+		std::vector <double> &v = stages[*iter];
+		std::cout << std::setw (15) << *iter << std::setw (8) << v.size ();
+		if (v.empty ())
+		{
+			std::cout << std::endl;
+			continue;
+		}
+		std::sort (v.begin (), v.end ());
+		double sum = 0;
+		for (std::vector <double>::iterator viter = v.begin (); viter != v.end (); viter++)
+			sum += *viter;
+		std::cout << std::setw (12) << v.front ()
+			<< std::setw (12) << v[v.size () / 2]
+			<< std::setw (12) << v[(size_t) (v.size () * 0.9)]
+			<< std::setw (12) << v[(size_t) (v.size () * 0.99)]
+			<< std::setw (12) << v.back ()
+			<< std::setw (12) << sum / v.size () << std::endl;
+	}
+}
+
+int main (int argc, char **argv)
+{
+	GcnReplay app (argc, argv);
+	return app.run ();
+}
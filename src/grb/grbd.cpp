@@ -19,6 +19,7 @@
 
 #include "command.h"
 #include "grbd.h"
+#include "libnova_cpp.h"
 
 using namespace rts2grbd;
 
@@ -31,6 +32,7 @@ using namespace rts2grbd;
 #define OPT_GCN_EXE             OPT_LOCAL + 55
 #define OPT_GCN_FOLLOUPS        OPT_LOCAL + 56
 #define OPT_QUEUE               OPT_LOCAL + 57
+#define OPT_NO_FAST_PATH        OPT_LOCAL + 58
 
 Grbd::Grbd (int in_argc, char **in_argv):DeviceDb (in_argc, in_argv, DEVICE_TYPE_GRB, "GRB")
 {
@@ -68,6 +70,13 @@ Grbd::Grbd (int in_argc, char **in_argv):DeviceDb (in_argc, in_argv, DEVICE_TYPE
 	createValue (lastIntegral, "last_integral", "time of last INTEGRAL position", false);
 	createValue (lastIntegralRaDec, "last_integral_position", "INTEGRAL current position", false);
 
+	createValue (fastPath, "fast_path", "if true, GRB positions are passed to executor before they are recorded in the database", false, RTS2_VALUE_WRITABLE);
+	fastPath->setValueBool (true);
+
+	createValue (fastParse, "fast_parse", "[s] time from reception of the last GCN packet to parsed GRB position", false);
+	createValue (fastForward, "fast_forward", "[s] time from reception of the last GCN packet to fast path command sent to executor", false);
+	createValue (dbRecorded, "db_recorded", "[s] time from reception of the last GCN packet to its recording in the database", false);
+
 	createValue (recordNotVisible, "not_visible", "record GRBs not visible from the current location", false, RTS2_VALUE_WRITABLE);
 	recordNotVisible->setValueBool (true);
 
@@ -86,6 +95,7 @@ Grbd::Grbd (int in_argc, char **in_argv):DeviceDb (in_argc, in_argv, DEVICE_TYPE
 	addOption (OPT_GCN_EXE, "add-exec", 1, "execute that command when new GCN packet arrives");
 	addOption (OPT_GCN_FOLLOUPS, "exec-followups", 0, "execute observation and add-exec script even for follow-ups without error box (currently Swift follow-ups of INTEGRAL and HETE GRBs)");
 	addOption (OPT_QUEUE, "queue-to", 1, "queue GRBs to following queue (using now command)");
+	addOption (OPT_NO_FAST_PATH, "no-fast-path", 0, "do not pass GRB positions to executor before they are recorded in the database");
 }
 
 Grbd::~Grbd (void)
@@ -125,6 +135,9 @@ int Grbd::processOption (int in_opt)
 		case OPT_QUEUE:
 			queueName = optarg;
 			break;	
+		case OPT_NO_FAST_PATH:
+			fastPath->setValueBool (false);
+			break;
 		default:
 			return DeviceDb::processOption (in_opt);
 	}
@@ -326,6 +339,60 @@ int Grbd::newGcnGrb (int tar_id)
 	return 0;
 }
 
+int Grbd::fastGcnGrb (int grb_id, int grb_type, double ra, double dec, float errorbox, double t_packet)
+{
+	double now = getNow ();
+	fastParse->setValueDouble (now - t_packet);
+	fastForward->setValueDouble (NAN);
+	dbRecorded->setValueDouble (NAN);
+
+	if (grb_enabled->getValueBool () != true || fastPath->getValueBool () != true)
+		return -1;
+
+	std::pair <int, int> key (grb_type, grb_id);
+	std::map <std::pair <int, int>, FastGrb>::iterator iter = fastGrbs.find (key);
+	if (iter != fastGrbs.end ())
+	{
+		// pass only better positions
+		if (std::isnan (errorbox) || (!std::isnan (iter->second.errorbox) && errorbox >= iter->second.errorbox))
+			return -1;
+	}
+	else
+	{
+		// forget GRBs older than a day
+		for (std::map <std::pair <int, int>, FastGrb>::iterator oiter = fastGrbs.begin (); oiter != fastGrbs.end ();)
+		{
+			if (oiter->second.t_packet < now - 86400)
+				fastGrbs.erase (oiter++);
+			else
+				oiter++;
+		}
+	}
+
+	rts2core::Connection *exec = getOpenConnection (DEVICE_TYPE_EXECUTOR);
+	if (exec == NULL)
+		return -1;
+
+	FastGrb fg;
+	fg.errorbox = errorbox;
+	fg.t_packet = t_packet;
+	fastGrbs[key] = fg;
+
+	exec->queCommand (new rts2core::CommandExecGrbFast (this, grb_id, ra, dec, errorbox, t_packet, now));
+
+	fastForward->setValueDouble (getNow () - t_packet);
+	logStream (MESSAGE_INFO) << "passed GRB " << grb_id << " at " << LibnovaRaDec (ra, dec) << " to executor " << fastForward->getValueDouble () << " seconds after GCN packet reception" << sendLog;
+	return 0;
+}
+
+void Grbd::gcnRecorded (double t_packet)
+{
+	dbRecorded->setValueDouble (getNow () - t_packet);
+	sendValueAll (fastParse);
+	sendValueAll (fastForward);
+	sendValueAll (dbRecorded);
+}
+
 int Grbd::commandAuthorized (rts2core::Connection * conn)
 {
 	if (conn->isCommand ("test"))
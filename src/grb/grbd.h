@@ -24,6 +24,8 @@
 #include "conngrb.h"
 #include "rts2grbfw.h"
 
+#include <map>
+
 // when we get GRB packet..
 #define RTS2_EVENT_GRB_PACKET      RTS2_LOCAL_EVENT + 600
 #define EVENT_TIMER_GCNCNN_INIT    RTS2_LOCAL_EVENT + 601
@@ -60,6 +62,29 @@ class Grbd:public rts2db::DeviceDb
 
 		int newGcnGrb (int tar_id);
 
+		/**
+		 * Pass GRB position to executor before it is recorded in the
+		 * database. Position is passed only if it is the first one for
+		 * given GRB, or if its errorbox is smaller than errorbox of the
+		 * position already passed.
+		 *
+		 * @param grb_id     GRB ID
+		 * @param grb_type   start of GCN packet type range (mission)
+		 * @param ra         GRB RA (J2000)
+		 * @param dec        GRB DEC (J2000)
+		 * @param errorbox   GRB errorbox, NAN if not known
+		 * @param t_packet   time when GCN packet was received
+		 *
+		 * @return 0 if position was passed to executor, -1 otherwise
+		 */
+		int fastGcnGrb (int grb_id, int grb_type, double ra, double dec, float errorbox, double t_packet);
+
+		/**
+		 * Called after GCN packet with GRB position was recorded in
+		 * the database and executor was notified.
+		 */
+		void gcnRecorded (double t_packet);
+
 		virtual int commandAuthorized (rts2core::Connection * conn);
 
 		void updateSwift (double lastTime, double ra, double dec);
@@ -111,6 +136,19 @@ class Grbd:public rts2db::DeviceDb
 		rts2core::ValueTime *lastIntegral;
 		rts2core::ValueRaDec *lastIntegralRaDec;
 
+		rts2core::ValueBool *fastPath;
+		rts2core::ValueDouble *fastParse;
+		rts2core::ValueDouble *fastForward;
+		rts2core::ValueDouble *dbRecorded;
+
+		// errorboxes of GRBs passed through fast path, indexed by mission and GRB ID
+		struct FastGrb
+		{
+			float errorbox;
+			double t_packet;
+		};
+		std::map <std::pair <int, int>, FastGrb> fastGrbs;
+
 		rts2core::ValueBool *recordNotVisible;
 		rts2core::ValueBool *recordOnlyVisibleTonight;
 		rts2core::ValueDouble *minGrbAltitude;
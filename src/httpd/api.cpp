@@ -82,20 +82,9 @@ void getCameraParameters (XmlRpc::HttpParams *params, const char *&camera, long
 	smin = params->getLong ("smin", LONG_MIN);
 	smax = params->getLong ("smax", LONG_MAX);
 
-	const char *scalings[] = { "lin", "log", "sqrt", "pow" };
 	const char *sc = params->getString ("scaling", "");
-	scaling = rts2image::SCALING_LINEAR;
-	if (sc[0] != '\0')
-	{
-		for (int i = 0; i < 3; i++)
-		{
-			if (!strcasecmp (sc, scalings[i]))
-			{
-				scaling = (rts2image::scaling_type) i;
-				break;
-			}
-		}
-	}
+	if (sc[0] == '\0' || rts2image::scalingFromString (sc, scaling))
+		scaling = rts2image::SCALING_LINEAR;
 
 	newType = params->getInteger ("2data", 0);
 }
@@ -123,6 +112,28 @@ void sendSelection (std::ostringstream &os, rts2core::ValueSelection *value)
 
 }
 
+bool API::isThreaded (const std::string &path, XmlRpc::HttpParams *params)
+{
+	std::vector <std::string> vals = SplitStr (path, std::string ("/"));
+	if (vals.size () != 1)
+		return false;
+	if (vals[0] == "sunalt")
+		return true;
+#ifdef RTS2_HAVE_PGSQL
+	// chunked target list writes directly to the connection
+	if (vals[0] == "tbyname")
+		return params->getInteger ("ch", 0) == 0;
+	// read-only database calls
+	const char *dbcalls[] = {"script", "taltitudes", "tlist", "tbyid", "tbylabel", "tbydistance", "tbystring", "ibyoid", "labels", "resolve", "obytid", "lastobs", "obyid", "stat_obylid", "plan", "labellist", "messages", "auger"};
+	for (size_t i = 0; i < sizeof (dbcalls) / sizeof (dbcalls[0]); i++)
+	{
+		if (vals[0] == dbcalls[i])
+			return true;
+	}
+#endif // RTS2_HAVE_PGSQL
+	return false;
+}
+
 void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length)
 {
 	std::vector <std::string> vals = SplitStr (path, std::string ("/"));
@@ -184,17 +195,25 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 				throw JSONException ("converting from integer into float type, or from float to integer");
 
 			response_type = "binary/data";
-			response_length = image->getPixelByteSize () * image->getChannelNPixels (chan);
-			if (newType != 0)
-				response_length /= (ntohs (im_h.data_type) / newType);
-
-			response_length += sizeof (imghdr);
+			size_t npix = image->getChannelNPixels (chan);
+			response_length = sizeof (imghdr) + (newType != 0 ? rts2image::pixelByteSize (newType) : image->getPixelByteSize ()) * npix;
 
 			response = new char[response_length];
 
 			if (newType != 0)
 			{
-				memcpy (response + sizeof (imghdr), image->getChannelDataScaled (chan, smin, smax, scaling, newType), response_length - sizeof (imghdr));
+				// scale to response, image data are kept for next requests
+				rts2image::PixelScaler scaler (smin, smax, scaling, newType);
+				double q = params->getDouble ("q", 0);
+				// histogram is cached in the image channel
+				if (q > 0 && q < 0.5)
+					scaler.setQuantileLimits (*(image->getChannelPixelHistogram (chan)), q);
+				if (scaler.scale (image->getDataType (), image->getChannelData (chan), response + sizeof (imghdr), npix) == false)
+				{
+					delete[] response;
+					response = NULL;
+					throw JSONException ("cannot scale image to given data type");
+				}
 				im_h.data_type = htons (newType);
 			}
 			else
@@ -204,6 +223,12 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 			memcpy (response, &im_h, sizeof (imghdr));
 			return;
 		}
+		// statistics in Prometheus format
+		else if (vals[0] == "metrics")
+		{
+			getMetrics (response_type, response, response_length);
+			return;
+		}
 		// calls returning arrays
 		else if (vals[0] == "devices")
 		{
@@ -535,7 +560,7 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 					if ((*iter)->getName ()[0] == '\0')
 						continue;
 					os << ",\"" << (*iter)->getName () << "\":{";
-					rts2json::sendConnectionValues (os, *iter, params, from, ext);
+					master->getSnapshot ().sendConnectionValues (os, *iter, params, from, ext);
 					os << '}';
 				}
 			}
@@ -553,7 +578,7 @@ void API::executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::H
 						conn = master->getOpenConnection (device);
 					if (conn == NULL)
 						throw JSONException ("cannot find device");
-					rts2json::sendConnectionValues (os, conn, params, from, ext);
+					master->getSnapshot ().sendConnectionValues (os, conn, params, from, ext);
 				}
 				else
 				{
@@ -815,3 +840,41 @@ void API::getWidgets (const std::vector <std::string> &vals, XmlRpc::HttpParams
 	response = new char[response_length];
 	memcpy (response, os.str ().c_str (), response_length);
 }
+
+void API::getMetrics (const char* &response_type, char* &response, size_t &response_length)
+{
+	rts2core::PrometheusWriter pw;
+	HttpD * master = (HttpD*) getMasterApp ();
+
+	pw.family ("rts2_instrumentation_enabled", "gauge") << "rts2_instrumentation_enabled " << rts2core::statsEnabled () << "\n";
+
+	std::string dl = rts2core::prometheusLabel ("device", master->getDeviceName ());
+	master->getLoopStats ().writePrometheus (pw, dl);
+	master->getExecutor ().getQueueWait ().writePrometheus (pw, "rts2_httpd_queue_wait_seconds", dl);
+	master->getExecutor ().getHandlerTime ().writePrometheus (pw, "rts2_httpd_handler_seconds", dl);
+
+	for (connections_t::iterator iter = master->getConnections ()->begin (); iter != master->getConnections ()->end (); iter++)
+	{
+		if ((*iter)->getName ()[0] == '\0')
+			continue;
+		(*iter)->getStats ().writePrometheus (pw, dl + "," + rts2core::prometheusLabel ("peer", (*iter)->getName ()));
+		// statistics reported by the device itself
+		const char *dv[] = {"loop_lag", "loop_poll", "loop_idle", "command_rtt", "bytes_received", "bytes_sent", "binary_rate", "suppressed_updates"};
+		for (size_t i = 0; i < sizeof (dv) / sizeof (dv[0]); i++)
+		{
+			rts2core::Value *val = (*iter)->getValue (dv[i]);
+			if (val == NULL || isnan (val->getValueDouble ()))
+				continue;
+			std::string name = std::string ("rts2_device_") + dv[i];
+			pw.family (name, "gauge") << name << "{" << rts2core::prometheusLabel ("device", (*iter)->getName ()) << "} " << val->getValueDouble () << "\n";
+		}
+	}
+
+	std::ostringstream os;
+	pw.write (os);
+
+	response_type = "text/plain; version=0.0.4";
+	response_length = os.str ().length ();
+	response = new char[response_length];
+	memcpy (response, os.str ().c_str (), response_length);
+}
@@ -51,10 +51,21 @@ class API:public rts2json::JSONRequest
 		void sendOwnValues (std::ostringstream & os, XmlRpc::HttpParams *params, double from, bool extended);
 
 	protected:
+		/**
+		 * Database queries and calculations not touching device
+		 * connections are executed in worker threads.
+		 */
+		virtual bool isThreaded (const std::string &path, XmlRpc::HttpParams *params);
+
 		virtual void executeJSON (XmlRpc::XmlRpcSource *source, std::string path, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
 	
 	private:
 		void getWidgets (const std::vector <std::string> &vals, XmlRpc::HttpParams *params, const char* &response_type, char* &response, size_t &response_length);
+
+		/**
+		 * Returns connection and event loop statistics in Prometheus text format.
+		 */
+		void getMetrics (const char* &response_type, char* &response, size_t &response_length);
 };
 
 }
@@ -25,6 +25,7 @@
 
 #include "hoststring.h"
 #include "daemon.h"
+#include "valueminmax.h"
 
 #ifdef RTS2_JSONSOUP
 #include <glib-object.h>
@@ -101,6 +102,12 @@ BBServer::BBServer (HttpD *_server, char *_serverApi, int _observatoryId, char *
 	send_thread = 0;
 	push_thread = 0;
 
+	lastFull = 0;
+	pthread_mutex_init (&pendingMutex, NULL);
+	pendingSeq = 0;
+	pendingBase = 0;
+	ackedSeq = 0;
+
 #ifdef RTS2_JSONSOUP
 	g_type_init ();
 #endif // RTS2_JSONSOUP
@@ -111,6 +118,7 @@ BBServer::~BBServer ()
 	pthread_cancel (send_thread);
 	pthread_cancel (push_thread);
 	delete client;
+	pthread_mutex_destroy (&pendingMutex);
 }
 
 void BBServer::postEvent (rts2core::Event *event)
@@ -118,7 +126,8 @@ void BBServer::postEvent (rts2core::Event *event)
 	switch (event->getType ())
 	{
 		case EVENT_XMLRPC_BB:
-			queueUpdate (-1);
+			if (prepareUpdate ())
+				queueUpdate (-1);
 			server->addTimer (getCadency (), event);
 			return;
 	}
@@ -137,31 +146,115 @@ XmlRpc::XmlRpcClient *BBServer::createClient ()
 	return ret;
 }
 
-void BBServer::sendUpdate ()
+void BBServer::trackConnection (rts2core::Connection *conn)
 {
-	if (client == NULL)
-		client = createClient ();
+	std::string dev (conn->getName ());
+	std::ostringstream os;
+	os << std::fixed;
 
-	std::ostringstream body;
+	double mfrom = NAN;
 
-	bool first = true;
+	for (rts2core::ValueVector::iterator iter = conn->valueBegin (); iter != conn->valueEnd (); iter++)
+	{
+		if (conn->getOtherDevClient ())
+		{
+			double ch = ((rts2json::DevInterface *) (conn->getOtherDevClient ()))->getValueChangedTime (*iter);
+			if (std::isnan (mfrom) || ch > mfrom)
+				mfrom = ch;
+		}
+
+		os.str ("");
+		rts2json::jsonValueData (*iter, true, os);
+		stateDelta.setMember (dev, rts2json::SECTION_VALUES, (*iter)->getName (), os.str ());
+
+		if ((*iter)->getValueExtType () == RTS2_VALUE_MMAX && (*iter)->getValueBaseType () == RTS2_VALUE_DOUBLE)
+		{
+			rts2core::ValueDoubleMinMax *v = (rts2core::ValueDoubleMinMax *) (*iter);
+			os.str ("");
+			os << "[" << rts2json::JsonDouble (v->getMin ()) << "," << rts2json::JsonDouble (v->getMax ()) << "]";
+			stateDelta.setMember (dev, rts2json::SECTION_MINMAX, v->getName (), os.str ());
+		}
+	}
 
-	body << "{";
+	os.str ("");
+	os << conn->isIdle ();
+	stateDelta.setMember (dev, rts2json::SECTION_HEADER, "idle", os.str ());
+
+	os.str ("");
+	os << conn->getState ();
+	stateDelta.setMember (dev, rts2json::SECTION_HEADER, "state", os.str ());
+
+	os.str ("");
+	os << rts2json::JsonDouble (conn->getProgressStart ());
+	stateDelta.setMember (dev, rts2json::SECTION_HEADER, "sstart", os.str ());
+
+	os.str ("");
+	os << rts2json::JsonDouble (conn->getProgressEnd ());
+	stateDelta.setMember (dev, rts2json::SECTION_HEADER, "send", os.str ());
+
+	os.str ("");
+	os << rts2json::JsonDouble (mfrom);
+	stateDelta.setMember (dev, rts2json::SECTION_HEADER, "f", os.str ());
+}
+
+bool BBServer::prepareUpdate ()
+{
+	stateDelta.beginUpdate ();
 
 	for (rts2core::connections_t::iterator iter = server->getConnections ()->begin (); iter != server->getConnections ()->end (); iter++)
 	{
 		if ((*iter)->getName ()[0] == '\0')
 			continue;
-		if (first)
-			first = false;
-		else
-			body << ",";
-		body << "\"" << (*iter)->getName () << "\":{";
-		rts2json::sendConnectionValues (body, *iter, NULL, NAN, true);
-		body << "}";
+		trackConnection (*iter);
+	}
+
+	uint32_t seq = stateDelta.endUpdate ();
+
+	pthread_mutex_lock (&pendingMutex);
+	uint32_t base = ackedSeq;
+	pthread_mutex_unlock (&pendingMutex);
+
+	std::ostringstream body;
+
+	time_t now = time (NULL);
+
+	if (base == 0 || now >= lastFull + BB_FULL_PERIOD || !stateDelta.delta (body, base))
+	{
+		body.str ("");
+		stateDelta.full (body);
+		base = 0;
+		lastFull = now;
 	}
 
-	body << "}";
+	pthread_mutex_lock (&pendingMutex);
+	bool queue = pendingBody.empty ();
+	// delta is cumulative since acknowledged sequence, so it is safe to replace update waiting in the queue
+	pendingBody = body.str ();
+	pendingSeq = seq;
+	pendingBase = base;
+	pthread_mutex_unlock (&pendingMutex);
+
+	return queue;
+}
+
+void BBServer::sendUpdate ()
+{
+	std::string body;
+	uint32_t seq;
+	uint32_t base;
+
+	pthread_mutex_lock (&pendingMutex);
+	body.swap (pendingBody);
+	seq = pendingSeq;
+	base = pendingBase;
+	pthread_mutex_unlock (&pendingMutex);
+
+	// update was already sent
+	if (body.empty ())
+		return;
+
+	if (client == NULL)
+		client = createClient ();
 
 	char * reply;
 	int reply_length;
@@ -169,9 +262,13 @@ void BBServer::sendUpdate ()
 	std::ostringstream url;
 	if (_uri)
 		url << _uri;
-	url << "/api/observatory?observatory_id=" << observatoryId;
+	url << "/api/observatory?observatory_id=" << observatoryId << "&seq=" << seq;
+	if (base > 0)
+		url << "&base=" << base;
+	else
+		url << "&full=1";
 
-	int ret = client->executePostRequest (url.str ().c_str (), body.str ().c_str (), reply, reply_length, 300);
+	int ret = client->executePostRequest (url.str ().c_str (), body.c_str (), reply, reply_length, 300);
 	if (!ret)
 	{
 		logStream (MESSAGE_ERROR) << "Error requesting " << serverApi.c_str () << url.str () << sendLog;
@@ -194,7 +291,28 @@ void BBServer::sendUpdate ()
 		return;
 	}
 
-	server->bbSend (json_object_get_double_member (json_node_get_object (json_parser_get_root (result)), "localtime"));
+	JsonObject *robj = json_node_get_object (json_parser_get_root (result));
+
+	server->bbSend (json_object_get_double_member (robj, "localtime"));
+
+	// BB servers without delta support do not acknowledge sequence, and receive full snapshots
+	if (json_object_has_member (robj, "seq"))
+	{
+		pthread_mutex_lock (&pendingMutex);
+		if (json_object_has_member (robj, "resync") && json_object_get_boolean_member (robj, "resync"))
+		{
+			logStream (MESSAGE_DEBUG) << "BB server " << serverApi.c_str () << " requested full state" << sendLog;
+			ackedSeq = 0;
+		}
+		else
+		{
+			ackedSeq = json_object_get_int_member (robj, "seq");
+		}
+		pthread_mutex_unlock (&pendingMutex);
+	}
+
+	if (json_object_has_member (robj, "deflate"))
+		client->setDeflateRequests (json_object_get_boolean_member (robj, "deflate"));
 
 	if (push_thread)
 	{
@@ -205,7 +323,7 @@ void BBServer::sendUpdate ()
 	}
 
 	// if client need to register for push..
-	if (json_object_get_boolean_member (json_node_get_object (json_parser_get_root (result)), "push") && push_thread == 0)
+	if (json_object_get_boolean_member (robj, "push") && push_thread == 0)
 	{
 		pthread_create (&push_thread, NULL, pushListener, (void *) this);
 	}
@@ -271,7 +389,10 @@ void BBServer::queueUpdate (int reqId)
 void BBServers::sendUpdate ()
 {
 	for (BBServers::iterator iter = begin (); iter != end (); iter++)
-		iter->queueUpdate (-1);
+	{
+		if (iter->prepareUpdate ())
+			iter->queueUpdate (-1);
+	}
 }
 
 void BBServers::sendObservatoryUpdate (int observatoryId, int request)
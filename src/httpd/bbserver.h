@@ -21,15 +21,24 @@
 #define __RTS2__BBSERVER__
 
 #include "object.h"
+#include "connection.h"
 #include "rts2-config.h"
 
 #include "tsqueue.h"
+#include "rts2json/statedelta.h"
 
 #include "xmlrpc++/XmlRpcValue.h"
 #include "xmlrpc++/XmlRpcClient.h"
 
 #include <vector>
 #include <pthread.h>
+#include <time.h>
+
+/**
+ * Period (in seconds) of full state snapshots sent to BB server. Between
+ * snapshots, only values changed since last acknowledged update are sent.
+ */
+#define BB_FULL_PERIOD        600
 
 using namespace XmlRpc;
 
@@ -54,9 +63,19 @@ class BBServer:public rts2core::Object
 		XmlRpc::XmlRpcClient *createClient ();
 
 		/**
-		 * Sends update message to BB server. Data part is specified in data parameter.
+		 * Encode observatory state for the next BB update. Must be
+		 * called from the main thread, as it reads connection values.
+		 * Only values changed since the last update acknowledged by BB
+		 * are encoded, except when full snapshot is due. Update replaces
+		 * any update not yet sent by the sending thread.
 		 *
-		 * @param data  data to send to BB server
+		 * @return true if sending of the update shall be queued, false if an update is already waiting in the queue
+		 */
+		bool prepareUpdate ();
+
+		/**
+		 * Sends update prepared by prepareUpdate to BB server. Runs in
+		 * the sending thread.
 		 */
 		void sendUpdate ();
 
@@ -94,6 +113,20 @@ class BBServer:public rts2core::Object
 		pthread_t push_thread;
 
 		int cadency;
+
+		// state tracking and encoding, accessed only from the main thread
+		rts2json::StateDelta stateDelta;
+		time_t lastFull;
+
+		// protects pending update and acknowledged sequence, shared with the sending thread
+		pthread_mutex_t pendingMutex;
+		std::string pendingBody;
+		uint32_t pendingSeq;
+		uint32_t pendingBase;
+		// last sequence number acknowledged by BB, 0 if full snapshot must be sent
+		uint32_t ackedSeq;
+
+		void trackConnection (rts2core::Connection *conn);
 };
 
 class BBServers:public std::vector <BBServer>
@@ -36,6 +36,7 @@ Events::Events (HttpD *_master)
 	defImageLabel = NULL;
 	docroot = std::string ();
 	defchan = INT_MAX;
+	indexed = false;
 }
 
 void Events::parseState (xmlNodePtr event, std::string deviceName)
@@ -374,6 +375,9 @@ void Events::parseBB (xmlNodePtr ev)
 
 void Events::load (const char *file)
 {
+	// even partially loaded configuration is indexed again
+	indexed = false;
+
 	stateCommands.clear ();
 	valueCommands.clear ();
 	publicPaths.clear ();
@@ -456,3 +460,54 @@ bool Events::isPublic (std::string path)
 	}
 	return false;
 }
+
+std::vector <ValueChange *> *Events::valueTriggers (const char *deviceName, const char *valueName)
+{
+	if (!indexed)
+		buildIndex ();
+	rts2core::NameMultiIndex <ValueChange, true> *device = valueIndex.find (deviceName);
+	if (device == NULL)
+		return NULL;
+	return device->find (valueName);
+}
+
+std::vector <StateChange *> *Events::stateTriggers (const char *deviceName)
+{
+	if (!indexed)
+		buildIndex ();
+	return stateIndex.find (deviceName);
+}
+
+std::vector <MessageEvent *> *Events::messageTriggers (const char *deviceName)
+{
+	if (!indexed)
+		buildIndex ();
+	return messageIndex.find (deviceName);
+}
+
+void Events::buildIndex ()
+{
+	valueIndex.clear ();
+	valueDevices.clear ();
+	for (ValueCommands::iterator iter = valueCommands.begin (); iter != valueCommands.end (); iter++)
+	{
+		rts2core::NameMultiIndex <ValueChange, true> *device = valueIndex.find ((*iter)->getDeviceName ());
+		if (device == NULL)
+		{
+			valueDevices.push_back (rts2core::NameMultiIndex <ValueChange, true> ());
+			device = &(valueDevices.back ());
+			valueIndex.add ((*iter)->getDeviceName (), device);
+		}
+		device->add ((*iter)->getValueName (), *iter);
+	}
+
+	stateIndex.clear ();
+	for (StateCommands::iterator iter = stateCommands.begin (); iter != stateCommands.end (); iter++)
+		stateIndex.add ((*iter)->getDeviceName (), *iter);
+
+	messageIndex.clear ();
+	for (MessageCommands::iterator iter = messageCommands.begin (); iter != messageCommands.end (); iter++)
+		messageIndex.add ((*iter)->getDeviceName (), *iter);
+
+	indexed = true;
+}
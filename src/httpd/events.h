@@ -24,6 +24,7 @@
 #include "stateevents.h"
 #include "valueevents.h"
 #include "bbserver.h"
+#include "nameindex.h"
 
 #include <xmlerror.h>
 
@@ -95,11 +96,37 @@ class Events
 
 		const char *getDefaultImageLabel () { return defImageLabel; }
 
+		/**
+		 * Return triggers of device value.
+		 *
+		 * @return triggers in order of configuration file, NULL if value does not have any trigger
+		 */
+		std::vector <ValueChange *> *valueTriggers (const char *deviceName, const char *valueName);
+
+		/**
+		 * Return triggers of device state changes.
+		 */
+		std::vector <StateChange *> *stateTriggers (const char *deviceName);
+
+		/**
+		 * Return triggers of messages from device.
+		 */
+		std::vector <MessageEvent *> *messageTriggers (const char *deviceName);
+
 	private:
 		HttpD *master;
 
 		char *defImageLabel;
 
+		// triggers indexed by device (and value) names, built on first use after load
+		bool indexed;
+		rts2core::NameIndex <rts2core::NameMultiIndex <ValueChange, true>, true> valueIndex;
+		std::list <rts2core::NameMultiIndex <ValueChange, true> > valueDevices;
+		rts2core::NameMultiIndex <StateChange, false> stateIndex;
+		rts2core::NameMultiIndex <MessageEvent, true> messageIndex;
+
+		void buildIndex ();
+
 		void parseHttp (xmlNodePtr ev);
 		void parseEvents (xmlNodePtr ev);
 		void parseBB (xmlNodePtr ev);
@@ -49,6 +49,7 @@ using namespace Magick;
 #define OPT_BB_QUEUE            OPT_LOCAL + 80
 #define OPT_SSL_CERT            OPT_LOCAL + 81
 #define OPT_SSL_KEY             OPT_LOCAL + 82
+#define OPT_WORKERS             OPT_LOCAL + 83
 
 using namespace XmlRpc;
 
@@ -453,6 +454,7 @@ rts2image::imageProceRes XmlDevCameraClient::processImage (rts2image::Image * im
 int HttpD::info ()
 {
 	bbQueueSize->setValueInteger (events.bbServers.queueSize ());
+	updateExecutorValues ();
 #ifdef RTS2_HAVE_PGSQL
 	return DeviceDb::info ();
 #else
@@ -511,6 +513,9 @@ int HttpD::processOption (int in_opt)
 		case OPT_BB_QUEUE:
 			bbQueueName = optarg;
 			break;
+		case OPT_WORKERS:
+			numWorkers->setValueInteger (atoi (optarg));
+			break;
 #ifdef RTS2_HAVE_PGSQL
 		default:
 			return DeviceDb::processOption (in_opt);
@@ -621,6 +626,11 @@ int HttpD::init ()
 #ifdef RTS2_HAVE_LIBJPEG
 	Magick::InitializeMagick (".");
 #endif /* RTS2_HAVE_LIBJPEG */
+
+	if (executor.start (numWorkers->getValueInteger ()))
+		logStream (MESSAGE_WARNING) << "cannot start worker threads, all requests will be handled in the main loop" << sendLog;
+	numWorkers->setValueInteger (executor.getThreads ());
+
 	return ret;
 }
 
@@ -632,6 +642,8 @@ void HttpD::addPollSocks ()
 	rts2core::Device::addPollSocks ();
 #endif
 	XmlRpcServer::addToFd (&getMasterAddPollFD);
+	if (executor.getNotifyFd () >= 0)
+		addPollFD (executor.getNotifyFd (), POLLIN | POLLPRI);
 }
 
 void HttpD::pollSuccess ()
@@ -642,6 +654,22 @@ void HttpD::pollSuccess ()
 	rts2core::Device::pollSuccess ();
 #endif
 	XmlRpcServer::checkFd (&getMasterGetEvents);
+	if (executor.getNotifyFd () >= 0 && isForRead (executor.getNotifyFd ()))
+	{
+		std::pair <messageType_t, std::string> msg;
+		while (executor.popMessage (msg))
+			rts2core::Device::sendMessage (msg.first, msg.second.c_str ());
+		if (executor.processFinished () > 0)
+			updateExecutorValues ();
+	}
+}
+
+void HttpD::sendMessage (messageType_t in_messageType, const char *in_messageString)
+{
+	// messages from worker threads are send from the main loop
+	if (executor.queueMessage (in_messageType, in_messageString))
+		return;
+	rts2core::Device::sendMessage (in_messageType, in_messageString);
 }
 
 void HttpD::signaledHUP ()
@@ -656,6 +684,7 @@ void HttpD::signaledHUP ()
 
 void HttpD::connectionRemoved (rts2core::Connection *conn)
 {
+	snapshot.invalidate (conn);
 	for (std::list <XmlDevCameraClient *>::iterator iter = camClis.begin (); iter != camClis.end ();)
 	{
 		if (conn->getOtherDevClient () == *iter)
@@ -700,9 +729,41 @@ void HttpD::removeConnection (XmlRpcServerConnection *source)
 		if ((*iter)->isForSource (source))
 			(*iter)->nullSource ();
 	}
+	// worker can still execute request of the connection
+	executor.orphanRequests (source);
 	XmlRpcServer::removeConnection (source);
 }
 
+bool HttpD::queueRequest (rts2json::GetRequestAuthorized *request, XmlRpcServerConnection *source, const std::string &path, XmlRpc::HttpParams *params)
+{
+	if (executor.queueRequest (request, source, path, params) == false)
+		return false;
+	queueDepth->setValueInteger (executor.getQueueDepth ());
+	return true;
+}
+
+void HttpD::workerStarted (int num)
+{
+#ifdef RTS2_HAVE_PGSQL
+	if (emptyConnectString ())
+		return;
+	// each worker uses its own database connection
+	std::ostringstream conn_name;
+	conn_name << "worker_" << num;
+	initDB (conn_name.str ().c_str ());
+#endif // RTS2_HAVE_PGSQL
+}
+
+void HttpD::updateExecutorValues ()
+{
+	queueDepth->setValueInteger (executor.getQueueDepth ());
+	workersBusy->setValueInteger (executor.getRunning ());
+	queueWait->setValueDouble (executor.getQueueWait ().getMean ());
+	handlerTime->setValueDouble (executor.getHandlerTime ().getMean ());
+	handlerMax->setValueDouble (executor.getHandlerTime ().getCount () > 0 ? executor.getHandlerTime ().getMax () : NAN);
+	snapshotHits->setValueLong (snapshot.getHits ());
+}
+
 #ifdef RTS2_HAVE_PGSQL
 HttpD::HttpD (int argc, char **argv): DeviceDb (argc, argv, DEVICE_TYPE_HTTPD, "HTTPD")
 #else
@@ -769,7 +830,9 @@ HttpD::HttpD (int argc, char **argv): rts2core::Device (argc, argv, DEVICE_TYPE_
   plan ("/plan", this, this),
 #endif // RTS2_HAVE_PGSQL
   switchState ("/switchstate", this, this),
-  devices ("/devices", this, this)
+  devices ("/devices", this, this),
+  executor (this),
+  snapshot ()
 {
 	rpcPort = 8889;
 	stateChangeFile = NULL;
@@ -800,6 +863,15 @@ HttpD::HttpD (int argc, char **argv): rts2core::Device (argc, argv, DEVICE_TYPE_
 	createValue (messageBufferSize, "message_buffer_size", "number of last messages to kept in memory", false, RTS2_VALUE_WRITABLE);
 	messageBufferSize->setValueInteger (100);
 
+	createValue (numWorkers, "workers", "number of threads executing database and image requests", false);
+	numWorkers->setValueInteger (4);
+	createValue (queueDepth, "queue_depth", "number of requests waiting for worker thread", false);
+	createValue (workersBusy, "workers_busy", "number of requests being executed by worker threads", false);
+	createValue (queueWait, "queue_wait", "[s] average time requests waited for worker thread", false);
+	createValue (handlerTime, "handler_time", "[s] average time of request execution in worker thread", false);
+	createValue (handlerMax, "handler_max", "[s] maximal time of request execution in worker thread", false);
+	createValue (snapshotHits, "snapshot_hits", "device values requests served from the snapshot", false);
+
 	debugTestscript = false;
 
 	bbQueueName = NULL;
@@ -816,6 +888,7 @@ HttpD::HttpD (int argc, char **argv): rts2core::Device (argc, argv, DEVICE_TYPE_
 	addOption (OPT_DEBUG_TESTSCRIPT, "debug-test-script", 0, "print test script debugging");
 	addOption (OPT_TESTSCRIPT, "test-script", 1, "test script to run on background");
 	addOption (OPT_BB_QUEUE, "bb-queue", 1, "name of queue used for BB scheduling");
+	addOption (OPT_WORKERS, "workers", 1, "number of worker threads for database and image requests; 0 handles all requests in the main loop. Default to 4");
 #ifdef RTS2_SSL
 	addOption (OPT_SSL_CERT, "ssl-cert", 1, "OpenSSL ca certification file");
 	addOption (OPT_SSL_KEY, "ssl-key", 1, "OpenSSL private key file");
@@ -826,6 +899,9 @@ HttpD::HttpD (int argc, char **argv): rts2core::Device (argc, argv, DEVICE_TYPE_
 
 HttpD::~HttpD ()
 {
+	// requests executed by workers are members of the class
+	executor.stop ();
+
 	for (std::vector <rts2json::Directory *>::iterator id = directories.begin (); id != directories.end (); id++)
 		delete *id;
 
@@ -908,18 +984,22 @@ int HttpD::setValue (rts2core::Value *old_value, rts2core::Value *new_value)
 void HttpD::stateChangedEvent (rts2core::Connection * conn, rts2core::ServerState * new_state)
 {
 	double now = getNow ();
+	const char *name;
+	if (conn->getOtherType () == DEVICE_TYPE_SERVERD)
+		name = "centrald";
+	else
+		name = conn->getName ();
 	// look if there is some state change command entry, which match us..
-	for (StateCommands::iterator iter = events.stateCommands.begin (); iter != events.stateCommands.end (); iter++)
+	std::vector <StateChange *> *triggers = events.stateTriggers (name);
+	if (triggers)
 	{
-		StateChange *sc = (*iter);
-		const char *name;
-		if (conn->getOtherType () == DEVICE_TYPE_SERVERD)
-			name = "centrald";
-		else
-			name = conn->getName ();
-		if (sc->isForDevice (name, conn->getOtherType ()) && sc->executeOnStateChange (new_state->getOldValue (), new_state->getValue ()))
+		for (std::vector <StateChange *>::iterator iter = triggers->begin (); iter != triggers->end (); iter++)
 		{
-			sc->run (this, conn, now);
+			StateChange *sc = (*iter);
+			if (sc->executeOnStateChange (new_state->getOldValue (), new_state->getValue ()))
+			{
+				sc->run (this, conn, now);
+			}
 		}
 	}
 	for (std::list <rts2json::AsyncAPI *>::iterator iter = asyncAPIs.begin (); iter != asyncAPIs.end (); iter++)
@@ -928,26 +1008,31 @@ void HttpD::stateChangedEvent (rts2core::Connection * conn, rts2core::ServerStat
 
 void HttpD::valueChangedEvent (rts2core::Connection * conn, rts2core::Value * new_value)
 {
+	snapshot.invalidate (conn);
 	double now = getNow ();
-	// look if there is some state change command entry, which match us..
-	for (ValueCommands::iterator iter = events.valueCommands.begin (); iter != events.valueCommands.end (); iter++)
+	const char *name;
+	if (conn->getOtherType () == DEVICE_TYPE_SERVERD)
+		name = "centrald";
+	else
+		name = conn->getName ();
+	// only triggers of the changed value are checked
+	std::vector <ValueChange *> *triggers = events.valueTriggers (name, new_value->getName ().c_str ());
+	if (triggers)
 	{
-		ValueChange *vc = (*iter);
-		const char *name;
-		if (conn->getOtherType () == DEVICE_TYPE_SERVERD)
-			name = "centrald";
-		else
-			name = conn->getName ();
-		if (vc->isForValue (name, new_value->getName (), now))
+		for (std::vector <ValueChange *>::iterator iter = triggers->begin (); iter != triggers->end (); iter++)
 		{
-			try
-			{
-				vc->run (new_value, now);
-				vc->runSuccessfully (now);
-			}
-			catch (rts2core::Error err)
+			ValueChange *vc = (*iter);
+			if (vc->shouldRun (now))
 			{
-				logStream (MESSAGE_ERROR) << err << sendLog;
+				try
+				{
+					vc->run (new_value, now);
+					vc->runSuccessfully (now);
+				}
+				catch (rts2core::Error err)
+				{
+					logStream (MESSAGE_ERROR) << err << sendLog;
+				}
 			}
 		}
 	}
@@ -976,18 +1061,22 @@ void HttpD::message (Message & msg)
 			break;
 	}
 	// look if there is some state change command entry, which match us..
-	for (MessageCommands::iterator iter = events.messageCommands.begin (); iter != events.messageCommands.end (); iter++)
+	std::vector <MessageEvent *> *triggers = events.messageTriggers (msg.getMessageOName ());
+	if (triggers)
 	{
-		MessageEvent *me = (*iter);
-		if (me->isForMessage (&msg))
+		for (std::vector <MessageEvent *>::iterator iter = triggers->begin (); iter != triggers->end (); iter++)
 		{
-			try
+			MessageEvent *me = (*iter);
+			if (me->isForType (&msg))
 			{
-				me->run (&msg);
-			}
-			catch (rts2core::Error err)
-			{
-				logStream (MESSAGE_ERROR) << err << sendLog;
+				try
+				{
+					me->run (&msg);
+				}
+				catch (rts2core::Error err)
+				{
+					logStream (MESSAGE_ERROR) << err << sendLog;
+				}
 			}
 		}
 	}
@@ -40,6 +40,7 @@
 #include "rts2json/directory.h"
 #include "events.h"
 #include "rts2json/httpreq.h"
+#include "rts2json/executor.h"
 #include "rts2json/images.h"
 #include "rts2json/libcss.h"
 #include "rts2json/libjavascript.h"
@@ -399,6 +400,8 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 		virtual void addPollSocks ();
 		virtual void pollSuccess ();
 
+		virtual void sendMessage (messageType_t in_messageType, const char *in_messageString);
+
 		virtual void message (Message & msg);
 
 		virtual int commandAuthorized (rts2core::Connection * conn);
@@ -476,6 +479,17 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 
 		virtual void addExecutedPage () { numRequests->inc (); }
 
+		virtual bool queueRequest (rts2json::GetRequestAuthorized *request, XmlRpcServerConnection *source, const std::string &path, XmlRpc::HttpParams *params);
+
+		virtual void workerStarted (int num);
+
+		/**
+		 * Snapshot of device values, used to serve device values requests.
+		 */
+		rts2json::ValuesSnapshot & getSnapshot () { return snapshot; }
+
+		const rts2json::RequestExecutor & getExecutor () { return executor; }
+
 		/**
 		 * Called when BB information were succesfully transmitted.
 		 */
@@ -528,6 +542,14 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 
 		rts2core::ValueInteger *messageBufferSize;
 
+		rts2core::ValueInteger *numWorkers;
+		rts2core::ValueInteger *queueDepth;
+		rts2core::ValueInteger *workersBusy;
+		rts2core::ValueDouble *queueWait;
+		rts2core::ValueDouble *handlerTime;
+		rts2core::ValueDouble *handlerMax;
+		rts2core::ValueLong *snapshotHits;
+
 #ifndef RTS2_HAVE_PGSQL
 		const char *config_file;
 #endif
@@ -541,6 +563,8 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 
 		void reloadEventsFile ();
 
+		void updateExecutorValues ();
+
 		int startTestScript ();
 
 		// pages
@@ -604,6 +628,9 @@ class HttpD:public rts2core::Device, XmlRpc::XmlRpcServer, rts2json::HTTPServer
 		SwitchState switchState;
 		Devices devices;
 
+		rts2json::RequestExecutor executor;
+		rts2json::ValuesSnapshot snapshot;
+
 		rts2core::ConnNotify *notifyConn;
 
 		std::list <const char *> testScripts;
@@ -38,6 +38,13 @@ class MessageEvent
 
 		bool isForMessage (rts2core::Message *message) { return deviceName == message->getMessageOName () && message->passMask (type); }
 
+		/**
+		 * Returns true if message of the trigger device shall be handled.
+		 */
+		bool isForType (rts2core::Message *message) { return message->passMask (type); }
+
+		const char *getDeviceName () { return deviceName.c_str (); }
+
 		/**
 		 * Triggered when message with given type is received. Throws Errors on error.
 		 */
@@ -204,6 +204,7 @@
  * @param id           Value to return
  * @param from         From this time
  * @param to           To this time
+ * @param bucket       Optional bucket length in seconds. If specified, minimal and maximal value of each bucket are returned instead of all records.
  */
 #define R2X_RECORDS_GET               "rts2.records.get"
 
@@ -213,6 +214,7 @@
  * @param Id           Value to return
  * @param From         From this time
  * @param To           To this time
+ * @param Bucket       Optional averaging bucket length in seconds, default to one hour.
  * @return Array of five values - middle time, average, minimal and maximal values, and number of records.
  */
 #define R2X_RECORDS_AVERAGES          "rts2.records.averages"
@@ -70,6 +70,8 @@ class StateChange
 			return deviceName == _deviceName;
 		}
 
+		const char *getDeviceName () { return deviceName.c_str (); }
+
 		virtual void run (HttpD *_master, rts2core::Connection *_conn, double validTime) = 0;
 
 	protected:
@@ -49,15 +49,20 @@ class ValueChange:public rts2core::Object
 		 */
 		virtual void postEvent (rts2core::Event * event);
 
-		bool isForValue (std::string _deviceName, std::string _valueName, double infoTime)
+		const char *getDeviceName () { return deviceName.c_str (); }
+		const char *getValueName () { return valueName.c_str (); }
+
+		/**
+		 * Returns true if trigger shall run. Trigger is selected by device and
+		 * value name, this checks cadency and test expression.
+		 */
+		bool shouldRun (double infoTime)
 		{
-			if (deviceName == _deviceName.c_str () && valueName == _valueName.c_str () && (cadency < 0 || lastTime + cadency < infoTime))
-			{
-				if (test && test->evaluate () == 0)
-						return false;
-				return true;
-			}
-			return false;
+			if (cadency >= 0 && lastTime + cadency >= infoTime)
+				return false;
+			if (test && test->evaluate () == 0)
+				return false;
+			return true;
 		}
 
 		/**
@@ -35,17 +35,14 @@ ValuePlot::ValuePlot (int _recvalId, int _valType, int w, int h):Plot (w, h)
 	valueType = _valType;
 }
 
-Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _image, rts2json::PlotType _plotType, int linewidth, int shadow, bool plotSun, bool plotShadow, bool localDate)
+Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _image, rts2json::PlotType _plotType, int linewidth, int shadow, bool plotSun, bool plotShadow, bool localDate, double bucket)
 {
-	// first load values..
 	rts2db::RecordsSet rs (recvalId);
 
 	from = _from;
 	to = _to;
 	plotType = _plotType;
 
-	rs.load (from, to);
-
 	if (_image)
 	{
 		image = _image;
@@ -60,6 +57,19 @@ Magick::Image* ValuePlot::getPlot (double _from, double _to, Magick::Image* _ima
 	image->strokeColor ("black");
 	image->strokeWidth (1);
 
+	// one bucket per pixel; round to whole minutes or hours, so rollup tables can be used
+	if (bucket < 0)
+	{
+		int pixels = size.width () - y_axis_width;
+		bucket = (to - from) / (pixels > 0 ? pixels : 1);
+		if (bucket >= 3600)
+			bucket = ceil (bucket / 3600) * 3600;
+		else if (bucket >= 60)
+			bucket = ceil (bucket / 60) * 60;
+	}
+
+	rs.load (from, to, bucket);
+
 	// Y axis scaling
 	min = rs.getMin ();
 	max = rs.getMax ();
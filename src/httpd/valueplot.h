@@ -53,10 +53,11 @@ class ValuePlot:public rts2json::Plot
 		 * @param plotSun    Plot sun altitude (dark/white background)
 		 * @param plotShadow Plot Sun shadow (night/day, twilight)
 		 * @param localDate  Use local date
+		 * @param bucket     Length of downsampling bucket in seconds. 0 plots all records, negative value selects bucket matching one pixel of the plot.
 		 * 
 		 * @throw rts2core::Error or its descendandts on error.
 		 */
-		Magick::Image* getPlot (double _from, double _to, Magick::Image* _image = NULL, rts2json::PlotType _plotType = rts2json::PLOTTYPE_AUTO, int linewidth = 3, int shadow = 5, bool plotSun = true, bool plotShadow = true, bool localDate = true);
+		Magick::Image* getPlot (double _from, double _to, Magick::Image* _image = NULL, rts2json::PlotType _plotType = rts2json::PLOTTYPE_AUTO, int linewidth = 3, int shadow = 5, bool plotSun = true, bool plotShadow = true, bool localDate = true, double bucket = -1);
 	
 	private:
 		int recvalId;
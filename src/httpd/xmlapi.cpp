@@ -1021,9 +1021,17 @@ void RecordsValues::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 	}
 }
 
+// bucket length can be passed as integer or double
+static double bucketLength (XmlRpcValue &v)
+{
+	if (v.getType () == XmlRpcValue::TypeInt)
+		return (int) v;
+	return (double) v;
+}
+
 void Records::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 {
-	if (params.size () != 3)
+	if (params.size () != 3 && params.size () != 4)
 		throw XmlRpcException ("Invalid number of parameters");
 
 	try
@@ -1031,7 +1039,7 @@ void Records::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 		rts2db::RecordsSet recset = rts2db::RecordsSet (params[0]);
 		int i = 0;
 		time_t t;
-		recset.load (params[1], params[2]);
+		recset.load (params[1], params[2], params.size () == 4 ? bucketLength (params[3]) : 0);
 		for (rts2db::RecordsSet::iterator iter = recset.begin (); iter != recset.end (); iter++)
 		{
 			rts2db::Record rv = (*iter);
@@ -1050,12 +1058,14 @@ void Records::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 
 void RecordsAverage::sessionExecute (XmlRpcValue& params, XmlRpcValue& result)
 {
-	if (params.size () != 3)
+	if (params.size () != 3 && params.size () != 4)
 		throw XmlRpcException ("Invalid number of parameters");
 
 	try
 	{
-		rts2db::RecordAvgSet recset = rts2db::RecordAvgSet (params[0], rts2db::HOUR);
+		rts2db::RecordAvgSet recset = params.size () == 4 ? rts2db::RecordAvgSet (params[0], bucketLength (params[3])) : rts2db::RecordAvgSet (params[0], rts2db::HOUR);
+		if (recset.getBucket () <= 0)
+			throw XmlRpcException ("Bucket length must be positive");
 		int i = 0;
 		time_t t;
 		recset.load (params[1], params[2]);
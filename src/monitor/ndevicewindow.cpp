@@ -30,6 +30,12 @@
 
 using namespace rts2ncurses;
 
+// flags which change display of the value
+static int32_t displayFlags (rts2core::Value *value)
+{
+	return value->getFlags () & ~(RTS2_VALUE_CHANGED | RTS2_VALUE_NEED_SEND);
+}
+
 NDeviceWindow::NDeviceWindow (rts2core::Connection * in_connection, bool _hide_debug):NSelWindow (10, 1, COLS - 10, LINES - 25)
 {
 	connection = in_connection;
@@ -40,6 +46,11 @@ NDeviceWindow::NDeviceWindow (rts2core::Connection * in_connection, bool _hide_d
 	hide_debug = _hide_debug;
 	filterMode = 0;
 
+	lastScrollWidth = -1;
+	lastHeight = -1;
+	lastSelRow = -1;
+	renderedLines = 0;
+
 	draw ();
 }
 
@@ -74,55 +85,15 @@ void NDeviceWindow::printValue (const char *name, const char *value, bool writab
 	wprintw (getWriteWindow (), "%c %-*s %30.*s\n", ((writable) ? 'W' : ' '), valueBegins, name, getScrollWidth () - valueBegins - 5, value);
 }
 
-void NDeviceWindow::printValue (rts2core::Value * value)
+std::string NDeviceWindow::formatValue (rts2core::Value * value)
 {
-	// customize value display
 	std::ostringstream _os;
-	switch (value->getFlags () & RTS2_VALUE_ERRORMASK)
-	{
-		case RTS2_VALUE_WARNING:
-			wcolor_set (getWriteWindow (), CLR_WARNING, NULL);
-			break;
-		case RTS2_VALUE_ERROR:
-			wcolor_set (getWriteWindow (), CLR_FAILURE, NULL);
-			break;
-		default:
-			if (value->getWriteToFits ())
-				wcolor_set (getWriteWindow (), CLR_FITS, NULL);
-			else
-				wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
-	}
-	// ultra special handling of SCRIPT value
+	// script display depends on script position
 	if (value->getValueDisplayType () == RTS2_DT_SCRIPT)
 	{
-		wprintw (getWriteWindow (), "  %-*s ", valueBegins, value->getName ().c_str ());
-		wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
-		const char *valStart = value->getValue ();
-		if (!valStart)
-			return;
-		const char *valTop = valStart;
-		int scriptPosition = connection->getValueInteger ("scriptPosition");
-		int scriptEnd = connection->getValueInteger ("scriptLen") + scriptPosition;
-
-		while (*valTop && (valTop - valStart < scriptPosition))
-		{
-			waddch (getWriteWindow (), *valTop);
-			valTop++;
-		}
-		wcolor_set (getWriteWindow (), CLR_SCRIPT_CURRENT, NULL);
-		while (*valTop && (valTop - valStart < scriptEnd))
-		{
-			waddch (getWriteWindow (), *valTop);
-			valTop++;
-		}
-		wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
-		while (*valTop)
-		{
-			waddch (getWriteWindow (), *valTop);
-			valTop++;
-		}
-		waddch (getWriteWindow (), '\n');
-		return;
+		const char *val = value->getValue ();
+		_os << connection->getValueInteger ("scriptPosition") << " " << connection->getValueInteger ("scriptLen") << " " << (val ? val : "");
+		return _os.str ();
 	}
 	switch (value->getValueType ())
 	{
@@ -142,7 +113,6 @@ void NDeviceWindow::printValue (rts2core::Value * value)
 				}
 				else if (value->getValueDisplayType () == RTS2_DT_ARCSEC)
 				{
-					double v_rd ();
 					_os << std::fixed << std::setprecision (3) << ((rts2core::ValueRaDec *) value)->getRa () * 3600 << "\" " << ((rts2core::ValueRaDec *) value)->getDec () * 3600 << "\"";
 				}
 				else
@@ -150,7 +120,6 @@ void NDeviceWindow::printValue (rts2core::Value * value)
 					LibnovaRaDec v_radec (((rts2core::ValueRaDec *) value)->getRa (), ((rts2core::ValueRaDec *) value)->getDec ());
 					_os << v_radec;
 				}
-				printValue (value->getName ().c_str (), _os.str().c_str (), value->isWritable ());
 			}
 			break;
 		case RTS2_VALUE_ALTAZ:
@@ -182,16 +151,100 @@ void NDeviceWindow::printValue (rts2core::Value * value)
 					LibnovaHrz hrz (((rts2core::ValueAltAz *) value)->getAlt (), az);
 					_os << hrz;
 				}
-				printValue (value->getName ().c_str (), _os.str().c_str (), value->isWritable ());
-
 			}
 			break;
 		case RTS2_VALUE_SELECTION:
-			wprintw (getWriteWindow (), "%c %-*s %5i %24.*s\n", value->isWritable () ? 'W' : ' ', valueBegins, value->getName ().c_str (), value->getValueInteger (), getScrollWidth () - valueBegins - 10, ((rts2core::ValueSelection *) value)->getSelName ());
+			_os << value->getValueInteger () << " " << ((rts2core::ValueSelection *) value)->getSelName ();
 			break;
 		default:
-			printValue (value->getName ().c_str (), getDisplayValue (value).c_str (), value->isWritable ());
+			return getDisplayValue (value);
 	}
+	return _os.str ();
+}
+
+void NDeviceWindow::printValue (rts2core::Value * value, const std::string &formatted)
+{
+	// customize value display
+	switch (value->getFlags () & RTS2_VALUE_ERRORMASK)
+	{
+		case RTS2_VALUE_WARNING:
+			wcolor_set (getWriteWindow (), CLR_WARNING, NULL);
+			break;
+		case RTS2_VALUE_ERROR:
+			wcolor_set (getWriteWindow (), CLR_FAILURE, NULL);
+			break;
+		default:
+			if (value->getWriteToFits ())
+				wcolor_set (getWriteWindow (), CLR_FITS, NULL);
+			else
+				wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
+	}
+	// ultra special handling of SCRIPT value
+	if (value->getValueDisplayType () == RTS2_DT_SCRIPT)
+	{
+		wprintw (getWriteWindow (), "  %-*s ", valueBegins, value->getName ().c_str ());
+		wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
+		const char *valStart = value->getValue ();
+		if (!valStart)
+			return;
+		const char *valTop = valStart;
+		int scriptPosition = connection->getValueInteger ("scriptPosition");
+		int scriptEnd = connection->getValueInteger ("scriptLen") + scriptPosition;
+
+		while (*valTop && (valTop - valStart < scriptPosition))
+		{
+			waddch (getWriteWindow (), *valTop);
+			valTop++;
+		}
+		wcolor_set (getWriteWindow (), CLR_SCRIPT_CURRENT, NULL);
+		while (*valTop && (valTop - valStart < scriptEnd))
+		{
+			waddch (getWriteWindow (), *valTop);
+			valTop++;
+		}
+		wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
+		while (*valTop)
+		{
+			waddch (getWriteWindow (), *valTop);
+			valTop++;
+		}
+		waddch (getWriteWindow (), '\n');
+		return;
+	}
+	if (value->getValueType () == RTS2_VALUE_SELECTION)
+		wprintw (getWriteWindow (), "%c %-*s %5i %24.*s\n", value->isWritable () ? 'W' : ' ', valueBegins, value->getName ().c_str (), value->getValueInteger (), getScrollWidth () - valueBegins - 10, ((rts2core::ValueSelection *) value)->getSelName ());
+	else
+		printValue (value->getName ().c_str (), formatted.c_str (), value->isWritable ());
+}
+
+bool NDeviceWindow::isVolatile (rts2core::Value * value)
+{
+	// time values are displayed with difference to current time
+	if (value->getValueType () == RTS2_VALUE_TIME || value->getValueDisplayType () == RTS2_DT_SCRIPT)
+		return true;
+	// without device client, value changes are not reported
+	return connection->getOtherDevClient () == NULL;
+}
+
+void NDeviceWindow::drawValueLine (size_t row, bool force)
+{
+	rts2core::Value *value = displayValues[row];
+	std::string formatted = formatValue (value);
+	if (!force && formatted == lineValues[row] && displayFlags (value) == lineFlags[row])
+		return;
+	lineValues[row] = formatted;
+	lineFlags[row] = displayFlags (value);
+
+	wmove (getWriteWindow (), row, 0);
+	wclrtoeol (getWriteWindow ());
+	printValue (value, formatted);
+	renderedLines++;
+}
+
+void NDeviceWindow::valueChanged (rts2core::Connection *conn, rts2core::Value *value)
+{
+	if (conn == connection)
+		changedValues.insert (value);
 }
 
 void NDeviceWindow::drawValuesList ()
@@ -199,9 +252,9 @@ void NDeviceWindow::drawValuesList ()
 	gettimeofday (&tvNow, NULL);
 	now = tvNow.tv_sec + tvNow.tv_usec / USEC_SEC;
 
-	maxrow = 0;
+	size_t newBegins = valueBegins;
 
-	displayValues.clear ();
+	visibleValues.clear ();
 
 	for (rts2core::ValueVector::iterator iter = connection->valueBegin (); iter != connection->valueEnd (); iter++)
 	{
@@ -212,16 +265,46 @@ void NDeviceWindow::drawValuesList ()
 				(filterMode == 2 && (*iter)->isWritable () == false))
 				continue;
 
-			maxrow++;
-
 			// Grow the width of value name field if necessary
-			if (valueBegins < strlen((*iter)->getName ().c_str ()) + 3)
-				valueBegins = strlen((*iter)->getName ().c_str ()) + 3;
+			if (newBegins < strlen((*iter)->getName ().c_str ()) + 3)
+				newBegins = strlen((*iter)->getName ().c_str ()) + 3;
 
-			printValue (*iter);
-			displayValues.push_back (*iter);
+			visibleValues.push_back (*iter);
 		}
 	}
+
+	// redraw everything if list of values or its geometry changed
+	if (visibleValues != displayValues || newBegins != valueBegins || lastScrollWidth != getScrollWidth () || lastHeight != getHeight ())
+	{
+		displayValues.swap (visibleValues);
+		valueBegins = newBegins;
+		lastScrollWidth = getScrollWidth ();
+		lastHeight = getHeight ();
+		lastSelRow = -1;
+
+		werase (getWriteWindow ());
+		lineValues.assign (displayValues.size (), std::string ());
+		lineFlags.assign (displayValues.size (), 0);
+		for (size_t row = 0; row < displayValues.size (); row++)
+			drawValueLine (row, true);
+	}
+	else
+	{
+		for (size_t row = 0; row < displayValues.size (); row++)
+		{
+			rts2core::Value *val = displayValues[row];
+			if (changedValues.find (val) != changedValues.end () || isVolatile (val) || displayFlags (val) != lineFlags[row])
+				drawValueLine (row, false);
+		}
+		// remove selection highlight from previously selected row
+		if (lastSelRow >= 0 && lastSelRow < (int) displayValues.size () && lastSelRow != getSelRow ())
+			drawValueLine (lastSelRow, true);
+	}
+
+	changedValues.clear ();
+	lastSelRow = getSelRow ();
+	maxrow = displayValues.size ();
+	wmove (getWriteWindow (), maxrow, 0);
 }
 
 rts2core::Value * NDeviceWindow::getSelValue ()
@@ -434,7 +517,6 @@ keyRet NDeviceWindow::injectKey (int key)
 void NDeviceWindow::draw ()
 {
 	NSelWindow::draw ();
-	werase (getWriteWindow ());
 	drawValuesList ();
 
 	wcolor_set (getWriteWindow (), CLR_DEFAULT, NULL);
@@ -490,6 +572,10 @@ NDeviceCentralWindow::~NDeviceCentralWindow (void)
 
 void NDeviceCentralWindow::printValues ()
 {
+	// extra lines are below values, and are redrawn every time
+	wmove (getWriteWindow (), getValueLines (), 0);
+	wclrtobot (getWriteWindow ());
+
 	// print statusChanges
 	wcolor_set (getWriteWindow (), CLR_TEXT, NULL);
 	rts2core::Value *nextState = getConnection ()->getValue ("next_state");
@@ -23,9 +23,20 @@
 #include "daemonwindow.h"
 #include "nvaluebox.h"
 
+#include <set>
+
 namespace rts2ncurses
 {
 
+/**
+ * Window displaying device values.
+ *
+ * Formatted values are kept between redraws. Only lines of values reported
+ * by valueChanged call, and of values which display depends on current time,
+ * are formatted again, and written only if they differ from the
+ * previous content. All lines are redrawn when list of displayed values
+ * changes.
+ */
 class NDeviceWindow:public NSelWindow
 {
 	public:
@@ -38,15 +49,28 @@ class NDeviceWindow:public NSelWindow
 		virtual bool setCursor ();
 		virtual bool hasEditBox () { return valueBox != NULL || searchBox != NULL; }
 
-	protected:
-		double now;
-		struct timeval tvNow;
+		/**
+		 * Mark value line for redraw.
+		 *
+		 * @param conn   connection which value changed
+		 * @param value  changed value
+		 */
+		void valueChanged (rts2core::Connection *conn, rts2core::Value *value);
+
+		/**
+		 * Returns number of value lines written to the window since its creation.
+		 */
+		unsigned long getRenderedLines () { return renderedLines; }
 
 		rts2core::Connection *getConnection ()
 		{
 			return connection;
 		}
 
+	protected:
+		double now;
+		struct timeval tvNow;
+
 		/**
 		 * Prints value name and value. Adds newline, so next value will be printed
 		 * on next line.
@@ -61,12 +85,24 @@ class NDeviceWindow:public NSelWindow
 		 * Prints out one value. Adds newline, so next value will be
 		 * printed on next line.
 		 *
-		 * @param value  Value to print.
+		 * @param value      Value to print.
+		 * @param formatted  Value formatted by formatValue call.
+		 */
+		void printValue (rts2core::Value * value, const std::string &formatted);
+
+		/**
+		 * Returns value as it will be displayed.
 		 */
-		void printValue (rts2core::Value * value);
+		std::string formatValue (rts2core::Value * value);
 
 		virtual void drawValuesList ();
 
+		/**
+		 * Number of lines with values. Lines below are free for
+		 * descendants.
+		 */
+		size_t getValueLines () { return displayValues.size (); }
+
 	private:
 		WINDOW * valueList;
 		rts2core::Connection *connection;
@@ -89,6 +125,27 @@ class NDeviceWindow:public NSelWindow
 
 		// draw only those values
 		std::vector <rts2core::Value *> displayValues;
+
+		// formatted values and their flags, as they were drawn
+		std::vector <std::string> lineValues;
+		std::vector <int32_t> lineFlags;
+
+		// values changed since the last draw
+		std::set <rts2core::Value *> changedValues;
+
+		// values which should be displayed, filled during draw
+		std::vector <rts2core::Value *> visibleValues;
+
+		int lastScrollWidth;
+		int lastHeight;
+		int lastSelRow;
+
+		unsigned long renderedLines;
+
+		void drawValueLine (size_t row, bool force);
+
+		// true if value display depends on current time or on other values
+		bool isVolatile (rts2core::Value * value);
 };
 
 /**
@@ -627,7 +627,8 @@ rts2core::ConnClient * NMonitor::createClientConnection (int _centrald_num, char
 
 rts2core::DevClient * NMonitor::createOtherType (rts2core::Connection * conn, int other_device_type)
 {
-	rts2core::DevClient *retC = rts2core::Client::createOtherType (conn, other_device_type);
+	NMonDevClientFactory factory (conn, this);
+	rts2core::DevClient *retC = rts2core::createDevClient (factory, other_device_type);
 	if (other_device_type == DEVICE_TYPE_MOUNT && tarArg)
 	{
 		struct ln_equ_posn tarPos;
@@ -665,6 +666,13 @@ void NMonitor::deleteClient (int p_centraldId)
 	repaint ();
 }
 
+void NMonitor::valueChanged (rts2core::Connection *conn, rts2core::Value *value)
+{
+	NDeviceWindow *dw = dynamic_cast <NDeviceWindow *> (daemonWindow);
+	if (dw)
+		dw->valueChanged (conn, value);
+}
+
 void NMonitor::message (rts2core::Message & msg)
 {
 	*msgwindow << msg;
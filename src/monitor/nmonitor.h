@@ -115,6 +115,11 @@ class NMonitor:public rts2core::Client
 
 		void commandReturn (rts2core::Command * cmd, int cmd_status);
 
+		/**
+		 * Called when device value changes. Marks value for redraw.
+		 */
+		void valueChanged (rts2core::Connection *conn, rts2core::Value *value);
+
 		virtual void addPollSocks ();
 		virtual void pollSuccess ();
 
@@ -196,6 +201,47 @@ class NMonitor:public rts2core::Client
 		std::map <std::string, std::list <std::string> > initCommands;
 };
 
+/**
+ * Device client notifying monitor about value changes, so only changed
+ * values are redrawn.
+ */
+template <class T> class NMonDevClient:public T
+{
+	public:
+		NMonDevClient (rts2core::Connection * conn, NMonitor * _master):T (conn)
+		{
+			master = _master;
+		}
+
+		virtual void valueChanged (rts2core::Value * value)
+		{
+			master->valueChanged (this->getConnection (), value);
+			T::valueChanged (value);
+		}
+
+	private:
+		NMonitor * master;
+};
+
+/**
+ * Creates NMonDevClient wrapping client class of the device type.
+ */
+class NMonDevClientFactory
+{
+	public:
+		NMonDevClientFactory (rts2core::Connection * _conn, NMonitor * _master)
+		{
+			conn = _conn;
+			master = _master;
+		}
+
+		template <class T> rts2core::DevClient *create () { return new NMonDevClient <T> (conn, master); }
+
+	private:
+		rts2core::Connection *conn;
+		NMonitor *master;
+};
+
 /**
  * Make sure that update of connection state is notified in monitor.
  */
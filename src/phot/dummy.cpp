@@ -7,14 +7,17 @@
 
 #include "phot.h"
 
+#include <pthread.h>
+#include <string.h>
 #include <time.h>
 
 using namespace rts2phot;
 
-class Dummy:public Photometer
+class Dummy:public Photometer, private SampleClock
 {
 	public:
 		Dummy (int argc, char **argv);
+		virtual ~Dummy () { stopBurst (); }
 
 		virtual int scriptEnds ();
 
@@ -33,12 +36,27 @@ class Dummy:public Photometer
 		virtual int disableMove ();
 	protected:
 		virtual int startIntegrate ();
+
+		virtual int startBurst ();
+		virtual int stopBurst ();
+
+		virtual bool sample (const struct timeval *tv);
 	private:
 		int filterCount;
+
+		pthread_t burstThread;
+		bool burstRunning;
+		volatile bool burstStop;
+		unsigned int burstSeed;
+
+		static void *burstThreadRoutine (void *arg);
+		void runBurst ();
 };
 
 Dummy::Dummy (int in_argc, char **in_argv):Photometer (in_argc, in_argv)
 {
+	burstRunning = false;
+	burstStop = false;
 }
 
 int Dummy::scriptEnds ()
@@ -63,6 +81,46 @@ int Dummy::startIntegrate ()
 	return 0;
 }
 
+int Dummy::startBurst ()
+{
+	burstStop = false;
+	int ret = pthread_create (&burstThread, NULL, burstThreadRoutine, this);
+	if (ret)
+	{
+		logStream (MESSAGE_ERROR) << "cannot start burst thread: " << strerror (ret) << sendLog;
+		return -1;
+	}
+	burstRunning = true;
+	return 0;
+}
+
+int Dummy::stopBurst ()
+{
+	if (!burstRunning)
+		return 0;
+	burstStop = true;
+	pthread_join (burstThread, NULL);
+	burstRunning = false;
+	return 0;
+}
+
+void *Dummy::burstThreadRoutine (void *arg)
+{
+	((Dummy *) arg)->runBurst ();
+	return NULL;
+}
+
+void Dummy::runBurst ()
+{
+	burstSeed = time (NULL);
+	runClock (req_time, burstStop);
+}
+
+bool Dummy::sample (const struct timeval *tv)
+{
+	return addSample (tv, rand_r (&burstSeed) % 10000, req_time, false) || !isBurstComplete ();
+}
+
 int Dummy::startFilterMove (int new_filter)
 {
 	filter->setValueInteger (new_filter);
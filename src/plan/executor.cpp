@@ -33,6 +33,8 @@
 #define OPT_DONT_DARK     OPT_LOCAL + 101
 #define OPT_DISABLE_AUTO  OPT_LOCAL + 102
 
+#define EVENT_GRB_FAST_TIMEOUT  RTS2_LOCAL_EVENT + 1100
+
 namespace rts2plan
 {
 
@@ -89,7 +91,33 @@ class Executor:public rts2db::DeviceDb
 		int setNextPlan (int nextPlanId);
 		int queueTarget (int nextId, double t_start = NAN, double t_end = NAN, int plan_id = -1);
 		int setNow (int nextId, int plan_id);
+
+		/**
+		 * Observe GRB target. If mount was slewed to the GRB by the
+		 * fast path and the target is rejected, observation of the
+		 * interrupted target is resumed.
+		 */
 		int setGrb (int grbId);
+		int setGrbTarget (int grbId);
+
+		/**
+		 * Slew mount to GRB position received before the GRB was
+		 * recorded to the database. Only checks which do not need
+		 * the database are performed. Current observation is ended
+		 * before the slew. Observation of the GRB is started when grb
+		 * command with GRB target ID arrives.
+		 *
+		 * @param grbId     GRB ID (not target ID)
+		 * @param t_packet  time when GCN packet was received
+		 * @param t_parse   time when GCN packet was parsed
+		 */
+		int setGrbFast (int grbId, double ra, double dec, double errorbox, double t_packet, double t_parse);
+
+		/**
+		 * Resume observation of target interrupted by GRB fast path
+		 * slew.
+		 */
+		void grbFastReturn ();
 		int setShower ();
 
 		/**
@@ -115,6 +143,25 @@ class Executor:public rts2db::DeviceDb
 		rts2core::ValueDouble *grb_sep_limit;
 		rts2core::ValueDouble *grb_min_sep;
 
+		// GRB fast path latency trace, all relative to GCN packet reception
+		rts2core::ValueTime *grb_fast_packet;
+		rts2core::ValueDouble *grb_fast_parse;
+		rts2core::ValueDouble *grb_fast_decision;
+		rts2core::ValueDouble *grb_fast_command;
+		rts2core::ValueDouble *grb_fast_slew;
+		rts2core::ValueDouble *grb_fast_timeout;
+
+		// true if mount was slewed to GRB and executor waits for GRB target
+		bool grbFastPending;
+		// true if mount was commanded to move and did not started yet
+		bool grbFastSlew;
+		double grbFastTimeout;
+		// ID of GRB the mount was slewed to by the fast path
+		int grbFastId;
+		// target and plan interrupted by fast path slew, -1 if there was no target
+		int grbFastReturnId;
+		int grbFastReturnPlan;
+
 		rts2core::ValueBool *enabled;
 		rts2core::ValueBool *selectorNext;
 		bool selector_next_reported;
@@ -233,6 +280,21 @@ Executor::Executor (int in_argc, char **in_argv):rts2db::DeviceDb (in_argc, in_a
 	createValue (grb_min_sep, "grb_min_sep", "[deg] when GRB is below grb_min_sep degrees from current position, telescope will not be slewed", false, RTS2_VALUE_WRITABLE | RTS2_DT_DEG_DIST);
 	grb_min_sep->setValueDouble (0);
 
+	createValue (grb_fast_packet, "grb_fast_packet", "time when GCN packet of the last GRB passed through fast path was received", false);
+	createValue (grb_fast_parse, "grb_fast_parse", "[s] time from GCN packet reception to parsed GRB position", false);
+	createValue (grb_fast_decision, "grb_fast_decision", "[s] time from GCN packet reception to executor decision", false);
+	createValue (grb_fast_command, "grb_fast_command", "[s] time from GCN packet reception to mount move command", false);
+	createValue (grb_fast_slew, "grb_fast_slew", "[s] time from GCN packet reception to start of the mount slew", false);
+	createValue (grb_fast_timeout, "grb_fast_timeout", "[s] return to the current target if GRB target does not arrive in this time after fast path slew", false, RTS2_VALUE_WRITABLE);
+	grb_fast_timeout->setValueDouble (60);
+
+	grbFastPending = false;
+	grbFastSlew = false;
+	grbFastTimeout = NAN;
+	grbFastId = -1;
+	grbFastReturnId = -1;
+	grbFastReturnPlan = -1;
+
 	addOption (OPT_IGNORE_DAY, "ignore-day", 0, "observe even during daytime");
 	addOption (OPT_DONT_DARK, "no-dark", 0, "do not take on its own dark frames");
 	addOption (OPT_DISABLE_AUTO, "no-auto", 0, "disable autolooping");
@@ -446,6 +508,9 @@ void Executor::postEvent (rts2core::Event * event)
 				postEvent (new rts2core::Event (EVENT_CLEAR_WAIT));
 				break;
 			}
+			// mount is on GRB position, observation starts when GRB target arrives
+			if (grbFastPending && !currentTarget)
+				break;
 			postEvent (new rts2core::Event (EVENT_OBSERVE));
 			break;
 		case EVENT_CORRECTING_OK:
@@ -464,6 +529,12 @@ void Executor::postEvent (rts2core::Event * event)
 			{
 				break;
 			}
+			if (grbFastPending && !currentTarget)
+			{
+				logStream (MESSAGE_WARNING) << "fast path slew to GRB failed" << sendLog;
+				grbFastReturn ();
+				break;
+			}
 			postEvent (new rts2core::Event (EVENT_STOP_OBSERVATION));
 			if (waitState)
 			{
@@ -479,6 +550,22 @@ void Executor::postEvent (rts2core::Event * event)
 			if (scriptCount->getValueInteger () == 0)
 				switchTarget ();
 			break;
+		case EVENT_MOVE_STARTED:
+			if (grbFastSlew)
+			{
+				grbFastSlew = false;
+				grb_fast_slew->setValueDouble (getNow () - grb_fast_packet->getValueDouble ());
+				sendValueAll (grb_fast_slew);
+				logStream (MESSAGE_INFO) << "mount started slew to GRB " << grb_fast_slew->getValueDouble () << " seconds after GCN packet reception" << sendLog;
+			}
+			break;
+		case EVENT_GRB_FAST_TIMEOUT:
+			if (grbFastPending && getNow () >= grbFastTimeout)
+			{
+				logStream (MESSAGE_WARNING) << "GRB target did not arrive after fast slew" << sendLog;
+				grbFastReturn ();
+			}
+			break;
 		case EVENT_ENTER_WAIT:
 			waitState = 1;
 			break;
@@ -720,6 +807,7 @@ int Executor::setNow (int nextId, int plan_id)
 
 int Executor::setNow (rts2db::Target * newTarget, int plan_id)
 {
+	grbFastPending = false;
 	if (currentTarget)
 	{
 		logStream (INFO_OBSERVATION_INTERRUPTED | MESSAGE_INFO) << currentTarget->getObsId () << " " << currentTarget->getTargetID () << " " << currentTarget->getPlanId () << sendLog;
@@ -748,6 +836,18 @@ int Executor::setNow (rts2db::Target * newTarget, int plan_id)
 }
 
 int Executor::setGrb (int grbId)
+{
+	int ret = setGrbTarget (grbId);
+	// GRB the mount was slewed to was not set as current target
+	if (grbFastPending && grbId == grbFastId)
+	{
+		logStream (MESSAGE_INFO) << "GRB target " << grbId << " was not accepted after fast path slew" << sendLog;
+		grbFastReturn ();
+	}
+	return ret;
+}
+
+int Executor::setGrbTarget (int grbId)
 {
 	rts2db::Target *grbTarget = NULL;
 	int ret;
@@ -844,6 +944,147 @@ int Executor::setGrb (int grbId)
 	}
 }
 
+int Executor::setGrbFast (int grbId, double ra, double dec, double errorbox, double t_packet, double t_parse)
+{
+	grb_fast_packet->setValueDouble (t_packet);
+	grb_fast_parse->setValueDouble (t_parse - t_packet);
+	grb_fast_decision->setValueDouble (NAN);
+	grb_fast_command->setValueDouble (NAN);
+	grb_fast_slew->setValueDouble (NAN);
+	grbFastSlew = false;
+
+	int ret = -2;
+	struct ln_equ_posn pos;
+	pos.ra = ra;
+	pos.dec = dec;
+
+	double JD = ln_get_julian_from_sys ();
+
+	if (enabled->getValueBool () == false)
+	{
+		logStream (MESSAGE_DEBUG) << "executor disabled, GRB fast path ignored" << sendLog;
+	}
+	else if (!(getMasterState () == SERVERD_NIGHT || getMasterState () == SERVERD_DUSK || getMasterState () == SERVERD_DAWN))
+	{
+		logStream (MESSAGE_DEBUG) << "daylight / not on state GRB fast path ignored" << sendLog;
+	}
+	else if (Configuration::instance ()->grbdValidity () == 0)
+	{
+		ret = 0;
+	}
+	else
+	{
+		struct ln_hrz_posn hrz;
+		ln_get_hrz_from_equ (&pos, observer, JD, &hrz);
+		if (Configuration::instance ()->getObjectChecker ()->is_good (&hrz) == 0)
+		{
+			logStream (MESSAGE_INFO) << "GRB " << grbId << " at " << LibnovaRaDec (&pos) << " is not visible, fast path ignored" << sendLog;
+		}
+		else if (currentTarget)
+		{
+			struct ln_equ_posn curr;
+			currentTarget->getPosition (&curr, JD);
+			double sep = ln_get_angular_separation (&pos, &curr);
+			ret = 0;
+			// same rules as in setGrb, GRB date is approximated by time of the packet
+			if (currentTarget->getTargetType () == TYPE_GRB
+				&& fabs (t_packet - ((rts2db::TargetGRB *) currentTarget)->getGrbDate ()) < 300
+				&& !std::isnan (errorbox)
+				&& errorbox > ((rts2db::TargetGRB *) currentTarget)->getErrorBox ())
+			{
+				logStream (MESSAGE_INFO) << "GRB " << grbId << " is probably the current target " << currentTarget->getTargetName () << " with smaller errorbox, fast path ignored" << sendLog;
+			}
+			else if (sep <= grb_min_sep->getValueDouble () || sep <= grb_sep_limit->getValueDouble ())
+			{
+				logStream (MESSAGE_INFO) << "GRB " << grbId << " is " << LibnovaDegDist (sep) << " from the current target, fast path ignored" << sendLog;
+			}
+			else
+			{
+				ret = 1;
+			}
+		}
+		else
+		{
+			ret = 1;
+		}
+	}
+
+	grb_fast_decision->setValueDouble (getNow () - t_packet);
+
+	if (ret == 1)
+	{
+		rts2core::Connection *tel = getOpenConnection (DEVICE_TYPE_MOUNT);
+		if (tel && tel->getOtherDevClient ())
+		{
+			// keep target interrupted by the previous fast path slew
+			if (!grbFastPending)
+				grbFastReturnId = -1;
+			// cameras must not expose GRB field with headers of the current observation
+			if (currentTarget)
+			{
+				grbFastReturnId = currentTarget->getTargetID ();
+				grbFastReturnPlan = current_plan_id->getValueInteger ();
+				logStream (INFO_OBSERVATION_INTERRUPTED | MESSAGE_INFO) << currentTarget->getObsId () << " " << currentTarget->getTargetID () << " " << currentTarget->getPlanId () << sendLog;
+				currentTarget->endObservation (-1);
+				processTarget (currentTarget);
+				currentTarget = NULL;
+			}
+			clearAll ();
+			postEvent (new rts2core::Event (EVENT_SET_TARGET_KILL, (void *) NULL));
+
+			grbFastSlew = true;
+			tel->queCommand (new rts2core::CommandMove (this, (rts2core::DevClientTelescope *) tel->getOtherDevClient (), ra, dec));
+			grb_fast_command->setValueDouble (getNow () - t_packet);
+
+			grbFastPending = true;
+			grbFastId = grbId;
+			grbFastTimeout = getNow () + grb_fast_timeout->getValueDouble ();
+			addTimer (grb_fast_timeout->getValueDouble (), new rts2core::Event (EVENT_GRB_FAST_TIMEOUT, this));
+
+			logStream (MESSAGE_INFO) << "slewing to GRB " << grbId << " at " << LibnovaRaDec (&pos) << " before its target is created, " << grb_fast_command->getValueDouble () << " seconds after GCN packet reception" << sendLog;
+		}
+		else
+		{
+			logStream (MESSAGE_ERROR) << "no mount available for GRB fast path" << sendLog;
+		}
+		ret = 0;
+	}
+
+	sendValueAll (grb_fast_packet);
+	sendValueAll (grb_fast_parse);
+	sendValueAll (grb_fast_decision);
+	sendValueAll (grb_fast_command);
+	sendValueAll (grb_fast_slew);
+
+	return ret;
+}
+
+void Executor::grbFastReturn ()
+{
+	grbFastPending = false;
+	grbFastSlew = false;
+	if (currentTarget)
+		return;
+	if (grbFastReturnId >= 0)
+	{
+		try
+		{
+			rts2db::Target *tar = createTarget (grbFastReturnId, observer, obs_altitude);
+			if (tar)
+			{
+				logStream (MESSAGE_INFO) << "returning to target " << tar->getTargetName () << " (#" << tar->getTargetID () << ") interrupted by GRB fast path" << sendLog;
+				setNow (tar, grbFastReturnPlan);
+				return;
+			}
+		}
+		catch (rts2core::Error &er)
+		{
+			logStream (MESSAGE_ERROR) << "cannot return to target with ID " << grbFastReturnId << " : " << er << sendLog;
+		}
+	}
+	switchTarget ();
+}
+
 int Executor::setShower ()
 {
 	// is during night and ready?
@@ -872,6 +1113,7 @@ int Executor::skip ()
 
 int Executor::stop ()
 {
+	grbFastPending = false;
 	flatsDone->setValueBool (false);
 	sendValueAll (flatsDone);
 	clearNextTargets ();
@@ -955,6 +1197,10 @@ void Executor::doSwitch ()
 
 int Executor::switchTarget ()
 {
+	// target is set when GRB target arrives after fast path slew
+	if (grbFastPending && !currentTarget)
+		return 0;
+
 	if (enabled->getValueBool () == false)
 	{
 		clearNextTargets ();
@@ -1060,6 +1306,13 @@ int Executor::commandAuthorized (rts2core::Connection * conn)
 			return -2;
 		return setGrb (tar_id);
 	}
+	else if (conn->isCommand ("grb_fast"))
+	{
+		double ra, dec, errorbox, t_packet, t_parse;
+		if (conn->paramNextInteger (&tar_id) || conn->paramNextDouble (&ra) || conn->paramNextDouble (&dec) || conn->paramNextDouble (&errorbox) || conn->paramNextDouble (&t_packet) || conn->paramNextDouble (&t_parse) || !conn->paramEnd ())
+			return -2;
+		return setGrbFast (tar_id, ra, dec, errorbox, t_packet, t_parse);
+	}
 	else if (conn->isCommand ("shower"))
 	{
 		if (!conn->paramEnd ())
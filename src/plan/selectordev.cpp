@@ -83,6 +83,8 @@ class SelectorDev:public rts2db::DeviceDb
 
 		virtual int commandAuthorized (rts2core::Connection * conn);
 
+		virtual void sendMessage (messageType_t in_messageType, const char *in_messageString);
+
 	protected:
 		virtual int processOption (int in_opt);
 		virtual int reloadConfig ();
@@ -138,8 +140,6 @@ class SelectorDev:public rts2db::DeviceDb
 		rts2core::TimeArray *free_start;
 		rts2core::TimeArray *free_end;
 
-		double last_p;
-
 		double nightHorizon;
 
 		rts2plan::Queues queues;
@@ -407,43 +407,37 @@ int SelectorDev::idle ()
 {
 	if (getState () & SEL_SIMULATING)
 	{
-		double p = simulQueue->step ();
-		if (p == 2)
-		{
-			maskState (SEL_SIMULATING, SEL_IDLE, "simulation finished");
-			simulExpected->setValueDouble (getNow () - simulStart);
-			sendValueAll (simulExpected);
-
-			if (last_p < 0)
-			{
-				if (free_start->size () == 0)
-				{
-					free_start->addValue (from);
-					sendValueAll (free_start);
-				}
-				free_end->addValue (simulQueue->getSimulationTime ());
-				sendValueAll (free_end);
-			}
+		// simulation runs in its own thread, only collect its progress
+		double st;
+		std::vector <double> starts, ends;
+		double p = simulQueue->progress (st, starts, ends);
 
-			setTimeout (60 * USEC_SEC);
+		if (starts.size () > 0)
+		{
+			for (std::vector <double>::iterator iter = starts.begin (); iter != starts.end (); iter++)
+				free_start->addValue (*iter);
+			sendValueAll (free_start);
 		}
-		else
+		if (ends.size () > 0)
 		{
-			if (last_p < 0 && p > 0)
-			{
-				free_end->addValue (simulTime->getValueDouble ());
-				sendValueAll (free_end);
-			}
-			else if (last_p > 0 && p < 0)
-			{
-				free_start->addValue (simulTime->getValueDouble ());
-				sendValueAll (free_start);
-			}
+			for (std::vector <double>::iterator iter = ends.begin (); iter != ends.end (); iter++)
+				free_end->addValue (*iter);
+			sendValueAll (free_end);
+		}
 
-			simulTime->setValueDouble (simulQueue->getSimulationTime ());
+		if (!std::isnan (p) && simulTime->getValueDouble () != st)
+		{
+			simulTime->setValueDouble (st);
 			sendValueAll (simulTime);
+		}
 
-			last_p = p;
+		if (p == 2 || std::isnan (p))
+		{
+			maskState (SEL_SIMULATING, SEL_IDLE, "simulation finished");
+			simulExpected->setValueDouble (getNow () - simulStart);
+			sendValueAll (simulExpected);
+
+			setTimeout (60 * USEC_SEC);
 		}
 	}
 	return rts2db::DeviceDb::idle ();
@@ -717,6 +711,14 @@ int SelectorDev::setValue (rts2core::Value * old_value, rts2core::Value * new_va
 	return rts2db::DeviceDb::setValue (old_value, new_value);
 }
 
+void SelectorDev::sendMessage (messageType_t in_messageType, const char *in_messageString)
+{
+	// messages from simulation thread are send from idle call
+	if (simulQueue != NULL && simulQueue->queueMessage (in_messageType, in_messageString))
+		return;
+	rts2db::DeviceDb::sendMessage (in_messageType, in_messageString);
+}
+
 void SelectorDev::valueChanged (rts2core::Value *value)
 {
 	if ((value == selEnabled && selEnabled->getValueBool ()) || value == queueOnly)
@@ -977,7 +979,6 @@ int SelectorDev::commandAuthorized (rts2core::Connection * conn)
 				from = simulStart;
 		}
 
-		last_p = 0;
 		free_start->clear ();
 		free_end->clear ();
 
@@ -989,7 +990,7 @@ int SelectorDev::commandAuthorized (rts2core::Connection * conn)
 
 		simulQueue->start (from, to);
 		maskState (SEL_SIMULATING, SEL_SIMULATING, "starting simulation", simulStart, simulStart + simulExpected->getValueDouble ());
-		setTimeout (0);
+		setTimeout (USEC_SEC / 10);
 		return 0;
 	}
 	else
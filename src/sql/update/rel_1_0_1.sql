@@ -0,0 +1,69 @@
+-- rollup tables for value records, maintained incrementally by trigger on records_double
+
+CREATE VIEW records_double_minute AS
+SELECT
+	recval_id,
+	date_trunc('minute',rectime) as minute,
+	avg(value) as avg_value,
+	min(value) as min_value,
+	max(value) as max_value,
+	count(*) as nrec
+FROM
+	records_double
+WHERE
+	value <> 'NaN'
+GROUP BY
+	recval_id,
+	minute
+ORDER BY
+	minute,
+	recval_id;
+
+SELECT * INTO mv_records_double_minute FROM records_double_minute;
+
+CREATE INDEX mv_records_double_minute_minute ON mv_records_double_minute (minute);
+CREATE UNIQUE INDEX mv_records_double_minute_record ON mv_records_double_minute (recval_id, minute);
+
+-- hourly table was refreshed only by mv_refresh, bring it up to date before trigger takes over
+DELETE FROM mv_records_double_hour;
+INSERT INTO mv_records_double_hour (SELECT * FROM records_double_hour WHERE avg_value <> 'NaN');
+
+CREATE OR REPLACE FUNCTION mv_refresh () RETURNS void AS '
+DELETE FROM mv_records_double_minute;
+DELETE FROM mv_records_double_hour;
+DELETE FROM mv_records_double_day;
+
+INSERT INTO mv_records_double_day (SELECT * FROM records_double_day);
+INSERT INTO mv_records_double_hour (SELECT * FROM records_double_hour WHERE avg_value <> ''NaN'');
+INSERT INTO mv_records_double_minute (SELECT * FROM records_double_minute);' LANGUAGE SQL;
+
+-- add new record to minute and hour rollup
+CREATE OR REPLACE FUNCTION records_double_rollup () RETURNS trigger AS '
+BEGIN
+	IF NEW.value IS NULL OR NEW.value = ''NaN'' THEN
+		RETURN NULL;
+	END IF;
+
+	-- concurrent inserts of the same record can create the rollup row at the same time, let unique index resolve it
+	INSERT INTO mv_records_double_minute AS m VALUES (NEW.recval_id, date_trunc (''minute'', NEW.rectime), NEW.value, NEW.value, NEW.value, 1)
+	ON CONFLICT (recval_id, minute) DO UPDATE SET
+		avg_value = (m.avg_value * m.nrec + NEW.value) / (m.nrec + 1),
+		min_value = least (m.min_value, NEW.value),
+		max_value = greatest (m.max_value, NEW.value),
+		nrec = m.nrec + 1;
+
+	INSERT INTO mv_records_double_hour AS h VALUES (NEW.recval_id, date_trunc (''hour'', NEW.rectime), NEW.value, NEW.value, NEW.value, 1)
+	ON CONFLICT (recval_id, hour) DO UPDATE SET
+		avg_value = (h.avg_value * h.nrec + NEW.value) / (h.nrec + 1),
+		min_value = least (h.min_value, NEW.value),
+		max_value = greatest (h.max_value, NEW.value),
+		nrec = h.nrec + 1;
+
+	RETURN NULL;
+END;
+' LANGUAGE plpgsql;
+
+CREATE TRIGGER records_double_rollup AFTER INSERT ON records_double
+	FOR EACH ROW EXECUTE PROCEDURE records_double_rollup ();
+
+GRANT ALL ON mv_records_double_minute TO GROUP observers;
@@ -0,0 +1,232 @@
+/*
+ * Fit GPoint telescope pointing model.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "cliapp.h"
+#include "error.h"
+#include "gpointfit.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdlib.h>
+#include <string.h>
+
+#define OPT_FLIP          OPT_LOCAL + 1
+#define OPT_LATITUDE      OPT_LOCAL + 2
+#define OPT_FIXED         OPT_LOCAL + 3
+#define OPT_EXTRA         OPT_LOCAL + 4
+#define OPT_MAXFEV        OPT_LOCAL + 5
+#define OPT_FTOL          OPT_LOCAL + 6
+#define OPT_XTOL          OPT_LOCAL + 7
+#define OPT_STAT_ONLY     OPT_LOCAL + 8
+#define OPT_BOOTSTRAP     OPT_LOCAL + 9
+
+/**
+ * Fits pointing model from alignment data. Accepts the same input and
+ * options as gpoint script, without plotting.
+ */
+class GPointFitApp:public rts2core::CliApp
+{
+	public:
+		GPointFitApp (int in_argc, char **in_argv);
+
+		virtual int doProcessing ();
+
+	protected:
+		virtual int processOption (int in_opt);
+		virtual int processArgs (const char *arg);
+		virtual void usage ();
+
+	private:
+		std::vector <const char *> inputs;
+		std::vector <const char *> extras;
+		const char *output;
+		const char *flips;
+		const char *fixed;
+		double latitude;
+		int maxfev;
+		double ftol;
+		double xtol;
+		bool statOnly;
+		int bootstrap;
+		int threads;
+		int verbose;
+};
+
+GPointFitApp::GPointFitApp (int in_argc, char **in_argv):rts2core::CliApp (in_argc, in_argv)
+{
+	output = NULL;
+	flips = "both";
+	fixed = NULL;
+	latitude = NAN;
+	maxfev = 10000;
+	ftol = 1.49012e-08;
+	xtol = 1.49012e-08;
+	statOnly = false;
+	bootstrap = 0;
+	threads = 0;
+	verbose = 0;
+
+	addOption ('o', NULL, 1, "model output filename");
+	addOption ('v', NULL, 0, "verbose, print fitted parameters");
+	addOption ('j', NULL, 1, "number of bootstrap threads (default to number of CPUs)");
+	addOption (OPT_FLIP, "flip", 1, "flips (both, east, west - select pointings only on given side)");
+	addOption (OPT_LATITUDE, "latitude", 1, "observatory latitude (north is positive)");
+	addOption (OPT_FIXED, "fixed", 1, "list (, separated) of parameters to fix (ie,ia,..); !negates the selection");
+	addOption (OPT_EXTRA, "extra", 1, "extra (harmonics,...) functions, axis:function:terms:consts");
+	addOption (OPT_MAXFEV, "maxfev", 1, "maximal number of least square fitting iterations");
+	addOption (OPT_FTOL, "ftol", 1, "relative error desired in the sum of squares");
+	addOption (OPT_XTOL, "xtol", 1, "relative error desired in the approximate solution");
+	addOption (OPT_STAT_ONLY, "stat-only", 0, "do not attempt to fit the model - only print statistics");
+	addOption (OPT_BOOTSTRAP, "bootstrap", 1, "estimate parameter errors from given number of resampled fits");
+}
+
+int GPointFitApp::processOption (int in_opt)
+{
+	switch (in_opt)
+	{
+		case 'o':
+			output = optarg;
+			break;
+		case 'v':
+			verbose++;
+			break;
+		case 'j':
+			threads = atoi (optarg);
+			break;
+		case OPT_FLIP:
+			flips = optarg;
+			break;
+		case OPT_LATITUDE:
+			latitude = atof (optarg);
+			break;
+		case OPT_FIXED:
+			fixed = optarg;
+			break;
+		case OPT_EXTRA:
+			extras.push_back (optarg);
+			break;
+		case OPT_MAXFEV:
+			maxfev = atoi (optarg);
+			break;
+		case OPT_FTOL:
+			ftol = atof (optarg);
+			break;
+		case OPT_XTOL:
+			xtol = atof (optarg);
+			break;
+		case OPT_STAT_ONLY:
+			statOnly = true;
+			break;
+		case OPT_BOOTSTRAP:
+			bootstrap = atoi (optarg);
+			break;
+		default:
+			return rts2core::CliApp::processOption (in_opt);
+	}
+	return 0;
+}
+
+int GPointFitApp::processArgs (const char *arg)
+{
+	inputs.push_back (arg);
+	return 0;
+}
+
+void GPointFitApp::usage ()
+{
+	std::cout
+		<< "  rts2-gpoint-fit -o model.gem alignment.txt                         .. fit GEM or Alt-Az model, save it to model.gem" << std::endl
+		<< "  rts2-gpoint-fit --extra az:sin:az:2 --bootstrap 500 -o model.altaz alignment.txt  .. add extra term, estimate errors from 500 resampled fits" << std::endl;
+}
+
+int GPointFitApp::doProcessing ()
+{
+	if (inputs.empty ())
+	{
+		std::cerr << "missing input file(s)" << std::endl;
+		return -1;
+	}
+
+	rts2telmodel::GPointFit fit (latitude);
+
+	try
+	{
+		for (std::vector <const char *>::iterator iter = extras.begin (); iter != extras.end (); iter++)
+			fit.addExtra (*iter);
+
+		if (fixed)
+		{
+			if (fixed[0] == '!')
+			{
+				fit.setVaryOnly (true);
+				fixed++;
+			}
+			std::vector <std::string> fn = SplitStr (std::string (fixed), std::string (","));
+			for (std::vector <std::string>::iterator iter = fn.begin (); iter != fn.end (); iter++)
+				fit.setFixed (iter->c_str ());
+		}
+
+		for (std::vector <const char *>::iterator iter = inputs.begin (); iter != inputs.end (); iter++)
+			fit.readAlignment (*iter, flips);
+
+		std::cout << "Input points " << fit.getPoints () << " RMS " << fit.getRMS (false) << "\"" << std::endl;
+
+		if (statOnly)
+			return 0;
+
+		int nfev = fit.fit (maxfev, ftol, xtol);
+
+		if (bootstrap > 0)
+			fit.bootstrap (bootstrap, threads);
+
+		if (verbose)
+			std::cout << "Evaluations " << nfev << std::endl;
+
+		fit.printParams (std::cout);
+
+		std::cout << "Model RMS " << fit.getRMS (true) << "\"" << std::endl;
+
+		if (output)
+		{
+			std::ofstream os (output);
+			fit.print (os);
+			if (os.fail ())
+			{
+				std::cerr << "cannot write model to " << output << std::endl;
+				return -1;
+			}
+		}
+		else
+		{
+			fit.print (std::cout);
+		}
+	}
+	catch (rts2core::Error &er)
+	{
+		std::cerr << er << std::endl;
+		return -1;
+	}
+	return 0;
+}
+
+int main (int argc, char **argv)
+{
+	GPointFitApp app (argc, argv);
+	return app.run ();
+}
@@ -0,0 +1,273 @@
+/*
+ * WebSocket client subscribed to device values.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#include "wsclient.h"
+#include "nan.h"
+
+#include <json.hpp>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+using namespace rts2wsd;
+
+WsClient::WsClient (struct lws *_wsi)
+{
+	wsi = _wsi;
+	binary = false;
+	interval = 0;
+	lastUpdate = 0;
+	coalesced = 0;
+}
+
+bool WsClient::receive (const char *data, size_t len)
+{
+	if (message.length () + len > WS_MAX_MESSAGE)
+	{
+		message.clear ();
+		return false;
+	}
+	message.append (data, len);
+	return true;
+}
+
+void WsClient::command (std::vector <valueName_t> &added)
+{
+	std::string msg;
+	msg.swap (message);
+
+	try
+	{
+		nlohmann::json j = nlohmann::json::parse (msg);
+		if (!j.is_object () || j.size () != 1)
+		{
+			setReply ("error", "message must be object with single member");
+			return;
+		}
+		nlohmann::json::iterator cmd = j.begin ();
+		if (cmd.key () == "subscribe" || cmd.key () == "unsubscribe")
+		{
+			bool sub = cmd.key () == "subscribe";
+			if (!cmd->is_object ())
+			{
+				setReply ("error", "devices must be object");
+				return;
+			}
+			for (nlohmann::json::iterator dev = cmd->begin (); dev != cmd->end (); dev++)
+			{
+				if (dev->is_string ())
+				{
+					changeSubscription (dev.key (), dev->get <std::string> (), sub, added);
+				}
+				else if (dev->is_array ())
+				{
+					for (nlohmann::json::iterator v = dev->begin (); v != dev->end (); v++)
+						changeSubscription (dev.key (), v->get <std::string> (), sub, added);
+				}
+				else
+				{
+					setReply ("error", "values must be string or array");
+					return;
+				}
+			}
+		}
+		else if (cmd.key () == "format")
+		{
+			std::string f = cmd->get <std::string> ();
+			if (f == "json")
+			{
+				binary = false;
+			}
+			else if (f == "binary")
+			{
+				binary = true;
+			}
+			else
+			{
+				setReply ("error", "unknown format");
+				return;
+			}
+			// pending updates are kept in both encodings
+		}
+		else if (cmd.key () == "interval")
+		{
+			interval = cmd->get <double> ();
+		}
+		else
+		{
+			setReply ("error", "unknown command");
+			return;
+		}
+		setReply ("ok", cmd.key ().c_str ());
+	}
+	catch (nlohmann::json::exception &ex)
+	{
+		setReply ("error", ex.what ());
+	}
+}
+
+bool WsClient::subscribed (const std::string &device, const std::string &value)
+{
+	std::map <std::string, std::set <std::string> >::iterator iter = subscriptions.find (device);
+	if (iter == subscriptions.end ())
+		return false;
+	return iter->second.find ("*") != iter->second.end () || iter->second.find (value) != iter->second.end ();
+}
+
+void WsClient::queue (const valueName_t &name, const std::string &json, const std::string &record)
+{
+	std::string &pj = pendingJson[name];
+	if (!pj.empty ())
+		coalesced++;
+	pj = json;
+	// binary encoding is used if available, text otherwise; keep only one
+	if (record.empty ())
+		pendingBinary.erase (name);
+	else
+		pendingBinary[name] = record;
+}
+
+double WsClient::nextWrite ()
+{
+	if (!replies.empty ())
+		return 0;
+	if (pendingJson.empty ())
+		return NAN;
+	return lastUpdate + interval;
+}
+
+bool WsClient::nextFrame (std::string &frame, bool &isBinary, double now)
+{
+	frame.clear ();
+	if (!replies.empty ())
+	{
+		frame.swap (replies.front ());
+		replies.pop_front ();
+		isBinary = false;
+		return true;
+	}
+
+	if (pendingJson.empty () || now < lastUpdate + interval)
+		return false;
+
+	if (binary && !pendingBinary.empty ())
+	{
+		isBinary = true;
+		uint64_t t;
+		memcpy (&t, &now, sizeof (t));
+		for (int i = 0; i < 8; i++, t >>= 8)
+			frame.push_back ((char) (t & 0xff));
+		std::map <valueName_t, std::string>::iterator iter = pendingBinary.begin ();
+		while (iter != pendingBinary.end ())
+		{
+			size_t rs = 2 + iter->first.first.length () + iter->second.length ();
+			if (frame.size () + rs > WS_MAX_FRAME && frame.size () > 8)
+				break;
+			uint16_t dl = iter->first.first.length ();
+			char b[2] = {(char) (dl & 0xff), (char) (dl >> 8)};
+			frame.append (b, 2);
+			frame.append (iter->first.first);
+			frame.append (iter->second);
+			pendingJson.erase (iter->first);
+			pendingBinary.erase (iter++);
+		}
+	}
+	else
+	{
+		isBinary = false;
+		char buf[50];
+		snprintf (buf, sizeof (buf), "{\"t\":%.6f,\"d\":{", now);
+		frame = buf;
+		std::string device;
+		std::map <valueName_t, std::string>::iterator iter = pendingJson.begin ();
+		while (iter != pendingJson.end ())
+		{
+			// binary client receives in text only values which cannot be encoded
+			if (binary && pendingBinary.find (iter->first) != pendingBinary.end ())
+			{
+				iter++;
+				continue;
+			}
+			size_t rs = iter->first.first.length () + iter->first.second.length () + iter->second.length () + 10;
+			if (frame.size () + rs > WS_MAX_FRAME && !device.empty ())
+				break;
+			if (device != iter->first.first)
+			{
+				if (!device.empty ())
+					frame += "},";
+				device = iter->first.first;
+				frame += "\"" + device + "\":{";
+			}
+			else
+			{
+				frame += ",";
+			}
+			frame += "\"" + iter->first.second + "\":" + iter->second;
+			pendingJson.erase (iter++);
+		}
+		if (device.empty ())
+			return false;
+		frame += "}}}";
+	}
+
+	if (pendingJson.empty ())
+		lastUpdate = now;
+	return true;
+}
+
+void WsClient::setReply (const char *key, const char *value)
+{
+	nlohmann::json j;
+	j[key] = value;
+	replies.push_back (j.dump ());
+}
+
+void WsClient::changeSubscription (const std::string &device, const std::string &value, bool subscribe, std::vector <valueName_t> &added)
+{
+	if (subscribe)
+	{
+		if (subscriptions[device].insert (value).second)
+			added.push_back (valueName_t (device, value));
+		return;
+	}
+	std::map <std::string, std::set <std::string> >::iterator iter = subscriptions.find (device);
+	if (iter == subscriptions.end ())
+		return;
+	if (value == "*")
+		iter->second.clear ();
+	else
+		iter->second.erase (value);
+	if (iter->second.empty ())
+		subscriptions.erase (iter);
+
+	// drop pending updates of unsubscribed values
+	std::map <valueName_t, std::string>::iterator piter = pendingJson.lower_bound (valueName_t (device, ""));
+	while (piter != pendingJson.end () && piter->first.first == device)
+	{
+		if (!subscribed (device, piter->first.second))
+		{
+			pendingBinary.erase (piter->first);
+			pendingJson.erase (piter++);
+		}
+		else
+		{
+			piter++;
+		}
+	}
+}
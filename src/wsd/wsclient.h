@@ -0,0 +1,163 @@
+/*
+ * WebSocket client subscribed to device values.
+ * Copyright (C) 2026 RTS2 developers
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+ */
+
+#ifndef __RTS2_WSCLIENT__
+#define __RTS2_WSCLIENT__
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "wsd.h"
+
+/**
+ * Maximal size of frame with value updates. More values are sent in
+ * multiple frames.
+ */
+#define WS_MAX_FRAME    32768
+
+/**
+ * Maximal size of message received from client. Commands are short, a
+ * longer message is treated as protocol violation.
+ */
+#define WS_MAX_MESSAGE  65536
+
+namespace rts2wsd
+{
+
+typedef std::pair <std::string, std::string> valueName_t;
+
+/**
+ * Client connected with rts2-values protocol.
+ *
+ * Client sends JSON text messages:
+ *
+ * <pre>
+ * {"subscribe":{"C0":["infotime","exposure"],"T0":"*"}}
+ * {"unsubscribe":{"C0":["exposure"]}}
+ * {"unsubscribe":{"T0":"*"}}
+ * {"format":"binary"}
+ * {"interval":0.5}
+ * </pre>
+ *
+ * "*" subscribes (or unsubscribes) all values of the device. Current values
+ * are sent after subscription, after that only changed values are sent.
+ * Interval is minimal time in seconds between two updates, value changes
+ * in between are coalesced. Every message is answered with {"ok":"command"},
+ * or {"error":"reason"}.
+ *
+ * Updates are sent as text frames {"t":time,"d":{"C0":{"infotime":..}}}, or,
+ * if binary format was requested, as binary frames. Binary frame starts
+ * with time as little endian double, followed by records holding device
+ * name length (uint16), device name and value record in format of
+ * rts2core::ValueFrame. Values which cannot be encoded in binary frames
+ * are sent in text frames.
+ *
+ * If client is not able to receive updates as fast as values change,
+ * only the last change of each value is kept and sent.
+ */
+class WsClient
+{
+	public:
+		WsClient (struct lws *_wsi);
+
+		struct lws *getWsi () { return wsi; }
+
+		/**
+		 * Append received data to message. Message is processed by
+		 * command call after last fragment is received.
+		 *
+		 * @return false if message exceeds WS_MAX_MESSAGE, true otherwise
+		 */
+		bool receive (const char *data, size_t len);
+
+		/**
+		 * Process received message.
+		 *
+		 * @param added  newly subscribed values; value name is "*" if all device values were subscribed
+		 */
+		void command (std::vector <valueName_t> &added);
+
+		/**
+		 * Returns true if client subscribed given value.
+		 */
+		bool subscribed (const std::string &device, const std::string &value);
+
+		bool subscribedDevice (const std::string &device) { return subscriptions.find (device) != subscriptions.end (); }
+
+		bool isBinary () { return binary; }
+
+		/**
+		 * Queue value update. Replaces previous update of the same value.
+		 *
+		 * @param json    JSON encoded value
+		 * @param record  value encoded with rts2core::ValueFrame, empty if value cannot be encoded
+		 */
+		void queue (const valueName_t &name, const std::string &json, const std::string &record);
+
+		/**
+		 * Time when the next frame can be sent.
+		 *
+		 * @return time, NAN if there isn't anything to send
+		 */
+		double nextWrite ();
+
+		/**
+		 * Fill next frame.
+		 *
+		 * @param frame      frame data
+		 * @param isBinary   true if frame is binary
+		 * @param now        current time
+		 *
+		 * @return false if there isn't anything to send
+		 */
+		bool nextFrame (std::string &frame, bool &isBinary, double now);
+
+		/**
+		 * Number of value updates replaced by newer update before they were sent.
+		 */
+		unsigned long getCoalesced () { return coalesced; }
+
+	private:
+		struct lws *wsi;
+
+		std::string message;
+
+		// subscribed values, "*" for all device values
+		std::map <std::string, std::set <std::string> > subscriptions;
+
+		bool binary;
+		double interval;
+		double lastUpdate;
+
+		std::list <std::string> replies;
+		std::map <valueName_t, std::string> pendingJson;
+		std::map <valueName_t, std::string> pendingBinary;
+
+		unsigned long coalesced;
+
+		void setReply (const char *key, const char *value);
+		void changeSubscription (const std::string &device, const std::string &value, bool subscribe, std::vector <valueName_t> &added);
+};
+
+}
+
+#endif // !__RTS2_WSCLIENT__
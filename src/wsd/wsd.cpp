@@ -18,7 +18,6 @@
  */
 
 #include "rts2-config.h"
-#include "wsd.h"
 
 #ifdef RTS2_HAVE_PGSQL
 #include "rts2db/devicedb.h"
@@ -26,64 +25,24 @@
 #include "device.h"
 #endif
 
-int max_poll_elements;
+#include "valueframe.h"
+#include "rts2json/jsonvalue.h"
 
-struct lws_pollfd *pollfds;
-int *fd_lookup;
-int count_pollfds;
+#include "wsd.h"
+#include "wsclient.h"
 
-int callback_dumb_increment (struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len)
-{
-	unsigned char buf[LWS_PRE + 512];
-	struct per_session_data__dumb_increment *pss = (struct per_session_data__dumb_increment *)user;
-	unsigned char *p = &buf[LWS_PRE];
-	int n, m;
+#include <list>
+#include <sstream>
 
-	switch (reason) {
+using namespace rts2wsd;
 
-	case LWS_CALLBACK_ESTABLISHED:
-		pss->number = 0;
-		break;
+int max_poll_elements;
 
-	case LWS_CALLBACK_SERVER_WRITEABLE:
-		n = sprintf((char *)p, "%d", pss->number++);
-		m = lws_write(wsi, p, n, LWS_WRITE_TEXT);
-		if (m < n)
-		{
-			logStream (MESSAGE_ERROR) << "ERROR " << n << " writing to di socket" << sendLog;
-			return -1;
-		}
-		break;
+struct lws_pollfd *pollfds;
+int *fd_lookup;
+int count_pollfds;
 
-	case LWS_CALLBACK_RECEIVE:
-		if (len < 6)
-			break;
-		if (strcmp((const char *)in, "reset\n") == 0)
-			pss->number = 0;
-		if (strcmp((const char *)in, "closeme\n") == 0) {
-			logStream (MESSAGE_INFO) << "dumb_inc: closing as requested" << sendLog;
-			lws_close_reason(wsi, LWS_CLOSE_STATUS_GOINGAWAY, (unsigned char *)"seeya", 5);
-			return -1;
-		}
-		break;
-	/*
-	 * this just demonstrates how to handle
-	 * LWS_CALLBACK_WS_PEER_INITIATED_CLOSE and extract the peer's close
-	 * code and auxiliary data.  You can just not handle it if you don't
-	 * have a use for this.
-	 */
-	case LWS_CALLBACK_WS_PEER_INITIATED_CLOSE:
-		logStream (MESSAGE_INFO) << "LWS_CALLBACK_WS_PEER_INITIATED_CLOSE: len " << len << sendLog;
-		for (n = 0; n < (int)len; n++)
-			logStream (MESSAGE_INFO) << " " << n << ": " << ((unsigned char*) in)[n] << sendLog;
-		break;
-
-	default:
-		break;
-	}
-
-	return 0;
-}
+int callback_rts2_values (struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len);
 
 static struct lws_protocols protocols[] = {
 	/* first protocol must always be HTTP handler */
@@ -94,16 +53,34 @@ static struct lws_protocols protocols[] = {
 		0			/* max frame size / rx buffer */
 	},
 	{
-		"dumb-increment-protocol",
-		callback_dumb_increment,
-		sizeof(struct per_session_data__dumb_increment),
-		10
-	}
+		"rts2-values",
+		callback_rts2_values,
+		sizeof (struct per_session_data__values),
+		4096
+	},
+	{ NULL, NULL, 0, 0 }
+};
+
+/**
+ * Notifies daemon about value changes of other devices.
+ */
+class WsDevClient:public rts2core::DevClient
+{
+	public:
+		WsDevClient (rts2core::Connection *conn):rts2core::DevClient (conn) {}
+
+		virtual void valueChanged (rts2core::Value *value);
 };
 
 /**
  * Websocket access daemon.
  *
+ * Connects to RTS2 devices as any other device and pushes changes of values
+ * subscribed by websocket clients. Changes are collected during processing
+ * of device connections and pushed to clients once per main loop
+ * iteration, so a value changed multiple times is encoded and sent only
+ * once.
+ *
  * @author Petr Kubanek <petr@kubanek.net>
  */
 #ifdef RTS2_HAVE_PGSQL
@@ -116,6 +93,15 @@ class WsD:public rts2core::Device
 		WsD (int argc, char **argv);
 		virtual ~WsD ();
 
+		virtual rts2core::DevClient *createOtherType (rts2core::Connection *conn, int other_device_type);
+
+		/**
+		 * Called when value of other device changed.
+		 */
+		void deviceValueChanged (rts2core::Connection *conn, rts2core::Value *value);
+
+		int valuesCallback (struct lws *wsi, enum lws_callback_reasons reason, struct per_session_data__values *pss, void *in, size_t len);
+
 	protected:
 		virtual int processOption (int opt);
 		virtual int initHardware ();
@@ -123,11 +109,74 @@ class WsD:public rts2core::Device
 		virtual int willConnect (rts2core::NetworkAddress * _addr);
 #endif
 
+		virtual void addPollSocks ();
+		virtual void pollSuccess ();
+		virtual int idle ();
+
 	private:
 		struct lws_context_creation_info info;
 		struct lws_context *context;
+
+		std::list <WsClient *> clients;
+
+		// values changed since last flush
+		std::set <valueName_t> changed;
+
+		rts2core::ValueInteger *numClients;
+		rts2core::ValueLong *framesSent;
+		rts2core::ValueLong *valuesCoalesced;
+		double lastStats;
+
+		// value changes of closed clients
+		unsigned long closedCoalesced;
+
+		/**
+		 * Queue changed values to clients which subscribed them.
+		 */
+		void flushChanged ();
+
+		/**
+		 * Queue current values to client after subscription.
+		 */
+		void queueCurrent (WsClient *client, std::vector <valueName_t> &added);
+
+		/**
+		 * Ask for writable callbacks of clients which have something to send.
+		 */
+		void scheduleWrites ();
+
+		void writeClient (WsClient *client);
+
+		void updateStats ();
 };
 
+void WsDevClient::valueChanged (rts2core::Value *value)
+{
+	((WsD *) getMaster ())->deviceValueChanged (getConnection (), value);
+	rts2core::DevClient::valueChanged (value);
+}
+
+int callback_rts2_values (struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len)
+{
+	WsD *master = (WsD *) lws_context_user (lws_get_context (wsi));
+	return master->valuesCallback (wsi, reason, (struct per_session_data__values *) user, in, len);
+}
+
+// encode value once for all clients
+static void encodeValue (rts2core::Value *value, std::string &json, std::string &record)
+{
+	std::ostringstream os;
+	os << std::fixed;
+	rts2json::jsonValueData (value, false, os);
+	json = os.str ();
+
+	rts2core::ValueFrame vf;
+	if (vf.add (value))
+		record.assign (vf.data (), vf.size ());
+	else
+		record.clear ();
+}
+
 #ifdef RTS2_HAVE_PGSQL
 WsD::WsD (int argc, char **argv):rts2db::DeviceDb (argc, argv, DEVICE_TYPE_HTTPD, "WSD")
 #else
@@ -139,12 +188,96 @@ WsD::WsD (int argc, char **argv):rts2core::Device (argc, argv, DEVICE_TYPE_HTTPD
 
 	context = NULL;
 
+	createValue (numClients, "clients", "number of connected websocket clients", false);
+	numClients->setValueInteger (0);
+	createValue (framesSent, "frames_sent", "number of frames with value updates sent to clients", false);
+	framesSent->setValueLong (0);
+	createValue (valuesCoalesced, "values_coalesced", "value updates replaced by newer update before they were sent", false);
+	valuesCoalesced->setValueLong (0);
+
+	lastStats = 0;
+	closedCoalesced = 0;
+
 	addOption ('p', NULL, 1, "websocket port. Default to 8888");
 }
 
 WsD::~WsD()
 {
 	lws_context_destroy (context);
+	for (std::list <WsClient *>::iterator iter = clients.begin (); iter != clients.end (); iter++)
+		delete *iter;
+	free (pollfds);
+	free (fd_lookup);
+}
+
+rts2core::DevClient *WsD::createOtherType (rts2core::Connection *conn, int other_device_type)
+{
+	return new WsDevClient (conn);
+}
+
+void WsD::deviceValueChanged (rts2core::Connection *conn, rts2core::Value *value)
+{
+	if (clients.empty ())
+		return;
+	// names are stored, as value can be deleted before changes are flushed
+	changed.insert (valueName_t (conn->getName (), value->getName ()));
+}
+
+int WsD::valuesCallback (struct lws *wsi, enum lws_callback_reasons reason, struct per_session_data__values *pss, void *in, size_t len)
+{
+	WsClient *client = (WsClient *) pss->client;
+
+	switch (reason)
+	{
+		case LWS_CALLBACK_ESTABLISHED:
+			client = new WsClient (wsi);
+			pss->client = client;
+			clients.push_back (client);
+			numClients->setValueInteger (clients.size ());
+			break;
+
+		case LWS_CALLBACK_CLOSED:
+			if (client == NULL)
+				break;
+			clients.remove (client);
+			closedCoalesced += client->getCoalesced ();
+			delete client;
+			pss->client = NULL;
+			numClients->setValueInteger (clients.size ());
+			break;
+
+		case LWS_CALLBACK_RECEIVE:
+			if (client == NULL)
+				return -1;
+			if (!client->receive ((const char *) in, len))
+			{
+				logStream (MESSAGE_WARNING) << "closing websocket client, message longer than " << WS_MAX_MESSAGE << " bytes" << sendLog;
+				lws_close_reason (wsi, LWS_CLOSE_STATUS_MESSAGE_TOO_LARGE, NULL, 0);
+				return -1;
+			}
+			if (lws_is_final_fragment (wsi) && lws_remaining_packet_payload (wsi) == 0)
+			{
+				std::vector <valueName_t> added;
+				client->command (added);
+				if (!added.empty ())
+				{
+					// changes not yet flushed shall not be sent twice
+					flushChanged ();
+					queueCurrent (client, added);
+				}
+				lws_callback_on_writable (wsi);
+			}
+			break;
+
+		case LWS_CALLBACK_SERVER_WRITEABLE:
+			if (client != NULL)
+				writeClient (client);
+			break;
+
+		default:
+			break;
+	}
+	return 0;
 }
 
 int WsD::processOption (int opt)
@@ -166,7 +299,19 @@ int WsD::processOption (int opt)
 
 int WsD::initHardware ()
 {
+	// descriptors are polled in RTS2 main loop
+	max_poll_elements = getdtablesize ();
+	pollfds = (struct lws_pollfd *) malloc (max_poll_elements * sizeof (struct lws_pollfd));
+	fd_lookup = (int *) malloc (max_poll_elements * sizeof (int));
+	count_pollfds = 0;
+	if (pollfds == NULL || fd_lookup == NULL)
+	{
+		logStream (MESSAGE_ERROR) << "cannot allocate poll descriptors" << sendLog;
+		return -1;
+	}
+
 	info.protocols = protocols;
+	info.user = this;
 
 	info.gid = -1;
 	info.uid = -1;
@@ -194,6 +339,9 @@ int WsD::initHardware ()
 		return -1;
 	}
 
+	// libwebsockets timeouts are serviced from idle
+	setTimeout (USEC_SEC);
+
 	return 0;
 }
 
@@ -208,6 +356,167 @@ int WsD::willConnect (rts2core::NetworkAddress *_addr)
 }
 #endif
 
+void WsD::addPollSocks ()
+{
+#ifdef RTS2_HAVE_PGSQL
+	DeviceDb::addPollSocks ();
+#else
+	rts2core::Device::addPollSocks ();
+#endif
+	for (int i = 0; i < count_pollfds; i++)
+		addPollFD (pollfds[i].fd, pollfds[i].events);
+}
+
+void WsD::pollSuccess ()
+{
+#ifdef RTS2_HAVE_PGSQL
+	DeviceDb::pollSuccess ();
+#else
+	rts2core::Device::pollSuccess ();
+#endif
+	// servicing can add and remove descriptors, so first collect them
+	std::vector <struct lws_pollfd> ready;
+	for (int i = 0; i < count_pollfds; i++)
+	{
+		pollfds[i].revents = getPollEvents (pollfds[i].fd);
+		if (pollfds[i].revents)
+			ready.push_back (pollfds[i]);
+	}
+	for (std::vector <struct lws_pollfd>::iterator iter = ready.begin (); iter != ready.end (); iter++)
+		lws_service_fd (context, &(*iter));
+}
+
+int WsD::idle ()
+{
+	flushChanged ();
+	scheduleWrites ();
+	if (context)
+		lws_service_fd (context, NULL);
+	if (getNow () - lastStats > 1)
+		updateStats ();
+#ifdef RTS2_HAVE_PGSQL
+	return DeviceDb::idle ();
+#else
+	return Device::idle ();
+#endif
+}
+
+void WsD::flushChanged ()
+{
+	std::string json, record;
+	for (std::set <valueName_t>::iterator iter = changed.begin (); iter != changed.end (); iter++)
+	{
+		rts2core::Connection *conn = getOpenConnection (iter->first.c_str ());
+		if (conn == NULL)
+			continue;
+		rts2core::Value *value = conn->getValue (iter->second.c_str ());
+		if (value == NULL)
+			continue;
+		bool encoded = false;
+		for (std::list <WsClient *>::iterator citer = clients.begin (); citer != clients.end (); citer++)
+		{
+			if (!(*citer)->subscribed (iter->first, iter->second))
+				continue;
+			if (!encoded)
+			{
+				encodeValue (value, json, record);
+				encoded = true;
+			}
+			(*citer)->queue (*iter, json, record);
+		}
+	}
+	changed.clear ();
+}
+
+void WsD::queueCurrent (WsClient *client, std::vector <valueName_t> &added)
+{
+	std::string json, record;
+	for (std::vector <valueName_t>::iterator iter = added.begin (); iter != added.end (); iter++)
+	{
+		rts2core::Connection *conn = getOpenConnection (iter->first.c_str ());
+		if (conn == NULL)
+			continue;
+		if (iter->second == "*")
+		{
+			for (rts2core::ValueVector::iterator viter = conn->valueBegin (); viter != conn->valueEnd (); viter++)
+			{
+				encodeValue (*viter, json, record);
+				client->queue (valueName_t (iter->first, (*viter)->getName ()), json, record);
+			}
+		}
+		else
+		{
+			rts2core::Value *value = conn->getValue (iter->second.c_str ());
+			if (value == NULL)
+				continue;
+			encodeValue (value, json, record);
+			client->queue (*iter, json, record);
+		}
+	}
+}
+
+void WsD::scheduleWrites ()
+{
+	double now = getNow ();
+	double next = NAN;
+	for (std::list <WsClient *>::iterator iter = clients.begin (); iter != clients.end (); iter++)
+	{
+		double nw = (*iter)->nextWrite ();
+		if (std::isnan (nw))
+			continue;
+		if (nw <= now)
+			lws_callback_on_writable ((*iter)->getWsi ());
+		else if (std::isnan (next) || nw < next)
+			next = nw;
+	}
+	// wake up when client with interval shall receive its updates
+	setTimeout (std::isnan (next) ? USEC_SEC : std::min ((long int) USEC_SEC, (long int) ((next - now) * USEC_SEC) + 1));
+}
+
+void WsD::writeClient (WsClient *client)
+{
+	std::string frame;
+	bool binary;
+
+	// frames which are not sent immediately are buffered by libwebsockets,
+	// and the next writable callback comes after the buffer is sent
+	if (lws_send_pipe_choked (client->getWsi ()))
+	{
+		lws_callback_on_writable (client->getWsi ());
+		return;
+	}
+
+	if (!client->nextFrame (frame, binary, getNow ()))
+		return;
+
+	unsigned char *buf = new unsigned char[LWS_PRE + frame.length ()];
+	memcpy (buf + LWS_PRE, frame.data (), frame.length ());
+	int n = lws_write (client->getWsi (), buf + LWS_PRE, frame.length (), binary ? LWS_WRITE_BINARY : LWS_WRITE_TEXT);
+	delete[] buf;
+	if (n < 0)
+	{
+		logStream (MESSAGE_ERROR) << "error writing to websocket client" << sendLog;
+		return;
+	}
+	framesSent->inc ();
+
+	double nw = client->nextWrite ();
+	if (!std::isnan (nw) && nw <= getNow ())
+		lws_callback_on_writable (client->getWsi ());
+}
+
+void WsD::updateStats ()
+{
+	unsigned long coalesced = closedCoalesced;
+	for (std::list <WsClient *>::iterator iter = clients.begin (); iter != clients.end (); iter++)
+		coalesced += (*iter)->getCoalesced ();
+	valuesCoalesced->setValueLong (coalesced);
+	sendValueAll (numClients);
+	sendValueAll (framesSent);
+	sendValueAll (valuesCoalesced);
+	lastStats = getNow ();
+}
+
 int main (int argc, char **argv)
 {
 	WsD device (argc, argv);
@@ -20,9 +20,12 @@ struct per_session_data__http {
 	unsigned int client_finished:1;
 };
 
-struct per_session_data__dumb_increment
+/**
+ * Session data of rts2-values protocol. Points to rts2wsd::WsClient.
+ */
+struct per_session_data__values
 {
-	int number;
+	void *client;
 };
 
 int callback_http (struct lws *wsi, enum lws_callback_reasons reason, void *user, void *in, size_t len);